@@ -0,0 +1,35 @@
+#include <Lgm_CTrans.h>
+#include <Lgm_Vec.h>
+
+/*
+ *  Make a flat, memory mappable copy of the DE421 ephemeris. If the copy is
+ *  put next to jpl_de421.h5 (in $JPL_EPHEM_PATH or the default DE_FILES
+ *  directory) as jpl_de421.map, Lgm_ReadJPLephem() will map it instead of
+ *  reading the HDF5 file.
+ *
+ *      DEMakeMap [ OutFile ]
+ */
+int main( int argc, char *argv[] ) {
+
+    Lgm_JPLephemInfo  *jpl = Lgm_InitJPLephemInfo( 421, LGM_DE_ALLBODIES, 2 );
+    Lgm_JPLephemInfo  *map = Lgm_InitJPLephemInfo( 421, LGM_DE_ALLBODIES, 2 );
+    char              *OutFile = ( argc > 1 ) ? argv[1] : "jpl_de421.map";
+    Lgm_Vector        u1, u2;
+    double            JD = 2457755.0;
+
+    Lgm_ReadJPLephem( jpl );
+    if ( Lgm_WriteJPLephemMap( OutFile, jpl ) != 0 ) return( 1 );
+
+    // Check that the copy gives the same answers
+    if ( Lgm_MapJPLephem( OutFile, map ) != 0 ) return( 1 );
+    Lgm_JPLephem_position( JD, LGM_DE_PLUTO, jpl, &u1 );
+    Lgm_JPLephem_position( JD, LGM_DE_PLUTO, map, &u2 );
+    printf( "Pluto (HDF5): %.8lf %.8lf %.8lf\n", u1.x, u1.y, u1.z );
+    printf( "Pluto (map):  %.8lf %.8lf %.8lf\n", u2.x, u2.y, u2.z );
+
+    Lgm_FreeJPLephemInfo( map );
+    Lgm_FreeJPLephemInfo( jpl );
+
+    return( 0 );
+
+}
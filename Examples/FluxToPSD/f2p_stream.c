@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <math.h>
+#include <Lgm_MagModelInfo.h>
+#include <Lgm_FluxToPsd.h>
+
+/*
+ *  Convert a (made up) day of geosynchronous flux data to PSD at constant Mu
+ *  and K with the streaming converter, and report the throughput.
+ */
+
+typedef struct ReaderInfo {
+    int         n;          // next sample to make
+    int         nSamples;   // number of samples in the series
+    int         nE, nA;
+    double      *E, *A;
+    Lgm_CTrans  *c;
+} ReaderInfo;
+
+
+/*
+ *  Reader callback. Makes up a two-component relativistic maxwellian
+ *  (Cayton et al. [1989]) with a sin^2 pitch angle modulation, every 5
+ *  minutes along a circular orbit at 6.6 Re. A real reader would pull the
+ *  next record out of a data file here.
+ */
+int Reader( Lgm_F2P_Sample *s, void *Data ) {
+
+    ReaderInfo  *r = (ReaderInfo *)Data;
+    Lgm_Vector  u;
+    double      f, p2c2, sa, phi;
+    int         i, j;
+
+    if ( r->n >= r->nSamples ) return( 0 );
+
+    s->DateTime.Date = 20020101;
+    s->DateTime.Time = r->n*5.0/60.0;
+    Lgm_Make_UTC( s->DateTime.Date, s->DateTime.Time, &(s->DateTime), r->c );
+
+    phi = 2.0*M_PI*s->DateTime.Time/24.0;
+    u.x = 6.6*cos( phi ); u.y = 6.6*sin( phi ); u.z = 0.0;
+    Lgm_Set_Coord_Transforms( s->DateTime.Date, s->DateTime.Time, r->c );
+    Lgm_Convert_Coords( &u, &(s->Position), GEO_TO_GSM, r->c );
+
+    for ( i=0; i<r->nE; i++ ) {
+        f    = Lgm_MaxJut( 5e-3, 25.0, r->E[i], LGM_Ee0 ) + Lgm_MaxJut( 1e-4, 200.0, r->E[i], LGM_Ee0 ); // PSD c^3/cm^3/MeV^3
+        p2c2 = Lgm_p2c2( r->E[i], LGM_Ee0 );
+        for ( j=0; j<r->nA; j++ ) {
+            sa = sin( r->A[j]*RadPerDeg );
+            s->FLUX_EA[i][j] = sa*sa*Lgm_PsdToDiffFlux( f, p2c2 );
+        }
+    }
+
+    ++(r->n);
+    return( 1 );
+
+}
+
+
+/*
+ *  Writer callback. Samples arrive in order.
+ */
+int Writer( Lgm_F2P_Sample *s, void *Data ) {
+
+    int *nK = (int *)Data;
+    int k;
+
+    printf( "%5ld %8.4f  Bmodel = %8.3f  PSD(Mu[0], K[k]):", s->Index, s->DateTime.Time, s->B );
+    for ( k=0; k<*nK; k++ ) printf( " %10.4g", s->PSD_MK[0][k] );
+    printf( "\n" );
+
+    return( 0 );
+
+}
+
+
+int main( ) {
+
+    Lgm_MagModelInfo   *mInfo = Lgm_InitMagInfo();
+    Lgm_F2P_Stream     *s;
+    ReaderInfo          r;
+    double              E[10], A[18], Mu[20], K[8];
+    int                 i, nMu = 20, nK = 8;
+
+    Lgm_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_T89, mInfo );
+    mInfo->Kp = 2;
+    mInfo->UseInterpRoutines = TRUE;
+
+    for ( i=0; i<10;  i++ ) E[i]  = 0.05*pow( 1.5, i );  // MeV
+    for ( i=0; i<18;  i++ ) A[i]  = 5.0 + 5.0*i;         // Degrees
+    for ( i=0; i<nMu; i++ ) Mu[i] = 100.0 + 100.0*i;     // MeV/G
+    for ( i=0; i<nK;  i++ ) K[i]  = 0.01*pow( 2.0, i );  // Re G^1/2
+
+    r.n = 0; r.nSamples = 288; r.nE = 10; r.nA = 18; r.E = E; r.A = A;
+    r.c = Lgm_init_ctrans( 0 );
+
+    s = Lgm_F2P_CreateStream( E, 10, A, 18, Mu, nMu, K, nK, 32 );
+    s->Extrapolate = 0;
+
+    Lgm_F2P_RunStream( s, Reader, &r, Writer, &nK, mInfo );
+
+    printf( "\n%ld samples in %g s (%g samples/s) using %d threads. Time in field model: %g s, in fitting: %g s\n",
+            s->nSamples, s->ElapsedTime, s->SamplesPerSec, s->nThreads, s->FieldTime, s->NumericTime );
+
+    Lgm_F2P_FreeStream( s );
+    Lgm_free_ctrans( r.c );
+    Lgm_FreeMagInfo( mInfo );
+
+    return(0);
+}
@@ -16,183 +16,14 @@
 #define KP_DEFAULT  1
 
 
-/*
- *      Input Variables:
- *
- *                      Date: 
- *                       UTC: 
- *                     brac1:  Radial distance for inner edge of search bracket
- *                     brac2:  Radial distance for outer edge of search bracket
- *                     Alpha:  Equatorial pitch angle to compute 
- *                   Quality:  Quality factor (0-8)
- *
- *      Input/OutPut Variables:
- *                         K:  K value for LCDS at given alpha
- *                 LstarInfo:  LstarInfo structure to specify B-field model, store last valid Lstar, etc.
- *  
- */
-int LCDS( long int Date, double UTC, double brac1, double brac2, double MLT, double Alpha, double tol, int Quality, double *K, Lgm_LstarInfo *LstarInfo ) {
-    Lgm_LstarInfo   *LstarInfo_brac1, *LstarInfo_brac2, *LstarInfo_test;
-    Lgm_Vector      v1, v2, v3, LCDSv3, Bvec, Ptest, PtestSM, Pinner, PinnerSM, Pouter, PouterSM;
-    double          Blocal, Xtest, sa, sa2, LCDS;
-    double          nTtoG = 1.0e-5;
-    int             LS_Flag, nn, k, TFlag;
-    int             maxIter = 50;
-
-    //Start by creating necessary structures... need an Lstar info for each bracket, plus test point.
-    LstarInfo_brac1 = Lgm_CopyLstarInfo( LstarInfo );
-    LstarInfo_brac2 = Lgm_CopyLstarInfo( LstarInfo );
-    LstarInfo_test = Lgm_CopyLstarInfo( LstarInfo );
-
-    // Set Tolerances
-    Lgm_SetLstarTolerances( Quality, 24, LstarInfo_brac1 );
-    Lgm_SetLstarTolerances( Quality, 24, LstarInfo_brac2 );
-    Lgm_SetLstarTolerances( Quality, 24, LstarInfo_test );
-
-    // set coord transformation 
-    Lgm_Set_Coord_Transforms( Date, UTC, LstarInfo_brac1->mInfo->c );
-    Lgm_Set_Coord_Transforms( Date, UTC, LstarInfo_brac2->mInfo->c );
-    Lgm_Set_Coord_Transforms( Date, UTC, LstarInfo_test->mInfo->c );
-
-    //Check for closed drift shell at brackets
-    PinnerSM.x = brac1*cos(MLT); PinnerSM.y = brac1*sin(MLT); PinnerSM.z = 0.0;
-    Lgm_Convert_Coords( &PinnerSM, &Pinner, SM_TO_GSM, LstarInfo_test->mInfo->c );
-
-    /*
-     *  Test inner bracket location.
-     */
-    LstarInfo_brac1->mInfo->Bfield( &Pinner, &Bvec, LstarInfo_brac1->mInfo );
-    Blocal = Lgm_Magnitude( &Bvec );
-    sa = sin( LstarInfo->PitchAngle*RadPerDeg ); sa2 = sa*sa;
-
-    //Trace to minimum-B
-    if ( Lgm_Trace( &Pinner, &v1, &v2, &v3, 120.0, 0.01, TRACE_TOL, LstarInfo_brac1->mInfo ) == LGM_CLOSED ) {
-        //Only continue if bracket 1 is closed FL
-        //Get L*
-        LstarInfo_brac1->mInfo->Bm = LstarInfo_brac1->mInfo->Bmin/sa2;
-        LS_Flag = Lstar( &v3, LstarInfo_brac1);
-        LCDS = LstarInfo_brac1->LS;
-        *K = (LstarInfo_brac1->I0)*sqrt(Lgm_Magnitude(&LstarInfo_brac1->Bmin[0]));
-        if (LstarInfo->VerbosityLevel > 1) printf("Found valid inner bracket. Pinner_GSM, Pmin_GSM = (%g, %g, %g), (%g, %g, %g)\n", Pinner.x, Pinner.y, Pinner.z, LstarInfo_brac1->mInfo->Pmin.x, LstarInfo_brac1->mInfo->Pmin.y, LstarInfo_brac1->mInfo->Pmin.z);
-    } else {
-        FreeLstarInfo( LstarInfo_brac1 );
-        FreeLstarInfo( LstarInfo_brac2 );
-        FreeLstarInfo( LstarInfo_test );
-        return(-8); //Inner bracket is bad - bail
-    }
-
-
-    /*
-     *  Test outer bracket location.
-     */
-    PouterSM.x = brac2*cos(MLT); PouterSM.y = brac2*sin(MLT); PouterSM.z = 0.0;
-    Lgm_Convert_Coords( &PouterSM, &Pouter, SM_TO_GSM, LstarInfo_test->mInfo->c );
-
-    LstarInfo_brac2->mInfo->Bfield( &Pouter, &Bvec, LstarInfo_brac2->mInfo );
-    Blocal = Lgm_Magnitude( &Bvec );
-
-    //Trace to minimum-B
-    if ( Lgm_Trace( &Pouter, &v1, &v2, &v3, 120.0, 0.01, TRACE_TOL, LstarInfo_brac2->mInfo ) == LGM_CLOSED ) {
-        //If bracket 2 is closed FL then check for undefined L*. If L* is defined, we have a problem
-        //Get L*
-        LstarInfo_brac2->mInfo->Bm = LstarInfo_brac2->mInfo->Bmin/sa2;
-        LS_Flag = Lstar( &v3, LstarInfo_brac2);
-        if (LstarInfo_brac2->LS != LGM_FILL_VALUE) {
-            //move outer bracket out and try again
-            PouterSM.x = 1.7*Lgm_Magnitude(&Pouter)*cos(MLT);
-            PouterSM.y = 1.7*Lgm_Magnitude(&Pouter)*sin(MLT); PouterSM.z = 0.0;
-            Lgm_Convert_Coords( &PouterSM, &Pouter, SM_TO_GSM, LstarInfo_test->mInfo->c );
-            if ( Lgm_Trace( &Pouter, &v1, &v2, &v3, 120.0, 0.01, TRACE_TOL, LstarInfo_brac2->mInfo ) == LGM_CLOSED ) {
-                LS_Flag = Lstar( &v3, LstarInfo_brac2);
-                if (LstarInfo_brac2->LS != LGM_FILL_VALUE) {
-                    FreeLstarInfo( LstarInfo_brac1 );
-                    FreeLstarInfo( LstarInfo_brac2 );
-                    FreeLstarInfo( LstarInfo_test );
-                    return(-9); //Outer bracket is bad - bail
-                }
-            }
-        }
-    }
-    if (LstarInfo->VerbosityLevel > 1) {
-        printf("Found valid outer bracket. Pouter_GSM, Pmin_GSM = (%g, %g, %g), (%g, %g, %g)\n", Pouter.x, Pouter.y, Pouter.z, LstarInfo_brac2->mInfo->Pmin.x, LstarInfo_brac2->mInfo->Pmin.y, LstarInfo_brac2->mInfo->Pmin.z);
-    }
-
-    //if brackets are okay, we've moved on without changing anything except setting initial LCDS value as L* at inner bracket
-    nn = 0;
-    while (Lgm_Magnitude(&Pouter)-Lgm_Magnitude(&Pinner) > tol){
-        if (LstarInfo->VerbosityLevel > 1) printf("Current LCDS iteration, bracket width = %d, %g\n", nn, Lgm_Magnitude(&Pouter)-Lgm_Magnitude(&Pinner));
-        if (nn > maxIter) {
-            printf("********* EXCEEDED MAXITER\n");
-            //free structures before returning
-            FreeLstarInfo( LstarInfo_brac1 );
-            FreeLstarInfo( LstarInfo_brac2 );
-            FreeLstarInfo( LstarInfo_test );
-            return(-2); //reached max iterations without achieving tolerance - bail
-        }
-        Xtest = (Lgm_Magnitude(&Pinner) + (Lgm_Magnitude(&Pouter)-Lgm_Magnitude(&Pinner))/2.0);
-        PtestSM.x = -1.0*Xtest*cos(MLT); PtestSM.y = -1.0*Xtest*sin(MLT); PtestSM.z = 0.0;
-        Lgm_Convert_Coords( &PtestSM, &Ptest, SM_TO_GSM, LstarInfo_test->mInfo->c );
-
-        LstarInfo_test->mInfo->Bfield( &Ptest, &Bvec, LstarInfo_test->mInfo );
-        Blocal = Lgm_Magnitude( &Bvec );
-        //Trace to minimum-B
-        TFlag = Lgm_Trace( &Ptest, &v1, &v2, &v3, 120.0, 0.01, TRACE_TOL, LstarInfo_test->mInfo );
-        if ( TFlag == LGM_CLOSED ) {
-            //If test point is closed FL then check for undefined L*.
-            //Get L*
-            LstarInfo_test->mInfo->Bm = LstarInfo_test->mInfo->Bmin/sa2;
-            LS_Flag = Lstar( &v3, LstarInfo_test);
-            if ( (LS_Flag > 0) || (LstarInfo_test->LS != LGM_FILL_VALUE) ){
-                //Drift shell defined
-                Pinner = Ptest;
-                LCDSv3 = v3;
-                LCDS = LstarInfo_test->LS;
-                *K = (LstarInfo_test->I0)*sqrt(LstarInfo_test->mInfo->Bm*nTtoG);
-
-                //Determine the type of the orbit
-                LstarInfo_test->DriftOrbitType = LGM_DRIFT_ORBIT_CLOSED;
-                for ( k=0; k<LstarInfo_test->nMinMax; ++k ) {
-                    if ( LstarInfo_test->nMinima[k] > 1 ) LstarInfo_test->DriftOrbitType = LGM_DRIFT_ORBIT_CLOSED_SHABANSKY;
-                    if ( LstarInfo_test->nMinima[k] < 1 ) {printf("Less than one minimum defined on field line: Exit due to impossibility."); exit(-1); }
-                }
-
-                if (LstarInfo->VerbosityLevel > 1) printf("Current LCDS, K, PtestSM is %g, %g, (%g, %g, %g)\n", LCDS, *K, PtestSM.x, PtestSM.y, PtestSM.z);
-                LstarInfo->mInfo->Bm = LstarInfo_test->mInfo->Bm;
-                LstarInfo->DriftOrbitType = LstarInfo_test->DriftOrbitType;
-            } else {
-                Pouter = Ptest;
-                Lgm_Convert_Coords( &Ptest, &PtestSM, GSM_TO_SM, LstarInfo_test->mInfo->c );
-                printf("Failed DS trace at test point (%g %g %g GSM; %g %g %g SM; TFlag = %d), moving outer bracket to current location\n", 
-                   Ptest.x, Ptest.y, Ptest.z, PtestSM.x, PtestSM.y, PtestSM.z, TFlag);
-            }
-        } else {
-            //FL open -> drift shell open
-            Lgm_Convert_Coords( &Ptest, &PtestSM, GSM_TO_SM, LstarInfo_test->mInfo->c );
-            printf("Failed FL trace at test point (%g %g %g GSM; %g %g %g SM; TFlag = %d), moving outer bracket to current location\n", 
-                   Ptest.x, Ptest.y, Ptest.z, PtestSM.x, PtestSM.y, PtestSM.z, TFlag);
-            Pouter = Ptest;
-        }
-
-    nn++;
-    }
-if (LstarInfo->VerbosityLevel > 0) printf("Final LCDS, K is %g, %g. Eq. radius = %g \n", LCDS, *K, Lgm_Magnitude( &LCDSv3 ));
-    LstarInfo->LS = LCDS;
-    //free structures
-    FreeLstarInfo( LstarInfo_brac1 );
-    FreeLstarInfo( LstarInfo_brac2 );
-    FreeLstarInfo( LstarInfo_test );
-    return(0);
-    }
-
-
 
 
 int main( int argc, char *argv[] ){
 
-    double           UTC, brac1, brac2, tol, sJD, eJD, JD, t_cadence, MLT;
-    double           K[500], LS[500], Alpha[500];
+    double           UTC, brac1, brac2, tol, sJD, eJD, JD, t_cadence, LT;
+    double           K[500], LS[500], Kin[500], rLCDS[500];
     long int         StartDate, EndDate, Date;
-    int              nAlpha, i, Quality, ans, aa, Year, Month, Day, Doy;
+    int              nK, i, Quality, ans, aa, Year, Month, Day, Doy, nDiv;
     char             Str[128], NewStr[2048];
     char             Filename[1024];
     Lgm_LstarInfo    *LstarInfo = InitLstarInfo(0);
@@ -203,23 +34,19 @@ int main( int argc, char *argv[] ){
 
     tol = 0.001;
 
-    nAlpha=5;
-    //nAlpha=18;
-    //for (i=0; i<nAlpha; i++) {
-    //#    Alpha[i] = 5.0+i*5.0;
-    //}
-    Alpha[0] = 10;
-    Alpha[1] = 25;
-    Alpha[2] = 40;
-    Alpha[3] = 65;
-    Alpha[4] = 90;
+    nK=5;
+    Kin[0] = 0.01;
+    Kin[1] = 0.05;
+    Kin[2] = 0.1;
+    Kin[3] = 0.3;
+    Kin[4] = 1.0;
 
     // Date and UTC
     StartDate       = 20010101;
     EndDate         = 20010101;
     StartDate       = 20130314;
     EndDate         = 20130314;
-    MLT = 0.0;
+    LT = 0.0;
     Lgm_Doy( StartDate, &Year, &Month, &Day, &Doy);
     NewStr[0]       = '\0';
     strcpy(Filename, "%YYYY%MM%DD_LCDS_T89c_6MLT.txt");
@@ -245,26 +72,26 @@ int main( int argc, char *argv[] ){
     int nCol = 0;
 
     fprintf( fp, "# {\n");
-    if ( nAlpha > 0 ) {
-        fprintf( fp, "#  \"Alpha\":            { \"DESCRIPTION\": \"Pitch Angles.\",\n");
-        fprintf( fp, "#                               \"NAME\": \"Pitch Angle\",\n");
-        fprintf( fp, "#                              \"TITLE\": \"Pitch Angle\",\n");
-        fprintf( fp, "#                              \"LABEL\": \"Pitch Angle\",\n");
-        fprintf( fp, "#                          \"DIMENSION\": [ %d ],\n", nAlpha );
+    if ( nK > 0 ) {
+        fprintf( fp, "#  \"Kin\":              { \"DESCRIPTION\": \"Modified second adiabatic invariant, K (as specified)\",\n");
+        fprintf( fp, "#                               \"NAME\": \"Kin\",\n");
+        fprintf( fp, "#                              \"TITLE\": \"Kin\",\n");
+        fprintf( fp, "#                              \"LABEL\": \"Kin\",\n");
+        fprintf( fp, "#                          \"DIMENSION\": [ %d ],\n", nK );
         fprintf( fp, "#                             \"VALUES\": [ ");
-        for (i=0; i<nAlpha-1; i++) fprintf(fp, "%g, ", Alpha[i] );
-        fprintf(fp, "%g ],\n", Alpha[i] ); 
+        for (i=0; i<nK-1; i++) fprintf(fp, "%g, ", Kin[i] );
+        fprintf(fp, "%g ],\n", Kin[i] ); 
 
         fprintf( fp, "#                      \"ELEMENT_NAMES\": [ ");
-        for (i=0; i<nAlpha-1; i++) fprintf(fp, "\"PA%d\", ", i );
-        fprintf(fp, "\"PA%d\" ],\n", i ); 
+        for (i=0; i<nK-1; i++) fprintf(fp, "\"K%d\", ", i );
+        fprintf(fp, "\"K%d\" ],\n", i ); 
 
         fprintf( fp, "#                     \"ELEMENT_LABELS\": [ ");
-        for (i=0; i<nAlpha-1; i++) fprintf(fp, "\"%g Deg.\", ", Alpha[i] );
-        fprintf(fp, "\"%g Deg.\" ],\n", Alpha[i] ); 
-        fprintf( fp, "#                              \"UNITS\": \"Degrees\",\n");
+        for (i=0; i<nK-1; i++) fprintf(fp, "\"%g R_E G^1/2\", ", Kin[i] );
+        fprintf(fp, "\"%g R_E G^1/2\" ],\n", Kin[i] ); 
+        fprintf( fp, "#                              \"UNITS\": \"R_E G^1/2\",\n");
         fprintf( fp, "#                          \"VALID_MIN\":  0.0,\n");
-        fprintf( fp, "#                          \"VALID_MAX\": 90.0,\n");
+        fprintf( fp, "#                          \"VALID_MAX\": 20.0,\n");
         fprintf( fp, "#                         \"FILL_VALUE\": -1e31 },\n");
         fprintf( fp, "#\n");
     }
@@ -277,41 +104,41 @@ int main( int argc, char *argv[] ){
     fprintf( fp, "#                       \"START_COLUMN\": %d },\n", nCol++);
     fprintf( fp, "#\n");
 
-    if ( nAlpha > 0 ) {
+    if ( nK > 0 ) {
         fprintf( fp, "#  \"LCDS\":            { \"DESCRIPTION\": \"Last closed generalized Roederer L-shell value (also known as L*).\",\n");
         fprintf( fp, "#                               \"NAME\": \"LCDS\",\n");
         fprintf( fp, "#                              \"TITLE\": \"LCDS\",\n");
         fprintf( fp, "#                              \"LABEL\": \"LCDS, Dimensionless\",\n");
         fprintf( fp, "#                              \"UNITS\": \"Dimensionless\",\n");
-        fprintf( fp, "#                          \"DIMENSION\": [ %d ],\n", nAlpha );
-        fprintf( fp, "#                       \"START_COLUMN\": %d,\n", nCol); nCol += nAlpha;
+        fprintf( fp, "#                          \"DIMENSION\": [ %d ],\n", nK );
+        fprintf( fp, "#                       \"START_COLUMN\": %d,\n", nCol); nCol += nK;
         fprintf( fp, "#                      \"ELEMENT_NAMES\": [ ");
-        for (i=0; i<nAlpha-1; i++) fprintf(fp, "\"LCDS_%g\", ", Alpha[i] );
-        fprintf(fp, "\"LCDS_%g\" ],\n", Alpha[i] ); 
+        for (i=0; i<nK-1; i++) fprintf(fp, "\"LCDS_%g\", ", Kin[i] );
+        fprintf(fp, "\"LCDS_%g\" ],\n", Kin[i] ); 
         fprintf( fp, "#                     \"ELEMENT_LABELS\": [ ");
-        for (i=0; i<nAlpha-1; i++) fprintf(fp, "\"LCDS %g!Eo!N\", ", Alpha[i] );
-        fprintf(fp, "\"LCDS %g!Eo!N\" ],\n", Alpha[i] ); 
-        fprintf( fp, "#                           \"DEPEND_1\": \"Alpha\",\n");
+        for (i=0; i<nK-1; i++) fprintf(fp, "\"LCDS K=%g\", ", Kin[i] );
+        fprintf(fp, "\"LCDS K=%g\" ],\n", Kin[i] ); 
+        fprintf( fp, "#                           \"DEPEND_1\": \"Kin\",\n");
         fprintf( fp, "#                          \"VALID_MIN\": 0.0,\n");
         fprintf( fp, "#                          \"VALID_MAX\": 1000.0,\n");
         fprintf( fp, "#                         \"FILL_VALUE\": -1e31 },\n");
         fprintf( fp, "#\n");
     }
-    if ( nAlpha > 0 ) {
+    if ( nK > 0 ) {
         fprintf( fp, "#  \"K\":              { \"DESCRIPTION\": \"Modified second adiabatic invariant, K\",\n");
         fprintf( fp, "#                               \"NAME\": \"K\",\n");
         fprintf( fp, "#                              \"TITLE\": \"K\",\n");
         fprintf( fp, "#                              \"LABEL\": \"K, [R!IE!N G!U1/2!N]\",\n");
         fprintf( fp, "#                              \"UNITS\": \"R!IE!N G!U1/2!N\",\n");
-        fprintf( fp, "#                          \"DIMENSION\": [ %d ],\n", nAlpha );
-        fprintf( fp, "#                       \"START_COLUMN\": %d,\n", nCol); nCol += nAlpha;
+        fprintf( fp, "#                          \"DIMENSION\": [ %d ],\n", nK );
+        fprintf( fp, "#                       \"START_COLUMN\": %d,\n", nCol); nCol += nK;
         fprintf( fp, "#                      \"ELEMENT_NAMES\": [ ");
-        for (i=0; i<nAlpha-1; i++) fprintf(fp, "\"K_%g\", ", Alpha[i] );
-        fprintf(fp, "\"K_%g\" ],\n", Alpha[i] ); 
+        for (i=0; i<nK-1; i++) fprintf(fp, "\"K_%g\", ", Kin[i] );
+        fprintf(fp, "\"K_%g\" ],\n", Kin[i] ); 
         fprintf( fp, "#                     \"ELEMENT_LABELS\": [ ");
-        for (i=0; i<nAlpha-1; i++) fprintf(fp, "\"K %g!Eo!N\", ", Alpha[i] );
-        fprintf(fp, "\"K %g!Eo!N\" ],\n", Alpha[i] ); 
-        fprintf( fp, "#                           \"DEPEND_1\": \"Alpha\",\n");
+        for (i=0; i<nK-1; i++) fprintf(fp, "\"K=%g\", ", Kin[i] );
+        fprintf(fp, "\"K=%g\" ],\n", Kin[i] ); 
+        fprintf( fp, "#                           \"DEPEND_1\": \"Kin\",\n");
         fprintf( fp, "#                          \"VALID_MIN\": 0.0,\n");
         fprintf( fp, "#                          \"VALID_MAX\": 1000.0,\n");
         fprintf( fp, "#                         \"FILL_VALUE\": -1e31 }\n");
@@ -321,9 +148,9 @@ int main( int argc, char *argv[] ){
     fprintf( fp, "#\n");
     // column header
     fprintf( fp, "# %24s", "Time" );
-    for (i=0; i<nAlpha; i++) { sprintf( Str, "L*%d", i ); fprintf(fp, " %8s", Str ); }
+    for (i=0; i<nK; i++) { sprintf( Str, "L*%d", i ); fprintf(fp, " %8s", Str ); }
     fprintf(fp, "    ");
-    for (i=0; i<nAlpha; i++) { sprintf( Str, "K%d", i ); fprintf(fp, " %8s", Str ); }
+    for (i=0; i<nK; i++) { sprintf( Str, "K%d", i ); fprintf(fp, " %8s", Str ); }
     fprintf(fp, "    ");
     fprintf(fp, "%s", " \n");
 
@@ -352,53 +179,46 @@ LstarInfo->mInfo->InternalModel = LGM_CDIP;
          * Compute L*s, Is, Bms, etc...
          */
     
-        { // ***** BEGIN PARALLEL EXECUTION *****
-    
-            /*
-             *  Do all of the PAs in parallel. To control how many threads get run
-             *  use the enironment variable OMP_NUM_THREADS. For example,
-             *          setenv OMP_NUM_THREADS 8
-             *  will use 8 threads to do the loop in parallel. Be very careful what gets 
-             *  set private here -- the threads must not interfere with each other.
-             */
-            #pragma omp parallel private(LstarInfo3,ans)
-            #pragma omp for schedule(dynamic, 1)
-    
-            for (aa=0; aa<nAlpha; ++aa) {
-                // make a local copy of LstarInfo structure -- needed for multi-threading
-                LstarInfo3 = Lgm_CopyLstarInfo( LstarInfo );
-                LstarInfo3->PitchAngle = Alpha[aa];
-                //printf("Date, UTC, aa, Alpha, tol = %ld, %g, %d, %g, %g\n", Date, UTC, aa, LstarInfo3->PitchAngle, tol);
-    
-                ans = LCDS( Date, UTC, brac1, brac2, MLT, Alpha[aa], tol, Quality, &K[aa], LstarInfo3 );
-                if (ans==0) LS[aa] = LstarInfo3->LS;
-                if (LstarInfo3->DriftOrbitType == 1) printf("Alpha: %g; Drift Orbit Type: Closed; L* = %g \n", Alpha[aa], LstarInfo3->LS);
-                if (LstarInfo3->DriftOrbitType == 2) printf("Drift Orbit Type: Shebansky; L* = %g\n", LstarInfo3->LS);
-                if (ans!=0) {
-                    K[aa] = LGM_FILL_VALUE;
-                    LS[aa] = LGM_FILL_VALUE;
-                    printf("**==**==**==** (PA = %g) Return value: %d\n", Alpha[aa], ans);
-                }
-    
-                FreeLstarInfo( LstarInfo3 );
+        /*
+         *  Each LCDS search runs its trial drift shells in parallel (nDiv at a
+         *  time), so the Ks are done one after another. To control how many
+         *  threads get run use the enironment variable OMP_NUM_THREADS. For
+         *  example,
+         *          setenv OMP_NUM_THREADS 8
+         *  will test 8 radii per round.
+         */
+        nDiv = omp_get_max_threads();
+        for (aa=0; aa<nK; ++aa) {
+            // make a local copy of LstarInfo structure -- keeps the shell guesses from leaking between Ks
+            LstarInfo3 = Lgm_CopyLstarInfo( LstarInfo );
+
+            ans = Lgm_LCDS_KSection( Date, UTC, brac1, brac2, Kin[aa], LT, tol, Quality, 24, nDiv, &K[aa], &rLCDS[aa], LstarInfo3 );
+            if (ans==0) LS[aa] = LstarInfo3->LS;
+            if (LstarInfo3->DriftOrbitType == 1) printf("K: %g; Drift Orbit Type: Closed; L* = %g \n", Kin[aa], LstarInfo3->LS);
+            if (LstarInfo3->DriftOrbitType == 2) printf("Drift Orbit Type: Shebansky; L* = %g\n", LstarInfo3->LS);
+            if (ans!=0) {
+                K[aa] = LGM_FILL_VALUE;
+                LS[aa] = LGM_FILL_VALUE;
+                printf("**==**==**==** (K = %g) Return value: %d\n", Kin[aa], ans);
             }
-    
-        } // ***** END PARALLEL EXECUTION *****
+
+            FreeLstarInfo( LstarInfo3 );
+        }
         
         // FIX THIS WRITE OUT
         Lgm_Make_UTC( Date, UTC, &DT_UTC, LstarInfo->mInfo->c );
         Lgm_DateTimeToString( Str, &DT_UTC, 0, 3);
         fprintf(fp, "%24s",     Str );
-        for ( i=0; i<nAlpha; ++i ) {
+        for ( i=0; i<nK; ++i ) {
             fprintf( fp, "     %8.6e", LS[i]);
         }
-        for ( i=0; i<nAlpha; ++i ) {
+        for ( i=0; i<nK; ++i ) {
             fprintf( fp, "     %8.6e", K[i] );
         }
         fprintf(fp, "%s", " \n");
     }
-    fclose(fp);
     fflush(fp);
+    fclose(fp);
 
     FreeLstarInfo( LstarInfo );
 
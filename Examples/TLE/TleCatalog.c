@@ -0,0 +1,74 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <Lgm_CTrans.h>
+#include <Lgm_Sgp.h>
+#include <Lgm_TleCatalog.h>
+
+/*
+ * This example shows how to build a binary TLE catalog from text TLE files
+ * and then look up (and propagate) the right TLE for an object at a given
+ * time without re-reading the text files.
+ *
+ *   TleCatalog Catalog.bin TLEs.txt [ more TLE files ... ]
+ */
+int main( int argc, char *argv[] ){
+
+    long int        i, k;
+    int             n, IdNumber;
+    double          JD, tsince;
+    Lgm_CTrans      *c = Lgm_init_ctrans( 0 );
+    Lgm_TleCatalog  *Cat;
+    _SgpTLE         TLE;
+    _SgpInfo        *s = (_SgpInfo *)calloc( 1, sizeof(_SgpInfo) );
+
+    if ( argc < 3 ) {
+        printf("Usage: %s Catalog.bin TleFile [ TleFile ... ]\n", argv[0] );
+        exit( 1 );
+    }
+
+
+    /*
+     * Build the catalog (this only needs to be done once).
+     */
+    n = Lgm_TleCatalog_Build( argv[1], argc-2, &argv[2], 1 );
+    if ( n < 0 ) exit( 1 );
+
+
+    /*
+     * Map it and list what is in it.
+     */
+    if ( ( Cat = Lgm_TleCatalog_Open( argv[1], 1 ) ) == NULL ) exit( 1 );
+    for ( k=0; k<Cat->nSat; k++ ) {
+        i = Cat->Sat[k].Start;
+        printf("Object %05d: %5d TLEs, JD %.5lf to %.5lf\n", Cat->Sat[k].IdNumber, Cat->Sat[k].nTle, Cat->JD[i], Cat->JD[i+Cat->Sat[k].nTle-1] );
+    }
+
+
+    /*
+     * For the first object, find the TLE to use half way through its span and
+     * propagate it to that time.
+     */
+    if ( Cat->nSat > 0 ) {
+
+        IdNumber = Cat->Sat[0].IdNumber;
+        i  = Cat->Sat[0].Start;
+        JD = 0.5*( Cat->JD[i] + Cat->JD[i+Cat->Sat[0].nTle-1] );
+
+        i = Lgm_TleCatalog_FindTLEforGivenTime( IdNumber, JD, Cat );
+        Lgm_TleCatalog_GetTLE( i, &TLE, Cat );
+        printf("\nTLE to use for object %05d at JD %.5lf (epoch %s):\n%s\n%s\n", IdNumber, JD, TLE.EpochStr, TLE.Line1, TLE.Line2 );
+
+        LgmSgp_SGP4_Init( s, &TLE );
+        tsince = ( JD - TLE.JD )*1440.0;
+        LgmSgp_SGP4( tsince, s );
+        printf("TEME position at JD %.5lf: %g %g %g km\n", JD, s->X, s->Y, s->Z );
+
+    }
+
+    Lgm_TleCatalog_Close( Cat );
+    Lgm_free_ctrans( c );
+    free( s );
+
+    return( 0 );
+
+}
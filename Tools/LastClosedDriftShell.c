@@ -170,8 +170,8 @@ int main( int argc, char *argv[] ){
     struct Arguments arguments;
     double           UTC, brac1, brac2, tol, sJD, eJD, JD=LGM_FILL_VALUE;
     double           jDate, jDate_beg, jDate_end, t_cadence;
-    double           K[500], LS[500], Kin[500], Bm[500];
-    int              DOT[500];
+    double           K[500], LS[500], Kin[500], Bm[500], rLCDS[500], rPrev[500];
+    int              DOT[500], nDiv;
     double           Inc, FootpointHeight, LT;
     int              Force, UseEop, retval;
     int              UseTS07=0;
@@ -324,6 +324,7 @@ Kin[2] = 0.2;
         // Bracket Position in GSM
         brac1 = -3.0;
         brac2 = -15.0;
+        for (i=0; i<nK; i++) rPrev[i] = LGM_FILL_VALUE;
     
     
         /*
@@ -477,46 +478,50 @@ Kin[2] = 0.2;
              * Compute L*s, Is, Bms, etc...
              */
         
-            { // ***** BEGIN PARALLEL EXECUTION *****
-        
-                /*
-                 *  Do all of the PAs in parallel. To control how many threads get run
-                 *  use the enironment variable OMP_NUM_THREADS. For example,
-                 *          setenv OMP_NUM_THREADS 8
-                 *  will use 8 threads to do the loop in parallel. Be very careful what gets 
-                 *  set private here -- the threads must not interfere with each other.
-                 */
-                #pragma omp parallel private(LstarInfo3,ans)
-                #pragma omp for schedule(dynamic, 1)
-        
-                for (aa=0; aa<nK; ++aa) {
-                    // make a local copy of LstarInfo structure -- needed for multi-threading
-                    LstarInfo3 = Lgm_CopyLstarInfo( LstarInfo );
-                    //LstarInfo3 = LstarInfo;
-                    //LstarInfo3->PitchAngle = Alpha[aa];
-                    if (arguments.verbose >= 1) printf("Date, UTC, aa, Alpha, tol = %ld, %g, %d, %g, %g\n", Date, UTC, aa, LstarInfo3->PitchAngle, tol);
-        
-                    ans = Lgm_LCDS( Date, UTC, brac1, brac2, Kin[aa], LT, tol, Quality, nFLsInDriftShell, &K[aa], LstarInfo3 );
-                    if (LstarInfo3->DriftOrbitType == 1)  printf("K: %g; Drift Orbit Type: Closed;       L* = %g\n", Kin[aa], LstarInfo3->LS);
-                    if (LstarInfo3->DriftOrbitType == 21) printf("K: %g; Drift Orbit Type: Shabansky_I;  L* = %g\n", Kin[aa], LstarInfo3->LS);
-                    if (LstarInfo3->DriftOrbitType == 22) printf("K: %g; Drift Orbit Type: Shabansky_II; L* = %g\n", Kin[aa], LstarInfo3->LS);
-                    DOT[aa] = LstarInfo3->DriftOrbitType;
-                    if (ans==0) {
-                        LS[aa] = LstarInfo3->LS;
-                        Bm[aa] = LstarInfo3->mInfo->Bm;
-                    }
-                    else {
-                        K[aa] = LGM_FILL_VALUE;
-                        LS[aa] = LGM_FILL_VALUE;
-                        Bm[aa] = LGM_FILL_VALUE;
-                        printf("**==**==**==** (K = %g) Return value: %d\n", Kin[aa], ans);
- 
+            /*
+             *  Each LCDS search runs its trial drift shells in parallel (nDiv
+             *  at a time), so the Ks are done one after another. To control
+             *  how many threads get run use the enironment variable
+             *  OMP_NUM_THREADS. The LCDS found at the previous time step
+             *  (for the same K) is used to narrow the initial bracket.
+             */
+            nDiv = omp_get_max_threads();
+            for (aa=0; aa<nK; ++aa) {
+                // make a local copy of LstarInfo structure -- keeps the shell guesses from leaking between Ks
+                LstarInfo3 = Lgm_CopyLstarInfo( LstarInfo );
+                if (arguments.verbose >= 1) printf("Date, UTC, aa, Kin, tol = %ld, %g, %d, %g, %g\n", Date, UTC, aa, Kin[aa], tol);
+
+                ans = -1;
+                if ( rPrev[aa] > 0.0 ) {
+                    ans = Lgm_LCDS_KSection( Date, UTC, rPrev[aa]-0.5, rPrev[aa]+0.5, Kin[aa], LT, tol, Quality, nFLsInDriftShell, nDiv, &K[aa], &rLCDS[aa], LstarInfo3 );
+                    if ( (ans == -8) || (ans == -9) ) {
+                        if (arguments.verbose >= 1) printf("LCDS moved out of bracket around previous value (%g). Using full bracket.\n", rPrev[aa]);
+                        ans = -1;
                     }
-        
-                    FreeLstarInfo( LstarInfo3 );
                 }
-        
-            } // ***** END PARALLEL EXECUTION *****
+                if ( ans == -1 ) {
+                    ans = Lgm_LCDS_KSection( Date, UTC, brac1, brac2, Kin[aa], LT, tol, Quality, nFLsInDriftShell, nDiv, &K[aa], &rLCDS[aa], LstarInfo3 );
+                }
+                if (LstarInfo3->DriftOrbitType == 1)  printf("K: %g; Drift Orbit Type: Closed;       L* = %g\n", Kin[aa], LstarInfo3->LS);
+                if (LstarInfo3->DriftOrbitType == 21) printf("K: %g; Drift Orbit Type: Shabansky_I;  L* = %g\n", Kin[aa], LstarInfo3->LS);
+                if (LstarInfo3->DriftOrbitType == 22) printf("K: %g; Drift Orbit Type: Shabansky_II; L* = %g\n", Kin[aa], LstarInfo3->LS);
+                DOT[aa] = LstarInfo3->DriftOrbitType;
+                if (ans==0) {
+                    LS[aa] = LstarInfo3->LS;
+                    Bm[aa] = LstarInfo3->mInfo->Bm;
+                    rPrev[aa] = rLCDS[aa];
+                }
+                else {
+                    K[aa] = LGM_FILL_VALUE;
+                    LS[aa] = LGM_FILL_VALUE;
+                    Bm[aa] = LGM_FILL_VALUE;
+                    rPrev[aa] = LGM_FILL_VALUE;
+                    printf("**==**==**==** (K = %g) Return value: %d\n", Kin[aa], ans);
+
+                }
+
+                FreeLstarInfo( LstarInfo3 );
+            }
             Lgm_Make_UTC( Date, UTC, &DT_UTC, LstarInfo->mInfo->c );
             Lgm_DateTimeToString( Str, &DT_UTC, 0, 3);
             fprintf(fp, "%24s",     Str );
@@ -44,21 +44,94 @@ static void elt_qsort( struct TimeList *arr, unsigned n ) {
     QSORT( struct TimeList, arr, n, elt_lt );
 }
 
-int WeDontAlreadyHaveThisTime( char *IsoTime, int nIsoTimeArray, char **IsoTimeArray ) {
+/*
+ * Returns the index of IsoTime in IsoTimeArray, or -1 if we dont already have
+ * this exact time.
+ */
+int FindExistingTime( char *IsoTime, int nIsoTimeArray, char **IsoTimeArray ) {
 
     int i;
 
     for ( i=0; i<nIsoTimeArray; i++ ) {
-        if ( strcmp( IsoTime, IsoTimeArray[i] ) == 0 )  { 
-            // then we have this exact time
-            printf("************************************************ We have time: %s already\n", IsoTime);
-            return( 0 );
+        if ( strcmp( IsoTime, IsoTimeArray[i] ) == 0 ) return( i );
+    }
+
+    return( -1 );
+
+}
+
+/*
+ * Returns (in a newly allocated string) the line that Lgm_WriteMagEphemData()
+ * writes for the current values, or NULL on failure.
+ */
+char *MagEphemDataToString( char *IntModel, char *ExtModel, double Kp, double Dst, Lgm_MagEphemInfo *m ) {
+
+    FILE    *fp;
+    long    n;
+    char    *Str;
+
+    if ( ( fp = tmpfile() ) == NULL ) return( NULL );
+    Lgm_WriteMagEphemData( fp, IntModel, ExtModel, Kp, Dst, m );
+    n = ftell( fp );
+    rewind( fp );
+    Str = (char *)calloc( n+1, sizeof(char) );
+    if ( ( n < 0 ) || ( fread( Str, 1, n, fp ) != (size_t)n ) ) {
+        free( Str );
+        Str = NULL;
+    }
+    fclose( fp );
+
+    return( Str );
+
+}
+
+/*
+ * The data lines of the txt file are in the same order as the rows of the
+ * hdf5 file. Rewrite the txt file with NewRows[i] in place of the line for
+ * row i (rows with NewRows[i] == NULL are left alone). The new file is
+ * written to OutFile.tmp and renamed, so on failure OutFile is left as it
+ * was. Returns 0 on success, -1 on failure.
+ */
+int RewriteMagEphemTxtRows( char *OutFile, int nRows, char **NewRows ) {
+
+    FILE    *fp_in, *fp_out;
+    char    *TmpFile, *Line = NULL;
+    size_t  LineSize = 0;
+    int     iRow = 0, Err = 0;
+
+    TmpFile = (char *)calloc( strlen( OutFile ) + 5, sizeof(char) );
+    sprintf( TmpFile, "%s.tmp", OutFile );
+    if ( ( fp_in = fopen( OutFile, "r" ) ) == NULL ) {
+        free( TmpFile );
+        return( -1 );
+    }
+    if ( ( fp_out = fopen( TmpFile, "w" ) ) == NULL ) {
+        fclose( fp_in );
+        free( TmpFile );
+        return( -1 );
+    }
+
+    while ( getline( &Line, &LineSize, fp_in ) > 0 ) {
+        if ( Line[0] == '#' ) {
+            if ( fputs( Line, fp_out ) == EOF ) Err = -1;
+        } else {
+            if ( fputs( ( ( iRow < nRows ) && NewRows[iRow] ) ? NewRows[iRow] : Line, fp_out ) == EOF ) Err = -1;
+            ++iRow;
         }
     }
+    free( Line );
+    fclose( fp_in );
+    if ( fclose( fp_out ) != 0 ) Err = -1;
+
+    if ( iRow < nRows ) {
+        printf("RewriteMagEphemTxtRows: %s has %d data lines, but %d rows were expected\n", OutFile, iRow, nRows );
+        Err = -1;
+    }
+    if ( ( Err == 0 ) && ( rename( TmpFile, OutFile ) != 0 ) ) Err = -1;
+    if ( Err != 0 ) remove( TmpFile );
+    free( TmpFile );
 
-    // we didnt find this exact time in the existing array
-    printf("************************************************ We dont have time: %s yet\n", IsoTime);
-    return(1);
+    return( Err );
 
 }
 
@@ -159,7 +232,7 @@ static struct argp_option Options[] = {
     {"Coords",          'C',    "coord_system",               0,        "Coordinate system used in the input file. Can be: LATLONRAD, SM, GSM, GEI2000 or GSE. Default is LATLONRAD." },
 
     { 0, 0, 0, 0,   "Update Options:", 5},
-    {"Update",          'U',    0,                            0,        "Update an existing file by adding missing lines. Can also force reprocessing of times using the -A option. (Experimental.)" },
+    {"Update",          'U',    0,                            0,        "Update an existing file by adding missing lines and recomputing lines whose inputs (TLE, Qin-Denton values, models, quality, etc.) have changed since they were computed. Can also force reprocessing of times using the -A option. (Experimental.)" },
     {"UpdateAfterDateTime",  'A',    "yyyymmdd[Thh:mm:ss]",        0,        "Redo times that occur after this time. This allows user to force reprocessing of recent times that may now have updated mag model inputs (e.g. Kp may be changed, etc.) Seconds will be truncated to integers.", 0 },
 
     { 0, 0, 0, 0,   "Output Options:", 6},
@@ -641,6 +714,10 @@ void Lgm_WriteMagEphemDataKML( FILE *fp, int i, Lgm_MagEphemData *med ) {
 int main( int argc, char *argv[] ){
     int              nExisting_H5_IsoTimes;
     char             **Existing_H5_IsoTimes;
+    char             **Existing_H5_Fingerprints;
+    char             **NewTxtRows;
+    char             Fingerprint[80];
+    int              iExisting, iRow, nAppended, nRecomputed;
     Lgm_ElapsedTimeInfo t;
     long int         IdNumber;
     char             IntDesig[512], CommonName[512];
@@ -676,7 +753,7 @@ int main( int argc, char *argv[] ){
     hid_t           DataSet, MemSpace;
     herr_t          status;
     hsize_t         Dims[4], Offset[4], SlabSize[4];
-    int             iT, nOffset;
+    int             iT;
     double          ForceKp;
     double          GeodLat, GeodLong, GeodHeight, MLAT, MLON, MLT;
     Lgm_MagEphemData *med;
@@ -1120,6 +1197,9 @@ if        ( !strcmp( Bird, "rbspa" ) ){
             StatError = stat( HdfOutFile, &StatBuf );
 
             FileExists = FALSE;
+            nExisting_H5_IsoTimes    = 0;
+            Existing_H5_IsoTimes     = NULL;
+            Existing_H5_Fingerprints = NULL;
             if ( StatError != -1 ) {
 
                 FileExists = TRUE;
@@ -1155,12 +1235,26 @@ if        ( !strcmp( Bird, "rbspa" ) ){
                     file = H5Fopen( HdfOutFile,  H5F_ACC_RDWR, H5P_DEFAULT );
                     Existing_H5_IsoTimes  = Get_StringDataset_1D( file, "/IsoTime", Dims );
                     nExisting_H5_IsoTimes = Dims[0];
+
+                    /*
+                     * Files written before fingerprints existed dont have
+                     * them. Add the dataset -- every existing row will then
+                     * look changed and get recomputed once.
+                     */
+                    if ( H5Lexists( file, "InputFingerprint", H5P_DEFAULT ) > 0 ) {
+                        Existing_H5_Fingerprints = Get_StringDataset_1D( file, "/InputFingerprint", Dims );
+                        if ( Dims[0] < nExisting_H5_IsoTimes ) {
+                            LGM_ARRAY_2D_FREE( Existing_H5_Fingerprints );
+                            Existing_H5_Fingerprints = NULL;
+                        }
+                    } else {
+                        if ( Lgm_CreateMagEphemInputFingerprintHdf( file ) < 0 ) {
+                            printf("\t      Could not add input fingerprints to %s\n", HdfOutFile );
+                        }
+                        Existing_H5_Fingerprints = NULL;
+                    }
                     H5Fclose( file );
-printf("nExisting_H5_IsoTimes = %d\n", nExisting_H5_IsoTimes);
-for (i=0; i<nExisting_H5_IsoTimes; i++){
-    printf("Time: %s\n", Existing_H5_IsoTimes[i]);
-}
-//exit(0);
+                    printf("\t      Number of existing times: %d (%s input fingerprints)\n", nExisting_H5_IsoTimes, (Existing_H5_Fingerprints) ? "with" : "without" );
                 }
 
             }
@@ -1455,22 +1549,15 @@ printf("nPerigee = %d, Date, Tmin = %ld %g\n", nPerigee, Date, Tmin );
                     es = (Date == EndDate) ? EndSeconds : 86400;
 
                     med->H5_nT = 0;
+                    nAppended = nRecomputed = 0;
+                    NewTxtRows = ( Update && ( nExisting_H5_IsoTimes > 0 ) ) ? (char **)calloc( nExisting_H5_IsoTimes, sizeof(char *) ) : NULL;
                     Lgm_ElapsedTimeInit( &t, 255, 150, 0 );
                     for ( Seconds=ss; Seconds<=es; Seconds += Delta ) {
 
                         Lgm_Make_UTC( Date, Seconds/3600.0, &UTC, c );
                         Lgm_DateTimeToString( IsoTimeString, &UTC, 0, 0 );
             
-                        /*
-                         * If we are running in append mode, we need to check
-                         * to see if we already have this time in the file.
-                         */
                         et = Lgm_TDBSecSinceJ2000( &UTC, c );
-//printf("et, UpdateAfter_et = %g %g\n", et, UpdateAfter_et);
-                        if ( !Update || WeDontAlreadyHaveThisTime( IsoTimeString, nExisting_H5_IsoTimes, Existing_H5_IsoTimes )  || ( et >= UpdateAfter_et ) ) {
-
-
-
 
 
 // Lets just see what TLE we actually would get by searching...
@@ -1482,6 +1569,39 @@ int tiii = 0;
 //printf("Line1: %s\n", tle[tiii].Line1 );
 //printf("Line2: %s\n", tle[tiii].Line2 );
 
+
+                        /*
+                         * Get the mag model parameters for this time and
+                         * fingerprint all of the inputs that go into the row.
+                         */
+                        if ( FixModelDateTime ) {
+                            Lgm_get_QinDenton_at_JD( ModelDateTime.JD, &p, (Verbosity > 0)? 1 : 0, 1 );
+                        } else {
+                            Lgm_get_QinDenton_at_JD( UTC.JD, &p, (Verbosity > 0)? 1 : 0, 1 );
+                        }
+                        Lgm_MagEphemInputFingerprint( Fingerprint, &tle[tiii], &p, IntModel, ExtModel, Quality, nFLsInDriftShell, ForceKp, FootpointHeight, nAlpha, Alpha, UseEop );
+
+                        /*
+                         * If we are running in update mode, we need to check
+                         * to see if we already have this time in the file. If
+                         * we do, we only recompute it if its inputs have
+                         * changed (or it is after UpdateAfterDateTime), and
+                         * the new values overwrite the old row in place. New
+                         * times get appended.
+                         */
+                        iExisting = ( Update ) ? FindExistingTime( IsoTimeString, nExisting_H5_IsoTimes, Existing_H5_IsoTimes ) : -1;
+                        if ( ( iExisting < 0 ) || ( et >= UpdateAfter_et ) || ( Existing_H5_Fingerprints == NULL ) || ( strcmp( Fingerprint, Existing_H5_Fingerprints[iExisting] ) != 0 ) ) {
+
+                            if ( !Update ) {
+                                iRow = med->H5_nT;
+                            } else if ( iExisting < 0 ) {
+                                iRow = nExisting_H5_IsoTimes + nAppended++;
+                            } else {
+                                iRow = iExisting;
+                                ++nRecomputed;
+                                if ( Verbosity > 0 ) printf("\t[ %s ]: Inputs changed for %s (row %d). Recomputing.\n", ProgramName, IsoTimeString, iRow );
+                            }
+
                             LgmSgp_SGP4_Init( sgp, &tle[tiii] );
 
 
@@ -1506,13 +1626,7 @@ int tiii = 0;
                             }
 
                             // Set mag model parameters
-                            if ( FixModelDateTime ) {
-                                Lgm_get_QinDenton_at_JD( ModelDateTime.JD, &p, (Verbosity > 0)? 1 : 0, 1 );
-                                Lgm_set_QinDenton( &p, MagEphemInfo->LstarInfo->mInfo );
-                            } else {
-                                Lgm_get_QinDenton_at_JD( UTC.JD, &p, (Verbosity > 0)? 1 : 0, 1 );
-                                Lgm_set_QinDenton( &p, MagEphemInfo->LstarInfo->mInfo );
-                            }
+                            Lgm_set_QinDenton( &p, MagEphemInfo->LstarInfo->mInfo );
 
 
                             if ( ForceKp >= 0.0 ) {
@@ -1545,10 +1659,19 @@ int tiii = 0;
                             /*
                              * Open file in append mode.
                              * Write a row of data into the txt file.
+                             * (Rows that are recomputed in update mode are
+                             * kept and swapped into the txt file once the
+                             * day is done.)
                              */
-                            fp_MagEphem = fopen( OutFile, "a" );
-                            Lgm_WriteMagEphemData( fp_MagEphem, IntModel, ExtModel, MagEphemInfo->LstarInfo->mInfo->fKp, MagEphemInfo->LstarInfo->mInfo->Dst, MagEphemInfo );
-                            fclose(fp_MagEphem);
+                            if ( iExisting < 0 ) {
+                                fp_MagEphem = fopen( OutFile, "a" );
+                                Lgm_WriteMagEphemData( fp_MagEphem, IntModel, ExtModel, MagEphemInfo->LstarInfo->mInfo->fKp, MagEphemInfo->LstarInfo->mInfo->Dst, MagEphemInfo );
+                                fclose(fp_MagEphem);
+                            } else {
+                                free( NewTxtRows[iExisting] );
+                                NewTxtRows[iExisting] = MagEphemDataToString( IntModel, ExtModel, MagEphemInfo->LstarInfo->mInfo->fKp, MagEphemInfo->LstarInfo->mInfo->Dst, MagEphemInfo );
+                                if ( NewTxtRows[iExisting] == NULL ) printf("\t[ %s ]: Could not format the txt line for %s\n", ProgramName, IsoTimeString );
+                            }
 
 
 
@@ -1567,6 +1690,7 @@ int tiii = 0;
                             strcpy( med->H5_IsoTimes[ med->H5_nT ], IsoTimeString );
                             strcpy( med->H5_IntModel[ med->H5_nT ], IntModel );
                             strcpy( med->H5_ExtModel[ med->H5_nT ], ExtModel );
+                            strcpy( med->H5_InputFingerprint[ med->H5_nT ], Fingerprint );
                             switch ( MagEphemInfo->FieldLineType ) {
                                 case LGM_OPEN_IMF:
                                                     sprintf( med->H5_FieldLineType[ med->H5_nT ], "%s",  "LGM_OPEN_IMF" ); // FL Type
@@ -1922,10 +2046,8 @@ int tiii = 0;
                              * Open existing HDF5 file in read/write mode.
                              * Write a row of data into the hdf5 file
                              */
-// The nOff
                             file = H5Fopen( HdfOutFile,  H5F_ACC_RDWR, H5P_DEFAULT );
-                            nOffset = ( Update ) ? nExisting_H5_IsoTimes : 0;
-                            Lgm_WriteMagEphemDataHdf( file, med->H5_nT + nOffset, med->H5_nT, med );
+                            Lgm_WriteMagEphemDataHdf( file, iRow, med->H5_nT, med );
                             H5Fclose( file );
                             ++(med->H5_nT);
 
@@ -1937,6 +2059,16 @@ int tiii = 0;
                     }
 
 
+                    if ( Update ) {
+                        printf("\t[ %s ]: Update: %d of %d existing rows recomputed, %d new rows appended.\n", ProgramName, nRecomputed, nExisting_H5_IsoTimes, nAppended );
+                        if ( ( nRecomputed > 0 ) && ( RewriteMagEphemTxtRows( OutFile, nExisting_H5_IsoTimes, NewTxtRows ) != 0 ) ) {
+                            printf("\t[ %s ]: Could not rewrite the recomputed rows in %s. It is out of step with %s; rerun without -U to regenerate it.\n", ProgramName, OutFile, HdfOutFile );
+                        }
+                    }
+                    if ( NewTxtRows ) {
+                        for ( i=0; i<nExisting_H5_IsoTimes; i++ ) free( NewTxtRows[i] );
+                        free( NewTxtRows );
+                    }
                     printf("DONE.\n");
                     Lgm_PrintElapsedTime( &t );
                     Lgm_SetElapsedTimeStr( &t );
@@ -1971,6 +2103,9 @@ int tiii = 0;
                 } //end else
             } // end "if ( !FileExists || Force )" control structure
 
+            if ( Existing_H5_IsoTimes )     LGM_ARRAY_2D_FREE( Existing_H5_IsoTimes );
+            if ( Existing_H5_Fingerprints ) LGM_ARRAY_2D_FREE( Existing_H5_Fingerprints );
+
 
         } // end birds loop
     } // end JD loop
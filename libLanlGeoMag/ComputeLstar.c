@@ -1,4 +1,10 @@
 // THIS CODE REALLY NEEDS CLEANING UP.
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#if USE_OPENMP
+#include <omp.h>
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -15,6 +21,7 @@
 
 void PredictMlat1( double *MirrorMLT, double *MirrorMlat, int k, double MLT, double *pred_mlat, double *pred_delta_mlat, double *delta );
 void PredictMlat2( double *MirrorMLT, double *MirrorMlat, int k, double MLT, double *pred_mlat, double *pred_delta_mlat, double *delta, Lgm_LstarInfo *LstarInfo );
+double InterpShellGuess( double MLT, Lgm_LstarInfo *LstarInfo );
 int FitQuadAndFindZero( double *x, double *y, double *dy, int n, double *res );
 
 /*
@@ -603,6 +610,7 @@ int Lstar( Lgm_Vector *vin, Lgm_LstarInfo *LstarInfo ){
     LstarInfo->LS = LGM_FILL_VALUE;
     LstarInfo->DriftOrbitType = LGM_DRIFT_ORBIT_OPEN;
     LstarInfo->nPnts = 0;
+    LstarInfo->nShellMirror = 0;
 
 
     if ((LstarInfo->PitchAngle < 0.0)||(LstarInfo->PitchAngle>90.0)) return(-1);
@@ -864,6 +872,12 @@ int Lstar( Lgm_Vector *vin, Lgm_LstarInfo *LstarInfo ){
 	        PredictMlat2( MirrorMLT, MirrorMlat, k, MLT, &pred_mlat, &pred_delta_mlat, &delta, LstarInfo );
 	        if (LstarInfo->VerbosityLevel > 2) printf("\t\t%sPredicted mlat2 = %g ( %g : %g )%s ", PreStr, pred_mlat, pred_delta_mlat, delta, PostStr ); fflush(stdout);
 
+            if ( (k < 3) && (LstarInfo->nShellGuess > 2) ) {
+                // Too few lines to predict from yet -- use the shape of the guessed shell instead.
+                pred_mlat = InterpShellGuess( MLT, LstarInfo ) + MirrorMlat[0] - InterpShellGuess( MirrorMLT[0], LstarInfo );
+                if (LstarInfo->VerbosityLevel > 2) printf("\t\t%sPredicted mlat from guessed shell = %g%s ", PreStr, pred_mlat, PostStr ); fflush(stdout);
+            }
+
 	    } else {
 
 	        PredictMlat1( MirrorMLT, MirrorMlat, k, MLT, &pred_mlat, &pred_delta_mlat, &delta );
@@ -879,7 +893,7 @@ int Lstar( Lgm_Vector *vin, Lgm_LstarInfo *LstarInfo ){
         if ( k == 0 ){
             delta           = 0.001;
         } else if ( k < 3 ){
-            delta = 3.0;
+            delta = ( LstarInfo->nShellGuess > 2 ) ? 1.0 : 3.0;
         } else {
             if (nIts > 1) delta = 1.5*fabs( PredMinusActualMlat );
         }
@@ -1152,6 +1166,9 @@ int Lstar( Lgm_Vector *vin, Lgm_LstarInfo *LstarInfo ){
 
         MirrorMLT[k]  = MLT;
         MirrorMlat[k] = mlat;
+        LstarInfo->ShellMirrorMLT[k]  = MLT;
+        LstarInfo->ShellMirrorMlat[k] = mlat;
+        LstarInfo->nShellMirror = k+1;
 
         /*
          *  convert mirror point to GSM.
@@ -1802,6 +1819,31 @@ void PredictMlat1( double *MirrorMLT, double *MirrorMlat, int k, double MLT, dou
 }
 
 
+/*
+ * Linear interpolation (periodic in MLT) of the guessed shell's mirror mlats.
+ * The guessed MLTs are in increasing order and span 24 hours.
+ */
+double InterpShellGuess( double MLT, Lgm_LstarInfo *LstarInfo ) {
+
+    int     j, n = LstarInfo->nShellGuess;
+    double  *x = LstarInfo->ShellGuessMLT, *y = LstarInfo->ShellGuessMlat, x0, x1, y1;
+
+    // map MLT into [x[0], x[0]+24)
+    MLT = x[0] + fmod( fmod( MLT - x[0], 24.0 ) + 24.0, 24.0 );
+
+    for ( j=0; (j < n-1) && (x[j+1] <= MLT); j++ );
+    x0 = x[j];
+    if ( j < n-1 ) {
+        x1 = x[j+1]; y1 = y[j+1];
+    } else {
+        x1 = x[0] + 24.0; y1 = y[0];
+    }
+
+    return( ( x1 > x0 ) ? y[j] + (y1 - y[j])*(MLT - x0)/(x1 - x0) : y[j] );
+
+}
+
+
 /*
  * Given a history of MirrorMLT[] and MirrorMlat[] vals, this routine tries to
  * predict what the next one will be via a periodic akima spine.
@@ -2127,3 +2169,228 @@ int Lgm_LCDS( long int Date, double UTC, double brac1, double brac2, double Kin,
 
 
 
+/*
+ *  Tests whether the drift shell through the point a distance r from the
+ *  Earth in the SM equatorial plane at local time LT (radians) is closed for
+ *  the given K. Test points are placed at -r*(cos(LT), sin(LT)) as in
+ *  Lgm_LCDS(). Returns 1 if the drift shell is closed (and sets *K), 0
+ *  otherwise.
+ */
+static int LCDS_TestRadius( Lgm_DateTime *DT_UTC, double r, double LT, double Kin, double *K, Lgm_LstarInfo *LstarInfo ) {
+
+    Lgm_Vector  v1, v2, v3, Ptest, PtestSM;
+    double      Alpha, nTtoG = 1.0e-5;
+    int         LS_Flag, TFlag, k;
+
+    PtestSM.x = -r*cos(LT); PtestSM.y = -r*sin(LT); PtestSM.z = 0.0;
+    Lgm_Convert_Coords( &PtestSM, &Ptest, SM_TO_GSM, LstarInfo->mInfo->c );
+
+    TFlag = Lgm_Trace( &Ptest, &v1, &v2, &v3, 120.0, 0.01, TRACE_TOL, LstarInfo->mInfo );
+    if ( TFlag != LGM_CLOSED ) {
+        if (LstarInfo->VerbosityLevel > 0) printf("Failed FL trace at r = %g (TFlag = %d)\n", r, TFlag );
+        return( 0 );
+    }
+
+    if ( Lgm_Setup_AlphaOfK( DT_UTC, &v3, LstarInfo->mInfo ) > 0 ) {
+        Alpha = Lgm_AlphaOfK( Kin, LstarInfo->mInfo );
+        Lgm_TearDown_AlphaOfK( LstarInfo->mInfo );
+    } else {
+        Alpha = LGM_FILL_VALUE;
+    }
+    LstarInfo->PitchAngle = Alpha;
+
+    LS_Flag = Lstar( &v3, LstarInfo );
+    if ( (LS_Flag <= 0) && (LstarInfo->LS == LGM_FILL_VALUE) ) {
+        if (LstarInfo->VerbosityLevel > 0) printf("Failed DS trace for alpha = %g (K=%g) at r = %g\n", Alpha, Kin, r );
+        return( 0 );
+    }
+
+    *K = (LstarInfo->I[0])*sqrt(LstarInfo->mInfo->Bm*nTtoG);
+
+    //Determine the type of the orbit
+    LstarInfo->DriftOrbitType = LGM_DRIFT_ORBIT_CLOSED;
+    for ( k=0; k<LstarInfo->nMinMax; ++k ) {
+        if ( LstarInfo->nMinima[k] > 1 ) LstarInfo->DriftOrbitType = LGM_DRIFT_ORBIT_CLOSED_SHABANSKY;
+        if ( LstarInfo->nMinima[k] < 1 ) {
+            if (LstarInfo->VerbosityLevel > 0) printf("Less than one minimum defined on field line at r = %g. Treating drift shell as open.\n", r );
+            return( 0 );
+        }
+    }
+
+    return( 1 );
+
+}
+
+
+/*
+ *  Same as Lgm_LCDS(), but narrows the bracket by testing nDiv equally spaced
+ *  points inside it at a time (in parallel if OpenMP is available) rather than
+ *  one midpoint. Each round shrinks the bracket by a factor of nDiv+1, so
+ *  with nDiv threads far fewer serial rounds are needed than with bisection.
+ *
+ *  The mirror points of the outermost closed shell found so far are handed to
+ *  the next round's Lstar() calls (via ShellGuessMLT/ShellGuessMlat) to speed
+ *  up the shell line searches. If LstarInfo->nShellGuess is set on input
+ *  (e.g. from the ShellMirror values of a previous call), it is used for the
+ *  first round. The guesses only live in the private copies of LstarInfo;
+ *  LstarInfo->nShellGuess is cleared on return so that later Lstar() calls
+ *  with the same structure do not use a guess meant for this search.
+ *
+ *  Since adjacent calls (e.g. consecutive times or K values) usually have
+ *  nearby LCDSs, callers can pass a narrow bracket around a previous rLCDS;
+ *  -8 or -9 is returned if it turns out not to bracket the LCDS.
+ *
+ *      Input Variables:
+ *
+ *                      Date:
+ *                       UTC:
+ *                     brac1:  Radial distance for inner edge of search bracket
+ *                     brac2:  Radial distance for outer edge of search bracket
+ *                       Kin:  K value to compute LCDS for
+ *                        LT:  Local time (hours) of the equatorial search line
+ *                       tol:  Tolerance on the radial distance of the LCDS
+ *                   Quality:  Quality factor (0-8)
+ *          nFLsInDriftShell:  Number of field lines to use in each drift shell
+ *                      nDiv:  Number of test points per round (e.g. the number of threads)
+ *
+ *      Output Variables:
+ *                         K:  K value for LCDS
+ *                     rLCDS:  Radial distance of the LCDS along the search line
+ *                 LstarInfo:  LS, DriftOrbitType, mInfo->Bm and the ShellMirror
+ *                             values are set for the LCDS; nShellGuess is
+ *                             set to 0.
+ *
+ *      Returns 0 on success, -8 for a bad inner bracket, -9 for a bad outer
+ *      bracket and -2 if the tolerance was not achieved.
+ */
+int Lgm_LCDS_KSection( long int Date, double UTC, double brac1, double brac2, double Kin, double LT, double tol, int Quality, int nFLsInDriftShell, int nDiv, double *K, double *rLCDS, Lgm_LstarInfo *LstarInfo ) {
+
+    Lgm_LstarInfo   **Info;
+    Lgm_DateTime    DT_UTC;
+    double          *r, *Kr, rin, rout, LCDS;
+    int             *Closed, nInfo, i, nn, RetVal;
+    int             maxIter = 20;
+
+    if ( nDiv < 1 ) nDiv = 1;
+    nInfo = ( nDiv > 2 ) ? nDiv : 2;
+
+    Lgm_Make_UTC( Date, UTC, &DT_UTC, LstarInfo->mInfo->c );
+    LT *= 15.0*RadPerDeg;
+
+    /*
+     *  Allocate the LstarInfo copies once for all rounds.
+     */
+    Info   = (Lgm_LstarInfo **)calloc( nInfo, sizeof(Lgm_LstarInfo *) );
+    r      = (double *)calloc( nInfo, sizeof(double) );
+    Kr     = (double *)calloc( nInfo, sizeof(double) );
+    Closed = (int *)calloc( nInfo, sizeof(int) );
+    for ( i=0; i<nInfo; i++ ) {
+        Info[i] = Lgm_CopyLstarInfo( LstarInfo );
+        Lgm_SetLstarTolerances( Quality, nFLsInDriftShell, Info[i] );
+        Lgm_Set_Coord_Transforms( Date, UTC, Info[i]->mInfo->c );
+    }
+
+    /*
+     *  Test inner and outer brackets.
+     */
+    rin  = fabs( brac1 );
+    rout = fabs( brac2 );
+    r[0] = rin; r[1] = rout;
+#if USE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for ( i=0; i<2; i++ ) Closed[i] = LCDS_TestRadius( &DT_UTC, r[i], LT, Kin, &Kr[i], Info[i] );
+
+    RetVal = 0;
+    if ( !Closed[0] ) {
+        if (LstarInfo->VerbosityLevel > 0) printf("Undefined DS at inner bracket (r = %g)\n", rin );
+        RetVal = -8;
+    } else if ( Closed[1] ) {
+        // move outer bracket out and try again
+        rout *= 1.7;
+        if ( LCDS_TestRadius( &DT_UTC, rout, LT, Kin, &Kr[1], Info[1] ) ) {
+            if (LstarInfo->VerbosityLevel > 0) printf("Defined DS at outer bracket (r = %g)\n", rout );
+            RetVal = -9;
+        }
+    }
+
+    if ( RetVal == 0 ) {
+
+        /*
+         *  Inner bracket is the current best estimate.
+         */
+        *rLCDS = rin;
+        *K     = Kr[0];
+        LCDS   = Info[0]->LS;
+        LstarInfo->mInfo->Bm      = Info[0]->mInfo->Bm;
+        LstarInfo->DriftOrbitType = Info[0]->DriftOrbitType;
+        LstarInfo->nShellMirror   = Info[0]->nShellMirror;
+        memcpy( LstarInfo->ShellMirrorMLT,  Info[0]->ShellMirrorMLT,  Info[0]->nShellMirror*sizeof(double) );
+        memcpy( LstarInfo->ShellMirrorMlat, Info[0]->ShellMirrorMlat, Info[0]->nShellMirror*sizeof(double) );
+
+        nn = 0;
+        while ( rout - rin > tol ) {
+
+            if (LstarInfo->VerbosityLevel > 2) printf("Current LCDS iteration, bracket = %d, [%g, %g]\n", nn, rin, rout );
+            if ( nn > maxIter ) {
+                printf("********* EXCEEDED MAXITER\n");
+                RetVal = -2;
+                break;
+            }
+
+            /*
+             *  Test nDiv equally spaced points inside the bracket.
+             */
+            for ( i=0; i<nDiv; i++ ) {
+                r[i] = rin + (i+1)*(rout-rin)/(double)(nDiv+1);
+                Info[i]->nShellGuess = LstarInfo->nShellMirror;
+                memcpy( Info[i]->ShellGuessMLT,  LstarInfo->ShellMirrorMLT,  LstarInfo->nShellMirror*sizeof(double) );
+                memcpy( Info[i]->ShellGuessMlat, LstarInfo->ShellMirrorMlat, LstarInfo->nShellMirror*sizeof(double) );
+            }
+#if USE_OPENMP
+            #pragma omp parallel for schedule(dynamic, 1)
+#endif
+            for ( i=0; i<nDiv; i++ ) Closed[i] = LCDS_TestRadius( &DT_UTC, r[i], LT, Kin, &Kr[i], Info[i] );
+
+            /*
+             *  The new bracket is the first open point and the last closed
+             *  point before it.
+             */
+            for ( i=0; i<nDiv; i++ ) {
+                if ( !Closed[i] ) {
+                    rout = r[i];
+                    break;
+                }
+                rin    = r[i];
+                *rLCDS = r[i];
+                *K     = Kr[i];
+                LCDS   = Info[i]->LS;
+                LstarInfo->mInfo->Bm      = Info[i]->mInfo->Bm;
+                LstarInfo->DriftOrbitType = Info[i]->DriftOrbitType;
+                LstarInfo->nShellMirror   = Info[i]->nShellMirror;
+                memcpy( LstarInfo->ShellMirrorMLT,  Info[i]->ShellMirrorMLT,  Info[i]->nShellMirror*sizeof(double) );
+                memcpy( LstarInfo->ShellMirrorMlat, Info[i]->ShellMirrorMlat, Info[i]->nShellMirror*sizeof(double) );
+            }
+            if (LstarInfo->VerbosityLevel > 0) printf("Current LCDS, K, r is %g, %g, %g\n", LCDS, *K, *rLCDS );
+
+            nn++;
+        }
+
+        if (LstarInfo->VerbosityLevel > 0) printf("Final LCDS, K is %g, %g. Eq. radius = %g \n", LCDS, *K, *rLCDS );
+        LstarInfo->LS = LCDS;
+
+    }
+
+    // the input guess (if any) has been used up
+    LstarInfo->nShellGuess = 0;
+
+    //free structures
+    for ( i=0; i<nInfo; i++ ) FreeLstarInfo( Info[i] );
+    free( Info );
+    free( r );
+    free( Kr );
+    free( Closed );
+
+    return( RetVal );
+
+}
@@ -0,0 +1,131 @@
+#ifndef LGM_ARENA_H
+#define LGM_ARENA_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ *  Arenas (bump allocators) for the LGM_ARRAY_* macros.
+ *
+ *  The LGM_ARRAY_nD() macros get their memory from Lgm_Calloc() and give it
+ *  back with Lgm_Free(). Normally these are just calloc() and free(). But if
+ *  an arena has been bound to the calling thread (with Lgm_Arena_Bind()),
+ *  Lgm_Calloc() carves the memory out of the arena instead (zeroed, and
+ *  aligned to LGM_ARENA_ALIGN bytes), and Lgm_Free() of arena memory does
+ *  nothing. All of the arena memory is then released at once with
+ *  Lgm_Arena_Reset() (or back to a mark with Lgm_Arena_Release()). The
+ *  arena keeps its chunks, so a loop that allocates and frees the same
+ *  temporary arrays over and over stops calling malloc() after its first
+ *  pass. A typical use would be:
+ *
+ *      Lgm_Arena       *a = Lgm_Arena_Create( "Fits", 0 );
+ *      Lgm_Arena       *Prev;
+ *      Lgm_ArenaMark    Mark;
+ *
+ *      Prev = Lgm_Arena_Bind( a );
+ *      for ( i=0; i<n; i++ ) {
+ *          Mark = Lgm_Arena_Mark( a );
+ *              ... code that uses LGM_ARRAY_* macros for temporaries ...
+ *          Lgm_Arena_Release( a, Mark );
+ *      }
+ *      Lgm_Arena_Bind( Prev );
+ *      Lgm_Arena_PrintStats( a, stdout );
+ *      Lgm_Arena_Destroy( a );
+ *
+ *  Arrays that are allocated while an arena is bound belong to the arena;
+ *  they must not be used past the next Reset/Release/Destroy of it.
+ *  LGM_ARRAY_*_FREE (i.e. Lgm_Free()) is fine at any time, even after the
+ *  arena has been destroyed: it never looks at arena memory, so it is a
+ *  no-op for it. Arena memory must not be given to plain free().
+ *
+ *  With no arena bound, Lgm_Calloc() and Lgm_Free() are plain calloc() and
+ *  free(), so heap arrays can be mixed freely with code that uses calloc()
+ *  and free() directly (as the LGM_ARRAY_FROM_DATA_* macros and their
+ *  callers do). The LGM_ARRAY_FROM_DATA_* macros never use arenas.
+ *
+ *  Lgm_Free() tells the two apart from the pointer alone (no locks, no list
+ *  of arenas to search, and without reading the memory): all arena chunks
+ *  are carved out of a single range of address space that is reserved once
+ *  and never handed to malloc(), see Lgm_Arena_IsArenaMem().
+ *
+ *  Every arena keeps track of how many bytes it has handed out in total and
+ *  the most it has had in use at any one time (see Lgm_Arena_PrintStats()).
+ *  If Lgm_Arena_Instrument( TRUE ) has been called, the same is done for
+ *  the Lgm_Calloc() calls that go to the heap, so that the benefit of an
+ *  arena can be judged before using one.
+ */
+#define LGM_ARENA_ALIGN             64
+#define LGM_ARENA_DEFAULT_CHUNK     (1<<20)
+
+/*
+ *  TRUE if p is arena memory (from any arena, live or not).
+ */
+#define LGM_IS_ARENA_MEM( p )       Lgm_Arena_IsArenaMem( (void *)(p) )
+
+typedef struct Lgm_ArenaChunk {
+
+    struct Lgm_ArenaChunk   *Next;
+    unsigned char           *Mem;       // Start of the chunk (page aligned)
+    unsigned char           *Data;      // Where allocations start (same as Mem)
+    size_t                  Size;       // Usable bytes at Data
+    size_t                  Used;       // Bytes in use
+
+} Lgm_ArenaChunk;
+
+typedef struct Lgm_ArenaMark {
+
+    Lgm_ArenaChunk          *Chunk;
+    size_t                  Used;
+    size_t                  InUse;
+
+} Lgm_ArenaMark;
+
+typedef struct Lgm_Arena {
+
+    char                    Name[64];
+    size_t                  ChunkSize;  // Size of new chunks (bigger requests get a chunk of their own size)
+    Lgm_ArenaChunk          *First;     // First chunk
+    Lgm_ArenaChunk          *Current;   // Chunk currently being allocated from
+
+    size_t                  InUse;      // Bytes currently in use
+    size_t                  PeakBytes;  // Most bytes in use at once
+    size_t                  TotalBytes; // Bytes allocated in total
+    size_t                  ChunkBytes; // Bytes held in chunks
+    long int                nAllocs;    // Number of allocations
+    long int                nResets;    // Number of Resets/Releases
+    int                     nChunks;    // Number of chunks
+
+} Lgm_Arena;
+
+/*
+ * Heap statistics kept by Lgm_Calloc() when instrumented.
+ */
+typedef struct Lgm_HeapStats {
+
+    size_t                  InUse;
+    size_t                  PeakBytes;
+    size_t                  TotalBytes;
+    long int                nAllocs;
+
+} Lgm_HeapStats;
+
+
+Lgm_Arena      *Lgm_Arena_Create( const char *Name, size_t ChunkSize );
+void            Lgm_Arena_Destroy( Lgm_Arena *a );
+void            Lgm_Arena_Reset( Lgm_Arena *a );
+Lgm_ArenaMark   Lgm_Arena_Mark( Lgm_Arena *a );
+void            Lgm_Arena_Release( Lgm_Arena *a, Lgm_ArenaMark Mark );
+void           *Lgm_Arena_Alloc( Lgm_Arena *a, size_t n, size_t size );
+int             Lgm_Arena_Owns( Lgm_Arena *a, void *p );
+int             Lgm_Arena_IsArenaMem( void *p );
+Lgm_Arena      *Lgm_Arena_Bind( Lgm_Arena *a );
+Lgm_Arena      *Lgm_Arena_Current( void );
+void            Lgm_Arena_PrintStats( Lgm_Arena *a, FILE *fp );
+void            Lgm_Arena_Instrument( int Flag );
+void            Lgm_Arena_GetHeapStats( Lgm_HeapStats *s );
+
+void           *Lgm_Calloc( size_t n, size_t size );
+void            Lgm_Free( void *p );
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef LGM_B_GRID_H
+#define LGM_B_GRID_H
+
+#include "Lgm/Lgm_MagModelInfo.h"
+
+/*
+ *  Gridded (precomputed) copy of a magnetic field model.
+ *
+ *  The external part of a field model (i.e. the model minus the internal
+ *  field) is sampled for a frozen set of model parameters onto an adaptively
+ *  refined (octree) grid in GSM. Each leaf cell holds a 4x4x4 lattice of
+ *  samples and is interpolated with tricubic Lagrange polynomials. The
+ *  internal field is always evaluated directly, since it is the part with the
+ *  steep gradients near the Earth and it is not expensive.
+ *
+ *  Cells are refined until the interpolation error (checked against the
+ *  direct model at test points inside each cell) is below Tol, or until
+ *  MaxLevel is reached. Outside the grid box, and in leaves that still fail
+ *  the test at MaxLevel (or that have non-finite samples, as next to the
+ *  origin), the direct model is used.
+ *
+ *  No derivatives are stored, so the interpolant is only continuous to
+ *  within about Tol where leaves of different sizes meet, and it is not
+ *  divergence-free by construction.
+ */
+typedef struct Lgm_B_GridCell {
+
+    double      x0, y0, z0;     // Lower corner of cell (GSM, Re)
+    double      h;              // Size of cell (Re)
+    int         Child;          // Index of first of 8 children in Cells[] (-1 if this is a leaf)
+    long int    iData;          // Offset into Data[] of this leaf's 4x4x4x3 samples (-1 if not a leaf, -2 if the source model is used directly)
+
+} Lgm_B_GridCell;
+
+typedef struct Lgm_B_GridInfo {
+
+    double          xmin, xmax;     // Extent of grid box (GSM, Re)
+    double          ymin, ymax;
+    double          zmin, zmax;
+    double          h0;             // Size of top-level cells
+    int             nx, ny, nz;     // Number of top-level cells in each direction
+
+    double          Tol;            // Requested max error (nT) of each B component
+    int             MaxLevel;       // Max number of refinements of a top-level cell
+
+    int             nCells;         // Total number of cells (the first nx*ny*nz are the top-level ones)
+    int             nLeaves;        // Number of leaf cells
+    int             nDirect;        // Number of leaves that use the source model directly
+    Lgm_B_GridCell  *Cells;
+    long int        nData;          // Number of doubles in Data[]
+    double          *Data;          // Samples of external B for all leaves
+
+    double          MaxErr;         // Largest error found at the test points of the interpolated leaves during the build (nT)
+    long int        nBuildEvals;    // Number of model evaluations made during the build
+    double          BuildTime;      // Wall clock time taken to build the grid (s)
+    size_t          nBytes;         // Memory used by the grid
+
+    int             (*Bsrc)();      // The model that was gridded
+    int             InternalModel;  // The internal model that was subtracted off (and is added back on)
+
+} Lgm_B_GridInfo;
+
+
+Lgm_B_GridInfo *Lgm_B_Grid_Build( double xmin, double xmax, double ymin, double ymax, double zmin, double zmax,
+                                  double h0, double Tol, int MaxLevel, Lgm_MagModelInfo *m );
+void            Lgm_B_Grid_Free( Lgm_B_GridInfo *g );
+int             Lgm_B_Grid( Lgm_Vector *v, Lgm_Vector *B, Lgm_MagModelInfo *Info );
+int             Lgm_B_Grid_Internal( Lgm_Vector *v, Lgm_Vector *B, int InternalModel, Lgm_MagModelInfo *Info );
+double          Lgm_B_Grid_CheckError( Lgm_B_GridInfo *g, int n, Lgm_MagModelInfo *m );
+void            Lgm_B_Grid_Report( Lgm_B_GridInfo *g );
+void            Lgm_Set_Lgm_B_Grid( Lgm_B_GridInfo *g, Lgm_MagModelInfo *m );
+
+#endif
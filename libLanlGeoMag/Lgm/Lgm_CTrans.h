@@ -17,6 +17,8 @@
 #include "Lgm_Vec.h"
 #include "Lgm_WGS84.h"
 #include "Lgm_JPLeph.h"
+#include "Lgm_SHCoeffs.h"
+#include "Lgm_SunMoonCheb.h"
 
 #define DegPerRad       57.295779513082320876798154814105
 #define RadPerDeg        0.017453292519943295769236907568
@@ -88,6 +90,12 @@
 #define LGM_TIME_SYS_TDB    4
 #define LGM_TIME_SYS_UT1    5
 
+/*
+ * Units for Lgm_ConvertTimeArray()
+ */
+#define LGM_TIME_JD         0   // Julian Date
+#define LGM_TIME_SECONDS    1   // TaiSeconds, GpsSeconds or seconds since J2000 (TT and TDB)
+
 
 
 /*
@@ -497,6 +505,10 @@ typedef struct Lgm_LeapSeconds {
 
     double      *LeapSeconds;       //!< The actual number of leap seconds that  went into effect on the given date
 
+    int         Shared;             //!< TRUE if the arrays belong to the shared table (see Lgm_SharedLeapSeconds()) and must not be freed
+
+    int         Hint;               //!< Index of the last interval found by Lgm_LeapSecondIndex()
+
 
 } Lgm_LeapSeconds;
 
@@ -548,6 +560,26 @@ typedef struct Lgm_DateTime {
 
 
 
+/*
+ *  Schmidt normalization factors and recursion coefficients used by the
+ *  spherical harmonic field models (up to degree and order 13).
+ */
+typedef struct Lgm_IGRF_Tables {
+
+    double      R[14][14];
+    double      K[14][14];
+    double      S[14][14];
+    double      TwoNm1_Over_NmM[14][14];
+    double      NpMm1_Over_NmM[14][14];
+    double      SqrtNM1[14][14];
+    double      SqrtNM2[14][14];
+    double      CartA[15][15];  // [m][n] = (2n-1)/(n-m) for the Cartesian solid harmonic recursion (up to degree 14)
+    double      CartB[15][15];  // [m][n] = (n+m-1)/(n-m)
+
+} Lgm_IGRF_Tables;
+
+
+
 typedef struct Lgm_CTrans {
 
     int               Verbose;
@@ -556,6 +588,7 @@ typedef struct Lgm_CTrans {
 
     Lgm_JPLephemInfo *jpl;          //!< Structure containing JPL Ephem info
     int              jpl_initialized;  //!< Flag to indicate jpl has been initialized
+    Lgm_JPLephemCache jplCache;     //!< Current DE records for the Sun, Earth-Moon barycenter and Moon
 
     Lgm_DateTime     UT1;           //!< A corrected version of UT0.
                                     /**< A corrected version of UT0.
@@ -782,13 +815,44 @@ typedef struct Lgm_CTrans {
     double      Lgm_IGRF_OldYear;
     double      Lgm_IGRF_g[14][14];
     double      Lgm_IGRF_h[14][14];
-    double      Lgm_IGRF_R[14][14];
-    double      Lgm_IGRF_K[14][14];
-    double      Lgm_IGRF_S[14][14];
-    double      Lgm_IGRF_TwoNm1_Over_NmM[14][14];
-    double      Lgm_IGRF_NpMm1_Over_NmM[14][14];
-    double      Lgm_IGRF_SqrtNM1[14][14];
-    double      Lgm_IGRF_SqrtNM2[14][14];
+
+    /*
+     *  Coefficients of the V_n,m and W_n,m solid harmonics (n = 2..14) in
+     *  Bx, By and Bz for Lgm_IGRF_Cart(), stored as CartCoeffs[k][m][n] with
+     *  k = 0..5 for Cx, Sx, Cy, Sy, Cz, Sz. Rebuilt whenever the IGRF coeffs
+     *  change.
+     */
+    double      Lgm_IGRF_CartYear;
+    double      Lgm_IGRF_CartCoeffs[6][15][15];
+
+    /*
+     *  Optional coefficient set to use instead of the built-in IGRF (see
+     *  Lgm_Set_SHCoeffs()). SHCoeffs is not owned by this structure;
+     *  SHC_Fold holds the gradient coeffs folded for day SHC_Date.
+     */
+    Lgm_SHCoeffs    *SHCoeffs;
+    long int        SHC_Date;
+    int             SHC_nFold;
+    double          *SHC_Fold;
+
+    /*
+     *  Optional precomputed Sun/Moon positions to use instead of evaluating
+     *  the ephemeris model (see Lgm_Set_SunMoonCheb()). Not owned by this
+     *  structure.
+     */
+    Lgm_SunMoonCheb *SunMoonCheb;
+
+    /*
+     *  These only depend on (n, m), so they point into the process-wide
+     *  tables returned by Lgm_IGRF_SharedTables() (and are never written to).
+     */
+    double      (*Lgm_IGRF_R)[14];
+    double      (*Lgm_IGRF_K)[14];
+    double      (*Lgm_IGRF_S)[14];
+    double      (*Lgm_IGRF_TwoNm1_Over_NmM)[14];
+    double      (*Lgm_IGRF_NpMm1_Over_NmM)[14];
+    double      (*Lgm_IGRF_SqrtNM1)[14];
+    double      (*Lgm_IGRF_SqrtNM2)[14];
 
 
 
@@ -865,6 +929,8 @@ Lgm_DateTime *Lgm_DateTime_Create( int Year, int Month, int Day, double Time, in
 void          Lgm_DateTime_Destroy( Lgm_DateTime *d );
 int           Lgm_Make_UTC( long int Date, double Time, Lgm_DateTime *UTC, Lgm_CTrans *c );
 int           Lgm_LoadLeapSeconds( Lgm_CTrans *c );
+Lgm_LeapSeconds *Lgm_SharedLeapSeconds( void );
+int           Lgm_LeapSecondIndex( double JD, Lgm_LeapSeconds *l );
 double        Lgm_GetLeapSeconds( double JD, Lgm_CTrans *c );
 int           Lgm_IsLeapSecondDay( long int Date, double *SecondsInDay, Lgm_CTrans *c );
 void          Lgm_UTC_to_TAI( Lgm_DateTime *UTC, Lgm_DateTime *TAI, Lgm_CTrans *c );
@@ -930,6 +996,8 @@ void    Lgm_TTSecSinceJ2000_to_TT( double TTSeconds, Lgm_DateTime *TT ) ;
 void    Lgm_TTSecSinceJ2000_to_UTC( double TTSeconds, Lgm_DateTime *UTC, Lgm_CTrans *c ) ;
 double  Lgm_UTC_to_TTSecSinceJ2000( Lgm_DateTime *UTC, Lgm_CTrans *c ) ;
 
+int     Lgm_ConvertTimeArray( long int n, double *In, int InSys, int InUnits, double *Out, int OutSys, int OutUnits, Lgm_CTrans *c );
+
 
 
 //double      Lgm_UTC_to_TT( double
@@ -964,11 +1032,22 @@ void    _Lgm_IGRF( Lgm_Vector *, Lgm_Vector *, Lgm_CTrans * );
 void    _Lgm_IGRF2( Lgm_Vector *, Lgm_Vector *, Lgm_CTrans * );
 void    _Lgm_IGRF3( Lgm_Vector *, Lgm_Vector *, Lgm_CTrans * );
 void    _Lgm_IGRF4( Lgm_Vector *, Lgm_Vector *, Lgm_CTrans * );
+void    Lgm_IGRF_Cart( Lgm_Vector *, Lgm_Vector *, Lgm_CTrans * );
+void    Lgm_IGRF_InitCart( Lgm_CTrans * );
+void    Lgm_IGRF_Cart_Jacobian( Lgm_Vector *u, Lgm_Vector *B, double J[3][3], Lgm_CTrans *c );
+void    Lgm_Set_SHCoeffs( Lgm_SHCoeffs *s, Lgm_CTrans *c );
+void    Lgm_SHCoeffs_B( Lgm_Vector *u, Lgm_Vector *B, Lgm_CTrans *c );
+Lgm_SunMoonCheb *Lgm_SunMoonCheb_Create( Lgm_DateTime *Start, Lgm_DateTime *End, double SegDays, int Order, double Tol, Lgm_CTrans *c );
+int     Lgm_Set_SunMoonCheb( Lgm_SunMoonCheb *s, Lgm_CTrans *c );
+int     Lgm_SunMoonCheb_Sun( Lgm_CTrans *c );
+int     Lgm_SunMoonCheb_Moon( Lgm_CTrans *c );
 
 void   Lgm_InitdPnm( double P[14][14], double dP[14][14], int N, Lgm_CTrans *c );
 void   Lgm_InitSqrtFuncs( double SqrtNM1[14][14], double SqrtNM2[14][14], int N );
 void   Lgm_InitK( double K[14][14], int N );
 void   Lgm_InitS( double S[14][14], int N );
+Lgm_IGRF_Tables *Lgm_IGRF_SharedTables( void );
+void   Lgm_IGRF_AttachTables( Lgm_CTrans *c );
 
 
 /*
@@ -0,0 +1,89 @@
+#ifndef LGM_DXX_TABLE_H
+#define LGM_DXX_TABLE_H
+
+#include "Lgm/Lgm_SummersDiffCoeff.h"
+#include "Lgm/Lgm_HDF5.h"
+
+/*
+ *  Tables of bounce-averaged diffusion coefficients.
+ *
+ *  Daa, Dap and Dpp are computed on a uniform grid in (L, log10(Ek), Alpha0)
+ *  and then looked up with a tensor product of 1D monotone (Steffen) cubic
+ *  interpolants. The interpolant goes through the tabulated values, is C1,
+ *  and never overshoots the data (so e.g. Daa and Dpp can't go negative
+ *  between grid points).
+ *
+ *  The coefficients at each grid point come from a user-supplied function
+ *  (Lgm_DxxTable_SummersFunc() is provided for the Summers [2005, 2007]
+ *  coefficients). Since the cost per point varies a lot (it is large near the
+ *  resonance singularities and zero outside of the resonance region), the
+ *  points are handed out to the threads one at a time.
+ *
+ *  Tables can be cached in HDF5 files. A cached table is only used if its
+ *  grid and its Key string (a description of the wave model supplied by the
+ *  caller) match the ones requested.
+ */
+
+#define LGM_DXX_TABLE_KEY_LENGTH    1024
+
+/*
+ *  Function that computes bounce-averaged Daa, Dap and Dpp (in s^-1) at
+ *  (L, Ek [MeV], Alpha0 [degrees]). Returns a negative value on failure.
+ */
+typedef int (*Lgm_DxxFunc)( double L, double Ek, double Alpha0, double *Daa, double *Dap, double *Dpp, void *Data );
+
+typedef struct Lgm_DxxTable {
+
+    int         nL, nE, nA;             // Number of grid points in L, log10(Ek) and Alpha0
+    double      L0, L1, dL;             // L grid
+    double      logEk0, logEk1, dlogEk; // log10(Ek/MeV) grid
+    double      Alpha00, Alpha01, dAlpha0; // Equatorial pitch angle grid (degrees)
+
+    double      ***Daa;                 // Daa[iL][iE][iA] (s^-1)
+    double      ***Dap;                 // Dap[iL][iE][iA] (s^-1)
+    double      ***Dpp;                 // Dpp[iL][iE][iA] (s^-1; normalized as returned by the DxxFunc)
+
+    char        Key[LGM_DXX_TABLE_KEY_LENGTH];  // Description of the wave model the table was built for
+
+    int         nFail;                  // Number of grid points where the DxxFunc failed (set to zero there)
+    double      BuildTime;              // Wall clock time taken to build the table (s)
+    int         FromCache;              // TRUE if the table was read from a cache file
+
+} Lgm_DxxTable;
+
+
+/*
+ *  Parameters for Lgm_DxxTable_SummersFunc(). Frequencies are given as
+ *  fractions of the equatorial electron gyrofrequency, so that the same
+ *  wave model can be applied at every L.
+ */
+typedef struct Lgm_DxxTable_SummersParams {
+
+    int         Version;                // LGM_SUMMERS_2005 or LGM_SUMMERS_2007
+    int         WaveMode;               // LGM_R_MODE_WAVE or LGM_L_MODE_WAVE
+    int         Species;                // LGM_ELECTRONS or LGM_PROTONS
+    int         Directions;             // LGM_FRWD, LGM_BKWD or LGM_FRWD_BKWD
+    double      n1, n2, n3;             // Ion composition (n1+n2+n3 = 1; only used for LGM_SUMMERS_2007)
+    double      aStarEq;                // Cold plasma parameter at the equator (used if aStarEqFunc is NULL)
+    double      (*aStarEqFunc)( double L, void *Data ); // Optional aStarEq as a function of L
+    double      w1, w2, wm, dw;         // Frequency cutoffs, peak and width (fractions of the equatorial electron gyrofrequency)
+    double      MaxWaveLat;             // Latitudinal extent of the waves (degrees)
+    void        *BwFuncData;            // Data for BwFunc
+    double      (*BwFunc)( double, void * ); // Wave amplitude (nT) as a function of latitude
+
+} Lgm_DxxTable_SummersParams;
+
+
+Lgm_DxxTable    *Lgm_DxxTable_Alloc( int nL, double L0, double L1, int nE, double logEk0, double logEk1, int nA, double Alpha00, double Alpha01 );
+void             Lgm_DxxTable_Free( Lgm_DxxTable *t );
+int              Lgm_DxxTable_Fill( Lgm_DxxTable *t, Lgm_DxxFunc DxxFunc, void *Data, int Verbosity );
+Lgm_DxxTable    *Lgm_DxxTable_Build( int nL, double L0, double L1, int nE, double logEk0, double logEk1, int nA, double Alpha00, double Alpha01,
+                                     Lgm_DxxFunc DxxFunc, void *Data, char *Key, char *CacheFile, int Verbosity );
+int              Lgm_DxxTable_Eval( Lgm_DxxTable *t, double L, double Ek, double Alpha0, double *Daa, double *Dap, double *Dpp );
+int              Lgm_DxxTable_Write( char *Filename, Lgm_DxxTable *t );
+Lgm_DxxTable    *Lgm_DxxTable_Read( char *Filename );
+
+int              Lgm_DxxTable_SummersFunc( double L, double Ek, double Alpha0, double *Daa, double *Dap, double *Dpp, void *Data );
+void             Lgm_DxxTable_SummersKey( Lgm_DxxTable_SummersParams *p, char *BwDescription, char *Key );
+
+#endif
@@ -6,7 +6,7 @@
  *  sets of macros here:
  *          
  *      1) Macros that allocate the contiguous block of memory for you (via
- *         calloc - so memory is initialized to zeros). These are:
+ *         Lgm_Calloc - so memory is initialized to zeros). These are:
  *
  *              LGM_ARRAY_1D( A, n1, type );
  *              LGM_ARRAY_2D( A, n1, n2, type );
@@ -36,6 +36,13 @@
  *                  ... do stuff ...
  *              LGM_ARRAY_2D_FREE( A );
  *
+ *          Lgm_Calloc() is just calloc() unless an arena has been bound to
+ *          the calling thread, in which case the memory comes out of the
+ *          arena (see Lgm_Arena.h). Loops that make and free the same
+ *          temporary arrays many times can use this to avoid the heap.
+ *          Arrays that may have come from an arena must be freed with the
+ *          macros below, not with plain free().
+ *
  *      2) Macros to free the arrays. We saw examples of there use above. The Macros are:
  *
  *              LGM_ARRAY_1D_FREE( A );
@@ -44,9 +51,17 @@
  *              LGM_ARRAY_4D_FREE( A );
  *              LGM_ARRAY_5D_FREE( A );
  *
+ *          Arrays that came from an arena are left alone as a whole (their
+ *          pointer arrays are not even read, since the arena may already
+ *          have been reset or destroyed). Heap arrays are free()'d, so the
+ *          macros also work on arrays whose blocks were calloc()'d directly,
+ *          as in 3) below.
+ *
  *      3) Macros that define the array structure for you, but require the user
  *         to provide a pointer to an already allocated contiguous block of
- *         memory. (Use the same FREE macros).
+ *         memory. (The same FREE macros can be used if the block was
+ *         calloc()'d, or the LGM_ARRAY_FROM_DATA_*_FREE macros, which leave
+ *         the block to the caller.)
  *
  *              LGM_ARRAY_FROM_DATA_1D( A, n1, type );
  *              LGM_ARRAY_FROM_DATA_2D( A, n1, n2, type );
@@ -115,6 +130,7 @@
 #if !defined(__APPLE__)
 #include <malloc.h>
 #endif
+#include "Lgm/Lgm_Arena.h"
 
 /*
  * Macros for dynamically allocating/freeing 1D arrays of any type
@@ -122,7 +138,7 @@
 #define LGM_ARRAY_1D( prow, col, type ) {\
     register type *pdata;\
     if ( col < 1 ) { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (col = %d)\n", (int)(col) ); exit(1); }\
-    pdata = (type *)calloc( (col), sizeof( type ) );\
+    pdata = (type *)Lgm_Calloc( (col), sizeof( type ) );\
     if ( pdata == (type *)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_1D Macro: Could not allocate space for data\n");\
         exit(1);\
@@ -131,7 +147,7 @@
 }\
 
 #define LGM_ARRAY_1D_FREE( pdata ) {\
-    free( pdata );\
+    Lgm_Free( pdata );\
 }\
 
 
@@ -143,12 +159,12 @@
     int      mi;\
     if ( row < 1 ) { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (row = %d)\n", (int)(row) ); exit(1); }\
     if ( col < 1 ) { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (col = %d)\n", (int)(col) ); exit(1); }\
-    pdata = (type *)calloc( (row)*(col), sizeof( type ) );\
+    pdata = (type *)Lgm_Calloc( (row)*(col), sizeof( type ) );\
     if ( pdata == (type *)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_2D Macro: Could not allocate space for data\n");\
         exit(1);\
     }\
-    prow = (type **)calloc( (row), sizeof( type * ));\
+    prow = (type **)Lgm_Calloc( (row), sizeof( type * ));\
     if ( prow == (type **)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_2D Macro: Could not allocate space for row pointers\n");\
         exit(1);\
@@ -160,8 +176,10 @@
 }\
 
 #define LGM_ARRAY_2D_FREE( prow ) {\
-    free( *prow );\
-    free( prow );\
+    if ( ( prow != NULL ) && !LGM_IS_ARENA_MEM( prow ) ) {\
+        Lgm_Free( *prow );\
+        Lgm_Free( prow );\
+    }\
 }\
 
 
@@ -175,17 +193,17 @@
     if ( row < 1 )  { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (row = %d)\n", (int)(row) ); exit(1); }\
     if ( col < 1 )  { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (col = %d)\n", (int)(col) ); exit(1); }\
     if ( grid < 1 ) { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (grid = %d)\n", (int)(grid) ); exit(1); }\
-    pdata = (type *)calloc( (grid)*(row)*(col), sizeof( type ) );\
+    pdata = (type *)Lgm_Calloc( (grid)*(row)*(col), sizeof( type ) );\
     if ( pdata == (type *)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_3D Macro: Could not allocate space for data\n");\
         exit(1);\
     }\
-    prow = (type **)calloc( (grid)*(row), sizeof( type * ));\
+    prow = (type **)Lgm_Calloc( (grid)*(row), sizeof( type * ));\
     if ( prow == (type **)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_3D Macro: Could not allocate space for row pointers\n");\
         exit(1);\
     }\
-    pgrid = (type ***)calloc( (grid), sizeof( type * ));\
+    pgrid = (type ***)Lgm_Calloc( (grid), sizeof( type * ));\
     if ( pgrid == (type ***)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_3D Macro: Could not allocate space for row pointers\n");\
         exit(1);\
@@ -201,9 +219,11 @@
 }\
     
 #define LGM_ARRAY_3D_FREE( pa ) {\
-    free( **pa );\
-    free( *pa );\
-    free( pa );\
+    if ( ( pa != NULL ) && !LGM_IS_ARENA_MEM( pa ) ) {\
+        Lgm_Free( **pa );\
+        Lgm_Free( *pa );\
+        Lgm_Free( pa );\
+    }\
 }\
 
 
@@ -220,22 +240,22 @@
     if ( n2 < 1 )  { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (n2 = %d)\n", (int)(n2) ); exit(1); }\
     if ( n3 < 1 )  { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (n3 = %d)\n", (int)(n3) ); exit(1); }\
     if ( n4 < 1 )  { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (n4 = %d)\n", (int)(n4) ); exit(1); }\
-    pdata = (type *)calloc( (n4)*(n3)*(n2)*(n1), sizeof( type ) );\
+    pdata = (type *)Lgm_Calloc( (n4)*(n3)*(n2)*(n1), sizeof( type ) );\
     if ( pdata == (type *)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_4D Macro: Could not allocate space for data\n");\
         exit(1);\
     }\
-    pn2 = (type **)calloc( (n4)*(n3)*(n2), sizeof( type * ));\
+    pn2 = (type **)Lgm_Calloc( (n4)*(n3)*(n2), sizeof( type * ));\
     if ( pn2 == (type **)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_4D Macro: Could not allocate space for n2 pointers\n");\
         exit(1);\
     }\
-    pn3 = (type ***)calloc( (n4)*(n3), sizeof( type * ));\
+    pn3 = (type ***)Lgm_Calloc( (n4)*(n3), sizeof( type * ));\
     if ( pn3 == (type ***)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_4D Macro: Could not allocate space for n3 pointers\n");\
         exit(1);\
     }\
-    pn4 = (type ****)calloc( (n4), sizeof( type * ));\
+    pn4 = (type ****)Lgm_Calloc( (n4), sizeof( type * ));\
     if ( pn4 == (type ****)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_4D Macro: Could not allocate space for n4 pointers\n");\
         exit(1);\
@@ -256,10 +276,12 @@
 }\
     
 #define LGM_ARRAY_4D_FREE( pn4 ) {\
-    free( ***pn4 );\
-    free( **pn4 );\
-    free( *pn4 );\
-    free( pn4 );\
+    if ( ( pn4 != NULL ) && !LGM_IS_ARENA_MEM( pn4 ) ) {\
+        Lgm_Free( ***pn4 );\
+        Lgm_Free( **pn4 );\
+        Lgm_Free( *pn4 );\
+        Lgm_Free( pn4 );\
+    }\
 }\
 
 
@@ -277,27 +299,27 @@
     if ( n3 < 1 )  { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (n3 = %d)\n", (int)(n3) ); exit(1); }\
     if ( n4 < 1 )  { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (n4 = %d)\n", (int)(n4) ); exit(1); }\
     if ( n5 < 1 )  { fprintf( stderr, "LGM_ARRAY_1D Macro: Trying to allocate less than one element (n5 = %d)\n", (int)(n5) ); exit(1); }\
-    pdata = (type *)calloc( (n5)*(n4)*(n3)*(n2)*(n1), sizeof( type ) );\
+    pdata = (type *)Lgm_Calloc( (n5)*(n4)*(n3)*(n2)*(n1), sizeof( type ) );\
     if ( pdata == (type *)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_5D Macro: Could not allocate space for data\n");\
         exit(1);\
     }\
-    pn2 = (type **)calloc( (n5)*(n4)*(n3)*(n2), sizeof( type * ));\
+    pn2 = (type **)Lgm_Calloc( (n5)*(n4)*(n3)*(n2), sizeof( type * ));\
     if ( pn2 == (type **)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_5D Macro: Could not allocate space for n2 pointers\n");\
         exit(1);\
     }\
-    pn3 = (type ***)calloc( (n5)*(n4)*(n3), sizeof( type * ));\
+    pn3 = (type ***)Lgm_Calloc( (n5)*(n4)*(n3), sizeof( type * ));\
     if ( pn3 == (type ***)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_5D Macro: Could not allocate space for n3 pointers\n");\
         exit(1);\
     }\
-    pn4 = (type ****)calloc( (n5)*(n4), sizeof( type * ));\
+    pn4 = (type ****)Lgm_Calloc( (n5)*(n4), sizeof( type * ));\
     if ( pn4 == (type ****)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_5D Macro: Could not allocate space for n4 pointers\n");\
         exit(1);\
     }\
-    pn5 = (type *****)calloc( (n5), sizeof( type * ));\
+    pn5 = (type *****)Lgm_Calloc( (n5), sizeof( type * ));\
     if ( pn5 == (type *****)NULL ) {\
         fprintf(stderr, "LGM_ARRAY_5D Macro: Could not allocate space for n4 pointers\n");\
         exit(1);\
@@ -322,11 +344,13 @@
 
 
 #define LGM_ARRAY_5D_FREE( pn5 ) {\
-    free( ****pn5 );\
-    free( ***pn5 );\
-    free( **pn5 );\
-    free( *pn5 );\
-    free( pn5 );\
+    if ( ( pn5 != NULL ) && !LGM_IS_ARENA_MEM( pn5 ) ) {\
+        Lgm_Free( ****pn5 );\
+        Lgm_Free( ***pn5 );\
+        Lgm_Free( **pn5 );\
+        Lgm_Free( *pn5 );\
+        Lgm_Free( pn5 );\
+    }\
 }\
 
 
@@ -0,0 +1,92 @@
+#ifndef LGM_ECLIPSE_H
+#define LGM_ECLIPSE_H
+
+#include "Lgm_CTrans.h"
+#include "Lgm_Sgp.h"
+
+/*
+ *  Finding shadow (eclipse) entry and exit times along trajectories.
+ *
+ *  Whether a S/C is in the shadow of a body is decided by the angle Theta
+ *  between the Sun and the body as seen from the S/C, and the angular radii
+ *  ThetaS and ThetaB of the Sun and the body. The boundaries of the shadow
+ *  are the zeros of the two (continuous) shadow functions
+ *
+ *      gPenumbra = Theta - ( ThetaB + ThetaS )     ( < 0 in the penumbra or umbra )
+ *      gUmbra    = Theta - ( ThetaB - ThetaS )     ( < 0 in the umbra )
+ *
+ *  Lgm_Eclipse_FindEvents() steps through a time range with a coarse step,
+ *  brackets the sign changes of these functions and refines each one to
+ *  within Tol seconds. Shadow passages that are shorter than the step can
+ *  be missed, so the step should be a fraction of the shortest passage of
+ *  interest (a minute or so is fine for Earth shadows from LEO to GEO).
+ *
+ *  The positions of the S/C come from a Lgm_EclipseSource. This is a
+ *  callback that returns the MOD position (Re) at a given time (the
+ *  Lgm_CTrans it is handed is already set up for that time). Sources for
+ *  SGP4 TLEs (Lgm_EclipseSgp4) and for tables of positions (e.g. from SPICE,
+ *  Lgm_EclipseTable) are provided.
+ */
+#define LGM_ECLIPSE_EARTH       1
+#define LGM_ECLIPSE_MOON        2
+
+typedef int (*Lgm_EclipsePosFunc)( Lgm_DateTime *UTC, Lgm_Vector *u, void *Data, Lgm_CTrans *c );
+
+typedef struct Lgm_EclipseSource {
+
+    Lgm_EclipsePosFunc  Func;       // Returns TRUE and the S/C position (MOD, Re) in u, or FALSE if there is none.
+    void                *Data;      // Passed to Func.
+
+} Lgm_EclipseSource;
+
+typedef struct Lgm_EclipseEvent {
+
+    double              t;          // Time of the event (TT seconds since J2000)
+    Lgm_DateTime        UTC;        // Time of the event (UTC)
+    int                 Body;       // LGM_ECLIPSE_EARTH or LGM_ECLIPSE_MOON
+    int                 Shadow;     // Boundary crossed (LGM_PENUMBRAL_ECLIPSE or LGM_UMBRAL_ECLIPSE)
+    int                 Entry;      // TRUE for entry into the shadow, FALSE for exit
+
+} Lgm_EclipseEvent;
+
+/*
+ *  Data for Lgm_EclipsePos_Sgp4(). Set up with Lgm_EclipseSgp4_Init().
+ */
+typedef struct Lgm_EclipseSgp4 {
+
+    _SgpTLE             TLE;
+    _SgpInfo            s;
+
+} Lgm_EclipseSgp4;
+
+/*
+ *  Data for Lgm_EclipsePos_Table(). Positions are interpolated (cubic
+ *  Lagrange) in the coordinate system they are given in and then converted
+ *  to MOD with Lgm_Convert_Coords( ..., Flag, c ). An inertial system
+ *  (e.g. GEI2000, Flag = GEI2000_TO_MOD) interpolates best. Flag = 0 means
+ *  the positions are already in MOD.
+ */
+typedef struct Lgm_EclipseTable {
+
+    long int            n;          // Number of points
+    double              *t;         // Times (TT seconds since J2000, increasing)
+    Lgm_Vector          *u;         // Positions (Re)
+    int                 Flag;       // Conversion to MOD (or 0)
+
+} Lgm_EclipseTable;
+
+
+void                Lgm_ShadowFunctions( Lgm_Vector *ScToSun, Lgm_Vector *ScToBody, double BodyRadius, double *gPenumbra, double *gUmbra );
+
+long int            Lgm_Eclipse_FindEvents( Lgm_EclipseSource *Src, Lgm_DateTime *Start, Lgm_DateTime *End, double Step, double Tol, int Bodies,
+                                            Lgm_EclipseEvent **Events, Lgm_CTrans *c );
+void                Lgm_Eclipse_FindEvents_Multi( int nSat, Lgm_EclipseSource *Src, Lgm_DateTime *Start, Lgm_DateTime *End, double Step, double Tol, int Bodies,
+                                            long int *nEvents, Lgm_EclipseEvent **Events, Lgm_CTrans *c );
+
+void                Lgm_EclipseSgp4_Init( Lgm_EclipseSgp4 *e, _SgpTLE *TLE );
+int                 Lgm_EclipsePos_Sgp4( Lgm_DateTime *UTC, Lgm_Vector *u, void *Data, Lgm_CTrans *c );
+Lgm_EclipseTable   *Lgm_EclipseTable_Create( long int n, Lgm_DateTime *UTC, Lgm_Vector *u, int Flag, Lgm_CTrans *c );
+void                Lgm_EclipseTable_Free( Lgm_EclipseTable *e );
+int                 Lgm_EclipsePos_Table( Lgm_DateTime *UTC, Lgm_Vector *u, void *Data, Lgm_CTrans *c );
+
+#endif
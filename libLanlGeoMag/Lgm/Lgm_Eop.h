@@ -41,6 +41,8 @@ typedef struct Lgm_Eop {
     double      *dX;    // actually ddX?
     double      *dY;    // actually ddY?
     double      *DAT;
+    int         Shared;   // TRUE if the arrays belong to the shared table (see Lgm_SharedEop()) and must not be freed
+    long int    Hint;     // Index found by the last lookup (successive lookups are usually for nearby times)
     
 } Lgm_Eop;
 
@@ -65,6 +67,8 @@ typedef struct Lgm_EopOne {
 Lgm_Eop *Lgm_init_eop( int Verbose );
 void    Lgm_destroy_eop( Lgm_Eop *e );
 void    Lgm_read_eop( Lgm_Eop *e );
+Lgm_Eop *Lgm_SharedEop( void );
+long int Lgm_EopIndex( double MJD, Lgm_Eop *e );
 void    Lgm_NgaEoppPred( double JD, Lgm_EopOne *eop, Lgm_NgaEopp *e );
 int     Lgm_ReadNgaEopp( Lgm_NgaEopp *e, int Verbosity );
 void    Lgm_get_eop_at_JD( double JD, Lgm_EopOne *eop, Lgm_Eop *e );
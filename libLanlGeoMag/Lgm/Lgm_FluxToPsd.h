@@ -167,6 +167,80 @@ typedef struct Lgm_FluxToPsd {
 } Lgm_FluxToPsd;
 
 
+/*
+ * Streaming Flux -> PSD conversion of a time series.
+ *
+ * A Lgm_F2P_Stream holds everything needed to convert a whole time series of
+ * flux measurements (all on the same energy and pitch angle grid) to PSD at
+ * a fixed set of Mu's and K's. All of the buffers are allocated once, when
+ * the stream is created. Lgm_F2P_RunStream() pulls samples from a reader
+ * callback, and hands the converted samples (in order) to a writer callback.
+ *
+ * Samples are processed in blocks of BlockSize. While block n is being read,
+ * block n-1 has its field model work done (AofK) and block n-2 has its
+ * numerical work done (PSD at the Mu's and K's), so the three stages
+ * overlap. With OpenMP, the samples in each stage are spread over threads.
+ */
+typedef struct Lgm_F2P_Sample {
+
+    long int     Index;             //!< Sample number in the series (set by Lgm_F2P_RunStream()).
+    Lgm_DateTime DateTime;          //!< Date/Time of measurment (set by the reader).
+    Lgm_Vector   Position;          //!< Position of measurment in GSM (set by the reader).
+    double       B_obs;             //!< Observed magnetic field strength (set by the reader, only used if UseModelB is FALSE).
+    double       **FLUX_EA;         //!< Differential flux versus Energy and PitchAngle, FLUX_EA[E][A] (set by the reader).
+
+    int          TraceFlag;         //!< Flag returned by Lgm_Setup_AlphaOfK().
+    double       B;                 //!< Model magnetic field strength.
+    double       *AofK;             //!< Local pitch angles implied by the K values. Size is nK.
+    double       **PSD_MK;          //!< PSD versus Mu and K, PSD_MK[Mu][K].
+
+} Lgm_F2P_Sample;
+
+/*
+ * Reader callbacks fill in DateTime, Position, FLUX_EA (and B_obs if
+ * needed) of the sample they are given, and return 1, or return 0 at the
+ * end of the series (or < 0 on error). Writer callbacks get the converted
+ * samples in order, and return < 0 to stop the stream.
+ */
+typedef int (*Lgm_F2P_ReaderFunc)( Lgm_F2P_Sample *s, void *Data );
+typedef int (*Lgm_F2P_WriterFunc)( Lgm_F2P_Sample *s, void *Data );
+
+typedef struct Lgm_F2P_Stream {
+
+    int              nE;            //!< Number of energy bins in the Flux arrays.
+    double           *E;            //!< Energy values of the Flux arrays.
+    int              nA;            //!< Number of pitch angle bins in the Flux arrays.
+    double           *A;            //!< Pitch angle values of the Flux arrays.
+    int              nMu;           //!< Number of Mu values to get PSD at.
+    double           *Mu;           //!< Mu values to get PSD at.
+    int              nK;            //!< Number of K values to get PSD at.
+    double           *K;            //!< K values to get PSD at.
+
+    int              Extrapolate;   //!< As in Lgm_FluxToPsd.
+    int              nMaxwellians;  //!< As in Lgm_FluxToPsd.
+    int              FitType;       //!< As in Lgm_FluxToPsd.
+    int              UseModelB;     //!< As in Lgm_FluxToPsd.
+
+    int              BlockSize;     //!< Number of samples in each block.
+    Lgm_F2P_Sample   *Block[3];     //!< Sample buffers for the three pipeline stages.
+    int              nBlock[3];     //!< Number of samples in each buffer.
+
+    int              nThreads;      //!< Number of per-thread work structures.
+    Lgm_FluxToPsd    **f;           //!< Per-thread Lgm_FluxToPsd structures (for the numerical stage).
+    Lgm_Arena        **Arena;       //!< Per-thread arenas for the temporaries of the numerical stage.
+
+    /*
+     * Throughput of the last Lgm_F2P_RunStream().
+     */
+    long int         nSamples;      //!< Number of samples converted.
+    double           ElapsedTime;   //!< Wall clock time (s).
+    double           FieldTime;     //!< Time spent in the field model stage, summed over threads (s).
+    double           NumericTime;   //!< Time spent in the numerical stage, summed over threads (s).
+    double           SamplesPerSec; //!< nSamples/ElapsedTime.
+
+} Lgm_F2P_Stream;
+
+
 #define         LGM_P2F_SPLINE                           0
 #define         LGM_P2F_MAXWELLIAN                       1
 
@@ -258,6 +332,14 @@ void           Lgm_F2P_SetDateTimeAndPos( Lgm_DateTime *d, Lgm_Vector *u, Lgm_Fl
 void           Lgm_F2P_SetObservedB( double B_obs, Lgm_FluxToPsd *f );
 void           Lgm_F2P_GetPsdAtConstMusAndKs( double *Mu, int nMu, double *K, int nK, Lgm_MagModelInfo *mInfo, Lgm_FluxToPsd *f );
 double         Lgm_F2P_GetPsdAtEandAlpha( int iMu, int iK, double E, double a, Lgm_FluxToPsd *f );
+void           Lgm_F2P_PsdFromFlux( Lgm_FluxToPsd *f );
+int            Lgm_F2P_AlphaOfK( Lgm_DateTime *d, Lgm_Vector *u, int nK, double *K, double *AofK, double *B, Lgm_MagModelInfo *mInfo );
+void           Lgm_F2P_PsdAtMusAndKs( Lgm_FluxToPsd *f );
+
+// Streaming Flux -> PSD routines
+Lgm_F2P_Stream *Lgm_F2P_CreateStream( double *E, int nE, double *A, int nA, double *Mu, int nMu, double *K, int nK, int BlockSize );
+void            Lgm_F2P_FreeStream( Lgm_F2P_Stream *s );
+long int        Lgm_F2P_RunStream( Lgm_F2P_Stream *s, Lgm_F2P_ReaderFunc Reader, void *ReaderData, Lgm_F2P_WriterFunc Writer, void *WriterData, Lgm_MagModelInfo *mInfo );
 
 
 // PSD -> Flux routines
@@ -0,0 +1,91 @@
+#ifndef LGM_GCTRACE_H
+#define LGM_GCTRACE_H
+
+#include <stdio.h>
+#include "Lgm/Lgm_MagModelInfo.h"
+#include "Lgm/Lgm_VelStepInfo.h"
+
+/*
+ *  Guiding center tracing of (large numbers of) test particles.
+ *
+ *  Each particle is a guiding center with a fixed kinetic energy T and mirror
+ *  field Bm (i.e. fixed mu and K) moving with the gradient/curvature drift
+ *  plus its parallel motion along B (see Lgm_GuidingCenterVel()). The
+ *  parallel motion is reversed at the mirror points. Every particle is
+ *  advanced with its own adaptive (Bulirsch-Stoer, Lgm_VelStep()) step, so a
+ *  batch can hold particles with very different energies and pitch angles.
+ *
+ *  The field is held fixed while a batch is advanced; Lgm_GCTrace_Advance()
+ *  can be called repeatedly (e.g. with updated model parameters in between).
+ *
+ *  Particles are stored as flat arrays of Lgm_GCParticle, which are also
+ *  what gets written to disk. A "frame" is a header followed by the
+ *  particles at a given time; checkpoint files hold a single frame and
+ *  streaming output files hold a sequence of them.
+ */
+#define LGM_GC_ACTIVE           0   // still being traced
+#define LGM_GC_PRECIPITATED     1   // went below Rmin
+#define LGM_GC_ESCAPED          2   // went beyond Rmax
+#define LGM_GC_FAILED           -1  // stepper failed
+
+#define LGM_GC_FRAME_MAGIC      "LGMGCTRC"
+#define LGM_GC_FRAME_VERSION    1
+#define LGM_GC_FRAME_BYTEORDER  0x01020304
+
+typedef struct Lgm_GCParticle {
+
+    long int    Id;         // Particle Id (carried along but not used)
+    Lgm_Vector  u;          // Guiding center position (GSM, Re)
+    double      t;          // Time since start of the trace (s)
+    double      T;          // Kinetic energy (MeV)
+    double      E0;         // Rest energy (MeV)
+    double      q;          // Charge (C)
+    double      Bm;         // Mirror field (nT). Fixed along with T, so this labels K (it only moves out by the overshoot of a mirror point).
+    double      Mu;         // First invariant, p_perp^2/(2 m0 B) (MeV/nT). Kept consistent with T and Bm.
+    double      H;          // Next step size to try (s)
+    int         VparSgn;    // Sense of the parallel motion relative to B (+1 or -1, 0 for none)
+    int         Status;     // LGM_GC_ACTIVE, LGM_GC_PRECIPITATED, etc.
+    long int    nSteps;     // Number of steps taken so far
+
+} Lgm_GCParticle;
+
+typedef struct Lgm_GCTraceInfo {
+
+    double      Tol;            // Accuracy asked of Lgm_VelStep() for each step (Re)
+    double      Hmin;           // Smallest step used to home in on a mirror point (s)
+    double      Hmax;           // Largest step allowed (s)
+    double      MirrorTol;      // Parallel motion is reversed once 1-B/Bm drops below this
+    double      Rmin;           // Particles are lost below this radius (Re)
+    double      Rmax;           // Particles are lost beyond this radius (Re)
+    int         DerivScheme;    // Derivative scheme for the field gradients (LGM_DERIV_SIX_POINT, etc.)
+    double      h;              // Grid spacing for the derivative scheme (Re)
+    int         VerbosityLevel;
+
+    long int    nVelEvals;      // Number of velocity evaluations made by the last Lgm_GCTrace_Advance()
+
+} Lgm_GCTraceInfo;
+
+typedef struct Lgm_GCFrameHeader {
+
+    char        Magic[8];       // LGM_GC_FRAME_MAGIC (not NUL terminated)
+    int         Version;        // LGM_GC_FRAME_VERSION
+    int         ByteOrder;      // LGM_GC_FRAME_BYTEORDER as written
+    int         RecordSize;     // sizeof( Lgm_GCParticle ) as written
+    int         Pad;
+    long int    n;              // Number of particles in the frame
+    double      t;              // Time of the frame (s)
+
+} Lgm_GCFrameHeader;
+
+
+void            Lgm_GCTrace_Defaults( Lgm_GCTraceInfo *g );
+int             Lgm_GCTrace_InitParticle( Lgm_GCParticle *p, long int Id, Lgm_Vector *u, double T, double Alpha, double q, double E0, Lgm_MagModelInfo *m );
+long int        Lgm_GCTrace_Advance( Lgm_GCParticle *p, long int n, double t1, Lgm_GCTraceInfo *g, Lgm_MagModelInfo *m );
+long int        Lgm_GCTrace_Run( Lgm_GCParticle *p, long int n, double t0, double t1, double dt, FILE *fp, char *CheckpointFile,
+                                 int CheckpointEvery, Lgm_GCTraceInfo *g, Lgm_MagModelInfo *m );
+int             Lgm_GCTrace_WriteFrame( FILE *fp, Lgm_GCParticle *p, long int n, double t );
+Lgm_GCParticle *Lgm_GCTrace_ReadFrame( FILE *fp, long int *n, double *t );
+int             Lgm_GCTrace_WriteCheckpoint( char *Filename, Lgm_GCParticle *p, long int n, double t );
+Lgm_GCParticle *Lgm_GCTrace_ReadCheckpoint( char *Filename, long int *n, double *t );
+
+#endif
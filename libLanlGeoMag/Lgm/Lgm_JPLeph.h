@@ -23,6 +23,8 @@
 #define FALSE 0
 #endif
 
+#include <stdint.h>
+
 /*
  *  Bitmap for solar system bodies, etc.
  */
@@ -368,6 +370,12 @@ typedef struct Lgm_JPLephemInfo {
     double      jomega;         //!< End Julian Date for DE
     double      jdelta;         //!< Julian Date delta for DE
     int         verbosity;
+    int         Shared;         //!< TRUE if this is the process-wide copy (see Lgm_SharedJPLephem()); never freed
+
+    //memory mapped coefficients (see Lgm_MapJPLephem())
+    int         Mapped;         //!< TRUE if the coefficient arrays point into a mapped file
+    void        *MapAddr;       //!< Start of the mapping
+    long int    MapSize;        //!< Size of the mapping (bytes)
 
 } Lgm_JPLephemInfo;
 
@@ -386,6 +394,72 @@ typedef struct Lgm_JPLephemBundle {
 } Lgm_JPLephemBundle;
 
 
+/*
+ *  Flat binary copy of a DE ephemeris that can be memory mapped (see
+ *  Lgm_WriteJPLephemMap() and Lgm_MapJPLephem()). The file starts with this
+ *  header and is followed by the coefficient datasets, each stored as a
+ *  contiguous [ SetIndex ][ AxisIndex ][ CoefficientIndex ] block of doubles
+ *  (in the byte order of the machine that wrote it) at the given offset.
+ *  Datasets are in the order Sun, EarthMoon, Moon, Mercury, Venus, Mars,
+ *  Jupiter, Saturn, Uranus, Neptune, Pluto, Librations, Nutations. An offset
+ *  of zero means the dataset is not in the file.
+ *
+ *  The header only uses fixed-width types (so its layout does not depend on
+ *  the size of long on the machine), and its size is stored in it as well.
+ */
+#define LGM_DE_MAP_MAGIC        "LGMDEMAP"
+#define LGM_DE_MAP_VERSION      2
+#define LGM_DE_MAP_BYTEORDER    0x01020304
+#define LGM_DE_MAP_NDATASETS    13
+
+typedef struct Lgm_JPLephemMapHeader {
+
+    char        Magic[8];                               //!< LGM_DE_MAP_MAGIC (not NUL terminated)
+    int32_t     Version;                                //!< LGM_DE_MAP_VERSION
+    int32_t     ByteOrder;                              //!< LGM_DE_MAP_BYTEORDER as written
+    int32_t     HeaderSize;                             //!< sizeof(Lgm_JPLephemMapHeader) as written
+    int32_t     DEnum;                                  //!< e.g. 421
+    int32_t     nDataSets;                              //!< LGM_DE_MAP_NDATASETS
+    int32_t     Spare;                                  //!< Zero (keeps the doubles 8 byte aligned)
+    double      jalpha, jomega, jdelta;                 //!< As in Lgm_JPLephemInfo
+    int64_t     nvals[ LGM_DE_MAP_NDATASETS ];          //!< Number of sets
+    int64_t     naxes[ LGM_DE_MAP_NDATASETS ];          //!< Number of axes
+    int64_t     ncoeffs[ LGM_DE_MAP_NDATASETS ];        //!< Number of coefficients per axis
+    int64_t     Offset[ LGM_DE_MAP_NDATASETS ];         //!< Byte offset of the data from the start of the file
+
+} Lgm_JPLephemMapHeader;
+
+
+/*
+ *  The record of Chebyshev coefficients last used for a body. The
+ *  coefficients are not copied; coeffs points into the Lgm_JPLephemInfo.
+ */
+typedef struct Lgm_JPLephemSegment {
+
+    double      **coeffs;       //!< [ AxisIndex ][ CoefficientIndex ] of the current record
+    int         ncoeffs;        //!< Number of coefficients per axis
+    int         index;          //!< Index of the record (-1 if none)
+    double      t0;             //!< Start of the record (JD)
+    double      days_per_set;   //!< Length of the record (days)
+
+} Lgm_JPLephemSegment;
+
+
+/*
+ *  Per-body record cache for Lgm_JPLephem_state(). It is kept apart from the
+ *  Lgm_JPLephemInfo (which may be shared by many threads) so each user can
+ *  have its own. A zeroed cache is empty.
+ */
+#define LGM_DE_CACHE_SLOTS  13
+
+typedef struct Lgm_JPLephemCache {
+
+    Lgm_JPLephemInfo    *jpl;                       //!< Ephemeris the cached records belong to
+    Lgm_JPLephemSegment Seg[ LGM_DE_CACHE_SLOTS ];  //!< Sun, Earth-Moon bary., Moon, Mercury, ..., Nutation
+
+} Lgm_JPLephemCache;
+
+
 /*
  *  Function prototypes
  */
@@ -393,6 +467,9 @@ Lgm_JPLephemInfo   *Lgm_InitJPLephemInfo( int DEnum, int getBodies, int Verbosit
 void                Lgm_InitJPLephDefaults (int DEnum, int getBodies, int verbosity, Lgm_JPLephemInfo *jpl );
 void                Lgm_FreeJPLephemInfo( Lgm_JPLephemInfo  *jpl );
 void                Lgm_ReadJPLephem( Lgm_JPLephemInfo *jpl );
+Lgm_JPLephemInfo   *Lgm_SharedJPLephem( void );
+int                 Lgm_MapJPLephem( char *Filename, Lgm_JPLephemInfo *jpl );
+int                 Lgm_WriteJPLephemMap( char *Filename, Lgm_JPLephemInfo *jpl );
 
 Lgm_JPLephemBundle *Lgm_InitJPLephemBundle( double tdb );
 void                Lgm_FreeJPLephemBundle( Lgm_JPLephemBundle *bundle );
@@ -405,3 +482,8 @@ int                 Lgm_JPL_getNSets( int objName, Lgm_JPLephemInfo *jpl);
 void                Lgm_JPLephem_position( double tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_Vector *position);
 void                Lgm_JPLephem_velocity( double tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_Vector *velocity);
 void                Lgm_JPL_getSunVector ( double tdb, Lgm_JPLephemInfo *jpl, Lgm_Vector *position );
+
+void                Lgm_JPLephem_ResetCache( Lgm_JPLephemCache *cache );
+void                Lgm_JPLephem_state( double tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_JPLephemCache *cache, Lgm_Vector *position, Lgm_Vector *velocity );
+void                Lgm_JPLephem_state_array( int n, double *tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_Vector *position, Lgm_Vector *velocity );
+void                Lgm_JPL_getSunVector_cached( double tdb, Lgm_JPLephemInfo *jpl, Lgm_JPLephemCache *cache, Lgm_Vector *position );
@@ -155,6 +155,22 @@ typedef struct Lgm_LstarInfo {
     int     nImI0;        // number of vals stored.
 
 
+    /*
+     * Mirror point (MLT, mlat) of each shell line found by the last call to
+     * Lstar(). If nShellGuess > 2, Lstar() uses ShellGuessMLT/ShellGuessMlat
+     * (e.g. the ShellMirror values of a nearby drift shell) to predict where
+     * the first few shell lines are. Lstar() does not reset nShellGuess, so
+     * a caller that sets it must set it back to 0 when done
+     * (Lgm_LCDS_KSection() does this itself).
+     */
+    int     nShellMirror;
+    double  ShellMirrorMLT[ LGM_LSTARINFO_MAX_FL ];
+    double  ShellMirrorMlat[ LGM_LSTARINFO_MAX_FL ];
+    int     nShellGuess;
+    double  ShellGuessMLT[ LGM_LSTARINFO_MAX_FL ];
+    double  ShellGuessMlat[ LGM_LSTARINFO_MAX_FL ];
+
+
 
     /*
      *  variables for keeping track of particles
@@ -197,6 +213,7 @@ double      LambdaIntegrand( double Lambda, _qpInfo *qpInfo ) ;
 double      LambdaIntegral( Lgm_LstarInfo *LstarInfo ) ;
 double      AngVelInv( double Phi );
 int         Lgm_LCDS( long int Date, double UTC, double brac1, double brac2, double Alpha, double LT, double tol, int Quality, int nFLsInDriftShell, double *K, Lgm_LstarInfo *LstarInfo );
+int         Lgm_LCDS_KSection( long int Date, double UTC, double brac1, double brac2, double Kin, double LT, double tol, int Quality, int nFLsInDriftShell, int nDiv, double *K, double *rLCDS, Lgm_LstarInfo *LstarInfo );
  
 
 #endif
@@ -3,6 +3,8 @@
 
 #include "Lgm/Lgm_MagModelInfo.h"
 #include "Lgm/Lgm_LstarInfo.h"
+#include "Lgm/Lgm_Sgp.h"
+#include "Lgm/Lgm_QinDenton.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
@@ -188,6 +190,7 @@ typedef struct Lgm_MagEphemData {
     char        **H5_FieldLineType;
     char        **H5_IntModel;
     char        **H5_ExtModel;
+    char        **H5_InputFingerprint;  // hash of the model inputs used for each row (hex string).
     
     long int    *H5_Date;
     int         *H5_Doy;
@@ -315,6 +318,9 @@ void    Lgm_WriteMagEphemHeader( FILE *fp, char *CodeVersion, char *ExtModel, in
 void    Lgm_WriteMagEphemHeaderHdf( hid_t file, char *argp_program_version, char *ExtModel, int SpiceBody,  char *Spacecraft, int IdNumber, char *IntDesig, char *CmdLine, int nAscend, Lgm_DateTime *Ascend_UTC, Lgm_Vector *Ascend_U, int nPerigee, Lgm_DateTime *Perigee_UTC, Lgm_Vector *Perigee_U, int nApogee, Lgm_DateTime *Apogee_UTC, Lgm_Vector *Apogee_U, Lgm_MagEphemInfo *m, Lgm_MagEphemData *med  );
 void    Lgm_WriteMagEphemData( FILE *fp, char *IntModel, char *ExtModel, double Kp, double Dst, Lgm_MagEphemInfo *m );
 void    Lgm_WriteMagEphemDataHdf( hid_t file, int iRow, int iii, Lgm_MagEphemData *m );
+int     Lgm_CreateMagEphemInputFingerprintHdf( hid_t file );
+void    Lgm_MagEphemInputFingerprint( char *Fingerprint, _SgpTLE *tle, Lgm_QinDentonOne *p, char *IntModel, char *ExtModel, int Quality, int nFLsInDriftShell,
+                                      double ForceKp, double FootpointHeight, int nAlpha, double *Alpha, int UseEop );
 
 
 Lgm_MagEphemData *Lgm_InitMagEphemData( int nRows, int nPA );                                                                                                                                                                              
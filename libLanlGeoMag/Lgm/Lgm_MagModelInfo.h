@@ -102,6 +102,7 @@
 #define LGM_EXTMODEL_SCATTERED_DATA5    13
 #define LGM_EXTMODEL_TU82               14
 #define LGM_EXTMODEL_OP88               15
+#define LGM_EXTMODEL_GRID               16
 
 
 
@@ -126,6 +127,21 @@
 #ifndef LGM_MAGSTEP_ODE_RK5
 #define LGM_MAGSTEP_ODE_RK5     1
 #endif
+#ifndef LGM_MAGSTEP_ODE_DP5
+#define LGM_MAGSTEP_ODE_DP5     2
+#endif
+
+/*
+ *  Continuous (dense) output for a single Lgm_MagStep_DP5() step. Evaluate
+ *  with Lgm_MagStep_DP5_Interp().
+ */
+typedef struct Lgm_MagStep_DenseOutput {
+
+    int         Valid;      // TRUE if r[][] describes a completed step.
+    double      Hdid;       // Size of the step (same sense as Hdid returned by Lgm_MagStep()).
+    double      r[5][3];    // Interpolating polynomial coefficients.
+
+} Lgm_MagStep_DenseOutput;
 
 typedef struct CircularBuffer {
 
@@ -286,7 +302,7 @@ typedef struct Lgm_MagModelInfo {
 
 
     long int    Lgm_nMagEvals;          // records number of Bfield evals between resets
-    int         Lgm_MagStep_Integrator; // ODE solver to use ( LGM_MAGSTEP_ODE_BS or LGM_MAGSTEP_ODE_RK5)
+    int         Lgm_MagStep_Integrator; // ODE solver to use ( LGM_MAGSTEP_ODE_BS, LGM_MAGSTEP_ODE_RK5 or LGM_MAGSTEP_ODE_DP5)
 
     /*
      *  Vars for Bulirsch-Stoer ODE solver. Some of these variables are needed
@@ -336,6 +352,21 @@ typedef struct Lgm_MagModelInfo {
     double      Lgm_MagStep_RK5_ErrCon;
     double      Lgm_MagStep_RK5_Eps;        // Eps parameter used in RK5 method. Influences speed greatly.
 
+    /*
+     *  Vars for Dormand-Prince RK5(4) ODE solver. The FSAL_* vars hold the
+     *  last stage of the previous accepted step so that it can be re-used as
+     *  the first stage of the next one.
+     */
+    double      Lgm_MagStep_DP5_Eps;        // Eps parameter used in DP5 method.
+    double      Lgm_MagStep_DP5_Safety;
+    int         Lgm_MagStep_DP5_MaxCount;
+    int         Lgm_MagStep_DP5_FSAL_Valid;
+    Lgm_Vector  Lgm_MagStep_DP5_FSAL_u;
+    double      Lgm_MagStep_DP5_FSAL_b[3];
+    Lgm_Vector  Lgm_MagStep_DP5_FSAL_B;     // un-normalized B at Lgm_MagStep_DP5_FSAL_u
+    int         (*Lgm_MagStep_DP5_FSAL_Mag)();
+    Lgm_MagStep_DenseOutput Lgm_MagStep_DP5_Dense; // dense output for last accepted step
+
     /*
      *  These variables are needed to make Lgm_MagStep2() reentrant/thread-safe.
      *  They basically used to be static declarations within Lgm_MagStep2()
@@ -434,6 +465,12 @@ typedef struct Lgm_MagModelInfo {
     Lgm_OctreeData *Octree_kNN;
     int             Octree_kNN_Alloced; // number of elements allocated. (0 if unallocated).
 
+    /*
+     * Gridded field model (see Lgm_B_Grid.c). Not owned by this structure;
+     * copies share it and the user frees it with Lgm_B_Grid_Free().
+     */
+    struct Lgm_B_GridInfo  *BGrid;
+
     /*
      * Variables for defining KdTree stuff
      */
@@ -546,6 +583,24 @@ typedef struct BrentFuncInfoP {
     double 		        (*func)( Lgm_Vector *P, double Val, Lgm_MagModelInfo *Info );
 
 } BrentFuncInfoP;
+/*
+ *  Event definition for Lgm_TraceWithEvents(). Func() is evaluated along the
+ *  FL (P is the position, B the field vector there) and an event occurs where
+ *  it changes sign.
+ */
+typedef struct Lgm_TraceEvent {
+
+    double      (*Func)( Lgm_Vector *P, Lgm_Vector *B, double Val, Lgm_MagModelInfo *Info );
+    double      Val;        // Parameter passed to Func() (e.g. Bm, Rtarget, Xtarget).
+    int         Direction;  // +1 to only detect -ve to +ve crossings, -1 for +ve to -ve, 0 for both.
+    int         Terminal;   // If TRUE, stop the trace at the first occurrence.
+
+    int         Found;      // Set to TRUE if the event was found.
+    double      S;          // Distance along FL from start point to event.
+    Lgm_Vector  P;          // Location of event.
+
+} Lgm_TraceEvent;
+
 int Lgm_BrentP(double Sa, double Sb, double Sc, double Bb, Lgm_Vector Pa, Lgm_Vector Pb, Lgm_Vector Pc, BrentFuncInfoP *fInfo, double tol, double *Smin, double *Bmin, Lgm_Vector *Pmin );
 int Lgm_zBrentP(double S1, double S2, double F1, double F2, Lgm_Vector P1, Lgm_Vector P2, BrentFuncInfoP *fInfo, double tol, double *Sz, double *Fz, Lgm_Vector *Pz );
 
@@ -586,6 +641,11 @@ int  FreeSpline( Lgm_MagModelInfo *Info );
 int  Lgm_TraceToMinRdotB( Lgm_Vector *, Lgm_Vector *, double, Lgm_MagModelInfo * );
 int  Lgm_TraceIDL( int, void *argv[] );
 int  Lgm_TraceToMirrorPoint( Lgm_Vector *u, Lgm_Vector *v, double *Sm, double Bm, double sgn, double tol, Lgm_MagModelInfo *Info );
+int  Lgm_TraceWithEvents( Lgm_Vector *u, Lgm_Vector *v, double *S, double sgn, double Smax, Lgm_TraceEvent *Events, int nEvents, double tol, Lgm_MagModelInfo *Info );
+double Lgm_TraceEvent_BminusBm( Lgm_Vector *P, Lgm_Vector *B, double Bm, Lgm_MagModelInfo *Info );
+double Lgm_TraceEvent_R( Lgm_Vector *P, Lgm_Vector *B, double Rtarget, Lgm_MagModelInfo *Info );
+double Lgm_TraceEvent_X( Lgm_Vector *P, Lgm_Vector *B, double Xtarget, Lgm_MagModelInfo *Info );
+double Lgm_TraceEvent_dBds( Lgm_Vector *P, Lgm_Vector *B, double Val, Lgm_MagModelInfo *Info );
 
 
 int  Lgm_MagStep( Lgm_Vector *, Lgm_Vector *, double, double *, double *, double, double *, int *,
@@ -594,6 +654,9 @@ int  Lgm_MagStep_BS( Lgm_Vector *, Lgm_Vector *, double, double *, double *, dou
               int (*Mag)(Lgm_Vector *, Lgm_Vector *, Lgm_MagModelInfo *), Lgm_MagModelInfo * );
 int  Lgm_MagStep_RK5( Lgm_Vector *, Lgm_Vector *, double, double *, double *, double, double, double *, int *,
               int (*Mag)(Lgm_Vector *, Lgm_Vector *, Lgm_MagModelInfo *), Lgm_MagModelInfo * );
+int  Lgm_MagStep_DP5( Lgm_Vector *, Lgm_Vector *, double, double *, double *, double, double, double *, int *,
+              int (*Mag)(Lgm_Vector *, Lgm_Vector *, Lgm_MagModelInfo *), Lgm_MagModelInfo * );
+int  Lgm_MagStep_DP5_Interp( double ds, Lgm_MagStep_DenseOutput *d, Lgm_Vector *u );
 
 /*
  * For Bulirsch-Stoer FL tracer
@@ -761,6 +824,7 @@ int Lgm_B_FromScatteredData3( Lgm_Vector *v, Lgm_Vector *B, Lgm_MagModelInfo *In
 int Lgm_B_FromScatteredData4( Lgm_Vector *v, Lgm_Vector *B, Lgm_MagModelInfo *Info );
 int Lgm_B_FromScatteredData5( Lgm_Vector *v, Lgm_Vector *B, Lgm_MagModelInfo *Info );
 void Lgm_B_FromScatteredData_SetUp( Lgm_MagModelInfo *Info );
+int Lgm_B_Grid( Lgm_Vector *v, Lgm_Vector *B, Lgm_MagModelInfo *Info );
 void Lgm_B_FromScatteredData_TearDown( Lgm_MagModelInfo *Info );
 void Lgm_B_FromScatteredData4_TearDown( Lgm_MagModelInfo *Info ); // unify the structs to avoid having this
 
@@ -801,11 +865,14 @@ double      IFromLBmM_Hilton( double L, double Bm, double M );
 double      LFromIBmM_McIlwain( double I, double Bm, double M );
 double      IFromLBmM_McIlwain( double L, double Bm, double M );
 double      Lgm_McIlwain_L( long int Date, double UTC, Lgm_Vector *u, double Alpha, int Type, double *I, double *Bm, double *M, Lgm_MagModelInfo *mInfo );
+int         Lgm_McIlwain_L_Batch( long int Date, double UTC, int nPos, Lgm_Vector *u, int nAlpha, double *Alpha, int Type, double *L, double *I, double *Bm, double *M, Lgm_MagModelInfo *mInfo );
 
 
 double      BofS( double s, Lgm_MagModelInfo *Info );
 int         SofBm( double Bm, double *ss, double *sn, Lgm_MagModelInfo *Info );
+int         Lgm_MirrorS_Interped( double Bm, int imin, int Dir, double *S, Lgm_MagModelInfo *Info );
 double      Lgm_AlphaOfK( double K, Lgm_MagModelInfo *Info );
+int         Lgm_AlphaOfK_Batch( int nK, double *K, double *Alpha, Lgm_MagModelInfo *Info );
 double      Lgm_KofAlpha( double Alpha, Lgm_MagModelInfo *Info );
 int         Lgm_Setup_AlphaOfK( Lgm_DateTime *d, Lgm_Vector *u, Lgm_MagModelInfo *m );
 void        Lgm_TearDown_AlphaOfK( Lgm_MagModelInfo *m );
@@ -872,6 +939,7 @@ int  Lgm_CGM_TO_GEOD( double CgmLat, double CgmLon, double CgmRadi, double *geoL
 /*
  * Various B-related routines
  */
+void    Lgm_B_Jacobian( Lgm_Vector *u0, Lgm_Vector *B, double J[3][3], int DerivScheme, double h, Lgm_MagModelInfo *m );
 void    Lgm_GradB( Lgm_Vector *u0, Lgm_Vector *GradB, int DerivScheme, double h, Lgm_MagModelInfo *m );
 void    Lgm_GradB2( Lgm_Vector *u0, Lgm_Vector *GradB, Lgm_Vector *GradB_para, Lgm_Vector *GradB_perp, int DerivScheme, double h, Lgm_MagModelInfo *m );
 void    Lgm_CurlB( Lgm_Vector *u0, Lgm_Vector *CurlB, int DerivScheme, double h, Lgm_MagModelInfo *m );
@@ -879,6 +947,7 @@ void    Lgm_CurlB2( Lgm_Vector *u0, Lgm_Vector *CurlB, Lgm_Vector *CurlB_para, L
 void    Lgm_B_Cross_GradB_Over_B( Lgm_Vector *u0, Lgm_Vector *A, int DerivScheme, double h, Lgm_MagModelInfo *m );
 void    Lgm_DivB( Lgm_Vector *u0, double *DivB, int DerivScheme, double h, Lgm_MagModelInfo *m );
 int     Lgm_GradAndCurvDriftVel( Lgm_Vector *u0, Lgm_Vector *Vel, Lgm_MagModelInfo *m );
+int     Lgm_GuidingCenterVel( Lgm_Vector *u0, Lgm_Vector *Vel, double VparSgn, double *Bmag, Lgm_MagModelInfo *m );
 
 void quicksort_uli( unsigned long n, unsigned long *arr );
 
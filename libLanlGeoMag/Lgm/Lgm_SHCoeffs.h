@@ -0,0 +1,65 @@
+#ifndef LGM_SHCOEFFS_H
+#define LGM_SHCOEFFS_H
+
+/*
+ *   Lgm_SHCoeffs.h
+ *
+ *   Spherical harmonic coefficient sets for internal field models of any
+ *   degree (e.g. IGRF up to degree 13, or higher degree core field models
+ *   such as CHAOS read from standard .shc coefficient files).
+ *
+ *   A coefficient set holds the Schmidt semi-normalized Gauss coefficients
+ *   at a number of epochs together with the (time independent) recursion
+ *   constants needed to evaluate the field. Once created it is only read
+ *   from, so a single set can be shared by any number of Lgm_CTrans
+ *   structures (and threads). See Lgm_Set_SHCoeffs() and Lgm_SHCoeffs_B().
+ *
+ *
+ *                                   m
+ *      g[ e*nCoeffs + LGM_SH_IDX(n,m) ] = g   at epoch e (nT)
+ *                                   n
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/*
+ *  Index of (n, m) in the triangular coefficient arrays.
+ */
+#define LGM_SH_IDX( n, m )      ( (n)*((n)+1)/2 + (m) )
+
+typedef struct Lgm_SHCoeffs {
+
+    int         N;              // Maximum degree (and order).
+    int         nCoeffs;        // Number of (n, m) pairs for n = 0..N ( (N+1)(N+2)/2 ).
+    int         nEpochs;        // Number of epochs.
+    double      *Epoch;         // Epochs (decimal years), in increasing order.
+    double      *g, *h;         // Schmidt semi-normalized coeffs (nT), nEpochs blocks of nCoeffs.
+    double      *g_SV, *h_SV;   // Secular variation after the last epoch (nT/yr), or NULL.
+    double      RefRadius;      // Reference radius of the expansion (km).
+    char        Name[80];       // Description of the model.
+
+    /*
+     *  Recursion constants for the Schmidt semi-normalized solid harmonics
+     *  (up to degree N+1, which is needed for the gradient). They are stored
+     *  column (m) major, in the same order as the evaluation sweep:
+     *  Rec[ 2*(Off[m] + n-m) + 0..1 ] = a_n,m, b_n,m, and Diag[m] = d_m.
+     */
+    int         *Off;
+    double      *Rec;
+    double      *Diag;
+
+} Lgm_SHCoeffs;
+
+
+Lgm_SHCoeffs   *Lgm_SHCoeffs_Alloc( int N, int nEpochs );
+void            Lgm_SHCoeffs_Free( Lgm_SHCoeffs *s );
+Lgm_SHCoeffs   *Lgm_SHCoeffs_ReadSHC( char *Filename );
+Lgm_SHCoeffs   *Lgm_SHCoeffs_IGRF( void );
+void            Lgm_SHCoeffs_AtTime( double Year, double *g, double *h, Lgm_SHCoeffs *s );
+
+
+#endif
@@ -29,6 +29,14 @@
 #define LGM_SUMMERS_2007    		2007
 #define LGM_GLAUERT_AND_HORNE_HIGH_FREQ    1 
 
+/*
+ * Glauert and Horne resonant root tables.
+ */
+#define LGM_GH_MAX_HARMONIC     20      // Cyclotron harmonics -LGM_GH_MAX_HARMONIC to LGM_GH_MAX_HARMONIC are summed.
+#define LGM_GH_NTHETA           32      // Number of Gauss-Legendre nodes in tan(theta) used for each harmonic.
+#define LGM_GH_MAX_ROOTS        8       // Max number of resonant roots (the dispersion polynomial is 8th degree).
+#define LGM_GH_CACHE_SIZE       1024    // Number of latitudes at which local G&H tensors are kept during a bounce average.
+
 // Derivative schemes
 #ifndef LGM_DERIV_TWO_POINT
 #define LGM_DERIV_TWO_POINT     0
@@ -87,9 +95,41 @@ typedef struct Lgm_SummersInfo {
     int	    nPlasmaParameters; //!< number of logarithmic grid points in aStar on which the normalizer for Glauert and Horne is computed
     double  *Nw;	    //!< pointer to the gridded evaluations of the normalizer needed for Glauert and Horne.
 
+
+    int     GH_nCache;                          //!< Number of latitudes held in GH_CacheLat[] / GH_CacheD[].
+    double  GH_CacheLat[LGM_GH_CACHE_SIZE];     //!< Latitudes at which the local Glauert and Horne tensor has been computed.
+    double  GH_CacheD[LGM_GH_CACHE_SIZE][3];    //!< Local Daa, Dap and Dpp at those latitudes.
+
 } Lgm_SummersInfo;
 
 
+/*
+ * Resonant roots for one cyclotron harmonic, tabulated at the Gauss-Legendre
+ * nodes in tan(theta) over the interval where roots can exist. Along with
+ * each root we keep the part of the integrand that is common to Daa, Dap and
+ * Dpp (C) and the factor q = s*n*Omega_e/(gamma*omega) - sin^2(alpha) that
+ * distinguishes them, so that all three components come from one table:
+ *
+ *      Daa = sum W C q^2/cos^2(alpha)
+ *      Dap = sum W C q sin(alpha)/cos(alpha)
+ *      Dpp = sum W C sin^2(alpha)
+ */
+typedef struct Lgm_GH_RootTable {
+
+    int     n;                                              //!< Cyclotron harmonic.
+    int     nTheta;                                         //!< Number of tan(theta) nodes.
+    double  SinAlpha;                                       //!< sin(alpha) used for the table.
+    double  CosAlpha;                                       //!< cos(alpha) used for the table.
+    double  tanTheta[LGM_GH_NTHETA];                        //!< tan(theta) at the nodes.
+    double  W[LGM_GH_NTHETA];                               //!< Quadrature weights (including the tan(theta) factor of the integrand).
+    int     nRoots[LGM_GH_NTHETA];                          //!< Number of resonant roots that contribute at each node.
+    double  x[LGM_GH_NTHETA][LGM_GH_MAX_ROOTS];             //!< Resonant roots (omega/Omega_e).
+    double  C[LGM_GH_NTHETA][LGM_GH_MAX_ROOTS];             //!< Common part of the integrand at each root.
+    double  q[LGM_GH_NTHETA][LGM_GH_MAX_ROOTS];             //!< s*n*Omega_e/(gamma*omega) - sin^2(alpha) at each root.
+
+} Lgm_GH_RootTable;
+
+
 int Lgm_SummersDxxBounceAvg( int Version, double Alpha0,  double Ek,  double L,  void *BwFuncData, double (*BwFunc)( double, void * ), double n1, double n2, double n3, double aStarEq,  int Directions, double w1, double w2, double wm, double dw, int WaveMode, int Species, double MaxWaveLat, double *Daa_ba,  double *Dap_ba,  double *Dpp_ba);
 //int Lgm_GlauertAndHorneDxxBounceAvg( int Version, double Alpha0,  double Ek,  double L,  void *BwFuncData, double (*BwFunc)( double, void * ), double n1, double n2, double n3, double aStarEq,  int Directions, double w1, double w2, double wm, double dw, double x1, double x2, int numberOfWaveNormalAngleDistributions, double *xm, double *dx, double *weightsOnWaveNormalAngleDistributions,int WaveMode, int Species, double MaxWaveLat, double *Daa_ba,  double *Dap_ba,  double *Dpp_ba);
 int Lgm_GlauertAndHorneDxxBounceAvg( int Version, double Alpha0,  double Ek,  double L,  void *BwFuncData, double (*BwFunc)( double, void * ), double n1, double n2, double n3, double aStarEq,  int Directions, double w1, double w2, double wm, double dw, double x1, double x2, int numberOfWaveNormalAngleDistributions, double *xm, double *dx, double *weightsOnWaveNormalAngleDistributions,int WaveMode, int Species, double MaxWaveLat, int nNw, int nPlasmaParameters, double aStarMin, double aStarMax, double *Nw, double *Daa_ba,  double *Dap_ba,  double *Dpp_ba);
@@ -102,6 +142,7 @@ double SummersIntegrand_Gap( double Lat, _qpInfo *qpInfo );
 double SummersIntegrand_Gpp( double Lat, _qpInfo *qpInfo );
 //double Lgm_GlauertAndHorneHighFrequencyDiffusionCoefficients_Local(double SinAlpha2, double E, double dBoverB2, double BoverBeq, double Omega_e, double Omega_Sig, double Rho, double Sig, double wxl, double wxh, double wxm, double wdx, double xmin, double xmax, int numberOfWaveNormalAngleDistributions, double *xmArray, double *dxArray, double *weightsOnWaveNormalAngleDistributions, double Lambda, int s, double aStar, int Directions, int tensorFlag);
 double Lgm_GlauertAndHorneHighFrequencyDiffusionCoefficients_Local(double SinAlpha2, double E, double dBoverB2, double BoverBeq, double Omega_e, double Omega_Sig, double Rho, double Sig, double wxl, double wxh, double wxm, double wdx, double xmin, double xmax, int numberOfWaveNormalAngleDistributions, double *xmArray, double *dxArray, double *weightsOnWaveNormalAngleDistributions, double Lambda, int s, double aStar, int Directions, int tensorFlag, int nNw, int nPlasmaParameters, double aStarMin, double aStarMax, double *Nw);
+int Lgm_GlauertAndHorneHighFrequencyDiffusionTensor_Local(double SinAlpha2, double E, double dBoverB2, double BoverBeq, double Omega_e, double Omega_Sig, double Rho, double Sig, double wxl, double wxh, double wxm, double wdx, double xmin, double xmax, int numberOfWaveNormalAngleDistributions, double *xmArray, double *dxArray, double *weightsOnWaveNormalAngleDistributions, double Lambda, int s, double aStar, int Directions, int nNw, int nPlasmaParameters, double aStarMin, double aStarMax, double *Nw, double *Daa, double *Dap, double *Dpp);
 double Lgm_SummersDaaLocal( double SinAlpha2, double E, double dBoverB2, double BoverBeq, double Omega_e, double Omega_Sig, double Rho, double Sig, double xl, double xh, double xm, double dx, double Lambda, int s, double aStar, int Directions );
 double Lgm_SummersDapLocal( double SinAlpha2, double E, double dBoverB2, double BoverBeq, double Omega_e, double Omega_Sig, double Rho, double Sig, double xl, double xh, double xm, double dx, double Lambda, int s, double aStar, int Directions );
 double Lgm_SummersDppLocal( double SinAlpha2, double E, double dBoverB2, double BoverBeq, double Omega_e, double Omega_Sig, double Rho, double Sig, double xl, double xh, double xm, double dx, double Lambda, int s, double aStar, int Directions );
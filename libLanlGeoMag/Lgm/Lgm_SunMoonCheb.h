@@ -0,0 +1,56 @@
+#ifndef LGM_SUNMOONCHEB_H
+#define LGM_SUNMOONCHEB_H
+
+/*
+ *   Lgm_SunMoonCheb.h
+ *
+ *   Piecewise Chebyshev fits of the Sun and Moon positions over a span of
+ *   time, for dense timelines where evaluating the Sun/Moon theories (or
+ *   the DE ephemeris) at every Lgm_Set_Coord_Transforms() call dominates.
+ *
+ *   For each segment [ tSeg[i], tSeg[i+1] ] (TT seconds since J2000) there
+ *   are LGM_SMC_NQ series of Order+1 coeffs each:
+ *
+ *      Coeffs[ (i*LGM_SMC_NQ + q)*(Order+1) + k ],   k = 0..Order
+ *
+ *   for q = the x, y, z components of the Sun and of the Moon position (MOD,
+ *   in Re) and the phase of the Moon. Segments are split until the fit
+ *   agrees with the theory it was made from to within Tol (relative position
+ *   error, i.e. roughly the angular error in radians, and absolute error in
+ *   the phase) at a set of check points between the fitting nodes. MaxErr
+ *   is the largest error that was found at those points, so it is a sampled
+ *   estimate of the error of the table rather than a strict bound.
+ *
+ *   Once created a table is only read from, so one table can be shared by
+ *   any number of Lgm_CTrans structures (and threads). See
+ *   Lgm_SunMoonCheb_Create() and Lgm_Set_SunMoonCheb().
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "Lgm_Vec.h"
+
+#define LGM_SMC_SUN_X       0
+#define LGM_SMC_MOON_X      3
+#define LGM_SMC_PHASE       6
+#define LGM_SMC_NQ          7
+
+typedef struct Lgm_SunMoonCheb {
+
+    int         Order;          // Order of the Chebyshev series.
+    int         nSeg;           // Number of segments.
+    double      t0, t1;         // Span covered (TT seconds since J2000).
+    double      *tSeg;          // Segment boundaries (nSeg+1 of them).
+    double      *Coeffs;        // Chebyshev coeffs (see above).
+    int         ephModel;       // Sun/Moon model that was fit (LGM_EPH_LOW_ACCURACY, etc).
+    int         HavePhase;      // FALSE if the model gives no phase for the Moon.
+    double      Tol;            // Requested accuracy.
+    double      MaxErr;         // Largest error found at the check points (an estimate, not a bound).
+
+} Lgm_SunMoonCheb;
+
+
+void    Lgm_SunMoonCheb_Free( Lgm_SunMoonCheb *s );
+int     Lgm_SunMoonCheb_Eval( double t, Lgm_Vector *Sun, Lgm_Vector *Moon, double *MoonPhase, Lgm_SunMoonCheb *s );
+
+
+#endif
@@ -26,6 +26,7 @@ typedef struct _Lgm_TabularBessel {
 
 void    Lgm_TabularBessel_Init( int M, int N, double xmin, double xmax, Lgm_TabularBessel *tb );
 void    Lgm_TabularBessel_Eval( double x, int Q, double *Jn, double *Jdn, Lgm_TabularBessel *tb );
+void    Lgm_TabularBessel_EvalArray( double x, int nmin, int nmax, double *Jn, Lgm_TabularBessel *tb );
 void    Lgm_TabularBessel_Free( Lgm_TabularBessel *tb );
 
 
@@ -0,0 +1,92 @@
+#ifndef LGM_TLECATALOG_H
+#define LGM_TLECATALOG_H
+
+/*
+ *   Lgm_TleCatalog.h
+ *
+ *   A binary, indexed catalog of TLEs for catalog-scale work (many objects,
+ *   many years of element sets) where re-reading and decoding text TLE files
+ *   for every object is the bottleneck.
+ *
+ *   Lgm_TleCatalog_Build() reads any number of text TLE files (with or
+ *   without a line 0 name), throws out element sets whose lines are malformed
+ *   or fail LgmSgp_TleChecksum(), groups what is left by NORAD ID, sorts each
+ *   group by epoch (dropping duplicate epochs) and writes it out as:
+ *
+ *      Lgm_TleCatHeader                    at offset 0
+ *      Lgm_TleCatSat   Sat[ nSat ]         sorted by IdNumber  (at SatOffset)
+ *      double          JD[ nTle ]          epochs              (at EpochOffset)
+ *      Lgm_TleCatRec   Rec[ nTle ]         raw lines           (at RecOffset)
+ *
+ *   The TLEs of the object Sat[k] are JD/Rec[ Sat[k].Start ... Sat[k].Start +
+ *   Sat[k].nTle - 1 ], in order of increasing epoch. The file is written in
+ *   the native byte order and layout (and is only readable on the same kind
+ *   of machine).
+ *
+ *   Lgm_TleCatalog_Open() mmaps the file read-only. Looking up a TLE is two
+ *   binary searches (the ID, then the epoch) that only touch the index and
+ *   epoch arrays; only the one record that is wanted is decoded (by
+ *   Lgm_TleCatalog_GetTLE()). Nothing is modified once the catalog is open,
+ *   so one catalog can be shared by any number of threads.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "Lgm_Sgp.h"
+
+#define LGM_TLECAT_MAGIC        "LGMTLECT"
+#define LGM_TLECAT_VERSION      1
+#define LGM_TLECAT_BYTEORDER    0x01020304
+
+typedef struct Lgm_TleCatHeader {
+
+    char        Magic[8];       // LGM_TLECAT_MAGIC (not NUL terminated)
+    int         Version;        // LGM_TLECAT_VERSION
+    int         ByteOrder;      // LGM_TLECAT_BYTEORDER as written
+    long int    nSat;           // Number of objects
+    long int    nTle;           // Number of element sets
+    long int    nRejected;      // Number of element sets that failed validation at build time
+    long int    SatOffset;      // Byte offsets of the arrays from the start of the file
+    long int    EpochOffset;
+    long int    RecOffset;
+
+} Lgm_TleCatHeader;
+
+typedef struct Lgm_TleCatSat {
+
+    int         IdNumber;       // NORAD ID
+    int         nTle;           // Number of element sets for this object
+    long int    Start;          // Index of the first one in JD[] and Rec[]
+
+} Lgm_TleCatSat;
+
+typedef struct Lgm_TleCatRec {
+
+    char        Line0[32];      // Name (may be empty)
+    char        Line1[72];
+    char        Line2[72];
+
+} Lgm_TleCatRec;
+
+typedef struct Lgm_TleCatalog {
+
+    long int        nSat;
+    long int        nTle;
+    Lgm_TleCatSat   *Sat;       // These all point into the mapping
+    double          *JD;
+    Lgm_TleCatRec   *Rec;
+
+    void            *MapAddr;
+    long int        MapSize;
+    int             Verbosity;
+
+} Lgm_TleCatalog;
+
+
+int             Lgm_TleCatalog_Build( char *OutFile, int nInFiles, char **InFiles, int Verbosity );
+Lgm_TleCatalog *Lgm_TleCatalog_Open( char *Filename, int Verbosity );
+void            Lgm_TleCatalog_Close( Lgm_TleCatalog *c );
+long int        Lgm_TleCatalog_FindSat( int IdNumber, Lgm_TleCatalog *c );
+long int        Lgm_TleCatalog_FindTLEforGivenTime( int IdNumber, double JD, Lgm_TleCatalog *c );
+int             Lgm_TleCatalog_GetTLE( long int i, _SgpTLE *TLE, Lgm_TleCatalog *c );
+
+#endif
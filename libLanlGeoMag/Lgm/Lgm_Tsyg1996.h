@@ -60,6 +60,19 @@ typedef struct LgmTsyg1996_Info {
     double      OLD_PDYN;
 
 
+    /*
+     *  Quantities in Tsyg_T96() that depend only on the model parameters.
+     *  Recomputed (by T96_SetState()) only when PARMOD changes.
+     */
+    int         State_Valid;
+    double      State_PARMOD[11];
+    long int    State_nUpdates;
+    double      State_ST, State_CT;
+    double      State_XAPPA, State_XAPPA3, State_X0, State_AM;
+    double      State_RCAMPL, State_TAMPL2, State_TAMPL3, State_B1AMPL, State_B2AMPL;
+    double      State_RECONN, State_RIMFAMPL;
+
+
     int         INTERCON_M_FLAG;
     double      P[4], R[4], RP[4], RR[4], SQPR[4][4];
 
@@ -108,6 +121,7 @@ typedef struct LgmTsyg1996_Info {
  *  Function declarations
  */
 void    Lgm_Init_T96( LgmTsyg1996_Info *t );
+void    T96_SetState( double *PARMOD, LgmTsyg1996_Info *t );
 void    Tsyg_T96( int IOPT, double *PARMOD, double PS, double SINPS, double COSPS, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg1996_Info *tInfo ) ;
 void    DIPSHLD_T96( double PS, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg1996_Info *tInfo ) ;
 void    CYLHARM_T96( double A[], double X, double Y, double Z, double *BX, double *BY, double *BZ ) ;
@@ -65,6 +65,29 @@ typedef struct LgmTsyg2001_Info {
     double      OLD_Z;
 
 
+
+
+    /*
+     *  Model "state". Everything in here depends only on (PS, PARMOD), so it
+     *  is recomputed (by T01S_SetState() or T02_SetState()) only when those
+     *  change rather than on every call. Since T01S and T02 share this
+     *  structure, the model the state was computed for is part of the key.
+     *  The tilt rotations and scale constants of the shielding fields are
+     *  filled in lazily by *_SHLCAR3X3() and *_RC_SHIELD().
+     */
+    int         State_Valid;
+    int         State_Model;            // 1 for T01S, 2 for T02
+    double      State_PS, State_PARMOD[11];
+    long int    State_nUpdates;
+    double      State_XAPPA, State_XAPPA3, State_X0, State_AM, State_SPS, State_STHETAH, State_OIMFY, State_OIMFZ;
+    double      State_TAMP1, State_TAMP2, State_A_SRC, State_A_PRC, State_A_R11, State_A_R12, State_A_R21, State_A_R22;
+    int         State_CF_Valid;
+    double      State_CF_CPS, State_CF_SPS, State_CF_ST1, State_CF_CT1, State_CF_ST2, State_CF_CT2;
+    double      State_CF_SQPR[3][3], State_CF_SQQS[3][3];
+    int         State_RC_Valid[2];      // [0] for the symmetric RC, [1] for the partial RC
+    double      State_RC_ST1[2], State_RC_CT1[2], State_RC_ST2[2], State_RC_CT2[2];
+    double      State_RC_SQPR[2][3][3], State_RC_SQQS[2][3][3];
+
     int         DoneJ[4];
     double      CPS, SPS, S3PS, PST1[4], PST2[4], ST1[4], CT1[4], ST2[4], CT2[4], X1[4], Z1[4], X2[4], Z2[4];
     double      P[4][4], ooP[4][4], ooP2[4][4];
@@ -89,6 +112,7 @@ typedef struct LgmTsyg2001_Info {
 /*
  *  Function declarations for T01S (aka TSK03)
  */
+void T01S_SetState( double *A, double *PARMOD, double PS, LgmTsyg2001_Info *t );
 void T01S_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT, double PDYN, double DST, double BYIMF,
                     double BZIMF, double G1, double G2, double G3, double PS, double X, double Y, double Z,
                     double *BXCF, double *BYCF, double *BZCF, double *BXT1, double *BYT1, double *BZT1,
@@ -97,7 +121,7 @@ void T01S_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
                     double *BXR12, double *BYR12, double *BZR12, double *BXR21, double *BYR21, double *BZR21,
                     double *BXR22, double *BYR22, double *BZR22, double *HXIMF, double *HYIMF, double *HZIMF,
                     double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t );
-void    T01S_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *BY, double *BZ );
+void    T01S_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t );
 void    T01S_DEFORMED( int IOPT, double PS, double X, double Y, double Z,
                 double *BX1, double *BY1, double *BZ1, double *BX2, double *BY2, double *BZ2, LgmTsyg2001_Info *t );
 void    T01S_WARPED( int IOPT, double PS, double X, double Y, double Z,
@@ -128,7 +152,7 @@ void    T01S_PRC_QUAD( double X, double Y, double Z, double *BX, double *BY, dou
 double  T01S_BR_PRC_Q( double R, double SINT, double COST );
 double  T01S_BT_PRC_Q( double R, double SINT, double COST);
 void    T01S_FFS( double A, double A0, double DA, double *F, double *FA, double *FS );
-void    T01S_RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t );
+void    T01S_RC_SHIELD( int NRC, double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t );
 void    T01S_DIPOLE( double PS, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t );
 
 
@@ -136,6 +160,7 @@ void    T01S_DIPOLE( double PS, double X, double Y, double Z, double *BX, double
 /*
  *  Function declarations for T02 (aka T01_01)
  */
+void T02_SetState( double *A, double *PARMOD, double PS, LgmTsyg2001_Info *t );
 void T02_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT, double PDYN, double DST, double BYIMF,
                     double BZIMF, double G1, double G2, double PS, double X, double Y, double Z,
                     double *BXCF, double *BYCF, double *BZCF, double *BXT1, double *BYT1, double *BZT1,
@@ -144,7 +169,7 @@ void T02_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
                     double *BXR12, double *BYR12, double *BZR12, double *BXR21, double *BYR21, double *BZR21,
                     double *BXR22, double *BYR22, double *BZR22, double *HXIMF, double *HYIMF, double *HZIMF,
                     double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t );
-void    T02_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *BY, double *BZ );
+void    T02_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t );
 void    T02_DEFORMED( int IOPT, double PS, double X, double Y, double Z,
                 double *BX1, double *BY1, double *BZ1, double *BX2, double *BY2, double *BZ2, LgmTsyg2001_Info *t );
 void    T02_WARPED( int IOPT, double PS, double X, double Y, double Z,
@@ -175,7 +200,7 @@ void    T02_PRC_QUAD( double X, double Y, double Z, double *BX, double *BY, doub
 double  T02_BR_PRC_Q( double R, double SINT, double COST );
 double  T02_BT_PRC_Q( double R, double SINT, double COST);
 void    T02_FFS( double A, double A0, double DA, double *F, double *FA, double *FS );
-void    T02_RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t );
+void    T02_RC_SHIELD( int NRC, double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t );
 void    T02_DIPOLE( double PS, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t );
 
 
@@ -66,7 +66,26 @@ typedef struct LgmTsyg2004_Info {
     double      OLD_X;
     double      OLD_Y;
     double      OLD_Z;
-    double      OLD_PDYN;
+
+
+    /*
+     *  Model "state". Everything in here depends only on (PS, PARMOD), so it
+     *  is recomputed (by TS04_SetState()) only when those change rather than
+     *  on every call. The tilt rotations and scale constants of the
+     *  shielding fields are filled in lazily by SHLCAR3X3() and RC_SHIELD()
+     *  (the flags are cleared by TS04_SetState()).
+     */
+    int         State_Valid;
+    double      State_PS, State_PARMOD[11];
+    long int    State_nUpdates;
+    double      State_XAPPA, State_XAPPA3, State_X0, State_AM, State_OIMFY, State_OIMFZ;
+    double      State_TAMP1, State_TAMP2, State_A_SRC, State_A_PRC, State_A_R11, State_A_R21;
+    int         State_CF_Valid;
+    double      State_CF_ST1, State_CF_CT1, State_CF_ST2, State_CF_CT2;
+    double      State_CF_SQPR[3][3], State_CF_SQQS[3][3];
+    int         State_RC_Valid[2];      // [0] for the symmetric RC, [1] for the partial RC
+    double      State_RC_ST1[2], State_RC_CT1[2], State_RC_ST2[2], State_RC_CT2[2];
+    double      State_RC_SQPR[2][3][3], State_RC_SQQS[2][3][3];
 
 
     // cache vars used in BIRK_SHL()
@@ -118,6 +137,7 @@ typedef struct LgmTsyg2004_Info {
  *  Function declarations
  */
 void Lgm_Init_TS04( LgmTsyg2004_Info *t );
+void TS04_SetState( double *A, double *PARMOD, double PS, LgmTsyg2004_Info *tInfo );
 void TS04_EXTERN( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT, double PDYN, double DST, double BXIMF, double BYIMF,
                 double BZIMF, double W1, double W2, double W3, double W4, double W5, double W6, double PS,
                 double X, double Y, double Z, double *BXCF, double *BYCF, double *BZCF, double *BXT1, double *BYT1,
@@ -156,7 +176,7 @@ void    PRC_QUAD( double X, double Y, double Z, double *BX, double *BY, double *
 double  BR_PRC_Q( double R, double SINT, double COST );
 double  BT_PRC_Q( double R, double SINT, double COST);
 void    FFS( double A, double A0, double DA, double *F, double *FA, double *FS );
-void    RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2004_Info *tInfo );
+void    RC_SHIELD( int NRC, double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2004_Info *tInfo );
 void    DIPOLE( double PS, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2004_Info *tInfo );
 
 
@@ -428,3 +428,249 @@ double Lgm_AlphaOfK_Func( double Kt, double Alpha, Lgm_MagModelInfo *m ) {
     }
 
 }
+
+
+
+
+/*
+ *  K(Alpha) on the pre-traced (and splined) field line set up by
+ *  Lgm_Setup_AlphaOfK(). The mirror points are found directly on the
+ *  interpolation arrays (searching out from the Bmin index, imin) rather
+ *  than by tracing to them, so this is much cheaper than Lgm_KofAlpha().
+ *  Returns LGM_FILL_VALUE if a mirror point is not on the pre-traced line.
+ */
+static double Lgm_KofAlpha_Interped( double Alpha, int imin, Lgm_MagModelInfo *m ) {
+
+    double  sa, Bm, Ss, Sn, I;
+
+    if ( fabs( Alpha - 90.0 ) < 1e-5 ) return( 0.0 );
+
+    sa = sin( Alpha*RadPerDeg );
+    Bm = m->Bmin/(sa*sa);
+    if ( Bm <= m->Bmag[imin] ) return( 0.0 );
+
+    if ( !Lgm_MirrorS_Interped( Bm, imin, -1, &Ss, m ) || !Lgm_MirrorS_Interped( Bm, imin, 1, &Sn, m ) ) return( LGM_FILL_VALUE );
+
+    if ( Sn - Ss <= 1e-5 ) {
+        I = (Sn - Ss)*sqrt( 1.0 - m->Bmin/Bm ); // Eqn 2.66b in Roederer
+    } else {
+        m->PitchAngle = Alpha;
+        m->Bm         = Bm;
+        m->Sm_South   = Ss;
+        m->Sm_North   = Sn;
+        I = Iinv_interped( m );
+    }
+    if ( I < 0.0 ) return( LGM_FILL_VALUE );
+
+    return( 3.16227766e-3*I*sqrt( Bm ) );
+
+}
+
+
+/*
+ *  Monotone (Steffen, 1990) slopes, d, for the cubic Hermite interpolant
+ *  through (x[i], y[i]) on a non-uniform grid (n >= 3).
+ */
+static void Lgm_AlphaOfK_Slopes( double *x, double *y, int n, double *d ) {
+
+    int     i;
+    double  h0, h1, s0, s1, p, a;
+
+    for ( i=1; i<n-1; i++ ) {
+        h0 = x[i] - x[i-1];       h1 = x[i+1] - x[i];
+        s0 = (y[i] - y[i-1])/h0;  s1 = (y[i+1] - y[i])/h1;
+        if ( s0*s1 <= 0.0 ) {
+            d[i] = 0.0;
+        } else {
+            p = (s0*h1 + s1*h0)/(h0 + h1);
+            a = ( fabs(s0) < fabs(s1) ) ? fabs(s0) : fabs(s1);
+            if ( 0.5*fabs(p) < a ) a = 0.5*fabs(p);
+            d[i] = ( s1 > 0.0 ) ? 2.0*a : -2.0*a;
+        }
+    }
+
+    h0 = x[1] - x[0];           h1 = x[2] - x[1];
+    s0 = (y[1] - y[0])/h0;      s1 = (y[2] - y[1])/h1;
+    p  = s0*(1.0 + h0/(h0+h1)) - s1*h0/(h0+h1);
+    d[0] = ( p*s0 <= 0.0 ) ? 0.0 : ( fabs(p) > 2.0*fabs(s0) ) ? 2.0*s0 : p;
+
+    h0 = x[n-1] - x[n-2];       h1 = x[n-2] - x[n-3];
+    s0 = (y[n-1] - y[n-2])/h0;  s1 = (y[n-2] - y[n-3])/h1;
+    p  = s0*(1.0 + h0/(h0+h1)) - s1*h0/(h0+h1);
+    d[n-1] = ( p*s0 <= 0.0 ) ? 0.0 : ( fabs(p) > 2.0*fabs(s0) ) ? 2.0*s0 : p;
+
+}
+
+
+/*
+ *  Evaluate the cubic Hermite interpolant (and its derivative) at xx, which
+ *  must lie in [ x[i], x[i+1] ].
+ */
+static double Lgm_AlphaOfK_Hermite( double *x, double *y, double *d, int i, double xx, double *dydx ) {
+
+    double  h, t, t2, t3;
+
+    h  = x[i+1] - x[i];
+    t  = (xx - x[i])/h; t2 = t*t; t3 = t2*t;
+    if ( dydx ) *dydx = ( (6.0*t2-6.0*t)*y[i] + (3.0*t2-4.0*t+1.0)*h*d[i] + (6.0*t-6.0*t2)*y[i+1] + (3.0*t2-2.0*t)*h*d[i+1] )/h;
+
+    return( (2.0*t3-3.0*t2+1.0)*y[i] + (t3-2.0*t2+t)*h*d[i] + (3.0*t2-2.0*t3)*y[i+1] + (t3-t2)*h*d[i+1] );
+
+}
+
+
+#define LGM_AOFK_NINIT      10      // Initial number of nodes in the K(Alpha) table
+#define LGM_AOFK_NMAX       200     // Maximum number of nodes in the K(Alpha) table
+#define LGM_AOFK_ALPHA_TOL  1e-2    // Refine the table until the interpolated Alpha(K) is this good (Degrees)
+
+/**
+ *   This routine returns the equatorial pitch angles that correspond to an
+ *   array of K values, \f$ K = I \sqrt{B_m}\f$, on the same field line. It
+ *   gives the same results as calling Lgm_AlphaOfK() for each K, but is much
+ *   cheaper when there are more than a few K's.
+ *
+ *   K(Alpha) is monotone on a given field line, so it is tabulated once (on
+ *   an alpha grid that is refined until the monotone cubic interpolant of
+ *   Alpha(K) is good to LGM_AOFK_ALPHA_TOL) using the pre-traced line, with
+ *   the mirror points found on the interpolation arrays. Each K is then
+ *   inverted by interpolating the table and polishing the result with a
+ *   single Newton step (i.e. one more K(Alpha) evaluation per K).
+ *
+ *      \param[in]      nK      Number of K values.
+ *      \param[in]      K       The values of the second invariant, K         <b> ( Re G^(1/2) )</b>
+ *      \param[out]     Alpha   Pitch angles, \f$\alpha\f$ implied by each K   <b> ( Degrees )</b>
+ *                              LGM_FILL_VALUE where there is no such pitch angle
+ *                              (e.g. the particles mirror below the loss cone height).
+ *      \param[in,out]  m       A properly initialized and configured Lgm_MagModelInfo structure.
+ *
+ *      \returns        The number of valid pitch angles found.
+ *
+ *      \note           You must call Lgm_Setup_AlphaOfK() before you call
+ *                      this routine. If m->UseInterpRoutines is not set (so
+ *                      there is no pre-traced line), this just calls
+ *                      Lgm_AlphaOfK() for each K.
+ *
+ */
+int Lgm_AlphaOfK_Batch( int nK, double *K, double *Alpha, Lgm_MagModelInfo *m ) {
+
+    int     i, j, k, n, nn, imin, nGood, Refine, Flag[LGM_AOFK_NMAX], NewFlag[LGM_AOFK_NMAX];
+    double  x[LGM_AOFK_NMAX], y[LGM_AOFK_NMAX], d[LGM_AOFK_NMAX];
+    double  xn[LGM_AOFK_NMAX], yn[LGM_AOFK_NMAX];
+    double  Bfoot, sa2, a_lo, a, am, Km, Kc, dadK;
+
+
+    if ( !m->UseInterpRoutines || !m->AllocedSplines || (m->nPnts < 3) ) {
+        for ( nGood=0, k=0; k<nK; k++ ) {
+            Alpha[k] = Lgm_AlphaOfK( K[k], m );
+            if ( Alpha[k] > 0.0 ) ++nGood;
+        }
+        return( nGood );
+    }
+
+    for ( imin=0, i=1; i<m->nPnts; i++ ) if ( m->Bmag[i] < m->Bmag[imin] ) imin = i;
+
+
+    /*
+     *  The smallest usable pitch angle is the one that mirrors (just above)
+     *  the lower of the two footpoints.
+     */
+    Bfoot = ( m->Bmag[0] < m->Bmag[m->nPnts-1] ) ? m->Bmag[0] : m->Bmag[m->nPnts-1];
+    sa2   = m->Bmin/(Bfoot*(1.0-1e-6));
+    a_lo  = ( sa2 < 1.0 ) ? DegPerRad*asin( sqrt( sa2 ) ) : 90.0;
+
+
+    /*
+     *  Initial table, kept in order of increasing K (i.e. decreasing alpha).
+     *  x is K, y is alpha, and Flag[j] says whether [j:j+1] still needs to
+     *  be checked.
+     */
+    for ( n=0, i=0; i<LGM_AOFK_NINIT; i++ ) {
+        a  = 90.0 - (90.0-a_lo)*i/(double)(LGM_AOFK_NINIT-1);
+        Km = Lgm_KofAlpha_Interped( a, imin, m );
+        if ( (Km >= 0.0) && ( (n == 0) || (Km > x[n-1]) ) ) {
+            x[n] = Km; y[n] = a; Flag[n] = TRUE; ++n;
+        }
+    }
+    if ( n < 4 ) {
+        if (m->VerbosityLevel >= 2) printf("Lgm_AlphaOfK_Batch(): Could not tabulate K(Alpha) (only %d good nodes). Using Lgm_AlphaOfK() instead.\n", n );
+        for ( nGood=0, k=0; k<nK; k++ ) {
+            Alpha[k] = Lgm_AlphaOfK( K[k], m );
+            if ( Alpha[k] > 0.0 ) ++nGood;
+        }
+        return( nGood );
+    }
+
+
+    /*
+     *  Refine. Each flagged interval gets its midpoint (in alpha) added, and
+     *  the two halves stay flagged if the interpolant missed the midpoint by
+     *  more than the tolerance.
+     */
+    Refine = TRUE;
+    while ( Refine ) {
+
+        Lgm_AlphaOfK_Slopes( x, y, n, d );
+        Refine = FALSE;
+
+        for ( nn=0, j=0; j<n-1; j++ ) {
+
+            xn[nn] = x[j]; yn[nn] = y[j]; NewFlag[nn] = FALSE; ++nn;
+
+            if ( Flag[j] && (n+nn-j < LGM_AOFK_NMAX) && (fabs( y[j]-y[j+1] ) > 1e-3) ) {
+                am = 0.5*(y[j] + y[j+1]);
+                Km = Lgm_KofAlpha_Interped( am, imin, m );
+                if ( (Km > x[j]) && (Km < x[j+1]) ) {
+                    a = Lgm_AlphaOfK_Hermite( x, y, d, j, Km, NULL );
+                    NewFlag[nn-1] = NewFlag[nn] = ( fabs( a - am ) > LGM_AOFK_ALPHA_TOL );
+                    if ( NewFlag[nn] ) Refine = TRUE;
+                    xn[nn] = Km; yn[nn] = am; ++nn;
+                }
+            }
+
+        }
+        xn[nn] = x[n-1]; yn[nn] = y[n-1]; NewFlag[nn] = FALSE; ++nn;
+
+        for ( j=0; j<nn; j++ ) { x[j] = xn[j]; y[j] = yn[j]; Flag[j] = NewFlag[j]; }
+        n = nn;
+        if ( n >= LGM_AOFK_NMAX-1 ) Refine = FALSE;
+
+    }
+    Lgm_AlphaOfK_Slopes( x, y, n, d );
+    if (m->VerbosityLevel >= 2) printf("Lgm_AlphaOfK_Batch(): K(Alpha) table has %d nodes, Alpha = [%g:%g], K = [%g:%g]\n", n, y[n-1], y[0], x[0], x[n-1] );
+
+
+    /*
+     *  Invert each K.
+     */
+    for ( nGood=0, k=0; k<nK; k++ ) {
+
+        if ( (K[k] < 0.0) || (K[k] > x[n-1]) ) {
+            if (m->VerbosityLevel >= 2) printf("Lgm_AlphaOfK_Batch(): K = %g is outside of [0:%g]. No alpha value found.\n", K[k], x[n-1] );
+            Alpha[k] = LGM_FILL_VALUE;
+            continue;
+        }
+
+        // bracket it (bisection on the table)
+        i = 0; j = n-1;
+        while ( j-i > 1 ) {
+            nn = (i+j)/2;
+            if ( x[nn] > K[k] ) j = nn; else i = nn;
+        }
+
+        a = Lgm_AlphaOfK_Hermite( x, y, d, i, K[k], &dadK );
+
+        // one Newton step, kept inside the bracket
+        Kc = Lgm_KofAlpha_Interped( a, imin, m );
+        if ( Kc >= 0.0 ) {
+            am = a + (K[k] - Kc)*dadK;
+            if ( (am <= y[i]) && (am >= y[i+1]) ) a = am;
+        }
+
+        Alpha[k] = a;
+        ++nGood;
+
+    }
+
+    return( nGood );
+
+}
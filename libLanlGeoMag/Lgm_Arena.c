@@ -0,0 +1,543 @@
+/*! \file Lgm_Arena.c
+ *
+ *  \brief Arena (bump) allocators that can be put behind the LGM_ARRAY_* macros.
+ *
+ *  See Lgm/Lgm_Arena.h for how these are meant to be used.
+ *
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define LGM_USABLE_SIZE( p )    malloc_size( p )
+#else
+#include <malloc.h>
+#define LGM_USABLE_SIZE( p )    malloc_usable_size( p )
+#endif
+#if USE_OPENMP
+#include <omp.h>
+#endif
+#include "Lgm/Lgm_Arena.h"
+
+#ifndef TRUE
+#define TRUE    1
+#endif
+#ifndef FALSE
+#define FALSE   0
+#endif
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+
+/*
+ *  The arena (if any) bound to each thread.
+ */
+static Lgm_Arena *Lgm_CurrentArena = NULL;
+#if USE_OPENMP
+#pragma omp threadprivate(Lgm_CurrentArena)
+#endif
+
+/*
+ *  All arena chunks are carved out of one range of address space that is
+ *  reserved (with no access and no memory behind it) the first time a chunk
+ *  is needed. Pages are made accessible while they belong to a chunk and are
+ *  given back (and made inaccessible again) when the chunk goes away, but
+ *  the range itself is never released. So a pointer is arena memory if and
+ *  only if it lies in [ Lgm_ArenaRegionLo, Lgm_ArenaRegionLo +
+ *  LGM_ARENA_REGION_SIZE ), for as long as the process runs. The free parts of the range below Lgm_ArenaRegionTop
+ *  are kept in an address-ordered list.
+ */
+#define LGM_ARENA_REGION_SIZE   ( ( sizeof(void *) >= 8 ) ? ( (size_t)1 << 36 ) : ( (size_t)1 << 28 ) )
+
+typedef struct Lgm_ArenaExtent {
+
+    struct Lgm_ArenaExtent  *Next;
+    unsigned char           *Mem;
+    size_t                  Size;
+
+} Lgm_ArenaExtent;
+
+static unsigned char    *Lgm_ArenaRegionLo  = NULL;
+static size_t           Lgm_ArenaRegionTop  = 0;
+static int              Lgm_ArenaRegionFail = FALSE;
+static Lgm_ArenaExtent  *Lgm_ArenaFreeList  = NULL;
+
+static int          Lgm_HeapInstrumented = FALSE;
+static Lgm_HeapStats Lgm_Heap        = { 0, 0, 0, 0 };
+
+
+/*
+ *  Get Size bytes (a multiple of the page size) of accessible, zeroed memory
+ *  from the region. Returns NULL if the region could not be reserved or is
+ *  full.
+ */
+static unsigned char *Lgm_ArenaRegion_Get( size_t Size ) {
+
+    unsigned char   *p = NULL;
+    void            *Addr;
+    Lgm_ArenaExtent *e, **pe;
+
+#if USE_OPENMP
+    #pragma omp critical(Lgm_ArenaRegion)
+#endif
+    {
+        if ( ( Lgm_ArenaRegionLo == NULL ) && !Lgm_ArenaRegionFail ) {
+            Addr = mmap( NULL, LGM_ARENA_REGION_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+            if ( Addr == MAP_FAILED ) {
+                fprintf( stderr, "Lgm_Arena: Could not reserve address space for arenas. LGM_ARRAY_* memory will come from the heap.\n" );
+                Lgm_ArenaRegionFail = TRUE;
+            } else {
+                Lgm_ArenaRegionLo = (unsigned char *)Addr;
+            }
+        }
+
+        if ( Lgm_ArenaRegionLo != NULL ) {
+
+            // First fit from the free list, else off the top.
+            for ( pe = &Lgm_ArenaFreeList; *pe && ( (*pe)->Size < Size ); pe = &(*pe)->Next );
+            if ( ( e = *pe ) != NULL ) {
+                p = e->Mem;
+                if ( e->Size == Size ) {
+                    *pe = e->Next;
+                    free( e );
+                } else {
+                    e->Mem  += Size;
+                    e->Size -= Size;
+                }
+            } else if ( Size <= LGM_ARENA_REGION_SIZE - Lgm_ArenaRegionTop ) {
+                p = Lgm_ArenaRegionLo + Lgm_ArenaRegionTop;
+                Lgm_ArenaRegionTop += Size;
+            }
+
+            // (If this fails the range is simply not used again.)
+            if ( ( p != NULL ) && ( mprotect( p, Size, PROT_READ | PROT_WRITE ) != 0 ) ) {
+                fprintf( stderr, "Lgm_Arena: Could not commit %lu bytes of arena memory\n", (unsigned long)Size );
+                p = NULL;
+            }
+
+        }
+    }
+
+    return( p );
+
+}
+
+/*
+ *  Give memory from Lgm_ArenaRegion_Get() back. Its pages are discarded (so
+ *  they read as zeros when next handed out) and made inaccessible.
+ */
+static void Lgm_ArenaRegion_Put( unsigned char *p, size_t Size ) {
+
+    Lgm_ArenaExtent *e, *Prev, *New;
+
+    madvise( p, Size, MADV_DONTNEED );
+    mprotect( p, Size, PROT_NONE );
+
+#if USE_OPENMP
+    #pragma omp critical(Lgm_ArenaRegion)
+#endif
+    {
+        for ( Prev = NULL, e = Lgm_ArenaFreeList; e && ( e->Mem < p ); Prev = e, e = e->Next );
+
+        if ( Prev && ( Prev->Mem + Prev->Size == p ) ) {
+            Prev->Size += Size;
+            New = Prev;
+        } else {
+            New = (Lgm_ArenaExtent *)calloc( 1, sizeof(Lgm_ArenaExtent) );
+            New->Mem  = p;
+            New->Size = Size;
+            New->Next = e;
+            if ( Prev ) Prev->Next = New; else Lgm_ArenaFreeList = New;
+        }
+        if ( e && ( New->Mem + New->Size == e->Mem ) ) {
+            New->Size += e->Size;
+            New->Next  = e->Next;
+            free( e );
+        }
+    }
+
+}
+
+
+/**
+ *  Is p arena memory? This only compares p with the bounds of the address
+ *  range that arena chunks come from; it takes no locks and does not look at
+ *  p (or at any arena), so it works for memory from arenas that have since
+ *  been reset or destroyed.
+ *
+ *      \param[in]      p           Pointer to test (may be NULL).
+ *
+ *      \returns        TRUE or FALSE.
+ */
+int Lgm_Arena_IsArenaMem( void *p ) {
+
+    unsigned char   *q = (unsigned char *)p, *Lo = Lgm_ArenaRegionLo;
+
+    return( ( Lo != NULL ) && ( q >= Lo ) && ( (size_t)( q - Lo ) < LGM_ARENA_REGION_SIZE ) );
+
+}
+
+
+
+
+/**
+ *  Create an arena.
+ *
+ *      \param[in]      Name        A name for the arena (used in Lgm_Arena_PrintStats()).
+ *      \param[in]      ChunkSize   Size of the chunks to get from the heap (bytes). If 0, LGM_ARENA_DEFAULT_CHUNK is used.
+ *
+ *      \returns        The arena (free with Lgm_Arena_Destroy()).
+ */
+Lgm_Arena *Lgm_Arena_Create( const char *Name, size_t ChunkSize ) {
+
+    Lgm_Arena   *a;
+
+    a = (Lgm_Arena *)calloc( 1, sizeof(Lgm_Arena) );
+    strncpy( a->Name, (Name) ? Name : "", 63 );
+    a->ChunkSize = ( ChunkSize > 0 ) ? ChunkSize : LGM_ARENA_DEFAULT_CHUNK;
+
+    return( a );
+
+}
+
+
+/**
+ *  Destroy an arena (and everything that was allocated from it). If it is
+ *  bound to the calling thread, it is unbound. Calling Lgm_Free() (or the
+ *  LGM_ARRAY_*_FREE macros) on memory that came from the arena is still
+ *  allowed afterwards (it does nothing).
+ *
+ *      \param[in]      a           The arena.
+ */
+void Lgm_Arena_Destroy( Lgm_Arena *a ) {
+
+    Lgm_ArenaChunk  *c, *Next;
+
+    if ( a == NULL ) return;
+    if ( Lgm_CurrentArena == a ) Lgm_CurrentArena = NULL;
+
+    for ( c = a->First; c; c = Next ) {
+        Next = c->Next;
+        Lgm_ArenaRegion_Put( c->Mem, c->Size );
+        free( c );
+    }
+    free( a );
+
+}
+
+
+/**
+ *  Release everything that was allocated from an arena. Its chunks are kept
+ *  for reuse.
+ *
+ *      \param[in]      a           The arena.
+ */
+void Lgm_Arena_Reset( Lgm_Arena *a ) {
+
+    Lgm_ArenaChunk  *c;
+
+    for ( c = a->First; c; c = c->Next ) c->Used = 0;
+    a->Current = a->First;
+    a->InUse   = 0;
+    ++(a->nResets);
+
+}
+
+
+/**
+ *  Get the current position of an arena (to go back to later with
+ *  Lgm_Arena_Release()).
+ *
+ *      \param[in]      a           The arena.
+ *
+ *      \returns        The mark.
+ */
+Lgm_ArenaMark Lgm_Arena_Mark( Lgm_Arena *a ) {
+
+    Lgm_ArenaMark   m;
+
+    m.Chunk = a->Current;
+    m.Used  = ( a->Current ) ? a->Current->Used : 0;
+    m.InUse = a->InUse;
+
+    return( m );
+
+}
+
+
+/**
+ *  Release everything that was allocated from an arena since Mark was
+ *  taken.
+ *
+ *      \param[in]      a           The arena.
+ *      \param[in]      Mark        A mark from Lgm_Arena_Mark().
+ */
+void Lgm_Arena_Release( Lgm_Arena *a, Lgm_ArenaMark Mark ) {
+
+    Lgm_ArenaChunk  *c;
+
+    if ( Mark.Chunk == NULL ) {
+        Lgm_Arena_Reset( a );
+        return;
+    }
+
+    Mark.Chunk->Used = Mark.Used;
+    for ( c = Mark.Chunk->Next; c; c = c->Next ) c->Used = 0;
+    a->Current = Mark.Chunk;
+    a->InUse   = Mark.InUse;
+    ++(a->nResets);
+
+}
+
+
+/**
+ *  Allocate (zeroed) memory for n objects of the given size from an arena.
+ *  The memory is aligned to LGM_ARENA_ALIGN bytes.
+ *
+ *      \param[in]      a           The arena.
+ *      \param[in]      n           Number of objects.
+ *      \param[in]      size        Size of each object.
+ *
+ *      \returns        Pointer to the memory, or NULL if a new chunk could not be had.
+ */
+void *Lgm_Arena_Alloc( Lgm_Arena *a, size_t n, size_t size ) {
+
+    size_t          Bytes, Rounded, Size, Page;
+    Lgm_ArenaChunk  *c, *Last;
+    void            *p;
+
+    Bytes   = n*size;
+    Rounded = ( Bytes + LGM_ARENA_ALIGN - 1 ) & ~((size_t)LGM_ARENA_ALIGN - 1);
+    if ( Rounded == 0 ) Rounded = LGM_ARENA_ALIGN;
+
+    /*
+     *  Chunks past the current one are empty, so use the first one that is
+     *  big enough. Otherwise add a new one on the end.
+     */
+    for ( c = a->Current; c && ( c->Used + Rounded > c->Size ); c = c->Next );
+    if ( c == NULL ) {
+
+        Size = ( Rounded > a->ChunkSize ) ? Rounded : a->ChunkSize;
+        Page = (size_t)sysconf( _SC_PAGESIZE );
+        Size = ( Size + Page - 1 )/Page*Page;
+        c = (Lgm_ArenaChunk *)calloc( 1, sizeof(Lgm_ArenaChunk) );
+        if ( c == NULL ) return( NULL );
+        if ( ( c->Mem = Lgm_ArenaRegion_Get( Size ) ) == NULL ) {
+            free( c );
+            return( NULL );
+        }
+        c->Data = c->Mem;
+        c->Size = Size;
+
+        if ( a->First == NULL ) {
+            a->First = c;
+        } else {
+            for ( Last = a->First; Last->Next; Last = Last->Next );
+            Last->Next = c;
+        }
+        a->ChunkBytes += Size;
+        ++(a->nChunks);
+
+    }
+
+    p = c->Data + c->Used;
+    c->Used   += Rounded;
+    a->Current = c;
+    memset( p, 0, Bytes );
+
+    a->InUse      += Rounded;
+    a->TotalBytes += Bytes;
+    ++(a->nAllocs);
+    if ( a->InUse > a->PeakBytes ) a->PeakBytes = a->InUse;
+
+    return( p );
+
+}
+
+
+/**
+ *  Does p point into one of the arena's chunks?
+ *
+ *      \param[in]      a           The arena.
+ *      \param[in]      p           Pointer to test.
+ *
+ *      \returns        TRUE or FALSE.
+ */
+int Lgm_Arena_Owns( Lgm_Arena *a, void *p ) {
+
+    Lgm_ArenaChunk  *c;
+    unsigned char   *q = (unsigned char *)p;
+
+    for ( c = a->First; c; c = c->Next ) {
+        if ( ( q >= c->Data ) && ( q < c->Data + c->Size ) ) return( TRUE );
+    }
+
+    return( FALSE );
+
+}
+
+
+/**
+ *  Bind an arena to the calling thread, so that the LGM_ARRAY_* macros
+ *  allocate from it. Pass NULL to go back to the heap.
+ *
+ *      \param[in]      a           The arena (or NULL).
+ *
+ *      \returns        The arena that was bound before (so that bindings can be nested).
+ */
+Lgm_Arena *Lgm_Arena_Bind( Lgm_Arena *a ) {
+
+    Lgm_Arena   *Prev = Lgm_CurrentArena;
+
+    Lgm_CurrentArena = a;
+
+    return( Prev );
+
+}
+
+
+/**
+ *  Returns the arena bound to the calling thread (or NULL).
+ */
+Lgm_Arena *Lgm_Arena_Current( void ) {
+
+    return( Lgm_CurrentArena );
+
+}
+
+
+/**
+ *  Print the usage statistics of an arena.
+ *
+ *      \param[in]      a           The arena. If NULL, the heap statistics (see Lgm_Arena_Instrument()) are printed.
+ *      \param[in]      fp          Where to print them.
+ */
+void Lgm_Arena_PrintStats( Lgm_Arena *a, FILE *fp ) {
+
+    Lgm_HeapStats   h;
+
+    if ( a == NULL ) {
+        Lgm_Arena_GetHeapStats( &h );
+        fprintf( fp, "Heap (LGM_ARRAY_*): nAllocs = %ld  TotalBytes = %lu  PeakBytes = %lu  InUse = %lu\n",
+                    h.nAllocs, (unsigned long)h.TotalBytes, (unsigned long)h.PeakBytes, (unsigned long)h.InUse );
+        return;
+    }
+
+    fprintf( fp, "Arena \"%s\": nAllocs = %ld  TotalBytes = %lu  PeakBytes = %lu  InUse = %lu  nChunks = %d (%lu bytes)  nResets = %ld\n",
+                a->Name, a->nAllocs, (unsigned long)a->TotalBytes, (unsigned long)a->PeakBytes, (unsigned long)a->InUse,
+                a->nChunks, (unsigned long)a->ChunkBytes, a->nResets );
+
+}
+
+
+/**
+ *  Turn on (or off) the accounting of LGM_ARRAY_* allocations that go to the
+ *  heap (i.e. that are made with no arena bound). TotalBytes counts the
+ *  bytes asked for; InUse and PeakBytes count the usable size of the blocks
+ *  (as malloc_usable_size() reports it), so that Lgm_Free() can take them
+ *  off again without a header. Blocks given to plain free() are not seen.
+ *
+ *      \param[in]      Flag        TRUE or FALSE.
+ */
+void Lgm_Arena_Instrument( int Flag ) {
+
+    Lgm_HeapInstrumented = Flag;
+
+}
+
+
+/**
+ *  Get the heap statistics gathered while instrumented.
+ *
+ *      \param[out]     s           The statistics.
+ */
+void Lgm_Arena_GetHeapStats( Lgm_HeapStats *s ) {
+
+#if USE_OPENMP
+    #pragma omp critical(Lgm_HeapStats)
+#endif
+    {
+        *s = Lgm_Heap;
+    }
+
+}
+
+
+/**
+ *  calloc() replacement used by the LGM_ARRAY_* macros. Allocates from the
+ *  arena bound to the calling thread if there is one (and it can get the
+ *  memory). Otherwise this is just calloc().
+ */
+void *Lgm_Calloc( size_t n, size_t size ) {
+
+    Lgm_Arena       *a;
+    void            *p;
+    size_t          Bytes;
+
+    if ( ( a = Lgm_CurrentArena ) != NULL ) {
+        if ( ( size > 0 ) && ( n > SIZE_MAX/size ) ) return( NULL );
+        if ( ( p = Lgm_Arena_Alloc( a, n, size ) ) != NULL ) return( p );
+    }
+
+    if ( ( p = calloc( n, size ) ) == NULL ) return( NULL );
+
+    if ( Lgm_HeapInstrumented ) {
+        Bytes = LGM_USABLE_SIZE( p );
+#if USE_OPENMP
+        #pragma omp critical(Lgm_HeapStats)
+#endif
+        {
+            Lgm_Heap.InUse      += Bytes;
+            Lgm_Heap.TotalBytes += n*size;
+            ++Lgm_Heap.nAllocs;
+            if ( Lgm_Heap.InUse > Lgm_Heap.PeakBytes ) Lgm_Heap.PeakBytes = Lgm_Heap.InUse;
+        }
+    }
+
+    return( p );
+
+}
+
+
+/**
+ *  free() replacement used by the LGM_ARRAY_*_FREE macros. Arena memory is
+ *  left alone (it goes back when the arena is reset); anything else is
+ *  free()'d. So this is also fine for memory that came from plain calloc()
+ *  (e.g. the data blocks given to the LGM_ARRAY_FROM_DATA_* macros), and
+ *  heap memory from Lgm_Calloc() may equally be given to plain free().
+ *
+ *  Arena memory is recognized by its address alone (see
+ *  Lgm_Arena_IsArenaMem()), so this takes no locks and is a no-op for memory
+ *  from an arena that has since been reset or destroyed.
+ */
+void Lgm_Free( void *p ) {
+
+    size_t  Bytes;
+
+    if ( ( p == NULL ) || Lgm_Arena_IsArenaMem( p ) ) return;
+
+    if ( Lgm_HeapInstrumented ) {
+        Bytes = LGM_USABLE_SIZE( p );
+#if USE_OPENMP
+        #pragma omp critical(Lgm_HeapStats)
+#endif
+        {
+            Lgm_Heap.InUse = ( Lgm_Heap.InUse > Bytes ) ? Lgm_Heap.InUse - Bytes : 0;
+        }
+    }
+
+    free( p );
+
+}
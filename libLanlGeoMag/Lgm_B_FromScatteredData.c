@@ -432,6 +432,9 @@ int Lgm_B_FromScatteredData2( Lgm_Vector *v, Lgm_Vector *B, Lgm_MagModelInfo *In
     } else {
 
         B1.x = B1.y = B1.z = 0.0;
+        Info->RBF_dBdx.x = Info->RBF_dBdx.y = Info->RBF_dBdx.z = 0.0;
+        Info->RBF_dBdy.x = Info->RBF_dBdy.y = Info->RBF_dBdy.z = 0.0;
+        Info->RBF_dBdz.x = Info->RBF_dBdz.y = Info->RBF_dBdz.z = 0.0;
 
     }
 
@@ -690,6 +693,9 @@ Info->RBF_Eps = 1.0/(d2min);
     } else {
 
         B1.x = B1.y = B1.z = 0.0;
+        Info->RBF_dBdx.x = Info->RBF_dBdx.y = Info->RBF_dBdx.z = 0.0;
+        Info->RBF_dBdy.x = Info->RBF_dBdy.y = Info->RBF_dBdy.z = 0.0;
+        Info->RBF_dBdz.x = Info->RBF_dBdz.y = Info->RBF_dBdz.z = 0.0;
 
     }
 
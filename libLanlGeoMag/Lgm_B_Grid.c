@@ -0,0 +1,539 @@
+/*! \file Lgm_B_Grid.c
+ *
+ *  \brief Precomputed, adaptively refined grid of a magnetic field model.
+ *
+ *  Models like TS04 or T01S cost a lot per evaluation, and codes that trace
+ *  many field lines (L*, drift shells, etc.) call them millions of times for
+ *  the very same set of model parameters. Lgm_B_Grid_Build() samples the
+ *  model once (for the parameters/time currently set in the
+ *  Lgm_MagModelInfo structure) onto an octree of cells in GSM and
+ *  Lgm_B_Grid() then interpolates from it.
+ *
+ *  Only the external part of the model (B minus the internal field) is
+ *  gridded. It is smooth everywhere inside the magnetosphere so it
+ *  interpolates well. The internal field (which has the steep r^-3 gradients
+ *  and all the structure near the Earth) is always evaluated directly, so
+ *  div B and the near-Earth field are as good as the internal model itself.
+ *
+ *  Each leaf cell holds a 4x4x4 lattice of samples (equally spaced, including
+ *  the cell faces) and is interpolated with tricubic Lagrange polynomials.
+ *  A cell is split into 8 children whenever the interpolated field differs
+ *  from the model by more than Tol (nT) at any of 9 test points (the cell
+ *  center and the centers of its 8 octants), or any sample is not finite,
+ *  and MaxLevel has not been reached. A leaf that still fails those tests
+ *  (e.g. the cells at the origin, where the models are singular) is not
+ *  interpolated at all: the source model is called directly inside it.
+ *
+ *  Only the samples are stored (no derivatives), so the interpolant is
+ *  continuous across faces shared by leaves of the same size (they use the
+ *  same 16 face samples), but only continuous to within about Tol across
+ *  faces where the refinement level changes. Nor is it constructed to be
+ *  divergence-free; div B of the gridded external field is only as small as
+ *  the interpolation error allows.
+ *
+ *  Typical usage;
+ *
+ *      Lgm_Set_Coord_Transforms( Date, UTC, mInfo->c );
+ *      Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_TS04, mInfo );
+ *      ... set Kp, P, etc ...
+ *      g = Lgm_B_Grid_Build( -30.0, 15.0, -20.0, 20.0, -15.0, 15.0, 2.5, 0.1, 4, mInfo );
+ *      Lgm_Set_Lgm_B_Grid( g, mInfo );
+ *      ... trace, compute L*, etc ...
+ *      Lgm_B_Grid_Free( g );
+ *
+ *  The grid is only valid for the model parameters and time that were set
+ *  when it was built. Copies of mInfo made with Lgm_CopyMagInfo() share the
+ *  (read-only) grid, so it must not be freed while they are still in use.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+#if USE_OPENMP
+#include <omp.h>
+#endif
+#include "Lgm/Lgm_B_Grid.h"
+
+#define LGM_B_GRID_NDATA    192     // 4*4*4*3 doubles per leaf
+#define LGM_B_GRID_NTEST    9       // number of test points per cell
+#define LGM_B_GRID_DIRECT   (-2)    // iData of a leaf where the source model is used directly
+
+
+/*
+ *  Lagrange weights for 4 equally spaced nodes at
+ *  t = 0, 1, 2, 3.
+ */
+static void Lgm_B_Grid_Weights( double t, double w[4] ) {
+
+    double  t0 = t, t1 = t-1.0, t2 = t-2.0, t3 = t-3.0;
+
+    w[0] = -t1*t2*t3/6.0;
+    w[1] =  t0*t2*t3/2.0;
+    w[2] = -t0*t1*t3/2.0;
+    w[3] =  t0*t1*t2/6.0;
+
+}
+
+
+/*
+ *  Interpolate the external field at v within a leaf cell.
+ */
+static void Lgm_B_Grid_InterpCell( Lgm_Vector *v, Lgm_B_GridCell *c, double *Data, Lgm_Vector *B ) {
+
+    double  wx[4], wy[4], wz[4], f, wyz, *d;
+    int     i, j, k;
+
+    f = 3.0/c->h;
+    Lgm_B_Grid_Weights( (v->x - c->x0)*f, wx );
+    Lgm_B_Grid_Weights( (v->y - c->y0)*f, wy );
+    Lgm_B_Grid_Weights( (v->z - c->z0)*f, wz );
+
+    B->x = B->y = B->z = 0.0;
+    d = Data + c->iData;
+    for ( k=0; k<4; k++ ) {
+        for ( j=0; j<4; j++ ) {
+            wyz = wy[j]*wz[k];
+            for ( i=0; i<4; i++ ) {
+                f = wx[i]*wyz;
+                B->x += f*d[0]; B->y += f*d[1]; B->z += f*d[2];
+                d += 3;
+            }
+        }
+    }
+
+}
+
+
+/*
+ *  Evaluate the internal field selected by InternalModel.
+ */
+int Lgm_B_Grid_Internal( Lgm_Vector *v, Lgm_Vector *B, int InternalModel, Lgm_MagModelInfo *Info ) {
+
+    switch ( InternalModel ){
+
+        case LGM_CDIP:
+                        Lgm_B_cdip( v, B, Info );
+                        break;
+        case LGM_EDIP:
+                        Lgm_B_edip( v, B, Info );
+                        break;
+        case LGM_IGRF:
+                        Lgm_B_igrf( v, B, Info );
+                        break;
+        default:
+                        fprintf(stderr, "Lgm_B_Grid_Internal: Unknown internal model (%d)\n", InternalModel);
+                        B->x = B->y = B->z = 0.0;
+                        return(0);
+                        break;
+
+    }
+
+    return(1);
+
+}
+
+
+/*
+ *  External part of the source model.
+ */
+static void Lgm_B_Grid_Ext( Lgm_Vector *v, Lgm_Vector *B, Lgm_B_GridInfo *g, Lgm_MagModelInfo *Info ) {
+
+    Lgm_Vector  Bint;
+
+    g->Bsrc( v, B, Info );
+    Lgm_B_Grid_Internal( v, &Bint, g->InternalModel, Info );
+    B->x -= Bint.x; B->y -= Bint.y; B->z -= Bint.z;
+
+}
+
+
+/*
+ *  Sample a cell and decide whether it needs to be split. Samples go into
+ *  Data[0..191]. Returns the max error found at the test points (HUGE_VAL if
+ *  any sample or test value is not finite).
+ */
+static double Lgm_B_Grid_SampleCell( Lgm_B_GridCell *c, double *Data, Lgm_B_GridInfo *g, Lgm_MagModelInfo *Info ) {
+
+    Lgm_B_GridCell  cc;
+    Lgm_Vector      v, B, Bi;
+    double          h3, q, err, MaxErr;
+    int             i, j, k, n, ox, oy, oz;
+
+    h3 = c->h/3.0;
+    n  = 0;
+    for ( k=0; k<4; k++ ) {
+        for ( j=0; j<4; j++ ) {
+            for ( i=0; i<4; i++ ) {
+                v.x = c->x0 + i*h3; v.y = c->y0 + j*h3; v.z = c->z0 + k*h3;
+                Lgm_B_Grid_Ext( &v, &B, g, Info );
+                Data[n++] = B.x; Data[n++] = B.y; Data[n++] = B.z;
+            }
+        }
+    }
+    for ( n=0; n<LGM_B_GRID_NDATA; n++ ) if ( !isfinite( Data[n] ) ) return( HUGE_VAL );
+
+    /*
+     *  Test points: the cell center and the centers of the 8 octants.
+     */
+    cc = *c; cc.iData = 0;
+    MaxErr = 0.0;
+    for ( n=0; n<LGM_B_GRID_NTEST; n++ ) {
+        if ( n == 0 ) {
+            v.x = c->x0 + 0.5*c->h; v.y = c->y0 + 0.5*c->h; v.z = c->z0 + 0.5*c->h;
+        } else {
+            ox = (n-1)&1; oy = ((n-1)>>1)&1; oz = ((n-1)>>2)&1;
+            q = 0.25*c->h;
+            v.x = c->x0 + q*(1+2*ox); v.y = c->y0 + q*(1+2*oy); v.z = c->z0 + q*(1+2*oz);
+        }
+        Lgm_B_Grid_Ext( &v, &B, g, Info );
+        Lgm_B_Grid_InterpCell( &v, &cc, Data, &Bi );
+        err = fabs( Bi.x - B.x );
+        if ( fabs( Bi.y - B.y ) > err ) err = fabs( Bi.y - B.y );
+        if ( fabs( Bi.z - B.z ) > err ) err = fabs( Bi.z - B.z );
+        if ( !isfinite( err ) ) return( HUGE_VAL );
+        if ( err > MaxErr ) MaxErr = err;
+    }
+
+    return( MaxErr );
+
+}
+
+
+/*
+ *  Returns TRUE if the cell lies entirely inside the Earth. These are never
+ *  refined (the models are not meaningful there anyway).
+ */
+static int Lgm_B_Grid_InsideEarth( Lgm_B_GridCell *c ) {
+
+    double  x, y, z;
+
+    x = ( fabs(c->x0) > fabs(c->x0+c->h) ) ? c->x0 : c->x0+c->h;
+    y = ( fabs(c->y0) > fabs(c->y0+c->h) ) ? c->y0 : c->y0+c->h;
+    z = ( fabs(c->z0) > fabs(c->z0+c->h) ) ? c->z0 : c->z0+c->h;
+
+    return( ( x*x + y*y + z*z < 1.0 ) ? TRUE : FALSE );
+
+}
+
+
+static double Lgm_B_Grid_WallTime( ) {
+    struct timeval  tv;
+    gettimeofday( &tv, NULL );
+    return( (double)tv.tv_sec + 1e-6*(double)tv.tv_usec );
+}
+
+
+/**
+ *  Build a gridded copy of the model currently set in m.
+ *
+ *      \param[in]      xmin, xmax  Extent of the grid box in X (GSM, Re).
+ *      \param[in]      ymin, ymax  Extent of the grid box in Y (GSM, Re).
+ *      \param[in]      zmin, zmax  Extent of the grid box in Z (GSM, Re).
+ *      \param[in]      h0          Size of the top-level cells (Re). The box is rounded up to a whole number of them.
+ *      \param[in]      Tol         Max allowed interpolation error in each component of the external field (nT).
+ *      \param[in]      MaxLevel    Max number of times a top-level cell may be split.
+ *      \param[in]      m           Lgm_MagModelInfo structure with the model (and its parameters) already set.
+ *
+ *      \return  A pointer to the grid (free with Lgm_B_Grid_Free()), or NULL on failure.
+ *
+ */
+Lgm_B_GridInfo *Lgm_B_Grid_Build( double xmin, double xmax, double ymin, double ymax, double zmin, double zmax,
+                                  double h0, double Tol, int MaxLevel, Lgm_MagModelInfo *m ) {
+
+    Lgm_B_GridInfo      *g;
+    Lgm_B_GridCell      *Cur, *Next, *c;
+    Lgm_MagModelInfo    *mInfo2;
+    double              *Samples, *Err, t0;
+    long int            nEvals;
+    int                 i, j, k, n, nCur, nNext, nCellsAlloced, Level, Split, oct;
+    long int            nDataAlloced;
+
+    if ( (h0 <= 0.0) || (xmax <= xmin) || (ymax <= ymin) || (zmax <= zmin) ) {
+        printf("Lgm_B_Grid_Build(): Invalid grid box or cell size.\n");
+        return( NULL );
+    }
+    if ( m->Bfield == Lgm_B_Grid ) {
+        printf("Lgm_B_Grid_Build(): Bfield is already a grid. Set the source model first.\n");
+        return( NULL );
+    }
+
+    t0 = Lgm_B_Grid_WallTime( );
+
+    g = (Lgm_B_GridInfo *)calloc( 1, sizeof( Lgm_B_GridInfo ) );
+    g->nx = (int)ceil( (xmax-xmin)/h0 ); g->xmin = xmin; g->xmax = xmin + g->nx*h0;
+    g->ny = (int)ceil( (ymax-ymin)/h0 ); g->ymin = ymin; g->ymax = ymin + g->ny*h0;
+    g->nz = (int)ceil( (zmax-zmin)/h0 ); g->zmin = zmin; g->zmax = zmin + g->nz*h0;
+    g->h0 = h0;
+    g->Tol = Tol;
+    g->MaxLevel = MaxLevel;
+    g->Bsrc = m->Bfield;
+    g->InternalModel = m->InternalModel;
+
+    /*
+     *  The top-level cells go first in Cells[], in x-fastest order.
+     */
+    nCur = g->nx*g->ny*g->nz;
+    nCellsAlloced = 2*nCur;
+    g->Cells = (Lgm_B_GridCell *)calloc( nCellsAlloced, sizeof( Lgm_B_GridCell ) );
+    for ( k=0; k<g->nz; k++ ) {
+        for ( j=0; j<g->ny; j++ ) {
+            for ( i=0; i<g->nx; i++ ) {
+                c = &g->Cells[ (k*g->ny + j)*g->nx + i ];
+                c->x0 = xmin + i*h0; c->y0 = ymin + j*h0; c->z0 = zmin + k*h0; c->h = h0;
+                c->Child = -1; c->iData = -1;
+            }
+        }
+    }
+    g->nCells = nCur;
+
+    nDataAlloced = (long int)nCur*LGM_B_GRID_NDATA;
+    g->Data = (double *)calloc( nDataAlloced, sizeof(double) );
+
+
+    /*
+     *  Build level by level. Cur[] holds indices (stored in the Child field
+     *  of temporary cell copies) of the cells at the current level.
+     */
+    Cur = (Lgm_B_GridCell *)calloc( nCur, sizeof( Lgm_B_GridCell ) );
+    for ( n=0; n<nCur; n++ ) { Cur[n] = g->Cells[n]; Cur[n].Child = n; }
+
+    nEvals = 0;
+    for ( Level=0; nCur > 0; Level++ ) {
+
+        Samples = (double *)calloc( (long int)nCur*LGM_B_GRID_NDATA, sizeof(double) );
+        Err     = (double *)calloc( nCur, sizeof(double) );
+
+        #if USE_OPENMP
+        #pragma omp parallel private(mInfo2,n)
+        #endif
+        {
+            mInfo2 = Lgm_CopyMagInfo( m );
+            #if USE_OPENMP
+            #pragma omp for schedule(dynamic,4)
+            #endif
+            for ( n=0; n<nCur; n++ ) {
+                Err[n] = Lgm_B_Grid_SampleCell( &Cur[n], Samples + (long int)n*LGM_B_GRID_NDATA, g, mInfo2 );
+            }
+            Lgm_FreeMagInfo( mInfo2 );
+        }
+        nEvals += (long int)nCur*(64+LGM_B_GRID_NTEST);
+
+
+        /*
+         *  Either store the samples (leaf) or split the cell.
+         */
+        nNext = 0;
+        Next  = (Lgm_B_GridCell *)calloc( 8*nCur, sizeof( Lgm_B_GridCell ) );
+        for ( n=0; n<nCur; n++ ) {
+
+            // (Written so that a NaN error also splits.)
+            Split = ( !(Err[n] <= Tol) && (Level < MaxLevel) && !Lgm_B_Grid_InsideEarth( &Cur[n] ) ) ? TRUE : FALSE;
+            c = &g->Cells[ Cur[n].Child ];
+
+            if ( !Split && !(Err[n] <= Tol) ) {
+
+                c->iData = LGM_B_GRID_DIRECT;
+                c->Child = -1;
+                ++g->nLeaves;
+                ++g->nDirect;
+
+            } else if ( !Split ) {
+
+                if ( g->nData + LGM_B_GRID_NDATA > nDataAlloced ) {
+                    nDataAlloced = 2*nDataAlloced + LGM_B_GRID_NDATA;
+                    g->Data = (double *)realloc( g->Data, nDataAlloced*sizeof(double) );
+                }
+                memcpy( g->Data + g->nData, Samples + (long int)n*LGM_B_GRID_NDATA, LGM_B_GRID_NDATA*sizeof(double) );
+                c->iData = g->nData;
+                c->Child = -1;
+                g->nData += LGM_B_GRID_NDATA;
+                ++g->nLeaves;
+                if ( Err[n] > g->MaxErr ) g->MaxErr = Err[n];
+
+            } else {
+
+                if ( g->nCells + 8 > nCellsAlloced ) {
+                    nCellsAlloced = 2*nCellsAlloced + 8;
+                    g->Cells = (Lgm_B_GridCell *)realloc( g->Cells, nCellsAlloced*sizeof( Lgm_B_GridCell ) );
+                    c = &g->Cells[ Cur[n].Child ];
+                }
+                c->Child = g->nCells;
+                c->iData = -1;
+                for ( oct=0; oct<8; oct++ ) {
+                    Lgm_B_GridCell *cc = &g->Cells[ g->nCells + oct ];
+                    cc->h  = 0.5*Cur[n].h;
+                    cc->x0 = Cur[n].x0 + ( (oct&1)      ? cc->h : 0.0 );
+                    cc->y0 = Cur[n].y0 + ( ((oct>>1)&1) ? cc->h : 0.0 );
+                    cc->z0 = Cur[n].z0 + ( ((oct>>2)&1) ? cc->h : 0.0 );
+                    cc->Child = -1; cc->iData = -1;
+                    Next[nNext] = *cc; Next[nNext].Child = g->nCells + oct;
+                    ++nNext;
+                }
+                g->nCells += 8;
+
+            }
+
+        }
+
+        if ( m->VerbosityLevel > 1 ) {
+            printf("Lgm_B_Grid_Build(): Level %d: %d cells, %d split, %d leaves so far.\n", Level, nCur, nNext/8, g->nLeaves );
+        }
+
+        free( Samples );
+        free( Err );
+        free( Cur );
+        Cur  = Next;
+        nCur = nNext;
+
+    }
+    free( Cur );
+
+    /*
+     *  Trim the arrays.
+     */
+    g->Cells = (Lgm_B_GridCell *)realloc( g->Cells, g->nCells*sizeof( Lgm_B_GridCell ) );
+    g->Data  = (double *)realloc( g->Data, g->nData*sizeof(double) );
+
+    g->nBuildEvals = nEvals;
+    g->nBytes      = sizeof( Lgm_B_GridInfo ) + g->nCells*sizeof( Lgm_B_GridCell ) + g->nData*sizeof(double);
+    g->BuildTime   = Lgm_B_Grid_WallTime( ) - t0;
+
+    if ( m->VerbosityLevel > 0 ) Lgm_B_Grid_Report( g );
+
+    return( g );
+
+}
+
+
+void Lgm_B_Grid_Free( Lgm_B_GridInfo *g ) {
+
+    if ( g == NULL ) return;
+    free( g->Cells );
+    free( g->Data );
+    free( g );
+
+}
+
+
+/**
+ *  Magnetic field from the gridded model (internal field + interpolated
+ *  external field). Outside the grid box, and in leaves that could not be
+ *  interpolated to within Tol, the source model is called directly.
+ *
+ *      \param[in]      v       Position (GSM, Re).
+ *      \param[out]     B       Magnetic field (nT).
+ *      \param[in]      Info    Lgm_MagModelInfo structure with Info->BGrid set (see Lgm_Set_Lgm_B_Grid()).
+ *
+ *      \return  1 on success, 0 on failure.
+ *
+ */
+int Lgm_B_Grid( Lgm_Vector *v, Lgm_Vector *B, Lgm_MagModelInfo *Info ) {
+
+    Lgm_B_GridInfo  *g = Info->BGrid;
+    Lgm_B_GridCell  *c;
+    Lgm_Vector      Bext;
+    double          h;
+    int             i, j, k;
+
+    if ( g == NULL ) {
+        fprintf(stderr, "Lgm_B_Grid: No grid has been set (see Lgm_Set_Lgm_B_Grid()).\n");
+        B->x = B->y = B->z = 0.0;
+        return(0);
+    }
+
+    if (   (v->x < g->xmin) || (v->x > g->xmax) || (v->y < g->ymin) || (v->y > g->ymax)
+        || (v->z < g->zmin) || (v->z > g->zmax) ) {
+        return( g->Bsrc( v, B, Info ) );
+    }
+
+    /*
+     *  Find the top-level cell, then descend to the leaf.
+     */
+    i = (int)( (v->x - g->xmin)/g->h0 ); if ( i >= g->nx ) i = g->nx-1;
+    j = (int)( (v->y - g->ymin)/g->h0 ); if ( j >= g->ny ) j = g->ny-1;
+    k = (int)( (v->z - g->zmin)/g->h0 ); if ( k >= g->nz ) k = g->nz-1;
+    c = &g->Cells[ (k*g->ny + j)*g->nx + i ];
+    while ( c->Child >= 0 ) {
+        h = 0.5*c->h;
+        c = &g->Cells[ c->Child + ( (v->x >= c->x0+h) ? 1 : 0 ) + ( (v->y >= c->y0+h) ? 2 : 0 ) + ( (v->z >= c->z0+h) ? 4 : 0 ) ];
+    }
+
+    if ( c->iData == LGM_B_GRID_DIRECT ) return( g->Bsrc( v, B, Info ) );
+
+    Lgm_B_Grid_InterpCell( v, c, g->Data, &Bext );
+    if ( !Lgm_B_Grid_Internal( v, B, g->InternalModel, Info ) ) return(0);
+    B->x += Bext.x; B->y += Bext.y; B->z += Bext.z;
+
+    return(1);
+
+}
+
+
+/**
+ *  Check the grid against the source model at n pseudo-random points in the
+ *  grid box (reproducible sequence), skipping points inside the Earth.
+ *  Returns the max error (nT) found in any component (HUGE_VAL if either one
+ *  is not finite).
+ */
+double Lgm_B_Grid_CheckError( Lgm_B_GridInfo *g, int n, Lgm_MagModelInfo *m ) {
+
+    Lgm_MagModelInfo    *mInfo2;
+    Lgm_Vector          v, B1, B2;
+    unsigned long       r;
+    double              err, MaxErr;
+    int                 i;
+
+    mInfo2 = Lgm_CopyMagInfo( m );
+    mInfo2->BGrid = g;
+
+    r = 12345UL;
+    MaxErr = 0.0;
+    for ( i=0; i<n; i++ ) {
+        r = ( r*1103515245UL + 12345UL ) & 0x7fffffffUL; v.x = g->xmin + (g->xmax-g->xmin)*(double)r/2147483648.0;
+        r = ( r*1103515245UL + 12345UL ) & 0x7fffffffUL; v.y = g->ymin + (g->ymax-g->ymin)*(double)r/2147483648.0;
+        r = ( r*1103515245UL + 12345UL ) & 0x7fffffffUL; v.z = g->zmin + (g->zmax-g->zmin)*(double)r/2147483648.0;
+        if ( Lgm_Magnitude( &v ) < 1.0 ) continue;
+        g->Bsrc( &v, &B1, mInfo2 );
+        Lgm_B_Grid( &v, &B2, mInfo2 );
+        err = fabs( B1.x - B2.x );
+        if ( fabs( B1.y - B2.y ) > err ) err = fabs( B1.y - B2.y );
+        if ( fabs( B1.z - B2.z ) > err ) err = fabs( B1.z - B2.z );
+        if ( !isfinite( err ) ) err = HUGE_VAL;
+        if ( err > MaxErr ) MaxErr = err;
+    }
+
+    Lgm_FreeMagInfo( mInfo2 );
+
+    return( MaxErr );
+
+}
+
+
+void Lgm_B_Grid_Report( Lgm_B_GridInfo *g ) {
+
+    printf("Lgm_B_Grid: Box: [%g, %g] x [%g, %g] x [%g, %g] Re, top-level cells: %d x %d x %d (h0 = %g Re)\n",
+            g->xmin, g->xmax, g->ymin, g->ymax, g->zmin, g->zmax, g->nx, g->ny, g->nz, g->h0 );
+    printf("Lgm_B_Grid: Tol = %g nT, MaxLevel = %d, max error at test points = %g nT\n", g->Tol, g->MaxLevel, g->MaxErr );
+    printf("Lgm_B_Grid: %d cells, %d leaves (%d using the model directly), %.3f MB, %ld model evaluations, build time = %.3f s\n",
+            g->nCells, g->nLeaves, g->nDirect, (double)g->nBytes/1048576.0, g->nBuildEvals, g->BuildTime );
+
+}
+
+
+/**
+ *  Make m use the grid g as its field model. The model (and parameters) that
+ *  g was built from should be the ones set in m, since the source model is
+ *  used outside the grid box.
+ */
+void Lgm_Set_Lgm_B_Grid( Lgm_B_GridInfo *g, Lgm_MagModelInfo *m ) {
+
+    m->BGrid         = g;
+    m->Bfield        = Lgm_B_Grid;
+    m->ExternalModel = LGM_EXTMODEL_GRID;
+    strcpy( m->ExtMagModelStr1, "GRID" );
+    strcpy( m->ExtMagModelStr2, "Gridded Magnetic Field Model" );
+    strcpy( m->ExtMagModelStr3, "Reference: Tricubic interpolation on an adaptive octree grid built with Lgm_B_Grid_Build()." );
+    strcpy( m->ExtMagModelStr4, "Comments: Valid only for the model parameters in effect when the grid was built." );
+
+}
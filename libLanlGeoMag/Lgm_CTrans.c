@@ -80,9 +80,13 @@ void Lgm_free_ctrans_children( Lgm_CTrans *c ) {
         Lgm_FreeJPLephemInfo( c->jpl );
     }
 
-    free( c->l.LeapSecondDates );
-    free( c->l.LeapSecondJDs );
-    free( c->l.LeapSeconds );
+    free( c->SHC_Fold );
+
+    if ( !c->l.Shared ) {
+        free( c->l.LeapSecondDates );
+        free( c->l.LeapSecondJDs );
+        free( c->l.LeapSeconds );
+    }
 }
 
 void Lgm_free_ctrans( Lgm_CTrans *c ) {
@@ -97,6 +101,10 @@ void Lgm_ctransDefaults(Lgm_CTrans *c, int Verbose) {
 
     c->Verbose     = Verbose;
     c->jpl_initialized = FALSE;
+    Lgm_JPLephem_ResetCache( &c->jplCache );
+
+    /* Point at the shared IGRF normalization/recursion tables */
+    Lgm_IGRF_AttachTables( c );
 
     /* Set Number of Nutation series terms to 106 */
     c->pnModel = LGM_PN_IAU76;
@@ -156,12 +164,35 @@ Lgm_CTrans *Lgm_CopyCTrans( Lgm_CTrans *s ) {
     /*
      * Do memcpy. Note that for things that are dynamically allocated in
      * Lgm_CTrans structure, this will copy pointers to to memory that belong
-     * to the source. Currently, the LeapSecond stuff is dynamically allocated,
-     * so we need to allocate our own memory for those and then do a memcpy on
-     * the contents.
+     * to the source. The LeapSecond arrays normally belong to the shared
+     * (read-only) table, in which case copying the pointers is all we need.
+     * Otherwise we need to allocate our own memory for those and then do a
+     * memcpy on the contents. The IGRF recursion coefficients are likewise
+     * shared (see Lgm_IGRF_SharedTables()).
      */
     memcpy( t, s, sizeof(Lgm_CTrans) );
 
+    /*
+     *  The shared ephemeris can be pointed at by any number of structures. A
+     *  privately owned one stays with the source (sharing it would lead to a
+     *  double free); the target attaches the shared one when it needs it.
+     */
+    if ( s->jpl_initialized && !s->jpl->Shared ) {
+        t->jpl = NULL;
+        t->jpl_initialized = FALSE;
+        Lgm_JPLephem_ResetCache( &t->jplCache );
+    }
+
+    /*
+     *  The coefficient set is shared, but the folded coeffs are per-structure
+     *  (they get rebuilt on first use).
+     */
+    t->SHC_Fold  = NULL;
+    t->SHC_nFold = 0;
+    t->SHC_Date  = -1;
+
+    if ( s->l.Shared ) return( t );
+
     /*
      *  Now, copy the LeapSeconds stuff properly (they were dyn. allocated).
      *  (memcpy's args are (dest, src, size))
@@ -478,8 +509,7 @@ void Lgm_Set_Coord_Transforms( long int date, double UTC, Lgm_CTrans *c ) {
     /* Test here for LGM_EPH_DE - if set, make a JPLephemInfo */
     if ( ( c->ephModel == LGM_EPH_DE ) && ( !(c->jpl_initialized) ) ){
 
-        c->jpl = Lgm_InitJPLephemInfo( 421, LGM_DE_SUN|LGM_DE_EARTHMOON, 1);
-        Lgm_ReadJPLephem( c->jpl );
+        c->jpl = Lgm_SharedJPLephem();
         c->jpl_initialized = TRUE;
 
 
@@ -830,14 +860,6 @@ void Lgm_Set_Coord_Transforms( long int date, double UTC, Lgm_CTrans *c ) {
     Lgm_Transpose( c->Agsm_to_gse, c->Agse_to_gsm);
 
 
-    /*  Construct transformation matrix from GSM to WGS84 and vice versa ;
-     * 	Agsm_to_wgs84 = Amod_to_wgs84 * Agsm_to_mod
-     * 	Awgs84_to_gsm = Transpose( Agsm_to_wgs84 )
-     */
-    Lgm_MatTimesMat( c->Amod_to_wgs84, c->Agsm_to_mod, c->Agsm_to_wgs84 );
-    Lgm_Transpose( c->Agsm_to_wgs84, c->Awgs84_to_gsm );
-
-
     /*
      *  Construct Transformation Matricies between  WGS84 and MOD
      *  and between WGS84 and GEI
@@ -849,6 +871,15 @@ void Lgm_Set_Coord_Transforms( long int date, double UTC, Lgm_CTrans *c ) {
     Lgm_Transpose( c->Awgs84_to_gei, c->Agei_to_wgs84 );
 
 
+    /*  Construct transformation matrix from GSM to WGS84 and vice versa ;
+     * 	Agsm_to_wgs84 = Amod_to_wgs84 * Agsm_to_mod
+     * 	Awgs84_to_gsm = Transpose( Agsm_to_wgs84 )
+     *  (Needs Amod_to_wgs84 for this time, so it has to come after the above.)
+     */
+    Lgm_MatTimesMat( c->Amod_to_wgs84, c->Agsm_to_mod, c->Agsm_to_wgs84 );
+    Lgm_Transpose( c->Agsm_to_wgs84, c->Awgs84_to_gsm );
+
+
     /* Compute Moon RA, Dec, distance and phase */
     Lgm_ComputeMoon( c );
 
@@ -1062,6 +1093,9 @@ void Lgm_ComputeSun( Lgm_CTrans *c  ) {
     double        l, r, b, Dec, RA, zec;
     Lgm_Vector    SunICRF, Sunmod, S;
 
+    /*  Use the precomputed table if there is one */
+    if ( Lgm_SunMoonCheb_Sun( c ) ) return;
+
     /*  Compute distance from Earth to the Sun */
     r0          = 1.495985e8;  /* in km */
     epsilon     = c->epsilon*RadPerArcSec; // radians
@@ -1071,7 +1105,7 @@ void Lgm_ComputeSun( Lgm_CTrans *c  ) {
 
     switch (c->ephModel) {
         case LGM_EPH_DE:
-            Lgm_JPL_getSunVector( c->TT.JD, c->jpl, &SunICRF);
+            Lgm_JPL_getSunVector_cached( c->TT.JD, c->jpl, &c->jplCache, &SunICRF );
             c->earth_sun_dist = Lgm_Magnitude( &SunICRF )/Re;
             Lgm_NormalizeVector(&SunICRF);
             c->SunJ2000 = SunICRF;
@@ -1141,6 +1175,11 @@ void Lgm_ComputeMoon( Lgm_CTrans *c ) {
     Lgm_Vector      MoonGCRF, Moonmod;
     int             ephModel;
 
+    /*
+     *  Use the precomputed table if there is one
+     */
+    if ( Lgm_SunMoonCheb_Moon( c ) ) return;
+
     /*
      * Compute Right Ascension and Declination of the Moon in MOD
      */
@@ -1152,7 +1191,7 @@ void Lgm_ComputeMoon( Lgm_CTrans *c ) {
     switch (ephModel) {
         case LGM_EPH_DE:
             /* Compute Right Ascension and Declination of the Moon */
-            Lgm_JPLephem_position( JD, LGM_DE_MOON, c->jpl, &MoonGCRF );
+            Lgm_JPLephem_state( JD, LGM_DE_MOON, c->jpl, &c->jplCache, &MoonGCRF, NULL );
             c->MoonJ2000 = MoonGCRF; // mgh - should this be GCRF or ICRF?
             Lgm_NormalizeVector( &(c->MoonJ2000) );
             Lgm_Convert_Coords( &MoonGCRF, &Moonmod, GEI2000_TO_MOD, c );        
@@ -1558,54 +1597,21 @@ void Lgm_WGS84_to_GeodHeight( Lgm_Vector *uin, double *GeodHeight ) {
  */
 void Lgm_B_igrf_ctrans(Lgm_Vector *v, Lgm_Vector *B, Lgm_CTrans *c) {
 
-    double  st, ct, sp, cp;
-    double  B_r, B_theta, B_phi;
-    double  r, theta, phi;
     Lgm_Vector  w, Bgeo;
 
-
     /*
-     *  Convert Coords to GEO
+     *  Rotate to GEO (WGS84) with the combined GSM->WGS84 matrix (computed
+     *  once per time in Lgm_Set_Coord_Transforms()), evaluate the field in
+     *  cartesian GEO coords (from a user-supplied coefficient set if one has
+     *  been attached), and rotate back.
      */
-    Lgm_Convert_Coords( v, &w, GSM_TO_WGS84, c );
-
-
-    /*
-     *  compute GEO (WGS84) geocentric speherical coords. (r, theta, phi)  theta is colat
-     */
-//    w.x *= Re; w.x /= 6371.2;
-//    w.y *= Re; w.y /= 6371.2;
-//    w.z *= Re; w.z /= 6371.2;
-    r     = sqrt(w.x*w.x + w.y*w.y + w.z*w.z );
-    theta = acos( w.z / r );
-    phi   = atan2(w.y, w.x);
-
-
-    st    = sin( theta ); ct    = cos( theta );
-    sp    = sin( phi );   cp    = cos( phi );
-
-
-    /*
-     *   Compute spherical components of B in GEO (WGS84)
-     */
-    w.x = r; w.y = theta; w.z = phi;
-    Lgm_IGRF( &w, &Bgeo, c );
-    B_r = Bgeo.x; B_theta = Bgeo.y; B_phi = Bgeo.z;
-
-
-
-    /*
-     *  Convert Bgeo to cartesian
-     */
-    Bgeo.x = B_r*st*cp + B_theta*ct*cp - B_phi*sp;
-    Bgeo.y = B_r*st*sp + B_theta*ct*sp + B_phi*cp;
-    Bgeo.z = B_r*ct    - B_theta*st;
-
-    /*
-     *  Convert Coords to GSM
-     */
-    Lgm_Convert_Coords( &Bgeo, B, WGS84_TO_GSM, c );
-
+    Lgm_MatTimesVec( c->Agsm_to_wgs84, v, &w );
+    if ( c->SHCoeffs ) {
+        Lgm_SHCoeffs_B( &w, &Bgeo, c );
+    } else {
+        Lgm_IGRF_Cart( &w, &Bgeo, c );
+    }
+    Lgm_MatTimesVec( c->Awgs84_to_gsm, &Bgeo, B );
 
 }
 
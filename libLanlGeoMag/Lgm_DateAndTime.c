@@ -10,6 +10,9 @@
 #include <stdlib.h>
 #include <math.h>
 #include "Lgm/Lgm_CTrans.h"
+#if USE_OPENMP
+#include <omp.h>
+#endif
 
 
 
@@ -35,6 +38,7 @@ int Lgm_LeapYear(int year) {
  * Lgm_GetLeapSeconds()
  * Lgm_IsLeapSecondDay()
  * Lgm_LoadLeapSeconds()
+ * Lgm_SharedLeapSeconds()
  *
  *
  * Leap seconds are added when necessary. First preference is given to
@@ -83,14 +87,10 @@ double Lgm_GetLeapSeconds( double JD, Lgm_CTrans *c ) {
     /*
      * For dates 1972 to present, leap seconds are stored in the
      * Lgm_LeapSeconds structure.
-     * Parse list in reverse order.
      */
-    for (i=l->nLeapSecondDates-1; i>=0; i--) {
-        // do > and not >= here because the 86400th second is still before the leap second
-        if ( JD >= l->LeapSecondJDs[i] ) {
-            TAI_Minus_UTC = l->LeapSeconds[i];
-            return( TAI_Minus_UTC );
-        }
+    if ( (i = Lgm_LeapSecondIndex( JD, l )) >= 0 ) {
+        TAI_Minus_UTC = l->LeapSeconds[i];
+        return( TAI_Minus_UTC );
     }
 
     /*
@@ -119,6 +119,38 @@ double Lgm_GetLeapSeconds( double JD, Lgm_CTrans *c ) {
 
 
 
+/*
+ * Returns the index of the leap second interval that JD falls in (i.e. the
+ * largest i with JD >= l->LeapSecondJDs[i]), or -1 if JD is before the first
+ * one. The table is bisected, but the interval found last time (l->Hint) is
+ * checked first since successive calls are usually for nearby times.
+ */
+int Lgm_LeapSecondIndex( double JD, Lgm_LeapSeconds *l ) {
+
+    int     n, h, lo, hi, mid;
+
+    n = l->nLeapSecondDates;
+    if ( (n <= 0) || (JD < l->LeapSecondJDs[0]) ) return( -1 );
+
+    h = l->Hint;
+    if ( (h >= 0) && (h < n) && (JD >= l->LeapSecondJDs[h]) && ( (h == n-1) || (JD < l->LeapSecondJDs[h+1]) ) ) return( h );
+
+    // Invariant: LeapSecondJDs[lo] <= JD, and the answer is in [lo, hi]
+    lo = 0; hi = n-1;
+    while ( lo < hi ) {
+        mid = (lo+hi+1)/2;
+        if ( JD >= l->LeapSecondJDs[mid] ) lo = mid;
+        else hi = mid-1;
+    }
+    l->Hint = lo;
+
+    return( lo );
+
+}
+
+
+
+
 /*
  * Returns a 1 if the given date is a LeapSecond date, 0 otherwise. I.e. -- a
  * date on which a leap second was added.
@@ -126,15 +158,17 @@ double Lgm_GetLeapSeconds( double JD, Lgm_CTrans *c ) {
 int Lgm_IsLeapSecondDay( long int Date, double *SecondsInDay, Lgm_CTrans *c ) {
 
     Lgm_LeapSeconds *l;
-    int             i;
+    int             i, lo, hi;
 
     l = &(c->l);
 
     /*
-     * Parse list in reverse order.
+     * Bisect the (ascending) list of dates.
      */
     *SecondsInDay = 86400.0;
-    for (i=l->nLeapSecondDates-1; i>=0; i--) {
+    lo = 0; hi = l->nLeapSecondDates-1;
+    while ( lo <= hi ) {
+        i = (lo+hi)/2;
         if ( Date == l->LeapSecondDates[i] ) {
             if (i > 0) {
                 if ( (l->LeapSeconds[i] - l->LeapSeconds[i-1]) > 0.0) {
@@ -144,6 +178,10 @@ int Lgm_IsLeapSecondDay( long int Date, double *SecondsInDay, Lgm_CTrans *c ) {
                 }
             }
             return(1); 
+        } else if ( Date < l->LeapSecondDates[i] ) {
+            hi = i-1;
+        } else {
+            lo = i+1;
         }
     }
     return(0);
@@ -155,18 +193,15 @@ int Lgm_IsLeapSecondDay( long int Date, double *SecondsInDay, Lgm_CTrans *c ) {
 
 /*
  * Reads in the file containing leap second info and packs the results into a
- * Lgm_LeapSeconds Structure contained in the Lgm_CTrans structure.
+ * Lgm_LeapSeconds Structure.
  */
-int Lgm_LoadLeapSeconds( Lgm_CTrans  *c ) {
+static int Lgm_ReadLeapSecondFile( Lgm_LeapSeconds *l ) {
 
-    Lgm_LeapSeconds *l;
-    int              i, n=0, N=50, Year, Month, Day;
+    int              i, k, n=0, N=50, Year, Month, Day, Parsed=FALSE;
     char             Line[513], LeapSecondFile[512];
     double           JD, Time;
     FILE             *fp;
 
-    l = &(c->l);
-
     sprintf( LeapSecondFile, "%s/%s", LGM_EOP_DATA_DIR, "/Lgm_LeapSecondDates.dat");
     //printf("File = %s\n", LeapSecondFile );
     
@@ -181,7 +216,7 @@ int Lgm_LoadLeapSeconds( Lgm_CTrans  *c ) {
         for (i=0;i<17; i++) fgets( Line, 512, fp );
 
         // read off data
-        while ( fscanf( fp, "%ld %lf %lf", &l->LeapSecondDates[n], &l->LeapSecondJDs[n], &l->LeapSeconds[n] ) != EOF) { 
+        while ( ( k = fscanf( fp, "%ld %lf %lf", &l->LeapSecondDates[n], &l->LeapSecondJDs[n], &l->LeapSeconds[n] ) ) == 3 ) { 
 
             //printf("l->LeapSecondDates[%d] = %ld, l->LeapSecondJDs[%d] = %lf, l->LeapSeconds[%d] = %g\n", 
             //        n, l->LeapSecondDates[n], n, l->LeapSecondJDs[n], n, l->LeapSeconds[n] );
@@ -209,9 +244,19 @@ int Lgm_LoadLeapSeconds( Lgm_CTrans  *c ) {
         }
         fclose(fp);
 
-    } else {
+        // fscanf() only gets to EOF if every record was read in full
+        if ( k == EOF ) {
+            Parsed = TRUE;
+        } else {
+            printf("Lgm_LoadLeapSeconds: Could not parse data record %d of %s\n", n+1, LeapSecondFile );
+            free( l->LeapSecondDates ); free( l->LeapSecondJDs ); free( l->LeapSeconds );
+        }
+
+    }
+
+    if ( !Parsed ) {
         /*
-         * Provides a fallback in case the Lgm_LeapSecondDates.dat was not present.
+         * Provides a fallback in case the Lgm_LeapSecondDates.dat was not present (or could not be read).
          */
         N = 28;
         l->nLeapSecondDates = N;
@@ -246,11 +291,12 @@ int Lgm_LoadLeapSeconds( Lgm_CTrans  *c ) {
         l->LeapSecondDates[25] = 20120701, l->LeapSecondJDs[25] = 2456109.5, l->LeapSeconds[25] = 35.0;
         l->LeapSecondDates[26] = 20150701, l->LeapSecondJDs[26] = 2457204.5, l->LeapSeconds[26] = 36.0;
         l->LeapSecondDates[27] = 20170101, l->LeapSecondJDs[27] = 2457754.5, l->LeapSeconds[27] = 37.0;
-        printf("Lgm_LoadLeapSeconds: Could not open Lgm_LeapSecondDates.dat file!\n");
+        printf("Lgm_LoadLeapSeconds: Could not read Lgm_LeapSecondDates.dat file!\n");
         printf("                     Setting the leap second values that I know about\n");
         printf("                     (latest leap second I know about was introduced on\n");
         printf("                     %8ld (total leap seconds is %g))\n", l->LeapSecondDates[N-1], l->LeapSeconds[N-1]);
         //return(LGM_ERROR);
+        n = N;
     }
 
     l->nLeapSecondDates = n;
@@ -264,6 +310,8 @@ int Lgm_LoadLeapSeconds( Lgm_CTrans  *c ) {
         Lgm_JD_to_Date( JD-1.0, &Year, &Month, &Day, &Time );
         l->LeapSecondDates[i] = Year*10000 + Month*100 + Day;
     }
+    l->Hint   = 0;
+    l->Shared = FALSE;
 
     return(TRUE);
 
@@ -272,6 +320,59 @@ int Lgm_LoadLeapSeconds( Lgm_CTrans  *c ) {
 
 
 
+/*
+ * Returns the process-wide leap second table. The file is only read until
+ * that succeeds; after that the table is read-only and is shared by all of
+ * the Lgm_CTrans structures (see Lgm_LoadLeapSeconds()). If it fails, an
+ * empty table is returned and the next call tries again.
+ */
+static Lgm_LeapSeconds  Lgm_SharedLeapSecondTable;
+static Lgm_LeapSeconds  Lgm_EmptyLeapSecondTable = { .Shared = TRUE };
+static volatile int     Lgm_SharedLeapSecondTableLoaded = FALSE;
+
+Lgm_LeapSeconds *Lgm_SharedLeapSeconds( void ) {
+
+    if ( !Lgm_SharedLeapSecondTableLoaded ) {
+        #if USE_OPENMP
+        #pragma omp critical (Lgm_SharedLeapSeconds)
+        #endif
+        {
+            if ( !Lgm_SharedLeapSecondTableLoaded && ( Lgm_ReadLeapSecondFile( &Lgm_SharedLeapSecondTable ) == TRUE ) ) {
+                Lgm_SharedLeapSecondTable.Shared = TRUE;
+                #if USE_OPENMP
+                #pragma omp flush
+                #endif
+                Lgm_SharedLeapSecondTableLoaded = TRUE;
+            }
+        }
+    }
+
+    return( Lgm_SharedLeapSecondTableLoaded ? &Lgm_SharedLeapSecondTable : &Lgm_EmptyLeapSecondTable );
+
+}
+
+
+
+
+/*
+ * Points the Lgm_LeapSeconds Structure contained in the Lgm_CTrans structure
+ * at the shared leap second table. Only the first successful call in a
+ * process does any file I/O. Returns LGM_ERROR if the table could not be
+ * loaded.
+ */
+int Lgm_LoadLeapSeconds( Lgm_CTrans  *c ) {
+
+    c->l        = *Lgm_SharedLeapSeconds();
+    c->l.Shared = TRUE;
+    c->l.Hint   = 0;
+
+    return( ( c->l.nLeapSecondDates > 0 ) ? TRUE : LGM_ERROR );
+
+}
+
+
+
+
 /*
  * GPS <-> TAI Conversions
  */
@@ -1638,3 +1739,270 @@ void Lgm_MJD_to_DateTime( double MJD, Lgm_DateTime *UTC, Lgm_CTrans *c ) {
     JD = MJD + 2400000.5;
     Lgm_JD_to_DateTime( JD, UTC, c );
 }
+
+
+
+
+/*
+ *  Array versions of the time system conversions
+ *  ---------------------------------------------
+ *
+ *  Lgm_ConvertTimeArray() converts n times from one time system (UTC, TAI,
+ *  GPS, TT or TDB) to another without going through Lgm_DateTime structures
+ *  (i.e. there is no calendar decomposition per sample). It is meant for long
+ *  high-cadence timestamp streams.
+ *
+ *  Times can be given either as Julian Dates (LGM_TIME_JD) or as seconds
+ *  (LGM_TIME_SECONDS) using the same conventions as the scalar routines;
+ *
+ *      TAI     -- TaiSeconds (SI seconds since 0h Jan 1, 1958 TAI)
+ *      GPS     -- GpsSeconds (SI seconds since 0h Jan 6, 1980 GPS)
+ *      TT      -- seconds since J2000 (12h Jan 1, 2000 TT)
+ *      TDB     -- seconds since J2000 (12h Jan 1, 2000 TDB)
+ *
+ *  UTC can only be given as a Julian Date (UTC seconds are ambiguous across
+ *  leap seconds). As in Lgm_JD(), a UTC day that ends with a leap second is
+ *  86401 s long and its Julian Dates are spread over the whole day.
+ *
+ *  Internally each time is held as the JD of the preceding 0h plus seconds
+ *  into the day, so that seconds inputs keep their full precision. The leap
+ *  second interval found for one sample is reused for the following ones
+ *  until a sample falls outside of it, and the periodic TT <-> TDB terms are
+ *  applied in separate loops over blocks of samples.
+ *
+ *  In and Out can be the same array. Returns 0 on success, -1 if the
+ *  time systems or units are not supported.
+ */
+#define LGM_TIME_ARRAY_BLOCK    256
+
+/*
+ *  JD that seconds are counted from in the given time system.
+ */
+static double Lgm_TimeArrayEpoch( int TimeSystem ) {
+
+    switch ( TimeSystem ) {
+        case LGM_TIME_SYS_TAI:  return( LGM_JD_TAI0 - 0.5 );
+        case LGM_TIME_SYS_GPS:  return( LGM_JD_GPS0 - 0.5 );
+        case LGM_TIME_SYS_TT:
+        case LGM_TIME_SYS_TDB:  return( LGM_JD_J2000 );
+        default:                return( 0.0 );
+    }
+
+}
+
+/*
+ *  Bring Sec back into [0, 86400) (only for systems with uniform days).
+ */
+static void Lgm_TimeArrayNormalize( double *Day, double *Sec ) {
+
+    double  k;
+
+    if ( (*Sec < 0.0) || (*Sec >= 86400.0) ) {
+        k = floor( *Sec/86400.0 );
+        *Day += k;
+        *Sec -= k*86400.0;
+    }
+
+}
+
+/*
+ *  TDB-TT (in seconds) at the given TT (or, to within a few ns, TDB) time.
+ *  This is the IAU 1976 expression used by Lgm_TT_to_TDB(). sin(2M) is formed
+ *  from sin(M) and cos(M).
+ */
+static void Lgm_TimeArrayTdbMinusTT( int n, double *Day, double *Sec, double *dt ) {
+
+    int     i;
+    double  T, M, sM, cM;
+
+    for ( i=0; i<n; i++ ) {
+        T  = ( (Day[i] - 2451545.0) + Sec[i]/86400.0 )/36525.0;
+        M  = (357.53 + 35999.050*T)*RadPerDeg;
+        sM = sin( M ); cM = cos( M );
+        dt[i] = 0.001658*sM + 0.000028*sM*cM;
+    }
+
+}
+
+int Lgm_ConvertTimeArray( long int n, double *In, int InSys, int InUnits, double *Out, int OutSys, int OutUnits, Lgm_CTrans *c ) {
+
+    long int        i0;
+    int             i, nb, k, nls, Seg;
+    double          Day[LGM_TIME_ARRAY_BLOCK], Sec[LGM_TIME_ARRAY_BLOCK], Sec0[LGM_TIME_ARRAY_BLOCK], dt[LGM_TIME_ARRAY_BLOCK];
+    double          Epoch, Epoch0, ns, u, t, SegLo, SegHi, SegDAT, SegEnd, LeapDay, M;
+    Lgm_LeapSeconds *l = &(c->l);
+
+    if ( (InSys < LGM_TIME_SYS_UTC) || (InSys > LGM_TIME_SYS_TDB) || (OutSys < LGM_TIME_SYS_UTC) || (OutSys > LGM_TIME_SYS_TDB) ) {
+        printf("Lgm_ConvertTimeArray: Unsupported time system (InSys = %d, OutSys = %d)\n", InSys, OutSys );
+        return( -1 );
+    }
+    if ( ( (InSys == LGM_TIME_SYS_UTC) && (InUnits != LGM_TIME_JD) ) || ( (OutSys == LGM_TIME_SYS_UTC) && (OutUnits != LGM_TIME_JD) ) ) {
+        printf("Lgm_ConvertTimeArray: UTC times must be given as Julian Dates\n" );
+        return( -1 );
+    }
+
+    nls = l->nLeapSecondDates;
+
+    // Current leap second interval [SegLo, SegHi) (UTC JDs) and TAI-UTC in it.
+    Seg = -2; SegLo = SegHi = SegDAT = 0.0;
+
+    for ( i0=0; i0<n; i0 += LGM_TIME_ARRAY_BLOCK ) {
+
+        nb = ( n-i0 < LGM_TIME_ARRAY_BLOCK ) ? (int)(n-i0) : LGM_TIME_ARRAY_BLOCK;
+
+
+        /*
+         *  Unpack into (0h JD, seconds into day).
+         */
+        if ( InUnits == LGM_TIME_SECONDS ) {
+            Epoch  = Lgm_TimeArrayEpoch( InSys );
+            Epoch0 = floor( Epoch - 0.5 ) + 0.5;
+            for ( i=0; i<nb; i++ ) {
+                Day[i] = Epoch0;
+                Sec[i] = In[i0+i] + (Epoch - Epoch0)*86400.0;
+                Lgm_TimeArrayNormalize( &Day[i], &Sec[i] );
+            }
+        } else {
+            for ( i=0; i<nb; i++ ) {
+                Day[i] = floor( In[i0+i] - 0.5 ) + 0.5;
+                Sec[i] = (In[i0+i] - Day[i])*86400.0;
+            }
+        }
+
+
+        /*
+         *  Go to TAI.
+         */
+        switch ( InSys ) {
+
+            case LGM_TIME_SYS_UTC:
+                for ( i=0; i<nb; i++ ) {
+                    if ( (Seg == -2) || (Day[i] < SegLo) || (Day[i] >= SegHi) ) {
+                        Seg = Lgm_LeapSecondIndex( Day[i], l );
+                        SegLo = ( Seg < 0 ) ? -1e31 : l->LeapSecondJDs[Seg];
+                        SegHi = ( Seg+1 < nls ) ? l->LeapSecondJDs[Seg+1] : 1e31;
+                        SegDAT = ( Seg < 0 ) ? 0.0 : l->LeapSeconds[Seg];
+                    }
+                    if ( Seg < 0 ) {
+                        // Pre-1972 (TAI-UTC drifts continuously)
+                        Sec[i] += Lgm_GetLeapSeconds( Day[i] + Sec[i]/86400.0, c );
+                    } else {
+                        if ( Day[i] + 1.0 == SegHi ) {
+                            // This day ends with a leap second. Undo the stretch in the JD.
+                            ns = 86400.0 + l->LeapSeconds[Seg+1] - SegDAT;
+                            Sec[i] *= ns/86400.0;
+                        }
+                        Sec[i] += SegDAT;
+                    }
+                    Lgm_TimeArrayNormalize( &Day[i], &Sec[i] );
+                }
+                break;
+
+            case LGM_TIME_SYS_GPS:
+                for ( i=0; i<nb; i++ ) { Sec[i] += 19.0; Lgm_TimeArrayNormalize( &Day[i], &Sec[i] ); }
+                break;
+
+            case LGM_TIME_SYS_TDB:
+                // TT = TDB - (TDB-TT)(TT). The correction changes by less than a
+                // ns over a few ms, so two fixed point iterations are plenty.
+                for ( i=0; i<nb; i++ ) Sec0[i] = Sec[i];
+                for ( k=0; k<2; k++ ) {
+                    Lgm_TimeArrayTdbMinusTT( nb, Day, Sec, dt );
+                    for ( i=0; i<nb; i++ ) Sec[i] = Sec0[i] - dt[i];
+                }
+                for ( i=0; i<nb; i++ ) { Sec[i] -= 32.184; Lgm_TimeArrayNormalize( &Day[i], &Sec[i] ); }
+                break;
+
+            case LGM_TIME_SYS_TT:
+                for ( i=0; i<nb; i++ ) { Sec[i] -= 32.184; Lgm_TimeArrayNormalize( &Day[i], &Sec[i] ); }
+                break;
+
+        }
+
+
+        /*
+         *  Go from TAI to the output system.
+         */
+        switch ( OutSys ) {
+
+            case LGM_TIME_SYS_UTC:
+                for ( i=0; i<nb; i++ ) {
+
+                    // Is the TAI time still inside of the current interval? (In
+                    // TAI, interval Seg starts at LeapSecondJDs[Seg] + LeapSeconds[Seg] s.)
+                    if ( (Seg < -1) || ( (Seg >= 0) && ( (Day[i]-SegLo)*86400.0 + Sec[i] < SegDAT ) )
+                                    || ( (Seg+1 < nls) && ( (Day[i]-SegHi)*86400.0 + Sec[i] >= l->LeapSeconds[Seg+1] ) ) ) {
+                        Seg = Lgm_LeapSecondIndex( Day[i] + Sec[i]/86400.0, l );
+                        if ( Seg >= 0 ) {
+                            // may be one interval too far if we are within DAT seconds of its start
+                            if ( (Day[i]-l->LeapSecondJDs[Seg])*86400.0 + Sec[i] < l->LeapSeconds[Seg] ) --Seg;
+                        }
+                        SegLo = ( Seg < 0 ) ? -1e31 : l->LeapSecondJDs[Seg];
+                        SegHi = ( Seg+1 < nls ) ? l->LeapSecondJDs[Seg+1] : 1e31;
+                        SegDAT = ( Seg < 0 ) ? 0.0 : l->LeapSeconds[Seg];
+                    }
+
+                    if ( Seg < 0 ) {
+                        // Pre-1972. Solve u = t - (TAI-UTC)(u) by fixed point iteration.
+                        t = Day[i] + Sec[i]/86400.0;
+                        u = t - Lgm_GetLeapSeconds( t, c )/86400.0;
+                        u = t - Lgm_GetLeapSeconds( u, c )/86400.0;
+                        Sec[i] -= (t-u)*86400.0;
+                        Lgm_TimeArrayNormalize( &Day[i], &Sec[i] );
+                        Out[i0+i] = Day[i] + Sec[i]/86400.0;
+                        continue;
+                    }
+
+                    // UTC seconds since SegLo
+                    u = (Day[i]-SegLo)*86400.0 + Sec[i] - SegDAT;
+                    if ( Seg+1 < nls ) {
+                        LeapDay = SegHi - 1.0;
+                        SegEnd  = (LeapDay - SegLo)*86400.0;
+                        if ( u >= SegEnd ) {
+                            // In the (stretched) last day of the interval.
+                            ns = 86400.0 + l->LeapSeconds[Seg+1] - SegDAT;
+                            Day[i] = LeapDay;
+                            Out[i0+i] = LeapDay + (u - SegEnd)/ns;
+                            continue;
+                        }
+                    }
+                    M = floor( u/86400.0 );
+                    Day[i] = SegLo + M;
+                    Sec[i] = u - M*86400.0;
+                    Out[i0+i] = Day[i] + Sec[i]/86400.0;
+
+                }
+                break;
+
+            case LGM_TIME_SYS_TAI:
+            case LGM_TIME_SYS_GPS:
+            case LGM_TIME_SYS_TT:
+            case LGM_TIME_SYS_TDB:
+                if ( OutSys == LGM_TIME_SYS_GPS ) {
+                    for ( i=0; i<nb; i++ ) Sec[i] -= 19.0;
+                } else if ( OutSys != LGM_TIME_SYS_TAI ) {
+                    for ( i=0; i<nb; i++ ) Sec[i] += 32.184;
+                }
+                if ( OutSys == LGM_TIME_SYS_TDB ) {
+                    Lgm_TimeArrayTdbMinusTT( nb, Day, Sec, dt );
+                    for ( i=0; i<nb; i++ ) Sec[i] += dt[i];
+                }
+
+                if ( OutUnits == LGM_TIME_SECONDS ) {
+                    Epoch = Lgm_TimeArrayEpoch( OutSys );
+                    for ( i=0; i<nb; i++ ) Out[i0+i] = (Day[i] - Epoch)*86400.0 + Sec[i];
+                } else {
+                    for ( i=0; i<nb; i++ ) {
+                        Lgm_TimeArrayNormalize( &Day[i], &Sec[i] );
+                        Out[i0+i] = Day[i] + Sec[i]/86400.0;
+                    }
+                }
+                break;
+
+        }
+
+    }
+
+    return( 0 );
+
+}
@@ -0,0 +1,564 @@
+/*! \file Lgm_DxxTable.c
+ *
+ *  \brief Tables of bounce-averaged diffusion coefficients with fast (monotone) lookup.
+ *
+ *  Lgm_SummersDxxBounceAvg() and friends do a full adaptive quadrature (with
+ *  resonant root finding at each latitude) for every (Alpha0, Ek, L). That is
+ *  fine for making a few plots, but diffusion solvers need the coefficients
+ *  on dense grids at every step and need to rebuild them whenever the wave
+ *  model changes.
+ *
+ *  The routines here build a table of Daa, Dap and Dpp on a uniform
+ *  (L, log10(Ek), Alpha0) grid in parallel, optionally cache it in an HDF5
+ *  file, and look values up with monotone cubic interpolation.
+ *
+ *  Example;
+ *
+ *      Lgm_DxxTable_SummersParams  p;
+ *      Lgm_DxxTable                *t;
+ *      char                        Key[LGM_DXX_TABLE_KEY_LENGTH];
+ *
+ *      p.Version = LGM_SUMMERS_2007; p.WaveMode = LGM_R_MODE_WAVE; ...
+ *      Lgm_DxxTable_SummersKey( &p, "Bw = 100pT, |Lat| < 35", Key );
+ *      t = Lgm_DxxTable_Build( 21, 3.0, 7.0, 61, -2.0, 1.0, 89, 1.0, 89.0,
+ *                              Lgm_DxxTable_SummersFunc, (void *)&p, Key, "Chorus.h5", 1 );
+ *
+ *      Lgm_DxxTable_Eval( t, L, Ek, Alpha0, &Daa, &Dap, &Dpp );
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "Lgm/Lgm_DxxTable.h"
+#include "Lgm/Lgm_DynamicMemory.h"
+
+#if USE_OPENMP
+#include <omp.h>
+#endif
+
+#define FMAX(a,b)  (((a)>(b))?(a):(b))
+#define FMIN(a,b)  (((a)<(b))?(a):(b))
+
+
+static double WallTime( void ) {
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return( (double)tv.tv_sec + 1e-6*(double)tv.tv_usec );
+}
+
+
+/**
+ *  Allocate a table with uniform grids in L, log10(Ek) and Alpha0. The
+ *  coefficients are all set to zero.
+ *
+ *      \param[in]      nL, L0, L1              Number of L values and the range of L.
+ *      \param[in]      nE, logEk0, logEk1      Number of energies and the range of log10(Ek/MeV).
+ *      \param[in]      nA, Alpha00, Alpha01    Number of equatorial pitch angles and their range (degrees).
+ *
+ *      \return  The table or NULL if the grid is invalid.
+ */
+Lgm_DxxTable *Lgm_DxxTable_Alloc( int nL, double L0, double L1, int nE, double logEk0, double logEk1, int nA, double Alpha00, double Alpha01 ) {
+
+    Lgm_DxxTable    *t;
+
+    if ( (nL < 1) || (nE < 1) || (nA < 1) || ((nL > 1) && (L1 <= L0)) || ((nE > 1) && (logEk1 <= logEk0)) || ((nA > 1) && (Alpha01 <= Alpha00)) ) {
+        printf("Lgm_DxxTable_Alloc: Invalid grid (nL, nE, nA = %d %d %d; L = [%g, %g], log10(Ek) = [%g, %g], Alpha0 = [%g, %g])\n",
+                nL, nE, nA, L0, L1, logEk0, logEk1, Alpha00, Alpha01 );
+        return( NULL );
+    }
+
+    t = (Lgm_DxxTable *)calloc( 1, sizeof(Lgm_DxxTable) );
+
+    t->nL = nL; t->L0      = L0;      t->L1      = L1;      t->dL      = (nL > 1) ? (L1-L0)/(double)(nL-1) : 0.0;
+    t->nE = nE; t->logEk0  = logEk0;  t->logEk1  = logEk1;  t->dlogEk  = (nE > 1) ? (logEk1-logEk0)/(double)(nE-1) : 0.0;
+    t->nA = nA; t->Alpha00 = Alpha00; t->Alpha01 = Alpha01; t->dAlpha0 = (nA > 1) ? (Alpha01-Alpha00)/(double)(nA-1) : 0.0;
+
+    LGM_ARRAY_3D( t->Daa, nL, nE, nA, double );
+    LGM_ARRAY_3D( t->Dap, nL, nE, nA, double );
+    LGM_ARRAY_3D( t->Dpp, nL, nE, nA, double );
+
+    return( t );
+
+}
+
+void Lgm_DxxTable_Free( Lgm_DxxTable *t ) {
+
+    if ( t == NULL ) return;
+    LGM_ARRAY_3D_FREE( t->Daa );
+    LGM_ARRAY_3D_FREE( t->Dap );
+    LGM_ARRAY_3D_FREE( t->Dpp );
+    free( t );
+
+}
+
+
+/**
+ *  Compute the coefficients at every grid point of the table.
+ *
+ *  The cost of a grid point can vary by orders of magnitude (points outside
+ *  the resonance region are nearly free, points near a singularity of the
+ *  integrand are very expensive). So rather than splitting the grid into
+ *  contiguous blocks (or parallelizing only over one axis), all
+ *  nL*nE*nA points are handed out to the threads one at a time; whichever
+ *  thread is free takes the next one.
+ *
+ *      \param[in,out]  t           Table (from Lgm_DxxTable_Alloc()).
+ *      \param[in]      DxxFunc     Function that computes the coefficients at a single point. Must be thread-safe.
+ *      \param[in]      Data        Data passed through to DxxFunc.
+ *      \param[in]      Verbosity   If > 0, print progress.
+ *
+ *      \return  Number of points where DxxFunc failed.
+ */
+int Lgm_DxxTable_Fill( Lgm_DxxTable *t, Lgm_DxxFunc DxxFunc, void *Data, int Verbosity ) {
+
+    long int    n, nTot, nDone = 0;
+    int         iL, iE, iA, nFail = 0;
+    double      L, Ek, Alpha0, Daa, Dap, Dpp, t0;
+
+    t0   = WallTime();
+    nTot = (long int)t->nL*t->nE*t->nA;
+
+    #if USE_OPENMP
+    #pragma omp parallel for schedule(dynamic,1) private(iL,iE,iA,L,Ek,Alpha0,Daa,Dap,Dpp) reduction(+:nFail)
+    #endif
+    for ( n=0; n<nTot; n++ ) {
+
+        iA = n % t->nA;
+        iE = (n / t->nA) % t->nE;
+        iL = n / ((long int)t->nA*t->nE);
+
+        L      = t->L0 + iL*t->dL;
+        Ek     = pow( 10.0, t->logEk0 + iE*t->dlogEk );
+        Alpha0 = t->Alpha00 + iA*t->dAlpha0;
+
+        if ( DxxFunc( L, Ek, Alpha0, &Daa, &Dap, &Dpp, Data ) < 0 ) {
+            Daa = Dap = Dpp = 0.0;
+            ++nFail;
+        }
+        t->Daa[iL][iE][iA] = Daa;
+        t->Dap[iL][iE][iA] = Dap;
+        t->Dpp[iL][iE][iA] = Dpp;
+
+        if ( Verbosity > 0 ) {
+            #if USE_OPENMP
+            #pragma omp critical (DxxTableProgress)
+            #endif
+            {
+                ++nDone;
+                if ( (nDone % FMAX( 1, nTot/10 )) == 0 ) printf("Lgm_DxxTable_Fill: %ld/%ld points done (%.1f s)\n", nDone, nTot, WallTime()-t0 );
+            }
+        }
+
+    }
+
+    t->nFail     = nFail;
+    t->BuildTime = WallTime() - t0;
+    t->FromCache = FALSE;
+
+    if ( Verbosity > 0 ) printf("Lgm_DxxTable_Fill: %ld points in %g s (%d failed)\n", nTot, t->BuildTime, nFail );
+
+    return( nFail );
+
+}
+
+
+/**
+ *  Get a table, either from a cache file or by computing it (and then
+ *  writing it to the cache file).
+ *
+ *      \param[in]      nL, L0, L1, nE, logEk0, logEk1, nA, Alpha00, Alpha01    Grid (see Lgm_DxxTable_Alloc()).
+ *      \param[in]      DxxFunc     Function that computes the coefficients at a single point. Must be thread-safe.
+ *      \param[in]      Data        Data passed through to DxxFunc.
+ *      \param[in]      Key         String that uniquely describes the wave model (and anything else DxxFunc depends on).
+ *      \param[in]      CacheFile   HDF5 cache file to use (or NULL for no caching).
+ *      \param[in]      Verbosity   If > 0, print progress.
+ *
+ *      \return  The table (NULL on failure).
+ */
+Lgm_DxxTable *Lgm_DxxTable_Build( int nL, double L0, double L1, int nE, double logEk0, double logEk1, int nA, double Alpha00, double Alpha01,
+                                  Lgm_DxxFunc DxxFunc, void *Data, char *Key, char *CacheFile, int Verbosity ) {
+
+    Lgm_DxxTable    *t, *c;
+
+    if ( (t = Lgm_DxxTable_Alloc( nL, L0, L1, nE, logEk0, logEk1, nA, Alpha00, Alpha01 )) == NULL ) return( NULL );
+    strncpy( t->Key, (Key != NULL) ? Key : "", LGM_DXX_TABLE_KEY_LENGTH-1 );
+
+    /*
+     *  Use the cached table if it was made for the same grid and wave model.
+     */
+    if ( (CacheFile != NULL) && (access( CacheFile, R_OK ) == 0) && ((c = Lgm_DxxTable_Read( CacheFile )) != NULL) ) {
+        if (    (c->nL == t->nL) && (c->L0 == t->L0) && (c->L1 == t->L1)
+             && (c->nE == t->nE) && (c->logEk0 == t->logEk0) && (c->logEk1 == t->logEk1)
+             && (c->nA == t->nA) && (c->Alpha00 == t->Alpha00) && (c->Alpha01 == t->Alpha01)
+             && !strcmp( c->Key, t->Key ) ) {
+            if ( Verbosity > 0 ) printf("Lgm_DxxTable_Build: Using cached table from %s\n", CacheFile );
+            Lgm_DxxTable_Free( t );
+            return( c );
+        }
+        if ( Verbosity > 0 ) printf("Lgm_DxxTable_Build: Cached table in %s does not match the requested grid/Key. Recomputing it.\n", CacheFile );
+        Lgm_DxxTable_Free( c );
+    }
+
+    Lgm_DxxTable_Fill( t, DxxFunc, Data, Verbosity );
+
+    if ( CacheFile != NULL ) {
+        if ( Lgm_DxxTable_Write( CacheFile, t ) < 0 ) {
+            printf("Lgm_DxxTable_Build: Could not write cache file %s\n", CacheFile );
+        }
+    }
+
+    return( t );
+
+}
+
+
+
+
+/*
+ *  Monotone (Steffen, 1990) cubic interpolation between y[1] and y[2] on a
+ *  uniform grid; y[0] and y[3] are the neighbouring points and u in [0,1] is
+ *  the fractional position between y[1] and y[2].
+ */
+static inline double SteffenSlope( double sm, double sp ) {
+    double  p, a;
+    if ( sm*sp <= 0.0 ) return( 0.0 );
+    p = 0.5*(sm+sp);
+    a = FMIN( fabs(sm), fabs(sp) );
+    a = FMIN( a, 0.5*fabs(p) );
+    return( (sp > 0.0) ? 2.0*a : -2.0*a );
+}
+
+static inline double Steffen( double *y, double u ) {
+    double  s0, s1, s2, m1, m2, u2, u3;
+    s0 = y[1]-y[0]; s1 = y[2]-y[1]; s2 = y[3]-y[2];
+    m1 = SteffenSlope( s0, s1 );
+    m2 = SteffenSlope( s1, s2 );
+    u2 = u*u; u3 = u2*u;
+    return( (2.0*u3-3.0*u2+1.0)*y[1] + (u3-2.0*u2+u)*m1 + (-2.0*u3+3.0*u2)*y[2] + (u3-u2)*m2 );
+}
+
+/*
+ *  Find the cell and the four stencil indices for x on a uniform grid. Off
+ *  the ends of the grid, the missing neighbour is flagged (Ext = -1 or +1)
+ *  so that it can be linearly extrapolated (which gives the end interval
+ *  the slope of the data there, rather than a zero slope).
+ */
+static inline int Stencil( double x, double x0, double dx, int n, int *Idx, int *Ext, double *u ) {
+
+    double  f;
+    int     i, Inside = TRUE;
+
+    if ( n < 2 ) {
+        Idx[0] = Idx[1] = Idx[2] = Idx[3] = 0;
+        *Ext = 0; *u = 0.0;
+        return( TRUE );
+    }
+
+    f = (x - x0)/dx;
+    if ( f < 0.0 )                { f = 0.0;              Inside = FALSE; }
+    if ( f > (double)(n-1) )      { f = (double)(n-1);    Inside = FALSE; }
+    i = (int)f;
+    if ( i > n-2 ) i = n-2;
+    *u = f - (double)i;
+
+    Idx[0] = i-1; Idx[1] = i; Idx[2] = i+1; Idx[3] = i+2;
+    *Ext = 0;
+    if ( Idx[0] < 0 )   { Idx[0] = 0;   *Ext -= 1; }
+    if ( Idx[3] > n-1 ) { Idx[3] = n-1; *Ext += 2; }
+
+    return( Inside );
+
+}
+
+static inline void FixEnds( double *y, int Ext ) {
+    if ( Ext == -1 || Ext == 1 ) y[0] = 2.0*y[1] - y[2];
+    if ( Ext ==  2 || Ext == 1 ) y[3] = 2.0*y[2] - y[1];
+}
+
+
+/**
+ *  Look up Daa, Dap and Dpp in a table.
+ *
+ *  The interpolation is done in L, log10(Ek) and Alpha0 with a tensor
+ *  product of monotone cubics (each 1D interpolant uses the 4 surrounding
+ *  grid values). Points outside the table are clamped to its edges.
+ *
+ *      \param[in]      t           Table.
+ *      \param[in]      L           L-shell.
+ *      \param[in]      Ek          Kinetic energy (MeV).
+ *      \param[in]      Alpha0      Equatorial pitch angle (degrees).
+ *      \param[out]     Daa, Dap, Dpp  Interpolated coefficients.
+ *
+ *      \return  TRUE if the point was inside the table, FALSE if it had to be clamped.
+ */
+int Lgm_DxxTable_Eval( Lgm_DxxTable *t, double L, double Ek, double Alpha0, double *Daa, double *Dap, double *Dpp ) {
+
+    int     IdxL[4], IdxE[4], IdxA[4], ExtL, ExtE, ExtA, InL, InE, InA;
+    int     i, j, k;
+    double  uL, uE, uA, ya[3][4], ye[3][4], yl[3][4], *pa, *pp, *pd;
+
+    InL = Stencil( L,           t->L0,      t->dL,      t->nL, IdxL, &ExtL, &uL );
+    InE = Stencil( log10( Ek ), t->logEk0,  t->dlogEk,  t->nE, IdxE, &ExtE, &uE );
+    InA = Stencil( Alpha0,      t->Alpha00, t->dAlpha0, t->nA, IdxA, &ExtA, &uA );
+
+    for ( i=0; i<4; i++ ) {
+        for ( j=0; j<4; j++ ) {
+            pa = t->Daa[IdxL[i]][IdxE[j]];
+            pp = t->Dap[IdxL[i]][IdxE[j]];
+            pd = t->Dpp[IdxL[i]][IdxE[j]];
+            for ( k=0; k<4; k++ ) {
+                ya[0][k] = pa[IdxA[k]];
+                ya[1][k] = pp[IdxA[k]];
+                ya[2][k] = pd[IdxA[k]];
+            }
+            for ( k=0; k<3; k++ ) {
+                FixEnds( ya[k], ExtA );
+                ye[k][j] = Steffen( ya[k], uA );
+            }
+        }
+        for ( k=0; k<3; k++ ) {
+            FixEnds( ye[k], ExtE );
+            yl[k][i] = Steffen( ye[k], uE );
+        }
+    }
+    for ( k=0; k<3; k++ ) FixEnds( yl[k], ExtL );
+
+    *Daa = Steffen( yl[0], uL );
+    *Dap = Steffen( yl[1], uL );
+    *Dpp = Steffen( yl[2], uL );
+
+    return( InL && InE && InA );
+
+}
+
+
+
+
+static int ReadDoubleAttr( hid_t Loc, char *Name, double *Val ) {
+
+    hid_t   Attr;
+    herr_t  Status;
+
+    if ( H5Aexists( Loc, Name ) <= 0 ) return( -1 );
+    if ( (Attr = H5Aopen( Loc, Name, H5P_DEFAULT )) < 0 ) return( -1 );
+    Status = H5Aread( Attr, H5T_NATIVE_DOUBLE, Val );
+    H5Aclose( Attr );
+
+    return( (Status < 0) ? -1 : 0 );
+
+}
+
+static int ReadStringAttr( hid_t Loc, char *Name, char *Str, int MaxLen ) {
+
+    hid_t   Attr, Type, MemType;
+    herr_t  Status;
+    size_t  n;
+    char    *Buf;
+
+    Str[0] = '\0';
+    if ( H5Aexists( Loc, Name ) <= 0 ) return( -1 );
+    if ( (Attr = H5Aopen( Loc, Name, H5P_DEFAULT )) < 0 ) return( -1 );
+    Type    = H5Aget_type( Attr );
+    n       = H5Tget_size( Type );
+    MemType = H5Tcopy( H5T_C_S1 );
+    H5Tset_size( MemType, n );
+    H5Tset_strpad( MemType, H5T_STR_NULLPAD );
+    Buf     = (char *)calloc( n+1, sizeof(char) );
+    Status  = H5Aread( Attr, MemType, Buf );
+    if ( Status >= 0 ) { strncpy( Str, Buf, MaxLen-1 ); Str[MaxLen-1] = '\0'; }
+    free( Buf );
+    H5Tclose( MemType );
+    H5Tclose( Type );
+    H5Aclose( Attr );
+
+    return( (Status < 0) ? -1 : 0 );
+
+}
+
+/*
+ *  Write one of the nL x nE x nA arrays. Returns 0 on success, -1 on failure.
+ */
+static int Write3D( hid_t File, char *Name, Lgm_DxxTable *t, double ***A ) {
+
+    hsize_t Dims[3];
+    hid_t   Space, DataSet;
+    herr_t  Status;
+
+    Dims[0] = t->nL; Dims[1] = t->nE; Dims[2] = t->nA;
+    if ( (Space = H5Screate_simple( 3, Dims, NULL )) < 0 ) return( -1 );
+    if ( (DataSet = H5Dcreate( File, Name, H5T_NATIVE_DOUBLE, Space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT )) < 0 ) {
+        H5Sclose( Space );
+        return( -1 );
+    }
+    Status = H5Dwrite( DataSet, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, &A[0][0][0] );
+    if ( Status >= 0 ) Lgm_WriteStringAttr( DataSet, "Units", "s^-1" );
+    H5Dclose( DataSet );
+    H5Sclose( Space );
+
+    return( (Status < 0) ? -1 : 0 );
+
+}
+
+/*
+ *  Read one of the arrays into A (already allocated for the grid of t).
+ *  Returns 0 on success, -1 if the dataset is missing, has the wrong shape
+ *  or can not be read.
+ */
+static int Read3D( hid_t File, char *Name, Lgm_DxxTable *t, double ***A ) {
+
+    hsize_t Dims[3];
+    hid_t   Space, DataSet;
+    herr_t  Status = -1;
+
+    if ( H5Lexists( File, Name, H5P_DEFAULT ) <= 0 ) return( -1 );
+    if ( (DataSet = H5Dopen( File, Name, H5P_DEFAULT )) < 0 ) return( -1 );
+    if ( (Space = H5Dget_space( DataSet )) < 0 ) {
+        H5Dclose( DataSet );
+        return( -1 );
+    }
+
+    if (    ( H5Sget_simple_extent_ndims( Space ) == 3 ) && ( H5Sget_simple_extent_dims( Space, Dims, NULL ) == 3 )
+         && ( Dims[0] == (hsize_t)t->nL ) && ( Dims[1] == (hsize_t)t->nE ) && ( Dims[2] == (hsize_t)t->nA ) ) {
+        Status = H5Dread( DataSet, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, &A[0][0][0] );
+    }
+
+    H5Sclose( Space );
+    H5Dclose( DataSet );
+
+    return( (Status < 0) ? -1 : 0 );
+
+}
+
+
+/**
+ *  Write a table to an HDF5 file (overwriting the file). If anything goes
+ *  wrong the (partial) file is removed, so it can't be mistaken for a cache
+ *  file later.
+ *
+ *      \return  0 on success, -1 on failure.
+ */
+int Lgm_DxxTable_Write( char *Filename, Lgm_DxxTable *t ) {
+
+    hid_t   File;
+    int     Status = 0;
+
+    if ( (File = H5Fcreate( Filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT )) < 0 ) {
+        printf("Lgm_DxxTable_Write: Could not create %s\n", Filename );
+        return( -1 );
+    }
+
+    Lgm_WriteDoubleAttr( File, "nL",      (double)t->nL );
+    Lgm_WriteDoubleAttr( File, "L0",      t->L0 );
+    Lgm_WriteDoubleAttr( File, "L1",      t->L1 );
+    Lgm_WriteDoubleAttr( File, "nE",      (double)t->nE );
+    Lgm_WriteDoubleAttr( File, "logEk0",  t->logEk0 );
+    Lgm_WriteDoubleAttr( File, "logEk1",  t->logEk1 );
+    Lgm_WriteDoubleAttr( File, "nA",      (double)t->nA );
+    Lgm_WriteDoubleAttr( File, "Alpha00", t->Alpha00 );
+    Lgm_WriteDoubleAttr( File, "Alpha01", t->Alpha01 );
+    Lgm_WriteDoubleAttr( File, "nFail",   (double)t->nFail );
+    Lgm_WriteStringAttr( File, "Key",     (t->Key[0] != '\0') ? t->Key : " " );
+
+    if (    ( Write3D( File, "Daa", t, t->Daa ) < 0 )
+         || ( Write3D( File, "Dap", t, t->Dap ) < 0 )
+         || ( Write3D( File, "Dpp", t, t->Dpp ) < 0 ) ) Status = -1;
+
+    if ( H5Fclose( File ) < 0 ) Status = -1;
+
+    if ( Status < 0 ) {
+        printf("Lgm_DxxTable_Write: Could not write the table to %s\n", Filename );
+        remove( Filename );
+    }
+
+    return( Status );
+
+}
+
+
+/**
+ *  Read a table written by Lgm_DxxTable_Write().
+ *
+ *      \return  The table, or NULL if the file could not be read (or isnt a table).
+ */
+Lgm_DxxTable *Lgm_DxxTable_Read( char *Filename ) {
+
+    hid_t           File;
+    double          nL, L0, L1, nE, logEk0, logEk1, nA, Alpha00, Alpha01, nFail;
+    Lgm_DxxTable    *t = NULL;
+
+    if ( (File = H5Fopen( Filename, H5F_ACC_RDONLY, H5P_DEFAULT )) < 0 ) {
+        printf("Lgm_DxxTable_Read: Could not open %s\n", Filename );
+        return( NULL );
+    }
+
+    if (    ReadDoubleAttr( File, "nL", &nL ) || ReadDoubleAttr( File, "L0", &L0 ) || ReadDoubleAttr( File, "L1", &L1 )
+         || ReadDoubleAttr( File, "nE", &nE ) || ReadDoubleAttr( File, "logEk0", &logEk0 ) || ReadDoubleAttr( File, "logEk1", &logEk1 )
+         || ReadDoubleAttr( File, "nA", &nA ) || ReadDoubleAttr( File, "Alpha00", &Alpha00 ) || ReadDoubleAttr( File, "Alpha01", &Alpha01 )
+         || ((t = Lgm_DxxTable_Alloc( (int)nL, L0, L1, (int)nE, logEk0, logEk1, (int)nA, Alpha00, Alpha01 )) == NULL) ) {
+        printf("Lgm_DxxTable_Read: %s does not contain a diffusion coefficient table\n", Filename );
+        H5Fclose( File );
+        return( NULL );
+    }
+
+    if ( ReadDoubleAttr( File, "nFail", &nFail ) == 0 ) t->nFail = (int)nFail;
+    ReadStringAttr( File, "Key", t->Key, LGM_DXX_TABLE_KEY_LENGTH );
+    if ( !strcmp( t->Key, " " ) ) t->Key[0] = '\0';
+    t->FromCache = TRUE;
+
+    if (    ( Read3D( File, "Daa", t, t->Daa ) < 0 )
+         || ( Read3D( File, "Dap", t, t->Dap ) < 0 )
+         || ( Read3D( File, "Dpp", t, t->Dpp ) < 0 ) ) {
+        printf("Lgm_DxxTable_Read: Could not read the coefficients from %s (missing, wrong shape for the grid, or unreadable)\n", Filename );
+        Lgm_DxxTable_Free( t );
+        t = NULL;
+    }
+
+    H5Fclose( File );
+
+    return( t );
+
+}
+
+
+
+/**
+ *  Lgm_DxxFunc for the Summers [2005, 2007] bounce-averaged coefficients
+ *  (via Lgm_SummersDxxBounceAvg()). Data must point to an
+ *  Lgm_DxxTable_SummersParams structure.
+ */
+int Lgm_DxxTable_SummersFunc( double L, double Ek, double Alpha0, double *Daa, double *Dap, double *Dpp, void *Data ) {
+
+    Lgm_DxxTable_SummersParams  *p = (Lgm_DxxTable_SummersParams *)Data;
+    double                      Beq, Omega_e, f, aStarEq;
+
+    Beq     = M_CDIP/(L*L*L);
+    Omega_e = Lgm_GyroFreq( LGM_e, Beq, LGM_ELECTRON_MASS );
+    f       = Omega_e/M_2PI;        // Hz
+    aStarEq = ( p->aStarEqFunc != NULL ) ? p->aStarEqFunc( L, p->BwFuncData ) : p->aStarEq;
+
+    return( Lgm_SummersDxxBounceAvg( p->Version, Alpha0, Ek, L, p->BwFuncData, p->BwFunc, p->n1, p->n2, p->n3, aStarEq, p->Directions,
+                                     p->w1*f, p->w2*f, p->wm*f, p->dw*f, p->WaveMode, p->Species, p->MaxWaveLat, Daa, Dap, Dpp ) );
+
+}
+
+/**
+ *  Make a Key string (for Lgm_DxxTable_Build()) from the parameters of a
+ *  Summers wave model. The wave amplitude function (and aStarEqFunc, if
+ *  used) cant be described automatically, so the caller supplies a
+ *  description of them in BwDescription.
+ */
+void Lgm_DxxTable_SummersKey( Lgm_DxxTable_SummersParams *p, char *BwDescription, char *Key ) {
+
+    char    aStarStr[80];
+
+    if ( p->aStarEqFunc != NULL ) strcpy( aStarStr, "func" );
+    else                          sprintf( aStarStr, "%.15g", p->aStarEq );
+
+    snprintf( Key, LGM_DXX_TABLE_KEY_LENGTH, "Summers Version=%d WaveMode=%d Species=%d Directions=%d n=(%.15g,%.15g,%.15g) aStarEq=%s w1=%.15g w2=%.15g wm=%.15g dw=%.15g MaxWaveLat=%.15g Bw=%s",
+                p->Version, p->WaveMode, p->Species, p->Directions, p->n1, p->n2, p->n3, aStarStr,
+                p->w1, p->w2, p->wm, p->dw, p->MaxWaveLat, (BwDescription != NULL) ? BwDescription : "" );
+
+}
@@ -2,6 +2,9 @@
  *
  *  \brief Determine if a position is in unmral or penumbral elicpse.
  *
+ *  (See Lgm_EclipseEvents.c for finding the shadow entry and exit times
+ *  along a trajectory.)
+ *
  *  \details
  *      See discussion at Celestrak: http://www.celestrak.com/columns/v03n01/
  *
@@ -18,84 +21,82 @@
 #include <math.h>
 #include "Lgm/Lgm_CTrans.h"
 #include "Lgm/Lgm_Vec.h"
+#include "Lgm/Lgm_Eclipse.h"
 
 
-/*
- *   Compute Earth Eclipse type for S/C position given in MOD coords (input Re).
+/**
+ *  Shadow functions of a body for a S/C. Theta is the angle between the Sun
+ *  and the body as seen from the S/C and ThetaS, ThetaB are their angular
+ *  radii. The S/C is in the penumbra (or umbra) if gPenumbra < 0 and in the
+ *  umbra if gUmbra < 0 (if the body looks smaller than the Sun, gUmbra is
+ *  never negative). Both are continuous, so their zeros can be found with
+ *  a root finder (see Lgm_Eclipse_FindEvents()).
+ *
+ *      \param[in]      ScToSun     Vector from the S/C to the Sun (km).
+ *      \param[in]      ScToBody    Vector from the S/C to the center of the body (km).
+ *      \param[in]      BodyRadius  Radius of the body (km).
+ *      \param[out]     gPenumbra   Theta - ( ThetaB + ThetaS ) (radians).
+ *      \param[out]     gUmbra      Theta - ( ThetaB - ThetaS ) (radians).
  */
-int Lgm_EarthEclipse( Lgm_Vector *u, Lgm_CTrans *c ) {
+void Lgm_ShadowFunctions( Lgm_Vector *ScToSun, Lgm_Vector *ScToBody, double BodyRadius, double *gPenumbra, double *gUmbra ) {
 
-    Lgm_Vector  Rsun, Psun, Psc;
-    double      Rsun_mag, Psun_mag, Psc_mag;
-    double      Theta, ThetaE, ThetaS;
-    int         Type;
+    Lgm_Vector  w;
+    double      Dsun, Dbody, Theta, ThetaB, ThetaS, sb;
 
-    Psc.x = Re*u->x; //km
-    Psc.y = Re*u->y; //km
-    Psc.z = Re*u->z; //km
-    Psc_mag = Lgm_Magnitude( &Psc ); // km
+    Dsun  = Lgm_Magnitude( ScToSun );
+    Dbody = Lgm_Magnitude( ScToBody );
 
     /*
-     * We need (all in MOD);
-     *          Rsun - Earth to Sun Vector.
-     *          Psun - Satellite to Sun Vector.
-     *          Psc  - Earth to Satellite Vector.
-     *
+     * Angle between the Sun and the body (atan2 rather than acos, to keep
+     * the accuracy at small angles).
      */
-    Rsun_mag = c->earth_sun_dist*Re;    // km
-    Rsun     = c->Sun;                  
-    Lgm_ScaleVector( &Rsun, Rsun_mag ); // km
-
-    Psun.x = Rsun.x - Psc.x;  //km
-    Psun.y = Rsun.y - Psc.y;  //km
-    Psun.z = Rsun.z - Psc.z;  //km
-    Psun_mag = Lgm_Magnitude( &Psun ); // km
-
-
-    
-
-    //printf("Rsun_mag, Psun_mag, Psc_mag = %g %g %g\n", Rsun_mag, Psun_mag, Psc_mag );
-
+    Lgm_CrossProduct( ScToSun, ScToBody, &w );
+    Theta = atan2( Lgm_Magnitude( &w ), Lgm_DotProduct( ScToSun, ScToBody ) );
 
     /*
-     * Compute angle between Psun and Psc
+     * Angular radii of the body and the Sun as seen from the S/C.
      */
-    Theta = acos( Lgm_DotProduct( &Psun, &Psc )/(Psun_mag*Psc_mag) );
+    sb     = BodyRadius/Dbody;
+    ThetaB = ( sb < 1.0 ) ? asin( sb ) : M_PI;
+    ThetaS = asin( SOLAR_RADIUS/Dsun );
 
+    *gPenumbra = Theta - ( ThetaB + ThetaS );
+    *gUmbra    = Theta - ( ThetaB - ThetaS );
 
-    /*
-     * Compute anglular radius of Earth and Sun as seen at S/C
-     */
-    //printf("Re/Psc_mag, Re, Psc_mag = %g %g %g\n", Re/Psc_mag, Re, Psc_mag );
-    ThetaE = asin( Re/Psc_mag );
-    ThetaS = asin( SOLAR_RADIUS/Psun_mag );
-    //printf("Theta, ThetaE, ThetaS = %g %g %g\n", Theta, ThetaE, ThetaS );
+}
 
 
+/*
+ *   Compute Earth Eclipse type for S/C position given in MOD coords (input Re).
+ */
+int Lgm_EarthEclipse( Lgm_Vector *u, Lgm_CTrans *c ) {
+
+    Lgm_Vector  ScToSun, ScToEarth;
+    double      gPenumbra, gUmbra;
+
     /*
-     * To have an umbral eclipse, need to have ThetaE > ThetaS 
-     * and Theta < ThetaE - ThetaS.
-     *
-     *  For a penumbral eclipse need to have |ThetaE - ThetaS| < Theta < ThetaE + ThetaS
-     *
+     * We need (all in MOD, km);
+     *          ScToSun   - Satellite to Sun Vector.
+     *          ScToEarth - Satellite to Earth Vector.
      */
-    if ( ( ThetaE > ThetaS ) && ( Theta < (ThetaE - ThetaS) ) ){
-
-        Type = LGM_UMBRAL_ECLIPSE;
+    ScToSun.x = c->Sun.x*c->earth_sun_dist*Re - Re*u->x;
+    ScToSun.y = c->Sun.y*c->earth_sun_dist*Re - Re*u->y;
+    ScToSun.z = c->Sun.z*c->earth_sun_dist*Re - Re*u->z;
 
-    } else if ( (Theta < (ThetaE + ThetaS)) && ( Theta > fabs(ThetaE - ThetaS))) {
+    ScToEarth.x = -Re*u->x;
+    ScToEarth.y = -Re*u->y;
+    ScToEarth.z = -Re*u->z;
 
-        Type = LGM_PENUMBRAL_ECLIPSE;
+    Lgm_ShadowFunctions( &ScToSun, &ScToEarth, Re, &gPenumbra, &gUmbra );
 
+    if ( gUmbra < 0.0 ) {
+        return( LGM_UMBRAL_ECLIPSE );
+    } else if ( gPenumbra < 0.0 ) {
+        return( LGM_PENUMBRAL_ECLIPSE );
     } else {
-
-        Type = LGM_NO_ECLIPSE;
-
+        return( LGM_NO_ECLIPSE );
     }
 
-
-    return( Type );
-
 }
 
 
@@ -106,95 +107,30 @@ int Lgm_EarthEclipse( Lgm_Vector *u, Lgm_CTrans *c ) {
  */
 int Lgm_MoonEclipse( Lgm_Vector *u, Lgm_CTrans *c ) {
 
-    Lgm_Vector  R_earth_to_sun, P_earth_to_sc, Rmoon, R_moon_to_sc;
-    Lgm_Vector  R_moon_to_sun, R_sc_to_sun, Psc, Psun, Rsun;
-    double      R_earth_to_sun_mag, Psc_mag, Psun_mag, Rsun_mag;
-    double      Theta, ThetaE, ThetaS;
-    int         Type;
-
-    // Earth to sun vector in km
-    R_earth_to_sun_mag = c->earth_sun_dist*Re;    // km
-    R_earth_to_sun     = c->Sun;                  // unit vec.
-    Lgm_ScaleVector( &R_earth_to_sun, R_earth_to_sun_mag ); // km
-
-    // Earth to S/C vector in km
-    P_earth_to_sc.x = Re*u->x; //km
-    P_earth_to_sc.y = Re*u->y; //km
-    P_earth_to_sc.z = Re*u->z; //km
-
-    // Earth to Moon unit vector in MOD
-    Lgm_Radec_to_Cart( c->RA_sun, c->DEC_sun, &Rmoon );
-    
-    // Earth to Moon Vector in km
-    Lgm_ScaleVector( &Rmoon, c->EarthMoonDistance*Re );
-
-
+    Lgm_Vector  Rmoon, ScToSun, ScToMoon;
+    double      gPenumbra, gUmbra;
 
+    // Earth to Moon Vector in km (MOD)
+    Lgm_Radec_to_Cart( c->RA_moon, c->DEC_moon, &Rmoon );
+    Lgm_ScaleVector( &Rmoon, c->EarthMoonDistance*Re );
 
+    // S/C to Sun and S/C to Moon Vectors in km
+    ScToSun.x = c->Sun.x*c->earth_sun_dist*Re - Re*u->x;
+    ScToSun.y = c->Sun.y*c->earth_sun_dist*Re - Re*u->y;
+    ScToSun.z = c->Sun.z*c->earth_sun_dist*Re - Re*u->z;
 
+    ScToMoon.x = Rmoon.x - Re*u->x;
+    ScToMoon.y = Rmoon.y - Re*u->y;
+    ScToMoon.z = Rmoon.z - Re*u->z;
 
-    // Moon to S/C Vector in km
-    R_moon_to_sc.x = P_earth_to_sc.x - Rmoon.x;
-    R_moon_to_sc.y = P_earth_to_sc.y - Rmoon.y;
-    R_moon_to_sc.z = P_earth_to_sc.z - Rmoon.z;
-
-    // Moon to Sun Vector in km
-    R_moon_to_sun.x = R_earth_to_sun.x - Rmoon.x;
-    R_moon_to_sun.y = R_earth_to_sun.y - Rmoon.y;
-    R_moon_to_sun.z = R_earth_to_sun.z - Rmoon.z;
-
-    // S/C to Sun Vector in km
-    R_sc_to_sun.x = R_moon_to_sun.x - R_moon_to_sc.x;
-    R_sc_to_sun.y = R_moon_to_sun.y - R_moon_to_sc.y;
-    R_sc_to_sun.z = R_moon_to_sun.z - R_moon_to_sc.z;
-
-
-    Psc  = R_moon_to_sc;  Psc_mag  = Lgm_Magnitude( &Psc );
-    Psun = R_sc_to_sun;   Psun_mag = Lgm_Magnitude( &Psun );
-    Rsun = R_moon_to_sun; Rsun_mag = Lgm_Magnitude( &Rsun );
-
-    
-
-    //printf("Moon: Rsun_mag, Psun_mag, Psc_mag = %g %g %g\n", Rsun_mag, Psun_mag, Psc_mag );
-
-
-    /*
-     * Compute angle between Psun and Psc
-     */
-    Theta = acos( Lgm_DotProduct( &Psun, &Psc )/(Psun_mag*Psc_mag) );
-
-
-    /*
-     * Compute anglular radius of Earth and Sun as seen at S/C
-     */
-    //printf("Re/Psc_mag, Re, Psc_mag = %g %g %g\n", Re/Psc_mag, Re, Psc_mag );
-    ThetaE = asin( Re/Psc_mag );
-    ThetaS = asin( LUNAR_RADIUS/Psun_mag );
-    //printf("Theta, ThetaE, ThetaS = %g %g %g\n", Theta, ThetaE, ThetaS );
-
-    /*
-     * To have an umbral eclipse, need to have ThetaE > ThetaS 
-     * and Theta < ThetaE - ThetaS.
-     *
-     *  For a penumbral eclipse need to have |ThetaE - ThetaS| < Theta < ThetaE + ThetaS
-     *
-     */
-    if ( ( ThetaE > ThetaS ) && ( Theta < (ThetaE - ThetaS) ) ){
-
-        Type = LGM_UMBRAL_ECLIPSE;
-
-    } else if ( (Theta < (ThetaE + ThetaS)) && ( Theta > fabs(ThetaE - ThetaS))) {
-
-        Type = LGM_PENUMBRAL_ECLIPSE;
+    Lgm_ShadowFunctions( &ScToSun, &ScToMoon, LUNAR_RADIUS, &gPenumbra, &gUmbra );
 
+    if ( gUmbra < 0.0 ) {
+        return( LGM_UMBRAL_ECLIPSE );
+    } else if ( gPenumbra < 0.0 ) {
+        return( LGM_PENUMBRAL_ECLIPSE );
     } else {
-
-        Type = LGM_NO_ECLIPSE;
-
+        return( LGM_NO_ECLIPSE );
     }
 
-
-    return( Type );
-
 }
-
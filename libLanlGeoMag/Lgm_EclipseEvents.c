@@ -0,0 +1,344 @@
+/*! \file Lgm_EclipseEvents.c
+ *
+ *  \brief Find shadow (eclipse) entry and exit times along trajectories.
+ *
+ *  Rather than calling Lgm_EarthEclipse()/Lgm_MoonEclipse() at every sample,
+ *  the continuous shadow functions (see Lgm_ShadowFunctions()) are sampled
+ *  with a coarse step and each sign change is refined with a bracketing root
+ *  finder (the Illinois variant of regula falsi). See Lgm/Lgm_Eclipse.h.
+ *
+ *  Example;
+ *
+ *      Lgm_EclipseSgp4     e;
+ *      Lgm_EclipseSource   Src;
+ *      Lgm_EclipseEvent    *Events;
+ *
+ *      Lgm_EclipseSgp4_Init( &e, &TLEs[0] );
+ *      Src.Func = Lgm_EclipsePos_Sgp4;
+ *      Src.Data = &e;
+ *      n = Lgm_Eclipse_FindEvents( &Src, &Start, &End, 60.0, 1e-3, LGM_ECLIPSE_EARTH, &Events, c );
+ *      for ( i=0; i<n; i++ ) ...
+ *      free( Events );
+ *
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#if USE_OPENMP
+#include <omp.h>
+#endif
+#include "Lgm/Lgm_CTrans.h"
+#include "Lgm/Lgm_DynamicMemory.h"
+#include "Lgm/Lgm_Eclipse.h"
+
+#define LGM_ECLIPSE_NG      4   // Earth penumbra, Earth umbra, Moon penumbra, Moon umbra
+
+
+
+/*
+ *  Evaluate the shadow functions at t (TT seconds since J2000). Returns
+ *  FALSE if the source has no position for t.
+ */
+static int Lgm_Eclipse_g( double t, Lgm_EclipseSource *Src, double *g, Lgm_CTrans *c ) {
+
+    Lgm_DateTime    UTC;
+    Lgm_Vector      u, Rsun, Rmoon, ScToSun, ScToBody;
+
+    Lgm_TTSecSinceJ2000_to_UTC( t, &UTC, c );
+    Lgm_Set_Coord_Transforms( UTC.Date, UTC.Time, c );
+    if ( !Src->Func( &(c->UTC), &u, Src->Data, c ) ) return( FALSE );
+
+    // All in km (MOD)
+    Lgm_ScaleVector( &u, Re );
+    Rsun = c->Sun;
+    Lgm_ScaleVector( &Rsun, c->earth_sun_dist*Re );
+    Lgm_VecSub( &ScToSun, &Rsun, &u );
+
+    ScToBody = u;
+    Lgm_ScaleVector( &ScToBody, -1.0 );
+    Lgm_ShadowFunctions( &ScToSun, &ScToBody, Re, &g[0], &g[1] );
+
+    Lgm_Radec_to_Cart( c->RA_moon, c->DEC_moon, &Rmoon );
+    Lgm_ScaleVector( &Rmoon, c->EarthMoonDistance*Re );
+    Lgm_VecSub( &ScToBody, &Rmoon, &u );
+    Lgm_ShadowFunctions( &ScToSun, &ScToBody, LUNAR_RADIUS, &g[2], &g[3] );
+
+    return( TRUE );
+
+}
+
+
+/*
+ *  Refine the zero of g[k] bracketed by [a, b] to within Tol seconds.
+ */
+static double Lgm_Eclipse_Refine( double a, double fa, double b, double fb, int k, double Tol, Lgm_EclipseSource *Src, Lgm_CTrans *c ) {
+
+    double  t, ft, g[LGM_ECLIPSE_NG];
+    int     Side = 0, Iter;
+
+    for ( Iter=0; ( Iter < 100 ) && ( b-a > Tol ); Iter++ ) {
+
+        /*
+         * Regula falsi (Illinois), with bisection steps if it stalls.
+         */
+        t = ( Iter < 50 ) ? ( a*fb - b*fa )/( fb - fa ) : 0.5*(a+b);
+        if ( ( t <= a ) || ( t >= b ) ) t = 0.5*(a+b);
+
+        if ( !Lgm_Eclipse_g( t, Src, g, c ) ) break;
+        ft = g[k];
+
+        if ( ft*fb > 0.0 ) {
+            b = t; fb = ft;
+            if ( Side == -1 ) fa *= 0.5;
+            Side = -1;
+        } else if ( ft*fa > 0.0 ) {
+            a = t; fa = ft;
+            if ( Side == +1 ) fb *= 0.5;
+            Side = +1;
+        } else {
+            return( t );
+        }
+
+    }
+
+    return( ( fabs(fa) < fabs(fb) ) ? a : b );
+
+}
+
+
+static int Lgm_Eclipse_CompareEvents( const void *p1, const void *p2 ) {
+
+    double t1 = ((Lgm_EclipseEvent *)p1)->t;
+    double t2 = ((Lgm_EclipseEvent *)p2)->t;
+
+    return( ( t1 < t2 ) ? -1 : ( t1 > t2 ) ? 1 : 0 );
+
+}
+
+
+/**
+ *  Find the times at which a S/C enters and leaves the shadows of the Earth
+ *  and/or Moon.
+ *
+ *      \param[in]      Src         Source of the S/C positions.
+ *      \param[in]      Start       Start of the time range (UTC).
+ *      \param[in]      End         End of the time range (UTC).
+ *      \param[in]      Step        Coarse step (s). Shadow passages shorter than this may be missed.
+ *      \param[in]      Tol         Accuracy of the event times (s).
+ *      \param[in]      Bodies      LGM_ECLIPSE_EARTH, LGM_ECLIPSE_MOON or LGM_ECLIPSE_EARTH | LGM_ECLIPSE_MOON.
+ *      \param[out]     Events      The events, in time order (allocated here, free() it when done).
+ *      \param[in]      c           Lgm_CTrans structure to use (its time gets changed).
+ *
+ *      \returns        The number of events found (or -1 on error).
+ */
+long int Lgm_Eclipse_FindEvents( Lgm_EclipseSource *Src, Lgm_DateTime *Start, Lgm_DateTime *End, double Step, double Tol, int Bodies,
+                                 Lgm_EclipseEvent **Events, Lgm_CTrans *c ) {
+
+    Lgm_EclipseEvent    *e = NULL;
+    double              t0, t1, ta, tb, ga[LGM_ECLIPSE_NG], gb[LGM_ECLIPSE_NG];
+    int                 k, Havea, Haveb;
+    long int            n = 0, nAlloc = 0;
+
+    *Events = NULL;
+    if ( Step <= 0.0 ) {
+        printf("Lgm_Eclipse_FindEvents: Step must be positive (got %g)\n", Step );
+        return( -1 );
+    }
+    if ( Tol <= 0.0 ) Tol = 1e-3;
+
+    t0 = Lgm_UTC_to_TTSecSinceJ2000( Start, c );
+    t1 = Lgm_UTC_to_TTSecSinceJ2000( End, c );
+
+    ta    = t0;
+    Havea = Lgm_Eclipse_g( ta, Src, ga, c );
+    while ( ta < t1 ) {
+
+        tb    = ( ta + Step < t1 ) ? ta + Step : t1;
+        Haveb = Lgm_Eclipse_g( tb, Src, gb, c );
+
+        if ( Havea && Haveb ) {
+            for ( k=0; k<LGM_ECLIPSE_NG; k++ ) {
+
+                if ( !( Bodies & ( (k < 2) ? LGM_ECLIPSE_EARTH : LGM_ECLIPSE_MOON ) ) ) continue;
+                if ( ( ga[k] < 0.0 ) == ( gb[k] < 0.0 ) ) continue;
+
+                if ( n >= nAlloc ) {
+                    nAlloc = ( nAlloc ) ? 2*nAlloc : 16;
+                    e = (Lgm_EclipseEvent *)realloc( e, nAlloc*sizeof(Lgm_EclipseEvent) );
+                }
+                e[n].t      = Lgm_Eclipse_Refine( ta, ga[k], tb, gb[k], k, Tol, Src, c );
+                e[n].Body   = ( k < 2 ) ? LGM_ECLIPSE_EARTH : LGM_ECLIPSE_MOON;
+                e[n].Shadow = ( k%2 ) ? LGM_UMBRAL_ECLIPSE : LGM_PENUMBRAL_ECLIPSE;
+                e[n].Entry  = ( gb[k] < 0.0 );
+                Lgm_TTSecSinceJ2000_to_UTC( e[n].t, &(e[n].UTC), c );
+                ++n;
+
+            }
+        }
+
+        ta    = tb;
+        Havea = Haveb;
+        memcpy( ga, gb, LGM_ECLIPSE_NG*sizeof(double) );
+
+    }
+
+    if ( n > 1 ) qsort( e, n, sizeof(Lgm_EclipseEvent), Lgm_Eclipse_CompareEvents );
+    *Events = e;
+
+    return( n );
+
+}
+
+
+/**
+ *  Lgm_Eclipse_FindEvents() for a number of S/C (in parallel if built with
+ *  OpenMP). Each S/C gets its own list of events, Events[i] (nEvents[i] of
+ *  them, free() each when done). Each source must be independent of the
+ *  others (e.g. each Lgm_EclipseSgp4 is only used by one thread).
+ */
+void Lgm_Eclipse_FindEvents_Multi( int nSat, Lgm_EclipseSource *Src, Lgm_DateTime *Start, Lgm_DateTime *End, double Step, double Tol, int Bodies,
+                                   long int *nEvents, Lgm_EclipseEvent **Events, Lgm_CTrans *c ) {
+
+    Lgm_CTrans  *c2;
+    int         i;
+
+#if USE_OPENMP
+    #pragma omp parallel private(c2)
+#endif
+    {
+        c2 = Lgm_CopyCTrans( c );
+
+#if USE_OPENMP
+        #pragma omp for schedule(dynamic,1)
+#endif
+        for ( i=0; i<nSat; i++ ) {
+            nEvents[i] = Lgm_Eclipse_FindEvents( &Src[i], Start, End, Step, Tol, Bodies, &Events[i], c2 );
+        }
+
+        Lgm_free_ctrans( c2 );
+    }
+
+}
+
+
+/**
+ *  Set up the data for Lgm_EclipsePos_Sgp4() from a TLE.
+ */
+void Lgm_EclipseSgp4_Init( Lgm_EclipseSgp4 *e, _SgpTLE *TLE ) {
+
+    memset( e, 0, sizeof(Lgm_EclipseSgp4) );
+    e->TLE = *TLE;
+    LgmSgp_SGP4_Init( &(e->s), &(e->TLE) );
+
+}
+
+
+/**
+ *  Lgm_EclipseSource function for SGP4. Data is a Lgm_EclipseSgp4.
+ */
+int Lgm_EclipsePos_Sgp4( Lgm_DateTime *UTC, Lgm_Vector *u, void *Data, Lgm_CTrans *c ) {
+
+    Lgm_EclipseSgp4 *e = (Lgm_EclipseSgp4 *)Data;
+    Lgm_Vector      Uteme;
+
+    LgmSgp_SGP4( ( UTC->JD - e->TLE.JD )*1440.0, &(e->s) );
+    if ( e->s.error ) return( FALSE );
+
+    Uteme.x = e->s.X/Re; Uteme.y = e->s.Y/Re; Uteme.z = e->s.Z/Re;
+    Lgm_Convert_Coords( &Uteme, u, TEME_TO_MOD, c );
+
+    return( TRUE );
+
+}
+
+
+/**
+ *  Make a Lgm_EclipseTable from a list of positions.
+ *
+ *      \param[in]      n           Number of positions (at least 2).
+ *      \param[in]      UTC         Times of the positions (UTC, increasing).
+ *      \param[in]      u           Positions (Re).
+ *      \param[in]      Flag        Lgm_Convert_Coords() flag to go from the system of u to MOD (e.g. GEI2000_TO_MOD), or 0 for MOD.
+ *      \param[in]      c           Lgm_CTrans structure (for the time conversions).
+ *
+ *      \returns        The table (free with Lgm_EclipseTable_Free()), or NULL on error.
+ */
+Lgm_EclipseTable *Lgm_EclipseTable_Create( long int n, Lgm_DateTime *UTC, Lgm_Vector *u, int Flag, Lgm_CTrans *c ) {
+
+    Lgm_EclipseTable    *e;
+    long int            i;
+
+    if ( n < 2 ) {
+        printf("Lgm_EclipseTable_Create: Need at least 2 points (got %ld)\n", n );
+        return( NULL );
+    }
+
+    e = (Lgm_EclipseTable *)calloc( 1, sizeof(Lgm_EclipseTable) );
+    e->n    = n;
+    e->Flag = Flag;
+    LGM_ARRAY_1D( e->t, n, double );
+    LGM_ARRAY_1D( e->u, n, Lgm_Vector );
+    for ( i=0; i<n; i++ ) {
+        e->t[i] = Lgm_UTC_to_TTSecSinceJ2000( &UTC[i], c );
+        e->u[i] = u[i];
+    }
+
+    return( e );
+
+}
+
+
+void Lgm_EclipseTable_Free( Lgm_EclipseTable *e ) {
+
+    if ( e == NULL ) return;
+    LGM_ARRAY_1D_FREE( e->t );
+    LGM_ARRAY_1D_FREE( e->u );
+    free( e );
+
+}
+
+
+/**
+ *  Lgm_EclipseSource function for a table of positions. Data is a
+ *  Lgm_EclipseTable. Uses cubic Lagrange interpolation on the 4 nearest
+ *  points (fewer at the ends or if the table is short).
+ */
+int Lgm_EclipsePos_Table( Lgm_DateTime *UTC, Lgm_Vector *u, void *Data, Lgm_CTrans *c ) {
+
+    Lgm_EclipseTable    *e = (Lgm_EclipseTable *)Data;
+    Lgm_Vector          v;
+    double              t, w;
+    long int            lo, hi, mid, i0, i1, i, j;
+
+    t = Lgm_TT_to_TTSecSinceJ2000( &(c->TT) );
+    if ( ( t < e->t[0] ) || ( t > e->t[e->n-1] ) ) return( FALSE );
+
+    lo = 0; hi = e->n-1;
+    while ( hi - lo > 1 ) {
+        mid = (lo+hi)/2;
+        if ( t < e->t[mid] ) hi = mid;
+        else lo = mid;
+    }
+    i0 = lo-1; if ( i0 < 0 ) i0 = 0;
+    i1 = i0+3; if ( i1 > e->n-1 ) { i1 = e->n-1; i0 = ( i1-3 > 0 ) ? i1-3 : 0; }
+
+    v.x = v.y = v.z = 0.0;
+    for ( i=i0; i<=i1; i++ ) {
+        for ( w=1.0, j=i0; j<=i1; j++ ) {
+            if ( j != i ) w *= ( t - e->t[j] )/( e->t[i] - e->t[j] );
+        }
+        v.x += w*e->u[i].x;
+        v.y += w*e->u[i].y;
+        v.z += w*e->u[i].z;
+    }
+
+    if ( e->Flag ) Lgm_Convert_Coords( &v, u, e->Flag, c );
+    else *u = v;
+
+    return( TRUE );
+
+}
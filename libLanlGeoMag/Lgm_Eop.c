@@ -12,43 +12,27 @@
 #include <string.h>
 #include "Lgm/Lgm_CTrans.h"
 #include "Lgm/Lgm_Eop.h"
+#if USE_OPENMP
+#include <omp.h>
+#endif
 
-#define JD1962 2437665.5
 
 
+/*
+ *  Allocates an (empty) Lgm_Eop structure. The EOP values themselves are
+ *  attached by Lgm_read_eop().
+ */
 Lgm_Eop *Lgm_init_eop( int Verbose ) {
 
     Lgm_Eop      *e;
-    long int      days;
-    double        cJD;
-    Lgm_CTrans   *c = Lgm_init_ctrans(0);
 
     e = (Lgm_Eop *) calloc (1, sizeof(*e));
 
     e->Verbosity = Verbose;
-
-    /*
-     *  Guess roughly how many values we need to calloc. The data goes from
-     *  1962->now+1year or so.
-     */
-    cJD    = Lgm_GetCurrentJD( c );
-    days = (long int)(cJD-JD1962+400.5);
-    
-    e->Size     = days; // size of arrays
-    e->nEopVals = 0;    // number of values stored in arrays
-    e->Date = (long int *)calloc( days, sizeof(long int) );
-    e->MJD  = (double *)calloc( days, sizeof(double) );
-    e->xp   = (double *)calloc( days, sizeof(double) );
-    e->yp   = (double *)calloc( days, sizeof(double) );
-    e->DUT1 = (double *)calloc( days, sizeof(double) );
-    e->LOD  = (double *)calloc( days, sizeof(double) );
-    e->dPsi = (double *)calloc( days, sizeof(double) );
-    e->dEps = (double *)calloc( days, sizeof(double) );
-    e->dX   = (double *)calloc( days, sizeof(double) );
-    e->dY   = (double *)calloc( days, sizeof(double) );
-    e->DAT  = (double *)calloc( days, sizeof(double) );
-
-    Lgm_free_ctrans( c );
+    e->Size      = 0;     // size of arrays
+    e->nEopVals  = 0;     // number of values stored in arrays
+    e->Shared    = FALSE;
+    e->Hint      = 0;
 
     return e;
 
@@ -56,18 +40,20 @@ Lgm_Eop *Lgm_init_eop( int Verbose ) {
 
 void  Lgm_destroy_eop( Lgm_Eop *e ) {
 
-    // first free arrays inside structure
-    free( e->Date );
-    free( e->MJD );
-    free( e->xp );
-    free( e->yp );
-    free( e->DUT1 );
-    free( e->LOD );
-    free( e->dPsi );
-    free( e->dEps );
-    free( e->dX );
-    free( e->dY );
-    free( e->DAT );
+    // first free arrays inside structure (unless they belong to the shared table)
+    if ( !e->Shared ) {
+        free( e->Date );
+        free( e->MJD );
+        free( e->xp );
+        free( e->yp );
+        free( e->DUT1 );
+        free( e->LOD );
+        free( e->dPsi );
+        free( e->dEps );
+        free( e->dX );
+        free( e->dY );
+        free( e->DAT );
+    }
 
     // tehn free structure itself
     free( e );
@@ -77,50 +63,192 @@ void  Lgm_destroy_eop( Lgm_Eop *e ) {
 }
 
 
-void Lgm_read_eop( Lgm_Eop *e ) {
+/*
+ *  Parses LgmEop.dat into e. The whole file is read in one go and the values
+ *  are stored column-wise in a single block of memory (e->MJD points to the
+ *  start of it, and e->Date to a separate block of long ints). Records that
+ *  do not hold a date and 10 numbers are reported and skipped. Returns FALSE
+ *  (with e left empty) if the file cannot be read or holds no good records.
+ */
+static int Lgm_ParseEopFile( Lgm_Eop *e ) {
 
     FILE        *fp;
-    long int    n, N;
-    char        *Line, *Filename;
+    long int    n, N, nBytes, Line;
+    char        *Buf, *p, *q, *r, Filename[512];
+    double      *Block, *v[10];
+    int         j;
+
+    e->nEopVals = 0;
+    e->Size     = 0;
+    e->Date     = NULL;
+    e->MJD  = e->xp   = e->yp = e->DUT1 = e->LOD = NULL;
+    e->dPsi = e->dEps = e->dX = e->dY   = e->DAT = NULL;
 
-    Filename = (char *)calloc( 512, sizeof(char) );
     sprintf( Filename, "%s/LgmEop.dat", LGM_EOP_DATA_DIR );
-    if ( (fp = fopen( Filename, "r" )) != NULL ) {
-
-        Line = (char *)calloc( 260, sizeof(char) );
-        while( fgets( Line, 256, fp ) != NULL ) {
-            if ( Line[0] != '#' ) {
-                n = e->nEopVals;
-                N = e->Size;
-                if ( n == N ) {
-                    // Out array sizes need to be increased  (try adding another years worth)
-                    N += 365;
-                    e->Date = realloc( e->Date, N );
-                    e->MJD  = realloc( e->MJD, N );
-                    e->xp   = realloc( e->xp, N );
-                    e->yp   = realloc( e->yp, N );
-                    e->DUT1 = realloc( e->DUT1, N );
-                    e->LOD  = realloc( e->LOD, N );
-                    e->dPsi = realloc( e->dPsi, N );
-                    e->dEps = realloc( e->dEps, N );
-                    e->dX   = realloc( e->dX, N );
-                    e->dY   = realloc( e->dY, N );
-                    e->DAT  = realloc( e->DAT, N );
-                    e->Size = N;
+    if ( (fp = fopen( Filename, "r" )) == NULL ) {
+        printf("Cannot open LgmEop.dat file\n");
+        return( FALSE );
+    }
+
+    fseek( fp, 0L, SEEK_END ); nBytes = ftell( fp ); fseek( fp, 0L, SEEK_SET );
+    if ( ( nBytes < 0 ) || ( (Buf = (char *)malloc( nBytes+1 )) == NULL ) ) {
+        printf("Lgm_ParseEopFile: Could not read %s\n", Filename );
+        fclose( fp );
+        return( FALSE );
+    }
+    nBytes = fread( Buf, 1, nBytes, fp );
+    Buf[nBytes] = '\0';
+    fclose( fp );
+
+    // Upper bound on the number of records is the number of lines
+    for ( N=1, p=Buf; *p; p++ ) if ( *p == '\n' ) ++N;
+
+    Block   = (double *)calloc( 10*N, sizeof(double) );
+    e->Date = (long int *)calloc( N, sizeof(long int) );
+    if ( ( Block == NULL ) || ( e->Date == NULL ) ) {
+        printf("Lgm_ParseEopFile: Memory allocation problem\n");
+        free( Block ); free( e->Date ); free( Buf );
+        e->Date = NULL;
+        return( FALSE );
+    }
+    e->MJD  = Block;     e->xp   = Block+N;   e->yp   = Block+2*N; e->DUT1 = Block+3*N; e->LOD  = Block+4*N;
+    e->dPsi = Block+5*N; e->dEps = Block+6*N; e->dX   = Block+7*N; e->dY   = Block+8*N; e->DAT  = Block+9*N;
+    v[0] = e->MJD;  v[1] = e->xp;   v[2] = e->yp; v[3] = e->DUT1; v[4] = e->LOD;
+    v[5] = e->dPsi; v[6] = e->dEps; v[7] = e->dX; v[8] = e->dY;   v[9] = e->DAT;
+
+    n = 0;
+    for ( Line=1, p=Buf; *p; Line++ ) {
+        for ( q=p; (*q == ' ') || (*q == '\t') || (*q == '\r'); ) ++q;
+        if ( ( *q != '#' ) && ( *q != '\n' ) && ( *q != '\0' ) ) {
+            // strtol()/strtod() leave the end pointer where they started if there was no number
+            e->Date[n] = strtol( p, &q, 10 );
+            for ( j=0; ( q != p ) && ( j<10 ); j++ ) {
+                r = q;
+                v[j][n] = strtod( r, &q );
+                if ( q == r ) break;
+            }
+            if ( j == 10 ) {
+                ++n;
+            } else {
+                printf("Lgm_ParseEopFile: Could not parse line %ld of %s (skipping it)\n", Line, Filename );
+            }
+        }
+        while ( *p && (*p != '\n') ) ++p; // skip to next line
+        if ( *p ) ++p;
+    }
+    free( Buf );
+
+    if ( n == 0 ) {
+        printf("Lgm_ParseEopFile: No EOP records found in %s\n", Filename );
+        free( Block ); free( e->Date );
+        e->Date = NULL;
+        e->MJD  = e->xp   = e->yp = e->DUT1 = e->LOD = NULL;
+        e->dPsi = e->dEps = e->dX = e->dY   = e->DAT = NULL;
+        return( FALSE );
+    }
+
+    e->nEopVals = n;
+    e->Size     = N;
+
+    return( TRUE );
+
+}
+
+
+/*
+ *  Returns the process-wide EOP table. LgmEop.dat is only parsed until it has
+ *  been read successfully; after that the table is read-only and is shared by
+ *  every Lgm_Eop that is passed to Lgm_read_eop(). If it could not be read,
+ *  an empty table (nEopVals = 0) is returned and the next call tries again.
+ *  (The shared table itself is only handed out once it is complete, so a
+ *  retry never changes a table that another thread may be reading.)
+ */
+static Lgm_Eop          Lgm_SharedEopTable;
+static Lgm_Eop          Lgm_EmptyEopTable = { .Shared = TRUE };
+static volatile int     Lgm_SharedEopTableLoaded = FALSE;
+
+Lgm_Eop *Lgm_SharedEop( void ) {
+
+    if ( !Lgm_SharedEopTableLoaded ) {
+        #if USE_OPENMP
+        #pragma omp critical (Lgm_SharedEop)
+        #endif
+        {
+            if ( !Lgm_SharedEopTableLoaded ) {
+                Lgm_SharedEopTable.Shared = TRUE;
+                if ( Lgm_ParseEopFile( &Lgm_SharedEopTable ) ) {
+                    #if USE_OPENMP
+                    #pragma omp flush
+                    #endif
+                    Lgm_SharedEopTableLoaded = TRUE;
                 }
-                sscanf( Line, "%ld %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf", &e->Date[n], &e->MJD[n], &e->xp[n],
-                    &e->yp[n], &e->DUT1[n], &e->LOD[n], &e->dPsi[n], &e->dEps[n], &e->dX[n], &e->dY[n], &e->DAT[n]);
-                ++(e->nEopVals);
             }
         }
-        free(Filename);
-        free(Line);
-        fclose( fp );
+    }
 
-    } else {
-        printf("Cannot open LgmEop.dat file\n");
+    return( Lgm_SharedEopTableLoaded ? &Lgm_SharedEopTable : &Lgm_EmptyEopTable );
+
+}
+
+
+/*
+ *  Attaches the (shared, read-only) EOP values to e. Only the first
+ *  successful call in a process reads LgmEop.dat.
+ */
+void Lgm_read_eop( Lgm_Eop *e ) {
+
+    Lgm_Eop     *s = Lgm_SharedEop();
+
+    if ( !e->Shared ) {
+        free( e->Date ); free( e->MJD ); free( e->xp ); free( e->yp ); free( e->DUT1 ); free( e->LOD );
+        free( e->dPsi ); free( e->dEps ); free( e->dX ); free( e->dY ); free( e->DAT );
     }
 
+    e->Size     = s->Size;
+    e->nEopVals = s->nEopVals;
+    e->Date     = s->Date;
+    e->MJD      = s->MJD;
+    e->xp       = s->xp;
+    e->yp       = s->yp;
+    e->DUT1     = s->DUT1;
+    e->LOD      = s->LOD;
+    e->dPsi     = s->dPsi;
+    e->dEps     = s->dEps;
+    e->dX       = s->dX;
+    e->dY       = s->dY;
+    e->DAT      = s->DAT;
+    e->Shared   = TRUE;
+    e->Hint     = 0;
+
+}
+
+
+/*
+ *  Returns the index of the last EOP record with e->MJD[i] <= MJD (clamped to
+ *  [0, nEopVals-1]). The record found last time is checked first, otherwise
+ *  the table is bisected.
+ */
+long int Lgm_EopIndex( double MJD, Lgm_Eop *e ) {
+
+    long int    n, h, lo, hi, mid;
+
+    n = e->nEopVals;
+    if ( n <= 0 ) return( 0 );
+    if ( MJD < e->MJD[0] ) return( 0 );
+
+    h = e->Hint;
+    if ( (h >= 0) && (h < n) && (MJD >= e->MJD[h]) && ( (h == n-1) || (MJD < e->MJD[h+1]) ) ) return( h );
+
+    lo = 0; hi = n-1;
+    while ( lo < hi ) {
+        mid = (lo+hi+1)/2;
+        if ( MJD >= e->MJD[mid] ) lo = mid;
+        else hi = mid-1;
+    }
+    e->Hint = lo;
+
+    return( lo );
+
 }
 
 
@@ -128,7 +256,7 @@ void Lgm_get_eop_at_JD( double JD, Lgm_EopOne *eop, Lgm_Eop *e ) {
      
     long int            q, ql, qh, t;
     int                 nq, i, ny, nm, nd;
-    double              *x, *y, MJD, UTC;
+    double              x[15], y[15], MJD, UTC;
     gsl_interp_accel    *acc;
     gsl_spline          *spline;
 
@@ -152,14 +280,12 @@ void Lgm_get_eop_at_JD( double JD, Lgm_EopOne *eop, Lgm_Eop *e ) {
 
     } else {
 
-        q = (int)( JD-JD1962 ); // approximate index where JD is found in the LgmEop.dat file
+        q = Lgm_EopIndex( MJD, e ); // index where JD is found in the LgmEop.dat file
         ql = q-7; // set low index to -7days
         qh = q+7; // set high index to +7days
         if (ql < 0 ) ql = 0;
-        if (qh >= e->nEopVals ) qh = e->nEopVals;
+        if (qh >= e->nEopVals ) qh = e->nEopVals-1;
         nq = qh-ql+1;
-        x = (double *)calloc( nq, sizeof(double) );
-        y = (double *)calloc( nq, sizeof(double) );
 
         acc    = gsl_interp_accel_alloc( );
         spline = gsl_spline_alloc( gsl_interp_cspline, nq );
@@ -215,8 +341,6 @@ void Lgm_get_eop_at_JD( double JD, Lgm_EopOne *eop, Lgm_Eop *e ) {
 
 
 
-        free(x);
-        free(y);
         gsl_spline_free (spline);
         gsl_interp_accel_free (acc);
 
@@ -456,7 +456,7 @@ void Lgm_F2P_SetFlux( double **J, double *E, int nE, double *A, int nA, Lgm_Flux
 
 
     int     i, j;
-    double  flux, p2c2, fp, Min, Max;
+    double  Min, Max;
 
 
     /*
@@ -516,6 +516,36 @@ void Lgm_F2P_SetFlux( double **J, double *E, int nE, double *A, int nA, Lgm_Flux
      * same Es and Alphas we started with.
      */
     LGM_ARRAY_2D( f->PSD_EA, f->nE, f->nA, double );
+    Lgm_F2P_PsdFromFlux( f );
+    if ( f->DumpDiagnostics ) {
+        DumpGif( "Lgm_FluxToPsd_PSD_EA", f->nA, f->nE, f->PSD_EA );
+    }
+
+    f->Alloced1 = TRUE;
+
+    return;
+
+}
+
+
+
+
+/**
+ *  \brief
+ *      Converts the flux array in a Lgm_FluxToPsd structure to PSD.
+ *  \details
+ *      Fills f->PSD_EA[E][Alpha] from f->FLUX_EA[E][Alpha] (both must already
+ *      be allocated). This is the conversion that Lgm_F2P_SetFlux() does; it
+ *      is split out so that the arrays can be reused (see Lgm_F2P_RunStream()).
+ *
+ *      \param[in,out]  f   Lgm_FluxToPsd sturcture.
+ *
+ */
+void Lgm_F2P_PsdFromFlux( Lgm_FluxToPsd *f ) {
+
+    int     i, j;
+    double  flux, p2c2, fp;
+
     for (j=0; j<f->nA; j++) {
         for (i=0; i<f->nE; i++) {
             flux   = f->FLUX_EA[i][j];
@@ -524,13 +554,6 @@ void Lgm_F2P_SetFlux( double **J, double *E, int nE, double *A, int nA, Lgm_Flux
             f->PSD_EA[i][j] = fp; // PSD_EA is "PSD versus Energy and Pitch Angle".
         }
     }
-    if ( f->DumpDiagnostics ) {
-        DumpGif( "Lgm_FluxToPsd_PSD_EA", f->nA, f->nE, f->PSD_EA );
-    }
-
-    f->Alloced1 = TRUE;
-
-    return;
 
 }
 
@@ -561,8 +584,8 @@ void Lgm_F2P_SetFlux( double **J, double *E, int nE, double *A, int nA, Lgm_Flux
  *      can just use the \f$f(E, \alpha)\f$ array to compute the desired f values.
  *      The steps are;
  *    
- *          - For each K, compute \f$\alpha(K)\f$. This is done with the routine
- *            Lgm_AlphaOfK().
+ *          - For each K, compute \f$\alpha(K)\f$. This is done (for all of
+ *            the K's at once) with the routine Lgm_AlphaOfK_Batch().
  *    
  *          - Then we compute E from \f$\alpha\f$ and the given mu and Alpha
  *            values.
@@ -584,9 +607,7 @@ void Lgm_F2P_SetFlux( double **J, double *E, int nE, double *A, int nA, Lgm_Flux
  */
 void Lgm_F2P_GetPsdAtConstMusAndKs( double *Mu, int nMu, double *K, int nK, Lgm_MagModelInfo *mInfo, Lgm_FluxToPsd *f ) {
 
-    int                 k, m, DoIt;
-    double              AlphaEq, SinA;
-    Lgm_MagModelInfo    *mInfo2;
+    int                 k, m;
 
 
     /*
@@ -613,75 +634,179 @@ void Lgm_F2P_GetPsdAtConstMusAndKs( double *Mu, int nMu, double *K, int nK, Lgm_
 
     /*
      * Copy K's (given in the arguments) into f structure.
-     * Transform the K's into Alpha's using Lgm_AlphaOfK().
+     * Transform the K's into Alpha's using Lgm_F2P_AlphaOfK() (which no
+     * longer runs an OpenMP loop over the K's when the interpolated
+     * routines are used; see there).
      * Save the results in the f structure.
      */
-    if ( Lgm_Setup_AlphaOfK( &(f->DateTime), &(f->Position), mInfo ) > 0 ) {
+    for ( k=0; k<nK; k++ ) f->K[k] = K[k];
+    Lgm_F2P_AlphaOfK( &(f->DateTime), &(f->Position), nK, f->K, f->AofK, &(f->B), mInfo );
+
+    if (  !(f->UseModelB)  ) {
+        if ( mInfo->VerbosityLevel > 0 ) printf("Bmodel, Bobs = %g %g\n", f->B, f->B_obs );
+    }
 
 
-        f->B = mInfo->Blocal;
+    /*
+     * Copy Mu's (given in the arguments) into f structure.
+     * Then get PSD at the Mu's and K's.
+     */
+    for ( m=0; m<nMu; m++ ) f->Mu[m] = Mu[m];
+    LGM_ARRAY_2D( f->PSD_MK, f->nMu,  f->nK,  double );
+    Lgm_F2P_PsdAtMusAndKs( f );
 
-        { // start parallel
+    if ( f->DumpDiagnostics ) {
+        DumpGif( "Lgm_FluxToPsd_PSD_MK", f->nK, f->nMu, f->PSD_MK );
+    }
 
+
+    f->Alloced2 = TRUE;
+
+    return;
+
+}
+
+
+
+/**
+ *  \brief
+ *      Computes the local pitch angles implied by a set of K values.
+ *  \details
+ *      This is the field-model part of Lgm_F2P_GetPsdAtConstMusAndKs(). It
+ *      traces the field line through u, converts the K's into equatorial
+ *      pitch angles (with Lgm_AlphaOfK_Batch(), or with Lgm_AlphaOfK() on
+ *      each K in parallel if mInfo->UseInterpRoutines is not set) and then
+ *      maps those to the local pitch angles at u. It does not touch a
+ *      Lgm_FluxToPsd structure, so it can be run (with separate mInfo's) on
+ *      many times/positions at once.
+ *
+ *      \param[in]      d       Date/Time of measurement.
+ *      \param[in]      u       Position of measurment (in GSM).
+ *      \param[in]      nK      Number of K values
+ *      \param[in]      K       1-D array of K values
+ *      \param[out]     AofK    Local pitch angles (LGM_FILL_VALUE where there are none).
+ *      \param[out]     B       Model field strength at u.
+ *      \param[in,out]  mInfo   A properly initialized and configured Lgm_MagModelInfo structure.
+ *
+ *      \return         The flag returned by Lgm_Setup_AlphaOfK().
+ *
+ */
+int Lgm_F2P_AlphaOfK( Lgm_DateTime *d, Lgm_Vector *u, int nK, double *K, double *AofK, double *B, Lgm_MagModelInfo *mInfo ) {
+
+    int                 k, Flag;
+    double              AlphaEq, SinA, Hmax;
+    Lgm_MagModelInfo    *mInfo2;
+
+    /*
+     * The result for one time/position should not depend on which ones were
+     * done before it with this mInfo (or with this thread's copy of it in
+     * Lgm_F2P_RunStream()). So start the integrators afresh (as
+     * Lgm_InitMagInfo() leaves them), and put back the mInfo->Hmax that
+     * Lgm_Setup_AlphaOfK() sets for the field line it traces.
+     */
+    mInfo->Lgm_MagStep_RK5_FirstTimeThrough = TRUE;
+    mInfo->Lgm_MagStep_BS_FirstTimeThrough  = TRUE;
+    mInfo->Lgm_MagStep_BS_eps_old           = -1.0;
+    mInfo->Lgm_MagStep_BS_first_step        = TRUE;
+    Hmax = mInfo->Hmax;
+
+    if ( (Flag = Lgm_Setup_AlphaOfK( d, u, mInfo )) > 0 ) {
+
+        *B = mInfo->Blocal;
+
+        if ( mInfo->UseInterpRoutines ) {
+
+            /*
+             * All of the K's are on the same field line, so invert them all
+             * at once (K(Alpha) gets tabulated once rather than root-finding
+             * each K separately). This used to be an OpenMP loop over the
+             * K's. Done serially, the batch inversion of 8 K's is about as
+             * quick as that loop would be with one thread per K, and much
+             * quicker with fewer threads (see the F2P_AlphaOfK benchmarks
+             * in tests/bench_LanlGeoMag.c).
+             */
+            Lgm_AlphaOfK_Batch( nK, K, AofK, mInfo ); // Lgm_AlphaOfK_Batch() returns equatorial pitch angles.
+
+        } else {
+
+            /*
+             * Without the pre-traced line Lgm_AlphaOfK_Batch() could only
+             * call Lgm_AlphaOfK() for each K, so spread those over threads
+             * instead, each with a private copy of mInfo.
+             */
+            { // start parallel
 #if USE_OPENMP
-            #pragma omp parallel private(mInfo2,AlphaEq,SinA)
-            #pragma omp for schedule(dynamic, 1)
+                #pragma omp parallel for private(mInfo2) schedule(dynamic, 1)
 #endif
-            for ( k=0; k<nK; k++ ){
-
-                mInfo2 = Lgm_CopyMagInfo( mInfo );  // make a private (per-thread) copy of mInfo
-
-                f->K[k]    = K[k];
-                //printf("\n\nK[%d] = %g   f->DateTime.UTC = %g f->Position = %g %g %g\n", k, K[k], f->DateTime.Time, f->Position.x, f->Position.y, f->Position.z);
-                AlphaEq    = Lgm_AlphaOfK( f->K[k], mInfo2 ); // Lgm_AlphaOfK() returns equatorial pitch angle.
-                SinA       = sqrt( mInfo2->Blocal/mInfo2->Bmin ) * sin( RadPerDeg*AlphaEq );
-                if ( AlphaEq > 0.0 ) {
-                    if ( SinA <= 1.0 ) {
-                        f->AofK[k] = DegPerRad*asin( SinA );
-                    } else {
-                        f->AofK[k] = LGM_FILL_VALUE;
-                        printf("Particles with Eq. PA of %g mirror below us. (I.e. S/C does not see Ks this low).\n", AlphaEq);
-                    }
-                } else {
-                    f->AofK[k] = LGM_FILL_VALUE;
-                    printf("Particles with K of %g mirror below LC height. (I.e. S/C does not see Ks this high).\n", f->K[k]);
+                for ( k=0; k<nK; k++ ){
+                    mInfo2  = Lgm_CopyMagInfo( mInfo );
+                    AofK[k] = Lgm_AlphaOfK( K[k], mInfo2 ); // Lgm_AlphaOfK() returns equatorial pitch angle.
+                    Lgm_FreeMagInfo( mInfo2 );
                 }
-                //printf("f->K[k] = %g   AlphaEq = %g SinA = %g f->AofK[k] = %g\n", f->K[k], AlphaEq, SinA, f->AofK[k]);
+            } // end parallel
 
-                Lgm_FreeMagInfo( mInfo2 ); // free mInfo2
+        }
 
+        for ( k=0; k<nK; k++ ){
 
+            AlphaEq    = AofK[k];
+            SinA       = sqrt( mInfo->Blocal/mInfo->Bmin ) * sin( RadPerDeg*AlphaEq );
+            if ( AlphaEq > 0.0 ) {
+                if ( SinA <= 1.0 ) {
+                    AofK[k] = DegPerRad*asin( SinA );
+                } else {
+                    AofK[k] = LGM_FILL_VALUE;
+                    if ( mInfo->VerbosityLevel > 0 ) printf("Particles with Eq. PA of %g mirror below us. (I.e. S/C does not see Ks this low).\n", AlphaEq);
+                }
+            } else {
+                AofK[k] = LGM_FILL_VALUE;
+                if ( mInfo->VerbosityLevel > 0 ) printf("Particles with K of %g mirror below LC height. (I.e. S/C does not see Ks this high).\n", K[k]);
             }
+            //printf("K[k] = %g   AlphaEq = %g SinA = %g AofK[k] = %g\n", K[k], AlphaEq, SinA, AofK[k]);
 
-        } // end parallel
-
-
+        }
 
         Lgm_TearDown_AlphaOfK( mInfo );
 
     } else {
 
         // Blocal will have been set in Lgm_Setup_AlphaOfK() even if it returned a value <= 0.
-        f->B = mInfo->Blocal;
-        for ( k=0; k<nK; k++ ) f->AofK[k] = LGM_FILL_VALUE;
+        *B = mInfo->Blocal;
+        for ( k=0; k<nK; k++ ) AofK[k] = LGM_FILL_VALUE;
 
     }
 
-    if (  !(f->UseModelB)  ) {
-        printf("Bmodel, Bobs = %g %g\n", f->B, f->B_obs );
-    }
+    mInfo->Hmax = Hmax;
+
+    return( Flag );
+
+}
+
+
+/**
+ *  \brief
+ *      Computes PSD at the Mu's and K's in a Lgm_FluxToPsd structure.
+ *  \details
+ *      This is the numerical part of Lgm_F2P_GetPsdAtConstMusAndKs(). The
+ *      f->PSD_EA, f->Mu, f->AofK and f->B (or f->B_obs) values must already
+ *      be set, and f->EofMu and f->PSD_MK must already be allocated. No
+ *      field model evaluations are done here.
+ *
+ *      \param[in,out]  f   Lgm_FluxToPsd sturcture.
+ *
+ */
+void Lgm_F2P_PsdAtMusAndKs( Lgm_FluxToPsd *f ) {
 
+    int     k, m, DoIt;
 
     /*
-     * Copy Mu's (given in the arguments) into f structure.
      * Transform the Mu's into (Kinetic) Energies.
      * Save the results in the f structure.
      * Note that since this conversion involves Mu and Alpha, the result is 2D.
 assumes electrons -- generalize this...
      */
-    for ( m=0; m<nMu; m++ ){
-        f->Mu[m] = Mu[m];
-        for ( k=0; k<nK; k++ ){
+    for ( m=0; m<f->nMu; m++ ){
+        for ( k=0; k<f->nK; k++ ){
             if ( f->UseModelB ) {
                 f->EofMu[m][k] = Lgm_Mu_to_Ek( f->Mu[m], f->AofK[k], f->B, LGM_Ee0 );
             } else {
@@ -695,9 +820,8 @@ assumes electrons -- generalize this...
      * Now, from the PSD[E][a] array, get PSD at the E's and Alpha's we just computed.
      * The result will be the same as PSD at the given Mu's and K's
      */
-    LGM_ARRAY_2D( f->PSD_MK, f->nMu,  f->nK,  double );
-    for ( m=0; m<nMu; m++ ){
-        for ( k=0; k<nK; k++ ){
+    for ( m=0; m<f->nMu; m++ ){
+        for ( k=0; k<f->nK; k++ ){
             DoIt = FALSE;
 //printf("f->EofMu[m][k] %g, f->E[0] %g \n", f->EofMu[m][k], f->E[0]);
             if ( f->Extrapolate > 2 ){ // extrapolate above and below
@@ -728,15 +852,6 @@ assumes electrons -- generalize this...
         }
     }
 
-    if ( f->DumpDiagnostics ) {
-        DumpGif( "Lgm_FluxToPsd_PSD_MK", f->nK, f->nMu, f->PSD_MK );
-    }
-
-
-    f->Alloced2 = TRUE;
-
-    return;
-
 }
 
 double  Model( double *x, int n, double E ) {
@@ -0,0 +1,529 @@
+/*! \file Lgm_GCTrace.c
+ *
+ *  \brief Guiding center tracing of batches of test particles.
+ *
+ *  Each particle is advanced with Lgm_VelStep() (a Bulirsch-Stoer scheme)
+ *  using Lgm_GuidingCenterVel() for its velocity. Steps are adaptive and are
+ *  kept separately for each particle (Lgm_GCParticle.H), so a batch can mix
+ *  particles with very different drift and bounce time scales. The batch is
+ *  spread over threads, each with its own copy of the Lgm_MagModelInfo and
+ *  its own Lgm_VelStepInfo (the stepper state is only needed for the
+ *  duration of a particle's step sequence, so it is not stored per particle).
+ *
+ *  The parallel motion is reversed at the mirror points. A step that would
+ *  carry a particle past its mirror point (B/Bm > 1+MirrorTol) is retaken with
+ *  half the step size until either |1-B/Bm| < MirrorTol, or the step is down
+ *  to Hmin. The motion is only reversed while the particle is still heading
+ *  into stronger field, and if it reached B >= Bm the mirror point is moved
+ *  just beyond it; otherwise a particle could sit at its mirror point
+ *  (reversing every step, or with no parallel speed) forever. Particles that start with a 90 degree pitch angle are given no
+ *  parallel motion at all (VparSgn = 0) and just drift; sqrt(1-B/Bm) has no
+ *  derivative at B = Bm, which would otherwise force tiny steps on them.
+ *
+ *  Typical usage;
+ *
+ *      Lgm_GCTrace_Defaults( &g );
+ *      p = (Lgm_GCParticle *)calloc( n, sizeof(Lgm_GCParticle) );
+ *      for ( i=0; i<n; i++ ) Lgm_GCTrace_InitParticle( &p[i], i, &u[i], T[i], Alpha[i], -LGM_e, LGM_Ee0, mInfo );
+ *      fp = fopen( "Particles.dat", "w" );
+ *      Lgm_GCTrace_Run( p, n, 0.0, 3600.0, 60.0, fp, "Particles.chk", 10, &g, mInfo );
+ *
+ *  and to restart from the checkpoint;
+ *
+ *      p = Lgm_GCTrace_ReadCheckpoint( "Particles.chk", &n, &t0 );
+ *      Lgm_GCTrace_Run( p, n, t0, 3600.0, 60.0, fp, "Particles.chk", 10, &g, mInfo );
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#if USE_OPENMP
+#include <omp.h>
+#endif
+#include "Lgm/Lgm_GCTrace.h"
+
+
+/*
+ *  What the velocity function needs (hung off of Lgm_VelStepInfo.data).
+ *  After each step the particle's velocity (and B) is evaluated at its new
+ *  position to check for the mirror point; it is kept here so that the
+ *  first evaluation of the next step (at the same point) can reuse it.
+ */
+typedef struct Lgm_GCTraceVelData {
+    Lgm_MagModelInfo    *m;
+    double              VparSgn;
+    int                 Cached;
+    Lgm_Vector          u;
+    Lgm_Vector          Vel;
+    long int            nReused;    // evaluations served from the above (Lgm_VelStep() counts them too)
+} Lgm_GCTraceVelData;
+
+static int Lgm_GCTrace_Vel( Lgm_Vector *u, Lgm_Vector *Vel, Lgm_VelStepInfo *Info ) {
+    Lgm_GCTraceVelData  *d = (Lgm_GCTraceVelData *)Info->data;
+    if ( d->Cached && ( u->x == d->u.x ) && ( u->y == d->u.y ) && ( u->z == d->u.z ) ) {
+        *Vel = d->Vel;
+        ++(d->nReused);
+        return( 1 );
+    }
+    return( Lgm_GuidingCenterVel( u, Vel, d->VparSgn, (double *)NULL, d->m ) );
+}
+
+
+
+/**
+ *  \brief
+ *      Set the default tracing parameters.
+ *
+ *      \param[out]     g       Lgm_GCTraceInfo structure to set.
+ *
+ */
+void Lgm_GCTrace_Defaults( Lgm_GCTraceInfo *g ) {
+
+    g->Tol            = 1e-6;
+    g->Hmin           = 1e-5;
+    g->Hmax           = 60.0;
+    g->MirrorTol      = 1e-6;
+    g->Rmin           = 1.0 + 100.0/Re;
+    g->Rmax           = 15.0;
+    g->DerivScheme    = LGM_DERIV_SIX_POINT;
+    g->h              = 1e-3;
+    g->VerbosityLevel = 0;
+    g->nVelEvals      = 0;
+
+}
+
+
+
+/**
+ *  \brief
+ *      Set up a particle from its position, energy and local pitch angle.
+ *
+ *      \param[out]     p       Particle to set up.
+ *      \param[in]      Id      Id to give the particle.
+ *      \param[in]      u       Guiding center position (GSM). [Re]
+ *      \param[in]      T       Kinetic energy. [MeV]
+ *      \param[in]      Alpha   Local pitch angle at u. Values above 90 start the particle moving against B. [Deg]
+ *      \param[in]      q       Charge. [C]
+ *      \param[in]      E0      Rest energy. [MeV]
+ *      \param[in]      m       A properly initialized and configured Lgm_MagModelInfo structure.
+ *
+ *      \return         1 on success, 0 if the pitch angle or field is unusable.
+ *
+ */
+int Lgm_GCTrace_InitParticle( Lgm_GCParticle *p, long int Id, Lgm_Vector *u, double T, double Alpha, double q, double E0, Lgm_MagModelInfo *m ) {
+
+    double      B, SinA;
+    Lgm_Vector  Bvec;
+
+    memset( p, 0, sizeof(Lgm_GCParticle) );
+    p->Id = Id;
+    p->u  = *u;
+    p->T  = T;
+    p->E0 = E0;
+    p->q  = q;
+    p->H  = 1.0;
+    if ( fabs( Alpha - 90.0 ) < 1e-10 ) {
+        p->VparSgn = 0;     // equatorially mirroring, so no parallel motion at all
+    } else {
+        p->VparSgn = ( Alpha > 90.0 ) ? -1 : 1;
+    }
+
+    m->Bfield( u, &Bvec, m );
+    B    = Lgm_Magnitude( &Bvec );
+    SinA = sin( Alpha*RadPerDeg );
+    if ( ( B <= 0.0 ) || ( fabs( SinA ) < 1e-10 ) ) {
+        printf("Lgm_GCTrace_InitParticle: Particle %ld has no usable mirror point (B = %g, Alpha = %g)\n", Id, B, Alpha );
+        p->Status = LGM_GC_FAILED;
+        return( 0 );
+    }
+    p->Bm = B/(SinA*SinA);
+    p->Mu = T*(T+2.0*E0)/(2.0*E0*p->Bm);
+    p->Status = LGM_GC_ACTIVE;
+
+    return( 1 );
+
+}
+
+
+
+/*
+ *  Advance a single particle to time t1. Returns the number of velocity
+ *  evaluations used.
+ */
+static long int Lgm_GCTrace_AdvanceParticle( Lgm_GCParticle *p, double t1, Lgm_GCTraceInfo *g, Lgm_VelStepInfo *vInfo, Lgm_MagModelInfo *m ) {
+
+    int                 reset;
+    long int            nEvals, n0;
+    double              Htry, Hdid, Hnext, s, r, B, Bprev, BoverBm;
+    Lgm_Vector          u_old, u_scale;
+    Lgm_GCTraceVelData  d;
+
+    if ( p->Status != LGM_GC_ACTIVE ) return( 0 );
+
+    m->Lgm_VelStep_q           = p->q;
+    m->Lgm_VelStep_T           = p->T;
+    m->Lgm_VelStep_E0          = p->E0;
+    m->Lgm_VelStep_Bm          = p->Bm;
+    m->Lgm_VelStep_h           = g->h;
+    m->Lgm_VelStep_DerivScheme = g->DerivScheme;
+
+    d.m         = m;
+    d.VparSgn   = (double)p->VparSgn;
+    d.Cached    = FALSE;
+    d.nReused   = 0;
+    vInfo->data = (void *)&d;
+
+    u_scale.x = u_scale.y = u_scale.z = 1.0;
+    s      = 0.0;
+    reset  = TRUE;
+    nEvals = 1;
+
+    /*
+     *  B at the start (the velocity is what the first step needs anyway).
+     */
+    if ( Lgm_GuidingCenterVel( &p->u, &d.Vel, d.VparSgn, &B, m ) == 0 ) {
+        if ( g->VerbosityLevel > 0 ) printf("Lgm_GCTrace_AdvanceParticle: Particle %ld failed at t = %g (u = %g %g %g)\n", p->Id, p->t, p->u.x, p->u.y, p->u.z );
+        p->Status = LGM_GC_FAILED;
+        return( nEvals );
+    }
+    d.u      = p->u;
+    d.Cached = TRUE;
+
+    while ( t1 - p->t > 1e-9 ) {
+
+        Htry = p->H;
+        if ( Htry > g->Hmax )   Htry = g->Hmax;
+        if ( Htry > t1 - p->t ) Htry = t1 - p->t;
+        if ( Htry < g->Hmin )   Htry = ( t1 - p->t < g->Hmin ) ? t1 - p->t : g->Hmin;
+
+        u_old = p->u;
+        Bprev = B;
+        n0 = ( reset ) ? 0 : vInfo->Lgm_nVelEvals;
+        if ( Lgm_VelStep( &p->u, &u_scale, Htry, &Hdid, &Hnext, g->Tol, 1.0, &s, &reset, Lgm_GCTrace_Vel, vInfo ) < 0 ) {
+            if ( g->VerbosityLevel > 0 ) printf("Lgm_GCTrace_AdvanceParticle: Particle %ld failed at t = %g (u = %g %g %g)\n", p->Id, p->t, u_old.x, u_old.y, u_old.z );
+            p->u      = u_old;
+            p->Status = LGM_GC_FAILED;
+            break;
+        }
+        nEvals += vInfo->Lgm_nVelEvals - n0;
+        reset = FALSE;
+
+        r = Lgm_Magnitude( &p->u );
+        if ( ( r < g->Rmin ) || ( r > g->Rmax ) ) {
+            p->t += Hdid;
+            ++(p->nSteps);
+            p->Status = ( r < g->Rmin ) ? LGM_GC_PRECIPITATED : LGM_GC_ESCAPED;
+            break;
+        }
+
+        /*
+         *  The velocity at the new point gives us B there for the mirror
+         *  check, and is the first evaluation the next step needs.
+         */
+        if ( Lgm_GuidingCenterVel( &p->u, &d.Vel, d.VparSgn, &B, m ) == 0 ) {
+            if ( g->VerbosityLevel > 0 ) printf("Lgm_GCTrace_AdvanceParticle: Particle %ld failed at t = %g (u = %g %g %g)\n", p->Id, p->t, p->u.x, p->u.y, p->u.z );
+            p->u      = u_old;
+            p->Status = LGM_GC_FAILED;
+            break;
+        }
+        ++nEvals;
+        d.u      = p->u;
+        d.Cached = TRUE;
+        BoverBm  = B/p->Bm;
+
+        if ( ( p->VparSgn != 0 ) && ( BoverBm > 1.0 + g->MirrorTol ) && ( Hdid > g->Hmin ) ) {
+
+            /*
+             *  Went past the mirror point. Retake the step with a smaller
+             *  step size.
+             */
+            p->u  = u_old;
+            B     = Bprev;
+            p->H  = 0.5*Hdid;
+            reset = TRUE;
+            continue;
+
+        }
+
+        p->t += Hdid;
+        ++(p->nSteps);
+        if ( Hnext > 0.0 ) p->H = Hnext;
+
+        if ( ( p->VparSgn != 0 ) && ( BoverBm > 1.0 - g->MirrorTol ) && ( B > Bprev ) ) {
+
+            /*
+             *  At the mirror point (and still heading into stronger field,
+             *  so a particle that has just turned around is left alone).
+             *  Reverse the parallel motion. If we reached or overshot it (by
+             *  less than MirrorTol or Hmin worth of motion), move the mirror
+             *  point out to just beyond here, otherwise the particle would
+             *  have no parallel velocity to get back with. T is fixed, so
+             *  Mu = p^2/(2 m0 Bm) moves with Bm.
+             */
+            if ( BoverBm >= 1.0 ) {
+                p->Bm *= BoverBm*( 1.0 + g->MirrorTol );
+                p->Mu  = p->T*(p->T+2.0*p->E0)/(2.0*p->E0*p->Bm);
+                m->Lgm_VelStep_Bm = p->Bm;
+            }
+            p->VparSgn = -p->VparSgn;
+            d.VparSgn  = (double)p->VparSgn;
+            d.Cached   = FALSE;     // the velocity depends on both
+            reset = TRUE;
+
+        }
+
+    }
+
+    return( nEvals - d.nReused );
+
+}
+
+
+
+/**
+ *  \brief
+ *      Advance a batch of particles to a given time.
+ *
+ *  \details
+ *      Each active particle is traced from its own time (Lgm_GCParticle.t) to
+ *      t1, or until it is lost. The particles are spread over threads when
+ *      compiled with OpenMP.
+ *
+ *      \param[in,out]  p       Array of particles.
+ *      \param[in]      n       Number of particles.
+ *      \param[in]      t1      Time to advance the particles to. [s]
+ *      \param[in,out]  g       Tracing parameters. nVelEvals is set on return.
+ *      \param[in]      m       A properly initialized and configured Lgm_MagModelInfo structure.
+ *
+ *      \return         The number of particles still active.
+ *
+ */
+long int Lgm_GCTrace_Advance( Lgm_GCParticle *p, long int n, double t1, Lgm_GCTraceInfo *g, Lgm_MagModelInfo *m ) {
+
+    long int            i, nActive, nEvals;
+    Lgm_MagModelInfo    *mInfo2;
+    Lgm_VelStepInfo     *vInfo;
+
+    nEvals = 0;
+    #if USE_OPENMP
+    #pragma omp parallel private(mInfo2,vInfo,i)
+    #endif
+    {
+        mInfo2 = Lgm_CopyMagInfo( m );
+        vInfo  = Lgm_InitVelInfo( );
+        vInfo->VerbosityLevel = g->VerbosityLevel;
+        #if USE_OPENMP
+        #pragma omp for schedule(dynamic,16) reduction(+:nEvals)
+        #endif
+        for ( i=0; i<n; i++ ) {
+            nEvals += Lgm_GCTrace_AdvanceParticle( &p[i], t1, g, vInfo, mInfo2 );
+        }
+        Lgm_FreeVelInfo( vInfo );
+        Lgm_FreeMagInfo( mInfo2 );
+    }
+    g->nVelEvals = nEvals;
+
+    for ( nActive=0, i=0; i<n; i++ ) if ( p[i].Status == LGM_GC_ACTIVE ) ++nActive;
+
+    return( nActive );
+
+}
+
+
+
+/**
+ *  \brief
+ *      Trace a batch of particles over an interval, with streaming output and checkpoints.
+ *
+ *  \details
+ *      The particles are advanced from t0 to t1 in increments of dt. After
+ *      each increment a frame is appended to fp (if it is not NULL), and
+ *      after every CheckpointEvery increments (and at t1) the particles are
+ *      written to CheckpointFile (if it is not NULL). To restart, read the
+ *      checkpoint back with Lgm_GCTrace_ReadCheckpoint() and call this again
+ *      with t0 set to the time it returns.
+ *
+ *      \param[in,out]  p               Array of particles.
+ *      \param[in]      n               Number of particles.
+ *      \param[in]      t0              Start time. [s]
+ *      \param[in]      t1              End time. [s]
+ *      \param[in]      dt              Output cadence. [s]
+ *      \param[in]      fp              Stream to append frames to (or NULL).
+ *      \param[in]      CheckpointFile  Name of the checkpoint file (or NULL).
+ *      \param[in]      CheckpointEvery Number of increments between checkpoints.
+ *      \param[in,out]  g               Tracing parameters.
+ *      \param[in]      m               A properly initialized and configured Lgm_MagModelInfo structure.
+ *
+ *      \return         The number of particles still active, or -1 if output could not be written.
+ *
+ */
+long int Lgm_GCTrace_Run( Lgm_GCParticle *p, long int n, double t0, double t1, double dt, FILE *fp, char *CheckpointFile,
+                          int CheckpointEvery, Lgm_GCTraceInfo *g, Lgm_MagModelInfo *m ) {
+
+    long int    k, nActive, nEvals;
+    double      t;
+    int         Last;
+
+    if ( dt <= 0.0 ) dt = t1 - t0;
+    if ( CheckpointEvery < 1 ) CheckpointEvery = 1;
+
+    nActive = n;
+    nEvals  = 0;
+    for ( Last=FALSE, k=1; !Last; k++ ) {
+
+        t = t0 + (double)k*dt;
+        if ( t >= t1 - 1e-9 ) { t = t1; Last = TRUE; }
+
+        nActive = Lgm_GCTrace_Advance( p, n, t, g, m );
+        nEvals += g->nVelEvals;
+        if ( g->VerbosityLevel > 0 ) printf("Lgm_GCTrace_Run: t = %g s, %ld of %ld particles active, %ld velocity evaluations\n", t, nActive, n, g->nVelEvals );
+
+        if ( ( fp != NULL ) && ( Lgm_GCTrace_WriteFrame( fp, p, n, t ) != 0 ) ) return( -1 );
+        if ( ( CheckpointFile != NULL ) && ( ( k%CheckpointEvery == 0 ) || Last ) ) {
+            if ( Lgm_GCTrace_WriteCheckpoint( CheckpointFile, p, n, t ) != 0 ) return( -1 );
+        }
+
+        if ( nActive == 0 ) break;
+
+    }
+    g->nVelEvals = nEvals;
+
+    return( nActive );
+
+}
+
+
+
+/**
+ *  \brief
+ *      Write a frame (the particles at a given time) to a stream.
+ *
+ *      \return         0 on success, -1 on failure.
+ *
+ */
+int Lgm_GCTrace_WriteFrame( FILE *fp, Lgm_GCParticle *p, long int n, double t ) {
+
+    Lgm_GCFrameHeader   h;
+
+    memset( &h, 0, sizeof(h) );
+    memcpy( h.Magic, LGM_GC_FRAME_MAGIC, 8 );
+    h.Version    = LGM_GC_FRAME_VERSION;
+    h.ByteOrder  = LGM_GC_FRAME_BYTEORDER;
+    h.RecordSize = (int)sizeof(Lgm_GCParticle);
+    h.n          = n;
+    h.t          = t;
+
+    if ( ( fwrite( &h, sizeof(h), 1, fp ) != 1 ) || ( (long int)fwrite( p, sizeof(Lgm_GCParticle), n, fp ) != n ) ) {
+        printf("Lgm_GCTrace_WriteFrame: Error writing frame (t = %g, n = %ld)\n", t, n );
+        return( -1 );
+    }
+    fflush( fp );
+
+    return( 0 );
+
+}
+
+
+
+/**
+ *  \brief
+ *      Read the next frame from a stream.
+ *
+ *      \param[in]      fp      Stream positioned at the start of a frame.
+ *      \param[out]     n       Number of particles read.
+ *      \param[out]     t       Time of the frame. [s]
+ *
+ *      \return         Newly allocated array of particles (free with free()), or NULL at end of file or on error.
+ *
+ */
+Lgm_GCParticle *Lgm_GCTrace_ReadFrame( FILE *fp, long int *n, double *t ) {
+
+    Lgm_GCFrameHeader   h;
+    Lgm_GCParticle      *p;
+
+    *n = 0;
+    if ( fread( &h, sizeof(h), 1, fp ) != 1 ) return( NULL );
+
+    if ( ( strncmp( h.Magic, LGM_GC_FRAME_MAGIC, 8 ) != 0 ) || ( h.Version != LGM_GC_FRAME_VERSION )
+            || ( h.ByteOrder != LGM_GC_FRAME_BYTEORDER ) || ( h.RecordSize != (int)sizeof(Lgm_GCParticle) ) || ( h.n < 0 ) ) {
+        printf("Lgm_GCTrace_ReadFrame: Not a frame written by this version/platform\n" );
+        return( NULL );
+    }
+
+    p = (Lgm_GCParticle *)calloc( h.n > 0 ? h.n : 1, sizeof(Lgm_GCParticle) );
+    if ( (long int)fread( p, sizeof(Lgm_GCParticle), h.n, fp ) != h.n ) {
+        printf("Lgm_GCTrace_ReadFrame: Frame is truncated (expected %ld particles)\n", h.n );
+        free( p );
+        return( NULL );
+    }
+    *n = h.n;
+    *t = h.t;
+
+    return( p );
+
+}
+
+
+
+/**
+ *  \brief
+ *      Write a checkpoint file.
+ *
+ *  \details
+ *      The frame is written to Filename.tmp and then renamed, so an existing
+ *      checkpoint is never left half written.
+ *
+ *      \return         0 on success, -1 on failure.
+ *
+ */
+int Lgm_GCTrace_WriteCheckpoint( char *Filename, Lgm_GCParticle *p, long int n, double t ) {
+
+    char    *TmpFile;
+    FILE    *fp;
+    int     Err;
+
+    TmpFile = (char *)calloc( strlen( Filename ) + 5, sizeof(char) );
+    sprintf( TmpFile, "%s.tmp", Filename );
+
+    if ( ( fp = fopen( TmpFile, "wb" ) ) == NULL ) {
+        printf("Lgm_GCTrace_WriteCheckpoint: Could not open %s for writing\n", TmpFile );
+        free( TmpFile );
+        return( -1 );
+    }
+    Err = Lgm_GCTrace_WriteFrame( fp, p, n, t );
+    if ( fclose( fp ) != 0 ) Err = -1;
+    if ( ( Err == 0 ) && ( rename( TmpFile, Filename ) != 0 ) ) {
+        printf("Lgm_GCTrace_WriteCheckpoint: Could not rename %s to %s\n", TmpFile, Filename );
+        Err = -1;
+    }
+    free( TmpFile );
+
+    return( Err );
+
+}
+
+
+
+/**
+ *  \brief
+ *      Read a checkpoint file written by Lgm_GCTrace_WriteCheckpoint().
+ *
+ *      \return         Newly allocated array of particles (free with free()), or NULL on failure.
+ *
+ */
+Lgm_GCParticle *Lgm_GCTrace_ReadCheckpoint( char *Filename, long int *n, double *t ) {
+
+    FILE            *fp;
+    Lgm_GCParticle  *p;
+
+    if ( ( fp = fopen( Filename, "rb" ) ) == NULL ) {
+        printf("Lgm_GCTrace_ReadCheckpoint: Could not open %s\n", Filename );
+        *n = 0;
+        return( NULL );
+    }
+    p = Lgm_GCTrace_ReadFrame( fp, n, t );
+    fclose( fp );
+
+    return( p );
+
+}
@@ -3,90 +3,277 @@
 #include "Lgm/Lgm_MagModelInfo.h"
 
 
+/*
+ *  First derivative from samples f[0..2N] at spacing h centered on f[N].
+ *      f_0^(1) = 1/(60h)  ( f_3 - 9f_2 + 45f_1  - 45f_-1 + 9f_-2 - f_-3 )
+ * See page 450 of CRC standard Math tables 28th edition.
+ */
+static double Lgm_Deriv1( double *f, int N, double h ) {
+    switch ( N ) {
+        case 3:  return( (f[6] - 9.0*f[5] + 45.0*f[4] - 45.0*f[2] + 9.0*f[1] - f[0])/(60.0*h) );
+        case 2:  return( (-f[4] + 8.0*f[3] - 8.0*f[1] + f[0])/(12.0*h) );
+        default: return( (f[2] - f[0])/(2.0*h) );
+    }
+}
+
+
+/*
+ *  J = A^T Jm A, i.e. the Jacobian in GSM given the Jacobian Jm in a frame
+ *  where x_frame = A x_gsm.
+ */
+static void Lgm_RotateJacobian( double A[3][3], double Jm[3][3], double J[3][3] ) {
+
+    double  T[3][3];
+    int     i, j, k;
+
+    for ( i=0; i<3; i++ ) {
+        for ( j=0; j<3; j++ ) {
+            T[i][j] = 0.0;
+            for ( k=0; k<3; k++ ) T[i][j] += Jm[i][k]*A[k][j];
+        }
+    }
+    for ( i=0; i<3; i++ ) {
+        for ( j=0; j<3; j++ ) {
+            J[i][j] = 0.0;
+            for ( k=0; k<3; k++ ) J[i][j] += A[k][i]*T[k][j];
+        }
+    }
+
+}
+
+
+/*
+ *  Centered (Offset == NULL) or eccentric dipole field and its Jacobian. In
+ *  SM coords (relative to the dipole center),
+ *
+ *      B_i       = -M ( 3 z x_i/r^5 - delta_iz/r^3 )
+ *      dB_i/dx_j = -M ( 3( delta_jz x_i + z delta_ij + delta_iz x_j )/r^5 - 15 z x_i x_j/r^7 )
+ */
+static void Lgm_DipoleJacobian( Lgm_Vector *u0, int Eccentric, Lgm_Vector *B, double J[3][3], Lgm_CTrans *c ) {
+
+    double      A[3][3], Jsm[3][3], x[3], Bsm[3], Bg[3], M, r2, ir3, ir5, ir7;
+    int         i, j;
+    Lgm_Vector  ED_geo, ED_sm;
+
+    M = c->M_cd;
+    A[0][0] = c->cos_psi; A[0][1] = 0.0; A[0][2] = -c->sin_psi;
+    A[1][0] = 0.0;        A[1][1] = 1.0; A[1][2] = 0.0;
+    A[2][0] = c->sin_psi; A[2][1] = 0.0; A[2][2] = c->cos_psi;
+
+    x[0] = A[0][0]*u0->x + A[0][2]*u0->z;
+    x[1] = u0->y;
+    x[2] = A[2][0]*u0->x + A[2][2]*u0->z;
+    if ( Eccentric ) {
+        ED_geo.x = c->ED_x0; ED_geo.y = c->ED_y0; ED_geo.z = c->ED_z0;
+        Lgm_Convert_Coords( &ED_geo, &ED_sm, WGS84_TO_SM, c );
+        x[0] -= ED_sm.x; x[1] -= ED_sm.y; x[2] -= ED_sm.z;
+    }
+
+    r2  = x[0]*x[0] + x[1]*x[1] + x[2]*x[2];
+    ir3 = 1.0/(r2*sqrt(r2));
+    ir5 = ir3/r2;
+    ir7 = ir5/r2;
+
+    for ( i=0; i<3; i++ ) {
+        Bsm[i] = -M*( 3.0*x[2]*x[i]*ir5 - ((i==2) ? ir3 : 0.0) );
+        for ( j=0; j<3; j++ ) {
+            Jsm[i][j] = -M*( 3.0*( ((j==2) ? x[i] : 0.0) + ((i==j) ? x[2] : 0.0) + ((i==2) ? x[j] : 0.0) )*ir5
+                                - 15.0*x[2]*x[i]*x[j]*ir7 );
+        }
+    }
+
+    for ( i=0; i<3; i++ ) {
+        Bg[i] = 0.0;
+        for ( j=0; j<3; j++ ) Bg[i] += A[j][i]*Bsm[j];
+    }
+    B->x = Bg[0]; B->y = Bg[1]; B->z = Bg[2];
+    Lgm_RotateJacobian( A, Jsm, J );
+
+}
+
+
+/*
+ *  Analytic B and Jacobian of the internal field model. Returns FALSE if the
+ *  model doesn't have one (e.g. a user-supplied coefficient set is attached).
+ */
+static int Lgm_InternalJacobian( Lgm_Vector *u0, int InternalModel, Lgm_Vector *B, double J[3][3], Lgm_CTrans *c ) {
+
+    double      Jgeo[3][3], A[3][3];
+    int         i, j;
+    Lgm_Vector  w, Bgeo;
+
+    switch ( InternalModel ) {
+        case LGM_CDIP:
+            Lgm_DipoleJacobian( u0, FALSE, B, J, c );
+            return( TRUE );
+        case LGM_EDIP:
+            Lgm_DipoleJacobian( u0, TRUE, B, J, c );
+            return( TRUE );
+        case LGM_IGRF:
+            if ( c->SHCoeffs != NULL ) return( FALSE );
+            Lgm_MatTimesVec( c->Agsm_to_wgs84, u0, &w );
+            Lgm_IGRF_Cart_Jacobian( &w, &Bgeo, Jgeo, c );
+            Lgm_MatTimesVec( c->Awgs84_to_gsm, &Bgeo, B );
+            // (Lgm_MatTimesVec() matrices are stored transposed)
+            for ( i=0; i<3; i++ ) for ( j=0; j<3; j++ ) A[i][j] = c->Agsm_to_wgs84[j][i];
+            Lgm_RotateJacobian( A, Jgeo, J );
+            return( TRUE );
+        default:
+            return( FALSE );
+    }
+
+}
+
+
 /**
  *  \brief
- *      Compute the gradient of B at a given point.
+ *      Compute B and its Jacobian (the full tensor of first derivatives) at a given point.
  *
  *  \details
- *      Computes \f$ \nabla B \f$.
+ *      Computes \f$ J_{ij} = \partial B_i/\partial x_j \f$. Everything else
+ *      in this file (grad B, curl B, div B, drift velocities) is built from
+ *      it, so callers that need several of these at the same point should
+ *      call this once and use the results.
+ *
+ *      If m->Bfield is one of the internal models (Lgm_B_cdip, Lgm_B_edip,
+ *      Lgm_B_igrf) or one of the RBF interpolated fields that also give
+ *      their derivatives (Lgm_B_FromScatteredData2/3), the Jacobian is
+ *      computed analytically and DerivScheme and h are ignored. Otherwise
+ *      all nine derivatives come from one pass over the finite difference
+ *      stencil (6N evaluations of m->Bfield for an N-point-per-side scheme,
+ *      plus one for B itself).
  *
  *
  *      \param[in]      u0          Position (in GSM) to use.
- *      \param[out]     GradB       The computed gradient of B at position u0.
+ *      \param[out]     B           B at position u0 (may be NULL).
+ *      \param[out]     J           J[i][j] = dB_i/dx_j at position u0 [nT/Re].
  *      \param[in]      DerivScheme Derivative scheme to use (can be one of LGM_DERIV_SIX_POINT, LGM_DERIV_FOUR_POINT, or LGM_DERIV_TWO_POINT).
  *      \param[in]      h           The delta (in Re) to use for grid spacing in the derivative scheme.
  *      \param[in,out]  m           A properly initialized and configured Lgm_MagModelInfo structure.
  *
- *
- *      \author         Mike Henderson
- *      \date           2011
- *
  */
-void Lgm_GradB( Lgm_Vector *u0, Lgm_Vector *GradB, int DerivScheme, double h, Lgm_MagModelInfo *m ) {
+void Lgm_B_Jacobian( Lgm_Vector *u0, Lgm_Vector *B, double J[3][3], int DerivScheme, double h, Lgm_MagModelInfo *m ) {
 
-    double      B, H, fx[7], fy[7], fz[7];
-    int         i, N;
-    Lgm_Vector  u, Bvec;
+    double      fx[7], fy[7], fz[7], Jint[3][3];
+    int         i, j, N;
+    Lgm_Vector  u, Bvec, Bstencil[3][7], Bint;
 
 
+    /*
+     *  Analytic derivatives.
+     */
+    if ( ( m->Bfield == Lgm_B_cdip ) || ( m->Bfield == Lgm_B_edip ) || ( m->Bfield == Lgm_B_igrf ) ) {
+        i = ( m->Bfield == Lgm_B_cdip ) ? LGM_CDIP : ( ( m->Bfield == Lgm_B_edip ) ? LGM_EDIP : LGM_IGRF );
+        if ( Lgm_InternalJacobian( u0, i, &Bvec, J, m->c ) ) {
+            if ( B != NULL ) *B = Bvec;
+            return;
+        }
+    } else if ( ( m->Bfield == Lgm_B_FromScatteredData2 ) || ( m->Bfield == Lgm_B_FromScatteredData3 ) ) {
+        // These leave the derivatives of the RBF part in m->RBF_dBdx etc.
+        m->Bfield( u0, &Bvec, m );
+        if ( Lgm_InternalJacobian( u0, m->InternalModel, &Bint, Jint, m->c ) ) {
+            for ( i=0; i<3; i++ ) {
+                J[i][0] = Jint[i][0] + ((i==0) ? m->RBF_dBdx.x : ((i==1) ? m->RBF_dBdx.y : m->RBF_dBdx.z));
+                J[i][1] = Jint[i][1] + ((i==0) ? m->RBF_dBdy.x : ((i==1) ? m->RBF_dBdy.y : m->RBF_dBdy.z));
+                J[i][2] = Jint[i][2] + ((i==0) ? m->RBF_dBdz.x : ((i==1) ? m->RBF_dBdz.y : m->RBF_dBdz.z));
+            }
+            if ( B != NULL ) *B = Bvec;
+            return;
+        }
+    }
+
 
     /*
      * Select the derivative scheme to use.
-     *      f_0^(1) = 1/(60h)  ( f_3 - 9f_2 + 45f_1  - 45f_-1 + 9f_-2 - f_-3 )
-     * See page 450 of CRC standard Math tables 28th edition.
      */
     switch ( DerivScheme ) {
-        case LGM_DERIV_SIX_POINT:
-            N = 3;
-            break;
         case LGM_DERIV_FOUR_POINT:
             N = 2;
             break;
         case LGM_DERIV_TWO_POINT:
             N = 1;
             break;
+        case LGM_DERIV_SIX_POINT:
+        default:
+            N = 3;
+            break;
     }
 
-    if (m->VerbosityLevel > 0) printf("\t\tLgm_GradB: Computing GradB with DerivScheme = %d,  h = %g", DerivScheme, h);
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.x += H;
-            m->Bfield( &u, &Bvec, m );
-            B = Lgm_Magnitude( &Bvec );
-            fx[i+N] = B;
-        }
-    }
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.y += H;
-            m->Bfield( &u, &Bvec, m );
-            B = Lgm_Magnitude( &Bvec );
-            fy[i+N] = B;
+    /*
+     *  One pass over the stencil gives all three components along each axis.
+     */
+    for ( j=0; j<3; ++j ) {
+        for ( i=-N; i<=N; ++i ) {
+            if ( i == 0 ) continue;
+            u = *u0;
+            if ( j == 0 )      u.x += (double)i*h;
+            else if ( j == 1 ) u.y += (double)i*h;
+            else               u.z += (double)i*h;
+            m->Bfield( &u, &Bstencil[j][i+N], m );
         }
     }
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.z += H;
-            m->Bfield( &u, &Bvec, m );
-            B = Lgm_Magnitude( &Bvec );
-            fz[i+N] = B;
+    for ( j=0; j<3; ++j ) {
+        for ( i=0; i<=2*N; ++i ) {
+            if ( i == N ) continue;
+            fx[i] = Bstencil[j][i].x; fy[i] = Bstencil[j][i].y; fz[i] = Bstencil[j][i].z;
         }
+        J[0][j] = Lgm_Deriv1( fx, N, h );
+        J[1][j] = Lgm_Deriv1( fy, N, h );
+        J[2][j] = Lgm_Deriv1( fz, N, h );
     }
 
+    if ( B != NULL ) m->Bfield( u0, B, m );
 
-    if (DerivScheme == LGM_DERIV_SIX_POINT){
-        GradB->x = (fx[6] - 9.0*fx[5] + 45.0*fx[4] - 45.0*fx[2] + 9.0*fx[1] - fx[0])/(60.0*h);
-        GradB->y = (fy[6] - 9.0*fy[5] + 45.0*fy[4] - 45.0*fy[2] + 9.0*fy[1] - fy[0])/(60.0*h);
-        GradB->z = (fz[6] - 9.0*fz[5] + 45.0*fz[4] - 45.0*fz[2] + 9.0*fz[1] - fz[0])/(60.0*h);
-    } else if (DerivScheme == LGM_DERIV_FOUR_POINT){
-        GradB->x = (-fx[4] + 8.0*fx[3] - 8.0*fx[1] + fx[0])/(12.0*h);
-        GradB->y = (-fy[4] + 8.0*fy[3] - 8.0*fy[1] + fy[0])/(12.0*h);
-        GradB->z = (-fz[4] + 8.0*fz[3] - 8.0*fz[1] + fz[0])/(12.0*h);
-    } else if (DerivScheme == LGM_DERIV_TWO_POINT){
-        GradB->x = (fx[2] - fx[0])/(2.0*h);
-        GradB->y = (fy[2] - fy[0])/(2.0*h);
-        GradB->z = (fz[2] - fz[0])/(2.0*h);
-    }
+    return;
+
+}
+
+
+/*
+ *  grad|B| = (b . dB/dx_j)
+ */
+static void Lgm_GradBFromJacobian( Lgm_Vector *Bvec, double J[3][3], Lgm_Vector *GradB ) {
+    double  B = Lgm_Magnitude( Bvec );
+    double  bx = Bvec->x/B, by = Bvec->y/B, bz = Bvec->z/B;
+    GradB->x = bx*J[0][0] + by*J[1][0] + bz*J[2][0];
+    GradB->y = bx*J[0][1] + by*J[1][1] + bz*J[2][1];
+    GradB->z = bx*J[0][2] + by*J[1][2] + bz*J[2][2];
+}
+
+static void Lgm_CurlBFromJacobian( double J[3][3], Lgm_Vector *CurlB ) {
+    CurlB->x = J[2][1] - J[1][2];
+    CurlB->y = J[0][2] - J[2][0];
+    CurlB->z = J[1][0] - J[0][1];
+}
+
+
+/**
+ *  \brief
+ *      Compute the gradient of B at a given point.
+ *
+ *  \details
+ *      Computes \f$ \nabla B \f$.
+ *
+ *
+ *      \param[in]      u0          Position (in GSM) to use.
+ *      \param[out]     GradB       The computed gradient of B at position u0.
+ *      \param[in]      DerivScheme Derivative scheme to use (can be one of LGM_DERIV_SIX_POINT, LGM_DERIV_FOUR_POINT, or LGM_DERIV_TWO_POINT).
+ *      \param[in]      h           The delta (in Re) to use for grid spacing in the derivative scheme.
+ *      \param[in,out]  m           A properly initialized and configured Lgm_MagModelInfo structure.
+ *
+ *
+ *      \author         Mike Henderson
+ *      \date           2011
+ *
+ */
+void Lgm_GradB( Lgm_Vector *u0, Lgm_Vector *GradB, int DerivScheme, double h, Lgm_MagModelInfo *m ) {
+
+    double      J[3][3];
+    Lgm_Vector  Bvec;
+
+    if (m->VerbosityLevel > 0) printf("\t\tLgm_GradB: Computing GradB with DerivScheme = %d,  h = %g", DerivScheme, h);
+    Lgm_B_Jacobian( u0, &Bvec, J, DerivScheme, h, m );
+    Lgm_GradBFromJacobian( &Bvec, J, GradB );
     if (m->VerbosityLevel > 0) printf("   GradB = (%g %g %g)\n", GradB->x, GradB->y, GradB->z );
 
     return;
@@ -117,14 +304,12 @@ void Lgm_GradB( Lgm_Vector *u0, Lgm_Vector *GradB, int DerivScheme, double h, Lg
  */
 void Lgm_GradB2( Lgm_Vector *u0, Lgm_Vector *GradB, Lgm_Vector *GradB_para, Lgm_Vector *GradB_perp, int DerivScheme, double h, Lgm_MagModelInfo *m ) {
 
-    double      g;
+    double      g, J[3][3];
     Lgm_Vector  Bvec;
 
 
-    Lgm_GradB( u0, GradB, DerivScheme, h, m );
-
-
-    m->Bfield( u0, &Bvec, m );
+    Lgm_B_Jacobian( u0, &Bvec, J, DerivScheme, h, m );
+    Lgm_GradBFromJacobian( &Bvec, J, GradB );
     Lgm_NormalizeVector( &Bvec );
 
     // Compute parallel component of GradB
@@ -144,13 +329,12 @@ void Lgm_GradB2( Lgm_Vector *u0, Lgm_Vector *GradB, Lgm_Vector *GradB_para, Lgm_
 
 void Lgm_B_Cross_GradB_Over_B( Lgm_Vector *u0, Lgm_Vector *A, int DerivScheme, double h, Lgm_MagModelInfo *m ) {
 
-    double      B;
+    double      B, J[3][3];
     Lgm_Vector  GradB, Bvec;
 
-    m->Bfield( u0, &Bvec, m );
+    Lgm_B_Jacobian( u0, &Bvec, J, DerivScheme, h, m );
     B = Lgm_Magnitude( &Bvec );
-
-    Lgm_GradB( u0, &GradB, DerivScheme, h, m );
+    Lgm_GradBFromJacobian( &Bvec, J, &GradB );
     Lgm_CrossProduct( &Bvec, &GradB, A );
     Lgm_ScaleVector( A, 1.0/B );
     
@@ -178,114 +362,11 @@ void Lgm_B_Cross_GradB_Over_B( Lgm_Vector *u0, Lgm_Vector *A, int DerivScheme, d
  */
 void Lgm_CurlB( Lgm_Vector *u0, Lgm_Vector *CurlB, int DerivScheme, double h, Lgm_MagModelInfo *m ) {
 
-    double      B, H;
-    double      fxy[7], fxz[7], fyx[7], fyz[7], fzx[7], fzy[7];
-    double      dBxdy, dBxdz, dBydx, dBydz, dBzdx, dBzdy;
-    int         i, N;
-    Lgm_Vector  u, Bvec;
-
-
-
-    /*
-     * Select the derivative scheme to use.
-     *      f_0^(1) = 1/(60h)  ( f_3 - 9f_2 + 45f_1  - 45f_-1 + 9f_-2 - f_-3 )
-     * See page 450 of CRC standard Math tables 28th edition.
-     */
-    switch ( DerivScheme ) {
-        case LGM_DERIV_SIX_POINT:
-            N = 3;
-            break;
-        case LGM_DERIV_FOUR_POINT:
-            N = 2;
-            break;
-        case LGM_DERIV_TWO_POINT:
-            N = 1;
-            break;
-    }
+    double      J[3][3];
 
     if (m->VerbosityLevel > 0) printf("\t\tLgm_CurlB: Computing CurlB with DerivScheme = %d,  h = %g", DerivScheme, h);
-    // dBx/dy and dBx/dz
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.y += H;
-            m->Bfield( &u, &Bvec, m );
-            fxy[i+N] = Bvec.x;
-        }
-    }
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.z += H;
-            m->Bfield( &u, &Bvec, m );
-            fxz[i+N] = Bvec.x;
-        }
-    }
-
-    // dBy/dx and dBy/dz
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.x += H;
-            m->Bfield( &u, &Bvec, m );
-            fyx[i+N] = Bvec.y;
-        }
-    }
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.z += H;
-            m->Bfield( &u, &Bvec, m );
-            fyz[i+N] = Bvec.y;
-        }
-    }
-
-    // dBz/dx and dBz/dy
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.x += H;
-            m->Bfield( &u, &Bvec, m );
-            fzx[i+N] = Bvec.z;
-        }
-    }
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.y += H;
-            m->Bfield( &u, &Bvec, m );
-            fzy[i+N] = Bvec.z;
-        }
-    }
-
-    if (DerivScheme == LGM_DERIV_SIX_POINT){
-        dBxdy = (fxy[6] - 9.0*fxy[5] + 45.0*fxy[4] - 45.0*fxy[2] + 9.0*fxy[1] - fxy[0])/(60.0*h);
-        dBxdz = (fxz[6] - 9.0*fxz[5] + 45.0*fxz[4] - 45.0*fxz[2] + 9.0*fxz[1] - fxz[0])/(60.0*h);
-
-        dBydx = (fyx[6] - 9.0*fyx[5] + 45.0*fyx[4] - 45.0*fyx[2] + 9.0*fyx[1] - fyx[0])/(60.0*h);
-        dBydz = (fyz[6] - 9.0*fyz[5] + 45.0*fyz[4] - 45.0*fyz[2] + 9.0*fyz[1] - fyz[0])/(60.0*h);
-
-        dBzdx = (fzx[6] - 9.0*fzx[5] + 45.0*fzx[4] - 45.0*fzx[2] + 9.0*fzx[1] - fzx[0])/(60.0*h);
-        dBzdy = (fzy[6] - 9.0*fzy[5] + 45.0*fzy[4] - 45.0*fzy[2] + 9.0*fzy[1] - fzy[0])/(60.0*h);
-    } else if (DerivScheme == LGM_DERIV_FOUR_POINT){
-        dBxdy = (-fxy[4] + 8.0*fxy[3] - 8.0*fxy[1] + fxy[0])/(12.0*h);
-        dBxdz = (-fxz[4] + 8.0*fxz[3] - 8.0*fxz[1] + fxz[0])/(12.0*h);
-
-        dBydx = (-fyx[4] + 8.0*fyx[3] - 8.0*fyx[1] + fyx[0])/(12.0*h);
-        dBydz = (-fyz[4] + 8.0*fyz[3] - 8.0*fyz[1] + fyz[0])/(12.0*h);
-
-        dBzdx = (-fzx[4] + 8.0*fzx[3] - 8.0*fzx[1] + fzx[0])/(12.0*h);
-        dBzdy = (-fzy[4] + 8.0*fzy[3] - 8.0*fzy[1] + fzy[0])/(12.0*h);
-    } else if (DerivScheme == LGM_DERIV_TWO_POINT){
-        dBxdy = (fxy[2] - fxy[0])/(2.0*h);
-        dBxdz = (fxz[2] - fxz[0])/(2.0*h);
-
-        dBydx = (fyx[2] - fyx[0])/(2.0*h);
-        dBydz = (fyz[2] - fyz[0])/(2.0*h);
-
-        dBzdx = (fzx[2] - fzx[0])/(2.0*h);
-        dBzdy = (fzy[2] - fzy[0])/(2.0*h);
-    }
-    CurlB->x = dBzdy - dBydz;
-    CurlB->y = dBxdz - dBzdx;
-    CurlB->z = dBydx - dBxdy;
-//printf("NRM dBdx = %g %g %g\n", -999.0, dBydx, dBzdx );
-//printf("NRM dBdy = %g %g %g\n", dBxdy, -999.0, dBzdy );
-//printf("NRM dBdz = %g %g %g\n", dBxdz, dBydz, -999.0 );
+    Lgm_B_Jacobian( u0, NULL, J, DerivScheme, h, m );
+    Lgm_CurlBFromJacobian( J, CurlB );
     if (m->VerbosityLevel > 0) printf("   CurlB = (%g %g %g)\n", CurlB->x, CurlB->y, CurlB->z );
 
     return;
@@ -316,14 +397,12 @@ void Lgm_CurlB( Lgm_Vector *u0, Lgm_Vector *CurlB, int DerivScheme, double h, Lg
  */
 void Lgm_CurlB2( Lgm_Vector *u0, Lgm_Vector *CurlB, Lgm_Vector *CurlB_para, Lgm_Vector *CurlB_perp, int DerivScheme, double h, Lgm_MagModelInfo *m ) {
 
-    double      g;
+    double      g, J[3][3];
     Lgm_Vector  Bvec;
 
 
-    Lgm_CurlB( u0, CurlB, DerivScheme, h, m );
-
-
-    m->Bfield( u0, &Bvec, m );
+    Lgm_B_Jacobian( u0, &Bvec, J, DerivScheme, h, m );
+    Lgm_CurlBFromJacobian( J, CurlB );
     Lgm_NormalizeVector( &Bvec );
 
     // Compute parallel component of CurlB
@@ -368,74 +447,12 @@ void Lgm_CurlB2( Lgm_Vector *u0, Lgm_Vector *CurlB, Lgm_Vector *CurlB_para, Lgm_
  */
 void Lgm_DivB( Lgm_Vector *u0, double *DivB, int DerivScheme, double h, Lgm_MagModelInfo *m ) {
 
-    double      B, H;
-    double      fxx[7], fyy[7], fzz[7];
-    double      dBxdx, dBydy, dBzdz;
-    int         i, N;
-    Lgm_Vector  u, Bvec;
-
-
-
-    /*
-     * Select the derivative scheme to use.
-     *      f_0^(1) = 1/(60h)  ( f_3 - 9f_2 + 45f_1  - 45f_-1 + 9f_-2 - f_-3 )
-     * See page 450 of CRC standard Math tables 28th edition.
-     */
-    switch ( DerivScheme ) {
-        case LGM_DERIV_SIX_POINT:
-            N = 3;
-            break;
-        case LGM_DERIV_FOUR_POINT:
-            N = 2;
-            break;
-        case LGM_DERIV_TWO_POINT:
-            N = 1;
-            break;
-    }
+    double      J[3][3];
 
     if (m->VerbosityLevel > 0) printf("\t\tLgm_DivB: Computing DivB with DerivScheme = %d,  h = %g", DerivScheme, h);
-    // dBx/dx
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.x += H;
-            m->Bfield( &u, &Bvec, m );
-            fxx[i+N] = Bvec.x;
-        }
-    }
-
-    // dBy/dy
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.y += H;
-            m->Bfield( &u, &Bvec, m );
-            fyy[i+N] = Bvec.y;
-        }
-    }
-
-    // dBz/dz
-    for (i=-N; i<=N; ++i){
-        if ( N != 0 ) {
-            u = *u0; H = (double)i*h; u.z += H;
-            m->Bfield( &u, &Bvec, m );
-            fzz[i+N] = Bvec.z;
-        }
-    }
-
-    if (DerivScheme == LGM_DERIV_SIX_POINT){
-        dBxdx = (fxx[6] - 9.0*fxx[5] + 45.0*fxx[4] - 45.0*fxx[2] + 9.0*fxx[1] - fxx[0])/(60.0*h);
-        dBydy = (fyy[6] - 9.0*fyy[5] + 45.0*fyy[4] - 45.0*fyy[2] + 9.0*fyy[1] - fyy[0])/(60.0*h);
-        dBzdz = (fzz[6] - 9.0*fzz[5] + 45.0*fzz[4] - 45.0*fzz[2] + 9.0*fzz[1] - fzz[0])/(60.0*h);
-    } else if (DerivScheme == LGM_DERIV_FOUR_POINT){
-        dBxdx = (-fxx[4] + 8.0*fxx[3] - 8.0*fxx[1] + fxx[0])/(12.0*h);
-        dBydy = (-fyy[4] + 8.0*fyy[3] - 8.0*fyy[1] + fyy[0])/(12.0*h);
-        dBzdz = (-fzz[4] + 8.0*fzz[3] - 8.0*fzz[1] + fzz[0])/(12.0*h);
-    } else if (DerivScheme == LGM_DERIV_TWO_POINT){
-        dBxdx = (fxx[2] - fxx[0])/(2.0*h);
-        dBydy = (fyy[2] - fyy[0])/(2.0*h);
-        dBzdz = (fzz[2] - fzz[0])/(2.0*h);
-    }
-    *DivB = dBxdx + dBydy + dBzdz;
-    if (m->VerbosityLevel > 0) printf("   dBxdx, dBydy, dBzdz, DivB = %g %g %g %g\n", dBxdx, dBydy, dBzdz, *DivB );
+    Lgm_B_Jacobian( u0, NULL, J, DerivScheme, h, m );
+    *DivB = J[0][0] + J[1][1] + J[2][2];
+    if (m->VerbosityLevel > 0) printf("   dBxdx, dBydy, dBzdz, DivB = %g %g %g %g\n", J[0][0], J[1][1], J[2][2], *DivB );
 
     return;
 
@@ -485,7 +502,38 @@ void Lgm_DivB( Lgm_Vector *u0, double *DivB, int DerivScheme, double h, Lgm_MagM
  */
 int Lgm_GradAndCurvDriftVel( Lgm_Vector *u0, Lgm_Vector *Vel, Lgm_MagModelInfo *m ) {
 
-    double      B, BoverBm, g, eta, h, Beta, Beta2, Gamma;
+    return( Lgm_GuidingCenterVel( u0, Vel, -1.0, (double *)NULL, m ) );
+
+}
+
+
+
+/**
+ *  \brief
+ *      Compute the velocity of a guiding center moving in a given direction along B.
+ *
+ *  \details
+ *      Same as Lgm_GradAndCurvDriftVel(), except that the sense of the
+ *      parallel motion is given explicitly. VparSgn = +1 moves the guiding
+ *      center along B and VparSgn = -1 moves it against B
+ *      (Lgm_GradAndCurvDriftVel() always uses -1). This is what a tracer needs
+ *      to reverse the parallel motion at the mirror points. The magnitude of
+ *      B at u0 is handed back as well, so that the caller can tell how close
+ *      to the mirror point it is without another field evaluation.
+ *
+ *      \param[in]      u0          Position (in GSM) to use. [Re]
+ *      \param[out]     Vel         The computed guiding center velocity in GSM coords. [Re/s]
+ *      \param[in]      VparSgn     Sense of the parallel motion relative to B (+1.0 or -1.0).
+ *      \param[out]     Bmag        Magnitude of B at u0 (can be NULL if not needed). [nT]
+ *      \param[in,out]  m           A properly initialized and configured Lgm_MagModelInfo structure
+ *                                  (the Lgm_VelStep_q, _T, _E0, _Bm, _h and _DerivScheme fields must be set).
+ *
+ *      \return        1
+ *
+ */
+int Lgm_GuidingCenterVel( Lgm_Vector *u0, Lgm_Vector *Vel, double VparSgn, double *Bmag, Lgm_MagModelInfo *m ) {
+
+    double      B, BoverBm, g, eta, h, Beta, Beta2, Gamma, J[3][3];
     double      q, T, E0, Bm;
     int         DerivScheme;
     Lgm_Vector  CurlB, CurlB_para, CurlB_perp, GradB, Bvec, Q, R, S, W, Z;
@@ -499,7 +547,10 @@ int Lgm_GradAndCurvDriftVel( Lgm_Vector *u0, Lgm_Vector *Vel, Lgm_MagModelInfo *
     DerivScheme = m->Lgm_VelStep_DerivScheme;
 
 //printf("Lgm_GradAndCurvDriftVel: u0 = %g %g %g\n", u0->x, u0->y, u0->z);
-    m->Bfield( u0, &Bvec, m );
+    /*
+     * B and all of its derivatives in one go.
+     */
+    Lgm_B_Jacobian( u0, &Bvec, J, DerivScheme, h, m );
     B = Lgm_Magnitude( &Bvec );
     BoverBm = B/Bm;
 //printf("BoverBm = %g\n", BoverBm);
@@ -508,14 +559,18 @@ int Lgm_GradAndCurvDriftVel( Lgm_Vector *u0, Lgm_Vector *Vel, Lgm_MagModelInfo *
     /*
      * Compute B cross GradB  [nT/Re]
      */
-    Lgm_GradB( u0, &GradB, DerivScheme, h, m );
+    Lgm_GradBFromJacobian( &Bvec, J, &GradB );
     Lgm_CrossProduct( &Bvec, &GradB, &B_Cross_GradB );
 
 
     /*
      * Compute (curl B)_perp [nT/Re]
      */
-    Lgm_CurlB2( u0, &CurlB, &CurlB_para, &CurlB_perp, DerivScheme, h, m );
+    Lgm_CurlBFromJacobian( J, &CurlB );
+    g = Lgm_DotProduct( &Bvec, &CurlB )/B; // (same as in Lgm_CurlB2())
+    CurlB_para = CurlB;
+    Lgm_ScaleVector( &CurlB_para, g );
+    Lgm_VecSub( &CurlB_perp, &CurlB, &CurlB_para );
 
 
     /*
@@ -551,7 +606,7 @@ int Lgm_GradAndCurvDriftVel( Lgm_Vector *u0, Lgm_Vector *Vel, Lgm_MagModelInfo *
     if (BoverBm >= 1.0) {
         g = 0.0;
     } else {
-        g = -LGM_c/(1000.0*Re)*Beta*sqrt(1.0-BoverBm)/B;
+        g = VparSgn*LGM_c/(1000.0*Re)*Beta*sqrt(1.0-BoverBm)/B;
     }
 //printf("T = %g, Beta = %g g = %g\n", T, Beta, g);
     W = Bvec;
@@ -562,6 +617,7 @@ int Lgm_GradAndCurvDriftVel( Lgm_Vector *u0, Lgm_Vector *Vel, Lgm_MagModelInfo *
     
 
     *Vel = Z;
+    if ( Bmag != NULL ) *Bmag = B;
 
 
     return(1);
@@ -274,11 +274,6 @@ void    _Lgm_IGRF2( Lgm_Vector *v, Lgm_Vector *B, Lgm_CTrans *c ) {
     sp = sin( Phi );   cp = cos( Phi );
 
 
-    if ( c->Lgm_IGRF_FirstCall ) {
-        Lgm_InitK( c->Lgm_IGRF_K, N );
-        Lgm_InitS( c->Lgm_IGRF_S, N );
-    }
-
 
 
     /*
@@ -438,11 +433,6 @@ void    _Lgm_IGRF3( Lgm_Vector *v, Lgm_Vector *B, Lgm_CTrans *c ) {
 
 
 
-    if ( c->Lgm_IGRF_FirstCall ) {
-        Lgm_InitK( c->Lgm_IGRF_K, N );
-        Lgm_InitS( c->Lgm_IGRF_S, N );
-    }
-
 
 
     /*
@@ -609,11 +599,6 @@ void    _Lgm_IGRF4( Lgm_Vector *v, Lgm_Vector *B, Lgm_CTrans *c ) {
 
 
 
-    if ( c->Lgm_IGRF_FirstCall ) {
-        Lgm_InitK( c->Lgm_IGRF_K, N );
-        Lgm_InitS( c->Lgm_IGRF_S, N );
-    }
-
 
 
     /*
@@ -711,10 +696,274 @@ void    _Lgm_IGRF4( Lgm_Vector *v, Lgm_Vector *B, Lgm_CTrans *c ) {
 
 
 
+/*
+ *  Cartesian version of the IGRF evaluation.
+ *
+ *  u is the position in GEO (WGS84) cartesian coords (units of Re) and B is
+ *  returned as cartesian GEO components (nT). The potential is expanded in
+ *  the (unnormalized) solid harmonics
+ *
+ *      V_n,m = (a/r)^(n+1) P_n,m( z/r ) cos( m phi )
+ *      W_n,m = (a/r)^(n+1) P_n,m( z/r ) sin( m phi )
+ *
+ *  which obey recursions in x, y, z alone (x, y, z, r in units of a;
+ *  Cunningham, 1970; see also Montenbruck and Gill, Satellite Orbits, 2000):
+ *
+ *      V_m,m = (2m-1) ( x V_m-1,m-1 - y W_m-1,m-1 )/r^2
+ *      W_m,m = (2m-1) ( x W_m-1,m-1 + y V_m-1,m-1 )/r^2
+ *      V_n,m = ( (2n-1) z V_n-1,m - (n+m-1) V_n-2,m )/( (n-m) r^2 )   (same for W)
+ *
+ *  The gradient of each degree n term is a combination of degree n+1 terms.
+ *  These combinations only depend on the IGRF coeffs, so they are folded into
+ *  c->Lgm_IGRF_CartCoeffs once per epoch (see Lgm_IGRF_InitCart()) and B is
+ *  then just a dot product with the V's and W's. No trig calls are needed and
+ *  there is no singularity at the poles (unlike Lgm_IGRF()).
+ */
+void Lgm_IGRF_Cart( Lgm_Vector *u, Lgm_Vector *B, Lgm_CTrans *c ) {
+
+    double  f, x, y, z, r2inv, xr, yr, zr, Bx, By, Bz;
+    double  V, W, Vmm, Wmm, Vnm1, Wnm1, Vnm2, Wnm2, Vt;
+    double  *A1, *A2, *Cx, *Sx, *Cy, *Sy, *Cz, *Sz;
+    int     n, m, N = 13, Rebuild;
+    Lgm_IGRF_Tables *t = Lgm_IGRF_SharedTables();
+
+    Rebuild = c->Lgm_IGRF_FirstCall || ( c->UTC.fYear != c->Lgm_IGRF_CartYear );
+    Lgm_InitIGRF( c->Lgm_IGRF_g, c->Lgm_IGRF_h, N, c->Lgm_IGRF_FirstCall, c );
+    if ( Rebuild ) Lgm_IGRF_InitCart( c );
+    c->Lgm_IGRF_FirstCall = FALSE;
+
+    /*
+     *  Convert position to units of IGRF_Re (see comments in Lgm_IGRF()).
+     */
+    f = Re/IGRF_Re;
+    x = u->x*f; y = u->y*f; z = u->z*f;
+    r2inv = 1.0/(x*x + y*y + z*z);
+    xr = x*r2inv; yr = y*r2inv; zr = z*r2inv;
+
+    /*
+     *  Sweep up each order m (from V_m,m) to degree N+1, accumulating the
+     *  contribution of each V_n,m and W_n,m to B as we go.
+     */
+    Bx = By = Bz = 0.0;
+    Vmm = sqrt( r2inv ); Wmm = 0.0;
+    for ( m=0; m<=N+1; ++m ) {
+
+        if ( m > 0 ) {
+            Vt  = (2*m-1)*( xr*Vmm - yr*Wmm );
+            Wmm = (2*m-1)*( xr*Wmm + yr*Vmm );
+            Vmm = Vt;
+        }
+
+        A1 = t->CartA[m]; A2 = t->CartB[m];
+        Cx = c->Lgm_IGRF_CartCoeffs[0][m]; Sx = c->Lgm_IGRF_CartCoeffs[1][m];
+        Cy = c->Lgm_IGRF_CartCoeffs[2][m]; Sy = c->Lgm_IGRF_CartCoeffs[3][m];
+        Cz = c->Lgm_IGRF_CartCoeffs[4][m]; Sz = c->Lgm_IGRF_CartCoeffs[5][m];
+
+        V = Vmm; W = Wmm;
+        Vnm1 = Wnm1 = 0.0;
+        for ( n=m; n<=N+1; ++n ) {
+            if ( n > m ) {
+                Vnm2 = Vnm1; Wnm2 = Wnm1;
+                Vnm1 = V;    Wnm1 = W;
+                V = A1[n]*zr*Vnm1 - A2[n]*r2inv*Vnm2;
+                W = A1[n]*zr*Wnm1 - A2[n]*r2inv*Wnm2;
+            }
+            Bx += Cx[n]*V + Sx[n]*W;
+            By += Cy[n]*V + Sy[n]*W;
+            Bz += Cz[n]*V + Sz[n]*W;
+        }
+
+    }
+
+    B->x = Bx;
+    B->y = By;
+    B->z = Bz;
+
+}
+
+
+/*
+ *  Like Lgm_IGRF_Cart(), but also returns the Jacobian J[i][j] = dB_i/du_j
+ *  (nT/Re, GEO cartesian). Each folded term of B is a degree n+1 solid
+ *  harmonic, so its gradient is once more a combination of degree n+2
+ *  harmonics given by the same relations (Montenbruck and Gill, 2000, Eq.
+ *  3.33) that were used to fold the coeffs:
+ *
+ *      dV_n,0/dx = -V_n+1,1                        dV_n,0/dy = -W_n+1,1
+ *      dV_n,m/dx = ( -V_n+1,m+1 + q V_n+1,m-1 )/2  dW_n,m/dx = ( -W_n+1,m+1 + q W_n+1,m-1 )/2
+ *      dV_n,m/dy = ( -W_n+1,m+1 - q W_n+1,m-1 )/2  dW_n,m/dy = (  V_n+1,m+1 + q V_n+1,m-1 )/2
+ *      dV_n,m/dz = -(n-m+1) V_n+1,m                dW_n,m/dz = -(n-m+1) W_n+1,m
+ *
+ *  with q = (n-m+2)(n-m+1).
+ */
+void Lgm_IGRF_Cart_Jacobian( Lgm_Vector *u, Lgm_Vector *B, double J[3][3], Lgm_CTrans *c ) {
+
+    double  f, x, y, z, r2inv, xr, yr, zr, Vt, q, C, S, p;
+    double  V[16][16], W[16][16];   // [m][n] for n <= N+2
+    double  dVx, dVy, dVz, dWx, dWy, dWz, Bv[3];
+    int     i, j, n, m, N = 13, Rebuild;
+
+    Rebuild = c->Lgm_IGRF_FirstCall || ( c->UTC.fYear != c->Lgm_IGRF_CartYear );
+    Lgm_InitIGRF( c->Lgm_IGRF_g, c->Lgm_IGRF_h, N, c->Lgm_IGRF_FirstCall, c );
+    if ( Rebuild ) Lgm_IGRF_InitCart( c );
+    c->Lgm_IGRF_FirstCall = FALSE;
+
+    f = Re/IGRF_Re;
+    x = u->x*f; y = u->y*f; z = u->z*f;
+    r2inv = 1.0/(x*x + y*y + z*z);
+    xr = x*r2inv; yr = y*r2inv; zr = z*r2inv;
+
+    /*
+     *  All the V_n,m and W_n,m up to degree N+2.
+     */
+    V[0][0] = sqrt( r2inv ); W[0][0] = 0.0;
+    for ( m=0; m<=N+2; ++m ) {
+        if ( m > 0 ) {
+            V[m][m] = (2*m-1)*( xr*V[m-1][m-1] - yr*W[m-1][m-1] );
+            W[m][m] = (2*m-1)*( xr*W[m-1][m-1] + yr*V[m-1][m-1] );
+        }
+        for ( n=m+1; n<=N+2; ++n ) {
+            Vt = ( n-m > 1 ) ? V[m][n-2] : 0.0;
+            V[m][n] = ( (2*n-1)*zr*V[m][n-1] - (n+m-1)*r2inv*Vt )/(double)(n-m);
+            Vt = ( n-m > 1 ) ? W[m][n-2] : 0.0;
+            W[m][n] = ( (2*n-1)*zr*W[m][n-1] - (n+m-1)*r2inv*Vt )/(double)(n-m);
+        }
+    }
+
+    for ( i=0; i<3; ++i ) {
+        Bv[i] = 0.0;
+        for ( j=0; j<3; ++j ) J[i][j] = 0.0;
+    }
+
+    for ( m=0; m<=N+1; ++m ) {
+        for ( n=m; n<=N+1; ++n ) {
+
+            q   = (double)((n-m+2)*(n-m+1));
+            p   = (double)(n-m+1);
+            if ( m == 0 ) {
+                dVx = -V[1][n+1]; dVy = -W[1][n+1];
+                dWx = dWy = 0.0;
+            } else {
+                dVx = 0.5*( -V[m+1][n+1] + q*V[m-1][n+1] );
+                dWx = 0.5*( -W[m+1][n+1] + q*W[m-1][n+1] );
+                dVy = 0.5*( -W[m+1][n+1] - q*W[m-1][n+1] );
+                dWy = 0.5*(  V[m+1][n+1] + q*V[m-1][n+1] );
+            }
+            dVz = -p*V[m][n+1];
+            dWz = -p*W[m][n+1];
+
+            for ( i=0; i<3; ++i ) {
+                C = c->Lgm_IGRF_CartCoeffs[2*i][m][n];
+                S = c->Lgm_IGRF_CartCoeffs[2*i+1][m][n];
+                if ( ( C == 0.0 ) && ( S == 0.0 ) ) continue;
+                Bv[i]   += C*V[m][n] + S*W[m][n];
+                J[i][0] += C*dVx + S*dWx;
+                J[i][1] += C*dVy + S*dWy;
+                J[i][2] += C*dVz + S*dWz;
+            }
+
+        }
+    }
+
+    // derivatives were w.r.t. units of IGRF_Re
+    for ( i=0; i<3; ++i ) {
+        for ( j=0; j<3; ++j ) J[i][j] *= f;
+    }
+
+    B->x = Bv[0];
+    B->y = Bv[1];
+    B->z = Bv[2];
+
+}
+
+
+/*
+ *  Fold the current IGRF coeffs into the coefficients of the degree n+1
+ *  solid harmonics in B = -grad( Potential ) (Montenbruck and Gill, 2000, Eq.
+ *  3.33). The g and h coeffs are Schmidt semi-normalized, so they are first
+ *  converted to go with the unnormalized V and W.
+ */
+void Lgm_IGRF_InitCart( Lgm_CTrans *c ) {
+
+    double  G, H, q, (*R)[14];
+    double  (*Cx)[15], (*Sx)[15], (*Cy)[15], (*Sy)[15], (*Cz)[15], (*Sz)[15];
+    int     n, m, N = 13;
+
+    R  = Lgm_IGRF_SharedTables()->R;
+    Cx = c->Lgm_IGRF_CartCoeffs[0]; Sx = c->Lgm_IGRF_CartCoeffs[1];
+    Cy = c->Lgm_IGRF_CartCoeffs[2]; Sy = c->Lgm_IGRF_CartCoeffs[3];
+    Cz = c->Lgm_IGRF_CartCoeffs[4]; Sz = c->Lgm_IGRF_CartCoeffs[5];
+    memset( c->Lgm_IGRF_CartCoeffs, 0, sizeof(c->Lgm_IGRF_CartCoeffs) );
+
+    for ( n=1; n<=N; ++n ) {
+
+        G = c->Lgm_IGRF_g[n][0];
+        Cx[1][n+1] += G;
+        Sy[1][n+1] += G;
+        Cz[0][n+1] += (n+1)*G;
+
+        for ( m=1; m<=n; ++m ) {
+            G = c->Lgm_IGRF_g[n][m]*R[n][m];
+            H = c->Lgm_IGRF_h[n][m]*R[n][m];
+            q = (n-m+2)*(n-m+1);
+            Cx[m+1][n+1] += 0.5*G;    Sx[m+1][n+1] += 0.5*H;
+            Cx[m-1][n+1] -= 0.5*q*G;  Sx[m-1][n+1] -= 0.5*q*H;
+            Sy[m+1][n+1] += 0.5*G;    Cy[m+1][n+1] -= 0.5*H;
+            Sy[m-1][n+1] += 0.5*q*G;  Cy[m-1][n+1] -= 0.5*q*H;
+            Cz[m][n+1]   += (n-m+1)*G;
+            Sz[m][n+1]   += (n-m+1)*H;
+        }
+
+    }
+
+    c->Lgm_IGRF_CartYear = c->UTC.fYear;
+
+}
+
+
+
+/**
+ *  Returns the built-in IGRF model as a coefficient set (see
+ *  Lgm_SHCoeffs.c). The caller should free it with Lgm_SHCoeffs_Free().
+ */
+Lgm_SHCoeffs *Lgm_SHCoeffs_IGRF( void ) {
+
+    Lgm_SHCoeffs    *s;
+    int             j, n, m, k, N = 13;
+
+    s = Lgm_SHCoeffs_Alloc( N, IGRF_nModels );
+    s->RefRadius = IGRF_Re;
+    s->g_SV = (double *)calloc( s->nCoeffs, sizeof(double) );
+    s->h_SV = (double *)calloc( s->nCoeffs, sizeof(double) );
+    strcpy( s->Name, IGRF_Model );
+
+    for ( j=0; j<IGRF_nModels; ++j ) {
+        s->Epoch[j] = IGRF_epoch[j];
+        for ( n=0; n<=N; ++n ) {
+            for ( m=0; m<=n; ++m ) {
+                k = j*s->nCoeffs + LGM_SH_IDX( n, m );
+                s->g[k] = IGRF_g[j][n][m];
+                s->h[k] = IGRF_h[j][n][m];
+            }
+        }
+    }
+    for ( n=0; n<=N; ++n ) {
+        for ( m=0; m<=n; ++m ) {
+            s->g_SV[ LGM_SH_IDX( n, m ) ] = IGRF_g_SV[n][m];
+            s->h_SV[ LGM_SH_IDX( n, m ) ] = IGRF_h_SV[n][m];
+        }
+    }
+
+    return( s );
+
+}
+
+
+
 void Lgm_InitPnm( double ct, double st, double R[14][14], double P[14][14], double dP[14][14], int N, Lgm_CTrans *c ) {
 
     double         Pmm, Pmp1m, Pnm, Pnm1m, Pnm2m, a, b, f, x, x2;
-    int            NmM, Nm1, Mp1;
+    int            Mp1;
 //    static double  TwoNm1_Over_NmM[13][13], NpMm1_Over_NmM[13][13];
 //    static int     FirstTimeThrough=TRUE;
     register int   n, m, i;
@@ -732,40 +981,15 @@ we dont really need this if we set everything below
             for (m=0; m<=N; ++m){
                 P[n][m] = 0.0;
                 dP[n][m] = 0.0;
-                R[n][m] = 0.0;
             }
         }
     }
 
     /*
-     *  Now calculate the Schmidt normalization factors ("Ratios").
-     *  There's almost certainly a better way to do this, but
-     *  we really only ever need to do this once (they are constants).
-     *
-     *  One solution would be to precompute them an stuff them into 
-     *  a static variable.
+     *  The Schmidt normalization factors ("Ratios") R and the recursion
+     *  coefficients are constants. They live in the shared tables (see
+     *  Lgm_IGRF_SharedTables()).
      */
-    if ( c->Lgm_IGRF_FirstCall ) {
-        for (n=0; n<=N; ++n){
-            for (m=0; m<=n; ++m){
-
-                NmM = n-m;
-                Nm1 = n-1;
-
-                if (m==0) {
-                    R[n][m] = 1.0;
-                } else {
-                    R[n][m] =  sqrt( 2.0*Lgm_Factorial(NmM)/Lgm_Factorial(n+m) );
-                }
-
-                if (n>m+1){
-                    c->Lgm_IGRF_TwoNm1_Over_NmM[n][m] = (double)(Nm1+n)/(double)NmM;
-                    c->Lgm_IGRF_NpMm1_Over_NmM[n][m]  = (double)(Nm1+m)/(double)NmM;
-                }
-
-            }
-        }
-    } 
 
 
     x2 = x*x;
@@ -849,9 +1073,6 @@ void Lgm_InitdPnm( double P[14][14], double dP[14][14], int N, Lgm_CTrans *c ) {
 //    static int      FirstTimeThrough=TRUE;
 
 
-//c->Lgm_IGRF_FirstCall = TRUE;
-    if ( c->Lgm_IGRF_FirstCall ) Lgm_InitSqrtFuncs( c->Lgm_IGRF_SqrtNM1, c->Lgm_IGRF_SqrtNM2, N );
-
     for (n=0; n<=N; ++n){
         for (m=n; m>=0; --m){
     
@@ -1016,6 +1237,87 @@ void Lgm_InitK( double K[14][14], int N ) {
 }
 
 
+
+/*
+ *  The Schmidt normalization factors and the recursion coefficients used by
+ *  Lgm_InitPnm(), Lgm_InitdPnm() and the _Lgm_IGRF*() variants only depend on
+ *  (n, m). They are computed once (for N = 13, which covers every smaller N)
+ *  and shared read-only by all Lgm_CTrans structures, rather than being
+ *  rebuilt in each one.
+ */
+static Lgm_IGRF_Tables  Lgm_IGRF_Shared;
+static volatile int     Lgm_IGRF_SharedInitialized = FALSE;
+
+Lgm_IGRF_Tables *Lgm_IGRF_SharedTables( void ) {
+
+    int     n, m, NmM, Nm1, N = 13;
+
+    if ( !Lgm_IGRF_SharedInitialized ) {
+        #if USE_OPENMP
+        #pragma omp critical (Lgm_IGRF_SharedTables)
+        #endif
+        {
+            if ( !Lgm_IGRF_SharedInitialized ) {
+
+                for (n=0; n<=N; ++n){
+                    for (m=0; m<=n; ++m){
+
+                        NmM = n-m;
+                        Nm1 = n-1;
+
+                        if (m==0) {
+                            Lgm_IGRF_Shared.R[n][m] = 1.0;
+                        } else {
+                            Lgm_IGRF_Shared.R[n][m] =  sqrt( 2.0*Lgm_Factorial(NmM)/Lgm_Factorial(n+m) );
+                        }
+
+                        if (n>m+1){
+                            Lgm_IGRF_Shared.TwoNm1_Over_NmM[n][m] = (double)(Nm1+n)/(double)NmM;
+                            Lgm_IGRF_Shared.NpMm1_Over_NmM[n][m]  = (double)(Nm1+m)/(double)NmM;
+                        }
+
+                    }
+                }
+                for (n=1; n<=N+1; ++n){
+                    for (m=0; m<n; ++m){
+                        Lgm_IGRF_Shared.CartA[m][n] = (double)(2*n-1)/(double)(n-m);
+                        Lgm_IGRF_Shared.CartB[m][n] = (double)(n+m-1)/(double)(n-m);
+                    }
+                }
+                Lgm_InitK( Lgm_IGRF_Shared.K, N );
+                Lgm_InitS( Lgm_IGRF_Shared.S, N );
+                Lgm_InitSqrtFuncs( Lgm_IGRF_Shared.SqrtNM1, Lgm_IGRF_Shared.SqrtNM2, N );
+
+                #if USE_OPENMP
+                #pragma omp flush
+                #endif
+                Lgm_IGRF_SharedInitialized = TRUE;
+            }
+        }
+    }
+
+    return( &Lgm_IGRF_Shared );
+
+}
+
+/*
+ *  Points the per-structure IGRF table pointers at the shared tables.
+ */
+void Lgm_IGRF_AttachTables( Lgm_CTrans *c ) {
+
+    Lgm_IGRF_Tables *t = Lgm_IGRF_SharedTables();
+
+    c->Lgm_IGRF_R               = t->R;
+    c->Lgm_IGRF_K               = t->K;
+    c->Lgm_IGRF_S               = t->S;
+    c->Lgm_IGRF_TwoNm1_Over_NmM = t->TwoNm1_Over_NmM;
+    c->Lgm_IGRF_NpMm1_Over_NmM  = t->NpMm1_Over_NmM;
+    c->Lgm_IGRF_SqrtNM1         = t->SqrtNM1;
+    c->Lgm_IGRF_SqrtNM2         = t->SqrtNM2;
+
+}
+
+
 void Lgm_InitIGRF( double g[14][14], double h[14][14], int N, int Flag, Lgm_CTrans *c ){
 
     double          Year;
@@ -1024,6 +1326,8 @@ void Lgm_InitIGRF( double g[14][14], double h[14][14], int N, int Flag, Lgm_CTra
     int             j, j0, j1, n, m;
 
 
+    Lgm_IGRF_AttachTables( c );
+
     /* Get Year from Lgm_CTrans structure */
     Year = c->UTC.fYear;
     if ( Year < 1.0 ) {
@@ -452,6 +452,7 @@ Lgm_MagEphemData *Lgm_InitMagEphemData( int nRows, int nPA ) {
     LGM_ARRAY_2D( MagEphemData->H5_FieldLineType,     nRows, 80,      char   );
     LGM_ARRAY_2D( MagEphemData->H5_IntModel,          nRows, 80,      char   );
     LGM_ARRAY_2D( MagEphemData->H5_ExtModel,          nRows, 80,      char   );
+    LGM_ARRAY_2D( MagEphemData->H5_InputFingerprint,  nRows, 80,      char   );
 
     LGM_ARRAY_1D( MagEphemData->H5_Date,              nRows,          long int );
     LGM_ARRAY_1D( MagEphemData->H5_Doy,               nRows,          int    );
@@ -580,6 +581,7 @@ void Lgm_FreeMagEphemData( Lgm_MagEphemData *MagEphemData ) {
     LGM_ARRAY_2D_FREE( MagEphemData->H5_FieldLineType );
     LGM_ARRAY_2D_FREE( MagEphemData->H5_IntModel );
     LGM_ARRAY_2D_FREE( MagEphemData->H5_ExtModel );
+    LGM_ARRAY_2D_FREE( MagEphemData->H5_InputFingerprint );
 
     LGM_ARRAY_1D_FREE( MagEphemData->H5_Date );
     LGM_ARRAY_1D_FREE( MagEphemData->H5_Doy );
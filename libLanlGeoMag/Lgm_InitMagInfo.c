@@ -65,7 +65,7 @@ void Lgm_InitMagInfoDefaults( Lgm_MagModelInfo  *MagInfo ) {
 
     /*
      * Default to Bulirsch-Stoer ODE method for FL tracing (i.e. LGM_MAGSTEP_ODE_BS)
-     * Could also use LGM_MAGSTEP_ODE_RK5
+     * Could also use LGM_MAGSTEP_ODE_RK5 or LGM_MAGSTEP_ODE_DP5
      */
     MagInfo->Lgm_MagStep_Integrator = LGM_MAGSTEP_ODE_BS;
 
@@ -98,6 +98,15 @@ void Lgm_InitMagInfoDefaults( Lgm_MagModelInfo  *MagInfo ) {
     MagInfo->Lgm_MagStep_RK5_ErrCon           = pow( 5.0/MagInfo->Lgm_MagStep_RK5_Safety, 1.0/MagInfo->Lgm_MagStep_RK5_pGrow);
     MagInfo->Lgm_MagStep_RK5_Eps              = 1e-5;
 
+    /*
+     *  Some inits for MagStep_DP5
+     */
+    MagInfo->Lgm_MagStep_DP5_Eps        = 1e-5;
+    MagInfo->Lgm_MagStep_DP5_Safety     = 0.9;
+    MagInfo->Lgm_MagStep_DP5_MaxCount   = 50;
+    MagInfo->Lgm_MagStep_DP5_FSAL_Valid = FALSE;
+    MagInfo->Lgm_MagStep_DP5_Dense.Valid = FALSE;
+
 //    gsl_set_error_handler_off(); // Turn off gsl default error handler
 
     /*
@@ -177,6 +186,12 @@ void Lgm_InitMagInfoDefaults( Lgm_MagModelInfo  *MagInfo ) {
     MagInfo->Octree_kNN_Alloced = 0;
 
 
+    /*
+     *  No gridded field model by default.
+     */
+    MagInfo->BGrid = NULL;
+
+
     /*
      *  Initialize hash table used in Lgm_B_FromScatteredData*()
      */
@@ -537,6 +552,14 @@ m->Lgm_MagStep_Integrator = LGM_MAGSTEP_ODE_BS;
                                 strcpy( m->ExtMagModelStr3, "Reference: Uses KDTree and nearest neighbor algorithm to interpolate from unstructured data clouds.");
                                 strcpy( m->ExtMagModelStr4, "Comments: Any 3D collection of B-field data points can be used." );
                                 break;
+        case LGM_EXTMODEL_GRID:
+                                m->Bfield = Lgm_B_Grid;
+                                m->Lgm_MagStep_Integrator = LGM_MAGSTEP_ODE_BS;
+                                strcpy( m->ExtMagModelStr1, "GRID" );
+                                strcpy( m->ExtMagModelStr2, "Gridded Magnetic Field Model" );
+                                strcpy( m->ExtMagModelStr3, "Reference: Tricubic interpolation on an adaptive octree grid built with Lgm_B_Grid_Build()." );
+                                strcpy( m->ExtMagModelStr4, "Comments: Requires m->BGrid to be set (see Lgm_Set_Lgm_B_Grid())." );
+                                break;
 
 
         default:
@@ -5,10 +5,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <math.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include "Lgm/Lgm_Vec.h"
 #include "Lgm/Lgm_HDF5.h"
 #include "Lgm/Lgm_JPLeph.h"
+#if USE_OPENMP
+#include <omp.h>
+#endif
 
 #ifndef LGM_INDEX_DATA_DIR
 #warning "hard-coding LGM_INDEX_DATA_DIR because it was not in config.h"
@@ -39,8 +45,65 @@ void Lgm_InitJPLephDefaults( int DEnum, int getBodies, int verbosity, Lgm_JPLeph
 
 }
 
+/*
+ *  Pointers to the array and dimensions of the i'th dataset of a mapped file
+ *  (see Lgm_JPLephemMapHeader for the order). Returns the get* flag that
+ *  requests it.
+ */
+static int Lgm_JPL_MapDataSet( int i, Lgm_JPLephemInfo *jpl, double *****a, int **nvals, int **naxes, int **ncoeffs ) {
+
+    switch ( i ) {
+        case  0: *a = &jpl->sun;            *nvals = &jpl->sun_nvals;            *naxes = &jpl->sun_naxes;            *ncoeffs = &jpl->sun_ncoeffs;            return( jpl->getSun );
+        case  1: *a = &jpl->earthmoon;      *nvals = &jpl->earthmoon_nvals;      *naxes = &jpl->earthmoon_naxes;      *ncoeffs = &jpl->earthmoon_ncoeffs;      return( jpl->getEarth );
+        case  2: *a = &jpl->moon_wrt_earth; *nvals = &jpl->moon_wrt_earth_nvals; *naxes = &jpl->moon_wrt_earth_naxes; *ncoeffs = &jpl->moon_wrt_earth_ncoeffs; return( jpl->getEarth );
+        case  3: *a = &jpl->mercury;        *nvals = &jpl->mercury_nvals;        *naxes = &jpl->mercury_naxes;        *ncoeffs = &jpl->mercury_ncoeffs;        return( jpl->getInnerPlanets );
+        case  4: *a = &jpl->venus;          *nvals = &jpl->venus_nvals;          *naxes = &jpl->venus_naxes;          *ncoeffs = &jpl->venus_ncoeffs;          return( jpl->getInnerPlanets );
+        case  5: *a = &jpl->mars;           *nvals = &jpl->mars_nvals;           *naxes = &jpl->mars_naxes;           *ncoeffs = &jpl->mars_ncoeffs;           return( jpl->getInnerPlanets );
+        case  6: *a = &jpl->jupiter;        *nvals = &jpl->jupiter_nvals;        *naxes = &jpl->jupiter_naxes;        *ncoeffs = &jpl->jupiter_ncoeffs;        return( jpl->getOuterPlanets );
+        case  7: *a = &jpl->saturn;         *nvals = &jpl->saturn_nvals;         *naxes = &jpl->saturn_naxes;         *ncoeffs = &jpl->saturn_ncoeffs;         return( jpl->getOuterPlanets );
+        case  8: *a = &jpl->uranus;         *nvals = &jpl->uranus_nvals;         *naxes = &jpl->uranus_naxes;         *ncoeffs = &jpl->uranus_ncoeffs;         return( jpl->getOuterPlanets );
+        case  9: *a = &jpl->neptune;        *nvals = &jpl->neptune_nvals;        *naxes = &jpl->neptune_naxes;        *ncoeffs = &jpl->neptune_ncoeffs;        return( jpl->getOuterPlanets );
+        case 10: *a = &jpl->pluto;          *nvals = &jpl->pluto_nvals;          *naxes = &jpl->pluto_naxes;          *ncoeffs = &jpl->pluto_ncoeffs;          return( jpl->getOuterPlanets );
+        case 11: *a = &jpl->libration;      *nvals = &jpl->libration_nvals;      *naxes = &jpl->libration_naxes;      *ncoeffs = &jpl->libration_ncoeffs;      return( jpl->getLibrationNutation );
+        default: *a = &jpl->nutation;       *nvals = &jpl->nutation_nvals;       *naxes = &jpl->nutation_naxes;       *ncoeffs = &jpl->nutation_ncoeffs;       return( jpl->getLibrationNutation );
+    }
+
+}
+
+
+/*
+ *  Drop the (pointer arrays into the) mapped coefficients.
+ */
+static void Lgm_UnmapJPLephem( Lgm_JPLephemInfo *jpl ) {
+
+    int     i, *nvals, *naxes, *ncoeffs;
+    double  ****a;
+
+    for ( i=0; i<LGM_DE_MAP_NDATASETS; i++ ) {
+        Lgm_JPL_MapDataSet( i, jpl, &a, &nvals, &naxes, &ncoeffs );
+        if ( *a != NULL ) {
+            LGM_ARRAY_FROM_DATA_3D_FREE( (*a) );
+            *a = NULL;
+        }
+    }
+    munmap( jpl->MapAddr, (size_t)jpl->MapSize );
+    jpl->MapAddr = NULL;
+    jpl->MapSize = 0;
+    jpl->Mapped  = FALSE;
+
+}
+
+
 void Lgm_FreeJPLephemInfo( Lgm_JPLephemInfo *jpl ) {
 
+    if ( jpl->Shared ) return;
+
+    if ( jpl->Mapped ) {
+        Lgm_UnmapJPLephem( jpl );
+        free( jpl );
+        return;
+    }
+
     if ( jpl->SunAlloced ) { 
         LGM_ARRAY_3D_FREE( jpl->sun );
     }
@@ -109,6 +172,16 @@ void Lgm_ReadJPLephem( Lgm_JPLephemInfo *jpl ) {
 
     }
 
+    /*
+     * Use a flat copy of the ephemeris if one has been made (see
+     * Lgm_WriteJPLephemMap()). Mapping it is much cheaper than reading the
+     * HDF5 file, and processes using it share the pages.
+     */
+    sprintf( eph_num, "/jpl_de%d.map", jpl->DEnum );
+    strcpy( JPLephemFile, JPLephemPath );
+    strcat( JPLephemFile, eph_num );
+    if ( ( stat( JPLephemFile, &StatBuf ) != -1 ) && ( Lgm_MapJPLephem( JPLephemFile, jpl ) == 0 ) ) return;
+
     // jpl structure has member DEnum that should be cast to a string
     sprintf( eph_num, "/jpl_de%d.h5", jpl->DEnum );
     strcpy( JPLephemFile, JPLephemPath );
@@ -187,31 +260,192 @@ void Lgm_ReadJPLephem( Lgm_JPLephemInfo *jpl ) {
 }
 
 
-void Lgm_JPLephem_setup_object( int objName, Lgm_JPLephemInfo *jpl, Lgm_JPLephemBundle *bundle ) {
-    
-    double days_per_set, offset, tdb;
-    int    index, number_of_sets, number_of_axes, coefficient_count;
-    int    ii, jj, omegas;
-    double vx, wx, div, mod, floordiv, t1, twot1;
-    double *T, ***cheby, **coefficients;
+/*
+ *  Map the coefficients of the bodies requested in jpl (see
+ *  Lgm_InitJPLephDefaults()) from a file written by Lgm_WriteJPLephemMap().
+ *  Nothing is copied: the coefficient arrays point straight into the read-only
+ *  mapping, so only the records that are actually used get paged in, and all
+ *  the processes that map the same file share those pages. Returns 0 on
+ *  success and a negative value (leaving jpl unchanged) on failure.
+ */
+int Lgm_MapJPLephem( char *Filename, Lgm_JPLephemInfo *jpl ) {
+
+    int                     fd, i, *nvals, *naxes, *ncoeffs, want;
+    int64_t                 n;
+    struct stat             StatBuf;
+    void                    *Addr;
+    double                  ****a, *Data;
+    Lgm_JPLephemMapHeader   *h;
+
+    if ( ( fd = open( Filename, O_RDONLY ) ) < 0 ) {
+        if ( jpl->verbosity > 1 ) printf("Lgm_MapJPLephem: could not open %s\n", Filename );
+        return( -1 );
+    }
+    if ( ( fstat( fd, &StatBuf ) < 0 ) || ( StatBuf.st_size < (off_t)sizeof(Lgm_JPLephemMapHeader) ) ) {
+        printf("Lgm_MapJPLephem: %s is too short to be a DE map file\n", Filename );
+        close( fd );
+        return( -2 );
+    }
+    Addr = mmap( NULL, (size_t)StatBuf.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( Addr == MAP_FAILED ) {
+        printf("Lgm_MapJPLephem: could not map %s\n", Filename );
+        return( -3 );
+    }
 
-    tdb = bundle->tdb;
-    if ((tdb < jpl->jalpha) || (tdb > jpl->jomega)) { 
-        printf("Time (JD) is %15.8lf but must be between %15.8lf and %15.8lf\n", tdb, jpl->jalpha, jpl->jomega);
-        exit(-1);
+    /*
+     * Check the header and that every dataset we want is there (and lies
+     * within the file).
+     */
+    h = (Lgm_JPLephemMapHeader *)Addr;
+    if ( ( strncmp( h->Magic, LGM_DE_MAP_MAGIC, 8 ) != 0 ) || ( h->Version != LGM_DE_MAP_VERSION )
+            || ( h->ByteOrder != LGM_DE_MAP_BYTEORDER ) || ( h->HeaderSize != (int32_t)sizeof(Lgm_JPLephemMapHeader) )
+            || ( h->nDataSets != LGM_DE_MAP_NDATASETS ) || ( h->DEnum != jpl->DEnum ) ) {
+        printf("Lgm_MapJPLephem: %s is not a DE%d map file written on this kind of machine\n", Filename, jpl->DEnum );
+        munmap( Addr, (size_t)StatBuf.st_size );
+        return( -4 );
+    }
+    for ( i=0; i<LGM_DE_MAP_NDATASETS; i++ ) {
+        if ( !Lgm_JPL_MapDataSet( i, jpl, &a, &nvals, &naxes, &ncoeffs ) ) continue;
+        n = ( (int64_t)StatBuf.st_size - h->Offset[i] )/(int64_t)sizeof(double); // number of doubles that fit after the offset
+        if ( ( h->Offset[i] <= 0 ) || ( h->Offset[i] % (int64_t)sizeof(double) ) || ( h->Offset[i] > (int64_t)StatBuf.st_size )
+                || ( h->nvals[i] <= 0 ) || ( h->naxes[i] <= 0 ) || ( h->ncoeffs[i] <= 0 )
+                || ( h->nvals[i] > INT_MAX ) || ( h->naxes[i] > INT_MAX ) || ( h->ncoeffs[i] > INT_MAX )
+                || ( h->nvals[i] > n/( h->naxes[i]*h->ncoeffs[i] ) ) ) {
+            printf("Lgm_MapJPLephem: dataset %d is missing from %s\n", i, Filename );
+            munmap( Addr, (size_t)StatBuf.st_size );
+            return( -5 );
         }
+    }
 
-    /* get DEXXX specific info */
-    number_of_sets = Lgm_JPL_getNSets( objName, jpl);
-    number_of_axes = Lgm_JPL_getNAxes( objName, jpl);
-    coefficient_count = Lgm_JPL_getNCoeffs( objName, jpl);
+    /*
+     * Point the coefficient arrays into the mapping.
+     */
+    for ( i=0; i<LGM_DE_MAP_NDATASETS; i++ ) {
+        want = Lgm_JPL_MapDataSet( i, jpl, &a, &nvals, &naxes, &ncoeffs );
+        if ( !want ) continue;
+        *nvals = h->nvals[i]; *naxes = h->naxes[i]; *ncoeffs = h->ncoeffs[i];
+        Data   = (double *)((char *)Addr + h->Offset[i]);
+        LGM_ARRAY_FROM_DATA_3D( (*a), Data, *nvals, *naxes, *ncoeffs, double );
+    }
+    jpl->jalpha  = h->jalpha;
+    jpl->jomega  = h->jomega;
+    jpl->jdelta  = h->jdelta;
+    jpl->MapAddr = Addr;
+    jpl->MapSize = (long int)StatBuf.st_size;
+    jpl->Mapped  = TRUE;
+
+    if (jpl->verbosity > 1) {
+        printf("Mapped JPL definitive ephemeris from %s\n", Filename);
+    }
 
-    if ((number_of_sets == -1) || (number_of_axes == -1) || (coefficient_count == -1)) {
-        printf("Invalid number of sets (%d), axes (%d) or coeffs (%d) for object %d\n", number_of_sets, number_of_axes, coefficient_count, objName);
-        exit(-1);
+    return( 0 );
+
+}
+
+
+/*
+ *  Write the coefficients loaded in jpl to a file that Lgm_MapJPLephem() can
+ *  map. Typically done once, with all the bodies loaded from the HDF5 file.
+ *  Returns 0 on success.
+ */
+int Lgm_WriteJPLephemMap( char *Filename, Lgm_JPLephemInfo *jpl ) {
+
+    int                     i, *nvals, *naxes, *ncoeffs;
+    int64_t                 Offset, n;
+    double                  ****a;
+    FILE                    *fp;
+    Lgm_JPLephemMapHeader   h;
+
+    memset( &h, 0, sizeof(h) );
+    memcpy( h.Magic, LGM_DE_MAP_MAGIC, 8 );
+    h.Version    = LGM_DE_MAP_VERSION;
+    h.ByteOrder  = LGM_DE_MAP_BYTEORDER;
+    h.HeaderSize = (int32_t)sizeof(h);
+    h.DEnum      = jpl->DEnum;
+    h.nDataSets  = LGM_DE_MAP_NDATASETS;
+    h.jalpha     = jpl->jalpha;
+    h.jomega     = jpl->jomega;
+    h.jdelta     = jpl->jdelta;
+
+    // Start the data on a page boundary (and keep every dataset 8 byte aligned).
+    Offset = 4096;
+    for ( i=0; i<LGM_DE_MAP_NDATASETS; i++ ) {
+        Lgm_JPL_MapDataSet( i, jpl, &a, &nvals, &naxes, &ncoeffs );
+        if ( *a == NULL ) continue;
+        h.nvals[i] = *nvals; h.naxes[i] = *naxes; h.ncoeffs[i] = *ncoeffs;
+        h.Offset[i] = Offset;
+        Offset += (int64_t)(*nvals) * (*naxes) * (*ncoeffs) * (int64_t)sizeof(double);
+    }
+
+    if ( ( fp = fopen( Filename, "wb" ) ) == NULL ) {
+        printf("Lgm_WriteJPLephemMap: could not open %s for writing\n", Filename );
+        return( -1 );
+    }
+    if ( ( fwrite( &h, sizeof(h), 1, fp ) != 1 ) || ( fseek( fp, 4096, SEEK_SET ) != 0 ) ) {
+        printf("Lgm_WriteJPLephemMap: error writing header to %s\n", Filename );
+        fclose( fp );
+        return( -2 );
+    }
+    for ( i=0; i<LGM_DE_MAP_NDATASETS; i++ ) {
+        if ( h.Offset[i] == 0 ) continue;
+        Lgm_JPL_MapDataSet( i, jpl, &a, &nvals, &naxes, &ncoeffs );
+        n = h.nvals[i]*h.naxes[i]*h.ncoeffs[i];
+        if ( fwrite( &(*a)[0][0][0], sizeof(double), (size_t)n, fp ) != (size_t)n ) {
+            printf("Lgm_WriteJPLephemMap: error writing dataset %d to %s\n", i, Filename );
+            fclose( fp );
+            return( -3 );
         }
-    days_per_set = (jpl->jomega - jpl->jalpha) / number_of_sets;
-    cheby = Lgm_JPL_getCoeffSet(objName, jpl);
+    }
+
+    return( ( fclose( fp ) == 0 ) ? 0 : -4 );
+
+}
+
+
+/*
+ *  Returns the process-wide DE421 (Sun and Earth-Moon) ephemeris used by
+ *  Lgm_Set_Coord_Transforms() when ephModel is LGM_EPH_DE. The coefficients
+ *  are only read on the first call and are never modified afterwards, so every
+ *  Lgm_CTrans structure (in every thread) can point at the same copy.
+ *  Lgm_FreeJPLephemInfo() ignores it.
+ */
+static Lgm_JPLephemInfo     Lgm_SharedJPLephemInfo;
+static volatile int         Lgm_SharedJPLephemLoaded = FALSE;
+
+Lgm_JPLephemInfo *Lgm_SharedJPLephem( void ) {
+
+    if ( !Lgm_SharedJPLephemLoaded ) {
+        #if USE_OPENMP
+        #pragma omp critical (Lgm_SharedJPLephem)
+        #endif
+        {
+            if ( !Lgm_SharedJPLephemLoaded ) {
+                Lgm_InitJPLephDefaults( 421, LGM_DE_SUN|LGM_DE_EARTHMOON, 1, &Lgm_SharedJPLephemInfo );
+                Lgm_ReadJPLephem( &Lgm_SharedJPLephemInfo );
+                Lgm_SharedJPLephemInfo.Shared = TRUE;
+                #if USE_OPENMP
+                #pragma omp flush
+                #endif
+                Lgm_SharedJPLephemLoaded = TRUE;
+            }
+        }
+    }
+
+    return( &Lgm_SharedJPLephemInfo );
+
+}
+
+
+/*
+ *  Index of the set (record) of Chebyshev coefficients that covers tdb, and
+ *  the offset of tdb from the start of the record (days). At the very end of
+ *  the ephemeris we roll back to the last record.
+ */
+static int Lgm_JPL_SetIndex( double tdb, double days_per_set, int number_of_sets, Lgm_JPLephemInfo *jpl, double *offset ) {
+
+    int    index;
+    double vx, wx, div, mod, floordiv;
 
     /* borrow divmod implementation from Python to get index and offset */
     vx = tdb - jpl->jalpha;
@@ -242,17 +476,48 @@ void Lgm_JPLephem_setup_object( int objName, Lgm_JPLephemInfo *jpl, Lgm_JPLephem
         floordiv = div * vx / wx; /* zero w/ sign of vx/wx */
     }
     index = (int)floordiv;
-    offset = mod;
+    *offset = mod;
 
-    /* extract right set of Chebyshev coefficients */
-    omegas = (index==number_of_sets) ? 1 : 0;
     /* if at the end of the interval, roll back to the last set of coefficients and add offset */
-    index = (omegas) ? index-1 : index;
-    offset = (omegas) ? offset+days_per_set : offset;
+    if ( index == number_of_sets ) {
+        --index;
+        *offset += days_per_set;
+    }
+
+    return( index );
+
+}
+
+
+void Lgm_JPLephem_setup_object( int objName, Lgm_JPLephemInfo *jpl, Lgm_JPLephemBundle *bundle ) {
+    
+    double days_per_set, offset, tdb;
+    int    index, number_of_sets, number_of_axes, coefficient_count;
+    int    ii, jj;
+    double t1, twot1;
+    double *T, ***cheby, **coefficients;
+
+    tdb = bundle->tdb;
+    if ((tdb < jpl->jalpha) || (tdb > jpl->jomega)) { 
+        printf("Time (JD) is %15.8lf but must be between %15.8lf and %15.8lf\n", tdb, jpl->jalpha, jpl->jomega);
+        exit(-1);
+        }
+
+    /* get DEXXX specific info */
+    number_of_sets = Lgm_JPL_getNSets( objName, jpl);
+    number_of_axes = Lgm_JPL_getNAxes( objName, jpl);
+    coefficient_count = Lgm_JPL_getNCoeffs( objName, jpl);
+
+    if ((number_of_sets == -1) || (number_of_axes == -1) || (coefficient_count == -1)) {
+        printf("Invalid number of sets (%d), axes (%d) or coeffs (%d) for object %d\n", number_of_sets, number_of_axes, coefficient_count, objName);
+        exit(-1);
+        }
+    days_per_set = (jpl->jomega - jpl->jalpha) / number_of_sets;
+    cheby = Lgm_JPL_getCoeffSet(objName, jpl);
+
+    /* extract right set of Chebyshev coefficients */
+    index = Lgm_JPL_SetIndex( tdb, days_per_set, number_of_sets, jpl, &offset );
     
-    /* TODO: Check whether this can just be done with a straight assignment like
-     * coefficients = cheby[index];
-     */
     LGM_ARRAY_2D( coefficients, number_of_axes, coefficient_count, double );
     for (ii=0; ii<number_of_axes; ii++) {
         for (jj=0; jj<coefficient_count; jj++) {
@@ -299,142 +564,239 @@ void Lgm_FreeJPLephemBundle( Lgm_JPLephemBundle *bundle ) {
     }
 
 
-void Lgm_JPLephem_position( double tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_Vector *position) {
-    int i, j;
-    double dum;
-    Lgm_JPLephemBundle *bundle = Lgm_InitJPLephemBundle( tdb );
-
-    //if Earth (recursive)
-    if (objName==LGM_DE_EARTH) {
-        Lgm_Vector EMbary, MoonGCRF;
-        double earth_fac;
-        Lgm_JPLephem_position( tdb, LGM_DE_EARTHMOON, jpl, &EMbary);
-        Lgm_JPLephem_position( tdb, LGM_DE_MOON, jpl, &MoonGCRF);
-        
-        earth_fac = 1.0/(1.0+LGM_DE421_EMRAT); //TODO: fix hardcoding so that this is generic to any DEXXX loaded
-        position->x = EMbary.x - MoonGCRF.x * earth_fac;
-        position->y = EMbary.y - MoonGCRF.y * earth_fac;
-        position->z = EMbary.z - MoonGCRF.z * earth_fac;
-        }
-    else if (objName==LGM_DE_MOON_ICRF) {
-        Lgm_Vector EMbary, MoonGCRF;
-        double moon_fac;
-        Lgm_JPLephem_position( tdb, LGM_DE_EARTHMOON, jpl, &EMbary);
-        Lgm_JPLephem_position( tdb, LGM_DE_MOON, jpl, &MoonGCRF);
-        
-        moon_fac = LGM_DE421_EMRAT/(1.0+LGM_DE421_EMRAT); //TODO: fix hardcoding so that this is generic to any DEXXX loaded
-        position->x = EMbary.x + MoonGCRF.x * moon_fac;
-        position->y = EMbary.y + MoonGCRF.y * moon_fac;
-        position->z = EMbary.z + MoonGCRF.z * moon_fac;
+/*
+ *  Slot in an Lgm_JPLephemCache for a body that has its own coefficients.
+ */
+static int Lgm_JPL_CacheSlot( int objName ) {
+    if ( (objName == LGM_DE_SUN) || (objName == LGM_DE_EARTHMOON) ) return( objName-1 );
+    if ( (objName >= LGM_DE_MOON) && (objName <= LGM_DE_NUTATION) ) return( objName-LGM_DE_MOON+2 );
+    return( -1 );
+}
+
+
+/*
+ *  Forget any cached records (e.g. after the ephemeris they pointed into was
+ *  freed). A zeroed cache is also a valid, empty one.
+ */
+void Lgm_JPLephem_ResetCache( Lgm_JPLephemCache *cache ) {
+    int i;
+    cache->jpl = NULL;
+    for (i=0; i<LGM_DE_CACHE_SLOTS; i++) cache->Seg[i].index = -1;
+}
+
+
+/*
+ *  Find the record of Chebyshev coefficients for objName that covers tdb.
+ *  If seg already holds that record nothing needs to be looked up. Returns
+ *  the normalized time (-1 <= t <= 1) within the record.
+ */
+static double Lgm_JPL_GetSegment( double tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_JPLephemSegment *seg ) {
+
+    int    number_of_sets, number_of_axes, index;
+    double days_per_set, offset;
+
+    if ((tdb < jpl->jalpha) || (tdb > jpl->jomega)) { 
+        printf("Time (JD) is %15.8lf but must be between %15.8lf and %15.8lf\n", tdb, jpl->jalpha, jpl->jomega);
+        exit(-1);
         }
-    else {
-        //precalculate
-        Lgm_JPLephem_setup_object( objName, jpl, bundle );
 
-        //calculate positions
-        dum = 0;
-        for (i=0; i<bundle->coefficient_count; i++) {
-            dum += bundle->T[i] * bundle->coeffs[0][i];
-            }
-        position->x = dum;
+    if ( (seg->index < 0) || (tdb < seg->t0) || (tdb > seg->t0 + seg->days_per_set) ) {
 
-        dum = 0;
-        for (i=0; i<bundle->coefficient_count; i++) {
-            dum += bundle->T[i] * bundle->coeffs[1][i];
+        number_of_sets = Lgm_JPL_getNSets( objName, jpl);
+        number_of_axes = Lgm_JPL_getNAxes( objName, jpl);
+        seg->ncoeffs   = Lgm_JPL_getNCoeffs( objName, jpl);
+        if ((number_of_sets <= 0) || (number_of_axes < 3) || (seg->ncoeffs < 2) || (Lgm_JPL_getCoeffSet( objName, jpl ) == NULL)) {
+            printf("Invalid number of sets (%d), axes (%d) or coeffs (%d) for object %d\n", number_of_sets, number_of_axes, seg->ncoeffs, objName);
+            exit(-1);
             }
-        position->y = dum;
 
-        dum = 0;
-        for (i=0; i<bundle->coefficient_count; i++) {
-            dum += bundle->T[i] * bundle->coeffs[2][i];
-            }
-        position->z = dum;
+        days_per_set = (jpl->jomega - jpl->jalpha) / number_of_sets;
+        index = Lgm_JPL_SetIndex( tdb, days_per_set, number_of_sets, jpl, &offset );
+
+        seg->coeffs       = Lgm_JPL_getCoeffSet( objName, jpl )[index];
+        seg->index        = index;
+        seg->days_per_set = days_per_set;
+        seg->t0           = jpl->jalpha + index*days_per_set;
+
+    }
+
+    /*
+     *  Same expression whether or not the record was cached, so results
+     *  don't depend on the history of the cache.
+     */
+    offset = (tdb - jpl->jalpha) - seg->index*seg->days_per_set;
+
+    return( 2.0 * offset / seg->days_per_set - 1.0 );
+
+}
+
 
+/*
+ *  Clenshaw summation of the three Chebyshev series (x, y, z) at t, along
+ *  with (if v is not NULL) their derivatives w.r.t. t scaled by dtdx.
+ *
+ *      b_k  = c_k + 2 t b_k+1 - b_k+2,                 f  = c_0 + t b_1 - b_2
+ *      b'_k = 2 b_k+1 + 2 t b'_k+1 - b'_k+2,           f' = b_1 + t b'_1 - b'_2
+ */
+static void Lgm_JPL_Clenshaw( double **c, int n, double t, double dtdx, Lgm_Vector *p, Lgm_Vector *v ) {
+
+    int     k;
+    double  twot = t + t, tmp;
+    double  bx1=0.0, bx2=0.0, by1=0.0, by2=0.0, bz1=0.0, bz2=0.0;
+    double  dx1=0.0, dx2=0.0, dy1=0.0, dy2=0.0, dz1=0.0, dz2=0.0;
+    double  *cx = c[0], *cy = c[1], *cz = c[2];
+
+    if ( v == NULL ) {
+        for (k=n-1; k>=1; k--) {
+            tmp = cx[k] + twot*bx1 - bx2; bx2 = bx1; bx1 = tmp;
+            tmp = cy[k] + twot*by1 - by2; by2 = by1; by1 = tmp;
+            tmp = cz[k] + twot*bz1 - bz2; bz2 = bz1; bz1 = tmp;
         }
-    Lgm_FreeJPLephemBundle( bundle );
+    } else {
+        for (k=n-1; k>=1; k--) {
+            tmp = 2.0*bx1 + twot*dx1 - dx2; dx2 = dx1; dx1 = tmp;
+            tmp = 2.0*by1 + twot*dy1 - dy2; dy2 = dy1; dy1 = tmp;
+            tmp = 2.0*bz1 + twot*dz1 - dz2; dz2 = dz1; dz1 = tmp;
+            tmp = cx[k] + twot*bx1 - bx2; bx2 = bx1; bx1 = tmp;
+            tmp = cy[k] + twot*by1 - by2; by2 = by1; by1 = tmp;
+            tmp = cz[k] + twot*bz1 - bz2; bz2 = bz1; bz1 = tmp;
+        }
+        v->x = (bx1 + t*dx1 - dx2)*dtdx;
+        v->y = (by1 + t*dy1 - dy2)*dtdx;
+        v->z = (bz1 + t*dz1 - dz2)*dtdx;
     }
 
-void Lgm_JPL_getSunVector ( double tdb, Lgm_JPLephemInfo *jpl, Lgm_Vector *position ) {
-    Lgm_Vector EarthICRF, SunICRF;
-    // get positions of Sun & Earth
-    Lgm_JPLephem_position( tdb, LGM_DE_EARTH, jpl, &EarthICRF);
-    Lgm_JPLephem_position( tdb, LGM_DE_SUN, jpl, &SunICRF);
+    if ( p != NULL ) {
+        p->x = cx[0] + t*bx1 - bx2;
+        p->y = cy[0] + t*by1 - by2;
+        p->z = cz[0] + t*bz1 - bz2;
+    }
 
-    // Calculate Earth-Sun vector 
-    position->x = SunICRF.x - EarthICRF.x;
-    position->y = SunICRF.y - EarthICRF.y;
-    position->z = SunICRF.z - EarthICRF.z;
+}
+
+
+/*
+ *  Position/velocity of a body that has its own coefficients.
+ */
+static void Lgm_JPL_EvalObject( double tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_JPLephemCache *cache, Lgm_Vector *p, Lgm_Vector *v ) {
+
+    int                 slot;
+    double              t;
+    Lgm_JPLephemSegment seg, *s;
+
+    slot = Lgm_JPL_CacheSlot( objName );
+    if ( slot < 0 ) {
+        printf("Invalid object %d\n", objName);
+        exit(-1);
+    }
+
+    if ( cache != NULL ) {
+        if ( cache->jpl != jpl ) {
+            Lgm_JPLephem_ResetCache( cache );
+            cache->jpl = jpl;
+        }
+        s = &cache->Seg[slot];
+    } else {
+        seg.index = -1;
+        s = &seg;
     }
 
+    t = Lgm_JPL_GetSegment( tdb, objName, jpl, s );
+    Lgm_JPL_Clenshaw( s->coeffs, s->ncoeffs, t, 2.0/s->days_per_set, p, v ); // velocity in km/day
 
-void Lgm_JPLephem_velocity( double tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_Vector *velocity) {
-    int i, j, ii;
-    double *dT;
-    double dum;
-    Lgm_JPLephemBundle *bundle = Lgm_InitJPLephemBundle( tdb );
-
-    //if Earth (recursive)
-    if (objName==LGM_DE_EARTH) {
-        Lgm_Vector EMbary, MoonGCRF;
-        double earth_fac;
-        Lgm_JPLephem_velocity( tdb, LGM_DE_EARTHMOON, jpl, &EMbary);
-        Lgm_JPLephem_velocity( tdb, LGM_DE_MOON, jpl, &MoonGCRF);
-        
-        earth_fac = 1.0/(1.0+LGM_DE421_EMRAT); //TODO: fix hardcoding so that this is generic to any DEXXX loaded
-        velocity->x = EMbary.x - MoonGCRF.x * earth_fac;
-        velocity->y = EMbary.y - MoonGCRF.y * earth_fac;
-        velocity->z = EMbary.z - MoonGCRF.z * earth_fac;
+}
+
+
+/*
+ *  Position (km) and/or velocity (km/day) of objName at tdb (JD). Either of
+ *  position or velocity may be NULL. The cache remembers the current record
+ *  for each body so that nearby times don't have to look it up again; it may
+ *  be NULL. A cache must not be used by more than one thread at a time (the
+ *  ephemeris itself can be).
+ */
+void Lgm_JPLephem_state( double tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_JPLephemCache *cache, Lgm_Vector *position, Lgm_Vector *velocity ) {
+
+    Lgm_Vector  pEMB, vEMB, pMoon, vMoon, *pe, *ve, *pm, *vm;
+    double      fac;
+
+    if ( (objName == LGM_DE_EARTH) || (objName == LGM_DE_MOON_ICRF) ) {
+
+        // Earth and Moon (ICRF) from the Earth-Moon barycenter and the geocentric Moon.
+        pe = (position) ? &pEMB : NULL; ve = (velocity) ? &vEMB : NULL;
+        pm = (position) ? &pMoon : NULL; vm = (velocity) ? &vMoon : NULL;
+        Lgm_JPL_EvalObject( tdb, LGM_DE_EARTHMOON, jpl, cache, pe, ve );
+        Lgm_JPL_EvalObject( tdb, LGM_DE_MOON, jpl, cache, pm, vm );
+
+        //TODO: fix hardcoding so that this is generic to any DEXXX loaded
+        fac = (objName == LGM_DE_EARTH) ? -1.0/(1.0+LGM_DE421_EMRAT) : LGM_DE421_EMRAT/(1.0+LGM_DE421_EMRAT);
+        if ( position ) {
+            position->x = pEMB.x + pMoon.x * fac;
+            position->y = pEMB.y + pMoon.y * fac;
+            position->z = pEMB.z + pMoon.z * fac;
         }
-    else if (objName==LGM_DE_MOON_ICRF) {
-        Lgm_Vector EMbary, MoonGCRF;
-        double moon_fac;
-        Lgm_JPLephem_velocity( tdb, LGM_DE_EARTHMOON, jpl, &EMbary);
-        Lgm_JPLephem_velocity( tdb, LGM_DE_MOON, jpl, &MoonGCRF);
-        
-        moon_fac = LGM_DE421_EMRAT/(1.0+LGM_DE421_EMRAT); //TODO: fix hardcoding so that this is generic to any DEXXX loaded
-        velocity->x = EMbary.x + MoonGCRF.x * moon_fac;
-        velocity->y = EMbary.y + MoonGCRF.y * moon_fac;
-        velocity->z = EMbary.z + MoonGCRF.z * moon_fac;
+        if ( velocity ) {
+            velocity->x = vEMB.x + vMoon.x * fac;
+            velocity->y = vEMB.y + vMoon.y * fac;
+            velocity->z = vEMB.z + vMoon.z * fac;
         }
-    else {
-        //precalculate
-        Lgm_JPLephem_setup_object( objName, jpl, bundle );
-        /* Chebyshev derivative */
-        LGM_ARRAY_1D( dT, bundle->coefficient_count, double );
-        dT[0] = 0.0;
-        dT[1] = 1.0;
-        dT[2] = bundle->twot1 + bundle->twot1;
-        for (ii=3; ii<bundle->coefficient_count; ii++) {
-            dT[ii] = bundle->twot1 * dT[ii-1] - dT[ii-2] + bundle->T[ii-1] + bundle->T[ii-1];
-            }
-        for (ii=0; ii<bundle->coefficient_count; ii++) {
-            dT[ii] *= 2.0;
-            dT[ii] /= bundle->days_per_set; //puts units to km/day
-            }
 
-        //calculate velocities
-        dum = 0;
-        for (i=0; i<bundle->coefficient_count; i++) {
-            dum += dT[i] * bundle->coeffs[0][i];
-            }
-        velocity->x = dum;
+    } else {
 
-        dum = 0;
-        for (i=0; i<bundle->coefficient_count; i++) {
-            dum += dT[i] * bundle->coeffs[1][i];
-            }
-        velocity->y = dum;
+        Lgm_JPL_EvalObject( tdb, objName, jpl, cache, position, velocity );
 
-        dum = 0;
-        for (i=0; i<bundle->coefficient_count; i++) {
-            dum += dT[i] * bundle->coeffs[2][i];
-            }
-        velocity->z = dum;
+    }
 
-        }
-    Lgm_FreeJPLephemBundle( bundle );
+}
+
+
+/*
+ *  Lgm_JPLephem_state() at n times. Consecutive times that fall in the same
+ *  record reuse it, so it pays to have the times sorted. Either of position
+ *  or velocity may be NULL.
+ */
+void Lgm_JPLephem_state_array( int n, double *tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_Vector *position, Lgm_Vector *velocity ) {
+
+    int                 i;
+    Lgm_JPLephemCache   cache;
+
+    Lgm_JPLephem_ResetCache( &cache );
+    for (i=0; i<n; i++) {
+        Lgm_JPLephem_state( tdb[i], objName, jpl, &cache, (position) ? &position[i] : NULL, (velocity) ? &velocity[i] : NULL );
+    }
+
+}
+
+
+void Lgm_JPLephem_position( double tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_Vector *position) {
+    Lgm_JPLephem_state( tdb, objName, jpl, NULL, position, NULL );
+    }
+
+void Lgm_JPLephem_velocity( double tdb, int objName, Lgm_JPLephemInfo *jpl, Lgm_Vector *velocity) {
+    Lgm_JPLephem_state( tdb, objName, jpl, NULL, NULL, velocity );
+    }
+
+void Lgm_JPL_getSunVector ( double tdb, Lgm_JPLephemInfo *jpl, Lgm_Vector *position ) {
+    Lgm_JPLephemCache cache;
+    Lgm_JPLephem_ResetCache( &cache );
+    Lgm_JPL_getSunVector_cached( tdb, jpl, &cache, position );
+    }
+
+/*
+ *  Earth-Sun vector (km) using (and updating) a caller-owned cache.
+ */
+void Lgm_JPL_getSunVector_cached( double tdb, Lgm_JPLephemInfo *jpl, Lgm_JPLephemCache *cache, Lgm_Vector *position ) {
+    Lgm_Vector EarthICRF, SunICRF;
+    // get positions of Sun & Earth
+    Lgm_JPLephem_state( tdb, LGM_DE_EARTH, jpl, cache, &EarthICRF, NULL );
+    Lgm_JPLephem_state( tdb, LGM_DE_SUN, jpl, cache, &SunICRF, NULL );
+
+    // Calculate Earth-Sun vector 
+    position->x = SunICRF.x - EarthICRF.x;
+    position->y = SunICRF.y - EarthICRF.y;
+    position->z = SunICRF.z - EarthICRF.z;
     }
 
+
 int Lgm_JPL_getNSets( int objName, Lgm_JPLephemInfo *jpl) {
     int nvals;
     switch (objName) {
@@ -410,6 +410,9 @@ void Lgm_WriteMagEphemHeaderHdf( hid_t file, char *CodeVersion, char *ExtModel,
     status  = H5Dclose( DataSet );
     status  = H5Tclose( atype );
 
+    // Create InputFingerprint Dataset
+    Lgm_CreateMagEphemInputFingerprintHdf( file );
+
 
 
     // Create Kp Dataset
@@ -1100,6 +1103,41 @@ void Lgm_WriteMagEphemHeaderHdf( hid_t file, char *CodeVersion, char *ExtModel,
 }
 
 
+/*
+ *  Creates the InputFingerprint dataset. This holds a hash of the model inputs
+ *  (TLE, Qin-Denton values, models, quality, etc.) that each row was computed
+ *  from, so that an update can tell which rows need to be recomputed. It is
+ *  split out from Lgm_WriteMagEphemHeaderHdf() so that it can be added to
+ *  files that were created before it existed. Returns 0 on success and -1 if
+ *  the dataset could not be created or closed.
+ */
+int Lgm_CreateMagEphemInputFingerprintHdf( hid_t file ) {
+
+    herr_t          status = 0;
+    hid_t           space;
+    hid_t           atype;
+    hid_t           DataSet;
+
+    atype = CreateStrType( 32 );
+    DataSet = CreateExtendableRank1DataSet( file, "InputFingerprint", atype, &space );
+    if ( DataSet < 0 ) {
+        printf("Lgm_CreateMagEphemInputFingerprintHdf: Could not create the InputFingerprint dataset\n");
+        H5Sclose( space );
+        H5Tclose( atype );
+        return( -1 );
+    }
+    Lgm_WriteStringAttr( DataSet, "DESCRIPTION", "Hash (64-bit FNV-1a, in hex) of the model inputs used to compute each row. Empty if unknown." );
+    Lgm_WriteStringAttr( DataSet, "DEPEND_0",   "IsoTime" );
+    Lgm_WriteStringAttr( DataSet, "VAR_TYPE",   "data" );
+    if ( H5Sclose( space )   < 0 ) status = -1;
+    if ( H5Dclose( DataSet ) < 0 ) status = -1;
+    if ( H5Tclose( atype )   < 0 ) status = -1;
+    if ( status < 0 ) printf("Lgm_CreateMagEphemInputFingerprintHdf: Could not close the InputFingerprint dataset\n");
+
+    return( status );
+
+}
+
 void Lgm_WriteMagEphemDataHdf( hid_t file, int iRow, int i, Lgm_MagEphemData *med ) {
 
     hid_t   atype;
@@ -1115,6 +1153,7 @@ void Lgm_WriteMagEphemDataHdf( hid_t file, int iRow, int i, Lgm_MagEphemData *me
     LGM_HDF5_EXTEND_RANK1_DATASET( file, "FieldLineType",     iRow,                  atype,             &med->H5_FieldLineType[i][0] );    // Write H5_FieldLineType
     LGM_HDF5_EXTEND_RANK1_DATASET( file, "IntModel",          iRow,                  atype,             &med->H5_IntModel[i][0] );         // Write IntModel
     LGM_HDF5_EXTEND_RANK1_DATASET( file, "ExtModel",          iRow,                  atype,             &med->H5_ExtModel[i][0] );         // Write ExtModel
+    LGM_HDF5_EXTEND_RANK1_DATASET( file, "InputFingerprint",  iRow,                  atype,             &med->H5_InputFingerprint[i][0] ); // Write InputFingerprint
     status  = H5Tclose( atype );
 
     // Write Non-String variables
@@ -1202,3 +1241,73 @@ void Lgm_WriteMagEphemDataHdf( hid_t file, int iRow, int i, Lgm_MagEphemData *me
 
 
 }
+
+
+/*
+ *  64-bit FNV-1a hashing of the inputs that a row of MagEphem output depends
+ *  on. The fingerprint is stored with each row (as a hex string in the
+ *  "InputFingerprint" dataset) so that an update only has to recompute the
+ *  rows whose inputs have actually changed (e.g. when provisional
+ *  Kp/Qin-Denton values get replaced by definitive ones). Fingerprint must
+ *  have room for 17 chars.
+ */
+#define LGM_FNV_OFFSET_BASIS    0xcbf29ce484222325ULL
+#define LGM_FNV_PRIME           0x100000001b3ULL
+
+static unsigned long long FnvBytes( unsigned long long h, const void *buf, size_t n ) {
+    const unsigned char *b = (const unsigned char *)buf;
+    while ( n-- ) {
+        h ^= (unsigned long long)(*b++);
+        h *= LGM_FNV_PRIME;
+    }
+    return( h );
+}
+
+static unsigned long long FnvDouble( unsigned long long h, double x ) {
+    if ( x == 0.0 ) x = 0.0; // dont let -0.0 and 0.0 hash differently.
+    return( FnvBytes( h, &x, sizeof(double) ) );
+}
+
+static unsigned long long FnvInt( unsigned long long h, int n ) {
+    return( FnvBytes( h, &n, sizeof(int) ) );
+}
+
+static unsigned long long FnvStr( unsigned long long h, char *Str ) {
+    return( FnvBytes( h, Str, strlen( Str )+1 ) );
+}
+
+void Lgm_MagEphemInputFingerprint( char *Fingerprint, _SgpTLE *tle, Lgm_QinDentonOne *p, char *IntModel, char *ExtModel, int Quality, int nFLsInDriftShell,
+                                   double ForceKp, double FootpointHeight, int nAlpha, double *Alpha, int UseEop ) {
+
+    int                 i;
+    unsigned long long  h = LGM_FNV_OFFSET_BASIS;
+
+    // The TLE used.
+    h = FnvDouble( h, tle->JD );
+    h = FnvStr( h, tle->Line1 );
+    h = FnvStr( h, tle->Line2 );
+
+    // The Qin-Denton values used.
+    h = FnvDouble( h, p->ByIMF ); h = FnvDouble( h, p->BzIMF ); h = FnvDouble( h, p->V_SW ); h = FnvDouble( h, p->Den_P ); h = FnvDouble( h, p->Pdyn );
+    h = FnvDouble( h, p->G1 ); h = FnvDouble( h, p->G2 ); h = FnvDouble( h, p->G3 );
+    h = FnvInt( h, p->ByIMF_status ); h = FnvInt( h, p->BzIMF_status ); h = FnvInt( h, p->V_SW_status ); h = FnvInt( h, p->Den_P_status ); h = FnvInt( h, p->Pdyn_status );
+    h = FnvInt( h, p->G1_status ); h = FnvInt( h, p->G2_status ); h = FnvInt( h, p->G3_status );
+    h = FnvDouble( h, p->fKp ); h = FnvDouble( h, p->akp3 ); h = FnvDouble( h, p->Dst );
+    h = FnvDouble( h, p->Bz1 ); h = FnvDouble( h, p->Bz2 ); h = FnvDouble( h, p->Bz3 ); h = FnvDouble( h, p->Bz4 ); h = FnvDouble( h, p->Bz5 ); h = FnvDouble( h, p->Bz6 );
+    h = FnvDouble( h, p->W1 ); h = FnvDouble( h, p->W2 ); h = FnvDouble( h, p->W3 ); h = FnvDouble( h, p->W4 ); h = FnvDouble( h, p->W5 ); h = FnvDouble( h, p->W6 );
+    h = FnvInt( h, p->W1_status ); h = FnvInt( h, p->W2_status ); h = FnvInt( h, p->W3_status ); h = FnvInt( h, p->W4_status ); h = FnvInt( h, p->W5_status ); h = FnvInt( h, p->W6_status );
+
+    // The models and how they were used.
+    h = FnvStr( h, IntModel );
+    h = FnvStr( h, ExtModel );
+    h = FnvInt( h, Quality );
+    h = FnvInt( h, nFLsInDriftShell );
+    h = FnvDouble( h, ForceKp );
+    h = FnvDouble( h, FootpointHeight );
+    h = FnvInt( h, UseEop );
+    h = FnvInt( h, nAlpha );
+    for ( i=0; i<nAlpha; i++ ) h = FnvDouble( h, Alpha[i] );
+
+    sprintf( Fingerprint, "%016llx", h );
+
+}
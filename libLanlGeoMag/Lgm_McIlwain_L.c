@@ -14,10 +14,14 @@
 #include "Lgm/Lgm_MagModelInfo.h"                                                                                                                                                                                
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#if USE_OPENMP
+#include <omp.h>
+#endif
 
 
 /*
@@ -26,6 +30,188 @@
  */
 
 
+/*
+ *  The part of Lgm_McIlwain_L() that comes after Lgm_Trace() has found a
+ *  closed field line (with its min-B point at v3): find the mirror points for
+ *  Alpha and compute I, Bm and L. mInfo->Blocal and mInfo->Bm must be set.
+ */
+static double Lgm_McIlwain_L_ClosedFL( Lgm_Vector *u, Lgm_Vector *v3, double Alpha, int Type, double *I, double *Bm, double *M, Lgm_MagModelInfo *mInfo ) {
+
+    int             reset;
+    Lgm_Vector      Bvec, Bvectmp, Ptmp, u_scale;
+    double          rat, B, dSa, dSb, r, SS, L, stmp, Hdid, Hnext, Btmp;
+
+    u_scale.x = u_scale.y = u_scale.z = 1.0;
+    L = LGM_FILL_VALUE;
+
+
+    /*
+     *  Test to see if the S/C is already close to the Bmin point or the
+     *  B's are almost the same; And the Pitch angle is close to 90.  If
+     *  so, use an approximation to I.
+     */
+    if ( ( ((SS=Lgm_VecDiffMag( u, v3 )) < 1e-4) || (fabs( mInfo->Blocal - mInfo->Bmin) < 1e-2) ) && (fabs(90.0-Alpha) < 1e-2)  ) {
+
+        // if FL length is small, use an approx expression for I
+        rat = mInfo->Bmin/mInfo->Bm;
+        if ((1.0-rat) < 0.0) {
+            *I = 0.0;
+        } else {
+            // Eqn 2.66b in Roederer
+            *I = SS*sqrt(1.0 - rat);
+        }
+
+    } else {
+
+
+        /*
+         * Trace from Bmin point up to northern mirror point and down to
+         * southern mirror point. dSa and dSb are the distances along the
+         * FL from the starting points point. So dSa is from the Bmin value.
+         * And dSb is from the Psouth value.
+         */
+        if ( Lgm_TraceToMirrorPoint( &(mInfo->Pmin), &(mInfo->Pm_South), &dSa, mInfo->Bm, -1.0, mInfo->Lgm_TraceToMirrorPoint_Tol, mInfo ) >= 0 ) {
+
+            if (mInfo->VerbosityLevel > 0) {
+                printf("\n\tMin-B  Point Location, Pmin (Re):      < %g, %g, %g >\n", mInfo->Pmin.x, mInfo->Pmin.y, mInfo->Pmin.z );
+                printf("\tMirror Point Location, Pm_South (Re):      < %g, %g, %g >  |Pm_South| = %g\n", mInfo->Pm_South.x, mInfo->Pm_South.y, mInfo->Pm_South.z, Lgm_Magnitude(&mInfo->Pm_South) );
+                mInfo->Bfield( &mInfo->Pm_South, &Bvec, mInfo );
+                B = Lgm_Magnitude( &Bvec );
+                printf("\tMag. Field Strength, Bm at Pm_South (nT):  %g     (mInfo->Bm = %g)\n", B, mInfo->Bm );
+            }
+
+
+
+            if ( Lgm_TraceToMirrorPoint( &(mInfo->Pmin), &(mInfo->Pm_North), &dSb, mInfo->Bm,  1.0, mInfo->Lgm_TraceToMirrorPoint_Tol, mInfo ) >= 0 ) {
+
+                if (mInfo->VerbosityLevel > 0) {
+                    printf("\n\tMin-B  Point Location, Pmin (Re):      < %g, %g, %g >\n", mInfo->Pmin.x, mInfo->Pmin.y, mInfo->Pmin.z );
+                    printf("\tMirror Point Location, Pm_North (Re):      < %g, %g, %g >  |Pm_North| = %g\n", mInfo->Pm_North.x, mInfo->Pm_North.y, mInfo->Pm_North.z, Lgm_Magnitude(&mInfo->Pm_North) );
+                    mInfo->Bfield( &mInfo->Pm_North, &Bvec, mInfo );
+                    B = Lgm_Magnitude( &Bvec );
+                    printf("\tMag. Field Strength, Bm at Pm_North (nT):  %g     (mInfo->Bm = %g)\n", B, mInfo->Bm );
+                }
+
+                /*
+                 *  Set the limits of integration. Define s=0 at the sourthern mirror point. Then, sm_North will just be dSb
+                 */
+                //SS = dSb;
+                SS = dSa+dSb;
+                mInfo->Hmax = SS/(double)mInfo->nDivs;
+                if ( mInfo->Hmax > mInfo->MaxDiv ) mInfo->Hmax = mInfo->MaxDiv;
+                r  = Lgm_Magnitude( &mInfo->Pm_North );
+                mInfo->Sm_South = 0.0;
+                mInfo->Sm_North = SS;
+
+                if ( SS <= 1e-5 ) {
+
+                    // if FL length is small, use an approx expression for I
+                    rat = mInfo->Bmin/mInfo->Bm;
+                    if ((1.0-rat) < 0.0) {
+                        *I = 0.0;
+                    } else {
+                        // Eqn 2.66b in Roederer
+                        *I = SS*sqrt(1.0 - rat);
+                    }
+
+                } else if ( mInfo->UseInterpRoutines ) {
+                    if ( Lgm_TraceLine2( &(mInfo->Pm_South), &mInfo->Pm_North, (r-1.0)*Re, 0.5*SS-mInfo->Hmax, 1.0, mInfo->Lgm_TraceToEarth_Tol, FALSE, mInfo ) <= 0 ) return(LGM_FILL_VALUE);
+//printf("BEFORE mInfo->nPnts = %d   mInfo->s[0] = %g   mInfo->s[1] = %g    mInfo->s[mInfo->nPnts-2] = %g   mInfo->s[mInfo->nPnts-1] = %g    SS = %g\n", mInfo->nPnts, mInfo->s[0], mInfo->s[1], mInfo->s[mInfo->nPnts-2], mInfo->s[mInfo->nPnts-1], SS );
+                    ReplaceFirstPoint( 0.0, mInfo->Bm, &mInfo->Pm_South, mInfo );
+                    ReplaceLastPoint( SS, mInfo->Bm, &mInfo->Pm_North, mInfo );
+//printf("AFTER1 mInfo->nPnts = %d   mInfo->s[0] = %g   mInfo->s[1] = %g    mInfo->s[mInfo->nPnts-2] = %g   mInfo->s[mInfo->nPnts-1] = %g    SS = %g\n", mInfo->nPnts, mInfo->s[0], mInfo->s[1], mInfo->s[mInfo->nPnts-2], mInfo->s[mInfo->nPnts-1], SS );
+
+                    /*
+                     * Make sure we have a small margin before and after so
+                     * we dont end up trying to extrapolate if s ever gets
+                     * slightly out of bounds.
+                     */
+                    Ptmp = mInfo->Pm_South; stmp = 0.0; reset = FALSE;
+                    if ( Lgm_MagStep( &Ptmp, &u_scale, 0.01, &Hdid, &Hnext, -1.0, &stmp, &reset, mInfo->Bfield, mInfo ) < 0 ) { return(-1); }
+                    mInfo->Bfield( &Ptmp, &Bvectmp, mInfo ); Btmp = Lgm_Magnitude( &Bvectmp );
+                    //printf("-stmp, Btmp = %g %g\n", -stmp, Btmp );
+                    AddNewPoint( -stmp, Btmp, &Ptmp, mInfo );
+//printf("AFTER2 mInfo->nPnts = %d   mInfo->s[0] = %g   mInfo->s[1] = %g    mInfo->s[mInfo->nPnts-2] = %g   mInfo->s[mInfo->nPnts-1] = %g    SS = %g\n", mInfo->nPnts, mInfo->s[0], mInfo->s[1], mInfo->s[mInfo->nPnts-2], mInfo->s[mInfo->nPnts-1], SS );
+
+                    Ptmp = mInfo->Pm_North; stmp = 0.0; reset = FALSE;
+                    if ( Lgm_MagStep( &Ptmp, &u_scale, 0.01, &Hdid, &Hnext, 1.0, &stmp, &reset, mInfo->Bfield, mInfo ) < 0 ) { return(-1); }
+                    mInfo->Bfield( &Ptmp, &Bvectmp, mInfo ); Btmp = Lgm_Magnitude( &Bvectmp );
+                    //printf("stmp, Btmp = %g %g\n", SS+stmp, Btmp );
+                    AddNewPoint( SS+stmp, Btmp, &Ptmp, mInfo );
+
+                    
+                    
+                    
+
+//printf("AFTER2 mInfo->nPnts = %d   mInfo->s[0] = %g   mInfo->s[1] = %g    mInfo->s[mInfo->nPnts-2] = %g   mInfo->s[mInfo->nPnts-1] = %g    SS = %g\n", mInfo->nPnts, mInfo->s[0], mInfo->s[1], mInfo->s[mInfo->nPnts-2], mInfo->s[mInfo->nPnts-1], SS );
+                    //AddNewPoint( SS,  mInfo->Bm, &mInfo->Pm_North, mInfo );
+                    if ( InitSpline( mInfo ) ) {
+
+                        /*
+                         *  Do interped I integral.
+                         */
+                        *I = Iinv_interped( mInfo  );
+                        if (mInfo->VerbosityLevel > 0) printf("Lgm_McIlwain_L: Integral Invariant, I (interped):      %g\n",  *I );
+                        FreeSpline( mInfo );
+
+                    } else {
+
+                        *I = LGM_FILL_VALUE;
+
+                    }
+
+                } else {
+
+                    /*
+                     *  Do full blown I integral. (Integrand is evaluated by tracing to required s-values.)
+                     */
+                    *I = Iinv( mInfo  );
+                    if (mInfo->VerbosityLevel > 0) printf("Lgm_McIlwain_L: Integral Invariant, I (full integral): %g\n",  *I );
+
+                }
+
+            } else {
+                if (mInfo->VerbosityLevel > 0) printf("Could not find northern mirror point.\n");
+            }
+
+        } else {
+            if (mInfo->VerbosityLevel > 0) printf("Could not find southern mirror point.\n");
+        }
+
+    } 
+
+
+
+    /*
+     * Current time-dependant value of dipole moement (derived from first 3 vals of IGRF model)
+     */
+    *M = mInfo->c->M_cd;
+
+    /*
+     *  Bmirror value.
+     */
+    *Bm = mInfo->Bm;
+
+
+    /*
+     *  McIlwain L, via McIlwain's original tables or via Hilton approx.
+     */
+    if ( *I < 0.0 ){
+        L = LGM_FILL_VALUE;
+    } else if ( Type == 0 ) {
+        L = LFromIBmM_McIlwain( *I, *Bm, *M );
+    } else {
+        L = LFromIBmM_Hilton( *I, *Bm, *M );
+    }
+
+
+    return( L );
+
+}
+
+
+
+
 //! Compute McIlwain L-shell parameter for a given date, time, location and pitch angle.
 /**
  *            \param[in]        Date        Date in format (e.g. 20101231). 
@@ -43,14 +229,11 @@
  */
 double Lgm_McIlwain_L( long int Date, double UTC, Lgm_Vector *u, double Alpha, int Type, double *I, double *Bm, double *M, Lgm_MagModelInfo *mInfo ) {
 
-    int             reset;
-    Lgm_Vector      v1, v2, v3, Bvec, Bvectmp, Ptmp, u_scale;
-    double          rat, B, sa, sa2, Blocal, dSa, dSb, r, SS, L, stmp, Hdid, Hnext, Btmp;
+    Lgm_Vector      v1, v2, v3, Bvec;
+    double          sa, sa2, Blocal, L;
 
     if (mInfo->VerbosityLevel > 0) printf("Lgm_McIlwain_L: VerbosityLevel = %d\n", mInfo->VerbosityLevel);
 
-    u_scale.x = u_scale.y = u_scale.z = 1.0;
-
     *I  = LGM_FILL_VALUE;
     *Bm = LGM_FILL_VALUE;
     *M  = LGM_FILL_VALUE;
@@ -83,173 +266,115 @@ double Lgm_McIlwain_L( long int Date, double UTC, Lgm_Vector *u, double Alpha, i
      *  First do a trace to identify the FL type and some of its critical points.
      */
     if ( Lgm_Trace( u, &v1, &v2, &v3, mInfo->Lgm_LossConeHeight, mInfo->Lgm_TraceToEarth_Tol, mInfo->Lgm_TraceToBmin_Tol, mInfo ) == LGM_CLOSED ) {
+        L = Lgm_McIlwain_L_ClosedFL( u, &v3, Alpha, Type, I, Bm, M, mInfo );
+    }
 
 
-        /*
-         *  Test to see if the S/C is already close to the Bmin point or the
-         *  B's are almost the same; And the Pitch angle is close to 90.  If
-         *  so, use an approximation to I.
-         */
-        if ( ( ((SS=Lgm_VecDiffMag( u, &v3 )) < 1e-4) || (fabs( mInfo->Blocal - mInfo->Bmin) < 1e-2) ) && (fabs(90.0-Alpha) < 1e-2)  ) {
-
-            // if FL length is small, use an approx expression for I
-            rat = mInfo->Bmin/mInfo->Bm;
-            if ((1.0-rat) < 0.0) {
-                *I = 0.0;
-            } else {
-                // Eqn 2.66b in Roederer
-                *I = SS*sqrt(1.0 - rat);
-            }
-
-        } else {
-
-
-            /*
-             * Trace from Bmin point up to northern mirror point and down to
-             * southern mirror point. dSa and dSb are the distances along the
-             * FL from the starting points point. So dSa is from the Bmin value.
-             * And dSb is from the Psouth value.
-             */
-            if ( Lgm_TraceToMirrorPoint( &(mInfo->Pmin), &(mInfo->Pm_South), &dSa, mInfo->Bm, -1.0, mInfo->Lgm_TraceToMirrorPoint_Tol, mInfo ) >= 0 ) {
-
-                if (mInfo->VerbosityLevel > 0) {
-                    printf("\n\tMin-B  Point Location, Pmin (Re):      < %g, %g, %g >\n", mInfo->Pmin.x, mInfo->Pmin.y, mInfo->Pmin.z );
-                    printf("\tMirror Point Location, Pm_South (Re):      < %g, %g, %g >  |Pm_South| = %g\n", mInfo->Pm_South.x, mInfo->Pm_South.y, mInfo->Pm_South.z, Lgm_Magnitude(&mInfo->Pm_South) );
-                    mInfo->Bfield( &mInfo->Pm_South, &Bvec, mInfo );
-                    B = Lgm_Magnitude( &Bvec );
-                    printf("\tMag. Field Strength, Bm at Pm_South (nT):  %g     (mInfo->Bm = %g)\n", B, mInfo->Bm );
-                }
-
-
-
-                if ( Lgm_TraceToMirrorPoint( &(mInfo->Pmin), &(mInfo->Pm_North), &dSb, mInfo->Bm,  1.0, mInfo->Lgm_TraceToMirrorPoint_Tol, mInfo ) >= 0 ) {
-
-                    if (mInfo->VerbosityLevel > 0) {
-                        printf("\n\tMin-B  Point Location, Pmin (Re):      < %g, %g, %g >\n", mInfo->Pmin.x, mInfo->Pmin.y, mInfo->Pmin.z );
-                        printf("\tMirror Point Location, Pm_North (Re):      < %g, %g, %g >  |Pm_North| = %g\n", mInfo->Pm_North.x, mInfo->Pm_North.y, mInfo->Pm_North.z, Lgm_Magnitude(&mInfo->Pm_North) );
-                        mInfo->Bfield( &mInfo->Pm_North, &Bvec, mInfo );
-                        B = Lgm_Magnitude( &Bvec );
-                        printf("\tMag. Field Strength, Bm at Pm_North (nT):  %g     (mInfo->Bm = %g)\n", B, mInfo->Bm );
-                    }
-
-                    /*
-                     *  Set the limits of integration. Define s=0 at the sourthern mirror point. Then, sm_North will just be dSb
-                     */
-                    //SS = dSb;
-                    SS = dSa+dSb;
-                    mInfo->Hmax = SS/(double)mInfo->nDivs;
-                    if ( mInfo->Hmax > mInfo->MaxDiv ) mInfo->Hmax = mInfo->MaxDiv;
-                    r  = Lgm_Magnitude( &mInfo->Pm_North );
-                    mInfo->Sm_South = 0.0;
-                    mInfo->Sm_North = SS;
-
-                    if ( SS <= 1e-5 ) {
-
-                        // if FL length is small, use an approx expression for I
-                        rat = mInfo->Bmin/mInfo->Bm;
-                        if ((1.0-rat) < 0.0) {
-                            *I = 0.0;
-                        } else {
-                            // Eqn 2.66b in Roederer
-                            *I = SS*sqrt(1.0 - rat);
-                        }
-
-                    } else if ( mInfo->UseInterpRoutines ) {
-                        if ( Lgm_TraceLine2( &(mInfo->Pm_South), &mInfo->Pm_North, (r-1.0)*Re, 0.5*SS-mInfo->Hmax, 1.0, mInfo->Lgm_TraceToEarth_Tol, FALSE, mInfo ) <= 0 ) return(LGM_FILL_VALUE);
-//printf("BEFORE mInfo->nPnts = %d   mInfo->s[0] = %g   mInfo->s[1] = %g    mInfo->s[mInfo->nPnts-2] = %g   mInfo->s[mInfo->nPnts-1] = %g    SS = %g\n", mInfo->nPnts, mInfo->s[0], mInfo->s[1], mInfo->s[mInfo->nPnts-2], mInfo->s[mInfo->nPnts-1], SS );
-                        ReplaceFirstPoint( 0.0, mInfo->Bm, &mInfo->Pm_South, mInfo );
-                        ReplaceLastPoint( SS, mInfo->Bm, &mInfo->Pm_North, mInfo );
-//printf("AFTER1 mInfo->nPnts = %d   mInfo->s[0] = %g   mInfo->s[1] = %g    mInfo->s[mInfo->nPnts-2] = %g   mInfo->s[mInfo->nPnts-1] = %g    SS = %g\n", mInfo->nPnts, mInfo->s[0], mInfo->s[1], mInfo->s[mInfo->nPnts-2], mInfo->s[mInfo->nPnts-1], SS );
+    return( L );
 
-                        /*
-                         * Make sure we have a small margin before and after so
-                         * we dont end up trying to extrapolate if s ever gets
-                         * slightly out of bounds.
-                         */
-                        Ptmp = mInfo->Pm_South; stmp = 0.0; reset = FALSE;
-                        if ( Lgm_MagStep( &Ptmp, &u_scale, 0.01, &Hdid, &Hnext, -1.0, &stmp, &reset, mInfo->Bfield, mInfo ) < 0 ) { return(-1); }
-                        mInfo->Bfield( &Ptmp, &Bvectmp, mInfo ); Btmp = Lgm_Magnitude( &Bvectmp );
-                        //printf("-stmp, Btmp = %g %g\n", -stmp, Btmp );
-                        AddNewPoint( -stmp, Btmp, &Ptmp, mInfo );
-//printf("AFTER2 mInfo->nPnts = %d   mInfo->s[0] = %g   mInfo->s[1] = %g    mInfo->s[mInfo->nPnts-2] = %g   mInfo->s[mInfo->nPnts-1] = %g    SS = %g\n", mInfo->nPnts, mInfo->s[0], mInfo->s[1], mInfo->s[mInfo->nPnts-2], mInfo->s[mInfo->nPnts-1], SS );
+}
 
-                        Ptmp = mInfo->Pm_North; stmp = 0.0; reset = FALSE;
-                        if ( Lgm_MagStep( &Ptmp, &u_scale, 0.01, &Hdid, &Hnext, 1.0, &stmp, &reset, mInfo->Bfield, mInfo ) < 0 ) { return(-1); }
-                        mInfo->Bfield( &Ptmp, &Bvectmp, mInfo ); Btmp = Lgm_Magnitude( &Bvectmp );
-                        //printf("stmp, Btmp = %g %g\n", SS+stmp, Btmp );
-                        AddNewPoint( SS+stmp, Btmp, &Ptmp, mInfo );
 
-                        
-                        
-                        
 
-//printf("AFTER2 mInfo->nPnts = %d   mInfo->s[0] = %g   mInfo->s[1] = %g    mInfo->s[mInfo->nPnts-2] = %g   mInfo->s[mInfo->nPnts-1] = %g    SS = %g\n", mInfo->nPnts, mInfo->s[0], mInfo->s[1], mInfo->s[mInfo->nPnts-2], mInfo->s[mInfo->nPnts-1], SS );
-                        //AddNewPoint( SS,  mInfo->Bm, &mInfo->Pm_North, mInfo );
-                        if ( InitSpline( mInfo ) ) {
 
-                            /*
-                             *  Do interped I integral.
-                             */
-                            *I = Iinv_interped( mInfo  );
-                            if (mInfo->VerbosityLevel > 0) printf("Lgm_McIlwain_L: Integral Invariant, I (interped):      %g\n",  *I );
-                            FreeSpline( mInfo );
-
-                        } else {
+/*
+ *  Compute L, I and Bm for all of the pitch angles at one position, tracing
+ *  to the min-B point only once. mInfo is first put back to Start (the state
+ *  it was passed in with), and back to what that trace left (Save) before
+ *  each pitch angle, so that every L is exactly what Lgm_McIlwain_L() gives
+ *  (the ODE integrator state carries over from one trace to the next).
+ *  Returns the number of valid L values.
+ */
+static int Lgm_McIlwain_L_FL( Lgm_Vector *u, int nAlpha, double *Alpha, int Type, double *L, double *I, double *Bm,
+                                Lgm_MagModelInfo *Start, Lgm_MagModelInfo *Save, Lgm_MagModelInfo *mInfo ) {
 
-                            *I = LGM_FILL_VALUE;
+    int             k, nGood;
+    double          Blocal, sa, M;
+    Lgm_Vector      v1, v2, v3, Bvec;
 
-                        }
+    for ( k=0; k<nAlpha; k++ ) L[k] = I[k] = Bm[k] = LGM_FILL_VALUE;
 
-                    } else {
+    memcpy( mInfo, Start, sizeof(Lgm_MagModelInfo) );
+    mInfo->P_gsm = *u;
+    mInfo->Bfield( u, &Bvec, mInfo );
+    Blocal = Lgm_Magnitude( &Bvec );
+    mInfo->Blocal = Blocal;
 
-                        /*
-                         *  Do full blown I integral. (Integrand is evaluated by tracing to required s-values.)
-                         */
-                        *I = Iinv( mInfo  );
-                        if (mInfo->VerbosityLevel > 0) printf("Lgm_McIlwain_L: Integral Invariant, I (full integral): %g\n",  *I );
+    if ( Lgm_Trace( u, &v1, &v2, &v3, mInfo->Lgm_LossConeHeight, mInfo->Lgm_TraceToEarth_Tol, mInfo->Lgm_TraceToBmin_Tol, mInfo ) != LGM_CLOSED ) return( 0 );
+    memcpy( Save, mInfo, sizeof(Lgm_MagModelInfo) );
 
-                    }
+    nGood = 0;
+    for ( k=0; k<nAlpha; k++ ) {
 
-                } else {
-                    if (mInfo->VerbosityLevel > 0) printf("Could not find northern mirror point.\n");
-                }
+        if ( k > 0 ) memcpy( mInfo, Save, sizeof(Lgm_MagModelInfo) );
+        sa = sin( Alpha[k]*RadPerDeg );
+        mInfo->Bm = Blocal/(sa*sa);
+        L[k] = Lgm_McIlwain_L_ClosedFL( u, &v3, Alpha[k], Type, &I[k], &Bm[k], &M, mInfo );
+        if ( L[k] > 0.0 ) ++nGood;
 
-            } else {
-                if (mInfo->VerbosityLevel > 0) printf("Could not find southern mirror point.\n");
-            }
+    }
 
-        } 
+    return( nGood );
 
+}
 
 
-        /*
-         * Current time-dependant value of dipole moement (derived from first 3 vals of IGRF model)
-         */
-        *M = mInfo->c->M_cd;
 
-        /*
-         *  Bmirror value.
-         */
-        *Bm = mInfo->Bm;
+//! Compute McIlwain L-shell parameter for many pitch angles (and positions) at once.
+/**
+ *      This gives exactly the same results as calling Lgm_McIlwain_L() with
+ *      mInfo for each (position, pitch angle) pair, but each field line is
+ *      only traced to its min-B point once; the mirror points and I integral
+ *      are then found for each pitch angle as Lgm_McIlwain_L() finds them.
+ *      Positions on field lines that are not closed get fill values. The
+ *      positions are spread over threads if compiled with OpenMP.
+ *
+ *            \param[in]        Date        Date in format (e.g. 20101231).
+ *            \param[in]        UTC         Universal Time (Coordinated) in decimal hours (e.g. 23.5).
+ *            \param[in]        nPos        Number of positions.
+ *            \param[in]        u           Positions (in GSM) to compute L-shell at (nPos of them).
+ *            \param[in]        nAlpha      Number of pitch angles.
+ *            \param[in]        Alpha       Pitch angles to compute L for (nAlpha of them). In degrees.
+ *            \param[in]        Type        Flag to indicate which alogorithm to use (0=original McIlwain; else use Hilton's formula).
+ *            \param[out]       L           McIlwain L values, L[ n*nAlpha + k ] for position n and pitch angle k.
+ *            \param[out]       I           The integral invariants, I (same layout as L).
+ *            \param[out]       Bm          The mirror magnetic field values, Bm (same layout as L).
+ *            \param[out]       M           The dipole magnetic moment used to compute L = f(I, Bm, M)
+ *            \param[in,out]    mInfo       Properly initialized Lgm_MagModelInfo structure.
+ *
+ *            \return           The number of valid L values computed.
+ *
+ */
+int Lgm_McIlwain_L_Batch( long int Date, double UTC, int nPos, Lgm_Vector *u, int nAlpha, double *Alpha, int Type,
+                            double *L, double *I, double *Bm, double *M, Lgm_MagModelInfo *mInfo ) {
 
+    int                 n, nGood;
+    Lgm_MagModelInfo    *mInfo2, *Start, *Save;
 
-        /*
-         *  McIlwain L, via McIlwain's original tables or via Hilton approx.
-         */
-        if ( *I < 0.0 ){
-            L = LGM_FILL_VALUE;
-        } else if ( Type == 0 ) {
-            L = LFromIBmM_McIlwain( *I, *Bm, *M );
-        } else {
-            L = LFromIBmM_Hilton( *I, *Bm, *M );
+    Lgm_Set_Coord_Transforms( Date, UTC, mInfo->c );
+    *M = mInfo->c->M_cd;
+
+    nGood = 0;
+    #if USE_OPENMP
+    #pragma omp parallel private(mInfo2,Start,Save,n)
+    #endif
+    {
+        mInfo2 = Lgm_CopyMagInfo( mInfo );  // make a private (per-thread) copy of mInfo
+        Start  = (Lgm_MagModelInfo *)malloc( sizeof(Lgm_MagModelInfo) );
+        Save   = (Lgm_MagModelInfo *)malloc( sizeof(Lgm_MagModelInfo) );
+        memcpy( Start, mInfo2, sizeof(Lgm_MagModelInfo) );
+        #if USE_OPENMP
+        #pragma omp for schedule(dynamic,1) reduction(+:nGood)
+        #endif
+        for ( n=0; n<nPos; n++ ) {
+            nGood += Lgm_McIlwain_L_FL( &u[n], nAlpha, Alpha, Type, &L[n*nAlpha], &I[n*nAlpha], &Bm[n*nAlpha], Start, Save, mInfo2 );
         }
-
-
+        memcpy( mInfo2, Start, sizeof(Lgm_MagModelInfo) );
+        free( Start );
+        free( Save );
+        Lgm_FreeMagInfo( mInfo2 );
     }
 
-
-    return( L );
+    return( nGood );
 
 }
-
-
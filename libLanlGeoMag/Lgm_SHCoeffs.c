@@ -0,0 +1,406 @@
+/*! \file Lgm_SHCoeffs.c
+ *
+ *  \brief Internal field models of arbitrary degree from spherical harmonic coefficient sets.
+ *
+ *  The IGRF routines in Lgm_IGRF.c are hard-wired to degree 13 (double
+ *  g[14][14], etc.). The routines here work with a coefficient set
+ *  (Lgm_SHCoeffs) of any degree, e.g. IGRF (Lgm_SHCoeffs_IGRF()) or a high
+ *  degree core field model read from a standard .shc file (the format used by
+ *  CHAOS and by the IGRF .shc distribution; Lgm_SHCoeffs_ReadSHC()).
+ *
+ *  The field is evaluated in cartesian GEO coords with Schmidt
+ *  semi-normalized solid harmonics (the normalized analogue of the Cunningham
+ *  recursions used by Lgm_IGRF_Cart()). The normalized harmonics stay of
+ *  order (a/r)^(n+1), so there is no overflow at high degree. The gradient
+ *  terms are folded into a single O(N^2) coefficient array once per day (per
+ *  Lgm_CTrans) and each evaluation is then one sequential sweep through the
+ *  recursion constants and that array.
+ *
+ *  Example;
+ *
+ *      Lgm_SHCoeffs    *s = Lgm_SHCoeffs_ReadSHC( "CHAOS-7_core.shc" );
+ *
+ *      Lgm_Set_SHCoeffs( s, mInfo->c );    // LGM_IGRF now uses this model
+ *      ...
+ *      Lgm_Set_SHCoeffs( NULL, mInfo->c ); // back to the built-in IGRF
+ *      Lgm_SHCoeffs_Free( s );
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "Lgm/Lgm_CTrans.h"
+#include "Lgm/Lgm_SHCoeffs.h"
+
+
+
+/*
+ *  Ratio of Schmidt normalization factors, R_n1,m1 / R_n2,m2, where
+ *  R_n,m = sqrt( (2-delta_m0) (n-m)!/(n+m)! ). Done with log-gamma so that
+ *  it works at any degree.
+ */
+static double SchmidtRatio( int n1, int m1, int n2, int m2 ) {
+
+    double  l1, l2;
+
+    l1 = lgamma( (double)(n1-m1+1) ) - lgamma( (double)(n1+m1+1) ) + ( (m1 > 0) ? M_LN2 : 0.0 );
+    l2 = lgamma( (double)(n2-m2+1) ) - lgamma( (double)(n2+m2+1) ) + ( (m2 > 0) ? M_LN2 : 0.0 );
+
+    return( exp( 0.5*(l1 - l2) ) );
+
+}
+
+
+/**
+ *  Allocates a coefficient set for degree N with nEpochs epochs and
+ *  computes its recursion constants. The coefficients themselves (and the
+ *  Epoch[] values) are set to zero. RefRadius defaults to 6371.2 km (the
+ *  value used by IGRF and CHAOS).
+ */
+Lgm_SHCoeffs *Lgm_SHCoeffs_Alloc( int N, int nEpochs ) {
+
+    Lgm_SHCoeffs    *s;
+    int             n, m, k, NmM, NpM;
+
+    if ( (N < 1) || (nEpochs < 1) ) {
+        printf("Lgm_SHCoeffs_Alloc: Error, bad N or nEpochs ( N = %d, nEpochs = %d )\n", N, nEpochs );
+        return( NULL );
+    }
+
+    s = (Lgm_SHCoeffs *)calloc( 1, sizeof(Lgm_SHCoeffs) );
+    s->N         = N;
+    s->nCoeffs   = (N+1)*(N+2)/2;
+    s->nEpochs   = nEpochs;
+    s->RefRadius = 6371.2;
+    s->Epoch     = (double *)calloc( nEpochs, sizeof(double) );
+    s->g         = (double *)calloc( nEpochs*s->nCoeffs, sizeof(double) );
+    s->h         = (double *)calloc( nEpochs*s->nCoeffs, sizeof(double) );
+
+    /*
+     *  Recursion constants for the normalized solid harmonics
+     *
+     *      V_m,m = d_m ( x V_m-1,m-1 - y W_m-1,m-1 )/r^2
+     *      V_n,m = a_n,m z V_n-1,m/r^2 - b_n,m V_n-2,m/r^2
+     *
+     *  with d_1 = 1, d_m = sqrt( (2m-1)/(2m) ),
+     *  a_n,m = (2n-1)/sqrt( (n-m)(n+m) ) and
+     *  b_n,m = sqrt( (n+m-1)(n-m-1)/((n-m)(n+m)) ).
+     */
+    s->Off  = (int *)calloc( N+2, sizeof(int) );
+    s->Diag = (double *)calloc( N+2, sizeof(double) );
+    s->Rec  = (double *)calloc( 2*(N+2)*(N+3)/2, sizeof(double) );
+    for ( k=0, m=0; m<=N+1; ++m ) {
+        s->Off[m]  = k;
+        s->Diag[m] = ( m < 2 ) ? 1.0 : sqrt( (2.0*m-1.0)/(2.0*m) );
+        for ( n=m; n<=N+1; ++n, ++k ) {
+            if ( n > m ) {
+                NmM = n-m; NpM = n+m;
+                s->Rec[2*k]   = (2.0*n-1.0)/sqrt( (double)NmM*(double)NpM );
+                s->Rec[2*k+1] = sqrt( ((double)NpM-1.0)*((double)NmM-1.0)/((double)NmM*(double)NpM) );
+            }
+        }
+    }
+
+    return( s );
+
+}
+
+
+void Lgm_SHCoeffs_Free( Lgm_SHCoeffs *s ) {
+
+    if ( s == NULL ) return;
+    free( s->Epoch );
+    free( s->g );
+    free( s->h );
+    free( s->g_SV );
+    free( s->h_SV );
+    free( s->Off );
+    free( s->Rec );
+    free( s->Diag );
+    free( s );
+
+}
+
+
+/**
+ *  Reads a coefficient set from a file in the .shc format used by CHAOS and
+ *  by the IGRF .shc distribution:
+ *
+ *      # comment lines
+ *      N_min N_max N_times Spline_Order N_Step
+ *      t_1 t_2 ... t_N_times                   (decimal years)
+ *      n m c_1 c_2 ... c_N_times               (one line per coefficient)
+ *
+ *  where lines with m < 0 are the h_n^|m| coeffs. Coefficients for n <
+ *  N_min are left at zero. Between the listed times the coeffs are
+ *  interpolated linearly (exact for Spline_Order 2 files such as IGRF; for
+ *  higher order files the listed values are the spline evaluated at those
+ *  times, so N_Step should be small enough for linear interpolation to be
+ *  adequate).
+ *
+ *  Returns NULL on failure.
+ */
+Lgm_SHCoeffs *Lgm_SHCoeffs_ReadSHC( char *Filename ) {
+
+    Lgm_SHCoeffs    *s;
+    FILE            *fp;
+    int             ch, Nmin, Nmax, nTimes, Order, Step, n, m, e, nRead;
+    double          v;
+
+    if ( (fp = fopen( Filename, "r" )) == NULL ) {
+        printf("Lgm_SHCoeffs_ReadSHC: Could not open file %s\n", Filename );
+        return( NULL );
+    }
+
+    /*
+     *  Skip comment lines.
+     */
+    while ( (ch = fgetc( fp )) == '#' || ch == '\n' ) {
+        if ( ch == '#' ) while ( ((ch = fgetc( fp )) != '\n') && (ch != EOF) );
+    }
+    if ( ch == EOF ) {
+        printf("Lgm_SHCoeffs_ReadSHC: No data in file %s\n", Filename );
+        fclose( fp );
+        return( NULL );
+    }
+    ungetc( ch, fp );
+
+    if ( (fscanf( fp, "%d %d %d %d %d", &Nmin, &Nmax, &nTimes, &Order, &Step ) != 5) || (Nmax < 1) || (nTimes < 1) ) {
+        printf("Lgm_SHCoeffs_ReadSHC: Bad header line in file %s\n", Filename );
+        fclose( fp );
+        return( NULL );
+    }
+
+    s = Lgm_SHCoeffs_Alloc( Nmax, nTimes );
+    for ( e=0; e<nTimes; ++e ) {
+        if ( fscanf( fp, "%lf", &s->Epoch[e] ) != 1 ) {
+            printf("Lgm_SHCoeffs_ReadSHC: Bad list of times in file %s\n", Filename );
+            Lgm_SHCoeffs_Free( s );
+            fclose( fp );
+            return( NULL );
+        }
+    }
+
+    nRead = 0;
+    while ( fscanf( fp, "%d %d", &n, &m ) == 2 ) {
+        if ( (n < 1) || (n > Nmax) || (abs(m) > n) ) {
+            printf("Lgm_SHCoeffs_ReadSHC: Bad coefficient (n, m) = (%d, %d) in file %s\n", n, m, Filename );
+            Lgm_SHCoeffs_Free( s );
+            fclose( fp );
+            return( NULL );
+        }
+        for ( e=0; e<nTimes; ++e ) {
+            if ( fscanf( fp, "%lf", &v ) != 1 ) {
+                printf("Lgm_SHCoeffs_ReadSHC: Short coefficient line for (n, m) = (%d, %d) in file %s\n", n, m, Filename );
+                Lgm_SHCoeffs_Free( s );
+                fclose( fp );
+                return( NULL );
+            }
+            if ( m >= 0 ) {
+                s->g[ e*s->nCoeffs + LGM_SH_IDX( n, m ) ] = v;
+            } else {
+                s->h[ e*s->nCoeffs + LGM_SH_IDX( n, -m ) ] = v;
+            }
+        }
+        ++nRead;
+    }
+    fclose( fp );
+
+    if ( nRead != (Nmax+1)*(Nmax+1) - Nmin*Nmin ) {
+        printf("Lgm_SHCoeffs_ReadSHC: Warning, expected %d coefficients in file %s but got %d\n", (Nmax+1)*(Nmax+1) - Nmin*Nmin, Filename, nRead );
+    }
+
+    strncpy( s->Name, Filename, 79 );
+
+    return( s );
+
+}
+
+
+/**
+ *  Computes the coefficients at time Year (decimal years) into g[] and h[]
+ *  (each nCoeffs long). Between epochs the coeffs are interpolated linearly.
+ *  After the last epoch the secular variation is used if there is one
+ *  (otherwise the coeffs are held constant), and before the first epoch they
+ *  are extrapolated linearly from the first two. This is the same scheme as
+ *  Lgm_InitIGRF().
+ */
+void Lgm_SHCoeffs_AtTime( double Year, double *g, double *h, Lgm_SHCoeffs *s ) {
+
+    int     j, j0, j1, k, nc = s->nCoeffs, ne = s->nEpochs;
+    double  *g0, *g1, *h0, *h1, f;
+
+    if ( ne == 1 ) {
+        memcpy( g, s->g, nc*sizeof(double) );
+        memcpy( h, s->h, nc*sizeof(double) );
+    } else if ( Year >= s->Epoch[ne-1] ) {
+        g0 = s->g + (ne-1)*nc; h0 = s->h + (ne-1)*nc;
+        f  = Year - s->Epoch[ne-1];
+        for ( k=0; k<nc; ++k ) {
+            g[k] = g0[k] + ( (s->g_SV) ? f*s->g_SV[k] : 0.0 );
+            h[k] = h0[k] + ( (s->h_SV) ? f*s->h_SV[k] : 0.0 );
+        }
+    } else {
+        if ( Year >= s->Epoch[0] ) {
+            for ( j=ne-2; Year < s->Epoch[j]; --j );
+            j0 = j; j1 = j+1;
+        } else {
+            j0 = 0; j1 = 1;
+        }
+        g0 = s->g + j0*nc; h0 = s->h + j0*nc;
+        g1 = s->g + j1*nc; h1 = s->h + j1*nc;
+        f  = (Year - s->Epoch[j0])/(s->Epoch[j1] - s->Epoch[j0]);
+        for ( k=0; k<nc; ++k ) {
+            g[k] = g0[k] + f*(g1[k] - g0[k]);
+            h[k] = h0[k] + f*(h1[k] - h0[k]);
+        }
+    }
+
+}
+
+
+/**
+ *  Makes the built-in IGRF field (in the LGM_IGRF slot of all of the
+ *  external models) be computed from the coefficient set s instead. Pass
+ *  NULL to go back to the built-in IGRF. The coefficient set is not copied
+ *  (and is not freed by Lgm_free_ctrans()), so it must outlive c.
+ *
+ *  Note that the coordinate systems that depend on the dipole axis (GSM, SM,
+ *  CDMAG, ...) are still defined by IGRF.
+ */
+void Lgm_Set_SHCoeffs( Lgm_SHCoeffs *s, Lgm_CTrans *c ) {
+
+    c->SHCoeffs = s;
+    c->SHC_Date = -1;
+
+}
+
+
+/*
+ *  Folds the coeffs for the day c->UTC.Date (evaluated at 12 UT) into the
+ *  coefficients of the degree n+1 harmonics in B = -grad( Potential )
+ *  (Montenbruck and Gill, Satellite Orbits, 2000, Eq. 3.33 -- converted to
+ *  the normalized harmonics). The secular variation over a day is well below
+ *  a nT, so one set per day is plenty.
+ */
+static void Lgm_SHCoeffs_Fold( Lgm_CTrans *c ) {
+
+    Lgm_SHCoeffs    *s = c->SHCoeffs;
+    double          *g, *h, *F, G, H, q, rp, rm, r0, Year;
+    int             n, m, N = s->N, nFold;
+
+    nFold = 6*(N+2)*(N+3)/2;
+    if ( c->SHC_nFold != nFold ) {
+        free( c->SHC_Fold );
+        c->SHC_Fold  = (double *)malloc( nFold*sizeof(double) );
+        c->SHC_nFold = nFold;
+    }
+    F = c->SHC_Fold;
+    memset( F, 0, nFold*sizeof(double) );
+
+    g = (double *)malloc( s->nCoeffs*sizeof(double) );
+    h = (double *)malloc( s->nCoeffs*sizeof(double) );
+    Year = (double)c->UTC.Year + ((double)c->UTC.Doy - 0.5)/(365.0 + (double)Lgm_LeapYear( c->UTC.Year )); // same convention as c->UTC.fYear
+    Lgm_SHCoeffs_AtTime( Year, g, h, s );
+
+    /*
+     *  F[ 6*(Off[m] + n-m) + 0..5 ] are the coeffs of V_n,m and W_n,m in
+     *  Bx, Bx, By, By, Bz, Bz respectively.
+     */
+    #define FOLD( k, nn, mm )   F[ 6*( s->Off[mm] + (nn)-(mm) ) + (k) ]
+    for ( n=1; n<=N; ++n ) {
+
+        G  = g[ LGM_SH_IDX( n, 0 ) ];
+        rp = SchmidtRatio( n, 0, n+1, 1 );
+        r0 = SchmidtRatio( n, 0, n+1, 0 );
+        FOLD( 0, n+1, 1 ) += G*rp;
+        FOLD( 3, n+1, 1 ) += G*rp;
+        FOLD( 4, n+1, 0 ) += (n+1)*G*r0;
+
+        for ( m=1; m<=n; ++m ) {
+            G  = 0.5*g[ LGM_SH_IDX( n, m ) ];
+            H  = 0.5*h[ LGM_SH_IDX( n, m ) ];
+            q  = (n-m+2)*(n-m+1);
+            rp = SchmidtRatio( n, m, n+1, m+1 );
+            rm = q*SchmidtRatio( n, m, n+1, m-1 );
+            r0 = 2.0*(n-m+1)*SchmidtRatio( n, m, n+1, m );
+            FOLD( 0, n+1, m+1 ) += G*rp;  FOLD( 1, n+1, m+1 ) += H*rp;
+            FOLD( 0, n+1, m-1 ) -= G*rm;  FOLD( 1, n+1, m-1 ) -= H*rm;
+            FOLD( 3, n+1, m+1 ) += G*rp;  FOLD( 2, n+1, m+1 ) -= H*rp;
+            FOLD( 3, n+1, m-1 ) += G*rm;  FOLD( 2, n+1, m-1 ) -= H*rm;
+            FOLD( 4, n+1, m )   += G*r0;  FOLD( 5, n+1, m )   += H*r0;
+        }
+
+    }
+    #undef FOLD
+
+    free( g );
+    free( h );
+    c->SHC_Date = c->UTC.Date;
+
+}
+
+
+/**
+ *  Computes B from the coefficient set attached to c (see
+ *  Lgm_Set_SHCoeffs()) at the time set in c.
+ *
+ *  u is the position in GEO (WGS84) cartesian coords (units of Re) and B is
+ *  returned as cartesian GEO components (nT).
+ */
+void Lgm_SHCoeffs_B( Lgm_Vector *u, Lgm_Vector *B, Lgm_CTrans *c ) {
+
+    Lgm_SHCoeffs    *s = c->SHCoeffs;
+    double          f, x, y, z, r2inv, xr, yr, zr, Bx, By, Bz;
+    double          V, W, Vmm, Wmm, Vnm1, Wnm1, Vt, Wt, dm, *F, *R;
+    int             n, m, Np1 = s->N+1;
+
+    if ( c->SHC_Date != c->UTC.Date ) Lgm_SHCoeffs_Fold( c );
+
+    f = Re/s->RefRadius;
+    x = u->x*f; y = u->y*f; z = u->z*f;
+    r2inv = 1.0/(x*x + y*y + z*z);
+    xr = x*r2inv; yr = y*r2inv; zr = z*r2inv;
+
+    /*
+     *  Sweep up each order m (from V_m,m) to degree N+1, accumulating the
+     *  contribution of each V_n,m and W_n,m to B as we go.
+     */
+    Bx = By = Bz = 0.0;
+    Vmm = sqrt( r2inv ); Wmm = 0.0;
+    for ( m=0; m<=Np1; ++m ) {
+
+        if ( m > 0 ) {
+            dm  = s->Diag[m];
+            Vt  = dm*( xr*Vmm - yr*Wmm );
+            Wmm = dm*( xr*Wmm + yr*Vmm );
+            Vmm = Vt;
+        }
+
+        F = c->SHC_Fold + 6*s->Off[m];
+        R = s->Rec + 2*s->Off[m];
+        V = Vmm; W = Wmm; Vnm1 = Wnm1 = 0.0;
+        Bx += F[0]*V + F[1]*W;
+        By += F[2]*V + F[3]*W;
+        Bz += F[4]*V + F[5]*W;
+        for ( n=m+1; n<=Np1; ++n ) {
+            F += 6; R += 2;
+            Vt = R[0]*zr*V - R[1]*r2inv*Vnm1;
+            Wt = R[0]*zr*W - R[1]*r2inv*Wnm1;
+            Vnm1 = V; Wnm1 = W;
+            V = Vt; W = Wt;
+            Bx += F[0]*V + F[1]*W;
+            By += F[2]*V + F[3]*W;
+            Bz += F[4]*V + F[5]*W;
+        }
+
+    }
+
+    B->x = Bx;
+    B->y = By;
+    B->z = Bz;
+
+}
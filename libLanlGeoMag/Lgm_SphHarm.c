@@ -154,11 +154,6 @@ void    _Lgm_JensenCain1960( Lgm_Vector *v, Lgm_Vector *B, Lgm_CTrans *c ) {
 
 
 
-    if ( c->Lgm_IGRF_FirstCall ) {
-        Lgm_InitK( c->Lgm_IGRF_K, N );
-        Lgm_InitS( c->Lgm_IGRF_S, N );
-    }
-
 
 
     /*
@@ -255,6 +250,8 @@ void Lgm_InitSphHarm( int Model, double g[14][14], double h[14][14], int N, int
     int             j, j0, j1, n, m;
 
 
+    Lgm_IGRF_AttachTables( c );
+
     Year = c->UTC.fYear;
     if ( Year < 1.0 ) {
         printf("Year not set?!   ( Year = %g )\n", Year);
@@ -1,4 +1,5 @@
 #include "Lgm/Lgm_SummersDiffCoeff.h"
+#include "Lgm/Lgm_TabularBessel.h"
 
 #include <gsl/gsl_poly.h>
 #include <gsl/gsl_integration.h>
@@ -11,6 +12,9 @@ struct normalizerForWavePowerSpectrumFunctionParams {double x; double aStar; int
 struct localDiffusionCoefficientAtSpecificThetaGlauertAndHorneFunctionParams {int tensorFlag; int s; double KE; double aStar; double wce; double xmin; double xmax; int numberOfWaveNormalAngleDistributions; double *xmArray; double *dxArray; double *weightsOnWaveNormalAngleDistributions; double wm; double dw; double wlc; double wuc; double Bw; double alpha; int nCyclotronLow; int nCyclotronHigh; double *Nw; int nNw; int Dir;};
 double normalizerForWavePowerSpectrumFunction(double tanTheta, void *p);
 int computeResonantRootsUsingColdElectronPlasma(double KE, double theta, double alpha, int s, int nCyclotron, double aStar, double xlc, double xuc, double *resonantRoots, int *nRoots);
+int computeResonantRootsUsingColdElectronPlasmaWithWorkspace(double KE, double theta, double alpha, int s, int nCyclotron, double aStar, double xlc, double xuc, double *resonantRoots, int *nRoots, gsl_poly_complex_workspace *w4, gsl_poly_complex_workspace *w9);
+int buildGlauertAndHorneRootTable(int n, double tanThetaMin, double tanThetaMax, struct localDiffusionCoefficientAtSpecificThetaGlauertAndHorneFunctionParams *p, gsl_integration_glfixed_table *gl, gsl_poly_complex_workspace *w4, gsl_poly_complex_workspace *w9, Lgm_GH_RootTable *rt);
+static double GlauertAndHorneLocalCached( Lgm_SummersInfo *si, double Lat, double SinAlpha2, double dBoverB2, double BoverBeq, double Omega_e, double Omega_Sig, double x1, double x2, double xm, double dx, double aStar, int tensorFlag );
 double besselFunctionNormalizer(int s, double p, double alpha, int nCyclotronNumber, double x, double y, double P, double R, double L, double S, double theta);
 double electronColdPlasmaGroupVelocity(double aStar, double tanTheta2, double x, double y);
 double localDiffusionCoefficientAtSpecificThetaGlauertAndHorneWeightedByTanTheta(double tanTheta, struct localDiffusionCoefficientAtSpecificThetaGlauertAndHorneFunctionParams *p);
@@ -180,6 +184,7 @@ int Lgm_SummersDxxBounceAvg( int Version, double Alpha0,  double Ek,  double L,
     int              npts2=4, limit=500, lenw=4*limit, iwork[502], last, ier, neval;
     int              VerbosityLevel = 0;
     Lgm_SummersInfo  si;
+    si.GH_nCache = 0;
     si.Version = Version;
     si.n1 = n1;
     si.n2 = n2;
@@ -452,6 +457,7 @@ printf("I'm really in Lgm_GlauertAndHorneDxxBounceAvg\n");
     si.nNw = nNw;
     si.nPlasmaParameters= nPlasmaParameters;
     si.Nw = (double *) Nw;
+    si.GH_nCache = 0;
 
     si.Version = Version;
     si.n1 = n1;
@@ -908,10 +914,7 @@ double  SummersIntegrand_Gaa( double Lat, _qpInfo *qpInfo ) {
 
     } else if ( si->Version == LGM_GLAUERT_AND_HORNE_HIGH_FREQ ) {
 
-	    Daa = Lgm_GlauertAndHorneHighFrequencyDiffusionCoefficients_Local(SinAlpha2, si->E, dBoverB2, BoverBeq, Omega_e, Omega_Sig, 
-		    si->Rho, si->Sig, x1, x2, xm, dx, si->x1, si->x2, si->numberOfWaveNormalAngleDistributions, 
-            	    (double *) si->xm, (double *) si->dx, (double *) si->weightsOnWaveNormalAngleDistributions, 
-            	    si->Lambda, si->s, aStar, si->Directions, (int) 0, si->nNw, si->nPlasmaParameters, si->aStarMin, si->aStarMax, si->Nw);
+	    Daa = GlauertAndHorneLocalCached( si, Lat, SinAlpha2, dBoverB2, BoverBeq, Omega_e, Omega_Sig, x1, x2, xm, dx, aStar, 0 );
 
     } else {
 
@@ -1045,10 +1048,7 @@ double  SummersIntegrand_Gap( double Lat, _qpInfo *qpInfo ) {
 
     } else if ( si->Version == LGM_GLAUERT_AND_HORNE_HIGH_FREQ ) {
 
-	    Dap = Lgm_GlauertAndHorneHighFrequencyDiffusionCoefficients_Local(SinAlpha2, si->E, dBoverB2, BoverBeq, Omega_e, Omega_Sig, 
-		    si->Rho, si->Sig, x1, x2, xm, dx, si->x1, si->x2, si->numberOfWaveNormalAngleDistributions, 
-		    (double *) si->xm, (double *) si->dx, (double *) si->weightsOnWaveNormalAngleDistributions, 
-                    si->Lambda, si->s, aStar, si->Directions, (int) 1, si->nNw, si->nPlasmaParameters, si->aStarMin, si->aStarMax, si->Nw);
+	    Dap = GlauertAndHorneLocalCached( si, Lat, SinAlpha2, dBoverB2, BoverBeq, Omega_e, Omega_Sig, x1, x2, xm, dx, aStar, 1 );
 
     } else {
 
@@ -1164,10 +1164,7 @@ double  SummersIntegrand_Gpp( double Lat, _qpInfo *qpInfo ) {
 
     } else if ( si->Version == LGM_GLAUERT_AND_HORNE_HIGH_FREQ ) {
 
-	Dpp = Lgm_GlauertAndHorneHighFrequencyDiffusionCoefficients_Local(SinAlpha2, si->E, dBoverB2, BoverBeq, Omega_e, Omega_Sig, 
-		    si->Rho, si->Sig, x1, x2, xm, dx, si->x1, si->x2, si->numberOfWaveNormalAngleDistributions, 
-		    (double *) si->xm, (double *) si->dx, (double *) si->weightsOnWaveNormalAngleDistributions, si->Lambda, si->s, aStar, si->Directions, (int) 2,
-		    si->nNw, si->nPlasmaParameters, si->aStarMin, si->aStarMax, si->Nw);
+	    Dpp = GlauertAndHorneLocalCached( si, Lat, SinAlpha2, dBoverB2, BoverBeq, Omega_e, Omega_Sig, x1, x2, xm, dx, aStar, 2 );
 
     } else {
 
@@ -3144,6 +3141,242 @@ if (commonFactor < 0.0) {printf("commonFactor<0.0: x=%g, indexIntoNw=%d, result=
 	return(0);
 }
 
+/*
+ *	Local Glauert and Horne Daa (tensorFlag=0), Dap (1) or Dpp (2) at latitude Lat, for the bounce average integrands.  All three components
+ *	are computed together the first time a latitude is seen and are kept in si, so the Gap and Gpp integrals (which mostly sample the same 
+ *	latitudes as the Gaa integral) don't have to redo the work.
+ */
+static double GlauertAndHorneLocalCached( Lgm_SummersInfo *si, double Lat, double SinAlpha2, double dBoverB2, double BoverBeq, double Omega_e, double Omega_Sig, double x1, double x2, double xm, double dx, double aStar, int tensorFlag ) {
+
+	double	D[3];
+	int	i;
+
+	for ( i=0; i<si->GH_nCache; i++ ) {
+		if ( si->GH_CacheLat[i] == Lat ) return( si->GH_CacheD[i][tensorFlag] );
+	}
+
+	Lgm_GlauertAndHorneHighFrequencyDiffusionTensor_Local( SinAlpha2, si->E, dBoverB2, BoverBeq, Omega_e, Omega_Sig, 
+		si->Rho, si->Sig, x1, x2, xm, dx, si->x1, si->x2, si->numberOfWaveNormalAngleDistributions, 
+		(double *) si->xm, (double *) si->dx, (double *) si->weightsOnWaveNormalAngleDistributions, 
+		si->Lambda, si->s, aStar, si->Directions, si->nNw, si->nPlasmaParameters, si->aStarMin, si->aStarMax, si->Nw, &D[0], &D[1], &D[2] );
+
+	if ( si->GH_nCache < LGM_GH_CACHE_SIZE ) {
+		si->GH_CacheLat[si->GH_nCache]  = Lat;
+		si->GH_CacheD[si->GH_nCache][0] = D[0];
+		si->GH_CacheD[si->GH_nCache][1] = D[1];
+		si->GH_CacheD[si->GH_nCache][2] = D[2];
+		++(si->GH_nCache);
+	}
+
+	return( D[tensorFlag] );
+}
+
+/*
+ *	The following routine computes all 3 components of the local Glauert and Horne diffusion tensor (Daa, Dap and Dpp) in one pass.  The 
+ *	inputs are the same as for Lgm_GlauertAndHorneHighFrequencyDiffusionCoefficients_Local() (minus tensorFlag) and the result is equivalent
+ *	to calling it with tensorFlag = 0, 1 and 2, except that:
+ *
+ *		- for each harmonic, the resonant roots (and everything at each root that doesn't depend on the tensor component) are tabulated
+ *		  once at fixed nodes in tan(theta) by buildGlauertAndHorneRootTable(), and all three components are summed from that table.  
+ *		  Previously each component did its own adaptive integral over tan(theta), re-solving the 8th degree dispersion polynomial at 
+ *		  every node;
+ *		- J_{n-1}, J_n and J_{n+1} at each root come from a single Bessel recurrence (see besselFunctionNormalizer());
+ *		- the GSL polynomial workspaces are allocated once per call rather than once per root solve.
+ *
+ *	The integral over tan(theta) for each harmonic uses an LGM_GH_NTHETA point Gauss-Legendre rule over the same interval the adaptive 
+ *	integration uses.  Returns 0 on success, -1 if the GSL workspaces could not be allocated.
+ */
+int Lgm_GlauertAndHorneHighFrequencyDiffusionTensor_Local( double SinAlpha2, double E, double dBoverB2, double BoverBeq, 
+        double Omega_e, double Omega_Sig, double Rho, double Sig, double wxl, double wxh, double wxm, double wdx, double xmin, double xmax, 
+        int numberOfWaveNormalAngleDistributions, double *xmArray, double *dxArray, double *weightsOnWaveNormalAngleDistributions, 
+        double Lambda, int sIn, double aStar, int Directions, int nNw, int nPlasmaParameters, double aStarMin, double aStarMax, double *Nwglobal,
+        double *Daa, double *Dap, double *Dpp ) {
+
+	double				alpha, KE, wce, wlc, wuc, wm, dw, Bw, gamma, vpar, wn, tempxmin, tempxmax;
+	double				thetaStart[4], thetaEnd[4], dDaa, dDap, dDpp, Cq, *Nw;
+	int				s, n, i, k, indexIntoNormalizer, nIntervals;
+	struct inequalityParameters 	inequalityParamsLC, inequalityParamsUC;
+	struct localDiffusionCoefficientAtSpecificThetaGlauertAndHorneFunctionParams p2;
+	gsl_integration_glfixed_table	*gl;
+	gsl_poly_complex_workspace	*w4, *w9;
+	Lgm_GH_RootTable		rt;
+
+	*Daa = *Dap = *Dpp = 0.0;
+
+/*	Convert from 'Summers' parameters to 'Glauert and Horne' parameters (see Lgm_GlauertAndHorneHighFrequencyDiffusionCoefficients_Local()) */
+	alpha = 0.0; KE = 0.0; s = -1;
+	if ((SinAlpha2>=0.0) && (SinAlpha2<=1.0)) {alpha = asin(sqrt(SinAlpha2));}
+	if (Lambda == -1) {KE = E*LGM_Ee0; s=-1;}
+	if (Lambda == LGM_EPS) {KE = E*LGM_Ep0; s=1;}
+	wce=Omega_e/(2.0*M_PI);
+	wlc=wxl*wce;
+	wuc=wxh*wce;
+	wm=wxm*wce;
+	dw=wdx*wce;
+	Bw = sqrt(dBoverB2*pow(Omega_e*LGM_ELECTRON_MASS*1e12/LGM_e, 2.0));
+
+	indexIntoNormalizer = (int) trunc(nPlasmaParameters*log(aStar/aStarMin)/log(aStarMax/aStarMin));
+	if (indexIntoNormalizer<0) {indexIntoNormalizer =0;}
+	if (indexIntoNormalizer>nPlasmaParameters-1) {indexIntoNormalizer=nPlasmaParameters-1;}
+	Nw=Nwglobal+(nNw*indexIntoNormalizer);
+
+	p2.tensorFlag=0; p2.s=s; p2.KE=KE; p2.aStar=aStar; p2.wce=wce; 
+	p2.wm=wm; p2.dw=dw; p2.wlc=wlc; p2.wuc=wuc; p2.xmin=xmin; p2.xmax=xmax; 
+	p2.xmArray=xmArray; p2.dxArray=dxArray; p2.weightsOnWaveNormalAngleDistributions=weightsOnWaveNormalAngleDistributions; 
+	p2.numberOfWaveNormalAngleDistributions=numberOfWaveNormalAngleDistributions; 
+	p2.Bw=Bw; p2.alpha=alpha; p2.Nw=Nw; p2.nNw=nNw; p2.Dir=Directions;
+
+	gamma = 1.0+((p2.KE)/LGM_Ee0);
+	vpar = cos(alpha)*sqrt(1-(1.0/(gamma*gamma)));
+	computeInequalityParameters(wxl, p2.aStar, vpar, &inequalityParamsLC);
+	computeInequalityParameters(wxh, p2.aStar, vpar, &inequalityParamsUC);
+
+	gl = gsl_integration_glfixed_table_alloc( LGM_GH_NTHETA );
+	w4 = gsl_poly_complex_workspace_alloc( 4 );
+	w9 = gsl_poly_complex_workspace_alloc( 9 );
+	if ( (gl == NULL) || (w4 == NULL) || (w9 == NULL) ) {
+		printf("Lgm_GlauertAndHorneHighFrequencyDiffusionTensor_Local: could not allocate GSL workspaces\n");
+		if ( gl != NULL ) gsl_integration_glfixed_table_free( gl );
+		if ( w4 != NULL ) gsl_poly_complex_workspace_free( w4 );
+		if ( w9 != NULL ) gsl_poly_complex_workspace_free( w9 );
+		return(-1);
+	}
+
+	for (n=-LGM_GH_MAX_HARMONIC; n<=LGM_GH_MAX_HARMONIC; n++) {
+
+/*		Only integrate over the wave normal angles where roots can exist for this harmonic */
+		wn = s*n/gamma;
+		computeWaveNormalAngleIntervalsWhereResonantRootsMayExist(wn, wxl, wxh, &inequalityParamsLC, &inequalityParamsUC, (int) 1, &nIntervals, thetaStart, thetaEnd);
+		if (nIntervals == 0) continue;
+		if (nIntervals == 1) {
+			tempxmin = tan(thetaStart[0]); if (tempxmin < xmin) { tempxmin = xmin; }
+			tempxmax = tan(thetaEnd[0]); if (tempxmax > xmax) { tempxmax = xmax; }
+		} else {
+			tempxmin = xmin; tempxmax = xmax;
+		}
+		if (tempxmax <= tempxmin) continue;
+
+		buildGlauertAndHorneRootTable( n, tempxmin, tempxmax, &p2, gl, w4, w9, &rt );
+
+		for (k=0; k<rt.nTheta; k++) {
+			dDaa = dDap = dDpp = 0.0;
+			for (i=0; i<rt.nRoots[k]; i++) {
+				Cq = rt.C[k][i]*rt.q[k][i];
+				dDaa += Cq*rt.q[k][i]/(rt.CosAlpha*rt.CosAlpha);
+				dDap += Cq*rt.SinAlpha/rt.CosAlpha;
+				dDpp += rt.C[k][i]*rt.SinAlpha*rt.SinAlpha;
+			}
+/*			As in localDiffusionCoefficientAtSpecificThetaGlauertAndHorne(), drop anything that isn't a number */
+			if (!isfinite(dDaa)) dDaa = 0.0;
+			if (!isfinite(dDap)) dDap = 0.0;
+			if (!isfinite(dDpp)) dDpp = 0.0;
+			*Daa += rt.W[k]*dDaa;
+			*Dap += rt.W[k]*dDap;
+			*Dpp += rt.W[k]*dDpp;
+		}
+
+	}
+
+	gsl_integration_glfixed_table_free( gl );
+	gsl_poly_complex_workspace_free( w4 );
+	gsl_poly_complex_workspace_free( w9 );
+
+	return(0);
+}
+
+/*
+ *	Tabulates the resonant roots for cyclotron harmonic n at the Gauss-Legendre nodes of [tanThetaMin, tanThetaMax], along with the parts of
+ *	the integrand at each root described in Lgm_GH_RootTable.  The quantities are the same as those computed in 
+ *	localDiffusionCoefficientAtSpecificThetaGlauertAndHorne(); p supplies the local state (its tensorFlag, nCyclotronLow and nCyclotronHigh
+ *	are not used).  The GSL workspaces are supplied by the caller.
+ */
+int buildGlauertAndHorneRootTable(int n, double tanThetaMin, double tanThetaMax, struct localDiffusionCoefficientAtSpecificThetaGlauertAndHorneFunctionParams *p, gsl_integration_glfixed_table *gl, gsl_poly_complex_workspace *w4, gsl_poly_complex_workspace *w9, Lgm_GH_RootTable *rt)
+{
+	int	i, j, k, nRoots, indexIntoNw, s, Dir, nNw;
+	double	alpha, SinAlpha, SinAlpha2, CosAlpha, Mu2, E, Gamma, Gamma2, momentum, pNorm2, vpar, Asquared;
+	double	KE, aStar, wce, wm, dw, wlc, wuc, Bw, *Nw;
+	double	tanTheta, tanTheta2, theta, cosTheta, Beta, a, g, xm, dx;
+	double	z[9], x, y, R, L, S, P, wi, result, phink2, dwdk, Bsquared, term1, term3a, term3b;
+
+	s=p->s; KE=p->KE; aStar=p->aStar; wce=p->wce; wm=p->wm; dw=p->dw; wlc=p->wlc; wuc=p->wuc; 
+	Bw=p->Bw; alpha=p->alpha; Nw=p->Nw; nNw=p->nNw; Dir=p->Dir;
+	if (fabs(alpha) < 1e-3) {alpha = 1e-3;}
+	if (fabs(alpha-(M_PI/2.0)) < 1e-3) {alpha = M_PI/2.0-1e-3;}
+
+/*	Things that don't depend on the wave normal angle */
+	SinAlpha=sin(alpha); SinAlpha2=SinAlpha*SinAlpha; CosAlpha=cos(alpha);
+	Mu2=1.0-SinAlpha2;
+	E=KE/0.511;
+	Gamma = E+1.0; Gamma2 = Gamma*Gamma;
+	momentum=sqrt((KE+LGM_Ee0)*(KE+LGM_Ee0)-(LGM_Ee0*LGM_Ee0));				//momentum in MeV/c
+	pNorm2 = pow(momentum*1e6*Joules_Per_eV/LGM_c, 2.0);					//momentum^2 in (kg*m/s)^2, to convert to Summers' normalization
+	vpar = (momentum*1e6*Joules_Per_eV*CosAlpha)/(Gamma*LGM_c*LGM_ELECTRON_MASS);		//vpar in m/s
+	Asquared = (pow(Bw*1e-12, 2.0)/(2.0*M_PI*dw))*(2/sqrt(M_PI))/(gsl_sf_erf((wm-wlc)/dw)+gsl_sf_erf((wuc-wm)/dw));
+	a = s*n/Gamma;
+
+	rt->n = n;
+	rt->nTheta = LGM_GH_NTHETA;
+	rt->SinAlpha = SinAlpha;
+	rt->CosAlpha = CosAlpha;
+
+	for (k=0; k<LGM_GH_NTHETA; k++) {
+
+		gsl_integration_glfixed_point( tanThetaMin, tanThetaMax, (size_t)k, &tanTheta, &rt->W[k], gl );
+		rt->tanTheta[k] = tanTheta;
+		rt->W[k] *= tanTheta;									// the integrand over tan(theta) is weighted by tan(theta)
+		rt->nRoots[k] = 0;
+
+		if (fabs(tanTheta) < 1e-3) {tanTheta=1e-3;}
+		if ((tanTheta<p->xmin)||(tanTheta>p->xmax)) continue;
+
+		theta = atan(tanTheta);
+		tanTheta2 = tanTheta*tanTheta;
+		cosTheta = cos(theta);
+		Beta = sqrt(E*(E+2.0)*Mu2*cosTheta*cosTheta/Gamma2);
+
+		g = 0.0;
+		for (j=0; j<p->numberOfWaveNormalAngleDistributions; j++) {
+			xm = p->xmArray[j]; dx = p->dxArray[j];
+			g += p->weightsOnWaveNormalAngleDistributions[j]*exp(-1.0*(tanTheta-xm)*(tanTheta-xm)/(dx*dx));
+		}
+
+		computeResonantRootsUsingColdElectronPlasmaWithWorkspace(KE, theta, alpha, s, n, aStar, wlc/wce, wuc/wce, &z[0], &nRoots, w4, w9);
+
+		for (i=0; i<nRoots; i++) {
+
+			x = z[i];
+			y = (x-a)/Beta;
+			if (!(((y<0)&&((Dir == LGM_BKWD)||(Dir== LGM_FRWD_BKWD)))||((y>0)&&((Dir == LGM_FRWD)||(Dir == LGM_FRWD_BKWD))))) continue;
+
+			R=1.0-((1.0/(aStar*x*x))*(x/(x-1.0)));
+			L=1.0-((1.0/(aStar*x*x))*(x/(x+1.0)));
+			S=0.5*(R+L);
+			P=1.0-(1.0/(aStar*x*x));
+			if (((-1.0*P/S*0.99)<(tanTheta2))&&(-1.0*P/S > 0.0)) continue;				// wave normal angle is beyond the resonance cone
+
+			wi = x*wce;
+			indexIntoNw = (int) (nNw*x);
+			if (indexIntoNw < 0) {indexIntoNw=0;}
+			if (indexIntoNw > (nNw-1)) {indexIntoNw=nNw-1;}
+			result = Nw[indexIntoNw]*wce*wce;
+			phink2 = besselFunctionNormalizer(s, momentum, alpha, n, x, y, P, R, L, S, theta);
+			dwdk = electronColdPlasmaGroupVelocity(aStar, tanTheta2, x, y);
+			Bsquared = Asquared*exp(-1.0*(wi-wm)*(wi-wm)/(dw*dw));
+			term1 = (LGM_e*LGM_e*wi*wi/(4.0*M_PI*(1.0+tanTheta2)*result));
+			term3a = Bsquared*g*phink2;
+			term3b = 1.0/fabs(vpar-(dwdk/cosTheta));
+
+			j = rt->nRoots[k]++;
+			rt->x[k][j] = x;
+			rt->C[k][j] = term1*term3a*term3b/pNorm2;
+			rt->q[k][j] = (s*n*wce/(Gamma*wi))-SinAlpha2;
+
+		}
+	}
+
+	return(0);
+}
+
 /*
  *	The following routine computes the frequencies, w_i, at which the dispersion relation and resonance condition are both simultaneously satisfied.
  *	The dispersion relation that is used is an approximation which assumes that the ion contribution is minimal (frequency is greater than 0.1 times
@@ -3162,6 +3395,15 @@ if (commonFactor < 0.0) {printf("commonFactor<0.0: x=%g, indexIntoNw=%d, result=
  *
  */
 int computeResonantRootsUsingColdElectronPlasma(double KE, double theta, double alpha, int s, int nCyclotron, double aStar, double xlc, double xuc, double *resonantRoots, int *nRoots)
+{
+	return( computeResonantRootsUsingColdElectronPlasmaWithWorkspace(KE, theta, alpha, s, nCyclotron, aStar, xlc, xuc, resonantRoots, nRoots, NULL, NULL) );
+}
+
+/*
+ *	Same as computeResonantRootsUsingColdElectronPlasma(), but the GSL polynomial workspaces (for the degree 3 and degree 8 polynomials) can be 
+ *	supplied by the caller so that they don't have to be allocated for every root solve.  Either may be NULL, in which case it is allocated here.
+ */
+int computeResonantRootsUsingColdElectronPlasmaWithWorkspace(double KE, double theta, double alpha, int s, int nCyclotron, double aStar, double xlc, double xuc, double *resonantRoots, int *nRoots, gsl_poly_complex_workspace *w4, gsl_poly_complex_workspace *w9)
 {
 	double		E, Gamma, Gamma2, Beta, Beta2, Beta4, tanTheta, tanTheta2, cosTheta, cosTheta2, cosAlpha, sinAlpha, sinAlpha2, Mu2, a, a2, a3, a4, Coeff[9];
     	double complex  zz[9];
@@ -3218,9 +3460,9 @@ int computeResonantRootsUsingColdElectronPlasma(double KE, double theta, double
     		Coeff[2] =-1.0*Beta4-(3.0*Beta4/aStar)-(1.0)-(1.0/(aStar))+(2.0*Beta2)+(4.0*Beta2/(aStar))-(tanTheta2*Beta4)+(3.0*tanTheta2*Beta4/aStar)-(tanTheta2)-(tanTheta2/(aStar))+(2.0*tanTheta2*Beta2)+(4.0*tanTheta2*Beta2/(aStar));												// the coefficient on the x^6 term in the original expansion, which will now be the y^2 term
     		Coeff[3] = 1.0*Beta4+(1.0)-(2.0*Beta2)+(tanTheta2*Beta4)+(tanTheta2)-(2.0*tanTheta2*Beta2); // the coefficient on the x^8 term in the original expansion, which will now be the y^3 term
 /* 		Solve for resonant roots and put into a complex array for further processing.  */
-    		gsl_poly_complex_workspace *w = gsl_poly_complex_workspace_alloc( 4 );
+    		gsl_poly_complex_workspace *w = ( w4 != NULL ) ? w4 : gsl_poly_complex_workspace_alloc( 4 );
     		gsl_err = gsl_poly_complex_solve( Coeff, 4, w, gsl_z );
-    		gsl_poly_complex_workspace_free( w );
+    		if ( w != w4 ) gsl_poly_complex_workspace_free( w );
     		(*nRoots) = 0;
     		if (gsl_err != GSL_SUCCESS ) 
 			{
@@ -3259,9 +3501,9 @@ int computeResonantRootsUsingColdElectronPlasma(double KE, double theta, double
     		Coeff[8] = 1.0*Beta4+(1.0)-(2.0*Beta2)+(tanTheta2*Beta4)+(tanTheta2)-(2.0*tanTheta2*Beta2);
 
 /* 		Solve for resonant roots and put into a complex array for further processing.  */
-    		gsl_poly_complex_workspace *w = gsl_poly_complex_workspace_alloc( 9 );
+    		gsl_poly_complex_workspace *w = ( w9 != NULL ) ? w9 : gsl_poly_complex_workspace_alloc( 9 );
     		gsl_err = gsl_poly_complex_solve( Coeff, 9, w, gsl_z );
-    		gsl_poly_complex_workspace_free( w );
+    		if ( w != w9 ) gsl_poly_complex_workspace_free( w );
     		(*nRoots) = 0;
     		if (gsl_err != GSL_SUCCESS ) 
 			{
@@ -3546,42 +3788,12 @@ double besselFunctionNormalizer(int s, double p, double alpha, int nCyclotronNum
 {
 	double 	n2,arg,sinTheta,sinTheta2,cosTheta,phink2;
 	double	J[3];
-	int	i,thisN;
 
 	n2 = (y/x)*(y/x);		//square of the index of refraction, n=ck/w
 	sinTheta=sin(theta); sinTheta2=sinTheta*sinTheta; 
 	cosTheta=cos(theta);
 	arg = s*(y/LGM_c)*sinTheta*p*sin(alpha)*(1e6*Joules_Per_eV/LGM_c)/LGM_ELECTRON_MASS; //the argument
-	thisN = nCyclotronNumber-1;
-	if (thisN < 0) 
-		{
-		thisN = -1*thisN;
-		i=gsl_sf_bessel_Jn_array(thisN, thisN, (double) (-1.0*arg),&J[0]);
-		}
-	else
-		{
-		i=gsl_sf_bessel_Jn_array(thisN, thisN, arg, &J[0]);
-		}
-	thisN = nCyclotronNumber;
-	if (thisN < 0) 
-		{
-		thisN = -1*thisN;
-		i=gsl_sf_bessel_Jn_array(thisN, thisN, (double) (-1.0*arg),&J[1]);
-		}
-	else
-		{
-		i=gsl_sf_bessel_Jn_array(thisN, thisN, arg, &J[1]);
-		}
-	thisN = nCyclotronNumber+1;
-	if (thisN < 0) 
-		{
-		thisN = -1*thisN;
-		i=gsl_sf_bessel_Jn_array(thisN, thisN, (double) (-1.0*arg),&J[2]);
-		}
-	else
-		{
-		i=gsl_sf_bessel_Jn_array(thisN, thisN, arg, &J[2]);
-		}
+	Lgm_TabularBessel_EvalArray( arg, nCyclotronNumber-1, nCyclotronNumber+1, J, (Lgm_TabularBessel *)NULL );	// J[0..2] = J_{n-1}, J_n, J_{n+1}
 	phink2=pow((((n2-L)/(n2-S))*J[2]+(((n2-R)/(n2-S))*J[0]))*((n2*sinTheta2-P)/(2.0*n2))+(sinTheta*cosTheta*J[1]/tan(alpha)), 2.0)/(pow((R-L)/(2.0*(n2-S)),2.0)*pow((P-(n2*sinTheta2))/n2, 2.0)+pow(P*cosTheta/n2, 2.0));
 	return(phink2);
 }
@@ -0,0 +1,419 @@
+/*! \file Lgm_SunMoonCheb.c
+ *
+ *  \brief Piecewise Chebyshev tables of the Sun and Moon positions.
+ *
+ *  Lgm_Set_Coord_Transforms() evaluates the Sun and Moon positions (with the
+ *  low or high accuracy theories, or the DE ephemeris) every time it is
+ *  called. For long, densely sampled timelines that can be avoided by
+ *  fitting the positions once with piecewise Chebyshev series and attaching
+ *  the table to the Lgm_CTrans structure. Lgm_ComputeSun() and
+ *  Lgm_ComputeMoon() then just sum the series (falling back to the model
+ *  outside of the span of the table). Everything that depends on the Sun
+ *  and Moon (GSE, GSM, SM, the eclipse routines, ...) picks the values up
+ *  from there as usual.
+ *
+ *  Example;
+ *
+ *      Lgm_Make_UTC( 20150101, 0.0, &Start, c );
+ *      Lgm_Make_UTC( 20160101, 0.0, &End, c );
+ *      s = Lgm_SunMoonCheb_Create( &Start, &End, 1.0, 12, 1e-9, c );
+ *
+ *      Lgm_Set_SunMoonCheb( s, c );
+ *      for ( ... ) {
+ *          Lgm_Set_Coord_Transforms( Date, UTC, c );
+ *          ...
+ *      }
+ *      Lgm_Set_SunMoonCheb( NULL, c );
+ *      Lgm_SunMoonCheb_Free( s );
+ *
+ *  The table reproduces the model it was made from (c->ephModel at the time
+ *  of creation); it is not more accurate than that model, and it is only
+ *  used while c->ephModel is still that model. MaxErr is the largest error
+ *  found at the check points (4*Order+5 of them in each segment, four times
+ *  as dense as the fitting nodes). It is a sampled estimate, not a bound,
+ *  although the error between the check points is not expected to be much
+ *  larger.
+ *
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "Lgm/Lgm_CTrans.h"
+#include "Lgm/Lgm_SunMoonCheb.h"
+
+#define LGM_SMC_MAX_ORDER   30
+#define LGM_SMC_MIN_SEG     60.0    // Segments are not split below this (s)
+
+
+
+/*
+ *  Sum a Chebyshev series (Clenshaw's recurrence).
+ */
+static double Lgm_SMC_Cheb( double x, double *a, int N ) {
+
+    double  b0 = 0.0, b1 = 0.0, b2, x2 = 2.0*x;
+    int     k;
+
+    for ( k=N; k>=1; k-- ) {
+        b2 = b1;
+        b1 = b0;
+        b0 = x2*b1 - b2 + a[k];
+    }
+
+    return( a[0] + x*b0 - b1 );
+
+}
+
+
+/*
+ *  Evaluate the model at t (TT seconds since J2000). The positions are in
+ *  MOD (Re).
+ */
+static void Lgm_SMC_Model( double t, double *q, Lgm_CTrans *c ) {
+
+    Lgm_DateTime    UTC;
+    Lgm_Vector      u;
+
+    Lgm_TTSecSinceJ2000_to_UTC( t, &UTC, c );
+    Lgm_Set_Coord_Transforms( UTC.Date, UTC.Time, c );
+
+    q[LGM_SMC_SUN_X]    = c->Sun.x*c->earth_sun_dist;
+    q[LGM_SMC_SUN_X+1]  = c->Sun.y*c->earth_sun_dist;
+    q[LGM_SMC_SUN_X+2]  = c->Sun.z*c->earth_sun_dist;
+
+    Lgm_Radec_to_Cart( c->RA_moon, c->DEC_moon, &u );
+    q[LGM_SMC_MOON_X]   = u.x*c->EarthMoonDistance;
+    q[LGM_SMC_MOON_X+1] = u.y*c->EarthMoonDistance;
+    q[LGM_SMC_MOON_X+2] = u.z*c->EarthMoonDistance;
+
+    q[LGM_SMC_PHASE]    = c->MoonPhase;
+
+}
+
+
+/*
+ *  Fit the series for one segment and return the largest error found at
+ *  the check points (the 4n+1 extrema of T_4n; they include both ends of the
+ *  segment and there are at least three between each pair of fitting
+ *  nodes).
+ */
+static double Lgm_SMC_FitSegment( double ta, double tb, double *Coeffs, Lgm_SunMoonCheb *s, Lgm_CTrans *c ) {
+
+    double  f[LGM_SMC_NQ][LGM_SMC_MAX_ORDER+1], q[LGM_SMC_NQ], *a;
+    double  x, t, sum, d2, r2, Err, MaxErr;
+    int     N = s->Order, n = s->Order+1, i, j, k, iq;
+
+    /*
+     *  Model values at the Chebyshev nodes.
+     */
+    for ( k=0; k<n; k++ ) {
+        x = cos( M_PI*(k+0.5)/n );
+        t = 0.5*(ta+tb) + 0.5*(tb-ta)*x;
+        Lgm_SMC_Model( t, q, c );
+        if ( !s->HavePhase ) q[LGM_SMC_PHASE] = 0.0;
+        for ( iq=0; iq<LGM_SMC_NQ; iq++ ) f[iq][k] = q[iq];
+    }
+
+    /*
+     *  Coeffs.
+     */
+    for ( iq=0; iq<LGM_SMC_NQ; iq++ ) {
+        a = Coeffs + iq*n;
+        for ( j=0; j<n; j++ ) {
+            for ( sum=0.0, k=0; k<n; k++ ) sum += f[iq][k]*cos( M_PI*j*(k+0.5)/n );
+            a[j] = 2.0*sum/n;
+        }
+        a[0] *= 0.5;
+    }
+
+    /*
+     *  Check.
+     */
+    MaxErr = 0.0;
+    for ( i=0; i<=4*n; i++ ) {
+        x = cos( M_PI*i/(4.0*n) );
+        t = 0.5*(ta+tb) + 0.5*(tb-ta)*x;
+        Lgm_SMC_Model( t, q, c );
+
+        for ( iq=LGM_SMC_SUN_X; iq<=LGM_SMC_MOON_X; iq += 3 ) {
+            for ( d2=r2=0.0, j=0; j<3; j++ ) {
+                sum = Lgm_SMC_Cheb( x, Coeffs + (iq+j)*n, N ) - q[iq+j];
+                d2 += sum*sum;
+                r2 += q[iq+j]*q[iq+j];
+            }
+            Err = sqrt( d2/r2 );
+            if ( Err > MaxErr ) MaxErr = Err;
+        }
+
+        if ( s->HavePhase ) {
+            Err = fabs( Lgm_SMC_Cheb( x, Coeffs + LGM_SMC_PHASE*n, N ) - q[LGM_SMC_PHASE] );
+            if ( Err > MaxErr ) MaxErr = Err;
+        }
+    }
+
+    return( MaxErr );
+
+}
+
+
+/*
+ *  Fit [ta, tb], halving it until the fits are good enough, and append the
+ *  segment(s) to the table.
+ */
+static int Lgm_SMC_AddSegment( double ta, double tb, int *nAlloc, Lgm_SunMoonCheb *s, Lgm_CTrans *c ) {
+
+    double  Coeffs[LGM_SMC_NQ*(LGM_SMC_MAX_ORDER+1)], Err, tm;
+    int     nc = LGM_SMC_NQ*(s->Order+1);
+
+    Err = Lgm_SMC_FitSegment( ta, tb, Coeffs, s, c );
+
+    if ( ( Err > s->Tol ) && ( tb-ta > 2.0*LGM_SMC_MIN_SEG ) ) {
+        tm = 0.5*(ta+tb);
+        if ( !Lgm_SMC_AddSegment( ta, tm, nAlloc, s, c ) ) return( FALSE );
+        return( Lgm_SMC_AddSegment( tm, tb, nAlloc, s, c ) );
+    }
+
+    if ( s->nSeg >= *nAlloc ) {
+        *nAlloc *= 2;
+        s->tSeg   = (double *)realloc( s->tSeg,   (*nAlloc+1)*sizeof(double) );
+        s->Coeffs = (double *)realloc( s->Coeffs, (*nAlloc)*nc*sizeof(double) );
+        if ( ( s->tSeg == NULL ) || ( s->Coeffs == NULL ) ) {
+            printf("Lgm_SunMoonCheb_Create: Could not allocate memory for %d segments\n", *nAlloc );
+            return( FALSE );
+        }
+    }
+
+    memcpy( s->Coeffs + s->nSeg*nc, Coeffs, nc*sizeof(double) );
+    s->tSeg[ s->nSeg ]   = ta;
+    s->tSeg[ s->nSeg+1 ] = tb;
+    ++(s->nSeg);
+    if ( Err > s->MaxErr ) s->MaxErr = Err;
+
+    return( TRUE );
+
+}
+
+
+/**
+ *  Fit the Sun and Moon positions over a span of time.
+ *
+ *  The span is cut into segments of (at most) SegDays days, and each
+ *  segment is halved until its series reproduce the model to within Tol.
+ *  The model is whatever c is set up to use (c->ephModel).
+ *
+ *      \param[in]      Start       Start of the span (UTC).
+ *      \param[in]      End         End of the span (UTC).
+ *      \param[in]      SegDays     Longest segment to use (days).
+ *      \param[in]      Order       Order of the Chebyshev series (2 to 30).
+ *      \param[in]      Tol         Accuracy required (relative error in the positions, absolute error in the Moon phase).
+ *      \param[in]      c           Lgm_CTrans structure (not changed).
+ *
+ *      \returns        The table (free with Lgm_SunMoonCheb_Free()), or NULL on error.
+ */
+Lgm_SunMoonCheb *Lgm_SunMoonCheb_Create( Lgm_DateTime *Start, Lgm_DateTime *End, double SegDays, int Order, double Tol, Lgm_CTrans *c ) {
+
+    Lgm_SunMoonCheb *s;
+    Lgm_CTrans      *c2;
+    double          t0, t1, dt, q[LGM_SMC_NQ];
+    int             i, n, nAlloc, Flag = TRUE;
+
+    if ( ( Order < 2 ) || ( Order > LGM_SMC_MAX_ORDER ) ) {
+        printf("Lgm_SunMoonCheb_Create: Order must be between 2 and %d (got %d)\n", LGM_SMC_MAX_ORDER, Order );
+        return( NULL );
+    }
+
+    t0 = Lgm_UTC_to_TTSecSinceJ2000( Start, c );
+    t1 = Lgm_UTC_to_TTSecSinceJ2000( End, c );
+    if ( t1 <= t0 ) {
+        printf("Lgm_SunMoonCheb_Create: End time must be after Start time\n");
+        return( NULL );
+    }
+    if ( SegDays <= 0.0 ) SegDays = 1.0;
+
+    /*
+     *  Work on a copy of c, with no table attached.
+     */
+    c2 = Lgm_CopyCTrans( c );
+    c2->SunMoonCheb = NULL;
+    c2->Verbose     = FALSE;
+
+    s = (Lgm_SunMoonCheb *)calloc( 1, sizeof(Lgm_SunMoonCheb) );
+    s->Order    = Order;
+    s->t0       = t0;
+    s->t1       = t1;
+    s->ephModel = c->ephModel;
+    s->Tol      = Tol;
+
+    Lgm_SMC_Model( t0, q, c2 );
+    s->HavePhase = ( q[LGM_SMC_PHASE] != LGM_FILL_VALUE );
+
+    n      = (int)ceil( (t1-t0)/(SegDays*86400.0) );
+    dt     = (t1-t0)/n;
+    nAlloc = n;
+    s->tSeg   = (double *)calloc( nAlloc+1, sizeof(double) );
+    s->Coeffs = (double *)calloc( nAlloc*LGM_SMC_NQ*(Order+1), sizeof(double) );
+
+    for ( i=0; ( i<n ) && Flag; i++ ) {
+        Flag = Lgm_SMC_AddSegment( t0 + i*dt, ( i == n-1 ) ? t1 : t0 + (i+1)*dt, &nAlloc, s, c2 );
+    }
+
+    Lgm_free_ctrans( c2 );
+
+    if ( !Flag ) {
+        Lgm_SunMoonCheb_Free( s );
+        return( NULL );
+    }
+
+    return( s );
+
+}
+
+
+/**
+ *  Free a table made by Lgm_SunMoonCheb_Create().
+ */
+void Lgm_SunMoonCheb_Free( Lgm_SunMoonCheb *s ) {
+
+    if ( s == NULL ) return;
+    free( s->tSeg );
+    free( s->Coeffs );
+    free( s );
+
+}
+
+
+/**
+ *  Evaluate a table.
+ *
+ *      \param[in]      t           Time (TT seconds since J2000).
+ *      \param[out]     Sun         Position of the Sun (MOD, Re). May be NULL.
+ *      \param[out]     Moon        Position of the Moon (MOD, Re). May be NULL.
+ *      \param[out]     MoonPhase   Phase of the Moon (LGM_FILL_VALUE if the model has none). May be NULL.
+ *      \param[in]      s           The table.
+ *
+ *      \returns        TRUE if t is within the span of the table, FALSE otherwise.
+ */
+int Lgm_SunMoonCheb_Eval( double t, Lgm_Vector *Sun, Lgm_Vector *Moon, double *MoonPhase, Lgm_SunMoonCheb *s ) {
+
+    int     lo, hi, mid, N, n;
+    double  x, *a;
+
+    if ( ( t < s->t0 ) || ( t > s->t1 ) ) return( FALSE );
+
+    lo = 0; hi = s->nSeg;
+    while ( hi - lo > 1 ) {
+        mid = (lo+hi)/2;
+        if ( t < s->tSeg[mid] ) hi = mid;
+        else lo = mid;
+    }
+
+    N = s->Order;
+    n = N+1;
+    x = ( 2.0*t - s->tSeg[lo] - s->tSeg[lo+1] )/( s->tSeg[lo+1] - s->tSeg[lo] );
+    a = s->Coeffs + lo*LGM_SMC_NQ*n;
+
+    if ( Sun ) {
+        Sun->x = Lgm_SMC_Cheb( x, a + (LGM_SMC_SUN_X  )*n, N );
+        Sun->y = Lgm_SMC_Cheb( x, a + (LGM_SMC_SUN_X+1)*n, N );
+        Sun->z = Lgm_SMC_Cheb( x, a + (LGM_SMC_SUN_X+2)*n, N );
+    }
+    if ( Moon ) {
+        Moon->x = Lgm_SMC_Cheb( x, a + (LGM_SMC_MOON_X  )*n, N );
+        Moon->y = Lgm_SMC_Cheb( x, a + (LGM_SMC_MOON_X+1)*n, N );
+        Moon->z = Lgm_SMC_Cheb( x, a + (LGM_SMC_MOON_X+2)*n, N );
+    }
+    if ( MoonPhase ) {
+        *MoonPhase = ( s->HavePhase ) ? Lgm_SMC_Cheb( x, a + LGM_SMC_PHASE*n, N ) : LGM_FILL_VALUE;
+    }
+
+    return( TRUE );
+
+}
+
+
+/**
+ *  Makes Lgm_Set_Coord_Transforms() take the Sun and Moon positions from
+ *  the table s (within its span). Pass NULL to go back to the ephemeris
+ *  model. The table is not copied (and is not freed by Lgm_free_ctrans()),
+ *  so it must outlive c.
+ *
+ *  The table must have been made with the ephemeris model that c uses
+ *  (c->ephModel). If it was not, no table is attached and FALSE is
+ *  returned. (If c->ephModel is changed later, the table is ignored until
+ *  it is changed back.)
+ *
+ *      \returns        TRUE on success, FALSE if the models differ.
+ */
+int Lgm_Set_SunMoonCheb( Lgm_SunMoonCheb *s, Lgm_CTrans *c ) {
+
+    if ( ( s != NULL ) && ( s->ephModel != c->ephModel ) ) {
+        printf("Lgm_Set_SunMoonCheb: Table was made with ephModel = %d, but c->ephModel = %d. Not using it.\n", s->ephModel, c->ephModel );
+        c->SunMoonCheb = NULL;
+        return( FALSE );
+    }
+
+    c->SunMoonCheb = s;
+
+    return( TRUE );
+
+}
+
+
+/*
+ *  Set the Sun quantities of c from its table (for Lgm_ComputeSun()).
+ *  Returns FALSE (and does nothing) if there is no table, it was made with
+ *  another ephemeris model, or the time is not in it.
+ */
+int Lgm_SunMoonCheb_Sun( Lgm_CTrans *c ) {
+
+    Lgm_Vector  S;
+    double      r, RA, Dec, epsilon;
+
+    if ( ( c->SunMoonCheb == NULL ) || ( c->SunMoonCheb->ephModel != c->ephModel )
+        || !Lgm_SunMoonCheb_Eval( Lgm_TT_to_TTSecSinceJ2000( &c->TT ), &S, NULL, NULL, c->SunMoonCheb ) ) return( FALSE );
+
+    c->earth_sun_dist = Lgm_NormalizeVector( &S );
+    c->Sun = S;
+    Lgm_MatTimesVec( c->Amod_to_gei, &S, &c->SunJ2000 );
+
+    Lgm_CartToSphCoords( &S, &Dec, &RA, &r );
+    c->RA_sun  = Lgm_angle360( RA );
+    c->DEC_sun = Dec;
+
+    epsilon       = c->epsilon*RadPerArcSec;
+    c->beta_sun   = asin( cos(epsilon)*S.z - sin(epsilon)*S.y );
+    c->lambda_sun = Lgm_angle2pi( atan2( cos(epsilon)*S.y + sin(epsilon)*S.z, S.x ) );
+
+    return( TRUE );
+
+}
+
+
+/*
+ *  Set the Moon quantities of c from its table (for Lgm_ComputeMoon()).
+ *  Returns FALSE (and does nothing) if there is no table, it was made with
+ *  another ephemeris model, or the time is not in it.
+ */
+int Lgm_SunMoonCheb_Moon( Lgm_CTrans *c ) {
+
+    Lgm_Vector  M;
+    double      r, RA, Dec, Phase;
+
+    if ( ( c->SunMoonCheb == NULL ) || ( c->SunMoonCheb->ephModel != c->ephModel )
+        || !Lgm_SunMoonCheb_Eval( Lgm_TT_to_TTSecSinceJ2000( &c->TT ), NULL, &M, &Phase, c->SunMoonCheb ) ) return( FALSE );
+
+    c->EarthMoonDistance = Lgm_NormalizeVector( &M );
+    Lgm_MatTimesVec( c->Amod_to_gei, &M, &c->MoonJ2000 );
+
+    Lgm_CartToSphCoords( &M, &Dec, &RA, &r );
+    c->RA_moon   = Lgm_angle360( RA );
+    c->DEC_moon  = Dec;
+    c->MoonPhase = Phase;
+
+    return( TRUE );
+
+}
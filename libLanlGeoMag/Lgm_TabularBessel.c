@@ -95,6 +95,67 @@ void Lgm_TabularBessel_Eval( double x, int Q, double *Jn, double *JDn, Lgm_Tabul
 
 
 
+/*
+ * Evaluates Jn(x) for all of the orders n = nmin, nmin+1, ..., nmax in one
+ * call (Jn[0] is J_nmin(x)). Negative orders and negative x are allowed
+ * (using J_-n(x) = (-1)^n Jn(x) and Jn(-x) = (-1)^n Jn(x)).
+ *
+ * If tb is non-NULL and its table covers |x| and all of the orders requested,
+ * the values are linearly interpolated from the table. Otherwise they are
+ * computed with gsl_sf_bessel_Jn_array(), which gets all the orders from a
+ * single recurrence rather than evaluating each one from scratch.
+ */
+void Lgm_TabularBessel_EvalArray( double x, int nmin, int nmax, double *Jn, Lgm_TabularBessel *tb ) {
+
+    double  ax, f, t;
+    int     i, n, an, ii, nn, m1, Done;
+
+    if ( nmax < nmin ) return;
+
+    nn   = nmax - nmin + 1;
+    ax   = fabs( x );
+    m1   = ( abs(nmin) > abs(nmax) ) ? abs(nmin) : abs(nmax);
+    Done = 0;
+
+    if ( (tb != NULL) && (m1 <= tb->N) && (ax >= tb->xmin) ) {
+        ii = (int)( (ax-tb->xmin)/tb->s );
+        if ( ii < tb->M-1 ) {
+            f = (ax - tb->JnTabular_x[ii])/tb->s;
+            for ( i=0; i<nn; i++ ) {
+                an = abs( nmin+i );
+                Jn[i] = tb->JnTabular[an][ii] + f*( tb->JnTabular[an][ii+1] - tb->JnTabular[an][ii] );
+            }
+            Done = 1;
+        }
+    }
+
+    if ( !Done ) {
+        if ( nmin >= 0 ) {
+            gsl_sf_bessel_Jn_array( nmin, nmax, ax, Jn );
+        } else if ( nmax <= 0 ) {
+            // orders -nmax ... -nmin, then reverse them
+            gsl_sf_bessel_Jn_array( -nmax, -nmin, ax, Jn );
+            for ( i=0; i<nn/2; i++ ) { t = Jn[i]; Jn[i] = Jn[nn-1-i]; Jn[nn-1-i] = t; }
+        } else {
+            for ( i=0; i<nn; i++ ) Jn[i] = gsl_sf_bessel_Jn( abs(nmin+i), ax );
+        }
+    }
+
+    /*
+     * So far we have J_|n|(|x|). Each of n<0 and x<0 contributes a factor
+     * of (-1)^n, so the sign flips only for odd n when exactly one of them
+     * holds.
+     */
+    for ( i=0; i<nn; i++ ) {
+        n = nmin+i;
+        if ( (abs(n)&1) && ( (n<0) != (x<0.0) ) ) Jn[i] = -Jn[i];
+    }
+
+}
+
+
+
+
 /*
  * This uses hermite interp. May be slower than using bess function in the first place !
  */
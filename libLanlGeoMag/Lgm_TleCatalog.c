@@ -0,0 +1,375 @@
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "Lgm/Lgm_Sgp.h"
+#include "Lgm/Lgm_TleCatalog.h"
+#include "Lgm/qsort.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/*
+ *  Entries collected while building a catalog. Seq is the order in which the
+ *  element sets were read, so that when the same epoch of the same object
+ *  turns up more than once the one read last wins.
+ */
+typedef struct TleCatEnt {
+    int         IdNumber;
+    double      JD;
+    long int    Seq;
+} TleCatEnt;
+
+#define TLECAT_ENT_LT(a,b) ( ((a)->IdNumber < (b)->IdNumber) || ( ((a)->IdNumber == (b)->IdNumber) \
+                           && ( ((a)->JD < (b)->JD) || ( ((a)->JD == (b)->JD) && ((a)->Seq < (b)->Seq) ) ) ) )
+
+static void TleCatSortEnts( long int n, TleCatEnt *e ) {
+    QSORT( TleCatEnt, e, n, TLECAT_ENT_LT );
+}
+
+/*
+ *  Strip the line terminators (which may be dos style) and any trailing blanks.
+ */
+static void TleCatTrim( char *Line ) {
+    int n = (int)strlen( Line );
+    while ( ( n > 0 ) && ( ( Line[n-1] == '\n' ) || ( Line[n-1] == '\r' ) || ( Line[n-1] == ' ' ) || ( Line[n-1] == '\t' ) ) ) Line[--n] = '\0';
+}
+
+/*
+ *  Checks an element set the same way LgmSgp_ReadTlesFromFile() does (line
+ *  numbers and checksums), and also that both lines are for the same object.
+ */
+static int TleCatValid( char *Line1, char *Line2 ) {
+
+    if ( ( strlen( Line1 ) < 69 ) || ( strlen( Line2 ) < 69 ) ) return( FALSE );
+    if ( ( Line1[0] != '1' ) || ( Line2[0] != '2' ) ) return( FALSE );
+    if ( (int)(Line1[68]-'0') != LgmSgp_TleChecksum( Line1 ) ) return( FALSE );
+    if ( (int)(Line2[68]-'0') != LgmSgp_TleChecksum( Line2 ) ) return( FALSE );
+    if ( strncmp( Line1+2, Line2+2, 5 ) != 0 ) return( FALSE );
+
+    return( TRUE );
+
+}
+
+
+/*
+ *  Builds a binary TLE catalog (see Lgm_TleCatalog.h) from the text TLE files
+ *  InFiles[0..nInFiles-1]. The element sets may be in 3 line (name, line 1,
+ *  line 2; a leading "0 " on the name is dropped) or 2 line format. The whole
+ *  catalog is held in memory while it is sorted (about 200 bytes per element
+ *  set).
+ *
+ *  Returns the number of element sets written, or a negative value on failure.
+ */
+int Lgm_TleCatalog_Build( char *OutFile, int nInFiles, char **InFiles, int Verbosity ) {
+
+    FILE                *fp;
+    char                Line[256], Line2[256], Name[256], L1[80], L2[80];
+    int                 f, GotLine;
+    long int            i, j, n, nMax, nRejected, nSat, nTle;
+    TleCatEnt           *Ent;
+    Lgm_TleCatRec       *Rec, *Out;
+    Lgm_TleCatSat       *Sat;
+    double              *JD;
+    Lgm_TleCatHeader    h;
+    _SgpTLE             *TLE;
+
+    n = 0; nMax = 1024; nRejected = 0;
+    Ent = (TleCatEnt *)calloc( nMax, sizeof(TleCatEnt) );
+    Rec = (Lgm_TleCatRec *)calloc( nMax, sizeof(Lgm_TleCatRec) );
+    TLE = (_SgpTLE *)calloc( 1, sizeof(_SgpTLE) );
+
+    /*
+     *  Read and validate the element sets.
+     */
+    for ( f=0; f<nInFiles; f++ ) {
+
+        if ( ( fp = fopen( InFiles[f], "rb" ) ) == NULL ) {
+            printf("Lgm_TleCatalog_Build: could not open TLE file %s\n", InFiles[f] );
+            continue;
+        }
+        if ( Verbosity > 0 ) printf("Lgm_TleCatalog_Build: reading %s\n", InFiles[f] );
+
+        Name[0] = '\0';
+        GotLine = ( fgets( Line, 256, fp ) != NULL );
+        while ( GotLine ) {
+
+            TleCatTrim( Line );
+
+            if ( ( Line[0] != '1' ) || ( Line[1] != ' ' ) ) {
+                // Not a line 1 -- take it to be the name of the next element set.
+                strcpy( Name, ( strncmp( Line, "0 ", 2 ) == 0 ) ? Line+2 : Line );
+                GotLine = ( fgets( Line, 256, fp ) != NULL );
+                continue;
+            }
+
+            if ( fgets( Line2, 256, fp ) == NULL ) {
+                ++nRejected;
+                break;
+            }
+            TleCatTrim( Line2 );
+
+            if ( !TleCatValid( Line, Line2 ) ) {
+                if ( Verbosity > 1 ) printf("Lgm_TleCatalog_Build: rejecting invalid TLE in %s:\n\t%s\n\t%s\n", InFiles[f], Line, Line2 );
+                ++nRejected;
+            } else {
+
+                if ( n >= nMax ) {
+                    nMax *= 2;
+                    Ent = (TleCatEnt *)realloc( Ent, nMax*sizeof(TleCatEnt) );
+                    Rec = (Lgm_TleCatRec *)realloc( Rec, nMax*sizeof(Lgm_TleCatRec) );
+                }
+
+                memset( &Rec[n], 0, sizeof(Lgm_TleCatRec) );
+                snprintf( Rec[n].Line0, sizeof(Rec[n].Line0), "%.*s", (int)sizeof(Rec[n].Line0)-1, Name );
+                memcpy( Rec[n].Line1, Line,  69 );     // TleCatValid() made sure there are at least 69 columns
+                memcpy( Rec[n].Line2, Line2, 69 );
+
+                // Lgm_SgpDecodeTle() can modify the lines, so decode copies.
+                strcpy( L1, Rec[n].Line1 ); strcpy( L2, Rec[n].Line2 );
+                Lgm_SgpDecodeTle( Rec[n].Line0, L1, L2, TLE, 0 );
+                Ent[n].IdNumber = TLE->IdNumber;
+                Ent[n].JD       = TLE->JD;
+                Ent[n].Seq      = n;
+                ++n;
+
+            }
+            Name[0] = '\0';
+            GotLine = ( fgets( Line, 256, fp ) != NULL );
+
+        }
+        fclose( fp );
+
+    }
+    free( TLE );
+
+    /*
+     *  Sort by ID then epoch, and drop repeated epochs (keeping the one read last).
+     */
+    TleCatSortEnts( n, Ent );
+    for ( nTle=0, i=0; i<n; i++ ) {
+        if ( ( i+1 < n ) && ( Ent[i+1].IdNumber == Ent[i].IdNumber ) && ( Ent[i+1].JD == Ent[i].JD ) ) continue;
+        Ent[nTle++] = Ent[i];
+    }
+    for ( nSat=0, i=0; i<nTle; i++ ) {
+        if ( ( i == 0 ) || ( Ent[i].IdNumber != Ent[i-1].IdNumber ) ) ++nSat;
+    }
+
+    Sat = (Lgm_TleCatSat *)calloc( nSat > 0 ? nSat : 1, sizeof(Lgm_TleCatSat) );
+    JD  = (double *)calloc( nTle > 0 ? nTle : 1, sizeof(double) );
+    for ( j=-1, i=0; i<nTle; i++ ) {
+        if ( ( i == 0 ) || ( Ent[i].IdNumber != Ent[i-1].IdNumber ) ) {
+            ++j;
+            Sat[j].IdNumber = Ent[i].IdNumber;
+            Sat[j].Start    = i;
+        }
+        ++Sat[j].nTle;
+        JD[i] = Ent[i].JD;
+    }
+
+    /*
+     *  Write it out. The arrays start on a page boundary (and every element
+     *  size is a multiple of 8 bytes, so they all stay aligned).
+     */
+    memset( &h, 0, sizeof(h) );
+    memcpy( h.Magic, LGM_TLECAT_MAGIC, 8 );
+    h.Version     = LGM_TLECAT_VERSION;
+    h.ByteOrder   = LGM_TLECAT_BYTEORDER;
+    h.nSat        = nSat;
+    h.nTle        = nTle;
+    h.nRejected   = nRejected;
+    h.SatOffset   = 4096;
+    h.EpochOffset = h.SatOffset   + nSat*(long int)sizeof(Lgm_TleCatSat);
+    h.RecOffset   = h.EpochOffset + nTle*(long int)sizeof(double);
+
+    if ( ( fp = fopen( OutFile, "wb" ) ) == NULL ) {
+        printf("Lgm_TleCatalog_Build: could not open %s for writing\n", OutFile );
+        free( Ent ); free( Rec ); free( Sat ); free( JD );
+        return( -1 );
+    }
+    if ( ( fwrite( &h, sizeof(h), 1, fp ) != 1 ) || ( fseek( fp, h.SatOffset, SEEK_SET ) != 0 )
+            || ( fwrite( Sat, sizeof(Lgm_TleCatSat), (size_t)nSat, fp ) != (size_t)nSat )
+            || ( fwrite( JD, sizeof(double), (size_t)nTle, fp ) != (size_t)nTle ) ) {
+        printf("Lgm_TleCatalog_Build: error writing index to %s\n", OutFile );
+        fclose( fp );
+        free( Ent ); free( Rec ); free( Sat ); free( JD );
+        return( -2 );
+    }
+    for ( i=0; i<nTle; i++ ) {
+        Out = &Rec[ Ent[i].Seq ];
+        if ( fwrite( Out, sizeof(Lgm_TleCatRec), 1, fp ) != 1 ) {
+            printf("Lgm_TleCatalog_Build: error writing records to %s\n", OutFile );
+            fclose( fp );
+            free( Ent ); free( Rec ); free( Sat ); free( JD );
+            return( -3 );
+        }
+    }
+
+    free( Ent ); free( Rec ); free( Sat ); free( JD );
+    if ( fclose( fp ) != 0 ) return( -4 );
+
+    if ( Verbosity > 0 ) {
+        printf("Lgm_TleCatalog_Build: wrote %ld TLEs for %ld objects to %s (%ld invalid, %ld duplicates dropped)\n",
+                nTle, nSat, OutFile, nRejected, n-nTle );
+    }
+
+    return( (int)nTle );
+
+}
+
+
+/*
+ *  Maps a catalog written by Lgm_TleCatalog_Build(). Returns NULL on failure.
+ */
+Lgm_TleCatalog *Lgm_TleCatalog_Open( char *Filename, int Verbosity ) {
+
+    int                 fd;
+    struct stat         StatBuf;
+    void                *Addr;
+    Lgm_TleCatHeader    *h;
+    Lgm_TleCatalog      *c;
+
+    if ( ( fd = open( Filename, O_RDONLY ) ) < 0 ) {
+        if ( Verbosity > 0 ) printf("Lgm_TleCatalog_Open: could not open %s\n", Filename );
+        return( NULL );
+    }
+    if ( ( fstat( fd, &StatBuf ) < 0 ) || ( StatBuf.st_size < (off_t)sizeof(Lgm_TleCatHeader) ) ) {
+        printf("Lgm_TleCatalog_Open: %s is too short to be a TLE catalog\n", Filename );
+        close( fd );
+        return( NULL );
+    }
+    Addr = mmap( NULL, (size_t)StatBuf.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( Addr == MAP_FAILED ) {
+        printf("Lgm_TleCatalog_Open: could not map %s\n", Filename );
+        return( NULL );
+    }
+
+    h = (Lgm_TleCatHeader *)Addr;
+    if ( ( strncmp( h->Magic, LGM_TLECAT_MAGIC, 8 ) != 0 ) || ( h->Version != LGM_TLECAT_VERSION ) || ( h->ByteOrder != LGM_TLECAT_BYTEORDER ) ) {
+        printf("Lgm_TleCatalog_Open: %s is not a TLE catalog written on this kind of machine\n", Filename );
+        munmap( Addr, (size_t)StatBuf.st_size );
+        return( NULL );
+    }
+    if ( ( h->nSat < 0 ) || ( h->nTle < 0 )
+            || ( h->EpochOffset != h->SatOffset   + h->nSat*(long int)sizeof(Lgm_TleCatSat) )
+            || ( h->RecOffset   != h->EpochOffset + h->nTle*(long int)sizeof(double) )
+            || ( h->RecOffset + h->nTle*(long int)sizeof(Lgm_TleCatRec) > (long int)StatBuf.st_size ) ) {
+        printf("Lgm_TleCatalog_Open: %s is truncated or corrupt\n", Filename );
+        munmap( Addr, (size_t)StatBuf.st_size );
+        return( NULL );
+    }
+
+    c = (Lgm_TleCatalog *)calloc( 1, sizeof(Lgm_TleCatalog) );
+    c->nSat      = h->nSat;
+    c->nTle      = h->nTle;
+    c->Sat       = (Lgm_TleCatSat *)((char *)Addr + h->SatOffset);
+    c->JD        = (double *)((char *)Addr + h->EpochOffset);
+    c->Rec       = (Lgm_TleCatRec *)((char *)Addr + h->RecOffset);
+    c->MapAddr   = Addr;
+    c->MapSize   = (long int)StatBuf.st_size;
+    c->Verbosity = Verbosity;
+
+    if ( Verbosity > 1 ) printf("Lgm_TleCatalog_Open: mapped %ld TLEs for %ld objects from %s\n", c->nTle, c->nSat, Filename );
+
+    return( c );
+
+}
+
+void Lgm_TleCatalog_Close( Lgm_TleCatalog *c ) {
+
+    if ( c == NULL ) return;
+    munmap( c->MapAddr, (size_t)c->MapSize );
+    free( c );
+
+}
+
+
+/*
+ *  Returns the index into c->Sat of the object IdNumber, or -1 if it is not
+ *  in the catalog.
+ */
+long int Lgm_TleCatalog_FindSat( int IdNumber, Lgm_TleCatalog *c ) {
+
+    long int    il, ih, im;
+
+    il = 0; ih = c->nSat-1;
+    while ( il <= ih ) {
+        im = (il+ih)/2;
+        if      ( c->Sat[im].IdNumber < IdNumber ) il = im+1;
+        else if ( c->Sat[im].IdNumber > IdNumber ) ih = im-1;
+        else return( im );
+    }
+
+    return( -1 );
+
+}
+
+
+/*
+ *  For the object IdNumber, returns the index (into c->JD and c->Rec) of the
+ *  most recent TLE with an epoch at or before JD. This is the same choice as
+ *  LgmSgp_FindTLEforGivenTime() makes for times strictly between the first
+ *  and last epochs. At or after the last epoch this returns the last TLE
+ *  (LgmSgp_FindTLEforGivenTime() returns the second-to-last one at exactly
+ *  the last epoch, and -1 after it). Returns -1 if the object is not in the
+ *  catalog or JD is before its first TLE.
+ */
+long int Lgm_TleCatalog_FindTLEforGivenTime( int IdNumber, double JD, Lgm_TleCatalog *c ) {
+
+    long int    k, il, ih, im;
+
+    if ( ( k = Lgm_TleCatalog_FindSat( IdNumber, c ) ) < 0 ) {
+        if ( c->Verbosity > 0 ) printf("Lgm_TleCatalog_FindTLEforGivenTime: object %d is not in the catalog\n", IdNumber );
+        return( -1 );
+    }
+
+    il = c->Sat[k].Start;
+    ih = il + c->Sat[k].nTle - 1;
+    if ( JD < c->JD[il] ) {
+        if ( c->Verbosity > 0 ) printf("Lgm_TleCatalog_FindTLEforGivenTime: requested time (JD = %lf) is before the earliest TLE for object %d (JD = %lf)\n", JD, IdNumber, c->JD[il] );
+        return( -1 );
+    }
+    if ( JD >= c->JD[ih] ) return( ih );
+
+    // Invariant: JD[il] <= JD < JD[ih]
+    while ( ih - il > 1 ) {
+        im = (il+ih)/2;
+        if ( c->JD[im] > JD ) ih = im;
+        else                  il = im;
+    }
+
+    return( il );
+
+}
+
+
+/*
+ *  Decodes TLE i of the catalog into TLE. Returns TRUE on success.
+ */
+int Lgm_TleCatalog_GetTLE( long int i, _SgpTLE *TLE, Lgm_TleCatalog *c ) {
+
+    char    Line0[32], Line1[72], Line2[72];
+
+    if ( ( i < 0 ) || ( i >= c->nTle ) ) return( FALSE );
+
+    // The mapping is read-only and Lgm_SgpDecodeTle() can modify the lines.
+    memcpy( Line0, c->Rec[i].Line0, sizeof(Line0) );
+    memcpy( Line1, c->Rec[i].Line1, sizeof(Line1) );
+    memcpy( Line2, c->Rec[i].Line2, sizeof(Line2) );
+    Lgm_SgpDecodeTle( Line0, Line1, Line2, TLE, c->Verbosity );
+
+    return( TRUE );
+
+}
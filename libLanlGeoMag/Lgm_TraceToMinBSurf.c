@@ -30,6 +30,20 @@
 #include <stdlib.h>
 #include "Lgm/Lgm_MagModelInfo.h"
 
+/*
+ *  Position along the bracket [Sa0, Sc0] from the continuous output of the two
+ *  Lgm_MagStep_DP5() steps that span it (Pa->Pb and Pb->Pc).
+ */
+static int MinB_DenseInterp( double S, double Sa0, double Sb0, Lgm_MagStep_DenseOutput *DenseAB, Lgm_MagStep_DenseOutput *DenseBC, Lgm_Vector *P ) {
+
+    if ( S <= Sb0 ) {
+        return( Lgm_MagStep_DP5_Interp( S-Sa0, DenseAB, P ) );
+    } else {
+        return( Lgm_MagStep_DP5_Interp( S-Sb0, DenseBC, P ) );
+    }
+
+}
+
 int Lgm_TraceToMinBSurf( Lgm_Vector *u, Lgm_Vector *v, double Htry, double tol, Lgm_MagModelInfo *Info ) {
 
     Lgm_Vector	u_scale;
@@ -38,8 +52,11 @@ int Lgm_TraceToMinBSurf( Lgm_Vector *u, Lgm_Vector *v, double Htry, double tol,
     double	    Ba, Bb, Bc, B, B2, R;
     Lgm_Vector	Btmp;
     Lgm_Vector	Pa, Pb, Pc, P, P2;
-    int		    done, reset=TRUE;
+    int		    done, reset=TRUE, UseDense;
     double s2 = 0.0;
+    double      Sa0, Sb0, Sc0, Ba0, Bb0, Bc0, St;
+    Lgm_Vector  Pa0, Pb0, Pc0;
+    Lgm_MagStep_DenseOutput DenseAB, DenseBC;
 
 
 
@@ -74,7 +91,7 @@ int Lgm_TraceToMinBSurf( Lgm_Vector *u, Lgm_Vector *v, double Htry, double tol,
      */
     Pa   = *u;
     R    = Lgm_Magnitude( &Pa );
-    Info->Bfield( &Pa, &Btmp, Info );
+    if ( Info->Bfield( &Pa, &Btmp, Info ) == 0 ) return(-1);
     Ba   = Lgm_Magnitude( &Btmp );
     Sa   = 0.0;
 
@@ -103,22 +120,25 @@ int Lgm_TraceToMinBSurf( Lgm_Vector *u, Lgm_Vector *v, double Htry, double tol,
     P = Pa;
     //reset = TRUE;
     if ( Lgm_MagStep( &P, &u_scale, Htry, &Hdid, &Hnext, -1.0, &s, &reset, Info->Bfield, Info ) < 0 ) return(-1);
-    Info->Bfield( &P, &Btmp, Info );
+    if ( Info->Bfield( &P, &Btmp, Info ) == 0 ) return(-1);
     B = Lgm_Magnitude( &Btmp );
 //printf("NEG: P, B  = %g %g %g %g\n", P.x, P.y, P.z, B); 
 
+    DenseAB.Valid = DenseBC.Valid = FALSE;
+    UseDense = ( Info->Lgm_MagStep_Integrator == LGM_MAGSTEP_ODE_DP5 ) ? TRUE : FALSE;
     if ( B < Ba ) {
 
 	    Pb  = P;
 	    Bb  = B;
 	    Sb  = Hdid;
 	    sgn = -1.0;     // We should move in direction opposite the field direction.
+        DenseAB = Info->Lgm_MagStep_DP5_Dense;
 
     } else {
 
         P2 = Pa; //reset = TRUE;
         if ( Lgm_MagStep( &P2, &u_scale, Htry, &Hdid, &Hnext, 1.0, &s2, &reset, Info->Bfield, Info ) < 0 ) return(-1);
-        Info->Bfield( &P2, &Btmp, Info );
+        if ( Info->Bfield( &P2, &Btmp, Info ) == 0 ) return(-1);
         B2 = Lgm_Magnitude( &Btmp );
 //printf("POS: P2, B2  = %g %g %g %g\n", P2.x, P2.y, P2.z, B2); 
 
@@ -127,15 +147,19 @@ int Lgm_TraceToMinBSurf( Lgm_Vector *u, Lgm_Vector *v, double Htry, double tol,
             Bb  = B2;
             Sb  = Hdid;
 	        sgn = 1.0;      // We should move in direction with the field direction.
+            DenseAB = Info->Lgm_MagStep_DP5_Dense;
 	    } else {
 	        /*
 	         *  We must have already bracketed the min.
+             *  (The two steps here went in opposite directions, so dont try to
+             *  use the dense output.)
 	         */
 	        Pb   = Pa;  Bb = Ba; Sb = Sa;
 	        Pa   = P;   Ba = B;  Sa = -s;
 	        Pc   = P2;  Bc = B2; Sc = s2;
 	        sgn  = 1.0;
 	        done = TRUE;
+            UseDense = FALSE;
 	    }
 
     }
@@ -156,12 +180,13 @@ int Lgm_TraceToMinBSurf( Lgm_Vector *u, Lgm_Vector *v, double Htry, double tol,
 
 	    P = Pb;
         if ( Lgm_MagStep( &P, &u_scale, Htry, &Hdid, &Hnext, sgn, &s, &reset, Info->Bfield, Info ) < 0 ) return(-1);
-        Info->Bfield( &P, &Btmp, Info );
+        if ( Info->Bfield( &P, &Btmp, Info ) == 0 ) return(-1);
         B = Lgm_Magnitude( &Btmp );
 
 	    if ( B < Bb ) {
 	        Pa = Pb; Ba = Bb; Sa = Sb;
 	        Pb = P;  Bb = B;  Sb = Sa + Hdid;
+            DenseAB = Info->Lgm_MagStep_DP5_Dense;
             if (   (P.x > Info->OpenLimit_xMax) || (P.x < Info->OpenLimit_xMin) || (P.y > Info->OpenLimit_yMax) || (P.y < Info->OpenLimit_yMin)
                     || (P.z > Info->OpenLimit_zMax) || (P.z < Info->OpenLimit_zMin) || ( s > 1000.0 ) ) {
 		        /*
@@ -184,6 +209,7 @@ int Lgm_TraceToMinBSurf( Lgm_Vector *u, Lgm_Vector *v, double Htry, double tol,
 	        }
 	    } else {
 	        Pc = P;  Bc = B; Sc = Sb + Hdid;
+            DenseBC = Info->Lgm_MagStep_DP5_Dense;
 	        done = TRUE;
 	    }
 
@@ -205,8 +231,74 @@ int Lgm_TraceToMinBSurf( Lgm_Vector *u, Lgm_Vector *v, double Htry, double tol,
      *  Use golden-section search to converge toward minimum.
      *  (Sa, Sb, Sc) are the distances of the triple points along
      *  the FL.
+     *
+     *  With the DP5 integrator, the bracket is covered by the continuous
+     *  output of the last two steps, so trial points can be had for a single
+     *  B-field evaluation each instead of a full step.
      */
-if (1==1){
+    UseDense = UseDense && DenseAB.Valid && DenseBC.Valid
+                && ( fabs( DenseAB.Hdid - (Sb-Sa) ) < 1e-12 ) && ( fabs( DenseBC.Hdid - (Sc-Sb) ) < 1e-12 );
+if ( UseDense ) {
+    Sa0 = Sa; Sb0 = Sb; Sc0 = Sc;
+    Pa0 = Pa; Pb0 = Pb; Pc0 = Pc;
+    Ba0 = Ba; Bb0 = Bb; Bc0 = Bc;
+    done = FALSE;
+    while (!done) {
+
+	    d1 = Sb - Sa;
+	    d2 = Sc - Sb;
+	    if ( (Sc-Sa) < tol ) {
+
+	        done = TRUE;
+
+	    } else if ( d1 > d2 ) {
+
+            St = Sa + 0.5*d1;
+            if ( !MinB_DenseInterp( St, Sa0, Sb0, &DenseAB, &DenseBC, &P ) || ( Info->Bfield( &P, &Btmp, Info ) == 0 ) ) {
+                UseDense = FALSE;
+                break;
+            }
+            ++(Info->Lgm_nMagEvals);
+            B = Lgm_Magnitude( &Btmp );
+	        if ( B < Bb ) {
+                Pc = Pb; Bc = Bb; Sc = Sb;
+		        Pb = P;  Bb = B;  Sb = St;
+	        } else {
+		        Pa = P;  Ba = B;  Sa = St;
+	        }
+
+	    } else {
+
+            St = Sb + 0.5*d2;
+            if ( !MinB_DenseInterp( St, Sa0, Sb0, &DenseAB, &DenseBC, &P ) || ( Info->Bfield( &P, &Btmp, Info ) == 0 ) ) {
+                UseDense = FALSE;
+                break;
+            }
+            ++(Info->Lgm_nMagEvals);
+            B = Lgm_Magnitude( &Btmp );
+	        if ( B < Bb ) {
+                Pa = Pb; Ba = Bb; Sa = Sb;
+		        Pb = P;  Bb = B;  Sb = St;
+	        } else {
+		        Pc = P;  Bc = B;  Sc = St;
+	        }
+
+	    }
+
+    }
+
+    if ( !UseDense ) {
+        /*
+         *  The interpolant or the B-field failed. Go back to the original
+         *  bracket and do it by stepping instead.
+         */
+        if ( Info->VerbosityLevel > 1 ) printf("Lgm_TraceToMinBSurf(): Search on the DP5 interpolant failed, falling back to stepping.\n");
+        Sa = Sa0; Sb = Sb0; Sc = Sc0;
+        Pa = Pa0; Pb = Pb0; Pc = Pc0;
+        Ba = Ba0; Bb = Bb0; Bc = Bc0;
+    }
+}
+if ( !UseDense ) {
     done = FALSE;
 //reset=TRUE;
     while (!done) {
@@ -223,7 +315,7 @@ if (1==1){
 	        P = Pa; Htry = 0.5*d1;
 //printf("A. Sa, Sb, Sc = %g %g %g   d1, d2 = %g %g Htry = %g tol = %g Sc-Sa = %g\n", Sa, Sb, Sc, d1, d2, Htry, tol, Sc-Sa);
             if ( Lgm_MagStep( &P, &u_scale, Htry, &Hdid, &Hnext, sgn, &s, &reset, Info->Bfield, Info ) < 0 ) return(-1);
-            Info->Bfield( &P, &Btmp, Info );
+            if ( Info->Bfield( &P, &Btmp, Info ) == 0 ) return(-1);
             B = Lgm_Magnitude( &Btmp );
 //printf("A. B = %g\n", B);
 
@@ -240,7 +332,7 @@ if (1==1){
 	        P = Pb; Htry = 0.5*d2;
 //printf("B. Sa, Sb, Sc = %g %g %g   d1, d2 = %g %g Htry = %g tol = %g Sc-Sa = %g\n", Sa, Sb, Sc, d1, d2, Htry, tol, Sc-Sa);
             if ( Lgm_MagStep( &P, &u_scale, Htry, &Hdid, &Hnext, sgn, &s, &reset, Info->Bfield, Info ) < 0 ) return(-1);
-            Info->Bfield( &P, &Btmp, Info );
+            if ( Info->Bfield( &P, &Btmp, Info ) == 0 ) return(-1);
             B = Lgm_Magnitude( &Btmp );
 //printf("B. P = %g %g %g B = %g\n", P.x, P.y, P.z, B);
 
@@ -58,6 +58,37 @@ double mpFunc( Lgm_Vector *P, double Bm, Lgm_MagModelInfo *Info ){
 
 }
 
+/*
+ *  B - Bm evaluated on the continuous output of the last Lgm_MagStep_DP5()
+ *  step. ds is the distance from the start of that step. Used with
+ *  Lgm_zBrent() so that each root-finding iteration costs a single B-field
+ *  evaluation rather than a full step.
+ */
+typedef struct mpDenseInfo {
+    Lgm_MagStep_DenseOutput Dense;
+    Lgm_MagModelInfo        *Info;
+    int                     Failed;
+} mpDenseInfo;
+
+static double mpDenseFunc( double ds, double Bm, void *Data ){
+
+    mpDenseInfo *d = (mpDenseInfo *)Data;
+    Lgm_Vector  P, Bvec;
+
+    /*
+     * If the interpolant or the B-field fails, flag it and return 0 so that
+     * Lgm_zBrent() stops right away. The caller checks Failed.
+     */
+    if ( d->Failed ) return( 0.0 );
+    if ( !Lgm_MagStep_DP5_Interp( ds, &d->Dense, &P ) || ( d->Info->Bfield( &P, &Bvec, d->Info ) == 0 ) ) {
+        d->Failed = TRUE;
+        return( 0.0 );
+    }
+    ++(d->Info->Lgm_nMagEvals);
+    return( Lgm_Magnitude( &Bvec ) - Bm );
+
+}
+
 int Lgm_TraceToMirrorPoint( Lgm_Vector *u, Lgm_Vector *v, double *Sm, double Bm, double sgn, double tol, Lgm_MagModelInfo *Info ) {
 
     Lgm_Vector	u_scale;
@@ -66,7 +97,7 @@ int Lgm_TraceToMirrorPoint( Lgm_Vector *u, Lgm_Vector *v, double *Sm, double Bm,
     double	    Rlc, R, Fa, Fb, F, Fmin, B, Fs, Fn;
     double	    Ra, Rb, Height;
     Lgm_Vector	w, Pa, Pb, P, Bvec, Pmin;
-    int		    done, FoundBracket, reset, nIts, nSteps;
+    int		    done, FoundBracket, reset, nIts, nSteps, UsedDense;
     double      MinValidHeight;
 
     reset = TRUE;
@@ -128,7 +159,7 @@ int Lgm_TraceToMirrorPoint( Lgm_Vector *u, Lgm_Vector *v, double *Sm, double Bm,
      *  a very small number, so it cant be used as the first point of the
      *  bracket. Instead, we need to step a tiny bit to get the first bracket.
      */
-    Info->Bfield( u, &Bvec, Info );
+    if ( Info->Bfield( u, &Bvec, Info ) == 0 ) return( LGM_BAD_TRACE );
     Pa = *u;
     Pb.x = Pb.y = Pb.z = 0.0;
     Ra = Lgm_Magnitude( &Pa );
@@ -156,7 +187,7 @@ int Lgm_TraceToMirrorPoint( Lgm_Vector *u, Lgm_Vector *v, double *Sm, double Bm,
         Htry = 0.1; // Some mirror point pairs may be closer thogether than this. If we fail, we need to try with a smaller value here.
         P = *u;
         if ( Lgm_MagStep( &P, &u_scale, Htry, &Hdid, &Hnext, sgn, &s, &reset, Info->Bfield, Info ) < 0 ) return( LGM_BAD_TRACE );
-        Info->Bfield( &P, &Bvec, Info );
+        if ( Info->Bfield( &P, &Bvec, Info ) == 0 ) return( LGM_BAD_TRACE );
         B = Lgm_Magnitude( &Bvec );
         F = B-Bm;
         if (fabs(F)<Fmin) { Fmin = fabs(F); Pmin = P; }
@@ -184,7 +215,7 @@ int Lgm_TraceToMirrorPoint( Lgm_Vector *u, Lgm_Vector *v, double *Sm, double Bm,
             Htry = 1e-6; // we probably dont ever need to split the mirror points to any finer precision than this(?).
             P    = *u;
             if ( Lgm_MagStep( &P, &u_scale, Htry, &Hdid, &Hnext, sgn, &s, &reset, Info->Bfield, Info ) < 0 ) return( LGM_BAD_TRACE );
-            Info->Bfield( &P, &Bvec, Info );
+            if ( Info->Bfield( &P, &Bvec, Info ) == 0 ) return( LGM_BAD_TRACE );
             B = Lgm_Magnitude( &Bvec );
             F = B-Bm;
             if (fabs(F)<Fmin) { Fmin = fabs(F); Pmin = P; }
@@ -255,7 +286,7 @@ int Lgm_TraceToMirrorPoint( Lgm_Vector *u, Lgm_Vector *v, double *Sm, double Bm,
         /*
          *  Get value of quantity we want to minimize
          */
-        Info->Bfield( &P, &Bvec, Info );
+        if ( Info->Bfield( &P, &Bvec, Info ) == 0 ) return(-1);
 //printf("P = %.15lf %.15lf %.15lf    Bvec = %g %g %g \n", P.x, P.y, P.z, Bvec.x, Bvec.y, Bvec.z );
         R = Lgm_Magnitude( &P );
         F = Lgm_Magnitude( &Bvec ) - Bm;
@@ -389,8 +420,42 @@ if (Htry < 0.01) Htry = 0.01;
          *  Earth, we could stop here: it must hit the Earth or we wouldnt
          *  have a minimum bracketed.)
          *
+         *  If we are using the DP5 integrator, the last step taken was exactly
+         *  Pa->Pb and we have a continuous interpolant over it. Find the root
+         *  on the interpolant with Brent's method instead of re-stepping.
+         *
          */
-    if (1==1){
+    UsedDense = FALSE;
+    if ( ( Info->Lgm_MagStep_Integrator == LGM_MAGSTEP_ODE_DP5 ) && Info->Lgm_MagStep_DP5_Dense.Valid
+            && ( fabs( Info->Lgm_MagStep_DP5_Dense.Hdid - (Sb-Sa) ) < 1e-12 ) ) {
+
+        double          dSz, Fz;
+        mpDenseInfo     dd;
+        BrentFuncInfo   f;
+
+        dd.Dense  = Info->Lgm_MagStep_DP5_Dense;
+        dd.Info   = Info;
+        dd.Failed = FALSE;
+        f.Val     = Bm;
+        f.Info    = (void *)&dd;
+        f.func    = &mpDenseFunc;
+        if ( Lgm_zBrent( 0.0, Sb-Sa, Fa, Fb, &f, tol, &dSz, &Fz ) && !dd.Failed ) {
+            Lgm_MagStep_DP5_Interp( dSz, &dd.Dense, &Pb );
+            Sb = Sa + dSz;
+            Fb = Fz;
+            nIts = 0;
+            UsedDense = TRUE;
+        } else if ( Info->VerbosityLevel > 1 ) {
+            printf("Lgm_TraceToMirrorPoint(): Root finding on the DP5 interpolant failed, falling back to stepping.\n");
+        }
+
+    }
+
+    /*
+     * Otherwise (or if the interpolant could not be used) bisect by stepping
+     * from Pa.
+     */
+    if ( !UsedDense ) {
         done  = FALSE;
         //reset = TRUE;
         if ( Info->VerbosityLevel > 4 ) nIts = 0;
@@ -409,7 +474,7 @@ if (Htry < 0.01) Htry = 0.01;
                 //P = Pa; Htry = 0.5*d;
                 P = Pa; Htry = LGM_1_OVER_GOLD*d;
                 if ( Lgm_MagStep( &P, &u_scale, Htry, &Hdid, &Hnext, sgn, &s, &reset, Info->Bfield, Info ) < 0 ) return(-1);
-                Info->Bfield( &P, &Bvec, Info );
+                if ( Info->Bfield( &P, &Bvec, Info ) == 0 ) return(-1);
                 F = Lgm_Magnitude( &Bvec ) - Bm;
                 if ( F >= 0.0 ) {
                     Pb = P; Fb = F; Sb = Sa + Hdid;
@@ -0,0 +1,278 @@
+/*! \file Lgm_TraceWithEvents.c
+ *
+ *  \brief Trace along a field line and stop on (or record) user-defined events.
+ *
+ *  The specialized Trace routines (Lgm_TraceToMirrorPoint(),
+ *  Lgm_TraceToMinBSurf(), Lgm_TraceToYZPlane(), etc.) all follow the same
+ *  pattern: step along the FL until some function of position changes sign,
+ *  then home in on the root by re-stepping from one end of the bracket. Each
+ *  of those re-steps costs a full set of B-field evaluations.
+ *
+ *  Lgm_TraceWithEvents() does the stepping with the Dormand-Prince
+ *  integrator (Lgm_MagStep_DP5()) and refines each root on the continuous
+ *  output of the step in which the sign change was detected. A refinement
+ *  iteration then costs a single B-field evaluation. Any number of events can
+ *  be monitored at once; each can be terminal (stop the trace) or not (just
+ *  record where it happened).
+ *
+ *  A few event functions are provided;
+ *
+ *      Lgm_TraceEvent_BminusBm()   g = |B| - Val       (e.g. mirror points, Val = Bm)
+ *      Lgm_TraceEvent_R()          g = |P| - Val       (e.g. Val = Rtarget)
+ *      Lgm_TraceEvent_X()          g = P.x - Val       (e.g. Val = Xtarget, as in Lgm_TraceToYZPlane())
+ *      Lgm_TraceEvent_dBds()       g = d|B|/ds         (B extrema along the FL, Val is unused)
+ *
+ *  but any function with the same prototype can be used. Event functions are
+ *  handed the B-field that the step (or refinement iteration) already
+ *  computed, so the first three cost nothing extra. Lgm_TraceEvent_dBds()
+ *  needs |B| at two more points each time it is called (see below).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "Lgm/Lgm_MagModelInfo.h"
+
+#define FMAX(a,b)  (((a)>(b))?(a):(b))
+#define FMIN(a,b)  (((a)<(b))?(a):(b))
+
+
+double Lgm_TraceEvent_BminusBm( Lgm_Vector *P, Lgm_Vector *B, double Bm, Lgm_MagModelInfo *Info ) {
+    return( Lgm_Magnitude( B ) - Bm );
+}
+
+double Lgm_TraceEvent_R( Lgm_Vector *P, Lgm_Vector *B, double Rtarget, Lgm_MagModelInfo *Info ) {
+    return( Lgm_Magnitude( P ) - Rtarget );
+}
+
+double Lgm_TraceEvent_X( Lgm_Vector *P, Lgm_Vector *B, double Xtarget, Lgm_MagModelInfo *Info ) {
+    return( P->x - Xtarget );
+}
+
+/*
+ *  Derivative of |B| along the field direction, computed with a centered
+ *  difference. It goes from negative to positive through a B minimum when
+ *  moving parallel to B, and from positive to negative when moving
+ *  anti-parallel (sgn = -1).
+ *
+ *  The B passed in gives the direction only; the difference needs |B| at two
+ *  more points. So this costs 2 B-field evaluations on top of the step's 6
+ *  (FSAL) for every step, and 3 instead of 1 per refinement iteration. In
+ *  T89, tracing from a mirror point back to Bmin takes about 70% more
+ *  evaluations with this event than with a free one. If Bmin is all that is
+ *  needed, Lgm_TraceToMinBSurf() is cheaper.
+ */
+double Lgm_TraceEvent_dBds( Lgm_Vector *P, Lgm_Vector *B, double Val, Lgm_MagModelInfo *Info ) {
+
+    double      h = 1e-4, B1, B2;
+    Lgm_Vector  b, P1, P2, Bvec;
+
+    b = *B;
+    Lgm_NormalizeVector( &b );
+
+    P1.x = P->x - h*b.x; P1.y = P->y - h*b.y; P1.z = P->z - h*b.z;
+    P2.x = P->x + h*b.x; P2.y = P->y + h*b.y; P2.z = P->z + h*b.z;
+
+    Info->Bfield( &P1, &Bvec, Info ); B1 = Lgm_Magnitude( &Bvec );
+    Info->Bfield( &P2, &Bvec, Info ); B2 = Lgm_Magnitude( &Bvec );
+    Info->Lgm_nMagEvals += 2;
+
+    return( (B2-B1)/(2.0*h) );
+
+}
+
+
+/*
+ *  Event function evaluated on the dense output of the current step. Used
+ *  with Lgm_zBrent().
+ */
+typedef struct _TraceEventDenseInfo {
+    Lgm_MagStep_DenseOutput *Dense;
+    Lgm_TraceEvent          *Event;
+    Lgm_MagModelInfo        *Info;
+    int                     Failed;
+} _TraceEventDenseInfo;
+
+static double TraceEventDenseFunc( double ds, double Val, void *Data ) {
+
+    _TraceEventDenseInfo *d = (_TraceEventDenseInfo *)Data;
+    Lgm_Vector           P, Bvec;
+
+    // On a failure, return 0 so that Lgm_zBrent() stops. The caller checks Failed.
+    if ( d->Failed ) return( 0.0 );
+    if ( !Lgm_MagStep_DP5_Interp( ds, d->Dense, &P ) || ( d->Info->Bfield( &P, &Bvec, d->Info ) == 0 ) ) {
+        d->Failed = TRUE;
+        return( 0.0 );
+    }
+    ++(d->Info->Lgm_nMagEvals);
+    return( d->Event->Func( &P, &Bvec, Val, d->Info ) );
+
+}
+
+static int TraceEventCrossed( Lgm_TraceEvent *e, double g0, double g1 ) {
+
+    int Rising, Falling;
+
+    Rising  = ( (g0 < 0.0) && (g1 >= 0.0) ) ? TRUE : FALSE;
+    Falling = ( (g0 > 0.0) && (g1 <= 0.0) ) ? TRUE : FALSE;
+
+    if      ( e->Direction > 0 ) return( Rising );
+    else if ( e->Direction < 0 ) return( Falling );
+    else                         return( Rising || Falling );
+
+}
+
+
+/**
+ *  Trace along a field line from u (in direction sgn) and locate events.
+ *
+ *      \param[in]      u           Starting point (GSM).
+ *      \param[out]     v           Location of the terminal event that stopped the trace (or the last point reached).
+ *      \param[out]     S           Distance along the FL from u to v.
+ *      \param[in]      sgn         Direction to trace (+1.0 along B, -1.0 against B).
+ *      \param[in]      Smax        Maximum distance to trace.
+ *      \param[in,out]  Events      Array of events to monitor. On return, Found, S and P are filled in for each.
+ *      \param[in]      nEvents     Number of events.
+ *      \param[in]      tol         Tolerance (in Re along the FL) for locating events.
+ *      \param[in]      Info        Properly initialized Lgm_MagModelInfo structure.
+ *
+ *      \return  1 if a terminal event was found, 0 if Smax was reached (or the
+ *               FL left the OpenLimit box) without one, -1 if the integration failed.
+ *
+ */
+int Lgm_TraceWithEvents( Lgm_Vector *u, Lgm_Vector *v, double *S, double sgn, double Smax, Lgm_TraceEvent *Events, int nEvents, double tol, Lgm_MagModelInfo *Info ) {
+
+    Lgm_Vector              u_scale, P, Bvec, Pz;
+    Lgm_MagStep_DenseOutput Dense;
+    _TraceEventDenseInfo    d;
+    BrentFuncInfo           f;
+    double                  Htry, Hdid, Hnext, Hmin, Hmax, s, Stotal, R, dSz, Fz;
+    double                  *g_old, *g_new, *dS;
+    int                     i, n, reset, iTerm, done, *Crossed;
+
+    *S = 0.0;
+    *v = *u;
+    if ( nEvents < 0 ) return(-1);
+    for ( i=0; i<nEvents; i++ ) Events[i].Found = FALSE;
+
+    g_old   = (double *)calloc( 3*nEvents+1, sizeof(double) );
+    g_new   = g_old + nEvents;
+    dS      = g_new + nEvents;
+    Crossed = (int *)calloc( nEvents+1, sizeof(int) );
+
+    u_scale.x = u_scale.y = u_scale.z = 1.0;
+    Hmax  = FMIN( 0.5, Info->Hmax );
+    Hmin  = 1e-7;
+    reset = TRUE;
+
+
+    /*
+     *  Event values at the start point.
+     */
+    P = *u;
+    if ( Info->Bfield( &P, &Bvec, Info ) == 0 ) {
+        free( g_old ); free( Crossed );
+        return(-1);
+    }
+    for ( i=0; i<nEvents; i++ ) g_old[i] = Events[i].Func( &P, &Bvec, Events[i].Val, Info );
+
+    R    = Lgm_Magnitude( &P );
+    Htry = FMIN( 0.01, FMAX( Hmin, 0.9*(R-1.0) ) );
+    Stotal = 0.0;
+    done   = FALSE;
+    n      = 0;
+    iTerm  = -1;
+
+    while ( !done ) {
+
+        /*
+         *  Lgm_MagStep_DP5() fails on steps that are too small, so treat a
+         *  remainder below Hmin as having reached Smax.
+         */
+        if ( Smax-Stotal < Hmin ) break;
+        if ( Htry > Smax-Stotal ) Htry = Smax-Stotal;
+
+        if ( Lgm_MagStep_DP5( &P, &u_scale, Htry, &Hdid, &Hnext, Info->Lgm_MagStep_DP5_Eps, sgn, &s, &reset, Info->Bfield, Info ) < 0 ) {
+            free( g_old ); free( Crossed );
+            return(-1);
+        }
+        Dense = Info->Lgm_MagStep_DP5_Dense;
+        Bvec  = Info->Lgm_MagStep_DP5_FSAL_B; // B at the end of the step comes for free
+
+
+        /*
+         *  Check for sign changes and refine them on the interpolant.
+         */
+        iTerm = -1;
+        for ( i=0; i<nEvents; i++ ) {
+
+            g_new[i]   = Events[i].Func( &P, &Bvec, Events[i].Val, Info );
+            Crossed[i] = ( TraceEventCrossed( &Events[i], g_old[i], g_new[i] ) && ( Events[i].Terminal || !Events[i].Found ) ) ? TRUE : FALSE;
+
+            if ( Crossed[i] ) {
+
+                d.Dense = &Dense;
+                d.Event = &Events[i];
+                d.Info   = Info;
+                d.Failed = FALSE;
+                f.Val    = Events[i].Val;
+                f.Info   = (void *)&d;
+                f.func   = &TraceEventDenseFunc;
+                if ( !Lgm_zBrent( 0.0, Hdid, g_old[i], g_new[i], &f, tol, &dSz, &Fz ) ) dSz = Hdid;
+                if ( d.Failed ) {
+                    printf("Lgm_TraceWithEvents(): B-field evaluation failed while locating event %d (returning with -1)\n", i );
+                    free( g_old ); free( Crossed );
+                    return(-1);
+                }
+                dS[i] = dSz;
+
+                if ( Events[i].Terminal && ( (iTerm < 0) || (dS[i] < dS[iTerm]) ) ) iTerm = i;
+
+            }
+
+        }
+
+        for ( i=0; i<nEvents; i++ ) {
+            if ( Crossed[i] && ( (iTerm < 0) || (dS[i] <= dS[iTerm]) ) ) {
+                Lgm_MagStep_DP5_Interp( dS[i], &Dense, &Pz );
+                Events[i].Found = TRUE;
+                Events[i].S     = Stotal + dS[i];
+                Events[i].P     = Pz;
+            }
+            g_old[i] = g_new[i];
+        }
+
+        if ( iTerm >= 0 ) {
+
+            *v = Events[iTerm].P;
+            *S = Events[iTerm].S;
+            free( g_old ); free( Crossed );
+            if ( Info->VerbosityLevel > 2 ) printf("Lgm_TraceWithEvents(): Number of Bfield evaluations = %ld\n", Info->Lgm_nMagEvals );
+            return( 1 );
+
+        }
+
+        Stotal += Hdid;
+        ++n;
+
+        if (   (P.x > Info->OpenLimit_xMax) || (P.x < Info->OpenLimit_xMin) || (P.y > Info->OpenLimit_yMax) || (P.y < Info->OpenLimit_yMin)
+            || (P.z > Info->OpenLimit_zMax) || (P.z < Info->OpenLimit_zMin) || ( Stotal >= Smax ) || ( n > 10000 ) ) {
+            done = TRUE;
+        }
+
+        /*
+         *  Adaptively set next step. Dont step more than 0.25*distance to
+         *  Earths surface (like the other Trace routines).
+         */
+        R    = Lgm_Magnitude( &P );
+        Htry = FMIN( Hnext, Hmax );
+        if ( R > 1.0 ) Htry = FMIN( Htry, FMAX( 0.25*(R-1.0), 1e-3 ) );
+        if ( Htry < Hmin ) Htry = Hmin;
+
+    }
+
+    *v = P;
+    *S = Stotal;
+    free( g_old ); free( Crossed );
+
+    return( 0 );
+
+}
@@ -39,9 +39,14 @@ int Lgm_MagStep( Lgm_Vector *u, Lgm_Vector *u_scale,
         eps = Info->Lgm_MagStep_RK5_Eps;
         status = Lgm_MagStep_RK5( u, u_scale, Htry, Hdid, Hnext, eps, sgn, s, reset, Mag, Info );
 
+    } else if ( Info->Lgm_MagStep_Integrator == LGM_MAGSTEP_ODE_DP5 ) {
+
+        eps = Info->Lgm_MagStep_DP5_Eps;
+        status = Lgm_MagStep_DP5( u, u_scale, Htry, Hdid, Hnext, eps, sgn, s, reset, Mag, Info );
+
     } else {
 
-        printf("Lgm_MagStep: Error. Unknown ODE solver. Info->Lgm_MagStep_Integrator must be either LGM_MAGSTEP_ODE_BS or LGM_MAGSTEP_ODE_RK5\n");
+        printf("Lgm_MagStep: Error. Unknown ODE solver. Info->Lgm_MagStep_Integrator must be one of LGM_MAGSTEP_ODE_BS, LGM_MAGSTEP_ODE_RK5 or LGM_MAGSTEP_ODE_DP5\n");
         return(-1);
 
     }
@@ -695,8 +700,6 @@ int Lgm_RKCK( Lgm_Vector *u0, Lgm_Vector *b0, Lgm_Vector *v, double h, double sg
 
 
     int i;
-    double  a2=0.2, a3=0.3, a4=0.6, a5=1.0, a6=0.875;
-
     double  b21 = 0.2;
 
     // b31=3.0/40.0, b32=9.0/40.0;
@@ -752,15 +755,15 @@ int Lgm_RKCK( Lgm_Vector *u0, Lgm_Vector *b0, Lgm_Vector *v, double h, double sg
     // 1st step
     ak1[0] = b0->x; ak1[1] = b0->y; ak1[2] = b0->z;
     for ( i=0; i<3; i++ ) {
-        ytemp[i] = y[i] + b21*H*ak1[i]; //WHY DOESN'T ytemp GET USED IN NEXT CALL TO Mag?????
+        ytemp[i] = y[i] + b21*H*ak1[i];
     }
 
 
 
     // 2nd step
-    u.x = u0->x + a2*H;
-    u.y = u0->y + a2*H;
-    u.z = u0->z + a2*H;
+    u.x = ytemp[0];
+    u.y = ytemp[1];
+    u.z = ytemp[2];
     if ( (*Mag)(&u, &B, Info) == 0 ) {
         // bail if B-field eval had issues.
         printf("Lgm_RKCK(): B-field evaluation during cash-karp step (u = %g %g %g) returned with errors (returning with 0)\n", u.x, u.y, u.z );
@@ -782,9 +785,9 @@ int Lgm_RKCK( Lgm_Vector *u0, Lgm_Vector *b0, Lgm_Vector *v, double h, double sg
 
 
     // 3rd step
-    u.x = u0->x + a3*H;
-    u.y = u0->y + a3*H;
-    u.z = u0->z + a3*H;
+    u.x = ytemp[0];
+    u.y = ytemp[1];
+    u.z = ytemp[2];
     if ( (*Mag)(&u, &B, Info) == 0 ) {
         // bail if B-field eval had issues.
         printf("Lgm_RKCK(): B-field evaluation during cash-karp step (u = %g %g %g) returned with errors (returning with 0)\n", u.x, u.y, u.z );
@@ -806,9 +809,9 @@ int Lgm_RKCK( Lgm_Vector *u0, Lgm_Vector *b0, Lgm_Vector *v, double h, double sg
 
 
     // 4th step
-    u.x = u0->x + a4*H;
-    u.y = u0->y + a4*H;
-    u.z = u0->z + a4*H;
+    u.x = ytemp[0];
+    u.y = ytemp[1];
+    u.z = ytemp[2];
     if ( (*Mag)(&u, &B, Info) == 0 ) {
         // bail if B-field eval had issues.
         printf("Lgm_RKCK(): B-field evaluation during cash-karp step (u = %g %g %g) returned with errors (returning with 0)\n", u.x, u.y, u.z );
@@ -831,9 +834,9 @@ int Lgm_RKCK( Lgm_Vector *u0, Lgm_Vector *b0, Lgm_Vector *v, double h, double sg
 
 
     // 5th step
-    u.x = u0->x + a5*H;
-    u.y = u0->y + a5*H;
-    u.z = u0->z + a5*H;
+    u.x = ytemp[0];
+    u.y = ytemp[1];
+    u.z = ytemp[2];
     if ( (*Mag)(&u, &B, Info) == 0 ) {
         // bail if B-field eval had issues.
         printf("Lgm_RKCK(): B-field evaluation during cash-karp step (u = %g %g %g) returned with errors (returning with 0)\n", u.x, u.y, u.z );
@@ -856,9 +859,9 @@ int Lgm_RKCK( Lgm_Vector *u0, Lgm_Vector *b0, Lgm_Vector *v, double h, double sg
 
 
     // 6th step
-    u.x = u0->x + a6*H;
-    u.y = u0->y + a6*H;
-    u.z = u0->z + a6*H;
+    u.x = ytemp[0];
+    u.y = ytemp[1];
+    u.z = ytemp[2];
     if ( (*Mag)(&u, &B, Info) == 0 ) {
         // bail if B-field eval had issues.
         printf("Lgm_RKCK(): B-field evaluation during cash-karp step (u = %g %g %g) returned with errors (returning with 0)\n", u.x, u.y, u.z );
@@ -894,3 +897,255 @@ int Lgm_RKCK( Lgm_Vector *u0, Lgm_Vector *b0, Lgm_Vector *v, double h, double sg
 
 }
 
+
+
+/*
+ *
+ *
+ *  Dormand-Prince RK5(4)7FM step (the DOPRI5 pair of Hairer, Norsett and
+ *  Wanner, Solving ODEs I).
+ *
+ *  Two things make this cheaper than Lgm_MagStep_RK5() for FL tracing;
+ *
+ *      - The 7th stage is B evaluated at the new point, so it is saved and
+ *        re-used as the 1st stage of the next step (First Same As Last).
+ *        An accepted step therefore costs 6 B-field evaluations, not 7.
+ *
+ *      - The stages give a 4th order continuous interpolant over the step
+ *        for free. The coefficients for the last accepted step are left in
+ *        Info->Lgm_MagStep_DP5_Dense and can be evaluated with
+ *        Lgm_MagStep_DP5_Interp(). Routines that need to locate something
+ *        inside a step (mirror points, Bmin, etc.) can then root-find on
+ *        the interpolant rather than re-stepping from a bracket endpoint.
+ *
+ */
+static int Lgm_MagStep_DP5_Deriv( Lgm_Vector *u, double *k, Lgm_Vector *Bfull,
+          int (*Mag)(Lgm_Vector *, Lgm_Vector *, Lgm_MagModelInfo *), Lgm_MagModelInfo *Info ) {
+
+    Lgm_Vector  B;
+    double      Bmag;
+
+    if ( (*Mag)(u, &B, Info) == 0 ) {
+        // bail if B-field eval had issues.
+        printf("Lgm_MagStep_DP5(): B-field evaluation (u = %g %g %g) returned with errors (returning with -1)\n", u->x, u->y, u->z );
+        return(0);
+    }
+    ++(Info->Lgm_nMagEvals);
+    if ( Bfull != NULL ) *Bfull = B;
+    Bmag = Lgm_NormalizeVector(&B);
+    if ( Bmag < 1e-16 ) {
+        // bail if B-field magnitude is too small
+        printf("Lgm_MagStep_DP5(): Bmag too small (u = %g %g %g Bmag = %g) (returning with -1).\n", u->x, u->y, u->z, Bmag );
+        return(0);
+    }
+    k[0] = B.x; k[1] = B.y; k[2] = B.z;
+
+    return(1);
+
+}
+
+int Lgm_MagStep_DP5( Lgm_Vector *u, Lgm_Vector *u_scale,
+          double Htry, double *Hdid, double *Hnext,
+          double eps, double sgn, double *s, int *reset,
+          int (*Mag)(Lgm_Vector *, Lgm_Vector *, Lgm_MagModelInfo *), Lgm_MagModelInfo *Info ){
+
+    int         i, Count, Rejected;
+    double      h, H, ErrMax, g, fac, snew, ydiff, bspl;
+    double      y[3], yout[3], ytemp[3], yerr[3], yscal[3];
+    double      ak1[3], ak2[3], ak3[3], ak4[3], ak5[3], ak6[3], ak7[3];
+    Lgm_Vector  u0, v, B7;
+    Lgm_MagStep_DenseOutput *d;
+
+    double  a21 =  1.0/5.0;
+    double  a31 =  3.0/40.0,       a32 =  9.0/40.0;
+    double  a41 =  44.0/45.0,      a42 = -56.0/15.0,      a43 =  32.0/9.0;
+    double  a51 =  19372.0/6561.0, a52 = -25360.0/2187.0, a53 =  64448.0/6561.0, a54 = -212.0/729.0;
+    double  a61 =  9017.0/3168.0,  a62 = -355.0/33.0,     a63 =  46732.0/5247.0, a64 =  49.0/176.0,   a65 = -5103.0/18656.0;
+    double  a71 =  35.0/384.0,     a73 =  500.0/1113.0,   a74 =  125.0/192.0,    a75 = -2187.0/6784.0, a76 =  11.0/84.0;
+
+    // error coefficients (5th order minus embedded 4th order weights)
+    double  e1  =  71.0/57600.0,   e3  = -71.0/16695.0,   e4  =  71.0/1920.0,    e5  = -17253.0/339200.0;
+    double  e6  =  22.0/525.0,     e7  = -1.0/40.0;
+
+    // dense output coefficients
+    double  d1  = -12715105075.0/11282082432.0, d3 =  87487479700.0/32700410799.0, d4 = -10690763975.0/1880347072.0;
+    double  d5  =  701980252875.0/199316789632.0, d6 = -1453857185.0/822651844.0,  d7 =  69997945.0/29380423.0;
+
+
+    if ( *reset ) {
+        Info->Lgm_nMagEvals = 0;
+        Info->Lgm_MagStep_DP5_FSAL_Valid  = FALSE;
+        Info->Lgm_MagStep_DP5_Dense.Valid = FALSE;
+        *s = 0.0;
+    }
+
+    /*
+     * The dense output is only valid for a step that completes. If this one
+     * fails (e.g. a B-field evaluation inside it fails) callers must not be
+     * left with the coefficients of the previous step.
+     */
+    Info->Lgm_MagStep_DP5_Dense.Valid = FALSE;
+
+    if ( fabs(Htry) < 1e-16 ) {
+        printf("%s(): Requested stepsize is very small (returning with -1). Htry = %g\n", __func__, Htry );
+        return(-1);
+    }
+
+    u0 = *u;
+    y[0] = u0.x; y[1] = u0.y; y[2] = u0.z;
+    yscal[0] = u_scale->x; yscal[1] = u_scale->y; yscal[2] = u_scale->z;
+
+
+    /*
+     * Get the 1st stage. If the last accepted step ended exactly here (and
+     * was done with the same field function), we already have it.
+     */
+    if ( Info->Lgm_MagStep_DP5_FSAL_Valid && ( Info->Lgm_MagStep_DP5_FSAL_Mag == Mag )
+            && ( u0.x == Info->Lgm_MagStep_DP5_FSAL_u.x ) && ( u0.y == Info->Lgm_MagStep_DP5_FSAL_u.y ) && ( u0.z == Info->Lgm_MagStep_DP5_FSAL_u.z ) ) {
+        for ( i=0; i<3; i++ ) ak1[i] = Info->Lgm_MagStep_DP5_FSAL_b[i];
+    } else {
+        if ( !Lgm_MagStep_DP5_Deriv( &u0, ak1, NULL, Mag, Info ) ) return(-1);
+    }
+
+
+    /*
+     * Htry can be positive or negative. The sign is independant of the sgn
+     * variable which can also be +/-.
+     */
+    h        = Htry;
+    Count    = 0;
+    Rejected = FALSE;
+    while ( TRUE ) {
+
+        H = sgn*h;
+
+        for ( i=0; i<3; i++ ) ytemp[i] = y[i] + H*a21*ak1[i];
+        v.x = ytemp[0]; v.y = ytemp[1]; v.z = ytemp[2];
+        if ( !Lgm_MagStep_DP5_Deriv( &v, ak2, NULL, Mag, Info ) ) return(-1);
+
+        for ( i=0; i<3; i++ ) ytemp[i] = y[i] + H*(a31*ak1[i] + a32*ak2[i]);
+        v.x = ytemp[0]; v.y = ytemp[1]; v.z = ytemp[2];
+        if ( !Lgm_MagStep_DP5_Deriv( &v, ak3, NULL, Mag, Info ) ) return(-1);
+
+        for ( i=0; i<3; i++ ) ytemp[i] = y[i] + H*(a41*ak1[i] + a42*ak2[i] + a43*ak3[i]);
+        v.x = ytemp[0]; v.y = ytemp[1]; v.z = ytemp[2];
+        if ( !Lgm_MagStep_DP5_Deriv( &v, ak4, NULL, Mag, Info ) ) return(-1);
+
+        for ( i=0; i<3; i++ ) ytemp[i] = y[i] + H*(a51*ak1[i] + a52*ak2[i] + a53*ak3[i] + a54*ak4[i]);
+        v.x = ytemp[0]; v.y = ytemp[1]; v.z = ytemp[2];
+        if ( !Lgm_MagStep_DP5_Deriv( &v, ak5, NULL, Mag, Info ) ) return(-1);
+
+        for ( i=0; i<3; i++ ) ytemp[i] = y[i] + H*(a61*ak1[i] + a62*ak2[i] + a63*ak3[i] + a64*ak4[i] + a65*ak5[i]);
+        v.x = ytemp[0]; v.y = ytemp[1]; v.z = ytemp[2];
+        if ( !Lgm_MagStep_DP5_Deriv( &v, ak6, NULL, Mag, Info ) ) return(-1);
+
+        for ( i=0; i<3; i++ ) yout[i] = y[i] + H*(a71*ak1[i] + a73*ak3[i] + a74*ak4[i] + a75*ak5[i] + a76*ak6[i]);
+        v.x = yout[0]; v.y = yout[1]; v.z = yout[2];
+        if ( !Lgm_MagStep_DP5_Deriv( &v, ak7, &B7, Mag, Info ) ) return(-1);
+
+
+        /*
+         * Test accuracy (RMS of scaled error).
+         */
+        ErrMax = 0.0;
+        for ( i=0; i<3; i++ ) {
+            yerr[i] = H*(e1*ak1[i] + e3*ak3[i] + e4*ak4[i] + e5*ak5[i] + e6*ak6[i] + e7*ak7[i]);
+            g       = yerr[i]/yscal[i];
+            ErrMax += g*g;
+        }
+        ErrMax = sqrt( ErrMax/3.0 )/eps;
+
+        if ( ErrMax <= 1.0 ) break;
+
+        /*
+         * Step failed. Shrink, but not by more than a factor of 5.
+         */
+        fac  = FMAX( 0.2, Info->Lgm_MagStep_DP5_Safety*pow( ErrMax, -0.2 ) );
+        h   *= fac;
+        snew = *s + h;
+        Rejected = TRUE;
+        if ( snew == *s ) {
+            printf( "%s(): Stepsize underflow. h = %g\n", __func__, h );
+            return( -1 );
+        }
+        if ( ++Count >= Info->Lgm_MagStep_DP5_MaxCount ) {
+            printf( "%s(): Too many failed attempts to take step. h = %g\n", __func__, h );
+            return( -1 );
+        }
+
+    }
+
+
+    /*
+     * Step accepted. Dont let it grow by more than a factor of 10, and not at
+     * all if we just had to shrink it.
+     */
+    fac = ( ErrMax > 0.0 ) ? Info->Lgm_MagStep_DP5_Safety*pow( ErrMax, -0.2 ) : 10.0;
+    fac = FMIN( 10.0, FMAX( 0.2, fac ) );
+    if ( Rejected ) fac = FMIN( 1.0, fac );
+    *Hnext = h*fac;
+    *Hdid  = h;
+    *s    += h;
+    u->x = yout[0]; u->y = yout[1]; u->z = yout[2];
+
+
+    /*
+     * Save the dense output coefficients for this step.
+     */
+    d = &Info->Lgm_MagStep_DP5_Dense;
+    d->Valid = TRUE;
+    d->Hdid  = h;
+    for ( i=0; i<3; i++ ) {
+        ydiff     = yout[i] - y[i];
+        bspl      = H*ak1[i] - ydiff;
+        d->r[0][i] = y[i];
+        d->r[1][i] = ydiff;
+        d->r[2][i] = bspl;
+        d->r[3][i] = ydiff - H*ak7[i] - bspl;
+        d->r[4][i] = H*(d1*ak1[i] + d3*ak3[i] + d4*ak4[i] + d5*ak5[i] + d6*ak6[i] + d7*ak7[i]);
+    }
+
+
+    /*
+     * Save last stage for re-use on next step.
+     */
+    Info->Lgm_MagStep_DP5_FSAL_Valid = TRUE;
+    Info->Lgm_MagStep_DP5_FSAL_Mag   = Mag;
+    Info->Lgm_MagStep_DP5_FSAL_u     = *u;
+    for ( i=0; i<3; i++ ) Info->Lgm_MagStep_DP5_FSAL_b[i] = ak7[i];
+    Info->Lgm_MagStep_DP5_FSAL_B     = B7;
+
+    *reset = FALSE;
+
+    return(1);
+
+}
+
+
+/*
+ *  Evaluate the continuous (dense) output of a Lgm_MagStep_DP5() step.
+ *
+ *  ds is the distance from the start of the step, measured in the same
+ *  sense as Hdid (i.e. ds = 0 gives the starting point and ds = d->Hdid gives
+ *  the end point). Values outside [0, Hdid] are extrapolations and are not
+ *  very trustworthy.
+ *
+ *  Returns 1 on success, 0 if d does not hold a valid step.
+ */
+int Lgm_MagStep_DP5_Interp( double ds, Lgm_MagStep_DenseOutput *d, Lgm_Vector *u ) {
+
+    int     i;
+    double  theta, theta1, y[3];
+
+    if ( !d->Valid || ( d->Hdid == 0.0 ) ) return(0);
+
+    theta  = ds/d->Hdid;
+    theta1 = 1.0 - theta;
+    for ( i=0; i<3; i++ ) {
+        y[i] = d->r[0][i] + theta*( d->r[1][i] + theta1*( d->r[2][i] + theta*( d->r[3][i] + theta1*d->r[4][i] ) ) );
+    }
+    u->x = y[0]; u->y = y[1]; u->z = y[2];
+
+    return(1);
+
+}
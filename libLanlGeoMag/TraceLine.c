@@ -1238,6 +1238,47 @@ int  SofBm( double Bm, double *ss, double *sn, Lgm_MagModelInfo *Info ) {
 
 
 
+/*
+ *  Find the mirror point for Bm on the pre-traced (and splined) field line,
+ *  searching from index imin in the direction Dir (+1 or -1). Returns FALSE
+ *  if B never gets up to Bm within the pre-traced points. Unlike SofBm(),
+ *  this does not depend on Info->Smin and the search is only as long as
+ *  it needs to be.
+ */
+int Lgm_MirrorS_Interped( double Bm, int imin, int Dir, double *S, Lgm_MagModelInfo *Info ) {
+
+    int     i, Iter;
+    double  sa, sb, s, fa, fb, f;
+
+    for ( i=imin; (i+Dir >= 0) && (i+Dir < Info->nPnts) && (Info->Bmag[i+Dir] <= Bm); i += Dir );
+    if ( (i+Dir < 0) || (i+Dir >= Info->nPnts) ) return( FALSE );
+
+    /*
+     *  Bm is bracketed by [ s[i], s[i+Dir] ]. Home in on it with the Illinois
+     *  variant of regula falsi.
+     */
+    sa = Info->s[i];     fa = Info->Bmag[i] - Bm;
+    sb = Info->s[i+Dir]; fb = Info->Bmag[i+Dir] - Bm;
+    s  = sb;
+    for ( Iter=0; Iter<100; Iter++ ) {
+        s = sb - fb*(sb-sa)/(fb-fa);
+        f = BofS( s, Info ) - Bm;
+        if ( (fabs(f) < 1e-7) || (fabs(sb-sa) < 1e-10) ) break;
+        if ( f*fb < 0.0 ) {
+            sa = sb; fa = fb;
+        } else {
+            fa *= 0.5;
+        }
+        sb = s; fb = f;
+    }
+    *S = s;
+
+    return( TRUE );
+
+}
+
+
+
 /*
  * Start at point u. Then trace the distance S in N steps.
  */
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "Lgm/Lgm_Tsyg1996.h"
 
 
@@ -141,6 +142,9 @@ void Lgm_Init_T96( LgmTsyg1996_Info *t ){
 
     t->INTERCON_M_FLAG = 0;
 
+    t->State_Valid    = FALSE;
+    t->State_nUpdates = 0;
+
 
 
     // cached vars in BIRK1SHLD_T96()
@@ -169,6 +173,75 @@ void Lgm_Init_T96( LgmTsyg1996_Info *t ){
 }
 
 
+/*
+ *  Compute the quantities in Tsyg_T96() that depend only on the model
+ *  parameters (IMF clock angle, amplitudes of the current systems and the
+ *  pressure scaling). They only change once per time step, so there is no
+ *  need to redo them (with their atan2/sin/cos/pow calls) at every point.
+ */
+void T96_SetState( double *PARMOD, LgmTsyg1996_Info *t ) {
+
+    double  A[]    = { -9e99, 1.162, 22.344, 18.50, 2.602, 6.903, 5.287, 0.5790, 0.4462, 0.7850 };
+    double PDYN0   = 2.0;
+    double EPS10   = 3630.7;
+    double AM0     = 70.0;
+    double X00     = 5.48;
+    double  PDYN, DST, BYIMF, BZIMF, SqrtPDYN, DEPR, Bt, THETA, EPS, FACTEPS, FACTPD, XAPPA;
+    int     i;
+
+    PDYN  = PARMOD[1];
+    DST   = PARMOD[2];
+    BYIMF = PARMOD[3];
+    BZIMF = PARMOD[4];
+
+    SqrtPDYN = sqrt( PDYN );
+    DEPR = 0.8*DST - 13.0*SqrtPDYN;  // DEPR is an estimate of total near-Earth depression, based on DST and Pdyn (usually, DEPR < 0 )
+
+
+    /*
+     * CALCULATE THE IMF-RELATED QUANTITIES:
+     */
+    Bt = sqrt( BYIMF*BYIMF + BZIMF*BZIMF );
+
+    if ( (BYIMF == 0.0) && (BZIMF == 0.0) ) {
+        THETA = 0.0;
+    } else {
+        THETA = atan2( BYIMF, BZIMF );
+        if ( THETA <= 0.0) THETA += 6.2831853; // MGH - precision for 2pi is pretty low....
+    }
+
+    t->State_ST = sin( THETA );
+    t->State_CT = cos( THETA );
+    EPS = 718.5*SqrtPDYN*Bt*sin( 0.5*THETA );
+
+    FACTEPS = EPS/EPS10 - 1.0;
+    FACTPD  = sqrt( PDYN/PDYN0 ) - 1.0;
+
+    t->State_RCAMPL = -A[1]*DEPR; //   RCAMPL is the amplitude of the ring current (positive and equal to abs.value of RC depression at origin)
+
+    t->State_TAMPL2 = A[2] + A[3]*FACTPD + A[4]*FACTEPS;
+    t->State_TAMPL3 = A[5] + A[6]*FACTPD;
+    t->State_B1AMPL = A[7] + A[8]*FACTEPS;
+    t->State_B2AMPL = 20.0*t->State_B1AMPL;  // IT IS EQUIVALENT TO ASSUMING THAT THE TOTAL CURRENT IN THE REGION 2 SYSTEM IS 40% OF THAT IN REGION 1
+    t->State_RECONN = A[9];
+
+    XAPPA  = pow( PDYN/PDYN0, 0.14 );
+    t->State_XAPPA  = XAPPA;
+    t->State_XAPPA3 = XAPPA*XAPPA*XAPPA;
+    t->State_X0     = X00/XAPPA;
+    t->State_AM     = AM0/XAPPA;
+
+    t->State_RIMFAMPL = t->State_RECONN*Bt;
+
+    for ( i=0; i<11; i++ ) t->State_PARMOD[i] = PARMOD[i];
+    t->State_Valid = TRUE;
+    ++t->State_nUpdates;
+
+    return;
+
+}
+
+
 void Tsyg_T96( int IOPT, double *PARMOD, double PS, double SINPS, double COSPS, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg1996_Info *t) {
 
     /*
@@ -221,65 +294,41 @@ void Tsyg_T96( int IOPT, double *PARMOD, double PS, double SINPS, double COSPS,
     double  CFX, CFY, CFZ, BXRC, BYRC, BZRC, BXT2, BYT2, BZT2, BXT3, BYT3, BZT3;
     double  R1X, R1Y, R1Z, R2X, R2Y, R2Z, RIMFX, RIMFYS, RIMFZS, QX, QY, QZ;
 
-    double  A[]    = { -9e99, 1.162, 22.344, 18.50, 2.602, 6.903, 5.287, 0.5790, 0.4462, 0.7850 };
-    double PDYN0   = 2.0;
-    double EPS10   = 3630.7;
-    double AM0     = 70.0;
     double S0      = 1.08;
-    double X00     = 5.48;
     double DSIG    = 0.005;
     double DELIMFX = 20.0;
     double DELIMFY = 10.0;
 
-    double  PDYN, DST, BYIMF, BZIMF, PPS, SqrtPDYN, DEPR, Bt, THETA, ST, CT, EPS, FACTEPS;
-    double  FACTPD, RCAMPL, TAMPL2, TAMPL3, B1AMPL, B2AMPL, RECONN, XAPPA, XAPPA3, YS, ZS;
+    double  BYIMF, BZIMF, PPS, ST, CT;
+    double  RCAMPL, TAMPL2, TAMPL3, B1AMPL, B2AMPL, RECONN, XAPPA, XAPPA3, YS, ZS;
     double  g, g2, FACTIMF, OIMFX, OIMFY, OIMFZ, RIMFAMPL, XX, YY, ZZ, X0, AM, RHO2, ASQ;
     double  XMXM, AXX0, ARO, SIGMA, SPS, RIMFY, RIMFZ, FX, FY, FZ, FINT, FEXT;
 
  
  
-    PDYN  = PARMOD[1];
-    DST   = PARMOD[2];
     BYIMF = PARMOD[3];
     BZIMF = PARMOD[4];
  
     PPS = PS;
     t->cos_psi = COSPS;
     SPS = t->sin_psi = SINPS;
- 
-    SqrtPDYN = sqrt( PDYN );
-    DEPR = 0.8*DST - 13.0*SqrtPDYN;  // DEPR is an estimate of total near-Earth depression, based on DST and Pdyn (usually, DEPR < 0 )
- 
 
     /*
-     * CALCULATE THE IMF-RELATED QUANTITIES:
+     *  Parameter-dependent quantities (recomputed only if PARMOD changed).
      */
-    Bt = sqrt( BYIMF*BYIMF + BZIMF*BZIMF );
-
-    if ( (BYIMF == 0.0) && (BZIMF == 0.0) ) {
-        THETA = 0.0;
-    } else {
-        THETA = atan2( BYIMF, BZIMF );
-        if ( THETA <= 0.0) THETA += 6.2831853; // MGH - precision for 2pi is pretty low....
-    }
+    if ( !t->State_Valid || memcmp( &PARMOD[1], &t->State_PARMOD[1], 4*sizeof(double) ) ) T96_SetState( PARMOD, t );
+    ST       = t->State_ST;
+    CT       = t->State_CT;
+    RCAMPL   = t->State_RCAMPL;
+    TAMPL2   = t->State_TAMPL2;
+    TAMPL3   = t->State_TAMPL3;
+    B1AMPL   = t->State_B1AMPL;
+    B2AMPL   = t->State_B2AMPL;
+    RECONN   = t->State_RECONN;
+    RIMFAMPL = t->State_RIMFAMPL;
+    XAPPA    = t->State_XAPPA;
+    XAPPA3   = t->State_XAPPA3;
 
-    ST  = sin( THETA );
-    CT  = cos( THETA );
-    EPS = 718.5*SqrtPDYN*Bt*sin( 0.5*THETA );
- 
-    FACTEPS = EPS/EPS10 - 1.0;
-    FACTPD  = sqrt( PDYN/PDYN0 ) - 1.0;
- 
-    RCAMPL = -A[1]*DEPR; //   RCAMPL is the amplitude of the ring current (positive and equal to abs.value of RC depression at origin)
- 
-    TAMPL2 = A[2] + A[3]*FACTPD + A[4]*FACTEPS;
-    TAMPL3 = A[5] + A[6]*FACTPD;
-    B1AMPL = A[7] + A[8]*FACTEPS;
-    B2AMPL = 20.0*B1AMPL;  // IT IS EQUIVALENT TO ASSUMING THAT THE TOTAL CURRENT IN THE REGION 2 SYSTEM IS 40% OF THAT IN REGION 1
-    RECONN = A[9];
- 
-    XAPPA  = pow( PDYN/PDYN0, 0.14 );
-    XAPPA3 = XAPPA*XAPPA*XAPPA;
     YS = Y*CT - Z*ST;
     ZS = Z*CT + Y*ST;
      
@@ -296,8 +345,6 @@ void Tsyg_T96( int IOPT, double *PARMOD, double PS, double SINPS, double COSPS,
     OIMFY = g*BYIMF;
     OIMFZ = g*BZIMF;
  
-    RIMFAMPL = RECONN*Bt;
- 
     PPS = PS;
     XX  = X*XAPPA;
     YY  = Y*XAPPA;
@@ -310,8 +357,8 @@ void Tsyg_T96( int IOPT, double *PARMOD, double PS, double SINPS, double COSPS,
      *  SCALE AND CALCULATE THE MAGNETOPAUSE PARAMETERS FOR THE INTERPOLATION ACROSS
      *   THE BOUNDARY LAYER (THE COORDINATES XX,YY,ZZ  ARE ALREADY SCALED)
      */
-    X0   = X00/XAPPA;
-    AM   = AM0/XAPPA;
+    X0   = t->State_X0;
+    AM   = t->State_AM;
     RHO2 = Y*Y + Z*Z;
     ASQ  = AM*AM;
     XMXM = AM + X - X0;
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "Lgm/Lgm_Tsyg2004.h"
 
 
@@ -106,6 +107,10 @@ void Lgm_Init_TS04( LgmTsyg2004_Info *t ){
     t->OLD_X  = -9e99;
     t->OLD_Y  = -9e99;
     t->OLD_Z  = -9e99;
+    t->State_Valid    = FALSE;
+    t->State_nUpdates = 0;
+    t->State_CF_Valid = FALSE;
+    t->State_RC_Valid[0] = t->State_RC_Valid[1] = FALSE;
     for (i=0; i<4; i++ ){
         t->DoneJ[i] = 0;
         for (j=0; j<4; j++ ){
@@ -177,6 +182,15 @@ void Tsyg_TS04( int IOPT, double *PARMOD, double PS, double SINPS, double COSPS,
     PSS = PS;
     tInfo->sin_psi_op = SINPS;
     tInfo->cos_psi_op = COSPS;
+
+
+    /*
+     *  Recompute the parameter-dependent state only if PS or PARMOD changed.
+     */
+    if ( !tInfo->State_Valid || ( PS != tInfo->State_PS ) || memcmp( &PARMOD[1], &tInfo->State_PARMOD[1], 10*sizeof(double) ) ) {
+        TS04_SetState( A, PARMOD, PS, tInfo );
+    }
+
     XX  = X;
     YY  = Y;
     ZZ  = Z;
@@ -217,6 +231,87 @@ printf("BBX, BBY, BBZ   = %.10g %.10g %.10g\n", BBX, BBY, BBZ);
 
 
 
+/*
+ *  Compute everything in TS04_EXTERN() that depends only on the tilt angle
+ *  and the model parameters (scaling factor, tail/Birkeland/ring current
+ *  scales and amplitudes, IMF penetration). This only needs to be done once
+ *  per time step instead of once per point.
+ */
+void TS04_SetState( double *A, double *PARMOD, double PS, LgmTsyg2004_Info *tInfo ) {
+
+    double    PDYN, DST, BYIMF, BZIMF, W1, W2, W3, W4, W5, W6;
+    double    XAPPA, DSTT, ZNAM, ZNAM05, ooZNAM20, DLP1, DLP2;
+    double    A0_A=34.586, A0_X0=3.4397;     // SHUE ET AL. PARAMETERS
+    int       i;
+
+    PDYN  = PARMOD[1];
+    DST   = PARMOD[2]*0.8 - 13.0*sqrt( PDYN );
+    BYIMF = PARMOD[3];
+    BZIMF = PARMOD[4];
+    W1 = PARMOD[5]; W2 = PARMOD[6]; W3 = PARMOD[7];
+    W4 = PARMOD[8]; W5 = PARMOD[9]; W6 = PARMOD[10];
+
+    tInfo->CB_G.G     = 35.0;    // TAIL WARPING PARAMETER
+    tInfo->CB_RH0.RH0 = 7.5;     // TAIL HINGING DISTANCE
+
+    XAPPA = mypow( 0.5*PDYN, A[23] );   //  OVERALL SCALING PARAMETER
+    tInfo->XAPPA        = XAPPA;
+    tInfo->State_XAPPA  = XAPPA;
+    tInfo->State_XAPPA3 = XAPPA*XAPPA*XAPPA;
+    tInfo->State_X0     = A0_X0/XAPPA;
+    tInfo->State_AM     = A0_A/XAPPA;
+
+    tInfo->State_OIMFY  = BYIMF*A[20];
+    tInfo->State_OIMFZ  = BZIMF*A[20];
+
+    // Tail
+    DSTT = -20.;
+    if (DST < DSTT) DSTT = DST;
+    ZNAM = mypow( fabs( DSTT ), 0.37 );
+    tInfo->CB_TAIL.DXSHIFT1 = A[24]-A[25]/ZNAM;
+    tInfo->CB_TAIL.DXSHIFT2 = A[26]-A[27]/ZNAM;
+    tInfo->CB_TAIL.D = A[36]*exp(-W1/A[37])  +A[69];
+    tInfo->CB_TAIL.DELTADY = 4.7;
+
+    // Birkeland currents
+    ZNAM = fabs( DST );
+    if ( DST >= -20.0 ) ZNAM = 20.0;
+    ZNAM05 = 0.05*ZNAM;
+    tInfo->CB_BIRKPAR.XKAPPA1 = A[32]*mypow( ZNAM05, A[33] );
+    tInfo->CB_BIRKPAR.XKAPPA2 = A[34]*mypow( ZNAM05, A[35] );
+
+    // Ring current
+    tInfo->CB_RCPAR.PHI  = A[38];
+    ooZNAM20 = 20.0/ZNAM;
+    tInfo->CB_RCPAR.SC_SY = A[28]* mypow( ooZNAM20, A[29]) * XAPPA;
+    tInfo->CB_RCPAR.SC_AS = A[30]* mypow( ooZNAM20, A[31]) * XAPPA;
+
+    // Amplitudes
+    DLP1 = mypow( 0.5*PDYN, A[21] );
+    DLP2 = mypow( 0.5*PDYN, A[22] );
+    tInfo->State_TAMP1 = A[2]  + A[3]*DLP1 +  A[4]*A[39]*W1/sqrt(W1*W1+A[39]*A[39]) + A[5]*DST;
+    tInfo->State_TAMP2 = A[6]  + A[7]*DLP2 +  A[8]*A[40]*W2/sqrt(W2*W2+A[40]*A[40]) + A[9]*DST;
+    tInfo->State_A_SRC = A[10] + A[11]*A[41]*W3/sqrt(W3*W3+A[41]*A[41]) + A[12]*DST;
+    tInfo->State_A_PRC = A[13] + A[14]*A[42]*W4/sqrt(W4*W4+A[42]*A[42]) + A[15]*DST;
+    tInfo->State_A_R11 = A[16] + A[17]*A[43]*W5/sqrt(W5*W5+A[43]*A[43]);
+    tInfo->State_A_R21 = A[18] + A[19]*A[44]*W6/sqrt(W6*W6+A[44]*A[44]);
+
+    // Tilt-dependent parts of the shielding fields get recomputed lazily
+    tInfo->State_CF_Valid = FALSE;
+    tInfo->State_RC_Valid[0] = tInfo->State_RC_Valid[1] = FALSE;
+
+    tInfo->State_PS = PS;
+    for ( i=0; i<11; i++ ) tInfo->State_PARMOD[i] = PARMOD[i];
+    tInfo->State_Valid = TRUE;
+    ++tInfo->State_nUpdates;
+
+    return;
+
+}
+
+
+
+
 /*
  *     IOPGEN - GENERAL OPTION FLAG:  IOPGEN=0 - CALCULATE TOTAL FIELD
  *                                    IOPGEN=1 - DIPOLE SHIELDING ONLY
@@ -246,32 +341,24 @@ void TS04_EXTERN( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
         double *BZR22, double *HXIMF, double *HYIMF, double *HZIMF, double *BX, double *BY, double *BZ, LgmTsyg2004_Info *tInfo ) {
 
     int       done;
-    double    XAPPA, XAPPA2, XAPPA3, SPS, X0, AM, S0, FACTIMF, OIMFX, OIMFY, OIMFZ, R, XSS, ZSS;
+    double    XAPPA, XAPPA3, SPS, X0, AM, S0, OIMFX, OIMFY, OIMFZ, R, XSS, ZSS;
     double    XSOLD, ZSOLD, ZSSoR, ZSSoR2, RH, RoRH, RoRH2, RoRH3, SINPSAS, SINPSAS2, COSPSAS, DD, RHO2, ASQ;
-    double    XMXM, AXX0, ARO, AROpAXX0, AROpAXX02, SIGMA, CFX, CFY, CFZ, DSTT, ZNAM;
-    double    DLP1, DLP2, TAMP1, TAMP2, A_SRC, A_PRC, A_R11, XX, YY, ZZ;
-    double    A_R21, QX, QY, QZ, FINT, FEXT, ZNAM05, ooZNAM20, BBX, BBY, BBZ;
+    double    XMXM, AXX0, ARO, AROpAXX0, AROpAXX02, SIGMA, CFX, CFY, CFZ;
+    double    TAMP1, TAMP2, A_SRC, A_PRC, A_R11, XX, YY, ZZ;
+    double    A_R21, QX, QY, QZ, FINT, FEXT, BBX, BBY, BBZ;
 
 
-    double    A0_A=34.586, A0_S0=1.1960, A0_X0=3.4397;     // SHUE ET AL. PARAMETERS
+    double    A0_S0=1.1960;     // SHUE ET AL. PARAMETERS
     double    DSIG=0.005, RH2=-5.2;
 
 
-    tInfo->CB_G.G     = 35.0;    // TAIL WARPING PARAMETER
-    tInfo->CB_RH0.RH0 = 7.5;    // TAIL HINGING DISTANCE
-
-
-
-    if ( PDYN != tInfo->OLD_PDYN ) {
-        XAPPA = mypow( 0.5*PDYN, A[23] );   //  OVERALL SCALING PARAMETER
-        tInfo->XAPPA = XAPPA;
-    } else {
-        XAPPA = tInfo->XAPPA;   //  OVERALL SCALING PARAMETER
-    }
-
-
-    XAPPA2 = XAPPA*XAPPA;
-    XAPPA3 = XAPPA*XAPPA2;
+    /*
+     *  The parameter-dependent quantities come from the model state (see
+     *  TS04_SetState(), which must have been called for the current PS and
+     *  parameters).
+     */
+    XAPPA  = tInfo->State_XAPPA;   //  OVERALL SCALING PARAMETER
+    XAPPA3 = tInfo->State_XAPPA3;
 
     XX = X*XAPPA;
     YY = Y*XAPPA;
@@ -280,8 +367,8 @@ void TS04_EXTERN( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
 //    SPS = sin( PS );
     SPS = tInfo->sin_psi_op;
 
-    X0 = A0_X0/XAPPA;
-    AM = A0_A/XAPPA;
+    X0 = tInfo->State_X0;
+    AM = tInfo->State_AM;
     S0 = A0_S0;
 
 
@@ -290,11 +377,9 @@ void TS04_EXTERN( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
      *  THEY ARE NEEDED ONLY IF THE POINT (X,Y,Z) IS WITHIN THE TRANSITION MAGNETOPAUSE LAYER
      *  OR OUTSIDE THE MAGNETOSPHERE:
      */
-    FACTIMF = A[20];
-
     OIMFX = 0.0;
-    OIMFY = BYIMF*FACTIMF;
-    OIMFZ = BZIMF*FACTIMF;
+    OIMFY = tInfo->State_OIMFY;
+    OIMFZ = tInfo->State_OIMFZ;
 
 
     R   = sqrt( X*X + Y*Y + Z*Z );
@@ -365,14 +450,6 @@ void TS04_EXTERN( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
         }
 
         if ( (IOPGEN == 0) || (IOPGEN == 2) ) {
-            DSTT = -20.;
-            if (DST < DSTT) DSTT = DST;
-    // Cache this.
-            ZNAM = mypow( fabs( DSTT ), 0.37 );
-            tInfo->CB_TAIL.DXSHIFT1 = A[24]-A[25]/ZNAM;
-            tInfo->CB_TAIL.DXSHIFT2 = A[26]-A[27]/ZNAM;
-            tInfo->CB_TAIL.D = A[36]*exp(-W1/A[37])  +A[69];
-            tInfo->CB_TAIL.DELTADY = 4.7;
             DEFORMED( IOPT, PS, XX, YY, ZZ, BXT1, BYT1, BZT1, BXT2, BYT2, BZT2, tInfo );     // TAIL FIELD (THREE MODES)
         } else {
             *BXT1=0.0;
@@ -384,13 +461,6 @@ void TS04_EXTERN( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
         }
 
         if  ( (IOPGEN == 0) || (IOPGEN == 3) ) {
-            ZNAM = fabs( DST );
-            if ( DST >= -20.0 ) ZNAM = 20.0;
-            ZNAM05 = 0.05*ZNAM;
-    // Cache this.
-            tInfo->CB_BIRKPAR.XKAPPA1 = A[32]*mypow( ZNAM05, A[33] );
-    // Cache this.
-            tInfo->CB_BIRKPAR.XKAPPA2 = A[34]*mypow( ZNAM05, A[35] );
             BIRK_TOT( IOPB, PS, XX, YY, ZZ, BXR11, BYR11, BZR11, BXR12, BYR12,
                     BZR12, BXR21, BYR21, BZR21, BXR22, BYR22, BZR22, tInfo );    //   BIRKELAND FIELD (TWO MODES FOR R1 AND TWO MODES FOR R2)
         } else {
@@ -404,16 +474,6 @@ void TS04_EXTERN( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
 
 
         if  ( (IOPGEN == 0) || (IOPGEN == 4) ) {
-            tInfo->CB_RCPAR.PHI  = A[38];
-            ZNAM = fabs( DST );
-            if ( DST >= -20.0 ) ZNAM = 20.0;
-            ooZNAM20 = 20.0/ZNAM;
-    //could create a LUT for this pow.
-            tInfo->CB_RCPAR.SC_SY = A[28]* mypow( ooZNAM20, A[29]) * XAPPA;    //
-    //could create a LUT for this pow.
-            tInfo->CB_RCPAR.SC_AS = A[30]* mypow( ooZNAM20, A[31]) * XAPPA;    //  MULTIPLICATION  BY XAPPA IS MADE IN ORDER TO MAKE THE SRC AND PRC
-                                    //  SCALING COMPLETELY INDEPENDENT OF THE GENERAL SCALING DUE TO THE
-                                    //  MAGNETOPAUSE COMPRESSION/EXPANSION
             FULL_RC( IOPR, PS, XX, YY, ZZ, BXSRC, BYSRC, BZSRC, BXPRC, BYPRC, BZPRC, tInfo );    // SHIELDED RING CURRENT (SRC AND PRC)
         } else {
             *BXSRC = 0.0;
@@ -444,17 +504,12 @@ void TS04_EXTERN( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
         /*
          *    NOW, ADD UP ALL THE COMPONENTS:
          */
-    //could create a LUT for this pow.
-        DLP1 = mypow( 0.5*PDYN, A[21] );
-    //could create a LUT for this pow.
-        DLP2 = mypow( 0.5*PDYN, A[22] );
-
-        TAMP1 = A[2]  + A[3]*DLP1 +  A[4]*A[39]*W1/sqrt(W1*W1+A[39]*A[39]) + A[5]*DST;
-        TAMP2 = A[6]  + A[7]*DLP2 +  A[8]*A[40]*W2/sqrt(W2*W2+A[40]*A[40]) + A[9]*DST;
-        A_SRC = A[10] + A[11]*A[41]*W3/sqrt(W3*W3+A[41]*A[41]) + A[12]*DST;
-        A_PRC = A[13] + A[14]*A[42]*W4/sqrt(W4*W4+A[42]*A[42]) + A[15]*DST;
-        A_R11 = A[16] + A[17]*A[43]*W5/sqrt(W5*W5+A[43]*A[43]);
-        A_R21 = A[18] + A[19]*A[44]*W6/sqrt(W6*W6+A[44]*A[44]);
+        TAMP1 = tInfo->State_TAMP1;
+        TAMP2 = tInfo->State_TAMP2;
+        A_SRC = tInfo->State_A_SRC;
+        A_PRC = tInfo->State_A_PRC;
+        A_R11 = tInfo->State_A_R11;
+        A_R21 = tInfo->State_A_R21;
 
         BBX = A[1]* *BXCF + TAMP1* *BXT1 + TAMP2* *BXT2 + A_SRC* *BXSRC + A_PRC* *BXPRC + A_R11* *BXR11 + A_R21* *BXR21 + A[20]* *HXIMF;
         BBY = A[1]* *BYCF + TAMP1* *BYT1 + TAMP2* *BYT2 + A_SRC* *BYSRC + A_PRC* *BYPRC + A_R11* *BYR11 + A_R21* *BYR21 + A[20]* *HYIMF;
@@ -578,10 +633,10 @@ void    SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *
                       4.663639687,15.73319647,2.303504968,5.840511214,.8385953499E-01,
                       .3477844929 };
 
-    double    P1, P2, P3, ooP1, ooP2, ooP3, ooP1_2, ooP2_2, ooP3_2;
-    double    R1, R2, R3, ooR1, ooR2, ooR3, ooR1_2, ooR2_2, ooR3_2;
-    double    Q1, Q2, Q3, ooQ1, ooQ2, ooQ3, ooQ1_2, ooQ2_2, ooQ3_2;
-    double    S1, S2, S3, ooS1, ooS2, ooS3, ooS1_2, ooS2_2, ooS3_2;
+    double    P1, P2, P3, ooP1, ooP2, ooP3;
+    double    R1, R2, R3, ooR1, ooR2, ooR3, ooR3_2;
+    double    Q1, Q2, Q3, ooQ1, ooQ2, ooQ3;
+    double    S1, S2, S3, ooS1, ooS2, ooS3;
     double    T1, T2;
     double    sqrtP1R1, sqrtP1R2, sqrtP1R3, sqrtP2R1, sqrtP2R2, sqrtP2R3, sqrtP3R1, sqrtP3R2, sqrtP3R3;
     double    sqrtQ1S1, sqrtQ1S2, sqrtQ1S3, sqrtQ2S1, sqrtQ2S2, sqrtQ2S3, sqrtQ3S1, sqrtQ3S2, sqrtQ3S3;
@@ -608,8 +663,35 @@ void    SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *
     //CPS = cos(PS); SPS = sin(PS); S2PS = 2.0*CPS;
     CPS = tInfo->cos_psi_op; SPS = tInfo->sin_psi_op; S2PS = 2.0*CPS;
 
-    ST1 = sin( PS*T1 ); CT1 = cos( PS*T1 );
-    ST2 = sin( PS*T2 ); CT2 = cos( PS*T2 );
+    /*
+     *  The tilt rotations (and the scale constants below) only change with
+     *  PS, so they are kept in the model state.
+     */
+    if ( !tInfo->State_CF_Valid ) {
+        tInfo->State_CF_ST1 = sin( PS*T1 ); tInfo->State_CF_CT1 = cos( PS*T1 );
+        tInfo->State_CF_ST2 = sin( PS*T2 ); tInfo->State_CF_CT2 = cos( PS*T2 );
+        tInfo->State_CF_SQPR[0][0] = sqrt( (1.0/P1)*(1.0/P1) + (1.0/R1)*(1.0/R1) );
+        tInfo->State_CF_SQPR[0][1] = sqrt( (1.0/P1)*(1.0/P1) + (1.0/R2)*(1.0/R2) );
+        tInfo->State_CF_SQPR[0][2] = sqrt( (1.0/P1)*(1.0/P1) + (1.0/R3)*(1.0/R3) );
+        tInfo->State_CF_SQPR[1][0] = sqrt( (1.0/P2)*(1.0/P2) + (1.0/R1)*(1.0/R1) );
+        tInfo->State_CF_SQPR[1][1] = sqrt( (1.0/P2)*(1.0/P2) + (1.0/R2)*(1.0/R2) );
+        tInfo->State_CF_SQPR[1][2] = sqrt( (1.0/P2)*(1.0/P2) + (1.0/R3)*(1.0/R3) );
+        tInfo->State_CF_SQPR[2][0] = sqrt( (1.0/P3)*(1.0/P3) + (1.0/R1)*(1.0/R1) );
+        tInfo->State_CF_SQPR[2][1] = sqrt( (1.0/P3)*(1.0/P3) + (1.0/R2)*(1.0/R2) );
+        tInfo->State_CF_SQPR[2][2] = sqrt( (1.0/P3)*(1.0/P3) + (1.0/R3)*(1.0/R3) );
+        tInfo->State_CF_SQQS[0][0] = sqrt( (1.0/Q1)*(1.0/Q1) + (1.0/S1)*(1.0/S1) );
+        tInfo->State_CF_SQQS[0][1] = sqrt( (1.0/Q1)*(1.0/Q1) + (1.0/S2)*(1.0/S2) );
+        tInfo->State_CF_SQQS[0][2] = sqrt( (1.0/Q1)*(1.0/Q1) + (1.0/S3)*(1.0/S3) );
+        tInfo->State_CF_SQQS[1][0] = sqrt( (1.0/Q2)*(1.0/Q2) + (1.0/S1)*(1.0/S1) );
+        tInfo->State_CF_SQQS[1][1] = sqrt( (1.0/Q2)*(1.0/Q2) + (1.0/S2)*(1.0/S2) );
+        tInfo->State_CF_SQQS[1][2] = sqrt( (1.0/Q2)*(1.0/Q2) + (1.0/S3)*(1.0/S3) );
+        tInfo->State_CF_SQQS[2][0] = sqrt( (1.0/Q3)*(1.0/Q3) + (1.0/S1)*(1.0/S1) );
+        tInfo->State_CF_SQQS[2][1] = sqrt( (1.0/Q3)*(1.0/Q3) + (1.0/S2)*(1.0/S2) );
+        tInfo->State_CF_SQQS[2][2] = sqrt( (1.0/Q3)*(1.0/Q3) + (1.0/S3)*(1.0/S3) );
+        tInfo->State_CF_Valid = TRUE;
+    }
+    ST1 = tInfo->State_CF_ST1; CT1 = tInfo->State_CF_CT1;
+    ST2 = tInfo->State_CF_ST2; CT2 = tInfo->State_CF_CT2;
 
     X1 = X*CT1 - Z*ST1; Z1 = X*ST1 + Z*CT1;
     X2 = X*CT2 - Z*ST2; Z2 = X*ST2 + Z*CT2;
@@ -622,27 +704,24 @@ void    SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *
      *           Very expensive. (Is there a recurrence relation for any of this?)
      *         sqrt()'s andm trigs are very expensive so dont do more than we need.
      */
-// do these change? Isnt this wasteful if they dont?
-// especially the sqrt() below...
-    ooP1 = 1.0/P1; ooP1_2 = ooP1*ooP1;
-    ooP2 = 1.0/P2; ooP2_2 = ooP2*ooP2;
-    ooP3 = 1.0/P3; ooP3_2 = ooP3*ooP3;
-    ooR1 = 1.0/R1; ooR1_2 = ooR1*ooR1;
-    ooR2 = 1.0/R2; ooR2_2 = ooR2*ooR2;
+    ooP1 = 1.0/P1;
+    ooP2 = 1.0/P2;
+    ooP3 = 1.0/P3;
+    ooR1 = 1.0/R1;
+    ooR2 = 1.0/R2;
     ooR3 = 1.0/R3; ooR3_2 = ooR3*ooR3;
 
-// are these constants?!
-    sqrtP1R1 = sqrt(ooP1_2 + ooR1_2);
-    sqrtP1R2 = sqrt(ooP1_2 + ooR2_2);
-    sqrtP1R3 = sqrt(ooP1_2 + ooR3_2);
+    sqrtP1R1 = tInfo->State_CF_SQPR[0][0];
+    sqrtP1R2 = tInfo->State_CF_SQPR[0][1];
+    sqrtP1R3 = tInfo->State_CF_SQPR[0][2];
 
-    sqrtP2R1 = sqrt(ooP2_2 + ooR1_2);
-    sqrtP2R2 = sqrt(ooP2_2 + ooR2_2);
-    sqrtP2R3 = sqrt(ooP2_2 + ooR3_2);
+    sqrtP2R1 = tInfo->State_CF_SQPR[1][0];
+    sqrtP2R2 = tInfo->State_CF_SQPR[1][1];
+    sqrtP2R3 = tInfo->State_CF_SQPR[1][2];
 
-    sqrtP3R1 = sqrt(ooP3_2 + ooR1_2);
-    sqrtP3R2 = sqrt(ooP3_2 + ooR2_2);
-    sqrtP3R3 = sqrt(ooP3_2 + ooR3_2);
+    sqrtP3R1 = tInfo->State_CF_SQPR[2][0];
+    sqrtP3R2 = tInfo->State_CF_SQPR[2][1];
+    sqrtP3R3 = tInfo->State_CF_SQPR[2][2];
 
 
     YoP1 = Y*ooP1;
@@ -750,24 +829,24 @@ void    SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *
     /*
      *  MAKE THE TERMS IN THE 2ND SUM ("PARALLEL" SYMMETRY):
      */
-    ooQ1 = 1.0/Q1; ooQ1_2 = ooQ1*ooQ1;
-    ooQ2 = 1.0/Q2; ooQ2_2 = ooQ2*ooQ2;
-    ooQ3 = 1.0/Q3; ooQ3_2 = ooQ3*ooQ3;
-    ooS1 = 1.0/S1; ooS1_2 = ooS1*ooS1;
-    ooS2 = 1.0/S2; ooS2_2 = ooS2*ooS2;
-    ooS3 = 1.0/S3; ooS3_2 = ooS3*ooS3;
+    ooQ1 = 1.0/Q1;
+    ooQ2 = 1.0/Q2;
+    ooQ3 = 1.0/Q3;
+    ooS1 = 1.0/S1;
+    ooS2 = 1.0/S2;
+    ooS3 = 1.0/S3;
 
-    sqrtQ1S1 = sqrt(ooQ1_2 + ooS1_2);
-    sqrtQ1S2 = sqrt(ooQ1_2 + ooS2_2);
-    sqrtQ1S3 = sqrt(ooQ1_2 + ooS3_2);
+    sqrtQ1S1 = tInfo->State_CF_SQQS[0][0];
+    sqrtQ1S2 = tInfo->State_CF_SQQS[0][1];
+    sqrtQ1S3 = tInfo->State_CF_SQQS[0][2];
 
-    sqrtQ2S1 = sqrt(ooQ2_2 + ooS1_2);
-    sqrtQ2S2 = sqrt(ooQ2_2 + ooS2_2);
-    sqrtQ2S3 = sqrt(ooQ2_2 + ooS3_2);
+    sqrtQ2S1 = tInfo->State_CF_SQQS[1][0];
+    sqrtQ2S2 = tInfo->State_CF_SQQS[1][1];
+    sqrtQ2S3 = tInfo->State_CF_SQQS[1][2];
 
-    sqrtQ3S1 = sqrt(ooQ3_2 + ooS1_2);
-    sqrtQ3S2 = sqrt(ooQ3_2 + ooS2_2);
-    sqrtQ3S3 = sqrt(ooQ3_2 + ooS3_2);
+    sqrtQ3S1 = tInfo->State_CF_SQQS[2][0];
+    sqrtQ3S2 = tInfo->State_CF_SQQS[2][1];
+    sqrtQ3S3 = tInfo->State_CF_SQQS[2][2];
 
 
     YoQ1 = Y*ooQ1;
@@ -2185,7 +2264,7 @@ void     FULL_RC( int IOPR, double PS, double X, double Y, double Z,
 
     X_SC = tInfo->CB_RCPAR.SC_SY-1.0;
     if ( (IOPR == 0) || (IOPR == 1) ) {
-        RC_SHIELD( C_SY, PS, X_SC, X, Y, Z, &FSX, &FSY, &FSZ, tInfo );
+        RC_SHIELD( 0, C_SY, PS, X_SC, X, Y, Z, &FSX, &FSY, &FSZ, tInfo );
     } else {
         FSX = 0.0;
         FSY = 0.0;
@@ -2194,7 +2273,7 @@ void     FULL_RC( int IOPR, double PS, double X, double Y, double Z,
 
     X_SC = tInfo->CB_RCPAR.SC_AS-1.0;
     if ( (IOPR == 0) || (IOPR == 2) ) {
-        RC_SHIELD( C_PR, PS, X_SC, X, Y, Z, &FPX, &FPY, &FPZ, tInfo);
+        RC_SHIELD( 1, C_PR, PS, X_SC, X, Y, Z, &FPX, &FPY, &FPZ, tInfo);
     } else {
         FPX = 0.0;
         FPY = 0.0;
@@ -3023,14 +3102,14 @@ void    FFS( double A, double A0, double DA, double *F, double *FA, double *FS )
 
 
 
-void    RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2004_Info *tInfo ) {
+void    RC_SHIELD( int NRC, double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2004_Info *tInfo ) {
 
 
     int    L, M, I, K, N, NN ;
     double X_SCp1, X_SCp12, X_SCp13, FAC_SC, CPS, SPS, S3PS, PST1;
     double PST2, ST1, CT1, ST2, CT2, X1, Z1, X2, Z2, GX, GY, GZ, P;
-    double ooP, ooP2, Q, ooQ, ooQ2, YoP, YoQ, CYPI, CYQI, SYPI, SYQI;
-    double R, ooR, ooR2, S, ooS, ooS2, Z1oR, Z2oS, SZRK, CZSK, CZRK;
+    double ooP, Q, ooQ, YoP, YoQ, CYPI, CYQI, SYPI, SYQI;
+    double R, ooR, S, ooS, Z1oR, Z2oS, SZRK, CZSK, CZRK;
     double SZSK, SQPR, SQQS, EPR, EQS, FX, FY, FZ, HX, HY, HZ, HXR, HZR;
 
 
@@ -3043,11 +3122,25 @@ void    RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, double
 
     S3PS = 2.0*CPS;
 
-    PST1 = PS*A[85];
-    PST2 = PS*A[86];
-
-ST1 = sin(PST1); CT1 = cos(PST1);
-ST2 = sin(PST2); CT2 = cos(PST2);
+    /*
+     *  Tilt rotations and scale constants for this (NRC = 0 for SRC, 1 for
+     *  PRC) shielding field are kept in the model state.
+     */
+    if ( !tInfo->State_RC_Valid[NRC] ) {
+        PST1 = PS*A[85];
+        PST2 = PS*A[86];
+        tInfo->State_RC_ST1[NRC] = sin(PST1); tInfo->State_RC_CT1[NRC] = cos(PST1);
+        tInfo->State_RC_ST2[NRC] = sin(PST2); tInfo->State_RC_CT2[NRC] = cos(PST2);
+        for (I=1; I<=3; I++ ){
+            for (K=1; K<=3; K++ ){
+                tInfo->State_RC_SQPR[NRC][I-1][K-1] = sqrt( (1.0/A[72+I])*(1.0/A[72+I]) + (1.0/A[75+K])*(1.0/A[75+K]) );
+                tInfo->State_RC_SQQS[NRC][I-1][K-1] = sqrt( (1.0/A[78+I])*(1.0/A[78+I]) + (1.0/A[81+K])*(1.0/A[81+K]) );
+            }
+        }
+        tInfo->State_RC_Valid[NRC] = TRUE;
+    }
+    ST1 = tInfo->State_RC_ST1[NRC]; CT1 = tInfo->State_RC_CT1[NRC];
+    ST2 = tInfo->State_RC_ST2[NRC]; CT2 = tInfo->State_RC_CT2[NRC];
 
     X1 = X*CT1-Z*ST1;
     Z1 = X*ST1+Z*CT1;
@@ -3064,8 +3157,8 @@ ST2 = sin(PST2); CT2 = cos(PST2);
 
         for (I=1; I<=3; I++ ){
 
-            P    = A[72+I]; ooP = 1.0/P; ooP2 = ooP*ooP;
-            Q    = A[78+I]; ooQ = 1.0/Q; ooQ2 = ooQ*ooQ;
+            P    = A[72+I]; ooP = 1.0/P;
+            Q    = A[78+I]; ooQ = 1.0/Q;
             YoP = Y*ooP; YoQ = Y*ooQ;
 
 SYPI = sin(YoP); CYPI = cos(YoP);
@@ -3073,14 +3166,14 @@ SYQI = sin(YoQ); CYQI = cos(YoQ);
 
             for (K=1; K<=3; K++ ){
 
-                R    = A[75+K]; ooR = 1.0/R; ooR2 = ooR*ooR;
-                S    = A[81+K]; ooS = 1.0/S; ooS2 = ooS*ooS;
+                R    = A[75+K]; ooR = 1.0/R;
+                S    = A[81+K]; ooS = 1.0/S;
                 Z1oR = Z1*ooR; Z2oS = Z2*ooS;
 SZRK = sin(Z1oR); CZSK = cos(Z2oS);
 CZRK = cos(Z1oR); SZSK = sin(Z2oS);
 
-                SQPR = sqrt(ooP2+ooR2);
-                SQQS = sqrt(ooQ2+ooS2);
+                SQPR = tInfo->State_RC_SQPR[NRC][I-1][K-1];
+                SQQS = tInfo->State_RC_SQQS[NRC][I-1][K-1];
                 EPR  = exp(X1*SQPR);
                 EQS  = exp(X2*SQQS);
 
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "Lgm/Lgm_Tsyg2001.h"
 
 /*
@@ -76,6 +77,11 @@ void Lgm_Init_T01S( LgmTsyg2001_Info *t ){
     t->OLD_X  = -9e99;
     t->OLD_Y  = -9e99;
     t->OLD_Z  = -9e99;
+    t->State_Valid    = FALSE;
+    t->State_Model    = 0;
+    t->State_nUpdates = 0;
+    t->State_CF_Valid = FALSE;
+    t->State_RC_Valid[0] = t->State_RC_Valid[1] = FALSE;
     for (i=0; i<4; i++ ){
         t->DoneJ[i] = 0;
         for (j=0; j<4; j++ ){
@@ -123,6 +129,14 @@ void Tsyg_T01S( int IOPT, double *PARMOD, double PS, double SINPS, double COSPS,
     G2   = PARMOD[5];
     G3   = PARMOD[6];
     PSS  = PS;
+
+    /*
+     *  Recompute the parameter-dependent state only if PS or PARMOD changed.
+     */
+    if ( !t->State_Valid || ( t->State_Model != 1 ) || ( PS != t->State_PS ) || memcmp( &PARMOD[1], &t->State_PARMOD[1], 10*sizeof(double) ) ) {
+        T01S_SetState( A, PARMOD, PS, t );
+    }
+
     XX   = X;
     YY   = Y;
     ZZ   = Z;
@@ -156,6 +170,111 @@ void Tsyg_T01S( int IOPT, double *PARMOD, double PS, double SINPS, double COSPS,
 
 
 
+/*
+ *  Compute everything in T01S_EXTALL() that depends only on the tilt angle
+ *  and the model parameters (scaling factor, IMF clock angle terms,
+ *  tail/Birkeland/ring current scales and amplitudes). This only needs to be
+ *  done once per time step instead of once per point.
+ */
+void T01S_SetState( double *A, double *PARMOD, double PS, LgmTsyg2001_Info *t ) {
+
+    double    PDYN, DST, BYIMF, BZIMF, G2, G3, XAPPA, THETA, st, FACTIMF, ZNAM, a, DLP1, DLP2;
+    double    G2T1, G2T2, G3PRC, G2R11, G2R12, G2R21, G2R22;
+    double    A0_A=34.586, A0_X0=3.4397;     // SHUE ET AL. PARAMETERS
+    int       i;
+
+    PDYN  = PARMOD[1];
+    DST   = PARMOD[2]*0.8 - 13.0*sqrt( PDYN );
+    BYIMF = PARMOD[3];
+    BZIMF = PARMOD[4];
+    G2    = PARMOD[5];
+    G3    = PARMOD[6];
+
+    XAPPA  = pow( 0.5*PDYN, A[39] );   //  NOW THIS IS A VARIABLE PARAMETER
+    t->CB_RH0.RH0  = A[40]; // TAIL HINGING DISTANCE
+    t->CB_G.G      = A[41]; // TAIL WARPING PARAMETER
+
+    t->State_XAPPA  = XAPPA;
+    t->State_XAPPA3 = XAPPA*XAPPA*XAPPA;
+    t->State_SPS    = sin( PS );
+    t->State_X0     = A0_X0/XAPPA;
+    t->State_AM     = A0_A/XAPPA;
+
+    /*
+     * CALCULATE THE IMF CLOCK ANGLE:
+     */
+    if ( (BYIMF==0.0)&&(BZIMF==0.0)) {
+        THETA = 0.0;
+    } else {
+        THETA = atan2( BYIMF, BZIMF );
+        if ( THETA <= 0.0 ) THETA += 2.0*M_PI;
+    }
+    st = sin( 0.5*THETA );
+    t->State_STHETAH = st*st;
+
+    FACTIMF = A[24] + A[25]*t->State_STHETAH;
+    t->State_OIMFY = BYIMF*FACTIMF;
+    t->State_OIMFZ = BZIMF*FACTIMF;
+
+    // Tail
+    t->CB_TAIL.DXSHIFT1 = A[26] + A[27]*G2*40.0/sqrt(1600.0 + G2*G2);
+    t->CB_TAIL.DXSHIFT2 = 0.0;
+    t->CB_TAIL.D        = A[28];
+    t->CB_TAIL.DELTADY  = A[29];
+
+    // Birkeland currents
+    ZNAM = fabs( DST );
+    if ( ZNAM < 20.0 ) ZNAM = 20.0;
+    t->CB_BIRKPAR.XKAPPA1 = A[35]*pow( ZNAM/20.0, A[36] );
+    t->CB_BIRKPAR.XKAPPA2 = A[37]*pow( ZNAM/20.0, A[38] );
+
+    // Ring current
+    t->CB_RCPAR.PHI  = A[34];
+    a     = 20.0/ZNAM;
+    t->CB_RCPAR.SC_SY = A[30]*pow(a, A[31])*XAPPA;
+    t->CB_RCPAR.SC_AS = A[32]*pow(a, A[33])*XAPPA;
+
+    // Amplitudes
+    a    = 0.5*PDYN;
+    DLP1 = pow( a, A[42] );
+    DLP2 = pow( a, A[43] );
+
+    G2T1  = A[44];
+    G2T2  = A[45];
+    G3PRC = A[46];
+    G2R11 = A[47];
+    G2R12 = A[48];
+    G2R21 = A[49];
+    G2R22 = A[50];
+
+    t->State_TAMP1 = A[2] + A[3]*DLP1 + A[4]*G2*G2T1/sqrt(G2T1*G2T1 + G2*G2) + A[5]*DST;            //   modified in this "j"-version
+    t->State_TAMP2 = A[6] + A[7]*DLP2 + A[8]*G2*G2T2/sqrt(G2T2*G2T2 + G2*G2) + A[9]*DST;
+
+    a = sqrt( PDYN );
+    t->State_A_SRC = A[10] + A[11]*DST + A[12]*a;
+    t->State_A_PRC = A[13] + A[14]*G3*G3PRC/sqrt(G3PRC*G3PRC + G3*G3) + A[15]*a;
+    t->State_A_R11 = A[16] + A[17]*G2*G2R11/sqrt(G2R11*G2R11 + G2*G2);
+    t->State_A_R12 = A[18] + A[19]*G2*G2R12/sqrt(G2R12*G2R12 + G2*G2);
+    t->State_A_R21 = A[20] + A[21]*G2*G2R21/sqrt(G2R21*G2R21 + G2*G2);
+    t->State_A_R22 = A[22] + A[23]*G2*G2R22/sqrt(G2R22*G2R22 + G2*G2);
+
+    // Tilt-dependent parts of the shielding fields get recomputed lazily
+    t->State_CF_Valid = FALSE;
+    t->State_RC_Valid[0] = t->State_RC_Valid[1] = FALSE;
+
+    t->State_PS = PS;
+    for ( i=0; i<11; i++ ) t->State_PARMOD[i] = PARMOD[i];
+    t->State_Model = 1;
+    t->State_Valid = TRUE;
+    ++t->State_nUpdates;
+
+    return;
+
+}
+
+
+
+
 /*
  * 
  *    IOPGEN - GENERAL OPTION FLAG:  IOPGEN=0 - CALCULATE TOTAL FIELD
@@ -188,57 +307,38 @@ void T01S_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
                     double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t ){
 
     int       done;
-    double    BPERP, THETA, CT, ST, YS, ZS, st, STHETAH, a, aa, b, A_R12, A_R22;
-    double    XAPPA, XAPPA3, SPS, X0, AM, S0, FACTIMF, OIMFX, OIMFY, OIMFZ, R, XSS, ZSS;
+    double    STHETAH, a, aa, b, A_R12, A_R22;
+    double    XAPPA, XAPPA3, SPS, X0, AM, S0, OIMFX, OIMFY, OIMFZ, R, XSS, ZSS;
     double    XSOLD, ZSOLD, RH, SINPSAS, COSPSAS, DD, RHO2, ASQ;
-    double    XMXM, AXX0, ARO, SIGMA, CFX, CFY, CFZ, ZNAM;
-    double    DLP1, DLP2, TAMP1, TAMP2, A_SRC, A_PRC, A_R11, XX, YY, ZZ;
+    double    XMXM, AXX0, ARO, SIGMA, CFX, CFY, CFZ;
+    double    TAMP1, TAMP2, A_SRC, A_PRC, A_R11, XX, YY, ZZ;
     double    A_R21, QX, QY, QZ, FINT, FEXT, BBX, BBY, BBZ;
-    double    G2T1, G2T2, G3PRC, G2R11, G2R12, G2R21, G2R22;
 
 
 
-    double    A0_A=34.586, A0_S0=1.1960, A0_X0=3.4397;     // SHUE ET AL. PARAMETERS
-    double    DSIG=0.005, RH0=8.0, RH2=-5.2;
+    double    A0_S0=1.1960;     // SHUE ET AL. PARAMETERS
+    double    DSIG=0.005, RH2=-5.2;
 
 
-    XAPPA  = pow( 0.5*PDYN, A[39] );   //  NOW THIS IS A VARIABLE PARAMETER
-    t->CB_RH0.RH0  = A[40]; // TAIL HINGING DISTANCE
-    t->CB_G.G      = A[41]; // TAIL WARPING PARAMETER
-
-    XAPPA3 = XAPPA*XAPPA*XAPPA;
+    /*
+     *  The parameter-dependent quantities come from the model state (see
+     *  T01S_SetState(), which must have been called for the current PS and
+     *  parameters).
+     */
+    XAPPA  = t->State_XAPPA;
+    XAPPA3 = t->State_XAPPA3;
 
     XX = X*XAPPA;
     YY = Y*XAPPA;
     ZZ = Z*XAPPA;
 
-    SPS = sin( PS );
+    SPS = t->State_SPS;
 
-    X0 = A0_X0/XAPPA;
-    AM = A0_A/XAPPA;
+    X0 = t->State_X0;
+    AM = t->State_AM;
     S0 = A0_S0;
 
-    BPERP = sqrt( BYIMF*BYIMF + BZIMF*BZIMF );
-
-
-    /*
-     * CALCULATE THE IMF CLOCK ANGLE:
-     */
-    if ( (BYIMF==0.0)&&(BZIMF==0.0)) {
-        THETA = 0.0;
-    } else {
-        THETA = atan2( BYIMF, BZIMF );
-        if ( THETA <= 0.0 ) THETA += 2.0*M_PI;
-    }
-
-
-    CT = cos(THETA);
-    ST = sin(THETA);
-    YS = Y*CT - Z*ST;
-    ZS = Z*CT + Y*ST;
-
-    st = sin( 0.5*THETA );
-    STHETAH = st*st;
+    STHETAH = t->State_STHETAH;
 
     /*
      *  CALCULATE "IMF" COMPONENTS OUTSIDE THE MAGNETOPAUSE LAYER (HENCE BEGIN WITH "O")
@@ -247,11 +347,9 @@ void T01S_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
      *
      */
 
-    FACTIMF = A[24] + A[25]*STHETAH;
-
     OIMFX = 0.0;
-    OIMFY = BYIMF*FACTIMF;
-    OIMFZ = BZIMF*FACTIMF;
+    OIMFY = t->State_OIMFY;
+    OIMFZ = t->State_OIMFZ;
 
     R   = sqrt( X*X + Y*Y + Z*Z );
     XSS = X;
@@ -301,7 +399,7 @@ void T01S_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
     if ( SIGMA < S0+DSIG ) {  //CASES (1) OR (2); CALCULATE THE MODEL FIELD (WITH THE POTENTIAL "PENETRATED" INTERCONNECTION FIELD):
 
         if ( IOPGEN <= 1 ) {
-            T01S_SHLCAR3X3( XX, YY, ZZ, PS, &CFX, &CFY, &CFZ );         //  T01S_DIPOLE SHIELDING FIELD
+            T01S_SHLCAR3X3( XX, YY, ZZ, PS, &CFX, &CFY, &CFZ, t );         //  T01S_DIPOLE SHIELDING FIELD
 
             *BXCF = CFX*XAPPA3;
             *BYCF = CFY*XAPPA3;
@@ -313,10 +411,6 @@ void T01S_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
         }
 
         if ( (IOPGEN == 0) || (IOPGEN == 2) ) {
-            t->CB_TAIL.DXSHIFT1 = A[26] + A[27]*G2*40.0/sqrt(1600.0 + G2*G2);
-            t->CB_TAIL.DXSHIFT2 = 0.0;
-            t->CB_TAIL.D        = A[28];
-            t->CB_TAIL.DELTADY  = A[29];
             T01S_DEFORMED( IOPT, PS, XX, YY, ZZ, BXT1, BYT1, BZT1, BXT2, BYT2, BZT2, t ); //  TAIL FIELD (THREE MODES)
         } else {
             *BXT1 = 0.0;
@@ -328,12 +422,6 @@ void T01S_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
         }
 
         if ( (IOPGEN == 0) || (IOPGEN == 3) ) {
-
-            ZNAM = fabs( DST );
-            if ( ZNAM < 20.0 ) ZNAM = 20.0;
-            t->CB_BIRKPAR.XKAPPA1 = A[35]*pow( ZNAM/20.0, A[36] );
-            t->CB_BIRKPAR.XKAPPA2 = A[37]*pow( ZNAM/20.0, A[38] );
-
             T01S_BIRK_TOT( IOPB, PS, XX, YY, ZZ, BXR11, BYR11, BZR11, BXR12, BYR12, 
                                   BZR12, BXR21, BYR21, BZR21, BXR22, BYR22, BZR22, t  );    //   BIRKELAND FIELD (TWO MODES FOR R1 AND TWO MODES FOR R2)
         } else {
@@ -352,13 +440,6 @@ void T01S_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
         }
 
         if ( (IOPGEN == 0) || (IOPGEN == 4) ) {
-            t->CB_RCPAR.PHI  = A[34];
-            ZNAM = fabs(DST);
-            if ( ZNAM < 20.0 ) ZNAM = 20.0;
-            a     = 20.0/ZNAM;
-            t->CB_RCPAR.SC_SY = A[30]*pow(a, A[31])*XAPPA;
-            t->CB_RCPAR.SC_AS = A[32]*pow(a, A[33])*XAPPA;
-//            printf("C: SC_SY, SC_AS = %g %g\n", t->CB_RCPAR.SC_SY, t->CB_RCPAR.SC_AS );
             T01S_FULL_RC(IOPR, PS, XX, YY, ZZ, BXSRC, BYSRC, BZSRC, BXPRC, BYPRC, BZPRC, t );  //  SHIELDED RING CURRENT (SRC AND PRC)
         } else {
             *BXSRC = 0.0;
@@ -393,32 +474,14 @@ void T01S_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
          *
          */
 
-        a    = 0.5*PDYN;
-        DLP1 = pow( a, A[42] );
-        DLP2 = pow( a, A[43] );
-
-        G2T1  = A[44];
-        G2T2  = A[45];
-        G3PRC = A[46];
-        G2R11 = A[47];
-        G2R12 = A[48];
-        G2R21 = A[49];
-        G2R22 = A[50];
-
-
-        TAMP1 = A[2] + A[3]*DLP1 + A[4]*G2*G2T1/sqrt(G2T1*G2T1 + G2*G2) + A[5]*DST;            //   modified in this "j"-version
-        TAMP2 = A[6] + A[7]*DLP2 + A[8]*G2*G2T2/sqrt(G2T2*G2T2 + G2*G2) + A[9]*DST;
-
-        a = sqrt( PDYN );
-        A_SRC = A[10] + A[11]*DST + A[12]*a;
-        A_PRC = A[13] + A[14]*G3*G3PRC/sqrt(G3PRC*G3PRC + G3*G3) + A[15]*a;
-        A_R11 = A[16] + A[17]*G2*G2R11/sqrt(G2R11*G2R11 + G2*G2);
-        A_R12 = A[18] + A[19]*G2*G2R12/sqrt(G2R12*G2R12 + G2*G2);
-        A_R21 = A[20] + A[21]*G2*G2R21/sqrt(G2R21*G2R21 + G2*G2);
-        A_R22 = A[22] + A[23]*G2*G2R22/sqrt(G2R22*G2R22 + G2*G2);
-
-//        printf("TAMP1, TAMP2, A_SRC, A_PRC, A_R11, A_R12, A_R21, A_R22 = %g %g %g %g %g %g %g %g\n", TAMP1, TAMP2, A_SRC, A_PRC, A_R11, A_R12, A_R21, A_R22 );
-
+        TAMP1 = t->State_TAMP1;
+        TAMP2 = t->State_TAMP2;
+        A_SRC = t->State_A_SRC;
+        A_PRC = t->State_A_PRC;
+        A_R11 = t->State_A_R11;
+        A_R12 = t->State_A_R12;
+        A_R21 = t->State_A_R21;
+        A_R22 = t->State_A_R22;
 
 
         BBX = A[1]* *BXCF + TAMP1* *BXT1 + TAMP2* *BXT2 + A_SRC* *BXSRC + A_PRC* *BXPRC
@@ -487,7 +550,7 @@ void T01S_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
  *       (ONE FOR THE PSI=0 MODE AND ANOTHER FOR THE PSI=90 MODE)
  * - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
  */
-void T01S_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *BY, double *BZ ) {
+void T01S_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t ) {
 
     static double A[] = { -9e99, -901.2327248,895.8011176,817.6208321,-845.5880889,
                           -83.73539535,86.58542841,336.8781402,-329.3619944,-311.2947120,
@@ -501,10 +564,10 @@ void T01S_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double
                           4.663639687,15.73319647,2.303504968,5.840511214,.8385953499e-01, 
                           .3477844929 };
 
-    double  P1, P2, P3, ooP1, ooP2, ooP3, ooP1_2, ooP2_2, ooP3_2;
-    double  R1, R2, R3, ooR1, ooR2, ooR3, ooR1_2, ooR2_2, ooR3_2;
-    double  Q1, Q2, Q3, ooQ1, ooQ2, ooQ3, ooQ1_2, ooQ2_2, ooQ3_2;
-    double  S1, S2, S3, ooS1, ooS2, ooS3, ooS1_2, ooS2_2, ooS3_2;
+    double  P1, P2, P3, ooP1, ooP2, ooP3;
+    double  R1, R2, R3, ooR1, ooR2, ooR3;
+    double  Q1, Q2, Q3, ooQ1, ooQ2, ooQ3;
+    double  S1, S2, S3, ooS1, ooS2, ooS3;
     double  T1, T2;
     double  CYP, SYP, CZR, SZR, CYQ, SYQ, CZS, SZS;
     double  sqrtP1R1, sqrtP1R2, sqrtP1R3, sqrtP2R1, sqrtP2R2, sqrtP2R3, sqrtP3R1, sqrtP3R2, sqrtP3R3;
@@ -530,32 +593,59 @@ void T01S_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double
     T1 = A[49]; T2 = A[50];
 
 
-    CPS  = cos(PS); SPS  = sin(PS); S2PS = 2.0*CPS; 
-
-    ST1 = sin( PS*T1 ); CT1 = cos( PS*T1 );
-    ST2 = sin( PS*T2 ); CT2 = cos( PS*T2 );
+    /*
+     *  The tilt rotations (and the scale constants below) only change with
+     *  PS, so they are kept in the model state.
+     */
+    if ( !t->State_CF_Valid ) {
+        t->State_CF_CPS = cos( PS );      t->State_CF_SPS = sin( PS );
+        t->State_CF_ST1 = sin( PS*T1 ); t->State_CF_CT1 = cos( PS*T1 );
+        t->State_CF_ST2 = sin( PS*T2 ); t->State_CF_CT2 = cos( PS*T2 );
+        t->State_CF_SQPR[0][0] = sqrt( (1.0/P1)*(1.0/P1) + (1.0/R1)*(1.0/R1) );
+        t->State_CF_SQPR[0][1] = sqrt( (1.0/P1)*(1.0/P1) + (1.0/R2)*(1.0/R2) );
+        t->State_CF_SQPR[0][2] = sqrt( (1.0/P1)*(1.0/P1) + (1.0/R3)*(1.0/R3) );
+        t->State_CF_SQPR[1][0] = sqrt( (1.0/P2)*(1.0/P2) + (1.0/R1)*(1.0/R1) );
+        t->State_CF_SQPR[1][1] = sqrt( (1.0/P2)*(1.0/P2) + (1.0/R2)*(1.0/R2) );
+        t->State_CF_SQPR[1][2] = sqrt( (1.0/P2)*(1.0/P2) + (1.0/R3)*(1.0/R3) );
+        t->State_CF_SQPR[2][0] = sqrt( (1.0/P3)*(1.0/P3) + (1.0/R1)*(1.0/R1) );
+        t->State_CF_SQPR[2][1] = sqrt( (1.0/P3)*(1.0/P3) + (1.0/R2)*(1.0/R2) );
+        t->State_CF_SQPR[2][2] = sqrt( (1.0/P3)*(1.0/P3) + (1.0/R3)*(1.0/R3) );
+        t->State_CF_SQQS[0][0] = sqrt( (1.0/Q1)*(1.0/Q1) + (1.0/S1)*(1.0/S1) );
+        t->State_CF_SQQS[0][1] = sqrt( (1.0/Q1)*(1.0/Q1) + (1.0/S2)*(1.0/S2) );
+        t->State_CF_SQQS[0][2] = sqrt( (1.0/Q1)*(1.0/Q1) + (1.0/S3)*(1.0/S3) );
+        t->State_CF_SQQS[1][0] = sqrt( (1.0/Q2)*(1.0/Q2) + (1.0/S1)*(1.0/S1) );
+        t->State_CF_SQQS[1][1] = sqrt( (1.0/Q2)*(1.0/Q2) + (1.0/S2)*(1.0/S2) );
+        t->State_CF_SQQS[1][2] = sqrt( (1.0/Q2)*(1.0/Q2) + (1.0/S3)*(1.0/S3) );
+        t->State_CF_SQQS[2][0] = sqrt( (1.0/Q3)*(1.0/Q3) + (1.0/S1)*(1.0/S1) );
+        t->State_CF_SQQS[2][1] = sqrt( (1.0/Q3)*(1.0/Q3) + (1.0/S2)*(1.0/S2) );
+        t->State_CF_SQQS[2][2] = sqrt( (1.0/Q3)*(1.0/Q3) + (1.0/S3)*(1.0/S3) );
+        t->State_CF_Valid = TRUE;
+    }
+    CPS = t->State_CF_CPS; SPS = t->State_CF_SPS; S2PS = 2.0*CPS;
+    ST1 = t->State_CF_ST1; CT1 = t->State_CF_CT1;
+    ST2 = t->State_CF_ST2; CT2 = t->State_CF_CT2;
 
     X1 = X*CT1 - Z*ST1; Z1 = X*ST1 + Z*CT1;
     X2 = X*CT2 - Z*ST2; Z2 = X*ST2 + Z*CT2;
 
-    ooP1 = 1.0/P1; ooP1_2 = ooP1*ooP1;
-    ooP2 = 1.0/P2; ooP2_2 = ooP2*ooP2;
-    ooP3 = 1.0/P3; ooP3_2 = ooP3*ooP3;
-    ooR1 = 1.0/R1; ooR1_2 = ooR1*ooR1;
-    ooR2 = 1.0/R2; ooR2_2 = ooR2*ooR2;
-    ooR3 = 1.0/R3; ooR3_2 = ooR3*ooR3;
+    ooP1 = 1.0/P1;
+    ooP2 = 1.0/P2;
+    ooP3 = 1.0/P3;
+    ooR1 = 1.0/R1;
+    ooR2 = 1.0/R2;
+    ooR3 = 1.0/R3;
 
-    sqrtP1R1 = sqrt(ooP1_2 + ooR1_2);
-    sqrtP1R2 = sqrt(ooP1_2 + ooR2_2);
-    sqrtP1R3 = sqrt(ooP1_2 + ooR3_2);
+    sqrtP1R1 = t->State_CF_SQPR[0][0];
+    sqrtP1R2 = t->State_CF_SQPR[0][1];
+    sqrtP1R3 = t->State_CF_SQPR[0][2];
 
-    sqrtP2R1 = sqrt(ooP2_2 + ooR1_2);
-    sqrtP2R2 = sqrt(ooP2_2 + ooR2_2);
-    sqrtP2R3 = sqrt(ooP2_2 + ooR3_2);
+    sqrtP2R1 = t->State_CF_SQPR[1][0];
+    sqrtP2R2 = t->State_CF_SQPR[1][1];
+    sqrtP2R3 = t->State_CF_SQPR[1][2];
 
-    sqrtP3R1 = sqrt(ooP3_2 + ooR1_2);
-    sqrtP3R2 = sqrt(ooP3_2 + ooR2_2);
-    sqrtP3R3 = sqrt(ooP3_2 + ooR3_2);
+    sqrtP3R1 = t->State_CF_SQPR[2][0];
+    sqrtP3R2 = t->State_CF_SQPR[2][1];
+    sqrtP3R3 = t->State_CF_SQPR[2][2];
 
     YoP1 = Y*ooP1;
     YoP2 = Y*ooP2;
@@ -715,24 +805,24 @@ void T01S_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double
     /*  
      *  MAKE THE TERMS IN THE 2ND SUM ("PARALLEL" SYMMETRY):
      */
-    ooQ1 = 1.0/Q1; ooQ1_2 = ooQ1*ooQ1;
-    ooQ2 = 1.0/Q2; ooQ2_2 = ooQ2*ooQ2;
-    ooQ3 = 1.0/Q3; ooQ3_2 = ooQ3*ooQ3;
-    ooS1 = 1.0/S1; ooS1_2 = ooS1*ooS1;
-    ooS2 = 1.0/S2; ooS2_2 = ooS2*ooS2;
-    ooS3 = 1.0/S3; ooS3_2 = ooS3*ooS3;
+    ooQ1 = 1.0/Q1;
+    ooQ2 = 1.0/Q2;
+    ooQ3 = 1.0/Q3;
+    ooS1 = 1.0/S1;
+    ooS2 = 1.0/S2;
+    ooS3 = 1.0/S3;
 
-    sqrtQ1S1 = sqrt(ooQ1_2 + ooS1_2);
-    sqrtQ1S2 = sqrt(ooQ1_2 + ooS2_2);
-    sqrtQ1S3 = sqrt(ooQ1_2 + ooS3_2);
+    sqrtQ1S1 = t->State_CF_SQQS[0][0];
+    sqrtQ1S2 = t->State_CF_SQQS[0][1];
+    sqrtQ1S3 = t->State_CF_SQQS[0][2];
 
-    sqrtQ2S1 = sqrt(ooQ2_2 + ooS1_2);
-    sqrtQ2S2 = sqrt(ooQ2_2 + ooS2_2);
-    sqrtQ2S3 = sqrt(ooQ2_2 + ooS3_2);
+    sqrtQ2S1 = t->State_CF_SQQS[1][0];
+    sqrtQ2S2 = t->State_CF_SQQS[1][1];
+    sqrtQ2S3 = t->State_CF_SQQS[1][2];
 
-    sqrtQ3S1 = sqrt(ooQ3_2 + ooS1_2);
-    sqrtQ3S2 = sqrt(ooQ3_2 + ooS2_2);
-    sqrtQ3S3 = sqrt(ooQ3_2 + ooS3_2);
+    sqrtQ3S1 = t->State_CF_SQQS[2][0];
+    sqrtQ3S2 = t->State_CF_SQQS[2][1];
+    sqrtQ3S3 = t->State_CF_SQQS[2][2];
 
 
     YoQ1 = Y*ooQ1;
@@ -2098,7 +2188,7 @@ void     T01S_FULL_RC( int IOPR, double PS, double X, double Y, double Z,
 
     X_SC = t->CB_RCPAR.SC_SY-1.0;
     if ( (IOPR == 0) || (IOPR == 1) ) {
-        T01S_RC_SHIELD( C_SY, PS, X_SC, X, Y, Z, &FSX, &FSY, &FSZ, t );
+        T01S_RC_SHIELD( 0, C_SY, PS, X_SC, X, Y, Z, &FSX, &FSY, &FSZ, t );
     } else {
         FSX = 0.0;
         FSY = 0.0;
@@ -2107,7 +2197,7 @@ void     T01S_FULL_RC( int IOPR, double PS, double X, double Y, double Z,
 
     X_SC = t->CB_RCPAR.SC_AS-1.0;
     if ( (IOPR == 0) || (IOPR == 2) ) {
-        T01S_RC_SHIELD( C_PR, PS, X_SC, X, Y, Z, &FPX, &FPY, &FPZ, t );
+        T01S_RC_SHIELD( 1, C_PR, PS, X_SC, X, Y, Z, &FPX, &FPY, &FPZ, t );
     } else {
         FPX = 0.0;
         FPY = 0.0;
@@ -2863,14 +2953,14 @@ void    T01S_FFS( double A, double A0, double DA, double *F, double *FA, double
 }
 
 
-void    T01S_RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t ) {
+void    T01S_RC_SHIELD( int NRC, double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t ) {
 
 
     int    L, M, I, K, N, NN ;
     double X_SCp1, X_SCp12, X_SCp13, FAC_SC, CPS, SPS, S3PS, PST1;
     double PST2, ST1, CT1, ST2, CT2, X1, Z1, X2, Z2, GX, GY, GZ, P;
-    double ooP, ooP2, Q, ooQ, ooQ2, YoP, YoQ, CYPI, CYQI, SYPI, SYQI;
-    double R, ooR, ooR2, S, ooS, ooS2, Z1oR, Z2oS, SZRK, CZSK, CZRK;
+    double ooP, Q, ooQ, YoP, YoQ, CYPI, CYQI, SYPI, SYQI;
+    double R, ooR, S, ooS, Z1oR, Z2oS, SZRK, CZSK, CZRK;
     double SZSK, SQPR, SQQS, EPR, EQS, FX, FY, FZ, HX, HY, HZ, HXR, HZR;
 
 
@@ -2883,13 +2973,25 @@ void    T01S_RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, d
 
     S3PS = 2.0*CPS;
 
-    PST1 = PS*A[85];
-    PST2 = PS*A[86];
-
-    ST1 = sin(PST1);
-    CT1 = cos(PST1);
-    ST2 = sin(PST2);
-    CT2 = cos(PST2);
+    /*
+     *  Tilt rotations and scale constants for this (NRC = 0 for SRC, 1 for
+     *  PRC) shielding field are kept in the model state.
+     */
+    if ( !t->State_RC_Valid[NRC] ) {
+        PST1 = PS*A[85];
+        PST2 = PS*A[86];
+        t->State_RC_ST1[NRC] = sin(PST1); t->State_RC_CT1[NRC] = cos(PST1);
+        t->State_RC_ST2[NRC] = sin(PST2); t->State_RC_CT2[NRC] = cos(PST2);
+        for (I=1; I<=3; I++ ){
+            for (K=1; K<=3; K++ ){
+                t->State_RC_SQPR[NRC][I-1][K-1] = sqrt( (1.0/A[72+I])*(1.0/A[72+I]) + (1.0/A[75+K])*(1.0/A[75+K]) );
+                t->State_RC_SQQS[NRC][I-1][K-1] = sqrt( (1.0/A[78+I])*(1.0/A[78+I]) + (1.0/A[81+K])*(1.0/A[81+K]) );
+            }
+        }
+        t->State_RC_Valid[NRC] = TRUE;
+    }
+    ST1 = t->State_RC_ST1[NRC]; CT1 = t->State_RC_CT1[NRC];
+    ST2 = t->State_RC_ST2[NRC]; CT2 = t->State_RC_CT2[NRC];
 
     X1 = X*CT1-Z*ST1;
     Z1 = X*ST1+Z*CT1;
@@ -2906,8 +3008,8 @@ void    T01S_RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, d
 
     for (I=1; I<=3; I++ ){
 
-        P    = A[72+I]; ooP = 1.0/P; ooP2 = ooP*ooP;
-        Q    = A[78+I]; ooQ = 1.0/Q; ooQ2 = ooQ*ooQ;
+        P    = A[72+I]; ooP = 1.0/P;
+        Q    = A[78+I]; ooQ = 1.0/Q;
         YoP = Y*ooP; YoQ = Y*ooQ;
         CYPI = cos(YoP);
         CYQI = cos(YoQ);
@@ -2916,15 +3018,15 @@ void    T01S_RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, d
 
         for (K=1; K<=3; K++ ){
 
-        R    = A[75+K]; ooR = 1.0/R; ooR2 = ooR*ooR;
-        S    = A[81+K]; ooS = 1.0/S; ooS2 = ooS*ooS;
+        R    = A[75+K]; ooR = 1.0/R;
+        S    = A[81+K]; ooS = 1.0/S;
         Z1oR = Z1*ooR; Z2oS = Z2*ooS;
         SZRK = sin(Z1oR);
         CZSK = cos(Z2oS);
         CZRK = cos(Z1oR);
         SZSK = sin(Z2oS);
-        SQPR = sqrt(ooP2+ooR2);
-        SQQS = sqrt(ooQ2+ooS2);
+        SQPR = t->State_RC_SQPR[NRC][I-1][K-1];
+        SQQS = t->State_RC_SQQS[NRC][I-1][K-1];
         EPR  = exp(X1*SQPR);
         EQS  = exp(X2*SQQS);
 
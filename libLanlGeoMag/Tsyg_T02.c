@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "Lgm/Lgm_Tsyg2001.h"
 
 /*
@@ -71,6 +72,11 @@ void Lgm_Init_T02( LgmTsyg2001_Info *t ){
     t->OLD_X  = -9e99;
     t->OLD_Y  = -9e99;
     t->OLD_Z  = -9e99;
+    t->State_Valid    = FALSE;
+    t->State_Model    = 0;
+    t->State_nUpdates = 0;
+    t->State_CF_Valid = FALSE;
+    t->State_RC_Valid[0] = t->State_RC_Valid[1] = FALSE;
     for (i=0; i<4; i++ ){
         t->DoneJ[i] = 0;
         for (j=0; j<4; j++ ){
@@ -111,6 +117,14 @@ void Tsyg_T02( int IOPT, double *PARMOD, double PS, double SINPS, double COSPS,
     G1   = PARMOD[5];
     G2   = PARMOD[6];
     PSS  = PS;
+
+    /*
+     *  Recompute the parameter-dependent state only if PS or PARMOD changed.
+     */
+    if ( !t->State_Valid || ( t->State_Model != 2 ) || ( PS != t->State_PS ) || memcmp( &PARMOD[1], &t->State_PARMOD[1], 10*sizeof(double) ) ) {
+        T02_SetState( A, PARMOD, PS, t );
+    }
+
     XX   = X;
     YY   = Y;
     ZZ   = Z;
@@ -141,6 +155,101 @@ void Tsyg_T02( int IOPT, double *PARMOD, double PS, double SINPS, double COSPS,
 
 
 
+/*
+ *  Compute everything in T02_EXTALL() that depends only on the tilt angle
+ *  and the model parameters (scaling factor, IMF clock angle terms,
+ *  tail/Birkeland/ring current scales and amplitudes). This only needs to be
+ *  done once per time step instead of once per point.
+ */
+void T02_SetState( double *A, double *PARMOD, double PS, LgmTsyg2001_Info *t ) {
+
+    double    PDYN, DST, BYIMF, BZIMF, VBIMF1, VBIMF2, XAPPA, THETA, st, FACTIMF, ZNAM, a, DLP1, DLP2;
+    double    A0_A=34.586, A0_X0=3.4397;     // SHUE ET AL. PARAMETERS
+    int       i;
+
+    PDYN   = PARMOD[1];
+    DST    = PARMOD[2]*0.8 - 13.0*sqrt( PDYN );
+    BYIMF  = PARMOD[3];
+    BZIMF  = PARMOD[4];
+    VBIMF1 = PARMOD[5];
+    VBIMF2 = PARMOD[6];
+
+    XAPPA  = pow( 0.5*PDYN, A[39] );   //  NOW THIS IS A VARIABLE PARAMETER
+    t->CB_RH0.RH0  = A[40]; // TAIL HINGING DISTANCE
+    t->CB_G.G      = A[41]; // TAIL WARPING PARAMETER
+
+    t->State_XAPPA  = XAPPA;
+    t->State_XAPPA3 = XAPPA*XAPPA*XAPPA;
+    t->State_SPS    = sin( PS );
+    t->State_X0     = A0_X0/XAPPA;
+    t->State_AM     = A0_A/XAPPA;
+
+    /*
+     * CALCULATE THE IMF CLOCK ANGLE:
+     */
+    if ( (BYIMF==0.0)&&(BZIMF==0.0)) {
+        THETA = 0.0;
+    } else {
+        THETA = atan2( BYIMF, BZIMF );
+        if ( THETA <= 0.0 ) THETA += 2.0*M_PI;
+    }
+    st = sin( 0.5*THETA );
+    t->State_STHETAH = st*st;
+
+    FACTIMF = A[24] + A[25]*t->State_STHETAH;
+    t->State_OIMFY = BYIMF*FACTIMF;
+    t->State_OIMFZ = BZIMF*FACTIMF;
+
+    // Tail
+    t->CB_TAIL.DXSHIFT1 = A[26] + A[27]*VBIMF2;
+    t->CB_TAIL.DXSHIFT2 = 0.0;
+    t->CB_TAIL.D        = A[28];
+    t->CB_TAIL.DELTADY  = A[29];
+
+    // Birkeland currents
+    t->CB_BIRKPAR.XKAPPA1 = A[35] + A[36]*VBIMF2;
+    t->CB_BIRKPAR.XKAPPA2 = A[37] + A[38]*VBIMF2;
+
+    // Ring current
+    ZNAM = fabs(DST);
+    t->CB_RCPAR.PHI  = 1.5707963*tanh( ZNAM/A[34] );   // PHI uses |DST| before the clamp
+    if ( ZNAM < 20.0 ) ZNAM = 20.0;
+    a     = 20.0/ZNAM;
+    t->CB_RCPAR.SC_SY = A[30]*pow(a, A[31])*XAPPA;
+    t->CB_RCPAR.SC_AS = A[32]*pow(a, A[33])*XAPPA;
+
+    // Amplitudes
+    a    = 0.5*PDYN;
+    DLP1 = pow( a, A[42] );
+    DLP2 = pow( a, A[43] );
+
+    a     = sqrt(PDYN);
+    t->State_TAMP1 = A[2]  + A[3]*DLP1 + A[4]*VBIMF1 + A[5]*DST;
+    t->State_TAMP2 = A[6]  + A[7]*DLP2 + A[8]*VBIMF1 + A[9]*DST;
+    t->State_A_SRC = A[10] + A[11]*DST + A[12]*a;
+    t->State_A_PRC = A[13] + A[14]*DST + A[15]*a;
+    t->State_A_R11 = A[16] + A[17]*VBIMF2;
+    t->State_A_R12 = A[18] + A[19]*VBIMF2;
+    t->State_A_R21 = A[20] + A[21]*VBIMF2;
+    t->State_A_R22 = A[22] + A[23]*VBIMF2;
+
+    // Tilt-dependent parts of the shielding fields get recomputed lazily
+    t->State_CF_Valid = FALSE;
+    t->State_RC_Valid[0] = t->State_RC_Valid[1] = FALSE;
+
+    t->State_PS = PS;
+    for ( i=0; i<11; i++ ) t->State_PARMOD[i] = PARMOD[i];
+    t->State_Model = 2;
+    t->State_Valid = TRUE;
+    ++t->State_nUpdates;
+
+    return;
+
+}
+
+
+
+
 /*
  * 
  *    IOPGEN - GENERAL OPTION FLAG:  IOPGEN=0 - CALCULATE TOTAL FIELD
@@ -173,57 +282,38 @@ void T02_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
                     double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t ){
 
     int       done;
-    double    BPERP, THETA, CT, ST, YS, ZS, st, STHETAH, a, aa, b, A_R12, A_R22;
-    double    XAPPA, XAPPA3, SPS, X0, AM, S0, FACTIMF, OIMFX, OIMFY, OIMFZ, R, XSS, ZSS;
+    double    STHETAH, a, aa, b, A_R12, A_R22;
+    double    XAPPA, XAPPA3, SPS, X0, AM, S0, OIMFX, OIMFY, OIMFZ, R, XSS, ZSS;
     double    XSOLD, ZSOLD, RH, SINPSAS, COSPSAS, DD, RHO2, ASQ;
-    double    XMXM, AXX0, ARO, SIGMA, CFX, CFY, CFZ, ZNAM;
-    double    DLP1, DLP2, TAMP1, TAMP2, A_SRC, A_PRC, A_R11, XX, YY, ZZ;
+    double    XMXM, AXX0, ARO, SIGMA, CFX, CFY, CFZ;
+    double    TAMP1, TAMP2, A_SRC, A_PRC, A_R11, XX, YY, ZZ;
     double    A_R21, QX, QY, QZ, FINT, FEXT, BBX, BBY, BBZ;
 
 
 
-    double    A0_A=34.586, A0_S0=1.1960, A0_X0=3.4397;     // SHUE ET AL. PARAMETERS
+    double    A0_S0=1.1960;     // SHUE ET AL. PARAMETERS
     double    DSIG=0.003, RH2=-5.2;
 
 
-    XAPPA  = pow( 0.5*PDYN, A[39] );   //  NOW THIS IS A VARIABLE PARAMETER
-    //t->CB_RH0.RH0  = 8.0; // always overwritten...?
-    t->CB_RH0.RH0  = A[40]; // TAIL HINGING DISTANCE
-    t->CB_G.G      = A[41]; // TAIL WARPING PARAMETER
-
-    XAPPA3 = XAPPA*XAPPA*XAPPA;
+    /*
+     *  The parameter-dependent quantities come from the model state (see
+     *  T02_SetState(), which must have been called for the current PS and
+     *  parameters).
+     */
+    XAPPA  = t->State_XAPPA;
+    XAPPA3 = t->State_XAPPA3;
 
     XX = X*XAPPA;
     YY = Y*XAPPA;
     ZZ = Z*XAPPA;
 
-    SPS = sin( PS );
+    SPS = t->State_SPS;
 
-    X0 = A0_X0/XAPPA;
-    AM = A0_A/XAPPA;
+    X0 = t->State_X0;
+    AM = t->State_AM;
     S0 = A0_S0;
 
-    BPERP = sqrt( BYIMF*BYIMF + BZIMF*BZIMF );
-
-
-    /*
-     * CALCULATE THE IMF CLOCK ANGLE:
-     */
-    if ( (BYIMF==0.0)&&(BZIMF==0.0)) {
-        THETA = 0.0;
-    } else {
-        THETA = atan2( BYIMF, BZIMF );
-        if ( THETA <= 0.0 ) THETA += 2.0*M_PI;
-    }
-
-
-    CT = cos(THETA);
-    ST = sin(THETA);
-    YS = Y*CT - Z*ST;
-    ZS = Z*CT + Y*ST;
-
-    st = sin( 0.5*THETA );
-    STHETAH = st*st;
+    STHETAH = t->State_STHETAH;
 
     /*
      *  CALCULATE "IMF" COMPONENTS OUTSIDE THE MAGNETOPAUSE LAYER (HENCE BEGIN WITH "O")
@@ -232,11 +322,9 @@ void T02_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
      *
      */
 
-    FACTIMF = A[24] + A[25]*STHETAH;
-
     OIMFX = 0.0;
-    OIMFY = BYIMF*FACTIMF;
-    OIMFZ = BZIMF*FACTIMF;
+    OIMFY = t->State_OIMFY;
+    OIMFZ = t->State_OIMFZ;
 
     R   = sqrt( X*X + Y*Y + Z*Z );
     XSS = X;
@@ -285,7 +373,7 @@ void T02_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
     if ( SIGMA < S0+DSIG ) {  //CASES (1) OR (2); CALCULATE THE MODEL FIELD (WITH THE POTENTIAL "PENETRATED" INTERCONNECTION FIELD):
 
         if ( IOPGEN <= 1 ) {
-            T02_SHLCAR3X3( XX, YY, ZZ, PS, &CFX, &CFY, &CFZ );         //  T02_DIPOLE SHIELDING FIELD
+            T02_SHLCAR3X3( XX, YY, ZZ, PS, &CFX, &CFY, &CFZ, t );         //  T02_DIPOLE SHIELDING FIELD
 //printf("PS = %g   XAPPA3 = %g\n", PS, XAPPA3);
 
             *BXCF = CFX*XAPPA3;
@@ -298,10 +386,6 @@ void T02_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
         }
 
         if ( (IOPGEN == 0) || (IOPGEN == 2) ) {
-            t->CB_TAIL.DXSHIFT1 = A[26] + A[27]*VBIMF2;
-            t->CB_TAIL.DXSHIFT2 = 0.0;
-            t->CB_TAIL.D        = A[28];
-            t->CB_TAIL.DELTADY  = A[29];
             T02_DEFORMED( IOPT, PS, XX, YY, ZZ, BXT1, BYT1, BZT1, BXT2, BYT2, BZT2, t ); //  TAIL FIELD (THREE MODES)
         } else {
             *BXT1 = 0.0;
@@ -313,8 +397,6 @@ void T02_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
         }
 
         if ( (IOPGEN == 0) || (IOPGEN == 3) ) {
-            t->CB_BIRKPAR.XKAPPA1 = A[35] + A[36]*VBIMF2;
-            t->CB_BIRKPAR.XKAPPA2 = A[37] + A[38]*VBIMF2;
             T02_BIRK_TOT( IOPB, PS, XX, YY, ZZ, BXR11, BYR11, BZR11, BXR12, BYR12, 
                                   BZR12, BXR21, BYR21, BZR21, BXR22, BYR22, BZR22, t  );    //   BIRKELAND FIELD (TWO MODES FOR R1 AND TWO MODES FOR R2)
         } else {
@@ -333,12 +415,6 @@ void T02_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
         }
 
         if ( (IOPGEN == 0) || (IOPGEN == 4) ) {
-            ZNAM = fabs(DST);
-            t->CB_RCPAR.PHI  = 1.5707963*tanh( ZNAM/A[34] );
-            if ( ZNAM < 20.0 ) ZNAM = 20.0;
-            a     = 20.0/ZNAM;
-            t->CB_RCPAR.SC_SY = A[30]*pow(a, A[31])*XAPPA;
-            t->CB_RCPAR.SC_AS = A[32]*pow(a, A[33])*XAPPA;
             T02_FULL_RC(IOPR, PS, XX, YY, ZZ, BXSRC, BYSRC, BZSRC, BXPRC, BYPRC, BZPRC, t );  //  SHIELDED RING CURRENT (SRC AND PRC)
         } else {
             *BXSRC = 0.0;
@@ -373,19 +449,15 @@ void T02_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
          *
          */
 
-        a    = 0.5*PDYN;
-        DLP1 = pow( a, A[42] );
-        DLP2 = pow( a, A[43] );
+        TAMP1 = t->State_TAMP1;
+        TAMP2 = t->State_TAMP2;
+        A_SRC = t->State_A_SRC;
+        A_PRC = t->State_A_PRC;
+        A_R11 = t->State_A_R11;
+        A_R12 = t->State_A_R12;
+        A_R21 = t->State_A_R21;
+        A_R22 = t->State_A_R22;
 
-        a     = sqrt(PDYN);
-        TAMP1 = A[2]  + A[3]*DLP1 + A[4]*VBIMF1 + A[5]*DST;
-        TAMP2 = A[6]  + A[7]*DLP2 + A[8]*VBIMF1 + A[9]*DST;
-        A_SRC = A[10] + A[11]*DST + A[12]*a;
-        A_PRC = A[13] + A[14]*DST + A[15]*a;
-        A_R11 = A[16] + A[17]*VBIMF2;
-        A_R12 = A[18] + A[19]*VBIMF2;
-        A_R21 = A[20] + A[21]*VBIMF2;
-        A_R22 = A[22] + A[23]*VBIMF2;
 
         BBX = A[1]* *BXCF + TAMP1* *BXT1 + TAMP2* *BXT2 + A_SRC* *BXSRC + A_PRC* *BXPRC
                  + A_R11* *BXR11 + A_R12* *BXR12 + A_R21* *BXR21 + A_R22* *BXR22
@@ -449,7 +521,7 @@ void T02_EXTALL( int IOPGEN, int IOPT, int IOPB, int IOPR, double *A, int NTOT,
  *       (ONE FOR THE PSI=0 MODE AND ANOTHER FOR THE PSI=90 MODE)
  * - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
  */
-void T02_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *BY, double *BZ ) {
+void T02_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t ) {
 
     static double A[] = { -9e99, -901.2327248,895.8011176,817.6208321,-845.5880889,
                           -83.73539535,86.58542841,336.8781402,-329.3619944,-311.2947120,
@@ -463,10 +535,10 @@ void T02_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double
                           4.663639687,15.73319647,2.303504968,5.840511214,.8385953499e-01, 
                           .3477844929 };
 
-    double  P1, P2, P3, ooP1, ooP2, ooP3, ooP1_2, ooP2_2, ooP3_2;
-    double  R1, R2, R3, ooR1, ooR2, ooR3, ooR1_2, ooR2_2, ooR3_2;
-    double  Q1, Q2, Q3, ooQ1, ooQ2, ooQ3, ooQ1_2, ooQ2_2, ooQ3_2;
-    double  S1, S2, S3, ooS1, ooS2, ooS3, ooS1_2, ooS2_2, ooS3_2;
+    double  P1, P2, P3, ooP1, ooP2, ooP3;
+    double  R1, R2, R3, ooR1, ooR2, ooR3;
+    double  Q1, Q2, Q3, ooQ1, ooQ2, ooQ3;
+    double  S1, S2, S3, ooS1, ooS2, ooS3;
     double  T1, T2;
     double  CYP, SYP, CZR, SZR, CYQ, SYQ, CZS, SZS;
     double  sqrtP1R1, sqrtP1R2, sqrtP1R3, sqrtP2R1, sqrtP2R2, sqrtP2R3, sqrtP3R1, sqrtP3R2, sqrtP3R3;
@@ -492,32 +564,59 @@ void T02_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double
     T1 = A[49]; T2 = A[50];
 
 
-    CPS  = cos(PS); SPS  = sin(PS); S2PS = 2.0*CPS; 
-
-    ST1 = sin( PS*T1 ); CT1 = cos( PS*T1 );
-    ST2 = sin( PS*T2 ); CT2 = cos( PS*T2 );
+    /*
+     *  The tilt rotations (and the scale constants below) only change with
+     *  PS, so they are kept in the model state.
+     */
+    if ( !t->State_CF_Valid ) {
+        t->State_CF_CPS = cos( PS );      t->State_CF_SPS = sin( PS );
+        t->State_CF_ST1 = sin( PS*T1 ); t->State_CF_CT1 = cos( PS*T1 );
+        t->State_CF_ST2 = sin( PS*T2 ); t->State_CF_CT2 = cos( PS*T2 );
+        t->State_CF_SQPR[0][0] = sqrt( (1.0/P1)*(1.0/P1) + (1.0/R1)*(1.0/R1) );
+        t->State_CF_SQPR[0][1] = sqrt( (1.0/P1)*(1.0/P1) + (1.0/R2)*(1.0/R2) );
+        t->State_CF_SQPR[0][2] = sqrt( (1.0/P1)*(1.0/P1) + (1.0/R3)*(1.0/R3) );
+        t->State_CF_SQPR[1][0] = sqrt( (1.0/P2)*(1.0/P2) + (1.0/R1)*(1.0/R1) );
+        t->State_CF_SQPR[1][1] = sqrt( (1.0/P2)*(1.0/P2) + (1.0/R2)*(1.0/R2) );
+        t->State_CF_SQPR[1][2] = sqrt( (1.0/P2)*(1.0/P2) + (1.0/R3)*(1.0/R3) );
+        t->State_CF_SQPR[2][0] = sqrt( (1.0/P3)*(1.0/P3) + (1.0/R1)*(1.0/R1) );
+        t->State_CF_SQPR[2][1] = sqrt( (1.0/P3)*(1.0/P3) + (1.0/R2)*(1.0/R2) );
+        t->State_CF_SQPR[2][2] = sqrt( (1.0/P3)*(1.0/P3) + (1.0/R3)*(1.0/R3) );
+        t->State_CF_SQQS[0][0] = sqrt( (1.0/Q1)*(1.0/Q1) + (1.0/S1)*(1.0/S1) );
+        t->State_CF_SQQS[0][1] = sqrt( (1.0/Q1)*(1.0/Q1) + (1.0/S2)*(1.0/S2) );
+        t->State_CF_SQQS[0][2] = sqrt( (1.0/Q1)*(1.0/Q1) + (1.0/S3)*(1.0/S3) );
+        t->State_CF_SQQS[1][0] = sqrt( (1.0/Q2)*(1.0/Q2) + (1.0/S1)*(1.0/S1) );
+        t->State_CF_SQQS[1][1] = sqrt( (1.0/Q2)*(1.0/Q2) + (1.0/S2)*(1.0/S2) );
+        t->State_CF_SQQS[1][2] = sqrt( (1.0/Q2)*(1.0/Q2) + (1.0/S3)*(1.0/S3) );
+        t->State_CF_SQQS[2][0] = sqrt( (1.0/Q3)*(1.0/Q3) + (1.0/S1)*(1.0/S1) );
+        t->State_CF_SQQS[2][1] = sqrt( (1.0/Q3)*(1.0/Q3) + (1.0/S2)*(1.0/S2) );
+        t->State_CF_SQQS[2][2] = sqrt( (1.0/Q3)*(1.0/Q3) + (1.0/S3)*(1.0/S3) );
+        t->State_CF_Valid = TRUE;
+    }
+    CPS = t->State_CF_CPS; SPS = t->State_CF_SPS; S2PS = 2.0*CPS;
+    ST1 = t->State_CF_ST1; CT1 = t->State_CF_CT1;
+    ST2 = t->State_CF_ST2; CT2 = t->State_CF_CT2;
 
     X1 = X*CT1 - Z*ST1; Z1 = X*ST1 + Z*CT1;
     X2 = X*CT2 - Z*ST2; Z2 = X*ST2 + Z*CT2;
 
-    ooP1 = 1.0/P1; ooP1_2 = ooP1*ooP1;
-    ooP2 = 1.0/P2; ooP2_2 = ooP2*ooP2;
-    ooP3 = 1.0/P3; ooP3_2 = ooP3*ooP3;
-    ooR1 = 1.0/R1; ooR1_2 = ooR1*ooR1;
-    ooR2 = 1.0/R2; ooR2_2 = ooR2*ooR2;
-    ooR3 = 1.0/R3; ooR3_2 = ooR3*ooR3;
+    ooP1 = 1.0/P1;
+    ooP2 = 1.0/P2;
+    ooP3 = 1.0/P3;
+    ooR1 = 1.0/R1;
+    ooR2 = 1.0/R2;
+    ooR3 = 1.0/R3;
 
-    sqrtP1R1 = sqrt(ooP1_2 + ooR1_2);
-    sqrtP1R2 = sqrt(ooP1_2 + ooR2_2);
-    sqrtP1R3 = sqrt(ooP1_2 + ooR3_2);
+    sqrtP1R1 = t->State_CF_SQPR[0][0];
+    sqrtP1R2 = t->State_CF_SQPR[0][1];
+    sqrtP1R3 = t->State_CF_SQPR[0][2];
 
-    sqrtP2R1 = sqrt(ooP2_2 + ooR1_2);
-    sqrtP2R2 = sqrt(ooP2_2 + ooR2_2);
-    sqrtP2R3 = sqrt(ooP2_2 + ooR3_2);
+    sqrtP2R1 = t->State_CF_SQPR[1][0];
+    sqrtP2R2 = t->State_CF_SQPR[1][1];
+    sqrtP2R3 = t->State_CF_SQPR[1][2];
 
-    sqrtP3R1 = sqrt(ooP3_2 + ooR1_2);
-    sqrtP3R2 = sqrt(ooP3_2 + ooR2_2);
-    sqrtP3R3 = sqrt(ooP3_2 + ooR3_2);
+    sqrtP3R1 = t->State_CF_SQPR[2][0];
+    sqrtP3R2 = t->State_CF_SQPR[2][1];
+    sqrtP3R3 = t->State_CF_SQPR[2][2];
 
     YoP1 = Y*ooP1;
     YoP2 = Y*ooP2;
@@ -677,24 +776,24 @@ void T02_SHLCAR3X3( double X, double Y, double Z, double PS, double *BX, double
     /*  
      *  MAKE THE TERMS IN THE 2ND SUM ("PARALLEL" SYMMETRY):
      */
-    ooQ1 = 1.0/Q1; ooQ1_2 = ooQ1*ooQ1;
-    ooQ2 = 1.0/Q2; ooQ2_2 = ooQ2*ooQ2;
-    ooQ3 = 1.0/Q3; ooQ3_2 = ooQ3*ooQ3;
-    ooS1 = 1.0/S1; ooS1_2 = ooS1*ooS1;
-    ooS2 = 1.0/S2; ooS2_2 = ooS2*ooS2;
-    ooS3 = 1.0/S3; ooS3_2 = ooS3*ooS3;
+    ooQ1 = 1.0/Q1;
+    ooQ2 = 1.0/Q2;
+    ooQ3 = 1.0/Q3;
+    ooS1 = 1.0/S1;
+    ooS2 = 1.0/S2;
+    ooS3 = 1.0/S3;
 
-    sqrtQ1S1 = sqrt(ooQ1_2 + ooS1_2);
-    sqrtQ1S2 = sqrt(ooQ1_2 + ooS2_2);
-    sqrtQ1S3 = sqrt(ooQ1_2 + ooS3_2);
+    sqrtQ1S1 = t->State_CF_SQQS[0][0];
+    sqrtQ1S2 = t->State_CF_SQQS[0][1];
+    sqrtQ1S3 = t->State_CF_SQQS[0][2];
 
-    sqrtQ2S1 = sqrt(ooQ2_2 + ooS1_2);
-    sqrtQ2S2 = sqrt(ooQ2_2 + ooS2_2);
-    sqrtQ2S3 = sqrt(ooQ2_2 + ooS3_2);
+    sqrtQ2S1 = t->State_CF_SQQS[1][0];
+    sqrtQ2S2 = t->State_CF_SQQS[1][1];
+    sqrtQ2S3 = t->State_CF_SQQS[1][2];
 
-    sqrtQ3S1 = sqrt(ooQ3_2 + ooS1_2);
-    sqrtQ3S2 = sqrt(ooQ3_2 + ooS2_2);
-    sqrtQ3S3 = sqrt(ooQ3_2 + ooS3_2);
+    sqrtQ3S1 = t->State_CF_SQQS[2][0];
+    sqrtQ3S2 = t->State_CF_SQQS[2][1];
+    sqrtQ3S3 = t->State_CF_SQQS[2][2];
 
 
     YoQ1 = Y*ooQ1;
@@ -2063,7 +2162,7 @@ void     T02_FULL_RC( int IOPR, double PS, double X, double Y, double Z,
 
     X_SC = t->CB_RCPAR.SC_SY-1.0;
     if ( (IOPR == 0) || (IOPR == 1) ) {
-        T02_RC_SHIELD( C_SY, PS, X_SC, X, Y, Z, &FSX, &FSY, &FSZ, t );
+        T02_RC_SHIELD( 0, C_SY, PS, X_SC, X, Y, Z, &FSX, &FSY, &FSZ, t );
     } else {
         FSX = 0.0;
         FSY = 0.0;
@@ -2072,7 +2171,7 @@ void     T02_FULL_RC( int IOPR, double PS, double X, double Y, double Z,
 
     X_SC = t->CB_RCPAR.SC_AS-1.0;
     if ( (IOPR == 0) || (IOPR == 2) ) {
-        T02_RC_SHIELD( C_PR, PS, X_SC, X, Y, Z, &FPX, &FPY, &FPZ, t );
+        T02_RC_SHIELD( 1, C_PR, PS, X_SC, X, Y, Z, &FPX, &FPY, &FPZ, t );
     } else {
         FPX = 0.0;
         FPY = 0.0;
@@ -2828,14 +2927,14 @@ void    T02_FFS( double A, double A0, double DA, double *F, double *FA, double *
 }
 
 
-void    T02_RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t ) {
+void    T02_RC_SHIELD( int NRC, double *A, double PS, double X_SC, double X, double Y, double Z, double *BX, double *BY, double *BZ, LgmTsyg2001_Info *t ) {
 
 
     int    L, M, I, K, N, NN ;
     double X_SCp1, X_SCp12, X_SCp13, FAC_SC, CPS, SPS, S3PS, PST1;
     double PST2, ST1, CT1, ST2, CT2, X1, Z1, X2, Z2, GX, GY, GZ, P;
-    double ooP, ooP2, Q, ooQ, ooQ2, YoP, YoQ, CYPI, CYQI, SYPI, SYQI;
-    double R, ooR, ooR2, S, ooS, ooS2, Z1oR, Z2oS, SZRK, CZSK, CZRK;
+    double ooP, Q, ooQ, YoP, YoQ, CYPI, CYQI, SYPI, SYQI;
+    double R, ooR, S, ooS, Z1oR, Z2oS, SZRK, CZSK, CZRK;
     double SZSK, SQPR, SQQS, EPR, EQS, FX, FY, FZ, HX, HY, HZ, HXR, HZR;
 
 
@@ -2848,13 +2947,25 @@ void    T02_RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, do
 
     S3PS = 2.0*CPS;
 
-    PST1 = PS*A[85];
-    PST2 = PS*A[86];
-
-    ST1 = sin(PST1);
-    CT1 = cos(PST1);
-    ST2 = sin(PST2);
-    CT2 = cos(PST2);
+    /*
+     *  Tilt rotations and scale constants for this (NRC = 0 for SRC, 1 for
+     *  PRC) shielding field are kept in the model state.
+     */
+    if ( !t->State_RC_Valid[NRC] ) {
+        PST1 = PS*A[85];
+        PST2 = PS*A[86];
+        t->State_RC_ST1[NRC] = sin(PST1); t->State_RC_CT1[NRC] = cos(PST1);
+        t->State_RC_ST2[NRC] = sin(PST2); t->State_RC_CT2[NRC] = cos(PST2);
+        for (I=1; I<=3; I++ ){
+            for (K=1; K<=3; K++ ){
+                t->State_RC_SQPR[NRC][I-1][K-1] = sqrt( (1.0/A[72+I])*(1.0/A[72+I]) + (1.0/A[75+K])*(1.0/A[75+K]) );
+                t->State_RC_SQQS[NRC][I-1][K-1] = sqrt( (1.0/A[78+I])*(1.0/A[78+I]) + (1.0/A[81+K])*(1.0/A[81+K]) );
+            }
+        }
+        t->State_RC_Valid[NRC] = TRUE;
+    }
+    ST1 = t->State_RC_ST1[NRC]; CT1 = t->State_RC_CT1[NRC];
+    ST2 = t->State_RC_ST2[NRC]; CT2 = t->State_RC_CT2[NRC];
 
     X1 = X*CT1-Z*ST1;
     Z1 = X*ST1+Z*CT1;
@@ -2871,8 +2982,8 @@ void    T02_RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, do
 
     for (I=1; I<=3; I++ ){
 
-        P    = A[72+I]; ooP = 1.0/P; ooP2 = ooP*ooP;
-        Q    = A[78+I]; ooQ = 1.0/Q; ooQ2 = ooQ*ooQ;
+        P    = A[72+I]; ooP = 1.0/P;
+        Q    = A[78+I]; ooQ = 1.0/Q;
         YoP = Y*ooP; YoQ = Y*ooQ;
         CYPI = cos(YoP);
         CYQI = cos(YoQ);
@@ -2881,15 +2992,15 @@ void    T02_RC_SHIELD( double *A, double PS, double X_SC, double X, double Y, do
 
         for (K=1; K<=3; K++ ){
 
-        R    = A[75+K]; ooR = 1.0/R; ooR2 = ooR*ooR;
-        S    = A[81+K]; ooS = 1.0/S; ooS2 = ooS*ooS;
+        R    = A[75+K]; ooR = 1.0/R;
+        S    = A[81+K]; ooS = 1.0/S;
         Z1oR = Z1*ooR; Z2oS = Z2*ooS;
         SZRK = sin(Z1oR);
         CZSK = cos(Z2oS);
         CZRK = cos(Z1oR);
         SZSK = sin(Z2oS);
-        SQPR = sqrt(ooP2+ooR2);
-        SQQS = sqrt(ooQ2+ooS2);
+        SQPR = t->State_RC_SQPR[NRC][I-1][K-1];
+        SQQS = t->State_RC_SQQS[NRC][I-1][K-1];
         EPR  = exp(X1*SQPR);
         EQS  = exp(X2*SQQS);
 
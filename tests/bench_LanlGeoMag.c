@@ -0,0 +1,654 @@
+/*
+ *  Micro-benchmarks for LanlGeoMag.
+ *
+ *  Times a fixed, reproducible set of workloads and writes the rates as JSON
+ *  (default) or CSV so that they can be tracked over time;
+ *
+ *      B_<model>           Field model evaluations/s over a fixed point cloud (2-10 Re)
+ *      Trace_<model>       Lgm_TraceToEarth() calls/s (and B evaluations/s made while tracing)
+ *      Lstar_<model>_Q<q>  Lstar() calls/s at quality level q
+ *      F2P_AlphaOfK_<model>        Lgm_F2P_AlphaOfK() calls/s (8 K's per call)
+ *      F2P_AlphaOfK_<model>_PerK   The same, done with Lgm_AlphaOfK() on each K over all threads
+ *      CTrans_*            Lgm_Set_Coord_Transforms() and Lgm_Convert_Coords() calls/s
+ *
+ *  Each workload is run several times and the median rate is reported
+ *  (along with the min and max). If a baseline file (the output of an
+ *  earlier run) is given, each result is compared against it and any that
+ *  are slower by more than the given tolerance are flagged, and the exit
+ *  status is non-zero if there were any.
+ *
+ *  Normally run through "make bench", "make bench-baseline" or
+ *  "make bench-compare".
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+#include <argp.h>
+#include "../libLanlGeoMag/Lgm/Lgm_MagModelInfo.h"
+#include "../libLanlGeoMag/Lgm/Lgm_LstarInfo.h"
+#include "../libLanlGeoMag/Lgm/Lgm_FluxToPsd.h"
+
+#define BENCH_MAX_RESULTS   64
+#define BENCH_MAX_REPS      50
+#define BENCH_NPOINTS       20000
+
+
+const  char *argp_program_version     = "bench_LanlGeoMag_1.0";
+static char doc[] = "Run the LanlGeoMag micro-benchmarks and (optionally) compare them against a baseline.";
+static char ArgsDoc[] = "";
+
+static struct argp_option Options[] = {
+    {"Output",      'o',    "file",     0,  "Write results to this file (default is stdout)."                                       },
+    {"Format",      'f',    "format",   0,  "Output format; json or csv. Default is json."                                          },
+    {"Baseline",    'b',    "file",     0,  "Compare against the results in this file (json or csv, as written by an earlier run)." },
+    {"Tolerance",   't',    "percent",  0,  "Flag results that are more than this much slower than the baseline. Default is 10."   },
+    {"Reps",        'r',    "n",        0,  "Number of times to repeat each benchmark. Default is 5."                               },
+    {"Select",      's',    "substr",   0,  "Only run the benchmarks whose names contain this string."                              },
+    {"Quick",       'q',    0,          0,  "Smaller workloads (for a fast sanity check; the rates are noisier)."                   },
+    {"Verbose",     'v',    0,          0,  "Print each result as it is obtained."                                                  },
+    { 0 }
+};
+
+struct Arguments {
+    char    Output[1024];
+    char    Baseline[1024];
+    char    Select[80];
+    int     Csv;
+    double  Tolerance;
+    int     nReps;
+    int     Quick;
+    int     Verbose;
+};
+
+static error_t parse_opt( int key, char *arg, struct argp_state *state ) {
+
+    struct Arguments *arguments = state->input;
+
+    switch( key ) {
+        case 'o':
+            strncpy( arguments->Output, arg, 1023 );
+            break;
+        case 'f':
+            if      ( !strcmp( arg, "csv" ) )  arguments->Csv = TRUE;
+            else if ( !strcmp( arg, "json" ) ) arguments->Csv = FALSE;
+            else argp_usage( state );
+            break;
+        case 'b':
+            strncpy( arguments->Baseline, arg, 1023 );
+            break;
+        case 't':
+            arguments->Tolerance = atof( arg );
+            break;
+        case 'r':
+            arguments->nReps = atoi( arg );
+            if ( arguments->nReps < 1 ) arguments->nReps = 1;
+            if ( arguments->nReps > BENCH_MAX_REPS ) arguments->nReps = BENCH_MAX_REPS;
+            break;
+        case 's':
+            strncpy( arguments->Select, arg, 79 );
+            break;
+        case 'q':
+            arguments->Quick = TRUE;
+            break;
+        case 'v':
+            arguments->Verbose = TRUE;
+            break;
+        case ARGP_KEY_ARG:
+            argp_usage( state );
+            break;
+        default:
+            return ARGP_ERR_UNKNOWN;
+    }
+    return 0;
+}
+
+static struct argp argp = { Options, parse_opt, ArgsDoc, doc };
+
+
+
+typedef struct BenchResult {
+    char        Name[64];
+    char        Unit[16];
+    long int    nOps;                   // Number of operations timed per repetition
+    double      Rate[BENCH_MAX_REPS];   // Rate (ops/s) for each repetition
+    int         nReps;
+    double      Median, Min, Max;
+} BenchResult;
+
+static BenchResult      Results[BENCH_MAX_RESULTS];
+static int              nResults = 0;
+static struct Arguments Args;
+
+static Lgm_Vector       *Cloud;
+static int              nCloud;
+
+
+static double WallTime( void ) {
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return( (double)tv.tv_sec + 1e-6*(double)tv.tv_usec );
+}
+
+static int CompareDoubles( const void *a, const void *b ) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return( (x > y) - (x < y) );
+}
+
+static int Selected( char *Name ) {
+    return( (Args.Select[0] == '\0') || (strstr( Name, Args.Select ) != NULL) );
+}
+
+static BenchResult *AddResult( char *Name, char *Unit, long int nOps ) {
+    BenchResult *r;
+    if ( nResults >= BENCH_MAX_RESULTS ) {
+        fprintf( stderr, "bench_LanlGeoMag: too many results (max is %d)\n", BENCH_MAX_RESULTS );
+        exit( -1 );
+    }
+    r = &Results[nResults++];
+    strncpy( r->Name, Name, 63 ); r->Name[63] = '\0';
+    strncpy( r->Unit, Unit, 15 ); r->Unit[15] = '\0';
+    r->nOps  = nOps;
+    r->nReps = 0;
+    return( r );
+}
+
+static void FinishResult( BenchResult *r ) {
+    double  s[BENCH_MAX_REPS];
+    int     n = r->nReps;
+    memcpy( s, r->Rate, n*sizeof(double) );
+    qsort( s, n, sizeof(double), CompareDoubles );
+    r->Min    = s[0];
+    r->Max    = s[n-1];
+    r->Median = (n%2) ? s[n/2] : 0.5*(s[n/2-1]+s[n/2]);
+    if ( Args.Verbose ) fprintf( stderr, "%-24s %14.6g %-10s (min %.6g, max %.6g, n = %ld)\n", r->Name, r->Median, r->Unit, r->Min, r->Max, r->nOps );
+}
+
+
+/*
+ *  B evaluations are counted by routing them through this wrapper.
+ */
+static int      (*BenchBsrc)();
+static long int BenchnB;
+static int BenchCountB( Lgm_Vector *v, Lgm_Vector *B, Lgm_MagModelInfo *Info ) {
+    ++BenchnB;
+    return( BenchBsrc( v, B, Info ) );
+}
+
+
+/*
+ *  Set up a MagInfo with a fixed time and fixed, moderately disturbed, model
+ *  parameters.
+ */
+static void SetUpModel( int InternalModel, int ExternalModel, Lgm_MagModelInfo *m ) {
+
+    Lgm_Set_Coord_Transforms( 20130317, 12.0, m->c );
+    Lgm_MagModelInfo_Set_MagModel( InternalModel, ExternalModel, m );
+
+    m->Kp  = 3; m->fKp = 3.0;
+    m->P   = 2.1; m->Dst = -25.0; m->By  = 3.0; m->Bz  = -4.0;
+    m->V   = 450.0; m->Den = 6.0;
+    m->G1  = 2.5; m->G2  = 3.2; m->G3  = 6.0;
+    m->W[0] = 0.44; m->W[1] = 0.42; m->W[2] = 0.66; m->W[3] = 0.48; m->W[4] = 0.49; m->W[5] = 0.91;
+
+    if ( ExternalModel == LGM_EXTMODEL_TS07 ) Lgm_SetCoeffs_TS07( 20130317, 12.0, &m->TS07_Info );
+
+}
+
+/*
+ *  TS07 needs its coefficient files (and Lgm_SetCoeffs_TS07() exits if it
+ *  cant find them), so only run it if TS07_DATA_PATH points at them.
+ */
+static int HaveTS07Data( void ) {
+    const char *Path = getenv( "TS07_DATA_PATH" );
+    return( (Path != NULL) && (access( Path, F_OK ) == 0) );
+}
+
+/*
+ *  Fixed point cloud (a simple LCG so that it is the same everywhere).
+ */
+static void MakeCloud( int n ) {
+
+    unsigned int    r = 1;
+    double          R, Theta, Phi;
+    int             i;
+
+    Cloud  = (Lgm_Vector *)calloc( n, sizeof(Lgm_Vector) );
+    nCloud = n;
+    for ( i=0; i<n; i++ ) {
+        r = r*1103515245 + 12345; R     = 2.0 + 8.0*(double)(r%100000)/1e5;
+        r = r*1103515245 + 12345; Theta = 0.3 + 2.5*(double)(r%100000)/1e5;
+        r = r*1103515245 + 12345; Phi   = 2.0*M_PI*(double)(r%100000)/1e5;
+        Cloud[i].x = R*sin(Theta)*cos(Phi);
+        Cloud[i].y = R*sin(Theta)*sin(Phi);
+        Cloud[i].z = R*cos(Theta);
+    }
+
+}
+
+
+
+
+static void Bench_Bfield( char *Name, int InternalModel, int ExternalModel ) {
+
+    Lgm_MagModelInfo    *m;
+    BenchResult         *r;
+    Lgm_Vector          B;
+    double              t0, Sum;
+    int                 i, k;
+    char                Str[64];
+
+    sprintf( Str, "B_%s", Name );
+    if ( !Selected( Str ) ) return;
+
+    m = Lgm_InitMagInfo();
+    SetUpModel( InternalModel, ExternalModel, m );
+    r = AddResult( Str, "evals/s", nCloud );
+
+    Sum = 0.0;
+    for ( k=0; k<Args.nReps; k++ ) {
+        t0 = WallTime();
+        for ( i=0; i<nCloud; i++ ) {
+            m->Bfield( &Cloud[i], &B, m );
+            Sum += B.x;
+        }
+        r->Rate[r->nReps++] = nCloud/(WallTime()-t0);
+    }
+    if ( Sum == 0.0 ) printf(" ");   // keep the loop from being optimized away
+
+    FinishResult( r );
+    Lgm_FreeMagInfo( m );
+
+}
+
+
+static void Bench_Trace( char *Name, int InternalModel, int ExternalModel ) {
+
+    Lgm_MagModelInfo    *m;
+    BenchResult         *r, *rB;
+    Lgm_Vector          u, v;
+    double              t0, dt, Phi;
+    int                 i, k, n;
+    char                Str[64], StrB[64];
+
+    sprintf( Str,  "Trace_%s", Name );
+    sprintf( StrB, "Trace_%s_Bevals", Name );
+    if ( !Selected( Str ) ) return;
+
+    n = Args.Quick ? 20 : 100;
+    m = Lgm_InitMagInfo();
+    SetUpModel( InternalModel, ExternalModel, m );
+    BenchBsrc = m->Bfield;
+    m->Bfield = BenchCountB;
+
+    r  = AddResult( Str,  "traces/s", n );
+    rB = AddResult( StrB, "evals/s",  0 );
+
+    for ( k=0; k<Args.nReps; k++ ) {
+        BenchnB = 0;
+        t0 = WallTime();
+        for ( i=0; i<n; i++ ) {
+            Phi = 2.0*M_PI*(double)i/(double)n;
+            u.x = 6.6*cos(Phi); u.y = 6.6*sin(Phi); u.z = 0.0;
+            Lgm_TraceToEarth( &u, &v, 120.0, 1.0, 1e-7, m );
+            Lgm_TraceToEarth( &u, &v, 120.0, -1.0, 1e-7, m );
+        }
+        dt = WallTime()-t0;
+        r->Rate[r->nReps++]   = 2.0*n/dt;
+        rB->Rate[rB->nReps++] = BenchnB/dt;
+        rB->nOps = BenchnB;
+    }
+
+    FinishResult( r );
+    FinishResult( rB );
+    Lgm_FreeMagInfo( m );
+
+}
+
+
+static void Bench_Lstar( char *Name, int InternalModel, int ExternalModel, int Quality ) {
+
+    Lgm_LstarInfo       *l;
+    BenchResult         *r;
+    Lgm_Vector          Psm, P;
+    double              t0;
+    int                 i, k, n;
+    char                Str[64];
+
+    sprintf( Str, "Lstar_%s_Q%d", Name, Quality );
+    if ( !Selected( Str ) ) return;
+
+    n = ( Args.Quick || (Quality > 2) ) ? 2 : 4;
+    l = InitLstarInfo( 0 );
+    SetUpModel( InternalModel, ExternalModel, l->mInfo );
+    l->PitchAngle = 90.0;
+    Lgm_SetLstarTolerances( Quality, 24, l );
+
+    r = AddResult( Str, "Lstar/s", n );
+    for ( k=0; k<Args.nReps; k++ ) {
+        t0 = WallTime();
+        for ( i=0; i<n; i++ ) {
+            Psm.x = -(4.5 + 0.5*i); Psm.y = 1.0; Psm.z = 0.0;
+            Lgm_Convert_Coords( &Psm, &P, SM_TO_GSM, l->mInfo->c );
+            Lstar( &P, l );
+        }
+        r->Rate[r->nReps++] = n/(WallTime()-t0);
+    }
+
+    FinishResult( r );
+    FreeLstarInfo( l );
+
+}
+
+
+/*
+ *  Lgm_F2P_AlphaOfK() inverts all of the K's on a field line at once with
+ *  Lgm_AlphaOfK_Batch(). The _PerK result does what it replaced (an OpenMP
+ *  loop calling Lgm_AlphaOfK() for each K with a private copy of mInfo) so
+ *  the two can be compared on machines with any number of cores.
+ */
+static void Bench_F2P_AlphaOfK( char *Name, int InternalModel, int ExternalModel ) {
+
+    Lgm_MagModelInfo    *m, *m2;
+    BenchResult         *r, *rK;
+    Lgm_DateTime        d;
+    Lgm_Vector          u;
+    double              t0, Phi, B, K[8], AofK[8];
+    int                 i, j, k, n;
+    char                Str[64], StrK[64];
+
+    sprintf( Str,  "F2P_AlphaOfK_%s", Name );
+    sprintf( StrK, "F2P_AlphaOfK_%s_PerK", Name );
+    if ( !Selected( Str ) ) return;
+
+    n = Args.Quick ? 4 : 20;
+    m = Lgm_InitMagInfo();
+    SetUpModel( InternalModel, ExternalModel, m );
+    Lgm_Make_UTC( 20130317, 12.0, &d, m->c );
+    for ( j=0; j<8; j++ ) K[j] = 0.01*pow( 2.0, j );
+
+    r  = AddResult( Str,  "calls/s", n );
+    rK = AddResult( StrK, "calls/s", n );
+
+    for ( k=0; k<Args.nReps; k++ ) {
+        t0 = WallTime();
+        for ( i=0; i<n; i++ ) {
+            Phi = 2.0*M_PI*(double)i/(double)n;
+            u.x = 6.0*cos(Phi); u.y = 6.0*sin(Phi); u.z = 0.5;
+            Lgm_F2P_AlphaOfK( &d, &u, 8, K, AofK, &B, m );
+        }
+        r->Rate[r->nReps++] = n/(WallTime()-t0);
+    }
+
+    for ( k=0; k<Args.nReps; k++ ) {
+        t0 = WallTime();
+        for ( i=0; i<n; i++ ) {
+            Phi = 2.0*M_PI*(double)i/(double)n;
+            u.x = 6.0*cos(Phi); u.y = 6.0*sin(Phi); u.z = 0.5;
+            if ( Lgm_Setup_AlphaOfK( &d, &u, m ) > 0 ) {
+#ifdef _OPENMP
+                #pragma omp parallel for private(m2) schedule(dynamic, 1)
+#endif
+                for ( j=0; j<8; j++ ) {
+                    m2      = Lgm_CopyMagInfo( m );
+                    AofK[j] = Lgm_AlphaOfK( K[j], m2 );
+                    Lgm_FreeMagInfo( m2 );
+                }
+                Lgm_TearDown_AlphaOfK( m );
+            }
+        }
+        rK->Rate[rK->nReps++] = n/(WallTime()-t0);
+    }
+
+    FinishResult( r );
+    FinishResult( rK );
+    Lgm_FreeMagInfo( m );
+
+}
+
+
+static void Bench_CTrans( void ) {
+
+    Lgm_CTrans      *c;
+    BenchResult     *r;
+    Lgm_Vector      v;
+    double          t0, Sum;
+    int             i, k, n;
+
+    c = Lgm_init_ctrans( 0 );
+
+    if ( Selected( "CTrans_SetTransforms" ) ) {
+        n = Args.Quick ? 2000 : 20000;
+        r = AddResult( "CTrans_SetTransforms", "calls/s", n );
+        for ( k=0; k<Args.nReps; k++ ) {
+            t0 = WallTime();
+            for ( i=0; i<n; i++ ) Lgm_Set_Coord_Transforms( 20130317, 24.0*(double)i/(double)n, c );
+            r->Rate[r->nReps++] = n/(WallTime()-t0);
+        }
+        FinishResult( r );
+    }
+
+    Lgm_Set_Coord_Transforms( 20130317, 12.0, c );
+    if ( Selected( "CTrans_GSM_TO_GEO" ) ) {
+        r = AddResult( "CTrans_GSM_TO_GEO", "calls/s", nCloud );
+        Sum = 0.0;
+        for ( k=0; k<Args.nReps; k++ ) {
+            t0 = WallTime();
+            for ( i=0; i<nCloud; i++ ) { Lgm_Convert_Coords( &Cloud[i], &v, GSM_TO_GEO, c ); Sum += v.x; }
+            r->Rate[r->nReps++] = nCloud/(WallTime()-t0);
+        }
+        if ( Sum == 0.0 ) printf(" ");
+        FinishResult( r );
+    }
+
+    if ( Selected( "CTrans_GSM_TO_GEI2000" ) ) {
+        r = AddResult( "CTrans_GSM_TO_GEI2000", "calls/s", nCloud );
+        Sum = 0.0;
+        for ( k=0; k<Args.nReps; k++ ) {
+            t0 = WallTime();
+            for ( i=0; i<nCloud; i++ ) { Lgm_Convert_Coords( &Cloud[i], &v, GSM_TO_GEI2000, c ); Sum += v.x; }
+            r->Rate[r->nReps++] = nCloud/(WallTime()-t0);
+        }
+        if ( Sum == 0.0 ) printf(" ");
+        FinishResult( r );
+    }
+
+    Lgm_free_ctrans( c );
+
+}
+
+
+
+
+static void WriteResults( FILE *fp ) {
+
+    char        Date[80];
+    time_t      t;
+    int         i;
+
+    t = time( NULL );
+    strftime( Date, 80, "%Y-%m-%dT%H:%M:%SZ", gmtime( &t ) );
+
+    if ( Args.Csv ) {
+        fprintf( fp, "name,unit,n,reps,median,min,max\n" );
+        for ( i=0; i<nResults; i++ ) {
+            fprintf( fp, "%s,%s,%ld,%d,%.6g,%.6g,%.6g\n", Results[i].Name, Results[i].Unit, Results[i].nOps,
+                            Results[i].nReps, Results[i].Median, Results[i].Min, Results[i].Max );
+        }
+    } else {
+        fprintf( fp, "{\n" );
+        fprintf( fp, "  \"date\": \"%s\",\n", Date );
+        fprintf( fp, "  \"quick\": %s,\n", Args.Quick ? "true" : "false" );
+        fprintf( fp, "  \"reps\": %d,\n", Args.nReps );
+        fprintf( fp, "  \"results\": [\n" );
+        for ( i=0; i<nResults; i++ ) {
+            fprintf( fp, "    {\"name\": \"%s\", \"unit\": \"%s\", \"n\": %ld, \"reps\": %d, \"median\": %.6g, \"min\": %.6g, \"max\": %.6g}%s\n",
+                            Results[i].Name, Results[i].Unit, Results[i].nOps, Results[i].nReps,
+                            Results[i].Median, Results[i].Min, Results[i].Max, (i < nResults-1) ? "," : "" );
+        }
+        fprintf( fp, "  ]\n}\n" );
+    }
+
+}
+
+
+/*
+ *  Read the name and median rate of each result in a file written by
+ *  WriteResults() (either format; one result per line in both).
+ */
+static int ReadBaseline( char *Filename, char Names[][64], double *Median, int nMax ) {
+
+    FILE    *fp;
+    char    Line[1024], *p, *q;
+    int     n = 0, i;
+
+    if ( (fp = fopen( Filename, "r" )) == NULL ) {
+        fprintf( stderr, "bench_LanlGeoMag: could not open baseline file %s\n", Filename );
+        return( -1 );
+    }
+
+    while ( (n < nMax) && (fgets( Line, 1024, fp ) != NULL) ) {
+
+        if ( (p = strstr( Line, "\"name\": \"" )) != NULL ) {
+            // JSON
+            p += 9;
+            if ( (q = strchr( p, '"' )) == NULL ) continue;
+            *q = '\0';
+            strncpy( Names[n], p, 63 ); Names[n][63] = '\0';
+            if ( (p = strstr( q+1, "\"median\": " )) == NULL ) continue;
+            Median[n++] = atof( p+10 );
+        } else if ( (strchr( Line, ',' ) != NULL) && strncmp( Line, "name,", 5 ) ) {
+            // CSV; name,unit,n,reps,median,...
+            p = Line;
+            q = strchr( p, ',' ); *q = '\0';
+            strncpy( Names[n], p, 63 ); Names[n][63] = '\0';
+            for ( i=0; (i<3) && (p != NULL); i++ ) {
+                p = strchr( q+1, ',' );
+                if ( p ) q = p;
+            }
+            if ( p == NULL ) continue;
+            Median[n++] = atof( p+1 );
+        }
+
+    }
+    fclose( fp );
+
+    return( n );
+
+}
+
+static int CompareToBaseline( char *Filename ) {
+
+    char    Names[BENCH_MAX_RESULTS][64];
+    double  Median[BENCH_MAX_RESULTS], Ratio;
+    int     n, i, j, nRegress = 0;
+
+    if ( (n = ReadBaseline( Filename, Names, Median, BENCH_MAX_RESULTS )) < 0 ) return( -1 );
+
+    printf( "\n%-24s %14s %14s %9s\n", "Benchmark", "Baseline", "Current", "Change" );
+    for ( i=0; i<nResults; i++ ) {
+        for ( j=0; j<n; j++ ) if ( !strcmp( Names[j], Results[i].Name ) ) break;
+        if ( (j == n) || (Median[j] <= 0.0) ) {
+            printf( "%-24s %14s %14.6g %9s\n", Results[i].Name, "-", Results[i].Median, "new" );
+            continue;
+        }
+        Ratio = Results[i].Median/Median[j];
+        printf( "%-24s %14.6g %14.6g %+8.1f%%", Results[i].Name, Median[j], Results[i].Median, 100.0*(Ratio-1.0) );
+        if ( Ratio < 1.0 - 0.01*Args.Tolerance ) {
+            printf( "  <-- REGRESSION" );
+            ++nRegress;
+        }
+        printf( "\n" );
+    }
+    printf( "\n%d regression(s) beyond %g%%\n", nRegress, Args.Tolerance );
+
+    return( nRegress );
+
+}
+
+
+
+
+int main( int argc, char *argv[] ) {
+
+    FILE    *fp;
+    int     q, nRegress = 0;
+
+    Args.Output[0]   = '\0';
+    Args.Baseline[0] = '\0';
+    Args.Select[0]   = '\0';
+    Args.Csv         = FALSE;
+    Args.Tolerance   = 10.0;
+    Args.nReps       = 5;
+    Args.Quick       = FALSE;
+    Args.Verbose     = FALSE;
+    argp_parse( &argp, argc, argv, 0, 0, &Args );
+
+    MakeCloud( Args.Quick ? BENCH_NPOINTS/10 : BENCH_NPOINTS );
+
+
+    /*
+     *  Field models
+     */
+    Bench_Bfield( "CDIP",      LGM_CDIP, LGM_EXTMODEL_NULL );
+    Bench_Bfield( "IGRF",      LGM_IGRF, LGM_EXTMODEL_NULL );
+    Bench_Bfield( "T89",       LGM_IGRF, LGM_EXTMODEL_T89 );
+    Bench_Bfield( "OP77",      LGM_IGRF, LGM_EXTMODEL_OP77 );
+    Bench_Bfield( "T96",       LGM_IGRF, LGM_EXTMODEL_T96 );
+    Bench_Bfield( "T01S",      LGM_IGRF, LGM_EXTMODEL_T01S );
+    Bench_Bfield( "T02",       LGM_IGRF, LGM_EXTMODEL_T02 );
+    Bench_Bfield( "TS04",      LGM_IGRF, LGM_EXTMODEL_TS04 );
+    if ( HaveTS07Data() ) {
+        Bench_Bfield( "TS07",  LGM_IGRF, LGM_EXTMODEL_TS07 );
+    } else if ( Args.Verbose ) {
+        fprintf( stderr, "TS07_DATA_PATH not set; skipping TS07\n" );
+    }
+
+
+    /*
+     *  Field line tracing
+     */
+    Bench_Trace( "IGRF",       LGM_IGRF, LGM_EXTMODEL_NULL );
+    Bench_Trace( "T89",        LGM_IGRF, LGM_EXTMODEL_T89 );
+    Bench_Trace( "TS04",       LGM_IGRF, LGM_EXTMODEL_TS04 );
+
+
+    /*
+     *  L*
+     */
+    for ( q=0; q<=(Args.Quick ? 2 : 4); q++ ) Bench_Lstar( "T89", LGM_IGRF, LGM_EXTMODEL_T89, q );
+
+
+    /*
+     *  Flux -> PSD
+     */
+    Bench_F2P_AlphaOfK( "T89", LGM_IGRF, LGM_EXTMODEL_T89 );
+
+
+    /*
+     *  Coordinate transforms
+     */
+    Bench_CTrans();
+
+
+
+    if ( Args.Output[0] != '\0' ) {
+        if ( (fp = fopen( Args.Output, "w" )) == NULL ) {
+            fprintf( stderr, "bench_LanlGeoMag: could not open %s for writing\n", Args.Output );
+            return( -1 );
+        }
+        WriteResults( fp );
+        fclose( fp );
+    } else {
+        WriteResults( stdout );
+    }
+
+    if ( Args.Baseline[0] != '\0' ) nRegress = CompareToBaseline( Args.Baseline );
+
+    free( Cloud );
+
+    return( (nRegress != 0) ? 1 : 0 );
+
+}
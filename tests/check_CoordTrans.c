@@ -484,6 +484,111 @@ START_TEST(test_CoordDipoleTilt) {
     } END_TEST
 
 
+START_TEST(test_CoordSunMoonCheb) {
+    /* Sun/Moon positions from a Chebyshev table vs. the model they were fit to */
+    Lgm_CTrans        *c  = Lgm_init_ctrans( 0 );
+    Lgm_CTrans        *c2 = Lgm_init_ctrans( 0 );
+    Lgm_SunMoonCheb   *s;
+    Lgm_DateTime      Start, End, UTC;
+    Lgm_Vector        S, S2, M, M2, u, Pmod, P, P2;
+    double            t0, t1, t, f, Err, SunErr, MoonErr, PhaseErr, GsmErr, Tol=1e-9;
+    int               i, nTests, nFail;
+
+    Lgm_Set_CTrans_Options( LGM_EPH_HIGH_ACCURACY, LGM_PN_IAU76, c );
+    Lgm_Set_CTrans_Options( LGM_EPH_HIGH_ACCURACY, LGM_PN_IAU76, c2 );
+
+    nTests = 0;
+    nFail  = 0;
+
+    printf("\nSun/Moon Chebyshev table tests:\n");
+
+    Lgm_Make_UTC( 20150301, 0.0, &Start, c );
+    Lgm_Make_UTC( 20150304, 0.0, &End, c );
+    s = Lgm_SunMoonCheb_Create( &Start, &End, 1.0, 12, Tol, c );
+    ck_assert_msg( s != NULL, "Lgm_SunMoonCheb_Create() failed\n" );
+    printf("Table: nSeg = %d, MaxErr = %g (Tol = %g)\n", s->nSeg, s->MaxErr, Tol);
+
+    // **** Test 1 **** //
+    printf("Test %d. Table attaches to a structure with the same ephModel\n", ++nTests);
+    if ( !Lgm_Set_SunMoonCheb( s, c ) || ( c->SunMoonCheb != s ) ) ++nFail;
+
+    // **** Test 2 **** //
+    /*
+     *  Compare with the model at times that are not check points (golden
+     *  ratio steps through the span). Pmod is a fixed vector in MOD, so
+     *  P (its GSM coords) checks the transforms that depend on the Sun.
+     */
+    printf("Test %d. Table vs. model at 1000 times\n", ++nTests);
+    t0 = Lgm_UTC_to_TTSecSinceJ2000( &Start, c );
+    t1 = Lgm_UTC_to_TTSecSinceJ2000( &End, c );
+    Pmod.x = 3.0; Pmod.y = -4.0; Pmod.z = 1.5;
+    SunErr = MoonErr = PhaseErr = GsmErr = 0.0;
+    for ( i=0; i<1000; i++ ) {
+        f = fmod( 0.5 + i*0.6180339887498949, 1.0 );
+        t = t0 + f*(t1-t0);
+        Lgm_TTSecSinceJ2000_to_UTC( t, &UTC, c );
+        Lgm_Set_Coord_Transforms( UTC.Date, UTC.Time, c );
+        Lgm_Set_Coord_Transforms( UTC.Date, UTC.Time, c2 );
+
+        S  = c->Sun;  Lgm_ScaleVector( &S,  c->earth_sun_dist );
+        S2 = c2->Sun; Lgm_ScaleVector( &S2, c2->earth_sun_dist );
+        Lgm_Radec_to_Cart( c->RA_moon,  c->DEC_moon,  &M );  Lgm_ScaleVector( &M,  c->EarthMoonDistance );
+        Lgm_Radec_to_Cart( c2->RA_moon, c2->DEC_moon, &M2 ); Lgm_ScaleVector( &M2, c2->EarthMoonDistance );
+        Lgm_VecSub( &u, &S, &S2 ); Err = Lgm_Magnitude( &u )/Lgm_Magnitude( &S2 );
+        if ( Err > SunErr ) SunErr = Err;
+        Lgm_VecSub( &u, &M, &M2 ); Err = Lgm_Magnitude( &u )/Lgm_Magnitude( &M2 );
+        if ( Err > MoonErr ) MoonErr = Err;
+        Err = fabs( c->MoonPhase - c2->MoonPhase );
+        if ( Err > PhaseErr ) PhaseErr = Err;
+
+        Lgm_Convert_Coords( &Pmod, &P,  MOD_TO_GSM, c );
+        Lgm_Convert_Coords( &Pmod, &P2, MOD_TO_GSM, c2 );
+        Lgm_VecSub( &u, &P, &P2 ); Err = Lgm_Magnitude( &u )/Lgm_Magnitude( &Pmod );
+        if ( Err > GsmErr ) GsmErr = Err;
+    }
+    printf("Max errors: Sun %g, Moon %g, Moon phase %g, MOD_TO_GSM %g\n", SunErr, MoonErr, PhaseErr, GsmErr);
+    /*
+     *  MaxErr is only sampled, so allow a little more than Tol between the
+     *  check points.
+     */
+    if ( ( SunErr > 2.0*Tol ) || ( MoonErr > 2.0*Tol ) || ( PhaseErr > 2.0*Tol ) || ( GsmErr > 2.0*Tol ) ) ++nFail;
+    if ( ( SunErr == 0.0 ) || ( MoonErr == 0.0 ) ) ++nFail; // table was not used
+
+    // **** Test 3 **** //
+    printf("Test %d. Outside of the span the model is used\n", ++nTests);
+    Lgm_Set_Coord_Transforms( 20150305, 12.0, c );
+    Lgm_Set_Coord_Transforms( 20150305, 12.0, c2 );
+    if ( ( c->Sun.x != c2->Sun.x ) || ( c->Sun.y != c2->Sun.y ) || ( c->Sun.z != c2->Sun.z )
+            || ( c->RA_moon != c2->RA_moon ) || ( c->DEC_moon != c2->DEC_moon ) ) ++nFail;
+
+    // **** Test 4 **** //
+    printf("Test %d. Table is ignored once c->ephModel is changed\n", ++nTests);
+    Lgm_Set_CTrans_Options( LGM_EPH_LOW_ACCURACY, LGM_PN_IAU76, c );
+    Lgm_Set_CTrans_Options( LGM_EPH_LOW_ACCURACY, LGM_PN_IAU76, c2 );
+    Lgm_Set_Coord_Transforms( 20150302, 7.0, c );
+    Lgm_Set_Coord_Transforms( 20150302, 7.0, c2 );
+    if ( ( c->Sun.x != c2->Sun.x ) || ( c->Sun.y != c2->Sun.y ) || ( c->Sun.z != c2->Sun.z )
+            || ( c->RA_moon != c2->RA_moon ) || ( c->DEC_moon != c2->DEC_moon ) ) ++nFail;
+
+    // **** Test 5 **** //
+    printf("Test %d. Table does not attach to a structure with another ephModel\n", ++nTests);
+    if ( Lgm_Set_SunMoonCheb( s, c2 ) || ( c2->SunMoonCheb != NULL ) ) ++nFail;
+
+
+    // **** Tests complete *** //
+    printf("Result: %d tests pass; %d tests fail \n", nTests-nFail, nFail);
+    fflush(stdout);
+    Lgm_Set_SunMoonCheb( NULL, c );
+    Lgm_SunMoonCheb_Free( s );
+    Lgm_free_ctrans( c );
+    Lgm_free_ctrans( c2 );
+
+    ck_assert_msg( nFail == 0, "SunMoonCheb test failed\n" );
+
+    return;
+    } END_TEST
+
+
 int testDiff(Lgm_Vector Utest, Lgm_Vector Utarg, double tol) {
     Lgm_Vector  Udiff;
     double      del;
@@ -555,6 +660,7 @@ Suite *CT_suite(void) {
   tcase_add_test(tc_CoordTrans, test_CoordGSE_equiv);
   tcase_add_test(tc_CoordTrans, test_CoordGSE_fail);
   tcase_add_test(tc_CoordTrans, test_CoordDipoleTilt);
+  tcase_add_test(tc_CoordTrans, test_CoordSunMoonCheb);
 
   suite_add_tcase(s, tc_CoordTrans);
 
@@ -1,10 +1,15 @@
 #include <check.h>
+#include <stddef.h>
+#include <unistd.h>
 #include "../libLanlGeoMag/Lgm/Lgm_CTrans.h"
 #include "../libLanlGeoMag/Lgm/Lgm_Vec.h"
+#include "../libLanlGeoMag/Lgm/Lgm_DynamicMemory.h"
 
 #define TRUE    1
 #define FALSE   0
 
+#define MAPFILE "check_DE421_map.map"
+
 
 int target( int targ );
 
@@ -136,6 +141,189 @@ START_TEST(test_DE421) {
     return;
     } END_TEST
 
+/*
+ *  Make up a DE421-like Sun and Earth-Moon ephemeris (so that no data files
+ *  are needed).
+ */
+static void FakeJPLephem( Lgm_JPLephemInfo *jpl ) {
+
+    int     i, j, k;
+
+    jpl->jalpha = 2451536.5;
+    jpl->jdelta = 32.0;
+    jpl->jomega = jpl->jalpha + 20*jpl->jdelta;
+
+    jpl->sun_nvals = 20; jpl->sun_naxes = 3; jpl->sun_ncoeffs = 11;
+    LGM_ARRAY_3D( jpl->sun, 20, 3, 11, double );
+    jpl->earthmoon_nvals = 20; jpl->earthmoon_naxes = 3; jpl->earthmoon_ncoeffs = 13;
+    LGM_ARRAY_3D( jpl->earthmoon, 20, 3, 13, double );
+    jpl->moon_wrt_earth_nvals = 20; jpl->moon_wrt_earth_naxes = 3; jpl->moon_wrt_earth_ncoeffs = 13;
+    LGM_ARRAY_3D( jpl->moon_wrt_earth, 20, 3, 13, double );
+    for ( i=0; i<20; i++ ) {
+        for ( j=0; j<3; j++ ) {
+            for ( k=0; k<11; k++ ) jpl->sun[i][j][k] = 1e6*sin( 1.0 + i + 3.7*j + 0.3*k )/( 1.0 + k*k );
+            for ( k=0; k<13; k++ ) jpl->earthmoon[i][j][k] = 1.5e8*cos( 2.0 + 0.1*i + j + 0.7*k )/( 1.0 + k*k*k );
+            for ( k=0; k<13; k++ ) jpl->moon_wrt_earth[i][j][k] = 4e5*sin( 0.5*i - j + 1.3*k )/( 1.0 + k*k*k );
+        }
+    }
+    jpl->SunAlloced       = TRUE;
+    jpl->EarthMoonAlloced = TRUE;
+
+}
+
+/*
+ *  Overwrite n bytes of a file at the given offset.
+ */
+static void PatchFile( char *Filename, long int Offset, void *Data, int n ) {
+
+    FILE    *fp = fopen( Filename, "r+b" );
+
+    fseek( fp, Offset, SEEK_SET );
+    fwrite( Data, 1, n, fp );
+    fclose( fp );
+
+}
+
+void DE421_Map_Setup(void) {
+    remove( MAPFILE );
+    return;
+}
+
+void DE421_Map_TearDown(void) {
+    remove( MAPFILE );
+    return;
+}
+
+
+START_TEST(test_DE421_Map) {
+
+    Lgm_JPLephemInfo        *jpl, *m;
+    Lgm_JPLephemMapHeader   h;
+    Lgm_Vector              U1, U2;
+    int                     i, n, Body[4] = { LGM_DE_SUN, LGM_DE_EARTHMOON, LGM_DE_EARTH, LGM_DE_MOON }, nFail = 0;
+    int32_t                 i32;
+    int64_t                 i64;
+    double                  JD;
+    FILE                    *fp;
+
+    /*
+     *  Write a map file, map it and check that the mapped ephemeris is the
+     *  one that was written (and gives the same positions and velocities).
+     */
+    jpl = Lgm_InitJPLephemInfo( 421, LGM_DE_SUN|LGM_DE_EARTHMOON, 0 );
+    FakeJPLephem( jpl );
+    if ( Lgm_WriteJPLephemMap( MAPFILE, jpl ) != 0 ) {
+        printf("Test DE421_Map: Lgm_WriteJPLephemMap() failed\n");
+        ck_abort_msg( "Lgm_WriteJPLephemMap() failed\n" );
+    }
+
+    m = Lgm_InitJPLephemInfo( 421, LGM_DE_SUN|LGM_DE_EARTHMOON, 0 );
+    if ( ( Lgm_MapJPLephem( MAPFILE, m ) != 0 ) || !m->Mapped ) {
+        printf("Test DE421_Map: Lgm_MapJPLephem() failed\n");
+        ck_abort_msg( "Lgm_MapJPLephem() failed\n" );
+    }
+    if (    ( m->jalpha != jpl->jalpha ) || ( m->jomega != jpl->jomega ) || ( m->jdelta != jpl->jdelta )
+         || ( m->sun_nvals != 20 ) || ( m->sun_naxes != 3 ) || ( m->sun_ncoeffs != 11 )
+         || ( m->earthmoon_nvals != 20 ) || ( m->earthmoon_naxes != 3 ) || ( m->earthmoon_ncoeffs != 13 )
+         || ( m->moon_wrt_earth_nvals != 20 ) || ( m->moon_wrt_earth_naxes != 3 ) || ( m->moon_wrt_earth_ncoeffs != 13 )
+         || memcmp( &m->sun[0][0][0], &jpl->sun[0][0][0], 20*3*11*sizeof(double) )
+         || memcmp( &m->earthmoon[0][0][0], &jpl->earthmoon[0][0][0], 20*3*13*sizeof(double) )
+         || memcmp( &m->moon_wrt_earth[0][0][0], &jpl->moon_wrt_earth[0][0][0], 20*3*13*sizeof(double) ) ) {
+        printf("Test DE421_Map: Mapped ephemeris differs from the one written\n");
+        ++nFail;
+    }
+    for ( n=0; n<50; n++ ) {
+        JD = jpl->jalpha + ( jpl->jomega - jpl->jalpha )*fmod( 0.01 + n*0.6180339887498949, 0.98 );
+        for ( i=0; i<4; i++ ) {
+            Lgm_JPLephem_position( JD, Body[i], jpl, &U1 );
+            Lgm_JPLephem_position( JD, Body[i], m,   &U2 );
+            if ( ( U1.x != U2.x ) || ( U1.y != U2.y ) || ( U1.z != U2.z ) ) ++nFail;
+            Lgm_JPLephem_velocity( JD, Body[i], jpl, &U1 );
+            Lgm_JPLephem_velocity( JD, Body[i], m,   &U2 );
+            if ( ( U1.x != U2.x ) || ( U1.y != U2.y ) || ( U1.z != U2.z ) ) ++nFail;
+        }
+    }
+    if ( nFail ) printf("Test DE421_Map: %d mapped positions/velocities differ\n", nFail );
+    Lgm_FreeJPLephemInfo( m );
+
+    /*
+     *  The header has the same layout everywhere.
+     */
+    if (    ( sizeof(h) != 472 ) || ( offsetof( Lgm_JPLephemMapHeader, HeaderSize ) != 16 )
+         || ( offsetof( Lgm_JPLephemMapHeader, jalpha ) != 32 ) || ( offsetof( Lgm_JPLephemMapHeader, nvals ) != 56 )
+         || ( offsetof( Lgm_JPLephemMapHeader, Offset ) != 368 ) ) {
+        printf("Test DE421_Map: Lgm_JPLephemMapHeader layout is machine dependent\n");
+        ++nFail;
+    }
+
+    /*
+     *  Files that do not match must be refused (leaving m unmapped): another
+     *  DE, bodies that are not in the file, a file from a machine with a
+     *  different header size or byte order, an old version, and truncated or
+     *  bad dataset sizes.
+     */
+    m = Lgm_InitJPLephemInfo( 430, LGM_DE_SUN|LGM_DE_EARTHMOON, 0 );
+    if ( ( Lgm_MapJPLephem( MAPFILE, m ) != -4 ) || m->Mapped ) { printf("Test DE421_Map: Map of another DE was not refused\n"); ++nFail; }
+    Lgm_FreeJPLephemInfo( m );
+
+    m = Lgm_InitJPLephemInfo( 421, LGM_DE_SUN|LGM_DE_EARTHMOON|LGM_DE_INNERPLANETS, 0 );
+    if ( ( Lgm_MapJPLephem( MAPFILE, m ) != -5 ) || m->Mapped ) { printf("Test DE421_Map: Map without the requested bodies was not refused\n"); ++nFail; }
+    Lgm_FreeJPLephemInfo( m );
+
+    i32 = sizeof(h) - 16;
+    PatchFile( MAPFILE, offsetof( Lgm_JPLephemMapHeader, HeaderSize ), &i32, sizeof(i32) );
+    m = Lgm_InitJPLephemInfo( 421, LGM_DE_SUN|LGM_DE_EARTHMOON, 0 );
+    if ( ( Lgm_MapJPLephem( MAPFILE, m ) != -4 ) || m->Mapped ) { printf("Test DE421_Map: Map with another header size was not refused\n"); ++nFail; }
+    Lgm_FreeJPLephemInfo( m );
+    i32 = sizeof(h);
+    PatchFile( MAPFILE, offsetof( Lgm_JPLephemMapHeader, HeaderSize ), &i32, sizeof(i32) );
+
+    i32 = 0x04030201;
+    PatchFile( MAPFILE, offsetof( Lgm_JPLephemMapHeader, ByteOrder ), &i32, sizeof(i32) );
+    m = Lgm_InitJPLephemInfo( 421, LGM_DE_SUN|LGM_DE_EARTHMOON, 0 );
+    if ( ( Lgm_MapJPLephem( MAPFILE, m ) != -4 ) || m->Mapped ) { printf("Test DE421_Map: Map with another byte order was not refused\n"); ++nFail; }
+    Lgm_FreeJPLephemInfo( m );
+    i32 = LGM_DE_MAP_BYTEORDER;
+    PatchFile( MAPFILE, offsetof( Lgm_JPLephemMapHeader, ByteOrder ), &i32, sizeof(i32) );
+
+    i32 = 1;
+    PatchFile( MAPFILE, offsetof( Lgm_JPLephemMapHeader, Version ), &i32, sizeof(i32) );
+    m = Lgm_InitJPLephemInfo( 421, LGM_DE_SUN|LGM_DE_EARTHMOON, 0 );
+    if ( ( Lgm_MapJPLephem( MAPFILE, m ) != -4 ) || m->Mapped ) { printf("Test DE421_Map: Map of a version 1 file was not refused\n"); ++nFail; }
+    Lgm_FreeJPLephemInfo( m );
+    i32 = LGM_DE_MAP_VERSION;
+    PatchFile( MAPFILE, offsetof( Lgm_JPLephemMapHeader, Version ), &i32, sizeof(i32) );
+
+    i64 = (int64_t)1 << 40;
+    PatchFile( MAPFILE, offsetof( Lgm_JPLephemMapHeader, nvals ), &i64, sizeof(i64) );
+    m = Lgm_InitJPLephemInfo( 421, LGM_DE_SUN|LGM_DE_EARTHMOON, 0 );
+    if ( ( Lgm_MapJPLephem( MAPFILE, m ) != -5 ) || m->Mapped ) { printf("Test DE421_Map: Map with a bad dataset size was not refused\n"); ++nFail; }
+    Lgm_FreeJPLephemInfo( m );
+    i64 = 20;
+    PatchFile( MAPFILE, offsetof( Lgm_JPLephemMapHeader, nvals ), &i64, sizeof(i64) );
+
+    m = Lgm_InitJPLephemInfo( 421, LGM_DE_SUN|LGM_DE_EARTHMOON, 0 );
+    if ( Lgm_MapJPLephem( MAPFILE, m ) != 0 ) { printf("Test DE421_Map: Map of the restored file failed\n"); ++nFail; }
+    Lgm_FreeJPLephemInfo( m );
+
+    fp = fopen( MAPFILE, "r+b" );
+    fseek( fp, 0, SEEK_END );
+    n = ftell( fp );
+    fclose( fp );
+    truncate( MAPFILE, n - 8 );
+    m = Lgm_InitJPLephemInfo( 421, LGM_DE_SUN|LGM_DE_EARTHMOON, 0 );
+    if ( ( Lgm_MapJPLephem( MAPFILE, m ) != -5 ) || m->Mapped ) { printf("Test DE421_Map: Map of a truncated file was not refused\n"); ++nFail; }
+    Lgm_FreeJPLephemInfo( m );
+
+    Lgm_FreeJPLephemInfo( jpl );
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "DE421 map test failed.\n" );
+
+    return;
+} END_TEST
+
+
 int target( int targ ) {
     int out;
     switch (targ) {
@@ -192,7 +380,12 @@ Suite *DE421_suite(void) {
 
   tcase_add_test(tc_DE421, test_DE421);
 
+  TCase *tc_DE421_Map = tcase_create("DE421 map files");
+  tcase_add_checked_fixture(tc_DE421_Map, DE421_Map_Setup, DE421_Map_TearDown);
+  tcase_add_test(tc_DE421_Map, test_DE421_Map);
+
   suite_add_tcase(s, tc_DE421);
+  suite_add_tcase(s, tc_DE421_Map);
 
   return s;
 
@@ -0,0 +1,231 @@
+#include <check.h>
+#include <math.h>
+#include "../libLanlGeoMag/Lgm/Lgm_DxxTable.h"
+
+/*
+ *  Tests for the diffusion coefficient tables and their HDF5 cache files
+ */
+
+
+#define FILENAME    "check_DxxTable_01.h5"
+
+
+/*
+ *  A cheap, smooth stand-in for the bounce-averaged coefficients.
+ */
+static int TestDxx( double L, double Ek, double Alpha0, double *Daa, double *Dap, double *Dpp, void *Data ) {
+
+    double  sa = sin( Alpha0*M_PI/180.0 ), ca = cos( Alpha0*M_PI/180.0 ), x = log10( Ek );
+
+    *Daa =  1e-4*( 1.0 + 0.2*L )*exp( -x*x )*( 0.1 + sa*sa );
+    *Dap = -1e-5*L*exp( -0.5*x*x )*sa*ca;
+    *Dpp =  1e-6*( 2.0 + sin( L ) )*exp( -0.25*x*x )*( 1.0 + ca*ca );
+
+    return( 1 );
+
+}
+
+
+void DxxTable_Setup(void) {
+    remove( FILENAME );
+    return;
+}
+
+void DxxTable_TearDown(void) {
+    remove( FILENAME );
+    return;
+}
+
+
+START_TEST(test_DxxTable_01) {
+
+    Lgm_DxxTable    *t, *r, *c;
+    int             i, j, k, n, nFail = 0;
+    double          L, Ek, Alpha0, Daa, Dap, Dpp, Daa2, Dap2, Dpp2, Daa0, Dap0, Dpp0, Err, MaxErr = 0.0;
+
+    /*
+     *  Build a table with a cache file, read the file back and check that
+     *  the grid, Key and coefficients come back exactly, and that both
+     *  tables interpolate identically (and close to the function). Building
+     *  it again must use the cache; building it with another Key must not.
+     */
+    t = Lgm_DxxTable_Build( 33, 3.0, 7.0, 31, -2.0, 1.0, 17, 5.0, 85.0, TestDxx, NULL, "check_DxxTable A", FILENAME, 0 );
+    if ( ( t == NULL ) || t->FromCache || ( t->nFail != 0 ) ) {
+        printf("Test 01: Lgm_DxxTable_Build() failed\n");
+        ck_abort_msg( "Lgm_DxxTable_Build() failed\n" );
+    }
+
+    for ( i=0; i<t->nL; i++ ) for ( j=0; j<t->nE; j++ ) for ( k=0; k<t->nA; k++ ) {
+        TestDxx( t->L0 + i*t->dL, pow( 10.0, t->logEk0 + j*t->dlogEk ), t->Alpha00 + k*t->dAlpha0, &Daa, &Dap, &Dpp, NULL );
+        if ( ( t->Daa[i][j][k] != Daa ) || ( t->Dap[i][j][k] != Dap ) || ( t->Dpp[i][j][k] != Dpp ) ) ++nFail;
+    }
+    if ( nFail ) printf("Test 01: %d grid points do not hold the function values\n", nFail );
+
+    if ( (r = Lgm_DxxTable_Read( FILENAME )) == NULL ) {
+        printf("Test 01: Lgm_DxxTable_Read() failed\n");
+        ck_abort_msg( "Lgm_DxxTable_Read() failed\n" );
+    }
+    if (    ( r->nL != t->nL ) || ( r->L0 != t->L0 ) || ( r->L1 != t->L1 ) || ( r->dL != t->dL )
+         || ( r->nE != t->nE ) || ( r->logEk0 != t->logEk0 ) || ( r->logEk1 != t->logEk1 ) || ( r->dlogEk != t->dlogEk )
+         || ( r->nA != t->nA ) || ( r->Alpha00 != t->Alpha00 ) || ( r->Alpha01 != t->Alpha01 ) || ( r->dAlpha0 != t->dAlpha0 )
+         || ( r->nFail != t->nFail ) || strcmp( r->Key, t->Key ) || !r->FromCache ) {
+        printf("Test 01: Grid/Key read back differ from what was written\n");
+        ++nFail;
+    } else {
+        n = t->nL*t->nE*t->nA*sizeof(double);
+        if (    memcmp( &r->Daa[0][0][0], &t->Daa[0][0][0], n ) || memcmp( &r->Dap[0][0][0], &t->Dap[0][0][0], n )
+             || memcmp( &r->Dpp[0][0][0], &t->Dpp[0][0][0], n ) ) {
+            printf("Test 01: Coefficients read back differ from what was written\n");
+            ++nFail;
+        }
+    }
+
+    for ( n=0; n<500; n++ ) {
+        L      = 3.0 + 4.0*fmod( 0.5 + n*0.6180339887498949, 1.0 );
+        Ek     = pow( 10.0, -2.0 + 3.0*fmod( 0.5 + n*0.7548776662466927, 1.0 ) );
+        Alpha0 = 5.0 + 80.0*fmod( 0.5 + n*0.5698402909980532, 1.0 );
+        Lgm_DxxTable_Eval( t, L, Ek, Alpha0, &Daa,  &Dap,  &Dpp );
+        Lgm_DxxTable_Eval( r, L, Ek, Alpha0, &Daa2, &Dap2, &Dpp2 );
+        if ( ( Daa != Daa2 ) || ( Dap != Dap2 ) || ( Dpp != Dpp2 ) ) {
+            printf("Test 01: L, Ek, Alpha0 = %g %g %g: tables interpolate differently\n", L, Ek, Alpha0 );
+            ++nFail;
+        }
+        TestDxx( L, Ek, Alpha0, &Daa0, &Dap0, &Dpp0, NULL );
+        Err = fabs( Daa - Daa0 )/fabs( Daa0 );   if ( Err > MaxErr ) MaxErr = Err;
+        Err = fabs( Dap - Dap0 )/1e-5/L;         if ( Err > MaxErr ) MaxErr = Err;
+        Err = fabs( Dpp - Dpp0 )/fabs( Dpp0 );   if ( Err > MaxErr ) MaxErr = Err;
+    }
+    /*
+     *  The monotone interpolant uses one-sided slopes at the ends of the
+     *  grid, so the largest errors (about 1%) are next to its edges.
+     */
+    printf("Test 01: Largest interpolation error = %g\n", MaxErr );
+    if ( !( MaxErr < 2e-2 ) ) ++nFail;
+
+    c = Lgm_DxxTable_Build( 33, 3.0, 7.0, 31, -2.0, 1.0, 17, 5.0, 85.0, TestDxx, NULL, "check_DxxTable A", FILENAME, 0 );
+    if ( ( c == NULL ) || !c->FromCache ) {
+        printf("Test 01: Cache file was not used\n");
+        ++nFail;
+    }
+    Lgm_DxxTable_Free( c );
+
+    c = Lgm_DxxTable_Build( 33, 3.0, 7.0, 31, -2.0, 1.0, 17, 5.0, 85.0, TestDxx, NULL, "check_DxxTable B", FILENAME, 0 );
+    if ( ( c == NULL ) || c->FromCache ) {
+        printf("Test 01: Cache file with another Key was used\n");
+        ++nFail;
+    }
+    Lgm_DxxTable_Free( c );
+
+    Lgm_DxxTable_Free( r );
+    Lgm_DxxTable_Free( t );
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "Lgm_DxxTable: Table did not survive the HDF5 round trip\n" );
+
+    return;
+}
+END_TEST
+
+
+START_TEST(test_DxxTable_02) {
+
+    Lgm_DxxTable    *t, *r;
+    int             nFail = 0;
+    hid_t           File, Attr;
+    double          nA;
+
+    /*
+     *  Failures must be reported, not passed on as tables: an unwritable
+     *  file, a missing file, a grid that does not match the datasets and a
+     *  missing dataset.
+     */
+    H5Eset_auto( H5E_DEFAULT, NULL, NULL );
+
+    t = Lgm_DxxTable_Build( 3, 3.0, 5.0, 4, -1.0, 0.5, 5, 10.0, 80.0, TestDxx, NULL, "check_DxxTable C", NULL, 0 );
+
+    if ( Lgm_DxxTable_Write( "no_such_directory/check_DxxTable.h5", t ) != -1 ) {
+        printf("Test 02: Write to an unwritable file did not fail\n");
+        ++nFail;
+    }
+    if ( (r = Lgm_DxxTable_Read( "no_such_directory/check_DxxTable.h5" )) != NULL ) {
+        printf("Test 02: Read of a missing file did not fail\n");
+        Lgm_DxxTable_Free( r );
+        ++nFail;
+    }
+
+    if ( Lgm_DxxTable_Write( FILENAME, t ) != 0 ) {
+        printf("Test 02: Write failed\n");
+        ++nFail;
+    }
+    File = H5Fopen( FILENAME, H5F_ACC_RDWR, H5P_DEFAULT );
+    nA   = t->nA + 1;
+    Attr = H5Aopen( File, "nA", H5P_DEFAULT );
+    H5Awrite( Attr, H5T_NATIVE_DOUBLE, &nA );
+    H5Aclose( Attr );
+    H5Fclose( File );
+    if ( (r = Lgm_DxxTable_Read( FILENAME )) != NULL ) {
+        printf("Test 02: Read of a file whose grid does not match its datasets did not fail\n");
+        Lgm_DxxTable_Free( r );
+        ++nFail;
+    }
+
+    Lgm_DxxTable_Write( FILENAME, t );
+    File = H5Fopen( FILENAME, H5F_ACC_RDWR, H5P_DEFAULT );
+    H5Ldelete( File, "Dpp", H5P_DEFAULT );
+    H5Fclose( File );
+    if ( (r = Lgm_DxxTable_Read( FILENAME )) != NULL ) {
+        printf("Test 02: Read of a file without Dpp did not fail\n");
+        Lgm_DxxTable_Free( r );
+        ++nFail;
+    }
+
+    /*
+     *  A bad cache file is ignored (and the table recomputed).
+     */
+    r = Lgm_DxxTable_Build( 3, 3.0, 5.0, 4, -1.0, 0.5, 5, 10.0, 80.0, TestDxx, NULL, "check_DxxTable C", FILENAME, 0 );
+    if ( ( r == NULL ) || r->FromCache || ( r->Dpp[2][3][4] != t->Dpp[2][3][4] ) ) {
+        printf("Test 02: Build with a bad cache file did not recompute the table\n");
+        ++nFail;
+    }
+    Lgm_DxxTable_Free( r );
+
+    Lgm_DxxTable_Free( t );
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "Lgm_DxxTable: HDF5 errors were not reported\n" );
+
+    return;
+}
+END_TEST
+
+
+Suite *DxxTable_suite(void) {
+
+  Suite *s = suite_create("DXXTABLE_TESTS");
+
+  TCase *tc_DxxTable = tcase_create("Diffusion coefficient tables");
+  tcase_add_checked_fixture(tc_DxxTable, DxxTable_Setup, DxxTable_TearDown);
+
+  tcase_add_test(tc_DxxTable, test_DxxTable_01);
+  tcase_add_test(tc_DxxTable, test_DxxTable_02);
+
+  suite_add_tcase(s, tc_DxxTable);
+
+  return s;
+
+}
+
+int main(void) {
+
+    int      number_failed;
+    Suite   *s  = DxxTable_suite();
+    SRunner *sr = srunner_create(s);
+
+    printf("\n\n");
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
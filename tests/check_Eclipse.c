@@ -0,0 +1,224 @@
+#include <check.h>
+#include "../libLanlGeoMag/Lgm/Lgm_CTrans.h"
+#include "../libLanlGeoMag/Lgm/Lgm_Eclipse.h"
+
+/*
+ *  Tests for the shadow (eclipse) routines
+ */
+
+
+Lgm_CTrans      *c;
+
+void Eclipse_Setup(void) {
+    c = Lgm_init_ctrans( 0 );
+    return;
+}
+
+void Eclipse_TearDown(void) {
+    Lgm_free_ctrans( c );
+    return;
+}
+
+
+/*
+ *  A circular, equatorial (MOD) orbit at geostationary distance.
+ */
+typedef struct GeoOrbit {
+    double  JD0;        // Julian Date at which the S/C is at Lon0
+    double  Lon0;       // MOD longitude at JD0 (radians)
+    double  R;          // Radius (Re)
+    double  Omega;      // Angular speed (rad/s)
+} GeoOrbit;
+
+static void GeoOrbit_Pos( double JD, Lgm_Vector *u, GeoOrbit *g ) {
+    double  Lon = g->Lon0 + g->Omega*( JD - g->JD0 )*86400.0;
+    u->x = g->R*cos( Lon ); u->y = g->R*sin( Lon ); u->z = 0.0;
+}
+
+static int GeoOrbit_Func( Lgm_DateTime *UTC, Lgm_Vector *u, void *Data, Lgm_CTrans *c ) {
+    GeoOrbit_Pos( UTC->JD, u, (GeoOrbit *)Data );
+    return( TRUE );
+}
+
+/*
+ *  Lgm_EarthEclipse() flag for the orbit at t (TT seconds since J2000).
+ */
+static int GeoOrbit_Flag( double t, GeoOrbit *g, Lgm_CTrans *c ) {
+    Lgm_DateTime    UTC;
+    Lgm_Vector      u;
+    Lgm_TTSecSinceJ2000_to_UTC( t, &UTC, c );
+    Lgm_Set_Coord_Transforms( UTC.Date, UTC.Time, c );
+    GeoOrbit_Pos( c->UTC.JD, &u, g );
+    return( Lgm_EarthEclipse( &u, c ) );
+}
+
+
+START_TEST(test_Eclipse_01) {
+
+    int                 k, n, nFail = 0, Before, After;
+    int                 Shadow[4]   = { LGM_PENUMBRAL_ECLIPSE, LGM_UMBRAL_ECLIPSE, LGM_UMBRAL_ECLIPSE, LGM_PENUMBRAL_ECLIPSE };
+    int                 Entry[4]    = { TRUE, TRUE, FALSE, FALSE };
+    int                 FlagPre[4]  = { LGM_NO_ECLIPSE, LGM_PENUMBRAL_ECLIPSE, LGM_UMBRAL_ECLIPSE, LGM_PENUMBRAL_ECLIPSE };
+    int                 FlagPost[4] = { LGM_PENUMBRAL_ECLIPSE, LGM_UMBRAL_ECLIPSE, LGM_PENUMBRAL_ECLIPSE, LGM_NO_ECLIPSE };
+    double              ThetaB, ThetaS, OmegaRel, Tumbra, Tpenumbra, dT;
+    Lgm_DateTime        Start, End;
+    Lgm_EclipseSource   Src;
+    Lgm_EclipseEvent    *Events;
+    GeoOrbit            g;
+
+    /*
+     *  GEO at the September 2016 equinox (the Sun is in the equatorial plane
+     *  and the Moon is near last quarter, so there are no Moon shadows). The
+     *  orbit is phased so that local midnight is at about 12 UT. There should
+     *  be exactly one passage: penumbra entry, umbra entry, umbra exit and
+     *  penumbra exit, in that order. Each event must be where the
+     *  Lgm_EarthEclipse() flag changes, and the lengths of the passages must
+     *  agree with the simple estimate
+     *
+     *      T = 2 ( asin( Re/R ) -/+ ThetaS )/( Omega - Omega_Sun )
+     *
+     *  (which ignores the parallax of the Sun).
+     */
+    Lgm_Make_UTC( 20160922, 0.0, &Start, c );
+    Lgm_Make_UTC( 20160923, 0.0, &End, c );
+    Lgm_Set_Coord_Transforms( Start.Date, Start.Time, c );
+
+    g.R        = 42164.17/Re;
+    g.Omega    = 2.0*M_PI/86164.0905;
+    OmegaRel   = g.Omega - 2.0*M_PI/( 365.2422*86400.0 );
+    g.JD0      = c->UTC.JD;
+    g.Lon0     = atan2( c->Sun.y, c->Sun.x ) + M_PI - OmegaRel*43200.0;
+    Src.Func   = GeoOrbit_Func;
+    Src.Data   = (void *)&g;
+
+    n = Lgm_Eclipse_FindEvents( &Src, &Start, &End, 60.0, 1e-3, LGM_ECLIPSE_EARTH | LGM_ECLIPSE_MOON, &Events, c );
+    if ( n != 4 ) {
+        printf("Test 01: Lgm_Eclipse_FindEvents() found %d events (expected 4)\n", n );
+        ++nFail;
+    }
+
+    for ( k=0; (k<n) && (k<4); k++ ) {
+
+        if ( ( Events[k].Body != LGM_ECLIPSE_EARTH ) || ( Events[k].Shadow != Shadow[k] ) || ( Events[k].Entry != Entry[k] ) ) {
+            printf("Test 01: Event %d: Body = %d Shadow = %d Entry = %d (expected %d %d %d)\n", k, Events[k].Body, Events[k].Shadow, Events[k].Entry, LGM_ECLIPSE_EARTH, Shadow[k], Entry[k] );
+            ++nFail;
+        }
+
+        Before = GeoOrbit_Flag( Events[k].t - 0.01, &g, c );
+        After  = GeoOrbit_Flag( Events[k].t + 0.01, &g, c );
+        if ( ( Before != FlagPre[k] ) || ( After != FlagPost[k] ) ) {
+            printf("Test 01: Event %d at %02d:%02d:%06.3lf: Lgm_EarthEclipse() = %d just before and %d just after (expected %d and %d)\n",
+                    k, Events[k].UTC.Hour, Events[k].UTC.Minute, Events[k].UTC.Second, Before, After, FlagPre[k], FlagPost[k] );
+            ++nFail;
+        }
+
+    }
+
+    if ( n == 4 ) {
+
+        ThetaB    = asin( 1.0/g.R );
+        ThetaS    = asin( SOLAR_RADIUS/( c->earth_sun_dist*Re ) );
+        Tumbra    = 2.0*( ThetaB - ThetaS )/OmegaRel;
+        Tpenumbra = 2.0*( ThetaB + ThetaS )/OmegaRel;
+
+        dT = Events[2].t - Events[1].t;
+        if ( fabs( dT - Tumbra ) > 0.001*Tumbra ) {
+            printf("Test 01: Time in umbra = %g s (expected %g s)\n", dT, Tumbra );
+            ++nFail;
+        }
+        dT = Events[3].t - Events[0].t;
+        if ( fabs( dT - Tpenumbra ) > 0.001*Tpenumbra ) {
+            printf("Test 01: Time in shadow = %g s (expected %g s)\n", dT, Tpenumbra );
+            ++nFail;
+        }
+
+    }
+    free( Events );
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "Lgm_Eclipse_FindEvents: Events differ from the expected GEO eclipse\n" );
+
+    return;
+}
+END_TEST
+
+
+START_TEST(test_Eclipse_02) {
+
+    int             nFail = 0, Flag;
+    double          d, rho;
+    Lgm_Vector      Sun, Moon, p, u;
+
+    /*
+     *  Points placed directly in the shadows of the Earth and the Moon (all
+     *  in MOD). Behind the Moon, the umbra has a radius of about
+     *  LUNAR_RADIUS - d ThetaS and the penumbra LUNAR_RADIUS + d ThetaS, d
+     *  behind its center.
+     */
+    Lgm_Set_Coord_Transforms( 20160922, 12.0, c );
+    Sun = c->Sun;
+    Lgm_Radec_to_Cart( c->RA_moon, c->DEC_moon, &Moon );
+    Lgm_ScaleVector( &Moon, c->EarthMoonDistance );
+    Lgm_CrossProduct( &Sun, &Moon, &p );
+    Lgm_NormalizeVector( &p );
+
+    // Earth: sunward, anti-sunward, and just off the limb on the night side.
+    u = Sun; Lgm_ScaleVector( &u, 6.6 );
+    if ( ( Flag = Lgm_EarthEclipse( &u, c ) ) != LGM_NO_ECLIPSE ) { printf("Test 02: Earth, day side: Flag = %d\n", Flag ); ++nFail; }
+    u = Sun; Lgm_ScaleVector( &u, -6.6 );
+    if ( ( Flag = Lgm_EarthEclipse( &u, c ) ) != LGM_UMBRAL_ECLIPSE ) { printf("Test 02: Earth, night side: Flag = %d\n", Flag ); ++nFail; }
+    u.x = -6.6*Sun.x + 1.01*p.x; u.y = -6.6*Sun.y + 1.01*p.y; u.z = -6.6*Sun.z + 1.01*p.z;
+    if ( ( Flag = Lgm_EarthEclipse( &u, c ) ) != LGM_PENUMBRAL_ECLIPSE ) { printf("Test 02: Earth, limb: Flag = %d\n", Flag ); ++nFail; }
+    if ( ( Flag = Lgm_MoonEclipse( &u, c ) ) != LGM_NO_ECLIPSE ) { printf("Test 02: Moon flag at the Earth's limb: Flag = %d\n", Flag ); ++nFail; }
+
+    // Moon: 5000 km behind it, on the axis, between umbra and penumbra edges, and outside.
+    d = 5000.0;
+    u.x = Moon.x - d/Re*Sun.x; u.y = Moon.y - d/Re*Sun.y; u.z = Moon.z - d/Re*Sun.z;
+    if ( ( Flag = Lgm_MoonEclipse( &u, c ) ) != LGM_UMBRAL_ECLIPSE ) { printf("Test 02: Moon, on axis: Flag = %d\n", Flag ); ++nFail; }
+    if ( ( Flag = Lgm_EarthEclipse( &u, c ) ) != LGM_NO_ECLIPSE ) { printf("Test 02: Earth flag behind the Moon: Flag = %d\n", Flag ); ++nFail; }
+
+    rho = LUNAR_RADIUS + 0.5*d*SOLAR_RADIUS/( c->earth_sun_dist*Re );
+    p.x = u.x + rho/Re*p.x; p.y = u.y + rho/Re*p.y; p.z = u.z + rho/Re*p.z;
+    if ( ( Flag = Lgm_MoonEclipse( &p, c ) ) != LGM_PENUMBRAL_ECLIPSE ) { printf("Test 02: Moon, penumbra: Flag = %d\n", Flag ); ++nFail; }
+
+    u.x = Moon.x + d/Re*Sun.x; u.y = Moon.y + d/Re*Sun.y; u.z = Moon.z + d/Re*Sun.z;
+    if ( ( Flag = Lgm_MoonEclipse( &u, c ) ) != LGM_NO_ECLIPSE ) { printf("Test 02: Moon, sunward: Flag = %d\n", Flag ); ++nFail; }
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "Lgm_EarthEclipse/Lgm_MoonEclipse: Wrong shadow flags\n" );
+
+    return;
+}
+END_TEST
+
+
+Suite *Eclipse_suite(void) {
+
+  Suite *s = suite_create("ECLIPSE_TESTS");
+
+  TCase *tc_Eclipse = tcase_create("Eclipses");
+  tcase_add_checked_fixture(tc_Eclipse, Eclipse_Setup, Eclipse_TearDown);
+
+  tcase_add_test(tc_Eclipse, test_Eclipse_01);
+  tcase_add_test(tc_Eclipse, test_Eclipse_02);
+
+  suite_add_tcase(s, tc_Eclipse);
+
+  return s;
+
+}
+
+int main(void) {
+
+    int      number_failed;
+    Suite   *s  = Eclipse_suite();
+    SRunner *sr = srunner_create(s);
+
+    printf("\n\n");
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
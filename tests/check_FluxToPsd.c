@@ -0,0 +1,261 @@
+#include <check.h>
+#include <math.h>
+#include <sys/time.h>
+#include "../libLanlGeoMag/Lgm/Lgm_FluxToPsd.h"
+#include "../libLanlGeoMag/Lgm/Lgm_MagModelInfo.h"
+
+/*
+ *  Tests for the Flux -> PSD conversion routines
+ */
+
+
+#define NE          12
+#define NA          18
+#define NMU         3
+#define NK          3
+#define NSAMPLES    7
+
+
+/*
+ *  A made up time series of flux measurements: a two-component
+ *  relativistic maxwellian with a pitch angle modulation, at a few positions
+ *  (one of them on an open field line) and times.
+ */
+typedef struct TestSeries {
+    int             n;          // next sample to hand out
+    double          E[NE], A[NA];
+    Lgm_DateTime    d[NSAMPLES];
+    Lgm_Vector      u[NSAMPLES];
+    double          **J[NSAMPLES];
+} TestSeries;
+
+typedef struct TestOutput {
+    int             n;          // number of samples written
+    long int        Index[NSAMPLES];
+    int             TraceFlag[NSAMPLES];
+    double          B[NSAMPLES];
+    double          AofK[NSAMPLES][NK];
+    double          PSD_MK[NSAMPLES][NMU][NK];
+} TestOutput;
+
+static double Mu[NMU] = { 100.0, 400.0, 1600.0 };   // MeV/G
+static double K[NK]   = { 0.01, 0.1, 0.5 };          // Re G^1/2
+
+
+static double WallTime( void ) {
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return( (double)tv.tv_sec + 1e-6*(double)tv.tv_usec );
+}
+
+
+static void MakeSeries( TestSeries *ts, Lgm_CTrans *c ) {
+
+    Lgm_Vector  u;
+    double      f, p2c2, sa, phi, R[NSAMPLES] = { 6.6, 4.5, 5.5, 12.0, 6.6, 3.5, 6.0 };
+    int         n, i, j;
+
+    ts->n = 0;
+    for ( i=0; i<NE; i++ ) ts->E[i] = 0.05*pow( 1.5, i );     // MeV
+    for ( j=0; j<NA; j++ ) ts->A[j] = 5.0 + 5.0*j;            // Degrees
+
+    for ( n=0; n<NSAMPLES; n++ ) {
+
+        Lgm_Make_UTC( 20020101, 1.0 + 3.1*n, &(ts->d[n]), c );
+        Lgm_Set_Coord_Transforms( ts->d[n].Date, ts->d[n].Time, c );
+        phi = 2.0*M_PI*( 0.1 + 0.37*n );
+        u.x = R[n]*cos( phi ); u.y = R[n]*sin( phi ); u.z = 0.3*( n%3 - 1 );
+        Lgm_Convert_Coords( &u, &(ts->u[n]), SM_TO_GSM, c );
+
+        LGM_ARRAY_2D( ts->J[n], NE, NA, double );
+        for ( i=0; i<NE; i++ ) {
+            f    = Lgm_MaxJut( 5e-3*( 1.0 + 0.2*n ), 25.0 + 5.0*n, ts->E[i], LGM_Ee0 ) + Lgm_MaxJut( 1e-4, 200.0 - 10.0*n, ts->E[i], LGM_Ee0 );
+            p2c2 = Lgm_p2c2( ts->E[i], LGM_Ee0 );
+            for ( j=0; j<NA; j++ ) {
+                sa = sin( ts->A[j]*RadPerDeg );
+                ts->J[n][i][j] = pow( sa, 1.0 + 0.5*n )*Lgm_PsdToDiffFlux( f, p2c2 );
+            }
+        }
+
+    }
+
+}
+
+static int Reader( Lgm_F2P_Sample *s, void *Data ) {
+
+    TestSeries  *ts = (TestSeries *)Data;
+    int         i, j;
+
+    if ( ts->n >= NSAMPLES ) return( 0 );
+
+    s->DateTime = ts->d[ts->n];
+    s->Position = ts->u[ts->n];
+    for ( i=0; i<NE; i++ ) for ( j=0; j<NA; j++ ) s->FLUX_EA[i][j] = ts->J[ts->n][i][j];
+    ++(ts->n);
+
+    return( 1 );
+
+}
+
+static int Writer( Lgm_F2P_Sample *s, void *Data ) {
+
+    TestOutput  *o = (TestOutput *)Data;
+    int         m, k;
+
+    if ( o->n >= NSAMPLES ) return( -1 );
+
+    o->Index[o->n]     = s->Index;
+    o->TraceFlag[o->n] = s->TraceFlag;
+    o->B[o->n]         = s->B;
+    for ( k=0; k<NK; k++ ) o->AofK[o->n][k] = s->AofK[k];
+    for ( m=0; m<NMU; m++ ) for ( k=0; k<NK; k++ ) o->PSD_MK[o->n][m][k] = s->PSD_MK[m][k];
+    ++(o->n);
+
+    return( 0 );
+
+}
+
+
+START_TEST(test_FluxToPsd_01) {
+
+    Lgm_MagModelInfo    *mInfo = Lgm_InitMagInfo();
+    Lgm_CTrans          *c = Lgm_init_ctrans( 0 );
+    Lgm_FluxToPsd       *f;
+    Lgm_F2P_Stream      *s;
+    TestSeries          ts;
+    TestOutput          o;
+    long int            nOut;
+    int                 n, m, k, BlockSize, nFail = 0, nDefined = 0;
+    double              t0, BatchTime;
+
+    /*
+     *  The streaming converter must give exactly what the one-time-at-a-time
+     *  Lgm_F2P_* routines give on the same input, with the samples written
+     *  out once each and in order. Run it with a block size of 1, one that
+     *  leaves a partial last block and one bigger than the whole series.
+     */
+    Lgm_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_T89, mInfo );
+    mInfo->Kp = 2;
+    MakeSeries( &ts, c );
+
+    t0 = WallTime();
+    memset( &o, 0, sizeof(o) );
+    for ( n=0; n<NSAMPLES; n++ ) {
+        f = Lgm_F2P_CreateFluxToPsd( FALSE );
+        Lgm_F2P_SetDateTimeAndPos( &(ts.d[n]), &(ts.u[n]), f );
+        Lgm_F2P_SetFlux( ts.J[n], ts.E, NE, ts.A, NA, f );
+        Lgm_F2P_GetPsdAtConstMusAndKs( Mu, NMU, K, NK, mInfo, f );
+        o.B[n] = f->B;
+        for ( k=0; k<NK; k++ ) o.AofK[n][k] = f->AofK[k];
+        for ( m=0; m<NMU; m++ ) for ( k=0; k<NK; k++ ) {
+            o.PSD_MK[n][m][k] = f->PSD_MK[m][k];
+            if ( f->PSD_MK[m][k] > 0.0 ) ++nDefined;
+        }
+        Lgm_F2P_FreeFluxToPsd( f );
+    }
+    BatchTime = WallTime() - t0;
+
+    /*
+     *  Make sure the series actually exercises something: most of the PSDs
+     *  should be defined, but not all of them (the open field line).
+     */
+    if ( ( nDefined < NSAMPLES*NMU*NK/2 ) || ( nDefined == NSAMPLES*NMU*NK ) ) {
+        printf("Test 01: %d of %d batch PSD values defined\n", nDefined, NSAMPLES*NMU*NK );
+        ++nFail;
+    }
+
+    for ( BlockSize=1; BlockSize<=8; BlockSize+=( BlockSize < 3 ) ? 2 : 5 ) {
+
+        TestOutput  os;
+
+        ts.n = 0;
+        memset( &os, 0, sizeof(os) );
+        s = Lgm_F2P_CreateStream( ts.E, NE, ts.A, NA, Mu, NMU, K, NK, BlockSize );
+        nOut = Lgm_F2P_RunStream( s, Reader, &ts, Writer, &os, mInfo );
+
+        if ( ( nOut != NSAMPLES ) || ( os.n != NSAMPLES ) || ( s->nSamples != NSAMPLES ) ) {
+            printf("Test 01: BlockSize = %d: %ld samples converted, %d written (expected %d)\n", BlockSize, nOut, os.n, NSAMPLES );
+            ++nFail;
+        }
+        for ( n=0; n<os.n; n++ ) {
+            if ( os.Index[n] != n ) {
+                printf("Test 01: BlockSize = %d: sample %d was written out as sample %ld\n", BlockSize, n, os.Index[n] );
+                ++nFail;
+            }
+            if ( os.B[n] != o.B[n] ) {
+                printf("Test 01: BlockSize = %d: sample %d: B = %.17g (batch %.17g)\n", BlockSize, n, os.B[n], o.B[n] );
+                ++nFail;
+            }
+            for ( k=0; k<NK; k++ ) {
+                if ( os.AofK[n][k] != o.AofK[n][k] ) {
+                    printf("Test 01: BlockSize = %d: sample %d: AofK[%d] = %.17g (batch %.17g)\n", BlockSize, n, k, os.AofK[n][k], o.AofK[n][k] );
+                    ++nFail;
+                }
+            }
+            for ( m=0; m<NMU; m++ ) for ( k=0; k<NK; k++ ) {
+                if ( os.PSD_MK[n][m][k] != o.PSD_MK[n][m][k] ) {
+                    printf("Test 01: BlockSize = %d: sample %d: PSD_MK[%d][%d] = %.17g (batch %.17g)\n", BlockSize, n, m, k, os.PSD_MK[n][m][k], o.PSD_MK[n][m][k] );
+                    ++nFail;
+                }
+            }
+        }
+
+        printf("Test 01: BlockSize = %d: %ld samples, stream %g s (%d threads), batch %g s\n", BlockSize, s->nSamples, s->ElapsedTime, s->nThreads, BatchTime );
+        Lgm_F2P_FreeStream( s );
+
+    }
+
+    /*
+     *  A writer that returns < 0 stops the stream.
+     */
+    ts.n   = 0;
+    o.n    = NSAMPLES;
+    s      = Lgm_F2P_CreateStream( ts.E, NE, ts.A, NA, Mu, NMU, K, NK, 2 );
+    nOut   = Lgm_F2P_RunStream( s, Reader, &ts, Writer, &o, mInfo );
+    if ( nOut != 0 ) {
+        printf("Test 01: Stream did not stop when the writer asked it to (%ld samples written)\n", nOut );
+        ++nFail;
+    }
+    Lgm_F2P_FreeStream( s );
+
+    for ( n=0; n<NSAMPLES; n++ ) LGM_ARRAY_2D_FREE( ts.J[n] );
+    Lgm_free_ctrans( c );
+    Lgm_FreeMagInfo( mInfo );
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "Lgm_F2P_RunStream: Streamed PSDs differ from the batch ones\n" );
+
+    return;
+}
+END_TEST
+
+
+Suite *FluxToPsd_suite(void) {
+
+  Suite *s = suite_create("FLUXTOPSD_TESTS");
+
+  TCase *tc_FluxToPsd = tcase_create("Flux to PSD conversion");
+  tcase_set_timeout(tc_FluxToPsd, 120);
+
+  tcase_add_test(tc_FluxToPsd, test_FluxToPsd_01);
+
+  suite_add_tcase(s, tc_FluxToPsd);
+
+  return s;
+
+}
+
+int main(void) {
+
+    int      number_failed;
+    Suite   *s  = FluxToPsd_suite();
+    SRunner *sr = srunner_create(s);
+
+    printf("\n\n");
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
@@ -199,6 +199,79 @@ START_TEST(test_Lstar_CDIPalpha2){
 }END_TEST
 
 
+START_TEST(test_Lstar_LCDS){
+    /*
+     *  An LCDS search must not leave a shell guess behind in the caller's
+     *  LstarInfo: a plain Lstar() call afterwards has to give the same result
+     *  as one made with a fresh structure.
+     */
+
+    double           UTC, K, rLCDS, LCDS, LS_Fresh, LstarDiff;
+    long int         Date;
+    int              i, quality=3, nFLs=24, RetVal, nFail=0;
+    Lgm_Vector       Psm, P;
+    Lgm_LstarInfo    *Fresh = InitLstarInfo(0);
+
+    // Date, UTC, position
+    Date       = 20130314;
+    UTC        = 12.0;
+    Psm.x = -5.0; Psm.y = 0.0; Psm.z = 0.0;
+
+    Lgm_Set_Coord_Transforms( Date, UTC, LstarInfo->mInfo->c );
+    Lgm_Convert_Coords( &Psm, &P, SM_TO_GSM, LstarInfo->mInfo->c );
+    Lgm_MagModelInfo_Set_MagModel( LGM_CDIP, LGM_EXTMODEL_T89, LstarInfo->mInfo );
+    LstarInfo->mInfo->Kp = 2;
+    LstarInfo->VerbosityLevel = 0;
+    Lgm_SetLstarTolerances( quality, nFLs, LstarInfo );
+
+    Lgm_Set_Coord_Transforms( Date, UTC, Fresh->mInfo->c );
+    Lgm_MagModelInfo_Set_MagModel( LGM_CDIP, LGM_EXTMODEL_T89, Fresh->mInfo );
+    Fresh->mInfo->Kp = 2;
+    Fresh->VerbosityLevel = 0;
+    Lgm_SetLstarTolerances( quality, nFLs, Fresh );
+    Fresh->PitchAngle = 60.0;
+    Lstar( &P, Fresh );
+    LS_Fresh = Fresh->LS;
+
+    /*
+     *  Start the search from a (poor) guess, as a caller reusing the
+     *  ShellMirror values of a previous search would.
+     */
+    LstarInfo->nShellGuess = Fresh->nShellMirror;
+    for ( i=0; i<Fresh->nShellMirror; i++ ) {
+        LstarInfo->ShellGuessMLT[i]  = Fresh->ShellMirrorMLT[i];
+        LstarInfo->ShellGuessMlat[i] = Fresh->ShellMirrorMlat[i] + 5.0;
+    }
+    RetVal = Lgm_LCDS_KSection( Date, UTC, 3.0, 13.0, 0.1, 0.0, 0.01, quality, nFLs, 4, &K, &rLCDS, LstarInfo );
+    if ( RetVal != 0 ) {
+        printf("Test LCDS: Lgm_LCDS_KSection() returned %d\n", RetVal );
+        ++nFail;
+    }
+    LCDS = LstarInfo->LS;
+    if ( LstarInfo->nShellGuess != 0 ) {
+        printf("Test LCDS: nShellGuess = %d after Lgm_LCDS_KSection() (expected 0)\n", LstarInfo->nShellGuess );
+        ++nFail;
+    }
+
+    Lgm_SetLstarTolerances( quality, nFLs, LstarInfo );
+    LstarInfo->PitchAngle = 60.0;
+    Lstar( &P, LstarInfo );
+    LstarDiff = fabs( LstarInfo->LS - LS_Fresh );
+    printf("LCDS = %g (r = %g, K = %g); Lstar after LCDS = %.10g, with fresh LstarInfo = %.10g\n", LCDS, rLCDS, K, LstarInfo->LS, LS_Fresh );
+    if ( LstarDiff > 1e-10 ) {
+        printf("Test LCDS: Lstar() after Lgm_LCDS_KSection() differs from fresh Lstar() by %g\n", LstarDiff );
+        ++nFail;
+    }
+
+    FreeLstarInfo( Fresh );
+
+    ck_assert_msg( nFail == 0, "Lstar() after an LCDS search differs from Lstar() with a fresh LstarInfo.\n" );
+
+    return;
+
+}END_TEST
+
+
 START_TEST(test_Lstar_McIlwain) {
     /*Compare McIlwain L before and after L* */
     Lgm_Vector        Pos, PosGSM;
@@ -447,6 +520,7 @@ Suite *Lstar_suite(void) {
   tcase_add_test(tc_Lstar, test_Lstar_CDIPapprox);
   tcase_add_test(tc_Lstar, test_Lstar_CDIPalpha);
   tcase_add_test(tc_Lstar, test_Lstar_CDIPalpha2);
+  tcase_add_test(tc_Lstar, test_Lstar_LCDS);
   tcase_add_test(tc_Lstar, test_Lstar_McIlwain);
   tcase_add_test(tc_Lstar, test_Lstar_Regressions);
 
@@ -0,0 +1,293 @@
+#include <check.h>
+#include "../libLanlGeoMag/Lgm/Lgm_CTrans.h"
+#include "../libLanlGeoMag/Lgm/Lgm_MagEphemInfo.h"
+
+/*
+ *  Tests for the MagEphem HDF5 writers
+ */
+
+
+#define FILENAME    "check_MagEphemHdf_01.h5"
+
+Lgm_MagEphemData    *med;
+
+void MagEphemHdf_Setup(void) {
+    med = Lgm_InitMagEphemData( 3, 1 );
+    return;
+}
+
+void MagEphemHdf_TearDown(void) {
+    Lgm_FreeMagEphemData( med );
+    remove( FILENAME );
+    return;
+}
+
+
+START_TEST(test_MagEphemHdf_01) {
+
+    int             i, nRows = 3, nFail = 0;
+    char            **IsoTimes, **Fingerprints;
+    char            *Expected[3] = { "cbf29ce484222325", "0123456789abcdef", "" };
+    hid_t           file, atype, space, DataSet;
+    hsize_t         Dims[4];
+
+    /*
+     *  Write a few rows of IsoTime and InputFingerprint (the last row with an
+     *  empty, i.e. unknown, fingerprint) and read them back the way the -U
+     *  update in MagEphemFromTLE does. Then add the dataset to a file that
+     *  already has rows but no fingerprints; it must read back as nRows empty
+     *  strings once the rows are written, and creating it a second time must
+     *  fail.
+     */
+    H5Eset_auto( H5E_DEFAULT, NULL, NULL );
+    for ( i=0; i<nRows; i++ ) {
+        sprintf( med->H5_IsoTimes[i], "2017-01-01T%02d:00:00.000Z", i );
+        strcpy( med->H5_InputFingerprint[i], Expected[i] );
+    }
+
+    file = H5Fcreate( FILENAME, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT );
+    atype = CreateStrType( 32 );
+    DataSet = CreateExtendableRank1DataSet( file, "IsoTime", atype, &space );
+    H5Sclose( space );
+    H5Dclose( DataSet );
+    if ( Lgm_CreateMagEphemInputFingerprintHdf( file ) != 0 ) {
+        printf("Test 01: Lgm_CreateMagEphemInputFingerprintHdf() failed on a new file\n");
+        ++nFail;
+    }
+    for ( i=0; i<nRows; i++ ) {
+        LGM_HDF5_EXTEND_RANK1_DATASET( file, "IsoTime",          i, atype, &med->H5_IsoTimes[i][0] );
+        LGM_HDF5_EXTEND_RANK1_DATASET( file, "InputFingerprint", i, atype, &med->H5_InputFingerprint[i][0] );
+    }
+    H5Tclose( atype );
+    H5Fclose( file );
+
+    file = H5Fopen( FILENAME, H5F_ACC_RDONLY, H5P_DEFAULT );
+    IsoTimes     = Get_StringDataset_1D( file, "/IsoTime", Dims );
+    Fingerprints = Get_StringDataset_1D( file, "/InputFingerprint", Dims );
+    if ( Dims[0] != nRows ) {
+        printf("Test 01: InputFingerprint has %d rows (expected %d)\n", (int)Dims[0], nRows );
+        ++nFail;
+    } else {
+        for ( i=0; i<nRows; i++ ) {
+            if ( strcmp( Fingerprints[i], Expected[i] ) || strcmp( IsoTimes[i], med->H5_IsoTimes[i] ) ) {
+                printf("Test 01: Row %d: IsoTime = \"%s\" InputFingerprint = \"%s\" (expected \"%s\" \"%s\")\n", i, IsoTimes[i], Fingerprints[i], med->H5_IsoTimes[i], Expected[i] );
+                ++nFail;
+            }
+        }
+    }
+    LGM_ARRAY_2D_FREE( IsoTimes );
+    LGM_ARRAY_2D_FREE( Fingerprints );
+    H5Fclose( file );
+
+
+    // A file written before fingerprints existed.
+    file = H5Fcreate( FILENAME, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT );
+    atype = CreateStrType( 32 );
+    DataSet = CreateExtendableRank1DataSet( file, "IsoTime", atype, &space );
+    H5Sclose( space );
+    H5Dclose( DataSet );
+    for ( i=0; i<nRows; i++ ) LGM_HDF5_EXTEND_RANK1_DATASET( file, "IsoTime", i, atype, &med->H5_IsoTimes[i][0] );
+    H5Fclose( file );
+
+    file = H5Fopen( FILENAME, H5F_ACC_RDWR, H5P_DEFAULT );
+    if ( ( H5Lexists( file, "InputFingerprint", H5P_DEFAULT ) > 0 ) || ( Lgm_CreateMagEphemInputFingerprintHdf( file ) != 0 ) ) {
+        printf("Test 01: Could not add InputFingerprint to an existing file\n");
+        ++nFail;
+    }
+    if ( Lgm_CreateMagEphemInputFingerprintHdf( file ) != -1 ) {
+        printf("Test 01: Creating InputFingerprint twice did not fail\n");
+        ++nFail;
+    }
+    for ( i=0; i<nRows; i++ ) LGM_HDF5_EXTEND_RANK1_DATASET( file, "InputFingerprint", i, atype, &med->H5_InputFingerprint[2][0] );
+    H5Tclose( atype );
+    H5Fclose( file );
+
+    file = H5Fopen( FILENAME, H5F_ACC_RDONLY, H5P_DEFAULT );
+    Fingerprints = Get_StringDataset_1D( file, "/InputFingerprint", Dims );
+    if ( Dims[0] != nRows ) {
+        printf("Test 01: Added InputFingerprint has %d rows (expected %d)\n", (int)Dims[0], nRows );
+        ++nFail;
+    } else {
+        for ( i=0; i<nRows; i++ ) {
+            if ( Fingerprints[i][0] != '\0' ) {
+                printf("Test 01: Added InputFingerprint, row %d = \"%s\" (expected \"\")\n", i, Fingerprints[i] );
+                ++nFail;
+            }
+        }
+    }
+    LGM_ARRAY_2D_FREE( Fingerprints );
+    H5Fclose( file );
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "InputFingerprint: Rows read back differ from those written\n" );
+
+    return;
+}
+END_TEST
+
+
+START_TEST(test_MagEphemHdf_02) {
+
+    int                 i, j, k, nRows = 4, nRecompute, nFail = 0;
+    char                Fingerprint[20], Ref[20], **Fingerprints, c;
+    double              Alpha[3] = { 90.0, 60.0, 30.0 }, Save;
+    double              *QdDoubles[23];
+    int                 *QdInts[14], iSave;
+    _SgpTLE             tle;
+    Lgm_QinDentonOne    p, Rows[4];
+    hid_t               file, atype, space, DataSet;
+    hsize_t             Dims[4];
+
+    /*
+     *  Lgm_MagEphemInputFingerprint() has to change whenever any one of the
+     *  Qin-Denton values it is given changes, and has to be reproducible, so
+     *  that an update of a file with nothing changed recomputes no rows and
+     *  one with a single revised value recomputes only that row.
+     */
+    memset( &tle, 0, sizeof(tle) );
+    strcpy( tle.Line1, "1 25544U 98067A   17001.50000000  .00016717  00000-0  10270-3 0  9005" );
+    strcpy( tle.Line2, "2 25544  51.6400 208.9163 0006317  69.9862  25.2906 15.54225995 35435" );
+    tle.JD = 2457755.0;
+
+    memset( &p, 0, sizeof(p) );
+    QdDoubles[0]  = &p.ByIMF; QdDoubles[1]  = &p.BzIMF; QdDoubles[2]  = &p.V_SW; QdDoubles[3]  = &p.Den_P; QdDoubles[4]  = &p.Pdyn;
+    QdDoubles[5]  = &p.G1;    QdDoubles[6]  = &p.G2;    QdDoubles[7]  = &p.G3;
+    QdDoubles[8]  = &p.fKp;   QdDoubles[9]  = &p.akp3;  QdDoubles[10] = &p.Dst;
+    QdDoubles[11] = &p.Bz1;   QdDoubles[12] = &p.Bz2;   QdDoubles[13] = &p.Bz3; QdDoubles[14] = &p.Bz4; QdDoubles[15] = &p.Bz5; QdDoubles[16] = &p.Bz6;
+    QdDoubles[17] = &p.W1;    QdDoubles[18] = &p.W2;    QdDoubles[19] = &p.W3;  QdDoubles[20] = &p.W4;  QdDoubles[21] = &p.W5;  QdDoubles[22] = &p.W6;
+    QdInts[0]  = &p.ByIMF_status; QdInts[1]  = &p.BzIMF_status; QdInts[2]  = &p.V_SW_status; QdInts[3] = &p.Den_P_status; QdInts[4] = &p.Pdyn_status;
+    QdInts[5]  = &p.G1_status;    QdInts[6]  = &p.G2_status;    QdInts[7]  = &p.G3_status;
+    QdInts[8]  = &p.W1_status;    QdInts[9]  = &p.W2_status;    QdInts[10] = &p.W3_status;   QdInts[11] = &p.W4_status; QdInts[12] = &p.W5_status; QdInts[13] = &p.W6_status;
+    for ( k=0; k<23; k++ ) *QdDoubles[k] = 0.5*(k+1);
+    for ( k=0; k<14; k++ ) *QdInts[k] = 2;
+
+    Lgm_MagEphemInputFingerprint( Ref, &tle, &p, "IGRF", "T89", 3, 24, -1.0, 100.0, 3, Alpha, 1 );
+    Lgm_MagEphemInputFingerprint( Fingerprint, &tle, &p, "IGRF", "T89", 3, 24, -1.0, 100.0, 3, Alpha, 1 );
+    if ( ( strlen( Ref ) != 16 ) || strcmp( Ref, Fingerprint ) ) {
+        printf("Test 02: Fingerprints of identical inputs: \"%s\" \"%s\"\n", Ref, Fingerprint );
+        ++nFail;
+    }
+
+    for ( k=0; k<23; k++ ) {
+        Save = *QdDoubles[k];
+        *QdDoubles[k] += 0.1;
+        Lgm_MagEphemInputFingerprint( Fingerprint, &tle, &p, "IGRF", "T89", 3, 24, -1.0, 100.0, 3, Alpha, 1 );
+        *QdDoubles[k] = Save;
+        if ( strcmp( Ref, Fingerprint ) == 0 ) {
+            printf("Test 02: Changing Qin-Denton value %d does not change the fingerprint\n", k );
+            ++nFail;
+        }
+    }
+    for ( k=0; k<14; k++ ) {
+        iSave = *QdInts[k];
+        *QdInts[k] = 1;
+        Lgm_MagEphemInputFingerprint( Fingerprint, &tle, &p, "IGRF", "T89", 3, 24, -1.0, 100.0, 3, Alpha, 1 );
+        *QdInts[k] = iSave;
+        if ( strcmp( Ref, Fingerprint ) == 0 ) {
+            printf("Test 02: Changing Qin-Denton status %d does not change the fingerprint\n", k );
+            ++nFail;
+        }
+    }
+    c = tle.Line2[30];
+    tle.Line2[30] = ( c == '9' ) ? '8' : '9';
+    Lgm_MagEphemInputFingerprint( Fingerprint, &tle, &p, "IGRF", "T89", 3, 24, -1.0, 100.0, 3, Alpha, 1 );
+    if ( strcmp( Ref, Fingerprint ) == 0 ) {
+        printf("Test 02: Changing the TLE does not change the fingerprint\n" );
+        ++nFail;
+    }
+    tle.Line2[30] = c;
+
+    // -0.0 and 0.0 are the same input.
+    p.Dst = 0.0;
+    Lgm_MagEphemInputFingerprint( Ref, &tle, &p, "IGRF", "T89", 3, 24, -1.0, 100.0, 3, Alpha, 1 );
+    p.Dst = -0.0;
+    Lgm_MagEphemInputFingerprint( Fingerprint, &tle, &p, "IGRF", "T89", 3, 24, -1.0, 100.0, 3, Alpha, 1 );
+    if ( strcmp( Ref, Fingerprint ) ) {
+        printf("Test 02: Dst = 0.0 and Dst = -0.0 fingerprint differently\n" );
+        ++nFail;
+    }
+
+    /*
+     *  Store the fingerprints of a few rows, read them back, and see which
+     *  rows an update with the same (and then one revised) set of inputs
+     *  would recompute.
+     */
+    H5Eset_auto( H5E_DEFAULT, NULL, NULL );
+    file = H5Fcreate( FILENAME, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT );
+    atype = CreateStrType( 32 );
+    DataSet = CreateExtendableRank1DataSet( file, "IsoTime", atype, &space );
+    H5Sclose( space );
+    H5Dclose( DataSet );
+    Lgm_CreateMagEphemInputFingerprintHdf( file );
+    for ( i=0; i<nRows; i++ ) {
+        Rows[i] = p;
+        Rows[i].Dst  = -10.0*i;
+        Rows[i].fKp  = 1.0 + i;
+        sprintf( med->H5_IsoTimes[0], "2017-01-01T%02d:00:00.000Z", i );
+        Lgm_MagEphemInputFingerprint( med->H5_InputFingerprint[0], &tle, &Rows[i], "IGRF", "T89", 3, 24, -1.0, 100.0, 3, Alpha, 1 );
+        LGM_HDF5_EXTEND_RANK1_DATASET( file, "IsoTime",          i, atype, &med->H5_IsoTimes[0][0] );
+        LGM_HDF5_EXTEND_RANK1_DATASET( file, "InputFingerprint", i, atype, &med->H5_InputFingerprint[0][0] );
+    }
+    H5Tclose( atype );
+    H5Fclose( file );
+
+    file = H5Fopen( FILENAME, H5F_ACC_RDONLY, H5P_DEFAULT );
+    Fingerprints = Get_StringDataset_1D( file, "/InputFingerprint", Dims );
+    H5Fclose( file );
+    for ( j=0; j<2; j++ ) {
+        if ( j == 1 ) Rows[2].Dst = -23.0;  // a provisional value replaced by a definitive one
+        for ( nRecompute=0, i=0; i<nRows; i++ ) {
+            Lgm_MagEphemInputFingerprint( Fingerprint, &tle, &Rows[i], "IGRF", "T89", 3, 24, -1.0, 100.0, 3, Alpha, 1 );
+            if ( strcmp( Fingerprint, Fingerprints[i] ) != 0 ) {
+                ++nRecompute;
+                if ( ( j == 0 ) || ( i != 2 ) ) {
+                    printf("Test 02: %s run would recompute row %d\n", ( j == 0 ) ? "Identical" : "Revised", i );
+                    ++nFail;
+                }
+            }
+        }
+        if ( nRecompute != j ) {
+            printf("Test 02: %s run would recompute %d rows (expected %d)\n", ( j == 0 ) ? "Identical" : "Revised", nRecompute, j );
+            ++nFail;
+        }
+    }
+    LGM_ARRAY_2D_FREE( Fingerprints );
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "InputFingerprint: Fingerprints do not track the inputs\n" );
+
+    return;
+}
+END_TEST
+
+
+Suite *MagEphemHdf_suite(void) {
+
+  Suite *s = suite_create("MAGEPHEMHDF_TESTS");
+
+  TCase *tc_MagEphemHdf = tcase_create("MagEphem HDF5");
+  tcase_add_checked_fixture(tc_MagEphemHdf, MagEphemHdf_Setup, MagEphemHdf_TearDown);
+
+  tcase_add_test(tc_MagEphemHdf, test_MagEphemHdf_01);
+  tcase_add_test(tc_MagEphemHdf, test_MagEphemHdf_02);
+
+  suite_add_tcase(s, tc_MagEphemHdf);
+
+  return s;
+
+}
+
+int main(void) {
+
+    int      number_failed;
+    Suite   *s  = MagEphemHdf_suite();
+    SRunner *sr = srunner_create(s);
+
+    printf("\n\n");
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
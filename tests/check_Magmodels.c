@@ -1,5 +1,7 @@
 #include <check.h>
 #include "../libLanlGeoMag/Lgm/Lgm_MagModelInfo.h"
+#include "../libLanlGeoMag/Lgm/Lgm_SHCoeffs.h"
+#include "../libLanlGeoMag/Lgm/Lgm_B_Grid.h"
 
 /*
  *  Regression tests for magnetic field model calculations
@@ -19,6 +21,34 @@ void Magmodels_TearDown(void) {
 }
 
 
+/*
+ *  Reference IGRF field (GSM) computed the way Lgm_B_igrf_ctrans() used to:
+ *  via geocentric spherical coords and the spherical harmonic routine
+ *  Lgm_IGRF().
+ */
+static void IGRF_Spherical( Lgm_Vector *v, Lgm_Vector *B, Lgm_CTrans *c ) {
+
+    double      r, theta, phi, st, ct, sp, cp;
+    Lgm_Vector  w, Bsph, Bgeo;
+
+    Lgm_Convert_Coords( v, &w, GSM_TO_WGS84, c );
+    r     = sqrt( w.x*w.x + w.y*w.y + w.z*w.z );
+    theta = acos( w.z/r );
+    phi   = atan2( w.y, w.x );
+    st = sin( theta ); ct = cos( theta );
+    sp = sin( phi );   cp = cos( phi );
+
+    w.x = r; w.y = theta; w.z = phi;
+    Lgm_IGRF( &w, &Bsph, c );
+
+    Bgeo.x = Bsph.x*st*cp + Bsph.y*ct*cp - Bsph.z*sp;
+    Bgeo.y = Bsph.x*st*sp + Bsph.y*ct*sp + Bsph.z*cp;
+    Bgeo.z = Bsph.x*ct    - Bsph.y*st;
+    Lgm_Convert_Coords( &Bgeo, B, WGS84_TO_GSM, c );
+
+}
+
+
 START_TEST(test_Magmodels_01) {
     Lgm_Vector        Bexpect, Pos, Btest, Udiff;
     int               nTests, nPass, nFail, transflag, Passed=FALSE;
@@ -116,6 +146,382 @@ START_TEST(test_Magmodels_01) {
 }
 END_TEST
 
+START_TEST(test_Magmodels_02) {
+
+    int         i, j, k, nFail = 0;
+    long int    Date[3] = { 19700101, 20050615, 20200301 };
+    double      r[4] = { 1.0, 1.5, 4.0, 10.0 }, Lat, Lon, cl, del, Bmag;
+    Lgm_Vector  u, v, B1, B2;
+
+    /*
+     *  Lgm_B_igrf (cartesian Lgm_IGRF_Cart() path) should agree with the
+     *  spherical harmonic path to round-off, at all dates, radii and
+     *  latitudes (including points a hair off the poles, where the
+     *  spherical path is at its worst).
+     */
+    Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_NULL, mInfo );
+    for ( i=0; i<3; i++ ) {
+        Lgm_Set_Coord_Transforms( Date[i], 3.0, mInfo->c );
+        for ( j=0; j<4; j++ ) {
+            for ( k=0; k<=36; k++ ) {
+                Lat = ( k == 0 ) ? -89.9999 : ( k == 36 ) ? 89.9999 : -90.0 + 5.0*k;
+                Lon = 37.0*k;
+                cl  = cos( Lat*RadPerDeg );
+                u.x = r[j]*cl*cos( Lon*RadPerDeg ); u.y = r[j]*cl*sin( Lon*RadPerDeg ); u.z = r[j]*sin( Lat*RadPerDeg );
+                Lgm_Convert_Coords( &u, &v, WGS84_TO_GSM, mInfo->c );
+
+                mInfo->Bfield( &v, &B1, mInfo );
+                IGRF_Spherical( &v, &B2, mInfo->c );
+                Bmag = Lgm_Magnitude( &B2 );
+                del  = Lgm_VecDiffMag( &B1, &B2 )/Bmag;
+                if ( del > 1e-9 ) {
+                    printf("Test 02: Date = %ld r = %g Lat = %g Lon = %g  Cart = %.12g %.12g %.12g  Sph = %.12g %.12g %.12g (rel. diff = %g)\n",
+                            Date[i], r[j], Lat, Lon, B1.x, B1.y, B1.z, B2.x, B2.y, B2.z, del );
+                    ++nFail;
+                }
+
+                /*
+                 *  And Lgm_IGRF_Cart() directly in GEO.
+                 */
+                Lgm_IGRF_Cart( &u, &B1, mInfo->c );
+                Lgm_Convert_Coords( &B2, &v, GSM_TO_WGS84, mInfo->c );
+                if ( Lgm_VecDiffMag( &B1, &v )/Bmag > 1e-9 ) {
+                    printf("Test 02: Lgm_IGRF_Cart: Date = %ld r = %g Lat = %g Lon = %g  Cart = %.12g %.12g %.12g  Sph = %.12g %.12g %.12g\n",
+                            Date[i], r[j], Lat, Lon, B1.x, B1.y, B1.z, v.x, v.y, v.z );
+                    ++nFail;
+                }
+            }
+        }
+    }
+
+    fflush(stdout);
+    ck_assert_msg( nFail == 0, "Lgm_IGRF_Cart: Results differ from spherical IGRF.\n" );
+
+}
+END_TEST
+
+START_TEST(test_Magmodels_03) {
+
+    int             i, j, k, nFail = 0;
+    long int        Date[3] = { 19700101, 20050615, 20200301 };
+    double          r[3] = { 1.0, 2.0, 6.6 }, Lat, Lon, cl, del, f, Year, MdotR, R, M[3][2] = { { -1500.0, -1600.0 }, { 5000.0, 4900.0 }, { -29500.0, -29000.0 } };
+    Lgm_Vector      u, v, B1, B2, Mv, Rv;
+    Lgm_SHCoeffs    *s;
+    FILE            *fp;
+
+    /*
+     *  A coefficient set holding IGRF should reproduce the built-in IGRF
+     *  (folded at 12 UT, so that is where we compare).
+     */
+    s = Lgm_SHCoeffs_IGRF();
+    Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_NULL, mInfo );
+    for ( i=0; i<3; i++ ) {
+        Lgm_Set_Coord_Transforms( Date[i], 12.0, mInfo->c );
+        for ( j=0; j<3; j++ ) {
+            for ( k=0; k<=18; k++ ) {
+                Lat = -89.0 + 178.0*k/18.0; Lon = 73.0*k;
+                cl  = cos( Lat*RadPerDeg );
+                u.x = r[j]*cl*cos( Lon*RadPerDeg ); u.y = r[j]*cl*sin( Lon*RadPerDeg ); u.z = r[j]*sin( Lat*RadPerDeg );
+                Lgm_Convert_Coords( &u, &v, WGS84_TO_GSM, mInfo->c );
+
+                Lgm_Set_SHCoeffs( NULL, mInfo->c );
+                mInfo->Bfield( &v, &B1, mInfo );
+                Lgm_Set_SHCoeffs( s, mInfo->c );
+                mInfo->Bfield( &v, &B2, mInfo );
+                del = Lgm_VecDiffMag( &B1, &B2 )/Lgm_Magnitude( &B1 );
+                if ( del > 1e-9 ) {
+                    printf("Test 03: Date = %ld r = %g Lat = %g Lon = %g  IGRF = %.12g %.12g %.12g  SHCoeffs = %.12g %.12g %.12g (rel. diff = %g)\n",
+                            Date[i], r[j], Lat, Lon, B1.x, B1.y, B1.z, B2.x, B2.y, B2.z, del );
+                    ++nFail;
+                }
+            }
+        }
+    }
+    Lgm_Set_SHCoeffs( NULL, mInfo->c );
+    Lgm_SHCoeffs_Free( s );
+
+
+    /*
+     *  Read back a .shc file holding a (time varying) tilted dipole, padded
+     *  out to degree 2 with zeros, and compare with the analytic field
+     *
+     *      B = 3 (M.R) R/R^5 - M/R^3        (R in units of RefRadius)
+     *
+     *  where M = ( g11, h11, g10 ).
+     */
+    fp = fopen( "check_Magmodels_03.shc", "w" );
+    fprintf( fp, "# Tilted dipole test model\n# \n1 2 2 2 1\n2000.0 2010.0\n" );
+    fprintf( fp, "1  0 %g %g\n1  1 %g %g\n1 -1 %g %g\n", M[2][0], M[2][1], M[0][0], M[0][1], M[1][0], M[1][1] );
+    fprintf( fp, "2  0 0 0\n2  1 0 0\n2 -1 0 0\n2  2 0 0\n2 -2 0 0\n" );
+    fclose( fp );
+    s = Lgm_SHCoeffs_ReadSHC( "check_Magmodels_03.shc" );
+    remove( "check_Magmodels_03.shc" );
+    ck_assert_msg( ( s != NULL ) && ( s->N == 2 ) && ( s->nEpochs == 2 ), "Lgm_SHCoeffs_ReadSHC: Could not read back coefficient file.\n" );
+
+    Lgm_Set_SHCoeffs( s, mInfo->c );
+    f = Re/s->RefRadius;
+    for ( i=0; i<3; i++ ) {
+        Lgm_Set_Coord_Transforms( Date[i], 12.0, mInfo->c );
+        Year = (double)mInfo->c->UTC.Year + ((double)mInfo->c->UTC.Doy - 0.5)/(365.0 + (double)Lgm_LeapYear( mInfo->c->UTC.Year ));
+        Year = ( Year - 2000.0 )/10.0;
+        if ( Year > 1.0 ) Year = 1.0; // no SV after the last epoch
+        Mv.x = M[0][0] + Year*( M[0][1] - M[0][0] );
+        Mv.y = M[1][0] + Year*( M[1][1] - M[1][0] );
+        Mv.z = M[2][0] + Year*( M[2][1] - M[2][0] );
+        for ( j=0; j<3; j++ ) {
+            for ( k=0; k<=18; k++ ) {
+                Lat = -89.0 + 178.0*k/18.0; Lon = 73.0*k;
+                cl  = cos( Lat*RadPerDeg );
+                u.x = r[j]*cl*cos( Lon*RadPerDeg ); u.y = r[j]*cl*sin( Lon*RadPerDeg ); u.z = r[j]*sin( Lat*RadPerDeg );
+
+                Lgm_SHCoeffs_B( &u, &B1, mInfo->c );
+
+                Rv = u; Lgm_ScaleVector( &Rv, f );
+                R = Lgm_Magnitude( &Rv ); MdotR = Lgm_DotProduct( &Mv, &Rv );
+                B2.x = 3.0*MdotR*Rv.x/pow( R, 5.0 ) - Mv.x/( R*R*R );
+                B2.y = 3.0*MdotR*Rv.y/pow( R, 5.0 ) - Mv.y/( R*R*R );
+                B2.z = 3.0*MdotR*Rv.z/pow( R, 5.0 ) - Mv.z/( R*R*R );
+                del = Lgm_VecDiffMag( &B1, &B2 )/Lgm_Magnitude( &B2 );
+                if ( del > 1e-12 ) {
+                    printf("Test 03: Dipole: Date = %ld r = %g Lat = %g Lon = %g  SHCoeffs = %.12g %.12g %.12g  Analytic = %.12g %.12g %.12g (rel. diff = %g)\n",
+                            Date[i], r[j], Lat, Lon, B1.x, B1.y, B1.z, B2.x, B2.y, B2.z, del );
+                    ++nFail;
+                }
+            }
+        }
+    }
+    Lgm_Set_SHCoeffs( NULL, mInfo->c );
+    Lgm_SHCoeffs_Free( s );
+
+    fflush(stdout);
+    ck_assert_msg( nFail == 0, "Lgm_SHCoeffs: Results differ from built-in IGRF or analytic dipole.\n" );
+
+}
+END_TEST
+
+START_TEST(test_Magmodels_04) {
+
+    int         i, j, k, n, l, nFail = 0;
+    double      J[3][3], Jfd[3][3], h = 1e-3, Jmax, del;
+    Lgm_Vector  u[4], B, Bref, v, Bp[4];
+
+    /*
+     *  Lgm_B_Jacobian() (analytic for the internal models, one stencil pass
+     *  otherwise) against plain fourth order central differences of
+     *  mInfo->Bfield. For the internal models J must also be symmetric
+     *  (curl free).
+     */
+    u[0].x = 1.1; u[0].y =  0.2; u[0].z =  0.3;
+    u[1].x = -2.5; u[1].y = 1.5; u[1].z = -1.0;
+    u[2].x = 0.1; u[2].y = -0.2; u[2].z =  1.8;
+    u[3].x = -6.6; u[3].y = 0.5; u[3].z =  0.4;
+
+    Lgm_Set_Coord_Transforms( 20150317, 8.0, mInfo->c );
+    mInfo->Kp = 2;
+    for ( n=0; n<4; n++ ) {
+        switch ( n ) {
+            case 0: Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_NULL, mInfo ); break;
+            case 1: Lgm_MagModelInfo_Set_MagModel( LGM_CDIP, LGM_EXTMODEL_NULL, mInfo ); break;
+            case 2: Lgm_MagModelInfo_Set_MagModel( LGM_EDIP, LGM_EXTMODEL_NULL, mInfo ); break;
+            case 3: Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_T89, mInfo ); break;
+        }
+        for ( k=0; k<4; k++ ) {
+
+            Lgm_B_Jacobian( &u[k], &B, J, LGM_DERIV_SIX_POINT, h, mInfo );
+            mInfo->Bfield( &u[k], &Bref, mInfo );
+
+            for ( j=0; j<3; j++ ) {
+                for ( l=0; l<4; l++ ) {
+                    v = u[k];
+                    del = ( l < 2 ) ? (l-2)*h : (l-1)*h;
+                    if ( j == 0 ) v.x += del; else if ( j == 1 ) v.y += del; else v.z += del;
+                    mInfo->Bfield( &v, &Bp[l], mInfo );
+                }
+                Jfd[0][j] = ( Bp[0].x - 8.0*Bp[1].x + 8.0*Bp[2].x - Bp[3].x )/(12.0*h);
+                Jfd[1][j] = ( Bp[0].y - 8.0*Bp[1].y + 8.0*Bp[2].y - Bp[3].y )/(12.0*h);
+                Jfd[2][j] = ( Bp[0].z - 8.0*Bp[1].z + 8.0*Bp[2].z - Bp[3].z )/(12.0*h);
+            }
+
+            Jmax = 0.0;
+            for ( i=0; i<3; i++ ) for ( j=0; j<3; j++ ) if ( fabs( Jfd[i][j] ) > Jmax ) Jmax = fabs( Jfd[i][j] );
+            for ( i=0; i<3; i++ ) {
+                for ( j=0; j<3; j++ ) {
+                    if (    ( fabs( J[i][j] - Jfd[i][j] ) > 1e-6*Jmax )
+                         || ( ( n < 3 ) && ( fabs( J[i][j] - J[j][i] ) > 1e-9*Jmax ) ) ) {
+                        printf("Test 04: model %d, point %d: J[%d][%d] = %.12g  finite diff. = %.12g  J[%d][%d] = %.12g\n", n, k, i, j, J[i][j], Jfd[i][j], j, i, J[j][i] );
+                        ++nFail;
+                    }
+                }
+            }
+            if ( Lgm_VecDiffMag( &B, &Bref ) > 1e-9*Lgm_Magnitude( &Bref ) ) {
+                printf("Test 04: model %d, point %d: B = %.12g %.12g %.12g  Bfield = %.12g %.12g %.12g\n", n, k, B.x, B.y, B.z, Bref.x, Bref.y, Bref.z );
+                ++nFail;
+            }
+
+        }
+    }
+
+    fflush(stdout);
+    ck_assert_msg( nFail == 0, "Lgm_B_Jacobian: Results differ from finite differences of Bfield.\n" );
+
+}
+END_TEST
+
+
+START_TEST(test_Magmodels_05) {
+
+    int             i, j, nFail = 0;
+    double          r, Th, Ph, err, Tol = 1.0, MaxErr = 0.0;
+    Lgm_Vector      v, B, Bref;
+    Lgm_B_GridInfo  *g;
+
+    /*
+     *  Lgm_B_Grid() against the model it was built from, with the box from
+     *  the Lgm_B_Grid.c docs. The origin is a node of 8 top-level cells, so
+     *  those can not be interpolated; the field must still be right (and
+     *  finite) everywhere outside the Earth, in particular within 2.5 Re.
+     */
+    Lgm_Set_Coord_Transforms( 20150317, 8.0, mInfo->c );
+    Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_T89, mInfo );
+    mInfo->Kp = 2;
+    g = Lgm_B_Grid_Build( -30.0, 15.0, -20.0, 20.0, -15.0, 15.0, 2.5, Tol, 3, mInfo );
+    Lgm_Set_Lgm_B_Grid( g, mInfo );
+
+    if ( g->nDirect < 1 ) {
+        printf("Test 05: no leaves use the model directly (expected some at the origin)\n");
+        ++nFail;
+    }
+
+    for ( i=0; i<12; i++ ) {
+        r = 1.0 + 0.125*i;
+        for ( j=0; j<20; j++ ) {
+            Th = ( 9.0*j + 4.5 )*RadPerDeg;
+            Ph = 37.0*j*RadPerDeg;
+            v.x = r*sin( Th )*cos( Ph ); v.y = r*sin( Th )*sin( Ph ); v.z = r*cos( Th );
+            Lgm_B_Grid( &v, &B, mInfo );
+            g->Bsrc( &v, &Bref, mInfo );
+            err = Lgm_VecDiffMag( &B, &Bref );
+            if ( !( err <= 3.0*Tol ) ) {
+                printf("Test 05: r = %g: B = %g %g %g  direct = %g %g %g\n", r, B.x, B.y, B.z, Bref.x, Bref.y, Bref.z );
+                ++nFail;
+            }
+        }
+    }
+
+    err = Lgm_B_Grid_CheckError( g, 2000, mInfo );
+    if ( !( err <= 3.0*Tol ) ) {
+        printf("Test 05: Lgm_B_Grid_CheckError() = %g nT (Tol = %g nT)\n", err, Tol );
+        ++nFail;
+    }
+
+    Lgm_B_Grid_Free( g );
+
+    fflush(stdout);
+    ck_assert_msg( nFail == 0, "Lgm_B_Grid: Results differ from the source model.\n" );
+
+}
+END_TEST
+
+
+START_TEST(test_Magmodels_06) {
+
+    /*
+     *  T96, T01S, T02 and TS04 against values from before their (PS,
+     *  PARMOD)-dependent state was cached. The parameter sets are run in
+     *  turn through the Info structures in mInfo (T01S and T02 share
+     *  T01_Info), so the cache has to be rebuilt whenever PS, PARMOD or the
+     *  model changes: set 2 differs from set 1 only in By, and set 3 goes
+     *  back to set 0. Set 0 has |Dst*| < 20 nT, where the T02 ring current
+     *  PHI must use the unclamped |Dst*|.
+     */
+    static double Par[4][11] = {
+        { 0.0, 1.0,   16.0, -2.0,   3.0, 0.5, 1.0, 0.1, 0.2, 0.3, 0.1 },
+        { 0.0, 8.0, -150.0,  4.0, -12.0, 6.0, 9.0, 1.2, 0.9, 1.5, 0.8 },
+        { 0.0, 8.0, -150.0,  6.0, -12.0, 6.0, 9.0, 1.2, 0.9, 1.5, 0.8 },
+        { 0.0, 1.0,   16.0, -2.0,   3.0, 0.5, 1.0, 0.1, 0.2, 0.3, 0.1 } };
+    static double PS[4] = { 0.3, -0.25, -0.25, 0.3 };
+    static double Pos[3][3] = { { -6.6, 0.0, 0.0 }, { -4.0, 2.0, 1.5 }, { -10.0, -3.0, 2.0 } };
+    static char  *Name[4] = { "T96", "T01S", "T02", "TS04" };
+    /*  model, parameter set, position, Bx, By, Bz (GSM, nT) */
+    static double Ref[48][6] = {
+        { 0, 0, 0, -9.574489259524885e+00, -6.387166411976556e-01, -1.002469484855029e+01 },
+        { 0, 0, 1, -2.300875526635923e-01, -1.173944040751762e+00, -1.084276196111424e+01 },
+        { 0, 0, 2, -3.845623947760053e+00, -1.265933494403109e+00, -1.120004976708752e+01 },
+        { 1, 0, 0, -1.311261100601460e+01, -1.649588959847062e+00, -7.172684057588657e+00 },
+        { 1, 0, 1, -3.330731659758130e+00, -1.068654571687735e+00, -2.011158708341850e+01 },
+        { 1, 0, 2, -2.531570627192194e+00, 2.917607153343851e-02, -1.176589875792591e+01 },
+        { 2, 0, 0, -8.290492541277384e+00, 1.473083161849951e-01, -9.288592305379437e+00 },
+        { 2, 0, 1, 5.123436353156324e-02, -6.214692083513611e-01, -9.757307789513535e+00 },
+        { 2, 0, 2, -3.008403477461277e+00, -2.763264439807408e-01, -9.766067247906340e+00 },
+        { 3, 0, 0, -2.792811131832573e+01, -1.935128700326921e+00, -2.732308613291150e+01 },
+        { 3, 0, 1, -7.983408556210192e+00, -2.519150940776971e+00, -4.096355268783134e+01 },
+        { 3, 0, 2, -5.166132481242246e+00, -7.399711532151786e-01, -2.614568297188970e+01 },
+        { 0, 1, 0, 1.375481552992724e+02, 1.154457800852278e+00, -6.469251070577850e+01 },
+        { 0, 1, 1, 1.365108395408024e+02, -6.014247327069511e+01, -1.375513279244778e+02 },
+        { 0, 1, 2, 8.184296203066793e+01, 1.939164756763365e+01, -1.523238413563903e+01 },
+        { 1, 1, 0, 1.110573395141042e+02, 3.397663093330632e+00, -5.002855145174338e+01 },
+        { 1, 1, 1, 1.086379786366708e+02, -2.867006968327080e+01, -1.073155999208840e+02 },
+        { 1, 1, 2, 8.190509558380681e+01, 1.316516038647628e+01, -1.833622404837803e+01 },
+        { 2, 1, 0, 1.019889124822497e+02, 3.150944520471590e+00, -6.858930441298446e+01 },
+        { 2, 1, 1, 1.041886648270200e+02, -2.888034084207851e+01, -1.039233765317072e+02 },
+        { 2, 1, 2, 8.642061444761488e+01, 1.521793523836645e+01, -2.117688627215710e+01 },
+        { 3, 1, 0, 1.078401026731124e+02, 2.678258325173589e+00, -4.300887435347410e+01 },
+        { 3, 1, 1, 8.903801221879414e+01, -2.978519670312761e+01, -7.742813373332032e+01 },
+        { 3, 1, 2, 8.375258807624552e+01, 8.399714048003030e+00, -1.718881046356393e+01 },
+        { 0, 2, 0, 1.387456737797002e+02, 1.731686701278417e+00, -6.470283349512664e+01 },
+        { 0, 2, 1, 1.377488331653784e+02, -6.054044149554061e+01, -1.382529962880098e+02 },
+        { 0, 2, 2, 8.246511780216856e+01, 1.994042851988151e+01, -1.527187457519370e+01 },
+        { 1, 2, 0, 1.110573395141042e+02, 4.390432742129988e+00, -5.000247271132843e+01 },
+        { 1, 2, 1, 1.086379786366708e+02, -2.767730003447145e+01, -1.072895211804691e+02 },
+        { 1, 2, 2, 8.190509558380681e+01, 1.415793003527564e+01, -1.831014530796309e+01 },
+        { 2, 2, 0, 1.019889124822497e+02, 4.298996729794231e+00, -6.840149906867310e+01 },
+        { 2, 2, 1, 1.041886648270200e+02, -2.773228863275586e+01, -1.037355711873959e+02 },
+        { 2, 2, 2, 8.642061444761488e+01, 1.636598744768909e+01, -2.098908092784573e+01 },
+        { 3, 2, 0, 1.078401026731124e+02, 3.583330325173589e+00, -4.300887435347410e+01 },
+        { 3, 2, 1, 8.903801221879414e+01, -2.888012470312761e+01, -7.742813373332032e+01 },
+        { 3, 2, 2, 8.375258807624552e+01, 9.304786048003031e+00, -1.718881046356393e+01 },
+        { 0, 3, 0, -9.574489259524885e+00, -6.387166411976556e-01, -1.002469484855029e+01 },
+        { 0, 3, 1, -2.300875526635923e-01, -1.173944040751762e+00, -1.084276196111424e+01 },
+        { 0, 3, 2, -3.845623947760053e+00, -1.265933494403109e+00, -1.120004976708752e+01 },
+        { 1, 3, 0, -1.311261100601460e+01, -1.649588959847062e+00, -7.172684057588657e+00 },
+        { 1, 3, 1, -3.330731659758130e+00, -1.068654571687735e+00, -2.011158708341850e+01 },
+        { 1, 3, 2, -2.531570627192194e+00, 2.917607153343851e-02, -1.176589875792591e+01 },
+        { 2, 3, 0, -8.290492541277384e+00, 1.473083161849951e-01, -9.288592305379437e+00 },
+        { 2, 3, 1, 5.123436353156324e-02, -6.214692083513611e-01, -9.757307789513535e+00 },
+        { 2, 3, 2, -3.008403477461277e+00, -2.763264439807408e-01, -9.766067247906340e+00 },
+        { 3, 3, 0, -2.792811131832573e+01, -1.935128700326921e+00, -2.732308613291150e+01 },
+        { 3, 3, 1, -7.983408556210192e+00, -2.519150940776971e+00, -4.096355268783134e+01 },
+        { 3, 3, 2, -5.166132481242246e+00, -7.399711532151786e-01, -2.614568297188970e+01 },
+    };
+    Lgm_Vector  B, Bref, Bdiff;
+    int         n, m, i, j, nFail = 0;
+    double      err, sps, cps;
+
+    for ( n=0; n<48; n++ ) {
+        m = (int)Ref[n][0]; i = (int)Ref[n][1]; j = (int)Ref[n][2];
+        sps = sin( PS[i] ); cps = cos( PS[i] );
+        switch ( m ) {
+            case 0: Tsyg_T96(  0, Par[i], PS[i], sps, cps, Pos[j][0], Pos[j][1], Pos[j][2], &B.x, &B.y, &B.z, &mInfo->T96_Info );  break;
+            case 1: Tsyg_T01S( 0, Par[i], PS[i], sps, cps, Pos[j][0], Pos[j][1], Pos[j][2], &B.x, &B.y, &B.z, &mInfo->T01_Info );  break;
+            case 2: Tsyg_T02(  0, Par[i], PS[i], sps, cps, Pos[j][0], Pos[j][1], Pos[j][2], &B.x, &B.y, &B.z, &mInfo->T01_Info );  break;
+            case 3: Tsyg_TS04( 0, Par[i], PS[i], sps, cps, Pos[j][0], Pos[j][1], Pos[j][2], &B.x, &B.y, &B.z, &mInfo->TS04_Info ); break;
+        }
+        Bref.x = Ref[n][3]; Bref.y = Ref[n][4]; Bref.z = Ref[n][5];
+        Lgm_VecSub( &Bdiff, &B, &Bref );
+        err = Lgm_Magnitude( &Bdiff )/Lgm_Magnitude( &Bref );
+        if ( !( err <= 1e-10 ) ) {
+            printf("Test 06: %s, set %d, pos %d: B = %.15g %.15g %.15g  expected %.15g %.15g %.15g (rel. err %g)\n",
+                    Name[m], i, j, B.x, B.y, B.z, Bref.x, Bref.y, Bref.z, err );
+            ++nFail;
+        }
+    }
+
+    fflush(stdout);
+    ck_assert_msg( nFail == 0, "Tsyganenko models: Results differ from the reference values.\n" );
+
+}
+END_TEST
+
 
 Suite *Magmodels_suite(void) {
 
@@ -125,6 +531,11 @@ Suite *Magmodels_suite(void) {
   tcase_add_checked_fixture(tc_Magmodels, Magmodels_Setup, Magmodels_TearDown);
 
   tcase_add_test(tc_Magmodels, test_Magmodels_01);
+  tcase_add_test(tc_Magmodels, test_Magmodels_02);
+  tcase_add_test(tc_Magmodels, test_Magmodels_03);
+  tcase_add_test(tc_Magmodels, test_Magmodels_04);
+  tcase_add_test(tc_Magmodels, test_Magmodels_05);
+  tcase_add_test(tc_Magmodels, test_Magmodels_06);
 
   suite_add_tcase(s, tc_Magmodels);
 
@@ -450,6 +450,104 @@ START_TEST(test_MCILWAIN_08) {
 }
 END_TEST
 
+START_TEST(test_MCILWAIN_09) {
+
+    int                 n, k, nGood, nGood_expected = 0, nFill = 0, Passed = TRUE;
+    long int            Date;
+    double              Alpha[6] = { 5.0, 30.0, 45.0, 60.0, 75.0, 90.0 };
+    double              Pos[6][3] = { { -4.2, 1.0, 1.0 }, { 3.0, -2.0, 0.5 }, { 0.0, 0.0, 10.0 }, { -6.6, 0.0, 0.0 }, { 0.5, 0.0, 0.0 }, { -2.0, 0.5, -0.3 } };
+    double              L[36], I[36], Bm[36], M, Ls, Is, Bms, Ms, UTC;
+    Lgm_Vector          u, v[6];
+    Lgm_MagModelInfo    *m;
+
+    /*
+     *  The batch routine should give exactly what Lgm_McIlwain_L() gives
+     *  when called one position and pitch angle at a time with the same
+     *  mInfo, including the failures: a position over the pole (open field
+     *  line), one inside the Earth and a pitch angle whose mirror points are
+     *  below the loss cone height.
+     */
+    Date = 20101012; UTC  = 0.0;
+    Lgm_Set_Coord_Transforms( Date, UTC, mInfo->c );
+    for ( n=0; n<6; n++ ) {
+        u.x = Pos[n][0]; u.y = Pos[n][1]; u.z = Pos[n][2];
+        Lgm_Convert_Coords( &u, &v[n], SM_TO_GSM, mInfo->c );
+    }
+    Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_T89, mInfo );
+    mInfo->Kp = 4.;
+    nGood = Lgm_McIlwain_L_Batch( Date, UTC, 6, v, 6, Alpha, 0, L, I, Bm, &M, mInfo );
+
+    for ( n=0; n<6; n++ ) {
+        for ( k=0; k<6; k++ ) {
+            m  = Lgm_CopyMagInfo( mInfo );
+            Ls = Lgm_McIlwain_L( Date, UTC, &v[n], Alpha[k], 0, &Is, &Bms, &Ms, m );
+            Lgm_FreeMagInfo( m );
+            if ( Ls > 0.0 ) ++nGood_expected; else ++nFill;
+            if ( (L[n*6+k] != Ls) || (I[n*6+k] != Is) || (Bm[n*6+k] != Bms) || ( (Ls > 0.0) && (M != Ms) ) ) {
+                printf("\nTest 09, Lgm_McIlwain_L_Batch(): Pos = %g %g %g  Alpha = %g  L, I, Bm (batch) = %.17g %.17g %.17g   L, I, Bm (single) = %.17g %.17g %.17g\n",
+                        Pos[n][0], Pos[n][1], Pos[n][2], Alpha[k], L[n*6+k], I[n*6+k], Bm[n*6+k], Ls, Is, Bms );
+                Passed = FALSE;
+            }
+        }
+    }
+
+    if ( (nGood != nGood_expected) || (nGood == 0) || (nFill < 13) ) {
+        printf("\nTest 09, Lgm_McIlwain_L_Batch(): %d valid L values (expected %d, with %d fill values)\n", nGood, nGood_expected, nFill );
+        Passed = FALSE;
+    }
+
+    fflush(stdout);
+    fail_unless( Passed, "Lgm_McIlwain_L_Batch(): Results differ from Lgm_McIlwain_L()\n" );
+
+
+    return;
+}
+END_TEST
+
+START_TEST(test_MCILWAIN_10) {
+
+    int                 k, nGood, Passed = TRUE;
+    long int            Date;
+    double              K[8] = { 0.0, 0.01, 0.05, 0.1, 0.3, 0.6, 1.0, 10.0 };
+    double              Alpha[8], As, UTC;
+    Lgm_DateTime        d;
+    Lgm_Vector          u, v;
+
+    /*
+     *  Lgm_AlphaOfK_Batch() should agree with Lgm_AlphaOfK() called one K at
+     *  a time, including which K's have no pitch angle (the last one mirrors
+     *  below the loss cone height). Lgm_AlphaOfK() stops once its bracket is
+     *  down to 0.01 Deg., so that sets the tolerance.
+     */
+    Date = 20101012; UTC  = 0.0;
+    Lgm_Set_Coord_Transforms( Date, UTC, mInfo->c );
+    Lgm_Make_UTC( Date, UTC, &d, mInfo->c );
+    u.x = -4.2; u.y = 1.0; u.z = 1.0;
+    Lgm_Convert_Coords( &u, &v, SM_TO_GSM, mInfo->c );
+    Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_T89, mInfo );
+    mInfo->Kp = 4.;
+    if ( Lgm_Setup_AlphaOfK( &d, &v, mInfo ) <= 0 ) Passed = FALSE;
+
+    nGood = Lgm_AlphaOfK_Batch( 8, K, Alpha, mInfo );
+    for ( k=0; k<8; k++ ) {
+        As = Lgm_AlphaOfK( K[k], mInfo );
+        if ( ( ( As > 0.0 ) != ( Alpha[k] > 0.0 ) ) || ( ( As > 0.0 ) && ( fabs( Alpha[k]-As ) > 2e-2 ) ) ) {
+            printf("\nTest 10, Lgm_AlphaOfK_Batch(): K = %g  Alpha (batch) = %.15g   Alpha (single) = %.15g\n", K[k], Alpha[k], As );
+            Passed = FALSE;
+        }
+        if ( As > 0.0 ) --nGood;
+    }
+    if ( nGood != 0 ) Passed = FALSE;
+    Lgm_TearDown_AlphaOfK( mInfo );
+
+    fflush(stdout);
+    fail_unless( Passed, "Lgm_AlphaOfK_Batch(): Results differ from Lgm_AlphaOfK()\n" );
+
+
+    return;
+}
+END_TEST
+
 Suite *McIlwain_L_suite(void) {
 
   Suite *s = suite_create("MCILWAIN_L_TESTS");
@@ -465,6 +563,8 @@ Suite *McIlwain_L_suite(void) {
   tcase_add_test(tc_McIlwain_L, test_MCILWAIN_06);
   tcase_add_test(tc_McIlwain_L, test_MCILWAIN_07);
   tcase_add_test(tc_McIlwain_L, test_MCILWAIN_08);
+  tcase_add_test(tc_McIlwain_L, test_MCILWAIN_09);
+  tcase_add_test(tc_McIlwain_L, test_MCILWAIN_10);
 
   suite_add_tcase(s, tc_McIlwain_L);
 
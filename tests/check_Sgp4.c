@@ -1,5 +1,6 @@
 #include <check.h>
 #include "../libLanlGeoMag/Lgm/Lgm_Sgp.h"
+#include "../libLanlGeoMag/Lgm/Lgm_TleCatalog.h"
 #include <stdio.h>
 #include <stdlib.h>
 #define TRUE    1
@@ -117,6 +118,142 @@ END_TEST
 
 
 
+START_TEST(test_Sgp4_02) {
+
+    int             i, j, k, m, n, nSat, nTLEs, nRef, nFail = 0, Order[4] = { 0, 2, 1, 3 };
+    int             SatNum[100];
+    long int        iCat;
+    double          Day, JD, dx;
+    char            Line[5000], Line1[100][120], Line2[100][120], L0[120], L1[120], L2[120];
+    char            *TleFile = "check_Sgp4_02.tle", *CatFile = "check_Sgp4_02.cat";
+    FILE            *fp;
+    _SgpTLE         *Ref, TLE;
+    _SgpInfo        *s1, *s2;
+    Lgm_TleCatalog  *Cat;
+
+    /*
+     *  Build a catalog from the element sets in check_Sgp4_01.expected, each
+     *  with three more copies at earlier epochs (written out of order, plus
+     *  one element set with a bad checksum), and check that the catalog picks
+     *  the same TLE as LgmSgp_FindTLEforGivenTime() on the sorted list of that
+     *  object's TLEs, and that propagating it gives the same positions.
+     */
+    nSat = 0;
+    if ( (fp = fopen( "check_Sgp4_01.expected", "r" )) != NULL ) {
+        while ( ( fgets( Line, 4096, fp ) != NULL ) && ( nSat < 100 ) ) {
+            if ( ( Line[0] != '#' ) && ( strstr( Line, "xx" ) != NULL ) ) {
+                sscanf( Line, "%d xx", &SatNum[nSat] );
+                fgets( Line1[nSat], 100, fp ); Line1[nSat][69] = '\0';
+                fgets( Line2[nSat], 100, fp ); Line2[nSat][69] = '\0';
+                Day = atof( Line1[nSat]+20 );
+                for ( j=0; j<nSat; j++ ) if ( SatNum[j] == SatNum[nSat] ) break;
+                if ( ( j == nSat ) && ( Day > 5.0 ) && ( (int)(Line1[nSat][68]-'0') == LgmSgp_TleChecksum( Line1[nSat] ) )
+                        && ( (int)(Line2[nSat][68]-'0') == LgmSgp_TleChecksum( Line2[nSat] ) ) ) ++nSat;
+            }
+        }
+        fclose( fp );
+    } else {
+        printf("Cant open file: check_Sgp4_01.expected\n" );
+    }
+
+    fp = fopen( TleFile, "w" );
+    for ( m=0; m<4; m++ ) {
+        k = Order[m];
+        for ( i=0; i<nSat; i++ ) {
+            strcpy( L1, Line1[i] );
+            Day = atof( Line1[i]+20 ) - 1.25*k;
+            sprintf( Line, "%012.8lf", Day ); memcpy( L1+20, Line, 12 );
+            L1[68] = '0' + LgmSgp_TleChecksum( L1 );
+            fprintf( fp, "%d xx\n%s\n%s\n", SatNum[i], L1, Line2[i] );
+        }
+    }
+    strcpy( L1, Line1[0] ); L1[68] = '0' + ( LgmSgp_TleChecksum( L1 ) + 1 )%10;
+    fprintf( fp, "%s\n%s\n", L1, Line2[0] );
+    fclose( fp );
+
+    n = Lgm_TleCatalog_Build( CatFile, 1, &TleFile, 0 );
+    Cat = Lgm_TleCatalog_Open( CatFile, 0 );
+    if ( ( nSat < 10 ) || ( n != 4*nSat ) || ( Cat == NULL ) || ( Cat->nSat != nSat ) ) {
+        printf("Test 02: Lgm_TleCatalog_Build() wrote %d element sets (expected 4*%d)\n", n, nSat );
+        ++nFail;
+    } else {
+
+        Ref = (_SgpTLE *)calloc( 4, sizeof(_SgpTLE) );
+        s1  = (_SgpInfo *)calloc( 1, sizeof(_SgpInfo) );
+        s2  = (_SgpInfo *)calloc( 1, sizeof(_SgpInfo) );
+
+        for ( i=0; i<nSat; i++ ) {
+
+            nTLEs = 0;
+            for ( k=3; k>=0; k-- ) {
+                strcpy( L1, Line1[i] ); strcpy( L2, Line2[i] );
+                Day = atof( Line1[i]+20 ) - 1.25*k;
+                sprintf( Line, "%012.8lf", Day ); memcpy( L1+20, Line, 12 );
+                L1[68] = '0' + LgmSgp_TleChecksum( L1 );
+                sprintf( L0, "%d xx", SatNum[i] );
+                LgmSgp_ReadTlesFromStrings( L0, L1, L2, &nTLEs, Ref, 0 );
+            }
+            LgmSgp_SortListOfTLEs( nTLEs, Ref );
+
+            // Before the first epoch, and at times between (and after) the epochs.
+            if ( Lgm_TleCatalog_FindTLEforGivenTime( SatNum[i], Ref[0].JD - 0.1, Cat ) != -1 ) {
+                printf("Test 02: Object %d: found a TLE before the first epoch\n", SatNum[i] );
+                ++nFail;
+            }
+            // At exactly the last epoch the catalog takes the last TLE (LgmSgp_FindTLEforGivenTime() takes the one before).
+            iCat = Lgm_TleCatalog_FindTLEforGivenTime( SatNum[i], Ref[nTLEs-1].JD, Cat );
+            if ( ( iCat < 0 ) || !Lgm_TleCatalog_GetTLE( iCat, &TLE, Cat ) || ( fabs( TLE.JD - Ref[nTLEs-1].JD ) > 1e-9 ) ) {
+                printf("Test 02: Object %d: did not get the last TLE at its epoch\n", SatNum[i] );
+                ++nFail;
+            }
+            for ( j=0; j<16; j++ ) {
+
+                JD   = Ref[0].JD + 0.3*j + 0.01;
+                iCat = Lgm_TleCatalog_FindTLEforGivenTime( SatNum[i], JD, Cat );
+                nRef = ( JD < Ref[nTLEs-1].JD ) ? LgmSgp_FindTLEforGivenTime( nTLEs, Ref, 1, JD, 0 ) : nTLEs-1;
+                if ( ( iCat < 0 ) || !Lgm_TleCatalog_GetTLE( iCat, &TLE, Cat ) || ( nRef < 0 )
+                        || ( fabs( TLE.JD - Ref[nRef].JD ) > 1e-9 ) || strncmp( TLE.Line1, Ref[nRef].Line1, 69 ) || strncmp( TLE.Line2, Ref[nRef].Line2, 69 ) ) {
+                    printf("Test 02: Object %d, JD = %.5lf: catalog TLE %ld (JD = %.8lf), reference TLE %d (JD = %.8lf)\n", SatNum[i], JD, iCat, TLE.JD, nRef, Ref[nRef].JD );
+                    ++nFail;
+                    continue;
+                }
+
+                LgmSgp_SGP4_Init( s1, &TLE );        LgmSgp_SGP4( ( JD - TLE.JD )*1440.0, s1 );
+                LgmSgp_SGP4_Init( s2, &Ref[nRef] );  LgmSgp_SGP4( ( JD - Ref[nRef].JD )*1440.0, s2 );
+                dx = sqrt( (s1->X-s2->X)*(s1->X-s2->X) + (s1->Y-s2->Y)*(s1->Y-s2->Y) + (s1->Z-s2->Z)*(s1->Z-s2->Z) );
+                if ( ( s1->error != s2->error ) || ( ( s2->error == 0 ) && !( dx < 1e-6 ) ) ) {
+                    printf("Test 02: Object %d, JD = %.5lf: catalog position %g %g %g (error %d), reference %g %g %g (error %d)\n",
+                            SatNum[i], JD, s1->X, s1->Y, s1->Z, s1->error, s2->X, s2->Y, s2->Z, s2->error );
+                    ++nFail;
+                }
+
+            }
+
+        }
+
+        if ( Lgm_TleCatalog_FindTLEforGivenTime( 99999, Ref[0].JD, Cat ) != -1 ) {
+            printf("Test 02: Found a TLE for an object that is not in the catalog\n" );
+            ++nFail;
+        }
+
+        free( Ref );
+        free( s1 );
+        free( s2 );
+
+    }
+    Lgm_TleCatalog_Close( Cat );
+    remove( TleFile );
+    remove( CatFile );
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "Lgm_TleCatalog: TLEs differ from LgmSgp_FindTLEforGivenTime()\n" );
+
+    return;
+}
+END_TEST
+
+
+
 
 
 
@@ -129,6 +266,7 @@ Suite *Sgp4_suite(void) {
   //tcase_add_checked_fixture(tc_Sgp4, Sgp4_Setup, Sgp4_TearDown);
 
   tcase_add_test(tc_Sgp4, test_Sgp4_01);
+  tcase_add_test(tc_Sgp4, test_Sgp4_02);
 
   suite_add_tcase(s, tc_Sgp4);
 
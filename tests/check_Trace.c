@@ -0,0 +1,471 @@
+#include <check.h>
+#include "../libLanlGeoMag/Lgm/Lgm_MagModelInfo.h"
+#include "../libLanlGeoMag/Lgm/Lgm_GCTrace.h"
+
+/*
+ *  Tests for the field line tracing integrators
+ */
+
+
+Lgm_MagModelInfo    *mInfo;
+
+void Trace_Setup(void) {
+    mInfo = Lgm_InitMagInfo();
+    return;
+}
+
+void Trace_TearDown(void) {
+    Lgm_FreeMagInfo( mInfo );
+    return;
+}
+
+
+START_TEST(test_Trace_01) {
+
+    int                 k, Flag1, Flag2, Passed = TRUE;
+    long int            Date;
+    double              UTC, Bm, Sm1, Sm2;
+    Lgm_Vector          u[3], v, Bmin1, Bmin2, Mirror1, Mirror2, v1, v2, v3, w1, w2, w3;
+
+    /*
+     *  The Dormand-Prince integrator (with its dense output used for root
+     *  finding) should give the same footpoints, min-B points and mirror
+     *  points as the RK5 integrator to well within the tracing tolerances.
+     *  (The location of min-B is poorly constrained on the stretched
+     *  nightside field lines, so it gets a looser tolerance.)
+     */
+    Date = 20101012; UTC  = 0.0;
+    Lgm_Set_Coord_Transforms( Date, UTC, mInfo->c );
+    Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_T89, mInfo );
+    mInfo->Kp = 3;
+
+    u[0].x = -4.2; u[0].y = 1.0; u[0].z =  1.0;
+    u[1].x = -6.0; u[1].y = 0.0; u[1].z =  0.5;
+    u[2].x =  3.0; u[2].y = 2.0; u[2].z = -1.0;
+
+    for ( k=0; k<3; k++ ) {
+
+        Lgm_Convert_Coords( &u[k], &v, SM_TO_GSM, mInfo->c );
+
+        mInfo->Lgm_MagStep_Integrator = LGM_MAGSTEP_ODE_RK5;
+        Flag1 = Lgm_Trace( &v, &v1, &v2, &v3, 120.0, 1e-7, 1e-7, mInfo );
+        Bm = 2.0*mInfo->Bmin;
+        Lgm_TraceToMinBSurf( &v, &Bmin1, 0.1, 1e-7, mInfo );
+        Lgm_TraceToMirrorPoint( &Bmin1, &Mirror1, &Sm1, Bm, 1.0, 1e-7, mInfo );
+
+        mInfo->Lgm_MagStep_Integrator = LGM_MAGSTEP_ODE_DP5;
+        Flag2 = Lgm_Trace( &v, &w1, &w2, &w3, 120.0, 1e-7, 1e-7, mInfo );
+        Lgm_TraceToMinBSurf( &v, &Bmin2, 0.1, 1e-7, mInfo );
+        Lgm_TraceToMirrorPoint( &Bmin2, &Mirror2, &Sm2, Bm, 1.0, 1e-7, mInfo );
+
+        if (    ( Flag1 != Flag2 ) || ( Lgm_VecDiffMag( &v1, &w1 ) > 1e-5 ) || ( Lgm_VecDiffMag( &v2, &w2 ) > 1e-5 )
+             || ( Lgm_VecDiffMag( &v3, &w3 ) > 1e-3 ) || ( Lgm_VecDiffMag( &Bmin1, &Bmin2 ) > 1e-3 )
+             || ( Lgm_VecDiffMag( &Mirror1, &Mirror2 ) > 1e-4 ) || ( fabs( Sm1-Sm2 ) > 1e-3 ) ) {
+            printf("\nTest 01, start point %d: Flag (RK5, DP5) = %d %d\n", k, Flag1, Flag2 );
+            printf("    South footpoint: RK5 = %.10g %.10g %.10g   DP5 = %.10g %.10g %.10g\n", v1.x, v1.y, v1.z, w1.x, w1.y, w1.z );
+            printf("    North footpoint: RK5 = %.10g %.10g %.10g   DP5 = %.10g %.10g %.10g\n", v2.x, v2.y, v2.z, w2.x, w2.y, w2.z );
+            printf("    Min-B (Lgm_Trace): RK5 = %.10g %.10g %.10g   DP5 = %.10g %.10g %.10g\n", v3.x, v3.y, v3.z, w3.x, w3.y, w3.z );
+            printf("    Min-B (Lgm_TraceToMinBSurf): RK5 = %.10g %.10g %.10g   DP5 = %.10g %.10g %.10g\n", Bmin1.x, Bmin1.y, Bmin1.z, Bmin2.x, Bmin2.y, Bmin2.z );
+            printf("    Mirror point: RK5 = %.10g %.10g %.10g (Sm = %.10g)  DP5 = %.10g %.10g %.10g (Sm = %.10g)\n", Mirror1.x, Mirror1.y, Mirror1.z, Sm1, Mirror2.x, Mirror2.y, Mirror2.z, Sm2 );
+            Passed = FALSE;
+        }
+
+    }
+
+    fflush(stdout);
+    fail_unless( Passed, "LGM_MAGSTEP_ODE_DP5: Results differ from LGM_MAGSTEP_ODE_RK5\n" );
+
+
+    return;
+}
+END_TEST
+
+START_TEST(test_Trace_02) {
+
+    int                 j, k, nCross, nFail = 0;
+    double              L[4] = { 3.0, 4.0, 5.0, 6.0 }, T[4] = { 0.5, 1.0, 2.0, 0.1 }, Alpha[4] = { 90.0, 90.0, 90.0, 40.0 };
+    double              t1 = 20.0, dt = 0.05, pv, Omega, Phi, dPhi, r, Lat, B0, B, Bm0, BoverBm, MaxBoverBm, MinBoverBm, zPrev;
+    double              Beta, Gamma, Tb, SinA;
+    Lgm_Vector          u, v, Bvec;
+    Lgm_GCParticle      p[4];
+    Lgm_GCTraceInfo     g;
+
+    /*
+     *  Electrons in a centered dipole. An equatorially mirroring particle
+     *  stays on its circle and gradient drifts (westward for protons,
+     *  eastward for electrons) with angular speed
+     *
+     *      Omega = 3 p v L / ( 2 |q| B0 Re^2 )
+     *
+     *  A bouncing particle stays on its L shell (r/cos^2(Lat) = L) between
+     *  its mirror points (B <= Bm), keeps mu = p^2/(2 m0 Bm) and crosses the
+     *  equator twice per bounce period, which in a dipole is (to about 0.5%,
+     *  Schulz and Lanzerotti, 1974)
+     *
+     *      Tb = 4 L Re/v ( 1.3802 - 0.3198 ( y + sqrt(y) ) ),  y = sin(Alpha_eq)
+     *
+     *  The particles are advanced in short increments so that the bouncing
+     *  one can be followed.
+     */
+    Lgm_Set_Coord_Transforms( 20120601, 0.0, mInfo->c );
+    Lgm_MagModelInfo_Set_MagModel( LGM_CDIP, LGM_EXTMODEL_NULL, mInfo );
+    B0 = mInfo->c->M_cd;
+
+    Lgm_GCTrace_Defaults( &g );
+    g.Tol = 1e-8;
+    for ( k=0; k<4; k++ ) {
+        Phi = 30.0*k*RadPerDeg;
+        u.x = L[k]*cos( Phi ); u.y = L[k]*sin( Phi ); u.z = 0.0;
+        Lgm_Convert_Coords( &u, &v, SM_TO_GSM, mInfo->c );
+        Lgm_GCTrace_InitParticle( &p[k], k, &v, T[k], Alpha[k], -LGM_e, LGM_Ee0, mInfo );
+    }
+    Bm0 = p[3].Bm;
+
+    nCross = 0; zPrev = 0.0;
+    MaxBoverBm = 0.0; MinBoverBm = 1.0;
+    for ( j=1; j<=(int)( t1/dt + 0.5 ); j++ ) {
+        Lgm_GCTrace_Advance( p, 4, ( j*dt < t1 ) ? j*dt : t1, &g, mInfo );
+        mInfo->Bfield( &p[3].u, &Bvec, mInfo );
+        B = Lgm_Magnitude( &Bvec );
+        BoverBm = B/p[3].Bm;
+        if ( BoverBm > MaxBoverBm ) MaxBoverBm = BoverBm;
+        if ( BoverBm < MinBoverBm ) MinBoverBm = BoverBm;
+        Lgm_Convert_Coords( &p[3].u, &u, GSM_TO_SM, mInfo->c );
+        if ( ( j > 1 ) && ( u.z*zPrev < 0.0 ) ) ++nCross;
+        zPrev = u.z;
+    }
+
+    for ( k=0; k<4; k++ ) {
+
+        Lgm_Convert_Coords( &p[k].u, &u, GSM_TO_SM, mInfo->c );
+        r   = Lgm_Magnitude( &u );
+        Lat = asin( u.z/r );
+        Phi = atan2( u.y, u.x );
+
+        if ( ( p[k].Status != LGM_GC_ACTIVE ) || ( fabs( p[k].t - t1 ) > 1e-9 ) || ( fabs( r/(cos( Lat )*cos( Lat )) - L[k] ) > 1e-4 ) ) {
+            printf("Test 02: particle %d: Status = %d t = %.10g L = %.10g (expected %g)\n", k, p[k].Status, p[k].t, r/(cos( Lat )*cos( Lat )), L[k] );
+            ++nFail;
+        }
+
+        if ( Alpha[k] == 90.0 ) {
+            pv    = T[k]*( T[k] + 2.0*LGM_Ee0 )/( T[k] + LGM_Ee0 )*1e6*LGM_e;
+            Omega = 3.0*pv*L[k]/( 2.0*LGM_e*B0*1e-9*Re*Re*1e6 );
+            dPhi  = fmod( Phi - 30.0*k*RadPerDeg - Omega*t1, 2.0*M_PI );
+            if ( dPhi < -M_PI ) dPhi += 2.0*M_PI;
+            if ( dPhi >  M_PI ) dPhi -= 2.0*M_PI;
+            if ( ( fabs( dPhi ) > 1e-4*Omega*t1 ) || ( fabs( u.z ) > 1e-6 ) ) {
+                printf("Test 02: particle %d: drift phase error = %.10g rad (analytic drift %.10g rad), z_sm = %g\n", k, dPhi, Omega*t1, u.z );
+                ++nFail;
+            }
+        } else {
+            SinA  = sin( Alpha[k]*RadPerDeg );
+            Gamma = 1.0 + T[k]/LGM_Ee0;
+            Beta  = sqrt( 1.0 - 1.0/(Gamma*Gamma) );
+            Tb    = 4.0*L[k]*Re*1e3/( Beta*LGM_c )*( 1.3802 - 0.3198*( SinA + sqrt( SinA ) ) );
+            printf("Test 02: particle %d: B/Bm in [%.6g, %.6g] (expected [%.6g, 1]), %d equator crossings (expected %.4g), Bm/Bm0 = %.10g\n", k, MinBoverBm, MaxBoverBm, SinA*SinA, nCross, 2.0*t1/Tb, p[k].Bm/Bm0 );
+            if ( ( MaxBoverBm > 1.0 + g.MirrorTol ) || ( MaxBoverBm < 0.9 ) || ( fabs( MinBoverBm - SinA*SinA ) > 0.02 ) ) {
+                printf("Test 02: particle %d: does not bounce between its mirror points\n", k );
+                ++nFail;
+            }
+            if ( fabs( nCross - 2.0*t1/Tb ) > 1.0 ) {
+                printf("Test 02: particle %d: bounce period does not match the dipole bounce period\n", k );
+                ++nFail;
+            }
+            if ( ( fabs( p[k].Bm/Bm0 - 1.0 ) > 10.0*g.MirrorTol ) || ( fabs( p[k].Mu*p[k].Bm*2.0*p[k].E0/( p[k].T*( p[k].T + 2.0*p[k].E0 ) ) - 1.0 ) > 1e-12 ) ) {
+                printf("Test 02: particle %d: Bm = %.10g Mu = %.10g (expected Bm = %.10g and Mu = p^2/(2 m0 Bm))\n", k, p[k].Bm, p[k].Mu, Bm0 );
+                ++nFail;
+            }
+        }
+
+    }
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "Lgm_GCTrace: Results differ from the analytic dipole drifts\n" );
+
+    return;
+}
+END_TEST
+
+
+START_TEST(test_Trace_03) {
+
+    int                 k, nFail = 0;
+    long int            n, nFrames;
+    double              T[4] = { 0.5, 1.0, 0.1, 0.3 }, Alpha[4] = { 90.0, 60.0, 40.0, 120.0 }, t, tc;
+    Lgm_Vector          u, v;
+    Lgm_GCParticle      p[4], q[4], *f, *c;
+    Lgm_GCTraceInfo     g;
+    FILE                *fp;
+    char                *FrameFile = "check_Trace_03.frames", *CheckFile = "check_Trace_03.chk";
+
+    /*
+     *  Streaming output and checkpoints. A run writes a frame per increment
+     *  that must read back exactly as the particles stood at that time, and
+     *  a run restarted from a checkpoint must end up bit for bit where an
+     *  uninterrupted run does (all of a particle's tracing state is in its
+     *  Lgm_GCParticle).
+     */
+    Lgm_Set_Coord_Transforms( 20120601, 0.0, mInfo->c );
+    Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_T89, mInfo );
+    mInfo->Kp = 2;
+
+    Lgm_GCTrace_Defaults( &g );
+    for ( k=0; k<4; k++ ) {
+        u.x = -(4.0+k)*cos( 0.3*k ); u.y = (4.0+k)*sin( 0.3*k ); u.z = 0.0;
+        Lgm_Convert_Coords( &u, &v, SM_TO_GSM, mInfo->c );
+        Lgm_GCTrace_InitParticle( &p[k], k, &v, T[k], Alpha[k], -LGM_e, LGM_Ee0, mInfo );
+    }
+    memcpy( q, p, sizeof(p) );
+
+    // Uninterrupted run, 0 to 8 s, with a frame every 2 s.
+    fp = fopen( FrameFile, "wb" );
+    if ( Lgm_GCTrace_Run( p, 4, 0.0, 8.0, 2.0, fp, (char *)NULL, 1, &g, mInfo ) != 4 ) {
+        printf("Test 03: Not all particles were still active after the uninterrupted run\n");
+        ++nFail;
+    }
+    fclose( fp );
+
+    fp = fopen( FrameFile, "rb" );
+    for ( nFrames=0; ( f = Lgm_GCTrace_ReadFrame( fp, &n, &t ) ) != NULL; nFrames++ ) {
+        if ( ( n != 4 ) || ( fabs( t - 2.0*(nFrames+1) ) > 1e-12 ) ) {
+            printf("Test 03: Frame %ld: n = %ld t = %g (expected 4 and %g)\n", nFrames, n, t, 2.0*(nFrames+1) );
+            ++nFail;
+        }
+        for ( k=0; k<n; k++ ) {
+            if ( f[k].t != t ) {
+                printf("Test 03: Frame %ld: particle %d is at t = %.10g (frame t = %g)\n", nFrames, k, f[k].t, t );
+                ++nFail;
+            }
+        }
+        if ( ( nFrames == 3 ) && ( memcmp( f, p, sizeof(p) ) != 0 ) ) {
+            printf("Test 03: Last frame differs from the particles at the end of the run\n");
+            ++nFail;
+        }
+        free( f );
+    }
+    fclose( fp );
+    if ( nFrames != 4 ) {
+        printf("Test 03: Read %ld frames (expected 4)\n", nFrames );
+        ++nFail;
+    }
+
+    // Interrupted run, 0 to 4 s checkpointing every 2 s, then restarted to 8 s.
+    if ( Lgm_GCTrace_Run( q, 4, 0.0, 4.0, 2.0, (FILE *)NULL, CheckFile, 1, &g, mInfo ) < 0 ) {
+        printf("Test 03: Lgm_GCTrace_Run() could not write the checkpoint\n");
+        ++nFail;
+    }
+    c = Lgm_GCTrace_ReadCheckpoint( CheckFile, &n, &tc );
+    if ( ( c == NULL ) || ( n != 4 ) || ( tc != 4.0 ) || ( memcmp( c, q, sizeof(q) ) != 0 ) ) {
+        printf("Test 03: Checkpoint does not hold the particles at t = 4 s (n = %ld, t = %g)\n", n, tc );
+        ++nFail;
+    } else {
+        Lgm_GCTrace_Run( c, n, tc, 8.0, 2.0, (FILE *)NULL, (char *)NULL, 1, &g, mInfo );
+        for ( k=0; k<4; k++ ) {
+            if ( memcmp( &c[k], &p[k], sizeof(Lgm_GCParticle) ) != 0 ) {
+                printf("Test 03: particle %d: restarted run ends at u = %.15g %.15g %.15g t = %.15g, uninterrupted run at u = %.15g %.15g %.15g t = %.15g\n",
+                        k, c[k].u.x, c[k].u.y, c[k].u.z, c[k].t, p[k].u.x, p[k].u.y, p[k].u.z, p[k].t );
+                ++nFail;
+            }
+        }
+    }
+    free( c );
+
+    // A file that is not a frame must be refused.
+    fp = fopen( FrameFile, "wb" );
+    fprintf( fp, "This is not a frame of particles" );
+    fclose( fp );
+    if ( ( f = Lgm_GCTrace_ReadCheckpoint( FrameFile, &n, &t ) ) != NULL ) {
+        printf("Test 03: A file that is not a frame was read as %ld particles\n", n );
+        free( f );
+        ++nFail;
+    }
+
+    remove( FrameFile );
+    remove( CheckFile );
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "Lgm_GCTrace: Frames, checkpoints or restarts are not exact\n" );
+
+    return;
+}
+END_TEST
+
+
+/*
+ *  A B-field that fails on one chosen call (and counts the calls).
+ */
+static int     FailingB_nCalls, FailingB_FailCall;
+static int   (*FailingB_Bfield)( Lgm_Vector *, Lgm_Vector *, Lgm_MagModelInfo * );
+
+static int FailingB( Lgm_Vector *v, Lgm_Vector *B, Lgm_MagModelInfo *Info ) {
+    if ( ++FailingB_nCalls == FailingB_FailCall ) {
+        B->x = B->y = B->z = 0.0;
+        return( 0 );
+    }
+    return( FailingB_Bfield( v, B, Info ) );
+}
+
+START_TEST(test_Trace_04) {
+
+    int                 j, n, nCalls, Flag, Flag0, nFail = 0;
+    double              Bm, Sm, Sm0;
+    Lgm_Vector          u, v, Bvec, Bmin, Bmin0, Mirror, Mirror0;
+
+    /*
+     *  With DP5, a B-field failure while root finding on the dense output
+     *  must not be taken as a B value. The search has to fall back to
+     *  stepping (and get the same answer) or report the failure. Fail each
+     *  of the last few calls in turn; these are the dense output evaluations
+     *  and the B-field evaluations of the last steps.
+     */
+    Lgm_Set_Coord_Transforms( 20101012, 0.0, mInfo->c );
+    Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_T89, mInfo );
+    mInfo->Kp = 3;
+    mInfo->Lgm_MagStep_Integrator = LGM_MAGSTEP_ODE_DP5;
+    FailingB_Bfield = mInfo->Bfield;
+    mInfo->Bfield   = FailingB;
+
+    u.x = -4.2; u.y = 1.0; u.z = 1.0;
+    Lgm_Convert_Coords( &u, &v, SM_TO_GSM, mInfo->c );
+
+    FailingB_nCalls = 0; FailingB_FailCall = -1;
+    Lgm_TraceToMinBSurf( &v, &Bmin0, 0.1, 1e-7, mInfo );
+    nCalls = FailingB_nCalls;
+    for ( j=0; j<16; j++ ) {
+        FailingB_nCalls = 0; FailingB_FailCall = nCalls - j;
+        Flag = Lgm_TraceToMinBSurf( &v, &Bmin, 0.1, 1e-7, mInfo );
+        if ( ( j == 0 ) && ( FailingB_nCalls <= nCalls ) ) {
+            printf("Test 04: Lgm_TraceToMinBSurf() did not fall back to stepping when its last dense output evaluation failed\n");
+            ++nFail;
+        }
+        if ( ( Flag > 0 ) && ( Lgm_VecDiffMag( &Bmin, &Bmin0 ) > 1e-3 ) ) {
+            printf("Test 04: Lgm_TraceToMinBSurf() with call %d of %d failing: Bmin = %.10g %.10g %.10g (expected %.10g %.10g %.10g)\n",
+                    nCalls-j, nCalls, Bmin.x, Bmin.y, Bmin.z, Bmin0.x, Bmin0.y, Bmin0.z );
+            ++nFail;
+        }
+    }
+
+    FailingB_Bfield( &Bmin0, &Bvec, mInfo );
+    Bm = 2.0*Lgm_Magnitude( &Bvec );
+    FailingB_nCalls = 0; FailingB_FailCall = -1;
+    Flag0 = Lgm_TraceToMirrorPoint( &Bmin0, &Mirror0, &Sm0, Bm, 1.0, 1e-7, mInfo );
+    nCalls = FailingB_nCalls;
+    for ( n=j=0; j<16; j++ ) {
+        FailingB_nCalls = 0; FailingB_FailCall = nCalls - j;
+        Flag = Lgm_TraceToMirrorPoint( &Bmin0, &Mirror, &Sm, Bm, 1.0, 1e-7, mInfo );
+        if ( ( j == 0 ) && ( FailingB_nCalls <= nCalls ) ) {
+            printf("Test 04: Lgm_TraceToMirrorPoint() did not fall back to stepping when its last dense output evaluation failed\n");
+            ++nFail;
+        }
+        if ( Flag == Flag0 ) ++n;
+        if ( ( Flag > 0 ) && ( ( Lgm_VecDiffMag( &Mirror, &Mirror0 ) > 1e-4 ) || ( fabs( Sm-Sm0 ) > 1e-3 ) ) ) {
+            printf("Test 04: Lgm_TraceToMirrorPoint() with call %d of %d failing: Mirror = %.10g %.10g %.10g Sm = %.10g (expected %.10g %.10g %.10g Sm = %.10g)\n",
+                    nCalls-j, nCalls, Mirror.x, Mirror.y, Mirror.z, Sm, Mirror0.x, Mirror0.y, Mirror0.z, Sm0 );
+            ++nFail;
+        }
+    }
+    if ( ( Flag0 <= 0 ) || ( n == 0 ) ) {
+        printf("Test 04: Lgm_TraceToMirrorPoint() did not recover from any failure (Flag0 = %d)\n", Flag0 );
+        ++nFail;
+    }
+
+    mInfo->Bfield = FailingB_Bfield;
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "LGM_MAGSTEP_ODE_DP5: B-field failures during dense output root finding were not handled\n" );
+
+    return;
+}
+END_TEST
+
+
+START_TEST(test_Trace_05) {
+
+    int                 k, Flag, nFail = 0;
+    double              Bm, Sm, S;
+    Lgm_Vector          u[3], v, w, Bvec, Bmin, Mirror;
+    Lgm_TraceEvent      e;
+
+    /*
+     *  Events located by Lgm_TraceWithEvents() must agree with the
+     *  specialized routines: the |B| = Bm crossing with the mirror point from
+     *  Lgm_TraceToMirrorPoint(), and the d|B|/ds = 0 crossing (tracing back
+     *  from that mirror point) with the minimum from Lgm_TraceToMinBSurf().
+     *  As in test 01, the min-B location gets the looser tolerance.
+     */
+    Lgm_Set_Coord_Transforms( 20101012, 0.0, mInfo->c );
+    Lgm_MagModelInfo_Set_MagModel( LGM_IGRF, LGM_EXTMODEL_T89, mInfo );
+    mInfo->Kp = 3;
+    mInfo->Lgm_MagStep_Integrator = LGM_MAGSTEP_ODE_DP5;
+
+    u[0].x = -4.2; u[0].y = 1.0; u[0].z =  1.0;
+    u[1].x = -6.0; u[1].y = 0.0; u[1].z =  0.5;
+    u[2].x =  3.0; u[2].y = 2.0; u[2].z = -1.0;
+
+    for ( k=0; k<3; k++ ) {
+
+        Lgm_Convert_Coords( &u[k], &v, SM_TO_GSM, mInfo->c );
+        Lgm_TraceToMinBSurf( &v, &Bmin, 0.1, 1e-7, mInfo );
+        mInfo->Bfield( &Bmin, &Bvec, mInfo );
+        Bm = 2.0*Lgm_Magnitude( &Bvec );
+        Lgm_TraceToMirrorPoint( &Bmin, &Mirror, &Sm, Bm, 1.0, 1e-7, mInfo );
+
+        e.Func = Lgm_TraceEvent_BminusBm; e.Val = Bm; e.Direction = 1; e.Terminal = TRUE;
+        Flag = Lgm_TraceWithEvents( &Bmin, &w, &S, 1.0, 20.0, &e, 1, 1e-7, mInfo );
+        if ( ( Flag != 1 ) || !e.Found || ( Lgm_VecDiffMag( &w, &Mirror ) > 1e-5 ) || ( fabs( S-Sm ) > 1e-5 ) ) {
+            printf("Test 05, start point %d: |B| = Bm event: Flag = %d P = %.10g %.10g %.10g S = %.10g   Lgm_TraceToMirrorPoint(): P = %.10g %.10g %.10g S = %.10g\n",
+                    k, Flag, w.x, w.y, w.z, S, Mirror.x, Mirror.y, Mirror.z, Sm );
+            ++nFail;
+        }
+
+        e.Func = Lgm_TraceEvent_dBds; e.Val = 0.0; e.Direction = 0; e.Terminal = TRUE;
+        Flag = Lgm_TraceWithEvents( &Mirror, &w, &S, -1.0, 20.0, &e, 1, 1e-7, mInfo );
+        if ( ( Flag != 1 ) || !e.Found || ( Lgm_VecDiffMag( &w, &Bmin ) > 1e-3 ) || ( fabs( S-Sm ) > 1e-3 ) ) {
+            printf("Test 05, start point %d: d|B|/ds = 0 event: Flag = %d P = %.10g %.10g %.10g S = %.10g   Lgm_TraceToMinBSurf(): P = %.10g %.10g %.10g S = %.10g\n",
+                    k, Flag, w.x, w.y, w.z, S, Bmin.x, Bmin.y, Bmin.z, Sm );
+            ++nFail;
+        }
+
+    }
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "Lgm_TraceWithEvents: Events differ from Lgm_TraceToMirrorPoint()/Lgm_TraceToMinBSurf()\n" );
+
+    return;
+}
+END_TEST
+
+
+Suite *Trace_suite(void) {
+
+  Suite *s = suite_create("TRACE_TESTS");
+
+  TCase *tc_Trace = tcase_create("Field Line Tracing");
+  tcase_add_checked_fixture(tc_Trace, Trace_Setup, Trace_TearDown);
+
+  tcase_add_test(tc_Trace, test_Trace_01);
+  tcase_add_test(tc_Trace, test_Trace_02);
+  tcase_add_test(tc_Trace, test_Trace_03);
+  tcase_add_test(tc_Trace, test_Trace_04);
+  tcase_add_test(tc_Trace, test_Trace_05);
+
+  suite_add_tcase(s, tc_Trace);
+
+  return s;
+
+}
+
+int main(void) {
+
+    int      number_failed;
+    Suite   *s  = Trace_suite();
+    SRunner *sr = srunner_create(s);
+
+    printf("\n\n");
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
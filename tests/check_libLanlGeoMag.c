@@ -1,5 +1,7 @@
 #include <check.h>
 #include "../libLanlGeoMag/Lgm/Lgm_CTrans.h"
+#include "../libLanlGeoMag/Lgm/Lgm_Eop.h"
+#include "../libLanlGeoMag/Lgm/Lgm_DynamicMemory.h"
 
 #define TRUE    1
 #define FALSE   0
@@ -53,7 +55,203 @@ START_TEST(test_GetLeapSeconds) {
     ck_assert_msg( n_leap == 34.0, "Should be 34 leap seconds by 2009/6/1, not %f", n_leap);
   return;
 }
-END_TEST // END Leap seconds test case
+END_TEST
+
+
+/*
+ *  Reference (linear scan) versions of the table lookups.
+ */
+static int LeapSecondIndex_Scan( double JD, Lgm_LeapSeconds *l ) {
+    int i, k = -1;
+    for ( i=0; i<l->nLeapSecondDates; i++ ) if ( JD >= l->LeapSecondJDs[i] ) k = i;
+    return( k );
+}
+
+static int IsLeapSecondDay_Scan( long int Date, Lgm_LeapSeconds *l ) {
+    int i;
+    for ( i=0; i<l->nLeapSecondDates; i++ ) if ( Date == l->LeapSecondDates[i] ) return( 1 );
+    return( 0 );
+}
+
+static long int EopIndex_Scan( double MJD, Lgm_Eop *e ) {
+    long int i, k = 0;
+    for ( i=0; i<e->nEopVals; i++ ) if ( MJD >= e->MJD[i] ) k = i;
+    return( k );
+}
+
+
+START_TEST(test_LeapSecondIndex) {
+
+    int         i, j, k, nBad = 0;
+    double      JD;
+    Lgm_CTrans  *c2;
+
+    printf("Check that Lgm_LeapSecondIndex() agrees with a linear scan of the leap second table\n");
+
+    /*
+     *  Sweep forward and backward (hint is useful) and then jump around (hint
+     *  is useless), including exactly on and just either side of each date.
+     */
+    for ( JD = 2435000.0; JD < 2462000.0; JD += 7.3 ) {
+        if ( Lgm_LeapSecondIndex( JD, &c->l ) != LeapSecondIndex_Scan( JD, &c->l ) ) ++nBad;
+    }
+    for ( JD = 2462000.0; JD > 2435000.0; JD -= 11.9 ) {
+        if ( Lgm_LeapSecondIndex( JD, &c->l ) != LeapSecondIndex_Scan( JD, &c->l ) ) ++nBad;
+    }
+    for ( i=0; i<c->l.nLeapSecondDates; i++ ) {
+        for ( j=-1; j<=1; j++ ) {
+            k  = (7*i+3) % c->l.nLeapSecondDates;
+            JD = c->l.LeapSecondJDs[k] + j*1e-6;
+            if ( Lgm_LeapSecondIndex( JD, &c->l ) != LeapSecondIndex_Scan( JD, &c->l ) ) ++nBad;
+            if ( ( JD >= c->l.LeapSecondJDs[0] ) && ( Lgm_GetLeapSeconds( JD, c ) != c->l.LeapSeconds[ LeapSecondIndex_Scan( JD, &c->l ) ] ) ) ++nBad;
+        }
+    }
+    ck_assert_msg( nBad == 0, "Lgm_LeapSecondIndex()/Lgm_GetLeapSeconds() disagree with a linear scan in %d cases", nBad );
+
+    /*
+     *  Every Lgm_CTrans should point at the same (process-wide) table.
+     */
+    c2 = Lgm_init_ctrans( 0 );
+    ck_assert_msg( (c2->l.LeapSecondJDs == c->l.LeapSecondJDs) && (c2->l.nLeapSecondDates == c->l.nLeapSecondDates), "Leap second table is not shared between Lgm_CTrans structures" );
+    Lgm_free_ctrans( c2 );
+
+    return;
+}
+END_TEST
+
+
+START_TEST(test_IsLeapSecondDay_03) {
+
+    int         i, Result, nBad = 0;
+    long int    Date;
+    double      sec_in_day;
+
+    printf("Check Lgm_IsLeapSecondDay() on every date in the leap second table and the days either side\n");
+    for ( i=0; i<c->l.nLeapSecondDates; i++ ) {
+        for ( Date = c->l.LeapSecondDates[i]-1; Date <= c->l.LeapSecondDates[i]+1; Date++ ) {
+            Result = Lgm_IsLeapSecondDay( Date, &sec_in_day, c );
+            if ( Result != IsLeapSecondDay_Scan( Date, &c->l ) ) ++nBad;
+            if ( !Result && (sec_in_day != 86400.0) ) ++nBad;
+        }
+    }
+    ck_assert_msg( nBad == 0, "Lgm_IsLeapSecondDay() gave the wrong answer in %d cases", nBad );
+
+    return;
+}
+END_TEST
+
+
+START_TEST(test_EopIndex) {
+
+    long int    i, nBad = 0;
+    double      MJD;
+    Lgm_Eop     *e = (Lgm_Eop *)calloc( 1, sizeof(Lgm_Eop) );
+
+    printf("Check that Lgm_EopIndex() agrees with a linear scan of the EOP table\n");
+
+    /*
+     *  A synthetic table with daily values and a few gaps.
+     */
+    e->nEopVals = 2000;
+    e->MJD      = (double *)calloc( e->nEopVals, sizeof(double) );
+    e->Hint     = -1;
+    e->MJD[0]   = 37665.0;
+    for ( i=1; i<e->nEopVals; i++ ) e->MJD[i] = e->MJD[i-1] + ( (i%97 == 0) ? 5.0 : 1.0 );
+
+    for ( MJD = 37600.0; MJD < e->MJD[e->nEopVals-1]+100.0; MJD += 0.37 ) {
+        if ( Lgm_EopIndex( MJD, e ) != EopIndex_Scan( MJD, e ) ) ++nBad;
+    }
+    for ( i=0; i<e->nEopVals; i++ ) {
+        MJD = e->MJD[ (i*613) % e->nEopVals ];
+        if ( Lgm_EopIndex( MJD, e ) != EopIndex_Scan( MJD, e ) ) ++nBad;
+        if ( Lgm_EopIndex( MJD-1e-7, e ) != EopIndex_Scan( MJD-1e-7, e ) ) ++nBad;
+    }
+    ck_assert_msg( nBad == 0, "Lgm_EopIndex() disagrees with a linear scan in %ld cases", nBad );
+
+    free( e->MJD );
+    free( e );
+
+    return;
+}
+END_TEST
+// END Leap seconds test case
+
+
+/*BEGIN Time conversion test case*/
+START_TEST(test_ConvertTimeArray) {
+
+    long int        i, n = 0, nBad = 0;
+    long int        Date;
+    int             Year, Month, Day;
+    double          *UTC_JD, *Ref, *TAI, *GPS, *TT, *TDB, *UTC2, Time, UT, dMax[5];
+    Lgm_DateTime    UTC;
+
+    printf("Check Lgm_ConvertTimeArray() against the scalar time conversion routines\n");
+
+    /*
+     *  UTC times spread over 1975-2020, plus a 0.5s sweep across the leap
+     *  second at the end of 2016.
+     */
+    UTC_JD = (double *)calloc( 3000, sizeof(double) );
+    Ref    = (double *)calloc( 4*3000, sizeof(double) );
+    for ( i=0; i<2000+42; i++ ) {
+        if ( i < 2000 ) {
+            Date = Lgm_JD_to_Date( 2442413.5 + i*8.2191, &Year, &Month, &Day, &UT );
+            Time = fmod( i*1.37, 24.0 );
+        } else {
+            // 2016-12-31 23:59:50 to 2017-01-01 00:00:10 (23:59:60 is Time = 24.0)
+            Date = 20161231;
+            Time = 24.0 + (i-2000-20)*0.5/3600.0;
+            if ( Time >= 24.0 + 1.0/3600.0 ) { Date = 20170101; Time -= 24.0 + 1.0/3600.0; }
+        }
+        Lgm_Make_UTC( Date, Time, &UTC, c );
+        UTC_JD[n] = UTC.JD;
+        Ref[4*n]   = Lgm_UTC_to_TaiSeconds( &UTC, c );
+        Ref[4*n+1] = Lgm_UTC_to_GpsSeconds( &UTC, c );
+        Ref[4*n+2] = Lgm_UTC_to_TTSecSinceJ2000( &UTC, c );
+        Ref[4*n+3] = Lgm_UTC_to_TdbSecSinceJ2000( &UTC, c );
+        ++n;
+    }
+
+    TAI  = (double *)calloc( n, sizeof(double) );
+    GPS  = (double *)calloc( n, sizeof(double) );
+    TT   = (double *)calloc( n, sizeof(double) );
+    TDB  = (double *)calloc( n, sizeof(double) );
+    UTC2 = (double *)calloc( n, sizeof(double) );
+    Lgm_ConvertTimeArray( n, UTC_JD, LGM_TIME_SYS_UTC, LGM_TIME_JD, TAI, LGM_TIME_SYS_TAI, LGM_TIME_SECONDS, c );
+    Lgm_ConvertTimeArray( n, UTC_JD, LGM_TIME_SYS_UTC, LGM_TIME_JD, GPS, LGM_TIME_SYS_GPS, LGM_TIME_SECONDS, c );
+    Lgm_ConvertTimeArray( n, UTC_JD, LGM_TIME_SYS_UTC, LGM_TIME_JD, TT,  LGM_TIME_SYS_TT,  LGM_TIME_SECONDS, c );
+    Lgm_ConvertTimeArray( n, UTC_JD, LGM_TIME_SYS_UTC, LGM_TIME_JD, TDB, LGM_TIME_SYS_TDB, LGM_TIME_SECONDS, c );
+
+    /*
+     *  The scalar routines work from Date and Time, while the array routine
+     *  gets JDs, which only resolve ~4e-5 s at these dates.
+     */
+    dMax[0] = dMax[1] = dMax[2] = dMax[3] = dMax[4] = 0.0;
+    for ( i=0; i<n; i++ ) {
+        dMax[0] = fmax( dMax[0], fabs( TAI[i] - Ref[4*i] ) );
+        dMax[1] = fmax( dMax[1], fabs( GPS[i] - Ref[4*i+1] ) );
+        dMax[2] = fmax( dMax[2], fabs( TT[i]  - Ref[4*i+2] ) );
+        dMax[3] = fmax( dMax[3], fabs( TDB[i] - Ref[4*i+3] ) );
+    }
+
+    /*
+     *  And the conversions back to UTC should recover the original JDs.
+     */
+    Lgm_ConvertTimeArray( n, TAI, LGM_TIME_SYS_TAI, LGM_TIME_SECONDS, UTC2, LGM_TIME_SYS_UTC, LGM_TIME_JD, c );
+    for ( i=0; i<n; i++ ) dMax[4] = fmax( dMax[4], fabs( UTC2[i] - UTC_JD[i] )*86400.0 );
+    Lgm_ConvertTimeArray( n, TDB, LGM_TIME_SYS_TDB, LGM_TIME_SECONDS, UTC2, LGM_TIME_SYS_UTC, LGM_TIME_JD, c );
+    for ( i=0; i<n; i++ ) dMax[4] = fmax( dMax[4], fabs( UTC2[i] - UTC_JD[i] )*86400.0 );
+
+    for ( i=0; i<5; i++ ) if ( dMax[i] > 5e-5 ) ++nBad;
+    if ( nBad ) printf("    Max differences (s): TAI %g  GPS %g  TT %g  TDB %g  UTC round trip %g\n", dMax[0], dMax[1], dMax[2], dMax[3], dMax[4] );
+    ck_assert_msg( nBad == 0, "Lgm_ConvertTimeArray() disagrees with the scalar routines" );
+
+    free( UTC_JD ); free( Ref ); free( TAI ); free( GPS ); free( TT ); free( TDB ); free( UTC2 );
+
+    return;
+}
+END_TEST // END Time conversion test case
 
 
 
@@ -101,6 +299,128 @@ END_TEST
 
 
 
+START_TEST(test_Arena_01) {
+
+    int             i, j, nFail = 0;
+    double          **A, *H, *H2, ***B, *C, *D;
+    Lgm_Arena       *a, *Prev;
+    Lgm_ArenaMark   Mark;
+    Lgm_HeapStats   h0, h1;
+    size_t          InUse;
+
+    /*
+     *  Binding and unbinding an arena, and freeing heap and arena arrays
+     *  with and without an arena bound (and after it is destroyed).
+     */
+    LGM_ARRAY_1D( H2, 100, double );     // (before instrumenting, since it goes to plain free())
+    Lgm_Arena_Instrument( TRUE );
+    Lgm_Arena_GetHeapStats( &h0 );
+    a = Lgm_Arena_Create( "check", 4096 );
+
+    Prev = Lgm_Arena_Bind( a );
+    if ( Lgm_Arena_Current() != a ) { printf("Arena 01: arena not bound\n"); ++nFail; }
+    LGM_ARRAY_2D( A, 10, 20, double );
+    if ( !LGM_IS_ARENA_MEM( A ) || !Lgm_Arena_Owns( a, A ) || !Lgm_Arena_Owns( a, A[0] ) || ( (size_t)A[0] % LGM_ARENA_ALIGN ) ) {
+        printf("Arena 01: LGM_ARRAY_2D did not come from the bound arena\n"); ++nFail;
+    }
+    for ( i=0; i<10; i++ ) for ( j=0; j<20; j++ ) {
+        if ( A[i][j] != 0.0 ) { printf("Arena 01: A[%d][%d] = %g (not zeroed)\n", i, j, A[i][j] ); ++nFail; }
+        A[i][j] = i*100+j;
+    }
+
+    // Nested binding of the heap.
+    if ( Lgm_Arena_Bind( NULL ) != a ) { printf("Arena 01: Lgm_Arena_Bind() did not return the previous arena\n"); ++nFail; }
+    LGM_ARRAY_1D( H,  100, double );
+    LGM_ARRAY_3D( B, 3, 4, 5, double );
+    if ( LGM_IS_ARENA_MEM( H ) || LGM_IS_ARENA_MEM( B ) || LGM_IS_ARENA_MEM( **B ) || Lgm_Arena_Owns( a, H ) ) {
+        printf("Arena 01: heap arrays look like arena memory\n"); ++nFail;
+    }
+    Lgm_Arena_Bind( a );
+
+    // Heap arrays freed while an arena is bound, or with plain free().
+    LGM_ARRAY_1D_FREE( H );
+    LGM_ARRAY_3D_FREE( B );
+    free( H2 );
+
+    // Mark/Release gives the same memory back.
+    InUse = a->InUse;
+    Mark = Lgm_Arena_Mark( a );
+    LGM_ARRAY_1D( C, 1000, double );     // bigger than a chunk
+    C[999] = 1.0;
+    Lgm_Arena_Release( a, Mark );
+    LGM_ARRAY_1D( D, 1000, double );
+    if ( ( a->InUse != InUse + 1000*sizeof(double) ) || ( D != C ) || ( D[999] != 0.0 ) ) {
+        printf("Arena 01: Release did not give back the memory (InUse = %lu, expected %lu)\n", (unsigned long)a->InUse, (unsigned long)(InUse+1000*sizeof(double)) ); ++nFail;
+    }
+
+    if ( Lgm_Arena_Bind( Prev ) != a || Lgm_Arena_Current() != Prev ) { printf("Arena 01: could not unbind the arena\n"); ++nFail; }
+
+    // Arena arrays freed with no arena bound, and after the arena is gone.
+    InUse = a->InUse;
+    LGM_ARRAY_1D_FREE( D );
+    if ( ( a->InUse != InUse ) || ( A[9][19] != 919.0 ) ) { printf("Arena 01: freeing arena memory changed it\n"); ++nFail; }
+    Lgm_Arena_Destroy( a );
+    LGM_ARRAY_2D_FREE( A );
+    if ( !LGM_IS_ARENA_MEM( A ) ) { printf("Arena 01: memory of a destroyed arena no longer recognized\n"); ++nFail; }
+
+    // A new arena reuses the address space, zeroed.
+    a = Lgm_Arena_Create( "check2", 4096 );
+    Prev = Lgm_Arena_Bind( a );
+    LGM_ARRAY_1D( C, 1000, double );
+    for ( i=0; i<1000; i++ ) if ( C[i] != 0.0 ) { printf("Arena 01: C[%d] = %g (not zeroed)\n", i, C[i] ); ++nFail; break; }
+    Lgm_Arena_Bind( Prev );
+    Lgm_Arena_Destroy( a );
+
+    Lgm_Arena_GetHeapStats( &h1 );
+    Lgm_Arena_Instrument( FALSE );
+    if ( h1.InUse != h0.InUse ) { printf("Arena 01: heap InUse = %lu after, %lu before\n", (unsigned long)h1.InUse, (unsigned long)h0.InUse ); ++nFail; }
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "Lgm_Arena: bind/unbind or mixed heap/arena frees failed\n" );
+
+    return;
+}
+END_TEST
+
+
+START_TEST(test_Arena_02) {
+
+    int             i, nFail = 0;
+    double          *pdata, **A, ***B;
+    Lgm_Arena       *a, *Prev;
+
+    /*
+     *  LGM_ARRAY_FROM_DATA_* on calloc()'d blocks (these never use arenas,
+     *  even with one bound), freed with the ordinary FREE macros -- as
+     *  ReadMagEphemInfoStruct()/Lgm_FreeMagEphemInfo() do.
+     */
+    a = Lgm_Arena_Create( "check", 0 );
+    Prev = Lgm_Arena_Bind( a );
+
+    pdata = (double *)calloc( 6*7, sizeof(double) );
+    LGM_ARRAY_FROM_DATA_2D( A, pdata, 6, 7, double );
+    for ( i=0; i<6; i++ ) A[i][6] = i;
+    if ( LGM_IS_ARENA_MEM( A ) || ( pdata[6*7-1] != 5.0 ) ) { printf("Arena 02: LGM_ARRAY_FROM_DATA_2D is wrong\n"); ++nFail; }
+    LGM_ARRAY_2D_FREE( A );
+
+    pdata = (double *)calloc( 3*4*5, sizeof(double) );
+    LGM_ARRAY_FROM_DATA_3D( B, pdata, 3, 4, 5, double );
+    B[2][3][4] = 1.0;
+    if ( LGM_IS_ARENA_MEM( B ) || ( pdata[3*4*5-1] != 1.0 ) ) { printf("Arena 02: LGM_ARRAY_FROM_DATA_3D is wrong\n"); ++nFail; }
+    Lgm_Arena_Bind( Prev );
+    LGM_ARRAY_3D_FREE( B );
+
+    if ( a->nAllocs != 0 ) { printf("Arena 02: LGM_ARRAY_FROM_DATA_* used the arena\n"); ++nFail; }
+    Lgm_Arena_Destroy( a );
+
+    fflush(stdout);
+    fail_unless( nFail == 0, "Lgm_Arena: LGM_ARRAY_FROM_DATA_* arrays are wrong\n" );
+
+    return;
+}
+END_TEST
+
+
 
 Suite *make_master_suite (void) {
     Suite *s = suite_create("LGM Master Suite");
@@ -117,12 +437,28 @@ Suite *lgm_ls_suite(void) {
     tcase_add_test(tc_leapseconds, test_IsLeapSecondDay_01);
     tcase_add_test(tc_leapseconds, test_IsLeapSecondDay_02);
     tcase_add_test(tc_leapseconds, test_GetLeapSeconds);
+    tcase_add_test(tc_leapseconds, test_LeapSecondIndex);
+    tcase_add_test(tc_leapseconds, test_IsLeapSecondDay_03);
+    tcase_add_test(tc_leapseconds, test_EopIndex);
     suite_add_tcase(s, tc_leapseconds);
   
     return s;
 
 }
 
+Suite *lgm_time_suite(void) {
+
+    Suite *s = suite_create("TIME_CONVERSION_TESTS");
+
+    TCase *tc_time = tcase_create("Time system conversions");
+    tcase_add_checked_fixture(tc_time, leapsecond_setup, leapsecond_teardown);
+    tcase_add_test(tc_time, test_ConvertTimeArray);
+    suite_add_tcase(s, tc_time);
+
+    return s;
+
+}
+
 Suite *lgm_vec_suite(void) {
 
     Suite *s = suite_create("VECTOR_OPERATION_TESTS");
@@ -137,13 +473,29 @@ Suite *lgm_vec_suite(void) {
 }
 
 
+Suite *lgm_mem_suite(void) {
+
+    Suite *s = suite_create("DYNAMIC_MEMORY_TESTS");
+
+    TCase *tc_mem = tcase_create("Arenas and LGM_ARRAY_* macros");
+    tcase_add_test(tc_mem, test_Arena_01);
+    tcase_add_test(tc_mem, test_Arena_02);
+    suite_add_tcase(s, tc_mem);
+
+    return s;
+
+}
+
+
 int main(void) {
 
     int      number_failed;
     Suite   *s = make_master_suite();
     SRunner *sr = srunner_create(s);
     srunner_add_suite (sr, lgm_ls_suite());
+    srunner_add_suite (sr, lgm_time_suite());
     srunner_add_suite (sr, lgm_vec_suite());
+    srunner_add_suite (sr, lgm_mem_suite());
 
     printf("\n\n\n======================================================\n");
     printf("\n               UNIT/REGRESSION TESTS                   \n");